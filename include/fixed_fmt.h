@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Integer-only text formatters for fixed-point values, cheaper than
+// snprintf("%f") on the FPU-less ESP32-C3. Each writes a NUL-terminated
+// string and returns its length, or 0 (and writes nothing) if it does not
+// fit in `size`.
+
+// Longest output of fixed_fmt: sign, 10 digits, point, NUL
+#define FIXED_FMT_MAX 13
+// "YYYY-MM-DDTHH:MM:SSZ" plus NUL
+#define FIXED_FMT_ISO8601_LEN 21
+
+// v / 10^decimals with exactly `decimals` fraction digits ("-22.9068470")
+int fixed_fmt(char *buf, size_t size, int32_t v, uint8_t decimals);
+// Same, rounded half away from zero to `shown` <= decimals fraction digits
+// (an e7 latitude with 5 shown: "-22.90685")
+int fixed_fmt_round(char *buf, size_t size, int32_t v, uint8_t decimals,
+                    uint8_t shown);
+// Unsigned integer, no padding
+int fixed_fmt_u32(char *buf, size_t size, uint32_t v);
+// Unix seconds as UTC ISO 8601
+int fixed_fmt_iso8601(char *buf, size_t size, uint32_t unix_time);
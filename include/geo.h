@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+// Integer geodesy on 1e-7 degree coordinates, no floating point. Distances
+// use a local equirectangular plane with cos(latitude) taken at the middle
+// of the leg: within 3 cm of haversine up to 100 m and 0.015% up to
+// ~100 km below 70 degrees of latitude (0.05% at 80), which covers
+// fix-to-fix legs, fences and map queries.
+
+// 1e-7 degree of arc in cm x100000 on the 6371 km mean sphere (1.11195 cm)
+#define GEO_CM_PER_E7_X100000 111195
+
+// Function prototypes
+// cos(latitude) in Q16 (65536 = 1), from a 1-degree table
+uint32_t geo_cos_q16(int32_t lat_e7);
+uint32_t geo_isqrt64(uint64_t v);
+// Heading of the vector (east, north): centidegrees clockwise from north,
+// 0..35999; 0 for a zero vector
+uint16_t geo_heading_cdeg(int64_t east, int64_t north);
+uint32_t geo_distance_cm(int32_t lat1_e7, int32_t lon1_e7, int32_t lat2_e7,
+                         int32_t lon2_e7);
+// Bearing from point 1 to point 2 at mid-leg, centidegrees from true north
+// (the initial bearing within ~0.1 degree on legs up to 1 km)
+uint16_t geo_bearing_cdeg(int32_t lat1_e7, int32_t lon1_e7, int32_t lat2_e7,
+                          int32_t lon2_e7);
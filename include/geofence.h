@@ -0,0 +1,66 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fence definitions, one per line, '#' starts a comment:
+//   C,<name>,<lat>,<lon>,<radius m>
+//   P,<name>,<lat1>,<lon1>,<lat2>,<lon2>,<lat3>,<lon3>[,...]
+// Degrees are decimal (parsed without floats). Read from the SD card, or
+// from the NVS string "geofence/fences" when the card has no file.
+#ifndef GEOFENCE_FILE
+#define GEOFENCE_FILE "/sd/fences.txt"
+#endif
+#define GEOFENCE_NVS_NAMESPACE "geofence"
+#define GEOFENCE_NVS_KEY "fences"
+
+#ifndef GEOFENCE_MAX_FENCES
+#define GEOFENCE_MAX_FENCES 2048
+#endif
+#define GEOFENCE_NAME_LEN 24
+#define GEOFENCE_LINE_MAX 1024
+// Fences the position may be inside at the same time
+#define GEOFENCE_MAX_INSIDE 32
+// Grid index cells per axis over the union of all fence boxes
+#define GEOFENCE_GRID_DIM 32
+
+typedef enum {
+  GEOFENCE_ENTER = 0,
+  GEOFENCE_EXIT,
+} geofence_transition_t;
+
+typedef struct {
+  uint16_t id; // line order in the definition
+  const char *name;
+  geofence_transition_t transition;
+  uint32_t time; // unix seconds of the fix
+  int32_t lat_e7;
+  int32_t lon_e7;
+} geofence_event_t;
+
+typedef void (*geofence_event_cb_t)(const geofence_event_t *ev, void *ctx);
+
+typedef struct {
+  uint16_t fences;
+  uint16_t inside;      // fences containing the last fix
+  uint32_t fixes;       // evaluations
+  uint32_t candidates;  // fences tested exactly, all fixes
+  uint32_t events;
+  uint32_t last_us;
+  uint32_t max_us;
+} geofence_stats_t;
+
+// Function prototypes
+// Loads GEOFENCE_FILE, falling back to NVS. ESP_ERR_NOT_FOUND when neither
+// has fences. Call before the first geofence_update() or from its task.
+esp_err_t geofence_init(void);
+// Parses a definition (see above) and rebuilds the index; malformed lines
+// are skipped with a warning
+esp_err_t geofence_load_text(const char *text);
+void geofence_set_callback(geofence_event_cb_t cb, void *ctx);
+// Tests the fix against fences in its grid cell only: box prefilter, then
+// an integer circle or crossing-number test. Calls the callback for every
+// enter/exit since the previous fix.
+void geofence_update(int32_t lat_e7, int32_t lon_e7, uint32_t time);
+void geofence_get_stats(geofence_stats_t *stats);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Constant-velocity Kalman filter on a local east/north plane in metres:
+// one decoupled (position, velocity) filter per axis, fed the fix position
+// weighted by HDOP and the receiver's Doppler speed/course. Single
+// precision only, the ESP32-C3 has no FPU and soft doubles cost ~3x more;
+// offsets from the plane origin stay under GPS_FILTER_REANCHOR_M so floats
+// keep millimetre resolution.
+
+// Position sigma per unit of HDOP (user equivalent range error)
+#ifndef GPS_FILTER_UERE_M
+#define GPS_FILTER_UERE_M 3.0f
+#endif
+// Process noise: white acceleration, m/s^2 (a boat turning or surging)
+#ifndef GPS_FILTER_ACCEL
+#define GPS_FILTER_ACCEL 0.5f
+#endif
+// Sigma of the Doppler velocity, m/s
+#define GPS_FILTER_SPEED_SIGMA 0.3f
+// Fixes with a normalized innovation above this (chi-square, 2 dof; ~5
+// sigma) are rejected; rejected for this long in a row, the receiver
+// really moved and the filter restarts on the fix. Timed rather than
+// counted so a multipath jump of a few seconds at 10 Hz is ridden out too.
+#define GPS_FILTER_GATE 25.0f
+#define GPS_FILTER_OUTLIER_RESET_US 5000000
+// A gap longer than this between fixes restarts the filter
+#define GPS_FILTER_MAX_GAP_US 10000000
+// Dead reckoning stops extrapolating after this long without a fix
+#define GPS_FILTER_DR_MAX_US 3000000
+#define GPS_FILTER_REANCHOR_M 2000.0f
+// Longest gps_filter_json() output, with its terminator
+#define GPS_FILTER_JSON_MAX 144
+
+typedef struct {
+  int64_t time_us; // monotonic time the fix arrived
+  int32_t lat_e7;
+  int32_t lon_e7;
+  uint16_t hdop_e2;     // 0 if unknown
+  uint32_t speed_ckmh;  // used when has_velocity
+  uint16_t course_cdeg;
+  bool has_velocity;
+} gps_filter_meas_t;
+
+// Published filter output
+typedef struct {
+  bool valid;
+  int64_t time_us; // of the last update
+  int32_t lat_e7;
+  int32_t lon_e7;
+  float vn, ve;          // m/s north and east
+  uint32_t speed_ckmh;   // 0.01 km/h, like gps_data_t
+  uint16_t course_cdeg;  // 0.01 degree, true
+  uint32_t sigma_cm;     // 1-sigma horizontal position
+  float e7_per_m_lon;   // longitude scale for dead reckoning
+} gps_filter_state_t;
+
+typedef struct {
+  uint32_t updates;
+  uint32_t outliers;
+  uint32_t resets;
+  uint32_t last_us;
+  uint32_t max_us;
+} gps_filter_stats_t;
+
+// Function prototypes
+// Writer side (GPS ingest task): predicts to the fix time and corrects with
+// it, then publishes the state. Returns false for a rejected outlier (the
+// prediction is published instead).
+bool gps_filter_update(const gps_filter_meas_t *m, gps_filter_state_t *out);
+void gps_filter_reset(void);
+// Reader side (any task): consistent copy, returns the update count
+uint32_t gps_filter_get(gps_filter_state_t *out);
+// Position extrapolated along the filtered velocity to now_us, for drawing
+// between fixes
+void gps_filter_position_at(const gps_filter_state_t *s, int64_t now_us,
+                            int32_t *lat_e7, int32_t *lon_e7);
+// ,"filtered":{latitude,longitude,speed,course,sigma} dead reckoned to
+// now_us, or "" without a filtered fix; shared by /api/gps and MQTT
+void gps_filter_json(char *buf, size_t size, int64_t now_us);
+void gps_filter_get_stats(gps_filter_stats_t *stats);
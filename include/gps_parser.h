@@ -3,21 +3,56 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#define GPS_MAX_SATS_STORED 32
+
+// Fix type as reported by GSA
+#define GPS_FIX_NONE 1
+#define GPS_FIX_2D 2
+#define GPS_FIX_3D 3
+
+typedef struct {
+  char talker; // second talker letter: P=GPS, L=GLONASS, A=Galileo, B=BeiDou
+  uint8_t prn;
+  uint8_t snr; // dB-Hz, 0 when not tracked
+} gps_sat_t;
+
 typedef struct {
   bool valid;
-  double latitude;
-  double longitude;
-  float altitude;
+  int32_t lat_e7; // 1e-7 degree
+  int32_t lon_e7;
+  int32_t alt_cm;
   uint8_t satellites;
-  float speed;
-  float course;
+  uint32_t speed_ckmh;  // 0.01 km/h
+  uint16_t course_cdeg; // 0.01 degree, true
   char timestamp[10]; // HHMMSS
+  uint16_t time_ms;   // sub-second part of timestamp
   char date[7];       // DDMMYY
+  // Complete fix epochs so far: GGA and RMC with the same time (NMEA), or
+  // one NAV-PVT (UBX). Consumers run once per new value.
+  uint32_t epoch;
+  uint8_t fix_type;   // GPS_FIX_*, 0 until a GSA is seen
+  uint16_t hdop_e2; // DOPs x100
+  uint16_t pdop_e2;
+  uint16_t vdop_e2;
+  uint8_t sats_in_view; // GSV field 3, summed over constellations
+  uint8_t sats_stored;  // entries in sats[]
+  gps_sat_t sats[GPS_MAX_SATS_STORED]; // from GSV, all constellations
 } gps_data_t;
 
+static inline bool gps_data_has_fix(const gps_data_t *gps) {
+  return gps->valid && gps->satellites >= 3;
+}
+
 // Function prototypes
+// Writer side (GPS ingest task only): parse into the working copy returned
+// by gps_get_data(), then gps_publish() it for everyone else.
 void gps_parse_nmea(const char *nmea_sentence);
 gps_data_t *gps_get_data(void);
+void gps_publish(void);
+// Reader side (any task): copies a consistent fix, never a half-updated one.
+// Returns the publish count, so callers can tell whether anything changed.
+uint32_t gps_get_snapshot(gps_data_t *out);
 void gps_reset_data(void);
 bool gps_has_fix(void);
-
+// UTC seconds since 1970 from date/timestamp, 0 until both are known
+uint32_t gps_unix_time(const gps_data_t *gps);
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+
+// Basemap blob produced by tools/osm2tiles.py (see its docstring for the
+// layout). Map units are 2^unit_log2_cm cm in both axes, x east, y north,
+// origin at the south-west corner of the extract. All offsets are from the
+// start of the blob; every struct sits at its natural alignment.
+#define MAP_MAGIC 0x50414D47 // "GMAP"
+#define MAP_VERSION 2
+#define MAP_NO_NAME 0xFFFFFFFF
+
+// Packed R-tree over the POI table: with fanout M, level 0 is the POI
+// table itself (Hilbert-sorted) and node i of level l covers children
+// i*M..i*M+M-1 of level l-1, so there are no child pointers. Boxes of all
+// internal levels follow rtree_off, lowest level first (the root is the
+// last box), then one kind mask byte per node (bit n = MAP_POI_* n
+// somewhere below).
+#define MAP_RTREE_MAX_LEVELS 8
+#define MAP_RTREE_MAX_FANOUT 32
+
+// Way classes
+#define MAP_KIND_COAST 1
+#define MAP_KIND_ROAD 2
+#define MAP_KIND_PATH 3
+#define MAP_KIND_PIER 4
+#define MAP_KIND_AREA 5
+#define MAP_KIND_BUILDING 6
+#define MAP_KIND_SEAMARK 7 // restricted areas, submarine pipelines
+#define MAP_KIND_BOUNDARY 8
+
+// Seamark point classes
+#define MAP_POI_BUOY 1
+#define MAP_POI_BEACON 2
+#define MAP_POI_WRECK 3
+#define MAP_POI_LIGHT 4
+#define MAP_POI_OTHER 5
+
+// Inclusive; an empty tile has x0 > x1
+typedef struct {
+  uint16_t x0, y0, x1, y1;
+} map_bbox_t;
+
+typedef struct {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t tiles_x;
+  uint8_t tiles_y;
+  int8_t unit_log2_cm;
+  int32_t origin_lat_e7;
+  int32_t origin_lon_e7;
+  uint32_t lat_q16; // map units per 1e-7 degree, Q16
+  uint32_t lon_q16;
+  uint16_t width; // extent in map units
+  uint16_t height;
+  uint16_t feature_count;
+  uint8_t rtree_fanout;
+  uint8_t rtree_levels; // internal levels, 0 without POIs
+  uint32_t poi_count;
+  uint32_t tiles_off;
+  uint32_t poi_off;
+  uint32_t rtree_off;
+  uint32_t names_off;
+  uint32_t size;
+} map_header_t;
+
+// Row-major from the south-west tile; features are contiguous
+typedef struct {
+  map_bbox_t bbox; // union of the tile's feature boxes
+  uint32_t offset;
+  uint16_t count;
+  uint16_t reserved;
+} map_tile_t;
+
+// Followed by `size` bytes of points: the first as uint16 x, y, then int8
+// dx, dy pairs, dx == -128 escaping to an absolute uint16 x, y. The size is
+// always even, so the next feature stays 2-byte aligned.
+typedef struct {
+  map_bbox_t bbox;
+  uint8_t kind;
+  uint8_t closed; // last point equals the first
+  uint16_t size;
+} map_feature_t;
+
+typedef struct {
+  uint16_t x, y;
+  uint8_t kind;
+  uint8_t reserved[3];
+  uint32_t name; // offset into the name table or MAP_NO_NAME
+} map_poi_t;
+
+_Static_assert(sizeof(map_header_t) == 56, "map header layout");
+_Static_assert(sizeof(map_tile_t) == 16, "map tile layout");
+_Static_assert(sizeof(map_feature_t) == 12, "map feature layout");
+_Static_assert(sizeof(map_poi_t) == 12, "map poi layout");
+
+// Built-in extract, generated into src/map_data.c
+extern const uint8_t map_blob[];
+extern const uint32_t map_blob_size;
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "map_data.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Queries over the packed R-tree of map POIs (see map_data.h). They work
+// on any validated map blob and cost O(log n) node visits, so the same
+// code serves the bundled extract and regional ones with millions of marks.
+#define MAP_POI_KIND_ALL 0xFF
+#define MAP_POI_MAX_K 16
+
+// Nearest marks to the last fix, refreshed on every published fix
+#define MAP_NEARBY_K 4
+
+typedef struct {
+  uint32_t id;    // index into the POI table
+  uint64_t dist2; // squared distance in map units
+} map_poi_hit_t;
+
+// Return false to stop the walk
+typedef bool (*map_poi_cb_t)(uint32_t id, const map_poi_t *poi, void *ctx);
+
+typedef struct {
+  uint32_t id;
+  uint32_t dist_m;
+  uint16_t bearing_deg; // from the fix, true north
+} map_nearby_hit_t;
+
+typedef struct {
+  int32_t lat_e7; // fix the hits refer to
+  int32_t lon_e7;
+  uint8_t count;
+  map_nearby_hit_t hits[MAP_NEARBY_K];
+} map_nearby_t;
+
+// Function prototypes
+const map_poi_t *map_poi_get(const map_header_t *map, uint32_t id);
+// NULL for unnamed marks
+const char *map_poi_name(const map_header_t *map, const map_poi_t *poi);
+const char *map_poi_kind_name(uint8_t kind);
+// Parses "buoy", "beacon", "wreck", "light", "other" or "all" into a kind
+// mask (bit n = MAP_POI_* n); 0 if unknown
+uint8_t map_poi_kind_mask(const char *name);
+
+// Calls cb for every POI of a kind in kind_mask inside the box (inclusive)
+// and returns how many were visited
+uint32_t map_index_bbox(const map_header_t *map, const map_bbox_t *box,
+                        uint8_t kind_mask, map_poi_cb_t cb, void *ctx);
+// Up to k (<= MAP_POI_MAX_K) nearest POIs of a kind in kind_mask to the map
+// unit position (which may lie outside the map), closest first. Returns
+// the number found.
+uint8_t map_index_nearest(const map_header_t *map, int32_t x, int32_t y,
+                          uint8_t kind_mask, uint8_t k, map_poi_hit_t *hits);
+// Squared map units to metres
+uint32_t map_index_dist_m(const map_header_t *map, uint64_t dist2);
+// Degrees from true north, from the map unit position to the POI
+uint16_t map_poi_bearing(const map_poi_t *poi, int32_t x, int32_t y);
+
+// Writer side (GPS ingest task): nearest marks of any kind to the fix
+void map_nearby_update(int32_t lat_e7, int32_t lon_e7);
+// Reader side (any task): consistent copy, returns the update count
+uint32_t map_nearby_get(map_nearby_t *out);
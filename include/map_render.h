@@ -0,0 +1,39 @@
+#pragma once
+
+#include "esp_err.h"
+#include "map_data.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Zoom levels, 0 = widest. Level z draws at 2^(MAP_ZOOM0_LOG2_CM - z) cm
+// per pixel: 20.5, 10.2, 5.1 and 2.6 m, i.e. 2.6 km down to 330 m across
+// the 128-pixel screen.
+#define MAP_ZOOM_LEVELS 4
+#define MAP_ZOOM0_LOG2_CM 11
+
+typedef struct {
+  uint16_t tiles;    // tiles whose box meets the viewport
+  uint16_t features; // features drawn
+  uint16_t segments; // segments left after clipping
+  uint16_t pois;
+  uint32_t render_us; // framebuffer work only, not the I2C refresh
+} map_render_stats_t;
+
+// Function prototypes
+// Selects a basemap blob (see map_data.h); the built-in extract is used
+// until this is called. The blob must stay mapped while in use.
+esp_err_t map_open(const uint8_t *blob, uint32_t size);
+// Current map, NULL if none is usable
+const map_header_t *map_get(void);
+// Between 1e-7 degrees and map units; false without a map
+bool map_project(int32_t lat_e7, int32_t lon_e7, int32_t *x, int32_t *y);
+void map_unproject(int32_t x, int32_t y, int32_t *lat_e7, int32_t *lon_e7);
+// True when the position lies inside the extract
+bool map_contains(int32_t lat_e7, int32_t lon_e7);
+// Draws the map north-up centred on the position into the OLED framebuffer
+// (current clip rectangle, caller clears and refreshes), with a marker for
+// the position itself
+esp_err_t map_render(int32_t lat_e7, int32_t lon_e7, uint8_t zoom,
+                     map_render_stats_t *stats);
+// Width in metres of `pixels` at a zoom level, for scale bars
+uint32_t map_scale_m(uint8_t zoom, uint8_t pixels);
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "esp_err.h"
+#include "geofence.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 // MQTT configuration
 #define MQTT_BROKER_HOST "192.168.1.100" // Change to your MQTT broker IP
@@ -8,12 +11,69 @@
 #define MQTT_CLIENT_ID "oledgps_%d"
 #define MQTT_TOPIC_GPS "gps/tracker"
 #define MQTT_TOPIC_STATUS "gps/status"
+#define MQTT_TOPIC_GEOFENCE "gps/geofence"
+#define MQTT_TOPIC_STATS "gps/stats"
+// Batches from the store-and-forward queue (see mqtt_queue.h). Delivery is
+// at least once: a batch whose ack was lost, or that was in flight across a
+// reconnect, is sent again. Each batch carries its session and seq
+// (mqtt_batch_id_t); subscribers drop fixes whose index seq + i is not
+// above the highest seen for that session.
+#define MQTT_TOPIC_TRACK "gps/track"
+// A batch not acknowledged within this is sent again
+#define MQTT_ACK_TIMEOUT_MS 30000
+
+// Connection manager: WiFi/IP and client events move the state, the MQTT
+// task applies it in mqtt_service(). A failed or lost connection is retried
+// after a delay that doubles from MIN to MAX and resets on success.
+#ifndef MQTT_BACKOFF_MIN_MS
+#define MQTT_BACKOFF_MIN_MS 1000
+#endif
+#ifndef MQTT_BACKOFF_MAX_MS
+#define MQTT_BACKOFF_MAX_MS 60000
+#endif
+// An attempt without CONNACK or error within this counts as failed
+#define MQTT_CONNECT_TIMEOUT_MS 20000
+
+typedef enum {
+  MQTT_STATE_IDLE = 0, // disabled or not on the server network
+  MQTT_STATE_CONNECTING,
+  MQTT_STATE_CONNECTED,
+  MQTT_STATE_BACKOFF, // waiting to retry
+} mqtt_state_t;
+
+typedef struct {
+  mqtt_state_t state;
+  uint32_t attempts;         // connection attempts
+  uint32_t connects;         // of those, connected
+  uint32_t drops;            // connections lost
+  uint32_t connect_ms;       // last attempt to CONNACK
+  uint32_t reconnect_ms;     // last outage: drop or network up to CONNACK
+  uint32_t max_reconnect_ms; // longest outage
+  uint32_t uptime_s;         // current connection, 0 while down
+  uint32_t total_up_s;       // all connections since boot
+  uint32_t backoff_ms;       // delay after the next failure
+} mqtt_conn_stats_t;
 
 // Function prototypes
+// After wifi_init_apsta(): registers the WiFi/IP handlers
 esp_err_t mqtt_init(void);
+// Allows or stops connecting; idempotent, the next mqtt_service() acts
 esp_err_t mqtt_connect(void);
 esp_err_t mqtt_disconnect(void);
+// MQTT task, every drain tick: starts, retries or drops the connection
+void mqtt_service(void);
+// MQTT task only: the counters are updated by mqtt_service() unlocked
+void mqtt_get_conn_stats(mqtt_conn_stats_t *stats);
 esp_err_t mqtt_publish_gps_data(void);
+// MQTT task, every drain tick: applies the broker's ack of the batch in
+// flight, then sends the next due batch, or spills the queue while offline.
+// At most one batch is in flight.
+esp_err_t mqtt_publish_queue(void);
 esp_err_t mqtt_publish_status(const char *status);
+// Odometer and current trip, retained so a dashboard gets the last values
+esp_err_t mqtt_publish_trip_stats(void);
+// Non-blocking (client outbox), safe from the GPS ingest task; QoS 1 so
+// events queued while the broker is away are delivered on reconnect
+esp_err_t mqtt_publish_geofence_event(const geofence_event_t *ev);
 bool mqtt_is_connected(void);
 
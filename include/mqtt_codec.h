@@ -0,0 +1,50 @@
+#pragma once
+
+#include "sd_logger.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// MQTT payload encodings for fixes, all from the integer sd_log_record_t
+// (no floating point). Each enabled format goes to its own topic suffix:
+//   JSON    ""       {"device_id":..,"session":..,"seq":..,"fields":[..],
+//                    "fixes":[[..],..]}
+//   CBOR    "/cbor"  [version, session, seq, row0, row1, ...], row =
+//                    [time, lat_e7, lon_e7, alt_cm, speed_ckmh, course_cdeg,
+//                    satellites, hdop_dec, flags]; after row0 the first four
+//                    fields are deltas from the previous row
+//   PACKED  "/bin"   u8 version, u8 count, u32 session, u32 seq, then count
+//                    sd_log_record_t as on the SD card (all little-endian,
+//                    24 bytes each, CRC-8 last)
+// tools/mqtt_decode.py decodes CBOR and packed to the JSON layout and
+// passes JSON through, so a capture of all three reads the same.
+#define MQTT_PAYLOAD_JSON 0x01
+#define MQTT_PAYLOAD_CBOR 0x02
+#define MQTT_PAYLOAD_PACKED 0x04
+#ifndef MQTT_PAYLOAD_FORMATS
+#define MQTT_PAYLOAD_FORMATS MQTT_PAYLOAD_JSON
+#endif
+
+#define MQTT_CODEC_VERSION 1
+// The packed count is one byte
+#define MQTT_CODEC_MAX_FIXES 255
+// Buffer that always fits n fixes in any format (JSON is the largest)
+#define MQTT_CODEC_MAX_BYTES(n) ((n) * 76 + 200)
+
+// Where a batch sits in the MQTT queue: fix i has queue index seq + i.
+// Within one session indices only grow and a resent fix keeps its index,
+// so a subscriber drops fixes at or below the highest index it has seen.
+// The session changes when the queue starts over (a new spill file, or
+// every boot without one). Both are 0 for fixes not from the queue.
+typedef struct {
+  uint32_t session;
+  uint32_t seq;
+} mqtt_batch_id_t;
+
+// Function prototypes
+// "" for JSON, "/cbor" or "/bin"
+const char *mqtt_codec_suffix(uint8_t format);
+// Encodes n fixes, oldest first, in one format. Returns the length, 0 when
+// buf is too small or n is out of range.
+size_t mqtt_codec_encode(uint8_t format, const mqtt_batch_id_t *id,
+                         const sd_log_record_t *recs, uint16_t n,
+                         uint8_t *buf, size_t size);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "esp_err.h"
+#include "mqtt_codec.h"
+#include "sd_logger.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Store-and-forward queue between the simplified track and MQTT. Fixes
+// pass a dead-band (distance, heading change or keepalive since the last
+// queued fix), wait in a RAM ring and leave in batches, oldest first. While
+// the broker is away the MQTT task spills the ring to a ring file on the SD
+// card, which survives reboots; on reconnect the file drains before RAM.
+// A batch only leaves the queue once the broker acknowledged it (QoS 1),
+// so nothing acknowledged is sent again and order is kept. A batch whose
+// ack was lost is resent with the same queue indices (mqtt_batch_id_t);
+// indices carry over when RAM spills to the file and across reboots.
+#ifndef MQTT_QUEUE_SPILL_PATH
+#define MQTT_QUEUE_SPILL_PATH "/sd/mqttq.bin"
+#endif
+
+// Dead-band: any one of these queues the fix
+#ifndef MQTT_DEADBAND_M
+#define MQTT_DEADBAND_M 25
+#endif
+#ifndef MQTT_DEADBAND_CDEG
+#define MQTT_DEADBAND_CDEG 1500
+#endif
+#ifndef MQTT_DEADBAND_MAX_S
+#define MQTT_DEADBAND_MAX_S 300
+#endif
+// Heading changes below this speed are GPS noise
+#define MQTT_DEADBAND_MIN_CKMH 300
+
+// Fixes per message, and the longest a queued fix waits for a full batch
+#ifndef MQTT_BATCH_MAX
+#define MQTT_BATCH_MAX 32
+#endif
+#ifndef MQTT_BATCH_MAX_AGE_S
+#define MQTT_BATCH_MAX_AGE_S 60
+#endif
+
+// RAM ring (24 bytes per fix); when full the oldest fix is dropped
+#ifndef MQTT_QUEUE_RAM
+#define MQTT_QUEUE_RAM 256
+#endif
+// Offline, the ring spills once it holds this many fixes
+#define MQTT_QUEUE_SPILL_AT MQTT_BATCH_MAX
+// Spill file capacity in fixes (~1 MiB); when full the oldest is dropped
+#ifndef MQTT_QUEUE_FILE_MAX
+#define MQTT_QUEUE_FILE_MAX 43690
+#endif
+#define MQTT_QUEUE_FILE_MAGIC 0x32544D47 // "GMT2"
+
+typedef struct {
+  uint32_t offered;    // simplified fixes seen
+  uint32_t queued;     // passed the dead-band
+  uint32_t dropped;    // lost to a full RAM ring or spill file
+  uint32_t spilled;    // written to the spill file
+  uint32_t sent;       // acknowledged by the broker
+  uint32_t batches;    // acknowledged messages
+  uint32_t resent;     // batches sent again after a lost ack
+  uint32_t ram;        // fixes now in RAM
+  uint32_t file;       // fixes now in the spill file
+} mqtt_queue_stats_t;
+
+// Function prototypes
+// spill_path NULL keeps the queue in RAM only. Call before the ingest task.
+esp_err_t mqtt_queue_init(const char *spill_path);
+// Ingest task, per simplified fix; never blocks on I/O. True when queued.
+bool mqtt_queue_offer(const sd_log_record_t *rec);
+// MQTT task only. Fills up to `max` of the oldest fixes when a batch is
+// due (full, old enough, or backlog in the file) and returns the count;
+// the same fixes, from the same `id`, come back until mqtt_queue_ack()
+uint16_t mqtt_queue_peek(sd_log_record_t *out, uint16_t max,
+                         mqtt_batch_id_t *id);
+void mqtt_queue_ack(uint16_t count);
+// Counts a resend of the batch last peeked
+void mqtt_queue_note_resend(void);
+// MQTT task, while offline: moves the ring to the spill file
+void mqtt_queue_spill(void);
+// Fixes waiting in RAM and in the file
+uint32_t mqtt_queue_backlog(void);
+void mqtt_queue_get_stats(mqtt_queue_stats_t *stats);
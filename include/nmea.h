@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// NMEA 0183 limits a sentence to 82 characters including "$" and CRLF
+#define NMEA_MAX_SENTENCE 82
+#define NMEA_MAX_FIELDS 24
+
+// A field is a view into the original sentence: no copy, no terminator.
+// Empty fields (",,") are kept with len == 0 so field indexes never shift.
+typedef struct {
+  const char *ptr;
+  uint8_t len;
+} nmea_field_t;
+
+// Split a sentence in a single pass. Field 0 is the address ("GPGGA"),
+// scanning stops at '*', CR, LF or NUL. Returns the number of fields.
+int nmea_split(const char *sentence, nmea_field_t *fields, int max_fields);
+
+// Integer parsers. All return false on an empty or malformed field and
+// leave *out untouched, so callers can keep the previous value. A value
+// past uint32_t is malformed.
+bool nmea_parse_uint(const nmea_field_t *f, uint32_t *out);
+
+// Parse "123.45" into a fixed-point integer with `decimals` fraction digits
+// (extra digits are truncated, missing ones are zero-filled).
+bool nmea_parse_fixed(const nmea_field_t *f, uint8_t decimals, int32_t *out);
+
+// Parse "ddmm.mmmm"/"dddmm.mmmm" plus hemisphere into 1e-7 degrees. More
+// than 90 degrees with N/S or 180 otherwise is rejected.
+bool nmea_parse_coord(const nmea_field_t *f, const nmea_field_t *hemi,
+                      int32_t *out_e7);
+
+// Incremental framer: accepts arbitrary byte chunks from the UART, rebuilds
+// complete "$...*HH" sentences across chunk boundaries and verifies the XOR
+// checksum before handing each one to the callback (NUL-terminated, no CRLF).
+typedef void (*nmea_frame_cb_t)(const char *sentence, void *ctx);
+
+typedef struct {
+  uint32_t good;         // checksum verified and dispatched
+  uint32_t bad_checksum; // complete frame, checksum mismatch or not hex
+  uint32_t truncated;    // overflow, missing '*' or restarted by a new '$'
+} nmea_framer_stats_t;
+
+typedef struct {
+  char buf[NMEA_MAX_SENTENCE + 1];
+  uint8_t len;
+  uint8_t state;
+  uint8_t checksum;
+  uint8_t expected;
+  nmea_framer_stats_t stats;
+} nmea_framer_t;
+
+void nmea_framer_init(nmea_framer_t *fr);
+void nmea_framer_feed(nmea_framer_t *fr, const uint8_t *data, size_t len,
+                      nmea_frame_cb_t cb, void *ctx);
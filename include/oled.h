@@ -1,10 +1,14 @@
 #pragma once
 
 #include "esp_err.h"
+#include "oled_font.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 // OLED display dimensions
 #define OLED_WIDTH 128
 #define OLED_HEIGHT 64
+#define OLED_PAGES (OLED_HEIGHT / 8)
 
 // I2C address (try both common addresses)
 #define OLED_ADDR_1 0x3C
@@ -35,11 +39,47 @@
 #define OLED_CMD_SEG_REMAP 0xA0
 #define OLED_CMD_CHARGE_PUMP 0x8D
 
+// Refresh accounting. oled_display() sends only the changed column span of
+// each 8-row page; bytes count everything on the bus (address, control
+// byte, commands, pixels). At 400 kHz one byte takes ~22.5 us, so a full
+// 1024-byte frame costs ~24 ms of bus time.
+typedef struct {
+  uint32_t frames;  // refreshes that sent something
+  uint32_t skipped; // refreshes with nothing changed
+  uint32_t bytes;
+  uint32_t transactions;
+  uint16_t last_bytes; // last refresh
+  uint8_t last_transactions;
+} oled_stats_t;
+
+typedef enum {
+  OLED_BLIT_OR = 0, // set where the bitmap is 1
+  OLED_BLIT_CLEAR,  // clear where the bitmap is 1 (AND-NOT)
+  OLED_BLIT_COPY,   // replace the whole w x h rectangle
+} oled_blit_mode_t;
+
+typedef struct oled_backend oled_backend_t;
+
 // Function prototypes
+// SSD1306 over I2C; oled_init_backend() selects another transport (see
+// oled_backend.h), e.g. the host emulator
 esp_err_t oled_init(void);
+esp_err_t oled_init_backend(const oled_backend_t *backend);
 esp_err_t oled_clear(void);
 esp_err_t oled_display(void);
+// Forces the next oled_display() to resend the whole frame
+esp_err_t oled_invalidate(void);
+void oled_get_stats(oled_stats_t *stats);
+// All drawing is clipped to the clip rectangle (whole screen by default).
+// Text: the cursor is the top-left pixel of the next glyph (any y, not just
+// page rows); '\n' returns to the x of the last oled_set_cursor(). Glyph
+// cells are drawn opaque and clipped to the clip rectangle. oled_clear()
+// homes the cursor.
 esp_err_t oled_set_cursor(uint8_t x, uint8_t y);
+void oled_set_font(const oled_font_t *font);
+esp_err_t oled_set_clip(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+void oled_reset_clip(void);
+uint16_t oled_text_width(const char *str);
 esp_err_t oled_print(const char *str);
 esp_err_t oled_println(const char *str);
 esp_err_t oled_draw_pixel(uint8_t x, uint8_t y, bool color);
@@ -49,4 +89,11 @@ esp_err_t oled_draw_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h,
                          bool color);
 esp_err_t oled_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h,
                          bool color);
+// Spans: one masked byte per column (hline) or one byte per page (vline)
+esp_err_t oled_draw_hline(int16_t x, int16_t y, int16_t w, bool color);
+esp_err_t oled_draw_vline(int16_t x, int16_t y, int16_t h, bool color);
+// 1-bpp bitmap in page layout (w bytes per 8-row page, LSB on top, like
+// oled_font_t glyphs) at any x/y, clipped; partially off-screen is fine
+esp_err_t oled_draw_bitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                           uint8_t w, uint8_t h, oled_blit_mode_t mode);
 
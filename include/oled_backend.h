@@ -0,0 +1,41 @@
+#pragma once
+
+#include "esp_err.h"
+#include "oled.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Transport under the framebuffer in src/oled.c. oled.c speaks the SSD1306
+// command set (init sequence, column/page windows, partial refresh); a
+// backend only moves command and data bytes to a controller.
+struct oled_backend {
+  const char *name;
+  // Find the controller (e.g. probe the I2C address)
+  esp_err_t (*probe)(void);
+  // One transaction of command bytes (control byte 0x00)
+  esp_err_t (*write_cmds)(const uint8_t *cmds, size_t len);
+  // One transaction of display RAM bytes (control byte 0x40)
+  esp_err_t (*write_data)(const uint8_t *data, size_t len);
+};
+
+// SSD1306 on I2C_NUM_0 at 0x3C or 0x3D (src/oled_ssd1306_i2c.c)
+extern const oled_backend_t oled_backend_ssd1306_i2c;
+
+// Emulated SSD1306 (src/oled_host.c): interprets the addressing commands,
+// keeps the controller RAM and counts the I2C traffic the same frames would
+// cost on the wire. Needs nothing but libc, so display layouts can be
+// rendered, dumped and profiled on a PC or written to the SD card.
+extern const oled_backend_t oled_backend_host;
+
+typedef struct {
+  uint32_t transactions;
+  uint32_t bytes; // address + control byte + payload
+  uint32_t data_bytes;
+} oled_host_stats_t;
+
+// Function prototypes
+const uint8_t *oled_host_ram(void);
+void oled_host_get_stats(oled_host_stats_t *stats);
+void oled_host_reset_stats(void);
+// Controller RAM as a binary PBM (P4), 1 = lit pixel
+esp_err_t oled_host_save_pbm(const char *path);
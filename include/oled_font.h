@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+// Bitmap font in SSD1306 page layout: each glyph is `width` column bytes per
+// 8-row page, LSB at the top, page 0 first. Generated into src/oled_font.c
+// by tools/gen_oled_font.py.
+typedef struct {
+  uint8_t width;   // glyph columns stored
+  uint8_t advance; // cursor step: width plus spacing
+  uint8_t pages;   // glyph height in pages, 1..4
+  uint8_t first;   // first character code present
+  uint8_t last;    // last character code present
+  const uint8_t *glyphs;
+} oled_font_t;
+
+extern const oled_font_t oled_font_5x7;          // 6x8 cell, ASCII
+extern const oled_font_t oled_font_10x14;        // 12x16 cell, ASCII
+extern const oled_font_t oled_font_digits_20x28; // 24x32 cell, "-./0-9:"
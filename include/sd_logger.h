@@ -0,0 +1,139 @@
+#pragma once
+
+#include "esp_err.h"
+#include "gps_parser.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Output streams, combine with |
+#define SD_LOG_CSV 0x01 // legacy text line per fix
+#define SD_LOG_BIN 0x02 // sd_log_record_t per fix, segmented
+
+#ifndef SD_LOG_FORMATS
+#define SD_LOG_FORMATS (SD_LOG_CSV | SD_LOG_BIN)
+#endif
+
+#ifndef SD_LOG_CSV_PATH
+#define SD_LOG_CSV_PATH "/sd/gps_log.txt"
+#endif
+// Binary segments are named after their first fix: /sd/gpslog/XXXXXXXX.BIN
+// with the unix time in hex (8.3 names, FATFS is built without LFN)
+#ifndef SD_LOG_SEG_DIR
+#define SD_LOG_SEG_DIR "/sd/gpslog"
+#endif
+
+// Each stream is buffered in RAM and written in whole 4 KiB (8 sector)
+// units aligned to the file offset; a partial buffer is written only when
+// SD_LOG_FLUSH_MS elapses, followed by fsync.
+#define SD_LOG_BUF_BYTES 4096
+#ifndef SD_LOG_FLUSH_MS
+#define SD_LOG_FLUSH_MS 30000
+#endif
+
+// Binary record, little-endian, 24 bytes
+typedef struct __attribute__((packed)) {
+  uint32_t time; // unix seconds (UTC)
+  int32_t lat_e7;
+  int32_t lon_e7;
+  int32_t alt_cm;
+  uint16_t speed_ckmh;  // 0.01 km/h
+  uint16_t course_cdeg; // 0.01 degree
+  uint8_t satellites;
+  uint8_t hdop_dec; // 0.1, saturates at 25.5
+  uint8_t flags;    // bit0 valid, bits1-2 fix type
+  uint8_t crc8;     // CRC-8 (poly 0x07) of the preceding 23 bytes
+} sd_log_record_t;
+
+// Segment layout:
+//   block 0..n-1  4 KiB each: sd_log_block_hdr_t + up to 170 records
+//   footer        sd_log_index_t[index_count] + sd_log_trailer_t
+// A segment rotates at SD_LOG_SEG_MAX_BLOCKS or when the UTC day changes.
+// The last block is rewritten in place until full, so a power cut loses at
+// most the records after the last flush; records carry their own CRC.
+#define SD_LOG_BLOCK_MAGIC 0x4B4C4247 // "GBLK"
+#define SD_LOG_TRAILER_MAGIC 0x58444947 // "GIDX"
+#define SD_LOG_BLOCK_RECORDS 170
+#ifndef SD_LOG_SEG_MAX_BLOCKS
+#define SD_LOG_SEG_MAX_BLOCKS 1024 // 4 MiB
+#endif
+// One index entry every 8 blocks (32 KiB): a range query reads log2 of the
+// index plus at most 8 blocks before the first match
+#define SD_LOG_INDEX_STRIDE 8
+#define SD_LOG_MAX_INDEX (SD_LOG_SEG_MAX_BLOCKS / SD_LOG_INDEX_STRIDE)
+// Segments considered by a query, newest kept
+#ifndef SD_LOG_MAX_SEGMENTS
+#define SD_LOG_MAX_SEGMENTS 400
+#endif
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint32_t seg_start;  // segment id, also its file name
+  uint32_t first_time; // time of records[0]
+  uint16_t block_no;
+  uint16_t count; // records in this block
+} sd_log_block_hdr_t;
+
+typedef struct __attribute__((packed)) {
+  uint32_t time; // first record of the block
+  uint32_t block_no;
+} sd_log_index_t;
+
+typedef struct __attribute__((packed)) {
+  uint32_t record_count;
+  uint32_t block_count;
+  uint32_t index_count;
+  uint32_t start_time;
+  uint32_t end_time;
+  uint32_t crc32; // index entries followed by the five fields above
+  uint32_t magic; // last 4 bytes of the file
+} sd_log_trailer_t;
+
+typedef struct {
+  uint32_t records;
+  uint32_t dropped; // both buffers full, SD too slow
+  uint32_t writes;
+  uint32_t bytes_written;
+  uint32_t last_write_us; // duration of the last write + fsync
+  uint32_t segments;      // segments opened since boot
+  uint32_t recovered;     // records kept when repairing the last segment
+} sd_logger_stats_t;
+
+// Time-range reader. Large (one block buffer): allocate, do not put it on a
+// task stack.
+typedef struct {
+  uint32_t from;
+  uint32_t to;
+  uint32_t segs[SD_LOG_MAX_SEGMENTS];
+  uint16_t seg_count;
+  uint16_t seg_idx;
+  int fd;
+  uint32_t block_no;
+  uint32_t block_count;
+  uint16_t rec_idx;
+  uint16_t rec_count;
+  uint8_t block[SD_LOG_BUF_BYTES];
+} sd_log_cursor_t;
+
+uint8_t sd_log_crc8(const uint8_t *data, size_t len);
+uint32_t sd_log_crc32(uint32_t crc, const uint8_t *data, size_t len);
+bool sd_log_record_from_gps(const gps_data_t *gps, sd_log_record_t *rec);
+bool sd_log_record_valid(const sd_log_record_t *rec);
+
+// Opens the log files once and repairs the last segment if it was not
+// closed; returns an error if the card is not usable
+esp_err_t sd_logger_init(void);
+// Copies the fix into RAM only; never touches the card
+bool sd_logger_append(const gps_data_t *gps);
+// Same for a fix already in record form (e.g. from the track simplifier);
+// the CRC is not recomputed
+bool sd_logger_append_record(const sd_log_record_t *rec);
+// Run from the SD task: writes filled buffers and the time-based flush
+esp_err_t sd_logger_service(void);
+esp_err_t sd_logger_flush(void);
+void sd_logger_get_stats(sd_logger_stats_t *stats);
+
+// Records with from <= time <= to, oldest first. Seeks by binary search over
+// the segment names and then the footer index of the first segment.
+esp_err_t sd_log_cursor_open(sd_log_cursor_t *cur, uint32_t from, uint32_t to);
+bool sd_log_cursor_next(sd_log_cursor_t *cur, sd_log_record_t *rec);
+void sd_log_cursor_close(sd_log_cursor_t *cur);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Sequence lock for a published copy with one writer task: the count is odd
+// while a write is in progress, and readers retry until they copy under one
+// stable even value. Neither side blocks or takes a lock, so the writer
+// never waits for a slow reader. Zero-initialised counts are unlocked.
+
+// Function prototypes
+// Writer side (one task only): copies len bytes of src over the published
+// copy at dst
+static inline void seqlock_write(uint32_t *seq, void *dst, const void *src,
+                                 size_t len) {
+  uint32_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+  __atomic_store_n(seq, s + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(dst, src, len);
+  __atomic_store_n(seq, s + 2, __ATOMIC_RELEASE);
+}
+
+// Reader side (any task): consistent copy of the published src into dst.
+// Returns the number of writes so far.
+static inline uint32_t seqlock_read(const uint32_t *seq, void *dst,
+                                    const void *src, size_t len) {
+  uint32_t before, after;
+  do {
+    before = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+    memcpy(dst, src, len);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    after = __atomic_load_n(seq, __ATOMIC_RELAXED);
+  } while ((before & 1) || before != after);
+  return before / 2;
+}
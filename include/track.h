@@ -0,0 +1,71 @@
+#pragma once
+
+#include "esp_err.h"
+#include "gps_parser.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// In-RAM fix history. Fixes are stored as delta-encoded varint records in a
+// ring of fixed-size blocks; each block keeps its first fix absolute, so the
+// oldest block can be dropped without re-encoding anything.
+//
+// Memory budget: TRACK_RING_BYTES of block data plus ~28 bytes of header per
+// block (64 KiB + 3.5 KiB by default). A record is 1 byte while moored (all
+// deltas zero, dt = 1 s) and 6-10 bytes under way at 1 Hz, so the default
+// holds ~18 h moored or ~2 h under way. A full day under way at 1 Hz needs
+// ~700 KiB, which only fits on boards with PSRAM; raise the budget there.
+#ifndef TRACK_RING_BYTES
+#define TRACK_RING_BYTES (64 * 1024)
+#endif
+#define TRACK_BLOCK_BYTES 512
+#define TRACK_BLOCKS (TRACK_RING_BYTES / TRACK_BLOCK_BYTES)
+// flags + dt + dlat + dlon + dalt + dspeed as varints + course
+#define TRACK_MAX_RECORD 25
+
+typedef struct {
+  uint32_t time; // unix seconds (UTC)
+  int32_t lat_e7;
+  int32_t lon_e7;
+  int32_t alt_dm;      // decimetres
+  uint16_t speed_dkmh; // 0.1 km/h
+  uint8_t course_2deg; // course / 2, 0..179
+} track_fix_t;
+
+typedef struct {
+  uint32_t fixes;
+  uint32_t bytes_used;
+  uint32_t oldest;
+  uint32_t newest;
+} track_stats_t;
+
+// Readers copy one block at a time under the lock and decode outside it,
+// so a slow HTTP client never blocks the ingest task's appends.
+typedef struct {
+  uint32_t from;
+  uint32_t to;
+  uint32_t seq; // block sequence number being read
+  uint16_t pos; // decode offset inside `data`
+  uint16_t len; // bytes copied into `data`
+  bool loaded;
+  bool first_done; // block's absolute fix already returned
+  track_fix_t first;
+  track_fix_t prev;
+  uint8_t data[TRACK_BLOCK_BYTES];
+} track_cursor_t;
+
+// Codec (no RTOS dependencies). Returns bytes written / consumed, 0 on error.
+size_t track_encode(const track_fix_t *prev, const track_fix_t *cur,
+                    uint8_t *out);
+size_t track_decode(const track_fix_t *prev, const uint8_t *in, size_t len,
+                    track_fix_t *out);
+bool track_fix_from_gps(const gps_data_t *gps, track_fix_t *out);
+
+esp_err_t track_init(void);
+// O(1): encodes against the previous fix, evicts the oldest block when full.
+// Fixes must have strictly increasing time; others are rejected.
+bool track_append(const track_fix_t *fix);
+void track_get_stats(track_stats_t *stats);
+
+void track_cursor_init(track_cursor_t *cur, uint32_t from, uint32_t to);
+bool track_cursor_next(track_cursor_t *cur, track_fix_t *fix);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Streams a time range of the SD log in a download format. Records are read
+// through sd_log_cursor_t and formatted into one TRACK_EXPORT_CHUNK buffer
+// that is handed to the sink whenever it fills, so memory use is fixed
+// (~7 KiB of heap while the export runs) whatever the range.
+#ifndef TRACK_EXPORT_CHUNK
+#define TRACK_EXPORT_CHUNK 1436 // one TCP segment at the default MSS
+#endif
+
+typedef enum {
+  TRACK_EXPORT_GPX = 0,
+  TRACK_EXPORT_GEOJSON,
+  TRACK_EXPORT_CSV,
+  TRACK_EXPORT_BIN, // raw sd_log_record_t
+} track_export_format_t;
+
+// Called with each filled chunk; a non-ESP_OK return aborts the export
+typedef esp_err_t (*track_export_sink_t)(const char *data, size_t len,
+                                         void *ctx);
+
+typedef struct {
+  uint32_t records;
+  uint32_t bytes;
+  uint32_t chunks;
+} track_export_stats_t;
+
+// Function prototypes
+bool track_export_parse_format(const char *name, track_export_format_t *fmt);
+const char *track_export_mime(track_export_format_t fmt);
+const char *track_export_extension(track_export_format_t fmt);
+esp_err_t track_export_stream(track_export_format_t fmt, uint32_t from,
+                              uint32_t to, track_export_sink_t sink,
+                              void *ctx, track_export_stats_t *stats);
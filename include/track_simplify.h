@@ -0,0 +1,54 @@
+#pragma once
+
+#include "sd_logger.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Streaming line simplification between the GPS and the log/MQTT sinks.
+// Opening-window Douglas-Peucker: a fix is dropped while every fix since the
+// last emitted one stays within the tolerance of the straight line from
+// that point to the newest fix. When one would not, the previous fix is
+// emitted and becomes the new start. Every dropped fix is therefore within
+// the tolerance of the emitted polyline, using a bounded window and
+// integer maths only (no RTOS dependencies).
+#ifndef TRACK_SIMPLIFY_TOL_M
+#define TRACK_SIMPLIFY_TOL_M 5
+#endif
+// Longest time without an emitted fix, so a moored boat still reports
+#ifndef TRACK_SIMPLIFY_KEEPALIVE_S
+#define TRACK_SIMPLIFY_KEEPALIVE_S 60
+#endif
+// Fixes held since the last emitted one; the window is cut when it fills
+#define TRACK_SIMPLIFY_WINDOW 64
+
+typedef struct {
+  uint32_t in;         // fixes accepted
+  uint32_t out;        // fixes emitted
+  uint32_t keepalives; // emitted only because of the keepalive
+  uint32_t window_cuts;
+} track_simplify_stats_t;
+
+typedef struct {
+  uint32_t tol;       // tolerance in 1e-7 degrees of latitude
+  uint32_t keepalive_s;
+  uint32_t cos_q16;   // longitude scale at the anchor
+  bool have_anchor;
+  uint8_t count;      // fixes in window
+  sd_log_record_t anchor; // last emitted fix
+  sd_log_record_t window[TRACK_SIMPLIFY_WINDOW];
+  track_simplify_stats_t stats;
+} track_simplifier_t;
+
+// Function prototypes
+void track_simplify_init(track_simplifier_t *s, uint32_t tol_m,
+                         uint32_t keepalive_s);
+// Feeds one fix (strictly increasing time, others are ignored). Returns true
+// and fills *out when a fix is emitted: the first fix, the fix before a
+// deviation, a full window or the keepalive. *out is older than *fix except
+// for the very first one.
+bool track_simplify_push(track_simplifier_t *s, const sd_log_record_t *fix,
+                         sd_log_record_t *out);
+// Emits the newest pending fix, if any, e.g. when the fix is lost
+bool track_simplify_flush(track_simplifier_t *s, sd_log_record_t *out);
+// Fixes in per fix out, x100 (250 = 2.5:1); 0 before the first output
+uint32_t track_simplify_ratio_x100(const track_simplify_stats_t *stats);
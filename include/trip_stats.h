@@ -0,0 +1,79 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Odometer and per-trip statistics, updated in O(1) per fix from the
+// filtered position and Doppler speed. Legs are measured with
+// geo_distance_cm() (within 0.015% of haversine below 70 degrees of
+// latitude) and only counted while moving, so GPS jitter at a mooring
+// does not creep into the odometer.
+// Short legs would add the position noise every second, so distance is
+// taken from the last counted point once it is TRIP_STATS_MIN_LEG_M away.
+// State is published by sequence lock and saved to NVS by
+// trip_stats_service(), never from the ingest task.
+#define TRIP_STATS_NVS_NAMESPACE "trip"
+#define TRIP_STATS_NVS_KEY "state"
+
+// Moving/stopped hysteresis on speed over ground
+#ifndef TRIP_STATS_START_CKMH
+#define TRIP_STATS_START_CKMH 300
+#endif
+#ifndef TRIP_STATS_STOP_CKMH
+#define TRIP_STATS_STOP_CKMH 150
+#endif
+#ifndef TRIP_STATS_MIN_LEG_M
+#define TRIP_STATS_MIN_LEG_M 25
+#endif
+// Fixes further apart than this do not add moving or stopped time; the
+// straight leg still counts unless it implies more than MAX_CKMH (a jump)
+#define TRIP_STATS_MAX_GAP_S 10
+#ifndef TRIP_STATS_MAX_CKMH
+#define TRIP_STATS_MAX_CKMH 20000
+#endif
+// Moving again after being stopped this long starts a new trip; 0 keeps
+// one trip until trip_stats_reset_trip()
+#ifndef TRIP_STATS_SPLIT_S
+#define TRIP_STATS_SPLIT_S 3600
+#endif
+// NVS is written at most this often while moving, and when stopping
+#ifndef TRIP_STATS_SAVE_S
+#define TRIP_STATS_SAVE_S 300
+#endif
+
+typedef struct {
+  uint32_t start;          // unix seconds of the first fix
+  uint32_t last;           // unix seconds of the last fix
+  uint32_t distance_cm;
+  uint32_t moving_s;
+  uint32_t stopped_s;
+  uint32_t max_speed_ckmh;
+  uint32_t min_speed_ckmh; // while moving; 0 before the first moving fix
+} trip_t;
+
+typedef struct {
+  uint64_t odometer_cm;
+  trip_t trip;
+  bool moving;
+  uint32_t fixes; // since boot
+} trip_stats_t;
+
+// Function prototypes
+// Loads the saved odometer and trip. Call before the ingest task starts.
+esp_err_t trip_stats_init(void);
+// Writer side (GPS ingest task), once per fix with strictly increasing time
+void trip_stats_update(uint32_t time, int32_t lat_e7, int32_t lon_e7,
+                       uint32_t speed_ckmh);
+// Any task: applied by the writer on the next fix
+void trip_stats_reset_trip(void);
+// Reader side (any task): consistent copy, returns the update count
+uint32_t trip_stats_get(trip_stats_t *out);
+// Average speed over moving time, 0.01 km/h
+uint32_t trip_stats_avg_ckmh(const trip_t *trip);
+// Low-priority task, periodically: saves to NVS when due
+void trip_stats_service(void);
+// {"odometer":km,"moving":bool,"trip":{...}}; returns the length, 0 if the
+// buffer is too small
+size_t trip_stats_json(const trip_stats_t *s, char *buf, size_t size);
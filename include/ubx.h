@@ -0,0 +1,79 @@
+#pragma once
+
+#include "gps_parser.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// UBX binary mode (u-blox receivers). Enable with -D GPS_UBX_MODE=1 in
+// platformio.ini build_flags; the default stays on 9600 baud NMEA.
+#ifndef GPS_UBX_MODE
+#define GPS_UBX_MODE 0
+#endif
+#ifndef GPS_UBX_BAUD
+#define GPS_UBX_BAUD 115200
+#endif
+#ifndef GPS_UBX_RATE_HZ
+#define GPS_UBX_RATE_HZ 10
+#endif
+
+#define UBX_SYNC_1 0xB5
+#define UBX_SYNC_2 0x62
+
+#define UBX_CLASS_NAV 0x01
+#define UBX_CLASS_CFG 0x06
+#define UBX_ID_NAV_DOP 0x04
+#define UBX_ID_NAV_PVT 0x07
+#define UBX_ID_CFG_PRT 0x00
+#define UBX_ID_CFG_MSG 0x01
+#define UBX_ID_CFG_RATE 0x08
+
+#define UBX_NAV_PVT_LEN 92
+#define UBX_NAV_DOP_LEN 18
+
+// Largest payload kept; longer frames are checksummed and skipped
+#define UBX_MAX_PAYLOAD 100
+// Header (6) + checksum (2)
+#define UBX_FRAME_OVERHEAD 8
+
+typedef void (*ubx_frame_cb_t)(uint8_t msg_class, uint8_t msg_id,
+                               const uint8_t *payload, uint16_t len,
+                               void *ctx);
+
+typedef struct {
+  uint32_t good;
+  uint32_t bad_checksum;
+  uint32_t skipped; // valid frames too long to buffer
+} ubx_decoder_stats_t;
+
+typedef struct {
+  uint8_t state;
+  uint8_t msg_class;
+  uint8_t msg_id;
+  uint16_t len;
+  uint16_t pos;
+  uint8_t ck_a;
+  uint8_t ck_b;
+  uint8_t payload[UBX_MAX_PAYLOAD];
+  ubx_decoder_stats_t stats;
+} ubx_decoder_t;
+
+void ubx_decoder_init(ubx_decoder_t *dec);
+void ubx_decoder_feed(ubx_decoder_t *dec, const uint8_t *data, size_t len,
+                      ubx_frame_cb_t cb, void *ctx);
+
+// Wrap a payload in sync, header and Fletcher checksum. Returns the frame
+// length, or 0 if `out` is too small.
+size_t ubx_build_frame(uint8_t msg_class, uint8_t msg_id,
+                       const uint8_t *payload, uint16_t len, uint8_t *out,
+                       size_t out_size);
+
+// Receiver setup: NAV-PVT and NAV-DOP every epoch at `rate_hz`, then
+// UART1 switched to UBX-only output at `baud`. The port change is last so
+// the earlier frames are still received at the old baud rate.
+size_t ubx_build_config(uint32_t baud, uint8_t rate_hz, uint8_t *out,
+                        size_t out_size);
+
+// Decode a NAV frame into `gps`. Returns true when `gps` was updated.
+bool ubx_apply_frame(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload,
+                     uint16_t len, gps_data_t *gps);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Web UI files, gzip-compressed in src/web_assets.c by tools/build_web.py
+// from web/, including the vendored Leaflet under /leaflet/. Files gzip
+// does not shrink (the PNGs) are stored as they are.
+typedef struct {
+  const char *path; // URI; "/" for index.html
+  const char *mime;
+  const char *cache_control;
+  const char *etag; // strong, quoted; from the uncompressed file
+  bool gzip;        // data is gzip-compressed
+  const uint8_t *data;
+  uint32_t len;
+} web_asset_t;
+
+extern const web_asset_t web_assets[];
+extern const uint32_t web_asset_count;
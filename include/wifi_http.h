@@ -1,6 +1,39 @@
 #pragma once
 
 #include "esp_err.h"
+#include <stdint.h>
+
+// Server-sent events on /api/stream: each fix epoch goes to every
+// subscriber as "data: <the /api/gps JSON>". The frame is built once per
+// fix on the httpd task and sent to each socket without blocking; a client
+// that cannot take it misses that fix, and one stuck for
+// HTTP_STREAM_STALL_MS is closed.
+#ifndef HTTP_STREAM_MAX_CLIENTS
+#define HTTP_STREAM_MAX_CLIENTS 4
+#endif
+#define HTTP_STREAM_STALL_MS 10000
+// EventSource reconnect delay sent to the browser
+#define HTTP_STREAM_RETRY_MS 3000
+
+typedef struct {
+  uint32_t clients;       // subscribed now
+  uint32_t opened;        // streams accepted
+  uint32_t refused;       // over HTTP_STREAM_MAX_CLIENTS
+  uint32_t closed;        // dropped on a send error or stall
+  uint32_t events;        // fan-outs
+  uint32_t skipped;       // frames a busy client missed
+  uint32_t bytes;         // sent to all clients
+  uint32_t build_failed;  // frames not sent: JSON larger than the buffer
+  uint32_t build_us;      // last frame serialisation
+  uint32_t per_client_us; // last fan-out send time per client
+  uint32_t max_send_us;   // worst fan-out send time, all clients
+} http_stream_stats_t;
 
 esp_err_t wifi_init_apsta(const char *ap_ssid, const char *ap_pass);
 esp_err_t http_server_start(void);
+// Ingest task, once per new fix epoch (gps_data_t.epoch); never blocks.
+// Epochs published while a fan-out is pending are merged into it.
+void http_stream_notify(void);
+// Written by the httpd task and copied unlocked: word-sized counters, so a
+// log line may at most mix two fan-outs
+void http_stream_get_stats(http_stream_stats_t *stats);
@@ -0,0 +1,96 @@
+#include "fixed_fmt.h"
+
+// Writes the decimal digits of v right-aligned ending at `end`, padding
+// with zeros up to `min_digits`; returns the first digit
+static char *put_digits(char *end, uint32_t v, uint8_t min_digits) {
+  uint8_t n = 0;
+  do {
+    *--end = (char)('0' + v % 10);
+    v /= 10;
+    n++;
+  } while (v != 0 || n < min_digits);
+  return end;
+}
+
+static int copy_out(char *buf, size_t size, const char *s, const char *end) {
+  size_t len = (size_t)(end - s);
+  if (len + 1 > size)
+    return 0;
+  for (size_t i = 0; i < len; i++)
+    buf[i] = s[i];
+  buf[len] = '\0';
+  return (int)len;
+}
+
+int fixed_fmt(char *buf, size_t size, int32_t v, uint8_t decimals) {
+  static const uint32_t pow10[] = {1,      10,      100,      1000,    10000,
+                                   100000, 1000000, 10000000, 100000000};
+  if (decimals > 8)
+    return 0;
+
+  char tmp[FIXED_FMT_MAX];
+  char *end = tmp + sizeof(tmp);
+  char *p = end;
+  uint32_t a = v < 0 ? (uint32_t)0 - (uint32_t)v : (uint32_t)v;
+  if (decimals > 0) {
+    p = put_digits(p, a % pow10[decimals], decimals);
+    *--p = '.';
+  }
+  p = put_digits(p, a / pow10[decimals], 1);
+  if (v < 0)
+    *--p = '-';
+  return copy_out(buf, size, p, end);
+}
+
+int fixed_fmt_round(char *buf, size_t size, int32_t v, uint8_t decimals,
+                    uint8_t shown) {
+  if (shown > decimals || decimals > 8)
+    return 0;
+  int64_t div = 1;
+  for (uint8_t i = shown; i < decimals; i++)
+    div *= 10;
+  int64_t a = v < 0 ? -(int64_t)v : v;
+  a = (a + div / 2) / div;
+  return fixed_fmt(buf, size, (int32_t)(v < 0 ? -a : a), shown);
+}
+
+int fixed_fmt_u32(char *buf, size_t size, uint32_t v) {
+  char tmp[10];
+  char *end = tmp + sizeof(tmp);
+  return copy_out(buf, size, put_digits(end, v, 1), end);
+}
+
+int fixed_fmt_iso8601(char *buf, size_t size, uint32_t unix_time) {
+  if (size < FIXED_FMT_ISO8601_LEN)
+    return 0;
+
+  // Civil date from days since 1970-01-01 (inverse of gps_unix_time)
+  uint32_t days = unix_time / 86400;
+  uint32_t secs = unix_time % 86400;
+  uint32_t z = days + 719468;
+  uint32_t era = z / 146097;
+  uint32_t doe = z - era * 146097;
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  uint32_t day = doy - (153 * mp + 2) / 5 + 1;
+  uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+  uint32_t year = yoe + era * 400 + (month <= 2);
+
+  char *end = buf + FIXED_FMT_ISO8601_LEN - 1;
+  *end = '\0';
+  char *p = end;
+  *--p = 'Z';
+  p = put_digits(p, secs % 60, 2);
+  *--p = ':';
+  p = put_digits(p, secs / 60 % 60, 2);
+  *--p = ':';
+  p = put_digits(p, secs / 3600, 2);
+  *--p = 'T';
+  p = put_digits(p, day, 2);
+  *--p = '-';
+  p = put_digits(p, month, 2);
+  *--p = '-';
+  put_digits(p, year % 10000, 4);
+  return FIXED_FMT_ISO8601_LEN - 1;
+}
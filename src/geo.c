@@ -0,0 +1,114 @@
+#include "geo.h"
+
+// cos(d degrees) in Q16, d = 0..90; cos(0) = 65536 does not fit and is
+// special-cased
+static const uint16_t cos_table[91] = {
+    65535, 65526, 65496, 65446, 65376, 65287, 65177, 65048, 64898, 64729,
+    64540, 64332, 64104, 63856, 63589, 63303, 62997, 62672, 62328, 61966,
+    61584, 61183, 60764, 60326, 59870, 59396, 58903, 58393, 57865, 57319,
+    56756, 56175, 55578, 54963, 54332, 53684, 53020, 52339, 51643, 50931,
+    50203, 49461, 48703, 47930, 47143, 46341, 45525, 44695, 43852, 42995,
+    42126, 41243, 40348, 39441, 38521, 37590, 36647, 35693, 34729, 33754,
+    32768, 31772, 30767, 29753, 28729, 27697, 26656, 25607, 24550, 23486,
+    22415, 21336, 20252, 19161, 18064, 16962, 15855, 14742, 13626, 12505,
+    11380, 10252, 9121,  7987,  6850,  5712,  4572,  3430,  2287,  1144,
+    0,
+};
+
+// atan(i / 64) in centidegrees, i = 0..64
+static const uint16_t atan_table[65] = {
+    0,    90,   179,  268,  358,  447,  536,  624,  713,  800,  888,
+    975,  1062, 1148, 1234, 1319, 1404, 1488, 1571, 1653, 1735, 1817,
+    1897, 1977, 2056, 2134, 2211, 2287, 2363, 2438, 2511, 2584, 2657,
+    2728, 2798, 2867, 2936, 3003, 3070, 3136, 3201, 3264, 3327, 3390,
+    3451, 3511, 3571, 3629, 3687, 3744, 3800, 3855, 3909, 3963, 4016,
+    4067, 4119, 4169, 4218, 4267, 4315, 4363, 4409, 4455, 4500,
+};
+
+uint32_t geo_cos_q16(int32_t lat_e7) {
+  uint32_t a = lat_e7 < 0 ? (uint32_t)0 - (uint32_t)lat_e7 : (uint32_t)lat_e7;
+  if (a >= 900000000u)
+    return 0;
+  uint32_t deg = a / 10000000u, frac = a % 10000000u;
+  // Linear between whole degrees: error below 3e-5
+  int32_t c0 = cos_table[deg], c1 = cos_table[deg + 1];
+  if (deg == 0)
+    c0 = 65536;
+  return (uint32_t)(c0 - (int32_t)((int64_t)(c0 - c1) * frac / 10000000));
+}
+
+uint32_t geo_isqrt64(uint64_t v) {
+  uint64_t r = 0, bit = 1ull << 62;
+  while (bit > v)
+    bit >>= 2;
+  while (bit) {
+    if (v >= r + bit) {
+      v -= r + bit;
+      r = (r >> 1) + bit;
+    } else {
+      r >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)r;
+}
+
+// atan(num / den) for 0 <= num <= den, den > 0
+static uint32_t atan_cdeg(uint64_t num, uint64_t den) {
+  // Q16 ratio, then table index (6 bits) and fraction (10 bits)
+  uint32_t t = (uint32_t)((num << 16) / den);
+  uint32_t i = t >> 10, frac = t & 0x3FF;
+  if (i >= 64)
+    return atan_table[64];
+  return atan_table[i] +
+         (((uint32_t)(atan_table[i + 1] - atan_table[i]) * frac + 512) >> 10);
+}
+
+uint16_t geo_heading_cdeg(int64_t east, int64_t north) {
+  uint64_t ae = east < 0 ? (uint64_t)-east : (uint64_t)east;
+  uint64_t an = north < 0 ? (uint64_t)-north : (uint64_t)north;
+  if (ae == 0 && an == 0)
+    return 0;
+  // Angle from the north/south axis within the quadrant
+  uint32_t a = ae <= an ? atan_cdeg(ae, an) : 9000 - atan_cdeg(an, ae);
+  uint32_t h;
+  if (north >= 0)
+    h = east >= 0 ? a : 36000 - a;
+  else
+    h = east >= 0 ? 18000 - a : 18000 + a;
+  return (uint16_t)(h % 36000);
+}
+
+// Leg on the local plane in 1e-7 degrees of latitude
+static void leg(int32_t lat1_e7, int32_t lon1_e7, int32_t lat2_e7,
+                int32_t lon2_e7, int64_t *east, int64_t *north) {
+  int64_t dlon = (int64_t)lon2_e7 - lon1_e7;
+  if (dlon > 1800000000)
+    dlon -= 3600000000LL;
+  else if (dlon < -1800000000)
+    dlon += 3600000000LL;
+  int32_t mid = (int32_t)(((int64_t)lat1_e7 + lat2_e7) / 2);
+  // Rounded, not truncated: a bias of half a unit is 0.1% of a 5 m leg
+  int64_t e = dlon * (int64_t)geo_cos_q16(mid);
+  *east = (e + (e < 0 ? -32768 : 32768)) / 65536;
+  *north = (int64_t)lat2_e7 - lat1_e7;
+}
+
+uint32_t geo_distance_cm(int32_t lat1_e7, int32_t lon1_e7, int32_t lat2_e7,
+                         int32_t lon2_e7) {
+  int64_t east, north;
+  leg(lat1_e7, lon1_e7, lat2_e7, lon2_e7, &east, &north);
+  uint64_t v = (uint64_t)(east * east + north * north);
+  uint64_t d = geo_isqrt64(v);
+  if (v - d * d > d) // nearest root: v >= (d + 1/2)^2
+    d++;
+  uint64_t cm = (d * GEO_CM_PER_E7_X100000 + 50000) / 100000;
+  return cm > UINT32_MAX ? UINT32_MAX : (uint32_t)cm;
+}
+
+uint16_t geo_bearing_cdeg(int32_t lat1_e7, int32_t lon1_e7, int32_t lat2_e7,
+                          int32_t lon2_e7) {
+  int64_t east, north;
+  leg(lat1_e7, lon1_e7, lat2_e7, lon2_e7, &east, &north);
+  return geo_heading_cdeg(east, north);
+}
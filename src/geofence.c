@@ -0,0 +1,431 @@
+#include "geofence.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "geo.h"
+#include "nmea.h"
+#include "nvs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "GEOFENCE";
+
+// Largest definition file read into RAM
+#define GEOFENCE_FILE_MAX 65536
+
+// Local plane: 1e-7 degree of latitude per unit (~1.1 cm) on both axes,
+// longitudes scaled by cos(latitude) at the centre of all fences. Exact
+// enough for harbour-sized fences and keeps every test in integers.
+typedef struct {
+  int32_t x, y;
+} gf_point_t;
+
+typedef struct {
+  int32_t x0, y0, x1, y1; // bounding box
+  int32_t cx, cy;         // circle centre
+  uint32_t r;             // circle radius
+  uint32_t first;         // polygon: first vertex in verts[]
+  uint16_t count;         // polygon vertices, 0 for a circle
+  char name[GEOFENCE_NAME_LEN];
+} fence_t;
+
+static fence_t *fences;
+static gf_point_t *verts;
+static uint16_t fence_count;
+static uint32_t vert_count;
+
+static int32_t ref_lat, ref_lon;
+static uint32_t cos_q16;
+
+// Grid index: cell c lists fence ids cell_ids[cell_start[c]..[c + 1])
+static int32_t grid_x0, grid_y0, cell_w, cell_h;
+static uint32_t cell_start[GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM + 1];
+static uint16_t *cell_ids;
+static uint32_t cell_fill[GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM]; // build
+
+static uint16_t inside[GEOFENCE_MAX_INSIDE]; // sorted fence ids
+static uint8_t inside_count;
+
+static geofence_event_cb_t event_cb;
+static void *event_ctx;
+static geofence_stats_t stats;
+
+static void project(int32_t lat_e7, int32_t lon_e7, int32_t *x, int32_t *y) {
+  *x = (int32_t)(((int64_t)(lon_e7 - ref_lon) * cos_q16) >> 16);
+  *y = lat_e7 - ref_lat;
+}
+
+static void free_index(void) {
+  free(fences);
+  free(verts);
+  free(cell_ids);
+  fences = NULL;
+  verts = NULL;
+  cell_ids = NULL;
+  fence_count = 0;
+  vert_count = 0;
+  inside_count = 0;
+}
+
+// Splits one line at commas into NMEA-style field views
+static int split_line(const char *line, size_t len, nmea_field_t *f, int max) {
+  int n = 0;
+  const char *end = line + len;
+  while (n < max) {
+    const char *start = line;
+    while (line < end && *line != ',')
+      line++;
+    size_t flen = (size_t)(line - start);
+    f[n].ptr = start;
+    f[n].len = flen > 255 ? 255 : (uint8_t)flen;
+    n++;
+    if (line >= end)
+      break;
+    line++;
+  }
+  return n;
+}
+
+static bool parse_deg(const nmea_field_t *f, int32_t *e7) {
+  return nmea_parse_fixed(f, 7, e7);
+}
+
+// Appends a fence in degrees (projected once everything is loaded)
+static bool parse_fence(const char *line, size_t len, size_t *fence_cap,
+                        size_t *vert_cap) {
+  // Static: a full line has more fields than a small task stack fits
+  static nmea_field_t f[GEOFENCE_LINE_MAX / 4];
+  int n = split_line(line, len, f, sizeof(f) / sizeof(f[0]));
+  if (n < 2 || f[0].len != 1 || fence_count >= GEOFENCE_MAX_FENCES)
+    return false;
+
+  fence_t fence = {0};
+  size_t name_len = f[1].len < GEOFENCE_NAME_LEN ? f[1].len
+                                                  : GEOFENCE_NAME_LEN - 1;
+  // Names go into JSON payloads verbatim
+  for (size_t i = 0; i < name_len; i++) {
+    char c = f[1].ptr[i];
+    fence.name[i] = (c == '"' || c == '\\' || (uint8_t)c < 0x20) ? '_' : c;
+  }
+
+  if (f[0].ptr[0] == 'C') {
+    uint32_t radius_m;
+    if (n != 5 || !parse_deg(&f[2], &fence.cy) ||
+        !parse_deg(&f[3], &fence.cx) || !nmea_parse_uint(&f[4], &radius_m) ||
+        radius_m == 0 || radius_m > 100000)
+      return false;
+    // 1e-7 degree of latitude is 1.1132 cm
+    fence.r = (uint32_t)((uint64_t)radius_m * 10000000u / 111320u);
+  } else if (f[0].ptr[0] == 'P') {
+    int pts = (n - 2) / 2;
+    if (pts < 3 || (n - 2) % 2)
+      return false;
+    if (vert_count + pts > *vert_cap) {
+      size_t cap = *vert_cap ? *vert_cap * 2 : 256;
+      while (cap < vert_count + pts)
+        cap *= 2;
+      gf_point_t *v = realloc(verts, cap * sizeof(*v));
+      if (!v)
+        return false;
+      verts = v;
+      *vert_cap = cap;
+    }
+    for (int i = 0; i < pts; i++) {
+      gf_point_t *v = &verts[vert_count + i];
+      if (!parse_deg(&f[2 + 2 * i], &v->y) ||
+          !parse_deg(&f[3 + 2 * i], &v->x))
+        return false;
+    }
+    fence.first = vert_count;
+    fence.count = (uint16_t)pts;
+    vert_count += pts;
+  } else {
+    return false;
+  }
+
+  if (fence_count >= *fence_cap) {
+    size_t cap = *fence_cap ? *fence_cap * 2 : 64;
+    fence_t *p = realloc(fences, cap * sizeof(*p));
+    if (!p)
+      return false;
+    fences = p;
+    *fence_cap = cap;
+  }
+  fences[fence_count++] = fence;
+  return true;
+}
+
+// Projects every fence around the centre of all of them and computes boxes
+static void project_all(void) {
+  int32_t lat0 = INT32_MAX, lat1 = INT32_MIN;
+  int32_t lon0 = INT32_MAX, lon1 = INT32_MIN;
+  for (uint16_t i = 0; i < fence_count; i++) {
+    const fence_t *fc = &fences[i];
+    uint32_t n = fc->count ? fc->count : 1;
+    for (uint32_t j = 0; j < n; j++) {
+      int32_t lat = fc->count ? verts[fc->first + j].y : fc->cy;
+      int32_t lon = fc->count ? verts[fc->first + j].x : fc->cx;
+      lat0 = lat < lat0 ? lat : lat0;
+      lat1 = lat > lat1 ? lat : lat1;
+      lon0 = lon < lon0 ? lon : lon0;
+      lon1 = lon > lon1 ? lon : lon1;
+    }
+  }
+  ref_lat = lat0 + (int32_t)(((int64_t)lat1 - lat0) / 2);
+  ref_lon = lon0 + (int32_t)(((int64_t)lon1 - lon0) / 2);
+  cos_q16 = geo_cos_q16(ref_lat);
+
+  for (uint16_t i = 0; i < fence_count; i++) {
+    fence_t *fc = &fences[i];
+    if (fc->count == 0) {
+      project(fc->cy, fc->cx, &fc->cx, &fc->cy);
+      fc->x0 = fc->cx - (int32_t)fc->r;
+      fc->x1 = fc->cx + (int32_t)fc->r;
+      fc->y0 = fc->cy - (int32_t)fc->r;
+      fc->y1 = fc->cy + (int32_t)fc->r;
+      continue;
+    }
+    fc->x0 = fc->y0 = INT32_MAX;
+    fc->x1 = fc->y1 = INT32_MIN;
+    for (uint32_t j = fc->first; j < fc->first + fc->count; j++) {
+      gf_point_t *v = &verts[j];
+      project(v->y, v->x, &v->x, &v->y);
+      fc->x0 = v->x < fc->x0 ? v->x : fc->x0;
+      fc->x1 = v->x > fc->x1 ? v->x : fc->x1;
+      fc->y0 = v->y < fc->y0 ? v->y : fc->y0;
+      fc->y1 = v->y > fc->y1 ? v->y : fc->y1;
+    }
+  }
+}
+
+static void cell_range(const fence_t *fc, int *cx0, int *cy0, int *cx1,
+                       int *cy1) {
+  *cx0 = (int)(((int64_t)fc->x0 - grid_x0) / cell_w);
+  *cy0 = (int)(((int64_t)fc->y0 - grid_y0) / cell_h);
+  *cx1 = (int)(((int64_t)fc->x1 - grid_x0) / cell_w);
+  *cy1 = (int)(((int64_t)fc->y1 - grid_y0) / cell_h);
+}
+
+// Two passes over the fence boxes: count per cell, then fill (CSR)
+static esp_err_t build_grid(void) {
+  int64_t x0 = INT32_MAX, y0 = INT32_MAX, x1 = INT32_MIN, y1 = INT32_MIN;
+  for (uint16_t i = 0; i < fence_count; i++) {
+    x0 = fences[i].x0 < x0 ? fences[i].x0 : x0;
+    y0 = fences[i].y0 < y0 ? fences[i].y0 : y0;
+    x1 = fences[i].x1 > x1 ? fences[i].x1 : x1;
+    y1 = fences[i].y1 > y1 ? fences[i].y1 : y1;
+  }
+  grid_x0 = (int32_t)x0;
+  grid_y0 = (int32_t)y0;
+  cell_w = (int32_t)((x1 - x0) / GEOFENCE_GRID_DIM + 1);
+  cell_h = (int32_t)((y1 - y0) / GEOFENCE_GRID_DIM + 1);
+
+  memset(cell_start, 0, sizeof(cell_start));
+  int cx0, cy0, cx1, cy1;
+  for (uint16_t i = 0; i < fence_count; i++) {
+    cell_range(&fences[i], &cx0, &cy0, &cx1, &cy1);
+    for (int cy = cy0; cy <= cy1; cy++)
+      for (int cx = cx0; cx <= cx1; cx++)
+        cell_start[cy * GEOFENCE_GRID_DIM + cx + 1]++;
+  }
+  for (int c = 0; c < GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM; c++)
+    cell_start[c + 1] += cell_start[c];
+
+  uint32_t total = cell_start[GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM];
+  cell_ids = malloc((total ? total : 1) * sizeof(*cell_ids));
+  if (!cell_ids)
+    return ESP_ERR_NO_MEM;
+  memcpy(cell_fill, cell_start, sizeof(cell_fill));
+  for (uint16_t i = 0; i < fence_count; i++) {
+    cell_range(&fences[i], &cx0, &cy0, &cx1, &cy1);
+    for (int cy = cy0; cy <= cy1; cy++)
+      for (int cx = cx0; cx <= cx1; cx++)
+        cell_ids[cell_fill[cy * GEOFENCE_GRID_DIM + cx]++] = i;
+  }
+  ESP_LOGI(TAG, "%u fences, %lu vertices, %lu grid entries, %ld x %ld cells",
+           fence_count, (unsigned long)vert_count, (unsigned long)total,
+           (long)cell_w, (long)cell_h);
+  return ESP_OK;
+}
+
+esp_err_t geofence_load_text(const char *text) {
+  free_index();
+  size_t fence_cap = 0, vert_cap = 0;
+  uint32_t line_no = 0, skipped = 0;
+
+  while (text && *text) {
+    const char *end = strchr(text, '\n');
+    size_t len = end ? (size_t)(end - text) : strlen(text);
+    line_no++;
+    size_t l = len;
+    while (l > 0 && (text[l - 1] == '\r' || text[l - 1] == ' '))
+      l--;
+    if (l > 0 && text[0] != '#' &&
+        (l >= GEOFENCE_LINE_MAX ||
+         !parse_fence(text, l, &fence_cap, &vert_cap))) {
+      ESP_LOGW(TAG, "Skipping line %lu", (unsigned long)line_no);
+      skipped++;
+    }
+    text += len + (end ? 1 : 0);
+  }
+
+  stats = (geofence_stats_t){.fences = fence_count};
+  if (fence_count == 0)
+    return ESP_ERR_NOT_FOUND;
+  project_all();
+  esp_err_t ret = build_grid();
+  if (ret != ESP_OK) {
+    free_index();
+    stats.fences = 0;
+  }
+  return ret;
+}
+
+static char *read_file(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return NULL;
+  char *text = NULL;
+  long size = -1;
+  if (fseek(f, 0, SEEK_END) == 0)
+    size = ftell(f);
+  if (size > 0 && size <= GEOFENCE_FILE_MAX && fseek(f, 0, SEEK_SET) == 0 &&
+      (text = malloc((size_t)size + 1)) != NULL) {
+    size_t n = fread(text, 1, (size_t)size, f);
+    text[n] = '\0';
+  }
+  fclose(f);
+  return text;
+}
+
+static char *read_nvs(void) {
+  nvs_handle_t h;
+  if (nvs_open(GEOFENCE_NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK)
+    return NULL;
+  size_t len = 0;
+  char *text = NULL;
+  if (nvs_get_str(h, GEOFENCE_NVS_KEY, NULL, &len) == ESP_OK && len > 1 &&
+      (text = malloc(len)) != NULL &&
+      nvs_get_str(h, GEOFENCE_NVS_KEY, text, &len) != ESP_OK) {
+    free(text);
+    text = NULL;
+  }
+  nvs_close(h);
+  return text;
+}
+
+esp_err_t geofence_init(void) {
+  const char *source = GEOFENCE_FILE;
+  char *text = read_file(GEOFENCE_FILE);
+  if (!text) {
+    source = "NVS";
+    text = read_nvs();
+  }
+  if (!text) {
+    ESP_LOGI(TAG, "No fences defined");
+    return ESP_ERR_NOT_FOUND;
+  }
+  esp_err_t ret = geofence_load_text(text);
+  free(text);
+  ESP_LOGI(TAG, "Loaded from %s: %s", source, esp_err_to_name(ret));
+  return ret;
+}
+
+void geofence_set_callback(geofence_event_cb_t cb, void *ctx) {
+  event_cb = cb;
+  event_ctx = ctx;
+}
+
+// Crossing number with exact integer edge tests: a horizontal ray to +x
+// flips `in` at every edge it crosses
+static bool polygon_contains(const fence_t *fc, int32_t px, int32_t py) {
+  const gf_point_t *v = &verts[fc->first];
+  bool in = false;
+  for (uint16_t i = 0, j = fc->count - 1; i < fc->count; j = i++) {
+    if ((v[i].y > py) == (v[j].y > py))
+      continue;
+    // px < x of the edge at py, without dividing
+    int64_t lhs = (int64_t)(v[j].x - v[i].x) * (py - v[i].y);
+    int64_t rhs = (int64_t)(px - v[i].x) * (v[j].y - v[i].y);
+    if (v[j].y > v[i].y ? lhs > rhs : lhs < rhs)
+      in = !in;
+  }
+  return in;
+}
+
+static bool fence_contains(const fence_t *fc, int32_t x, int32_t y) {
+  if (x < fc->x0 || x > fc->x1 || y < fc->y0 || y > fc->y1)
+    return false;
+  if (fc->count)
+    return polygon_contains(fc, x, y);
+  int64_t dx = (int64_t)x - fc->cx, dy = (int64_t)y - fc->cy;
+  return dx * dx + dy * dy <= (int64_t)fc->r * fc->r;
+}
+
+static void emit(uint16_t id, geofence_transition_t tr, int32_t lat_e7,
+                 int32_t lon_e7, uint32_t time) {
+  stats.events++;
+  ESP_LOGI(TAG, "%s %s", tr == GEOFENCE_ENTER ? "Enter" : "Exit",
+           fences[id].name);
+  if (!event_cb)
+    return;
+  geofence_event_t ev = {
+      .id = id,
+      .name = fences[id].name,
+      .transition = tr,
+      .time = time,
+      .lat_e7 = lat_e7,
+      .lon_e7 = lon_e7,
+  };
+  event_cb(&ev, event_ctx);
+}
+
+void geofence_update(int32_t lat_e7, int32_t lon_e7, uint32_t time) {
+  if (!fence_count)
+    return;
+  int64_t start = esp_timer_get_time();
+  int32_t x, y;
+  project(lat_e7, lon_e7, &x, &y);
+
+  // Only the fix's cell can hold fences containing it; cell lists are in
+  // id order, so `now` comes out sorted
+  uint16_t now[GEOFENCE_MAX_INSIDE];
+  uint8_t now_count = 0;
+  int64_t gx = ((int64_t)x - grid_x0) / cell_w;
+  int64_t gy = ((int64_t)y - grid_y0) / cell_h;
+  if (x >= grid_x0 && y >= grid_y0 && gx < GEOFENCE_GRID_DIM &&
+      gy < GEOFENCE_GRID_DIM) {
+    uint32_t c = (uint32_t)(gy * GEOFENCE_GRID_DIM + gx);
+    for (uint32_t i = cell_start[c]; i < cell_start[c + 1]; i++) {
+      uint16_t id = cell_ids[i];
+      stats.candidates++;
+      if (fence_contains(&fences[id], x, y) &&
+          now_count < GEOFENCE_MAX_INSIDE)
+        now[now_count++] = id;
+    }
+  }
+
+  // Merge the sorted old and new sets into exit and enter events
+  uint8_t a = 0, b = 0;
+  while (a < inside_count || b < now_count) {
+    if (b == now_count || (a < inside_count && inside[a] < now[b])) {
+      emit(inside[a++], GEOFENCE_EXIT, lat_e7, lon_e7, time);
+    } else if (a == inside_count || now[b] < inside[a]) {
+      emit(now[b++], GEOFENCE_ENTER, lat_e7, lon_e7, time);
+    } else {
+      a++;
+      b++;
+    }
+  }
+  memcpy(inside, now, now_count * sizeof(now[0]));
+  inside_count = now_count;
+
+  uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+  stats.fixes++;
+  stats.inside = now_count;
+  stats.last_us = us;
+  if (us > stats.max_us)
+    stats.max_us = us;
+}
+
+void geofence_get_stats(geofence_stats_t *out) { *out = stats; }
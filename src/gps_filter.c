@@ -0,0 +1,229 @@
+#include "gps_filter.h"
+#include "esp_timer.h"
+#include "fixed_fmt.h"
+#include "seqlock.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// 1e-7 degree of latitude is 1.1132 cm
+#define E7_PER_M 89.8311f
+#define DEG_PER_RAD (180.0f / (float)M_PI)
+
+// Position and velocity along one axis with their covariance
+typedef struct {
+  float p, v;
+  float pp, pv, vv;
+} axis_t;
+
+static axis_t north, east;
+static int32_t origin_lat, origin_lon; // plane origin, e7
+static float e7_per_m_lon;
+static int64_t last_us;
+static bool running;
+static int64_t outlier_since_us; // first of the rejected run, -1 if none
+static gps_filter_stats_t stats;
+
+// Published state, see seqlock.h
+static gps_filter_state_t state;
+static uint32_t state_seq;
+
+static void axis_predict(axis_t *a, float dt, float q) {
+  float dt2 = dt * dt;
+  a->p += a->v * dt;
+  a->pp += dt * (2.0f * a->pv + dt * a->vv) + q * dt2 * dt / 3.0f;
+  a->pv += dt * a->vv + q * dt2 / 2.0f;
+  a->vv += q * dt;
+}
+
+// Scalar updates, H = [1 0] and [0 1]; P = (I - KH)P written out
+static void axis_update_pos(axis_t *a, float y, float s) {
+  float kp = a->pp / s, kv = a->pv / s;
+  float pp = a->pp, pv = a->pv;
+  a->p += kp * y;
+  a->v += kv * y;
+  a->pp -= kp * pp;
+  a->pv -= kp * pv;
+  a->vv -= kv * pv;
+}
+
+static void axis_update_vel(axis_t *a, float z, float r) {
+  float s = a->vv + r, y = z - a->v;
+  float kp = a->pv / s, kv = a->vv / s;
+  float pv = a->pv, vv = a->vv;
+  a->p += kp * y;
+  a->v += kv * y;
+  a->pp -= kp * pv;
+  a->pv -= kp * vv;
+  a->vv -= kv * vv;
+}
+
+static void set_origin(int32_t lat_e7, int32_t lon_e7) {
+  origin_lat = lat_e7;
+  origin_lon = lon_e7;
+  e7_per_m_lon = E7_PER_M / cosf((float)lat_e7 * 1e-7f / DEG_PER_RAD);
+}
+
+static void measured_velocity(const gps_filter_meas_t *m, float *vn,
+                              float *ve) {
+  float speed = (float)m->speed_ckmh / 360.0f;
+  float course = (float)m->course_cdeg * 0.01f / DEG_PER_RAD;
+  *vn = speed * cosf(course);
+  *ve = speed * sinf(course);
+}
+
+static float position_var(const gps_filter_meas_t *m) {
+  float hdop = m->hdop_e2 ? (float)m->hdop_e2 * 0.01f : 2.0f;
+  if (hdop < 0.5f)
+    hdop = 0.5f;
+  float sigma = hdop * GPS_FILTER_UERE_M;
+  return sigma * sigma;
+}
+
+static void restart(const gps_filter_meas_t *m) {
+  float r = position_var(m);
+  float vn = 0, ve = 0, rv = 100.0f; // unknown velocity: 10 m/s sigma
+  if (m->has_velocity) {
+    measured_velocity(m, &vn, &ve);
+    rv = GPS_FILTER_SPEED_SIGMA * GPS_FILTER_SPEED_SIGMA;
+  }
+  set_origin(m->lat_e7, m->lon_e7);
+  north = (axis_t){.v = vn, .pp = r, .vv = rv};
+  east = (axis_t){.v = ve, .pp = r, .vv = rv};
+  outlier_since_us = -1;
+  running = true;
+  stats.resets++;
+}
+
+// Keeps the offsets small so single precision stays exact enough
+static void reanchor(void) {
+  if (fabsf(north.p) < GPS_FILTER_REANCHOR_M &&
+      fabsf(east.p) < GPS_FILTER_REANCHOR_M)
+    return;
+  int32_t dlat = (int32_t)lroundf(north.p * E7_PER_M);
+  int32_t dlon = (int32_t)lroundf(east.p * e7_per_m_lon);
+  north.p -= (float)dlat / E7_PER_M;
+  east.p -= (float)dlon / e7_per_m_lon;
+  set_origin(origin_lat + dlat, origin_lon + dlon);
+}
+
+static void publish(int64_t time_us) {
+  gps_filter_state_t next = {
+      .valid = running,
+      .time_us = time_us,
+      .lat_e7 = origin_lat + (int32_t)lroundf(north.p * E7_PER_M),
+      .lon_e7 = origin_lon + (int32_t)lroundf(east.p * e7_per_m_lon),
+      .vn = north.v,
+      .ve = east.v,
+      .speed_ckmh = (uint32_t)lroundf(
+          sqrtf(north.v * north.v + east.v * east.v) * 360.0f),
+      .sigma_cm = (uint32_t)lroundf(sqrtf(north.pp + east.pp) * 100.0f),
+      .e7_per_m_lon = e7_per_m_lon,
+  };
+  int32_t course = (int32_t)lroundf(atan2f(east.v, north.v) * DEG_PER_RAD *
+                                    100.0f);
+  next.course_cdeg = (uint16_t)((course + 36000) % 36000);
+
+  seqlock_write(&state_seq, &state, &next, sizeof(state));
+}
+
+bool gps_filter_update(const gps_filter_meas_t *m, gps_filter_state_t *out) {
+  int64_t start = esp_timer_get_time();
+  bool accepted = true;
+  int64_t dt_us = m->time_us - last_us;
+
+  if (!running || dt_us > GPS_FILTER_MAX_GAP_US || dt_us < 0) {
+    restart(m);
+  } else {
+    float dt = (float)dt_us * 1e-6f;
+    float q = GPS_FILTER_ACCEL * GPS_FILTER_ACCEL;
+    axis_predict(&north, dt, q);
+    axis_predict(&east, dt, q);
+
+    float r = position_var(m);
+    float yn =
+        (float)((int64_t)m->lat_e7 - origin_lat) / E7_PER_M - north.p;
+    float ye =
+        (float)((int64_t)m->lon_e7 - origin_lon) / e7_per_m_lon - east.p;
+    float sn = north.pp + r, se = east.pp + r;
+    if (yn * yn / sn + ye * ye / se > GPS_FILTER_GATE) {
+      accepted = false;
+      stats.outliers++;
+      if (outlier_since_us < 0)
+        outlier_since_us = m->time_us;
+      if (m->time_us - outlier_since_us >= GPS_FILTER_OUTLIER_RESET_US) {
+        restart(m);
+        accepted = true;
+      }
+    } else {
+      outlier_since_us = -1;
+      axis_update_pos(&north, yn, sn);
+      axis_update_pos(&east, ye, se);
+      if (m->has_velocity) {
+        float vn, ve, rv = GPS_FILTER_SPEED_SIGMA * GPS_FILTER_SPEED_SIGMA;
+        measured_velocity(m, &vn, &ve);
+        axis_update_vel(&north, vn, rv);
+        axis_update_vel(&east, ve, rv);
+      }
+      reanchor();
+    }
+  }
+  last_us = m->time_us;
+  publish(m->time_us);
+  if (out)
+    gps_filter_get(out);
+
+  stats.updates++;
+  stats.last_us = (uint32_t)(esp_timer_get_time() - start);
+  if (stats.last_us > stats.max_us)
+    stats.max_us = stats.last_us;
+  return accepted;
+}
+
+void gps_filter_reset(void) {
+  running = false;
+  publish(last_us);
+}
+
+uint32_t gps_filter_get(gps_filter_state_t *out) {
+  return seqlock_read(&state_seq, out, &state, sizeof(*out));
+}
+
+void gps_filter_position_at(const gps_filter_state_t *s, int64_t now_us,
+                            int32_t *lat_e7, int32_t *lon_e7) {
+  int64_t dt_us = now_us - s->time_us;
+  if (dt_us < 0)
+    dt_us = 0;
+  if (dt_us > GPS_FILTER_DR_MAX_US)
+    dt_us = GPS_FILTER_DR_MAX_US;
+  float dt = (float)dt_us * 1e-6f;
+  *lat_e7 = s->lat_e7 + (int32_t)lroundf(s->vn * dt * E7_PER_M);
+  *lon_e7 = s->lon_e7 + (int32_t)lroundf(s->ve * dt * s->e7_per_m_lon);
+}
+
+void gps_filter_json(char *buf, size_t size, int64_t now_us) {
+  gps_filter_state_t filt;
+  gps_filter_get(&filt);
+  buf[0] = '\0';
+  if (!filt.valid)
+    return;
+  int32_t lat_e7, lon_e7;
+  gps_filter_position_at(&filt, now_us, &lat_e7, &lon_e7);
+  char lat[FIXED_FMT_MAX], lon[FIXED_FMT_MAX], speed[FIXED_FMT_MAX];
+  char course[FIXED_FMT_MAX], sigma[FIXED_FMT_MAX];
+  fixed_fmt(lat, sizeof(lat), lat_e7, 7);
+  fixed_fmt(lon, sizeof(lon), lon_e7, 7);
+  fixed_fmt(speed, sizeof(speed), (int32_t)filt.speed_ckmh, 2);
+  fixed_fmt_round(course, sizeof(course), filt.course_cdeg, 2, 1);
+  fixed_fmt_round(sigma, sizeof(sigma), (int32_t)filt.sigma_cm, 2, 1);
+  int len = snprintf(buf, size,
+                     ",\"filtered\":{\"latitude\":%s,\"longitude\":%s,"
+                     "\"speed\":%s,\"course\":%s,\"sigma\":%s}",
+                     lat, lon, speed, course, sigma);
+  if (len < 0 || (size_t)len >= size)
+    buf[0] = '\0';
+}
+
+void gps_filter_get_stats(gps_filter_stats_t *stats_out) {
+  *stats_out = stats;
+}
@@ -1,136 +1,347 @@
 #include "gps_parser.h"
 #include "esp_log.h"
-#include <stdio.h>
-#include <stdlib.h>
+#include "nmea.h"
+#include "seqlock.h"
 #include <string.h>
 
 static const char *TAG = "GPS_PARSER";
+
+// Working copy, touched only by the ingest task
 static gps_data_t gps_data = {0};
 
-static double parse_coordinate(const char *coord_str, const char *direction) {
-  if (!coord_str || strlen(coord_str) < 4)
-    return 0.0;
+// The epoch being assembled: NMEA time in ms since midnight and the
+// sentences of it parsed so far
+#define EPOCH_GGA 0x01
+#define EPOCH_RMC 0x02
+#define EPOCH_COMPLETE (EPOCH_GGA | EPOCH_RMC)
+static uint32_t epoch_time_ms = UINT32_MAX;
+static uint8_t epoch_parts;
 
-  double coord = atof(coord_str);
-  int degrees = (int)(coord / 100);
-  double minutes = coord - (degrees * 100);
-  double decimal_degrees = degrees + (minutes / 60.0);
+// GSV field 3 per constellation, summed into sats_in_view; sats[] only
+// keeps the first GPS_MAX_SATS_STORED of them
+#define GSV_CONSTELLATIONS 6
+typedef struct {
+  char talker;
+  uint8_t in_view;
+} gsv_count_t;
+static gsv_count_t gsv_counts[GSV_CONSTELLATIONS];
 
-  // Apply direction (N/E = positive, S/W = negative)
-  if (direction && (*direction == 'S' || *direction == 'W')) {
-    decimal_degrees = -decimal_degrees;
-  }
+// Published copy, see seqlock.h
+static gps_data_t gps_published = {0};
+static uint32_t gps_seq = 0;
 
-  return decimal_degrees;
+static void copy_field6(char *dst, const nmea_field_t *f) {
+  if (f->len >= 6) {
+    memcpy(dst, f->ptr, 6);
+    dst[6] = '\0';
+  }
 }
 
-static void parse_gga(const char *sentence) {
-  // $GPGGA,time,lat,N/S,lon,E/W,quality,num_sat,hdop,alt,M,alt_geoid,M,dgps_age,dgps_id*checksum
-  char *tokens[15];
-  char *str = strdup(sentence);
-  char *token = strtok(str, ",");
-  int i = 0;
+// hhmmss[.sss] into timestamp and time_ms; *ms_of_day keys the epoch
+static bool parse_time(const nmea_field_t *f, uint32_t *ms_of_day) {
+  int32_t t;
+  if (f->len < 6 || !nmea_parse_fixed(f, 3, &t) || t < 0)
+    return false;
+  uint32_t hms = (uint32_t)t / 1000;
+  copy_field6(gps_data.timestamp, f);
+  gps_data.time_ms = (uint16_t)(t % 1000);
+  *ms_of_day = (hms / 10000 * 3600 + hms / 100 % 100 * 60 + hms % 100) *
+                   1000u +
+               gps_data.time_ms;
+  return true;
+}
 
-  while (token && i < 15) {
-    tokens[i++] = token;
-    token = strtok(NULL, ",");
+// GGA carries the position and RMC the speed, course and date; the epoch
+// counts once both of one time are in, in either order. A sentence of a
+// new time starts the next epoch.
+static void epoch_part(uint32_t ms_of_day, uint8_t part) {
+  if (ms_of_day != epoch_time_ms) {
+    epoch_time_ms = ms_of_day;
+    epoch_parts = 0;
   }
+  if (epoch_parts == EPOCH_COMPLETE)
+    return;
+  epoch_parts |= part;
+  if (epoch_parts == EPOCH_COMPLETE)
+    gps_data.epoch++;
+}
 
-  if (i >= 15) {
-    // Parse latitude
-    if (strlen(tokens[2]) > 0) {
-      gps_data.latitude = parse_coordinate(tokens[2], tokens[3]);
-    }
+static uint16_t dop_e2(int32_t v) {
+  return v < 0 ? 0 : v > 9999 ? 9999 : (uint16_t)v;
+}
 
-    // Parse longitude
-    if (strlen(tokens[4]) > 0) {
-      gps_data.longitude = parse_coordinate(tokens[4], tokens[5]);
-    }
+static uint16_t course_cdeg(int32_t v) {
+  v %= 36000;
+  return (uint16_t)(v < 0 ? v + 36000 : v);
+}
 
-    // Parse quality (0=invalid, 1=GPS, 2=DGPS)
-    int quality = atoi(tokens[6]);
-    gps_data.valid = (quality > 0);
+static void parse_gga(const nmea_field_t *f, int n) {
+  // $xxGGA,time,lat,N/S,lon,E/W,quality,num_sat,hdop,alt,M,alt_geoid,M,dgps_age,dgps_id*checksum
+  if (n < 10)
+    return;
 
-    // Parse number of satellites
-    gps_data.satellites = atoi(tokens[7]);
+  int32_t lat_e7, lon_e7;
+  if (nmea_parse_coord(&f[2], &f[3], &lat_e7))
+    gps_data.lat_e7 = lat_e7;
+  if (nmea_parse_coord(&f[4], &f[5], &lon_e7))
+    gps_data.lon_e7 = lon_e7;
 
-    // Parse altitude
-    if (strlen(tokens[9]) > 0) {
-      gps_data.altitude = atof(tokens[9]);
-    }
+  // Parse quality (0=invalid, 1=GPS, 2=DGPS)
+  uint32_t quality = 0;
+  nmea_parse_uint(&f[6], &quality);
+  gps_data.valid = (quality > 0);
 
-    // Parse timestamp
-    if (strlen(tokens[1]) >= 6) {
-      strncpy(gps_data.timestamp, tokens[1], 6);
-      gps_data.timestamp[6] = '\0';
-    }
-  }
+  uint32_t sats = 0;
+  nmea_parse_uint(&f[7], &sats);
+  gps_data.satellites = (uint8_t)sats;
+
+  int32_t hdop_e2;
+  if (nmea_parse_fixed(&f[8], 2, &hdop_e2))
+    gps_data.hdop_e2 = dop_e2(hdop_e2);
 
-  free(str);
+  int32_t alt_cm;
+  if (nmea_parse_fixed(&f[9], 2, &alt_cm))
+    gps_data.alt_cm = alt_cm;
+
+  uint32_t ms_of_day;
+  if (parse_time(&f[1], &ms_of_day))
+    epoch_part(ms_of_day, EPOCH_GGA);
 }
 
-static void parse_rmc(const char *sentence) {
-  // $GPRMC,time,status,lat,N/S,lon,E/W,speed,course,date,mag_var,E/W*checksum
-  char *tokens[13];
-  char *str = strdup(sentence);
-  char *token = strtok(str, ",");
-  int i = 0;
+static void parse_rmc(const nmea_field_t *f, int n) {
+  // $xxRMC,time,status,lat,N/S,lon,E/W,speed,course,date,mag_var,E/W*checksum
+  if (n < 10)
+    return;
 
-  while (token && i < 13) {
-    tokens[i++] = token;
-    token = strtok(NULL, ",");
-  }
+  // Parse status (A=active, V=void)
+  gps_data.valid = (f[2].len > 0 && f[2].ptr[0] == 'A');
 
-  if (i >= 13) {
-    // Parse status (A=active, V=void)
-    gps_data.valid = (tokens[2][0] == 'A');
+  // Speed in knots with 3 decimals, converted to 0.01 km/h (1.852 km/h per
+  // knot)
+  int32_t knots_e3;
+  if (nmea_parse_fixed(&f[7], 3, &knots_e3) && knots_e3 >= 0)
+    gps_data.speed_ckmh =
+        (uint32_t)(((uint64_t)knots_e3 * 1852 + 5000) / 10000);
 
-    // Parse speed (knots)
-    if (strlen(tokens[7]) > 0) {
-      gps_data.speed = atof(tokens[7]) * 1.852; // Convert knots to km/h
-    }
+  int32_t course_e2;
+  if (nmea_parse_fixed(&f[8], 2, &course_e2))
+    gps_data.course_cdeg = course_cdeg(course_e2);
+
+  copy_field6(gps_data.date, &f[9]);
+
+  uint32_t ms_of_day;
+  if (parse_time(&f[1], &ms_of_day))
+    epoch_part(ms_of_day, EPOCH_RMC);
+}
+
+static void parse_gsa(const nmea_field_t *f, int n) {
+  // $xxGSA,mode,fix_type,prn1..prn12,pdop,hdop,vdop[,system_id]*checksum
+  if (n < 18)
+    return;
+
+  uint32_t fix_type;
+  if (nmea_parse_uint(&f[2], &fix_type))
+    gps_data.fix_type = (uint8_t)fix_type;
 
-    // Parse course
-    if (strlen(tokens[8]) > 0) {
-      gps_data.course = atof(tokens[8]);
+  int32_t dop;
+  if (nmea_parse_fixed(&f[15], 2, &dop))
+    gps_data.pdop_e2 = dop_e2(dop);
+  if (nmea_parse_fixed(&f[16], 2, &dop))
+    gps_data.hdop_e2 = dop_e2(dop);
+  if (nmea_parse_fixed(&f[17], 2, &dop))
+    gps_data.vdop_e2 = dop_e2(dop);
+}
+
+static void update_in_view(char talker, uint32_t in_view) {
+  uint32_t total = 0;
+  bool found = false;
+  for (int i = 0; i < GSV_CONSTELLATIONS; i++) {
+    gsv_count_t *c = &gsv_counts[i];
+    if (!found && (c->talker == talker || !c->talker)) {
+      c->talker = talker;
+      c->in_view = in_view > 255 ? 255 : (uint8_t)in_view;
+      found = true;
     }
+    total += c->in_view;
+  }
+  gps_data.sats_in_view = total > 255 ? 255 : (uint8_t)total;
+}
+
+static void parse_gsv(const nmea_field_t *f, int n) {
+  // $xxGSV,num_msgs,msg_num,sats_in_view,{prn,elev,azimuth,snr}x1..4*checksum
+  if (n < 4)
+    return;
+
+  char talker = f[0].ptr[1];
+  uint32_t msg_num;
+  if (!nmea_parse_uint(&f[2], &msg_num))
+    return;
 
-    // Parse date
-    if (strlen(tokens[9]) >= 6) {
-      strncpy(gps_data.date, tokens[9], 6);
-      gps_data.date[6] = '\0';
+  uint32_t in_view;
+  if (nmea_parse_uint(&f[3], &in_view))
+    update_in_view(talker, in_view);
+
+  // First message of a cycle replaces this constellation's entries
+  if (msg_num == 1) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < gps_data.sats_stored; i++) {
+      if (gps_data.sats[i].talker != talker)
+        gps_data.sats[kept++] = gps_data.sats[i];
     }
+    gps_data.sats_stored = kept;
   }
 
-  free(str);
+  // Each satellite is a full group of 4 fields; a trailing NMEA 4.1 signal
+  // id is left over and ignored
+  for (int i = 4; i + 3 < n; i += 4) {
+    uint32_t prn, snr = 0;
+    if (!nmea_parse_uint(&f[i], &prn))
+      continue;
+    nmea_parse_uint(&f[i + 3], &snr);
+    if (gps_data.sats_stored >= GPS_MAX_SATS_STORED)
+      break;
+    gps_sat_t *sat = &gps_data.sats[gps_data.sats_stored++];
+    sat->talker = talker;
+    sat->prn = (uint8_t)prn;
+    sat->snr = (uint8_t)snr;
+  }
 }
 
-void gps_parse_nmea(const char *nmea_sentence) {
-  if (!nmea_sentence || strlen(nmea_sentence) < 6)
+static void parse_vtg(const nmea_field_t *f, int n) {
+  // $xxVTG,course_true,T,course_mag,M,speed_knots,N,speed_kmh,K[,mode]*checksum
+  if (n < 9)
+    return;
+
+  int32_t course_e2;
+  if (nmea_parse_fixed(&f[1], 2, &course_e2))
+    gps_data.course_cdeg = course_cdeg(course_e2);
+
+  int32_t kmh_e3;
+  if (nmea_parse_fixed(&f[7], 3, &kmh_e3) && kmh_e3 >= 0)
+    gps_data.speed_ckmh = (uint32_t)(kmh_e3 + 5) / 10;
+}
+
+static void put_two_digits(char *dst, uint32_t v) {
+  dst[0] = (char)('0' + v / 10 % 10);
+  dst[1] = (char)('0' + v % 10);
+}
+
+static void parse_zda(const nmea_field_t *f, int n) {
+  // $xxZDA,time,day,month,year,tz_hours,tz_minutes*checksum
+  if (n < 5)
     return;
 
-  // Check for valid NMEA sentence
-  if (nmea_sentence[0] != '$')
+  uint32_t ms_of_day;
+  parse_time(&f[1], &ms_of_day);
+
+  uint32_t day, month, year;
+  if (nmea_parse_uint(&f[2], &day) && nmea_parse_uint(&f[3], &month) &&
+      nmea_parse_uint(&f[4], &year)) {
+    // DDMMYY like RMC; snprintf() here cost more than the rest of the parse
+    put_two_digits(gps_data.date, day);
+    put_two_digits(gps_data.date + 2, month);
+    put_two_digits(gps_data.date + 4, year);
+    gps_data.date[6] = '\0';
+  }
+}
+
+// Sentences are matched on the 3-letter formatter only, so $GP, $GN, $GL,
+// $GA and $GB talkers share one parser. Lookup cost does not depend on
+// which talker sent the sentence.
+#define SENTENCE_ID(a, b, c)                                                  \
+  (((uint32_t)(a) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(c))
+
+typedef struct {
+  uint32_t id;
+  void (*parse)(const nmea_field_t *f, int n);
+} sentence_handler_t;
+
+static const sentence_handler_t sentence_handlers[] = {
+    {SENTENCE_ID('G', 'G', 'A'), parse_gga},
+    {SENTENCE_ID('R', 'M', 'C'), parse_rmc},
+    {SENTENCE_ID('G', 'S', 'A'), parse_gsa},
+    {SENTENCE_ID('G', 'S', 'V'), parse_gsv},
+    {SENTENCE_ID('V', 'T', 'G'), parse_vtg},
+    {SENTENCE_ID('Z', 'D', 'A'), parse_zda},
+};
+
+void gps_parse_nmea(const char *nmea_sentence) {
+  if (!nmea_sentence || nmea_sentence[0] != '$')
     return;
 
   // Find checksum
-  char *asterisk = strchr(nmea_sentence, '*');
-  if (!asterisk)
+  if (!strchr(nmea_sentence, '*'))
     return;
 
   ESP_LOGD(TAG, "Parsing: %s", nmea_sentence);
 
-  // Parse different sentence types
-  if (strncmp(nmea_sentence, "$GPGGA", 6) == 0) {
-    parse_gga(nmea_sentence);
-  } else if (strncmp(nmea_sentence, "$GPRMC", 6) == 0) {
-    parse_rmc(nmea_sentence);
+  nmea_field_t fields[NMEA_MAX_FIELDS];
+  int n = nmea_split(nmea_sentence, fields, NMEA_MAX_FIELDS);
+  if (n < 1 || fields[0].len != 5)
+    return;
+
+  // Address is a 2-letter talker followed by the sentence formatter
+  const char *addr = fields[0].ptr;
+  uint32_t id = SENTENCE_ID(addr[2], addr[3], addr[4]);
+  size_t count = sizeof(sentence_handlers) / sizeof(sentence_handlers[0]);
+  for (size_t i = 0; i < count; i++) {
+    if (sentence_handlers[i].id == id) {
+      sentence_handlers[i].parse(fields, n);
+      return;
+    }
   }
 }
 
 gps_data_t *gps_get_data(void) { return &gps_data; }
 
-void gps_reset_data(void) { memset(&gps_data, 0, sizeof(gps_data)); }
+void gps_publish(void) {
+  seqlock_write(&gps_seq, &gps_published, &gps_data, sizeof(gps_published));
+}
+
+uint32_t gps_get_snapshot(gps_data_t *out) {
+  return seqlock_read(&gps_seq, out, &gps_published, sizeof(*out));
+}
+
+void gps_reset_data(void) {
+  memset(&gps_data, 0, sizeof(gps_data));
+  memset(gsv_counts, 0, sizeof(gsv_counts));
+  epoch_time_ms = UINT32_MAX;
+  epoch_parts = 0;
+  gps_publish();
+}
+
+bool gps_has_fix(void) {
+  gps_data_t snapshot;
+  gps_get_snapshot(&snapshot);
+  return gps_data_has_fix(&snapshot);
+}
+
+static bool two_digits(const char *p, uint32_t *out) {
+  if (p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9')
+    return false;
+  *out = (uint32_t)(p[0] - '0') * 10 + (uint32_t)(p[1] - '0');
+  return true;
+}
+
+uint32_t gps_unix_time(const gps_data_t *gps) {
+  uint32_t day, month, year, hour, minute, second;
+  if (!two_digits(&gps->date[0], &day) || !two_digits(&gps->date[2], &month) ||
+      !two_digits(&gps->date[4], &year) ||
+      !two_digits(&gps->timestamp[0], &hour) ||
+      !two_digits(&gps->timestamp[2], &minute) ||
+      !two_digits(&gps->timestamp[4], &second))
+    return 0;
+  if (month < 1 || month > 12 || day < 1)
+    return 0;
 
-bool gps_has_fix(void) { return gps_data.valid && gps_data.satellites >= 3; }
+  // Days since 1970-01-01 for a proleptic Gregorian date (years 2000-2099)
+  int32_t y = (int32_t)(2000 + year) - (month <= 2);
+  int32_t era = y / 400;
+  uint32_t yoe = (uint32_t)(y - era * 400);
+  uint32_t mp = (month + 9) % 12;
+  uint32_t doy = (153 * mp + 2) / 5 + day - 1;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  int32_t days = era * 146097 + (int32_t)doe - 719468;
 
+  return (uint32_t)days * 86400u + hour * 3600u + minute * 60u + second;
+}
@@ -2,20 +2,77 @@
 #include "driver/spi_master.h"
 #include "driver/uart.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_vfs_fat.h"
+#include "fixed_fmt.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/task.h"
+#include "geofence.h"
+#include "gps_filter.h"
 #include "gps_parser.h"
+#include "map_index.h"
+#include "map_render.h"
 #include "mqtt_client.h"
+#include "mqtt_queue.h"
+#include "nmea.h"
 #include "nvs_flash.h"
 #include "oled.h"
 #include "pins.h"
+#include "sd_logger.h"
 #include "sdmmc_cmd.h"
+#include "track.h"
+#include "track_simplify.h"
+#include "trip_stats.h"
+#include "ubx.h"
 #include "wifi_http.h"
 #include <stdio.h>
 
 static const char *TAG = "OLEDGPS";
 
+// Task layout: the ingest task owns the UART and the parser working copy and
+// runs above every consumer, so a slow I2C, SD or network call never stalls
+// UART draining. Consumers only read published snapshots.
+#define GPS_INGEST_TASK_PRIO 10
+#define MQTT_TASK_PRIO 5
+#define DISPLAY_TASK_PRIO 4
+#define SD_TASK_PRIO 3
+
+// test_ingest_stack replays the 10 Hz UBX and 1 Hz NMEA captures through
+// this task's calls with 1000 geofences: 3064 B deep on x86-64, whose 8-byte
+// frames are above RV32's, and held under 3.5 KiB there. The other 1.5 KiB
+// covers ESP_LOGI()'s vprintf and the trap frame. log_gps_stats() reports
+// what the device never touched.
+#define GPS_INGEST_STACK_BYTES 5120
+
+// Refresh sends only changed page spans (see oled_stats_t), so 10 Hz costs
+// a few hundred bus bytes per second on the shared I2C bus
+#define DISPLAY_PERIOD_MS 100
+// Pages rotate text, map (text again outside the basemap), trip
+#define DISPLAY_PAGE_MS 5000
+#define SD_PERIOD_MS 1000
+#define MQTT_PERIOD_MS 10000
+// The track itself goes out in queue batches; the live snapshot and the
+// retained trip stats are only refreshed at these rates
+#define MQTT_LIVE_PERIOD_MS 60000
+#define MQTT_STATS_PERIOD_MS 300000
+// Queue drain tick: one batch in flight, so at most MQTT_BATCH_MAX fixes
+// per tick after a reconnect
+#define MQTT_DRAIN_PERIOD_MS 500
+#define GPS_STATS_PERIOD_MS 10000
+
+#define GPS_UART_RX_BUF 2048
+#define GPS_UART_QUEUE_LEN 20
+
+static QueueHandle_t gps_uart_queue;
+static bool sd_mounted;
+static nmea_framer_t nmea_framer;
+static ubx_decoder_t ubx_decoder;
+static bool gps_updated;
+// Owned by the ingest task; sinks only see its output
+static track_simplifier_t simplifier;
+static uint32_t queued_points; // past the MQTT dead-band, read by MQTT task
+
 static esp_err_t init_nvs(void) {
   esp_err_t err = nvs_flash_init();
   if (err == ESP_ERR_NVS_NO_FREE_PAGES ||
@@ -64,6 +121,40 @@ static void i2c_scan(void) {
   }
 }
 
+static void on_nmea_frame(const char *sentence, void *ctx) {
+  ESP_LOGD(TAG, "GPS: %s", sentence);
+  gps_parse_nmea(sentence);
+  gps_updated = true;
+}
+
+static void on_ubx_frame(uint8_t msg_class, uint8_t msg_id,
+                         const uint8_t *payload, uint16_t len, void *ctx) {
+  if (ubx_apply_frame(msg_class, msg_id, payload, len, gps_get_data()))
+    gps_updated = true;
+}
+
+static esp_err_t configure_gps_ubx(void) {
+  uint8_t cfg[96];
+  size_t len =
+      ubx_build_config(GPS_UBX_BAUD, GPS_UBX_RATE_HZ, cfg, sizeof(cfg));
+  if (!len)
+    return ESP_FAIL;
+
+  // Send at the power-on default first, then at the target rate in case the
+  // receiver kept its port settings across a warm reset
+  const uint32_t bauds[] = {9600, GPS_UBX_BAUD};
+  for (int i = 0; i < 2; i++) {
+    ESP_ERROR_CHECK(uart_set_baudrate(UART_NUM_0, bauds[i]));
+    uart_write_bytes(UART_NUM_0, cfg, len);
+    ESP_ERROR_CHECK(uart_wait_tx_done(UART_NUM_0, pdMS_TO_TICKS(500)));
+    vTaskDelay(pdMS_TO_TICKS(100));
+  }
+  uart_flush_input(UART_NUM_0);
+  ESP_LOGI(TAG, "GPS switched to UBX NAV-PVT at %d baud, %d Hz", GPS_UBX_BAUD,
+           GPS_UBX_RATE_HZ);
+  return ESP_OK;
+}
+
 static esp_err_t init_uart_gps(void) {
   const uart_config_t uart_config = {
       .baud_rate = 9600,
@@ -73,11 +164,19 @@ static esp_err_t init_uart_gps(void) {
       .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
       .source_clk = UART_SCLK_DEFAULT,
   };
-  ESP_ERROR_CHECK(uart_driver_install(UART_NUM_0, 2048, 0, 0, NULL, 0));
+  ESP_ERROR_CHECK(uart_driver_install(UART_NUM_0, GPS_UART_RX_BUF, 0,
+                                      GPS_UART_QUEUE_LEN, &gps_uart_queue, 0));
   ESP_ERROR_CHECK(uart_param_config(UART_NUM_0, &uart_config));
   // Map pins (note: may conflict with USB-Serial on 20/21)
   ESP_ERROR_CHECK(uart_set_pin(UART_NUM_0, GPS_TX_GPIO, GPS_RX_GPIO,
                                UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+  if (GPS_UBX_MODE)
+    return configure_gps_ubx();
+
+  // Wake the ingest task once per NMEA line instead of per FIFO threshold
+  ESP_ERROR_CHECK(
+      uart_enable_pattern_det_baud_intr(UART_NUM_0, '\n', 1, 9, 0, 0));
+  ESP_ERROR_CHECK(uart_pattern_queue_reset(UART_NUM_0, GPS_UART_QUEUE_LEN));
   return ESP_OK;
 }
 
@@ -117,66 +216,456 @@ static esp_err_t mount_sdcard(void) {
     return ESP_OK; // allow running without SD card
   }
   sdmmc_card_print_info(stdout, card);
+  sd_mounted = true;
   return ESP_OK;
 }
 
-static void display_gps_info(void) {
-  gps_data_t *gps = gps_get_data();
+static map_render_stats_t map_stats;
+
+// Zooms out as speed grows so the view covers roughly the next minute
+static uint8_t map_zoom_for_speed(uint32_t speed_ckmh) {
+  if (speed_ckmh < 500)
+    return 3;
+  if (speed_ckmh < 2000)
+    return 2;
+  if (speed_ckmh < 6000)
+    return 1;
+  return 0;
+}
+
+// North-up basemap around the fix with a 32-pixel scale bar bottom left
+static void display_map(int32_t lat_e7, int32_t lon_e7,
+                        uint32_t speed_ckmh) {
+  uint8_t zoom = map_zoom_for_speed(speed_ckmh);
+  char line[16];
+
+  oled_clear();
+  map_render(lat_e7, lon_e7, zoom, &map_stats);
+  oled_set_font(&oled_font_5x7);
+  oled_draw_hline(0, OLED_HEIGHT - 1, 32, true);
+  oled_draw_vline(0, OLED_HEIGHT - 3, 3, true);
+  oled_draw_vline(31, OLED_HEIGHT - 3, 3, true);
+  snprintf(line, sizeof(line), "%lum", (unsigned long)map_scale_m(zoom, 32));
+  oled_set_cursor(0, OLED_HEIGHT - 11);
+  oled_print(line);
+  oled_display();
+}
+
+// No GSA seen yet (0) or no fix reported shows as "--", never as 2D
+static const char *fix_label(uint8_t fix_type) {
+  switch (fix_type) {
+  case GPS_FIX_3D:
+    return "3D";
+  case GPS_FIX_2D:
+    return "2D";
+  default:
+    return "--";
+  }
+}
+
+// Durations as h:mm
+static void format_hm(char *buf, size_t size, uint32_t s) {
+  snprintf(buf, size, "%lu:%02lu", (unsigned long)(s / 3600),
+           (unsigned long)(s / 60 % 60));
+}
+
+// Same layout as the text page: trip distance in the big digits
+static void display_trip(void) {
+  trip_stats_t st;
+  trip_stats_get(&st);
+  const trip_t *t = &st.trip;
+  char line[32], a[FIXED_FMT_MAX], b[FIXED_FMT_MAX];
 
   oled_clear();
+  oled_set_font(&oled_font_5x7);
+  snprintf(line, sizeof(line), "TRIP km %13s", st.moving ? "MOVING" : "STOP");
+  oled_println(line);
+  fixed_fmt_round(a, sizeof(a), (int32_t)t->max_speed_ckmh, 2, 1);
+  fixed_fmt_round(b, sizeof(b), (int32_t)trip_stats_avg_ckmh(t), 2, 1);
+  snprintf(line, sizeof(line), "MAX %s AVG %s", a, b);
+  oled_println(line);
+  format_hm(a, sizeof(a), t->moving_s);
+  format_hm(b, sizeof(b), t->stopped_s);
+  snprintf(line, sizeof(line), "MOV %s STOP %s", a, b);
+  oled_println(line);
+
+  // Five 24-pixel digits fit the width
+  uint32_t m = t->distance_cm / 100;
+  uint8_t shown = m < 100000 ? 2 : m < 1000000 ? 1 : 0;
+  oled_set_font(&oled_font_digits_20x28);
+  oled_set_cursor(0, 24);
+  fixed_fmt_round(line, sizeof(line), (int32_t)m, 3, shown);
+  oled_print(line);
+
+  oled_set_font(&oled_font_5x7);
+  oled_set_cursor(0, 56);
+  snprintf(line, sizeof(line), "ODO %lu km",
+           (unsigned long)(st.odometer_cm / 100000));
+  oled_print(line);
+  oled_display();
+}
 
-  if (gps_has_fix()) {
-    char line1[32], line2[32], line3[32], line4[32];
+// 128x64 layout: three 5x7 lines on top, speed in 20x28 digits, then a
+// 5x7 status line at the bottom
+static void display_gps_info(void) {
+  gps_data_t snapshot;
+  gps_get_snapshot(&snapshot);
+  const gps_data_t *gps = &snapshot;
+  char line[32];
 
-    // Line 1: Satellites
-    snprintf(line1, sizeof(line1), "SAT: %d", gps->satellites);
-    oled_print(line1);
-    oled_println("");
+  // Filtered position, dead reckoned to now so the marker moves smoothly
+  // between 1 Hz fixes
+  int32_t lat_e7 = gps->lat_e7, lon_e7 = gps->lon_e7;
+  uint32_t speed_ckmh = gps->speed_ckmh;
+  uint16_t course_cdeg = gps->course_cdeg;
+  if (gps_data_has_fix(gps)) {
+    gps_filter_state_t filt;
+    gps_filter_get(&filt);
+    if (filt.valid) {
+      gps_filter_position_at(&filt, esp_timer_get_time(), &lat_e7, &lon_e7);
+      speed_ckmh = filt.speed_ckmh;
+      course_cdeg = filt.course_cdeg;
+    }
+    uint32_t page = xTaskGetTickCount() * portTICK_PERIOD_MS /
+                    DISPLAY_PAGE_MS % 3;
+    if (page == 1 && map_contains(lat_e7, lon_e7)) {
+      display_map(lat_e7, lon_e7, speed_ckmh);
+      return;
+    }
+    if (page == 2) {
+      display_trip();
+      return;
+    }
+  }
+
+  oled_clear();
+  oled_set_font(&oled_font_5x7);
 
-    // Line 2: Coordinates
-    snprintf(line2, sizeof(line2), "LAT: %.6f", gps->latitude);
-    oled_print(line2);
-    oled_println("");
+  if (gps_data_has_fix(gps)) {
+    char num[FIXED_FMT_MAX];
+    fixed_fmt_round(num, sizeof(num), gps->hdop_e2, 2, 1);
+    snprintf(line, sizeof(line), "SAT %d %s HDOP %s", gps->satellites,
+             fix_label(gps->fix_type), num);
+    oled_println(line);
+    fixed_fmt_round(num, sizeof(num), lat_e7, 7, 6);
+    snprintf(line, sizeof(line), "LAT %s", num);
+    oled_println(line);
+    fixed_fmt_round(num, sizeof(num), lon_e7, 7, 6);
+    snprintf(line, sizeof(line), "LON %s", num);
+    oled_println(line);
 
-    snprintf(line3, sizeof(line3), "LON: %.6f", gps->longitude);
-    oled_print(line3);
-    oled_println("");
+    oled_set_font(&oled_font_digits_20x28);
+    oled_set_cursor(0, 24);
+    fixed_fmt_round(line, sizeof(line), (int32_t)speed_ckmh, 2, 1);
+    oled_print(line);
+    oled_set_font(&oled_font_5x7);
+    oled_set_cursor(OLED_WIDTH - oled_text_width("km/h"), 48);
+    oled_print("km/h");
 
-    // Line 3: Speed and Altitude
-    snprintf(line4, sizeof(line4), "SPD: %.1f ALT: %.1f", gps->speed,
-             gps->altitude);
-    oled_print(line4);
+    oled_set_cursor(0, 56);
+    fixed_fmt_round(num, sizeof(num), gps->alt_cm, 2, 0);
+    snprintf(line, sizeof(line), "ALT %sm CRS %u\x7F", num,
+             (unsigned)((course_cdeg + 50) / 100 % 360));
+    oled_print(line);
   } else {
-    oled_print("GPS: Searching...");
-    oled_println("");
-    oled_print("Sats: ");
-    char sats[8];
-    snprintf(sats, sizeof(sats), "%d", gps->satellites);
-    oled_print(sats);
+    oled_println("GPS: Searching...");
+    snprintf(line, sizeof(line), "Sats: %d in view: %d", gps->satellites,
+             gps->sats_in_view);
+    oled_println(line);
   }
 
   oled_display();
 }
 
-static esp_err_t save_gps_to_sd(void) {
-  gps_data_t *gps = gps_get_data();
-  if (!gps->valid)
-    return ESP_OK; // Only save valid GPS data
+static void gps_drain_uart(void) {
+  uint8_t buf[256];
+  size_t avail = 0;
+  uart_get_buffered_data_len(UART_NUM_0, &avail);
+  while (avail > 0) {
+    int len = uart_read_bytes(UART_NUM_0, buf,
+                              avail < sizeof(buf) ? avail : sizeof(buf), 0);
+    if (len <= 0)
+      break;
+    // Frames may span reads or several may arrive in one read
+    if (GPS_UBX_MODE)
+      ubx_decoder_feed(&ubx_decoder, buf, len, on_ubx_frame, NULL);
+    else
+      nmea_framer_feed(&nmea_framer, buf, len, on_nmea_frame, NULL);
+    avail -= len;
+  }
+}
 
-  FILE *file = fopen("/sd/gps_log.txt", "a");
-  if (!file) {
-    ESP_LOGW(TAG, "Failed to open SD file for writing");
-    return ESP_FAIL;
+static void log_gps_stats(void) {
+  if (GPS_UBX_MODE) {
+    ESP_LOGI(TAG, "UBX frames: good=%lu bad=%lu skipped=%lu",
+             (unsigned long)ubx_decoder.stats.good,
+             (unsigned long)ubx_decoder.stats.bad_checksum,
+             (unsigned long)ubx_decoder.stats.skipped);
+  } else {
+    ESP_LOGI(TAG, "NMEA frames: good=%lu bad=%lu truncated=%lu",
+             (unsigned long)nmea_framer.stats.good,
+             (unsigned long)nmea_framer.stats.bad_checksum,
+             (unsigned long)nmea_framer.stats.truncated);
   }
+  geofence_stats_t gf;
+  geofence_get_stats(&gf);
+  if (gf.fences)
+    ESP_LOGI(TAG, "Geofence: %u fences, inside %u, %lu tested/fix, "
+                  "last %lu us max %lu us, %lu events",
+             gf.fences, gf.inside,
+             (unsigned long)(gf.fixes ? gf.candidates / gf.fixes : 0),
+             (unsigned long)gf.last_us, (unsigned long)gf.max_us,
+             (unsigned long)gf.events);
+  gps_filter_stats_t fs;
+  gps_filter_get_stats(&fs);
+  ESP_LOGI(TAG, "Filter: %lu updates, %lu outliers, %lu restarts, "
+                "last %lu us max %lu us",
+           (unsigned long)fs.updates, (unsigned long)fs.outliers,
+           (unsigned long)fs.resets, (unsigned long)fs.last_us,
+           (unsigned long)fs.max_us);
+  http_stream_stats_t hs;
+  http_stream_get_stats(&hs);
+  ESP_LOGI(TAG, "Web stream: %lu clients (%lu opened, %lu refused, "
+                "%lu closed), %lu events, %lu skipped, %lu bytes, "
+                "build %lu us (%lu failed), send %lu us/client max %lu us",
+           (unsigned long)hs.clients, (unsigned long)hs.opened,
+           (unsigned long)hs.refused, (unsigned long)hs.closed,
+           (unsigned long)hs.events, (unsigned long)hs.skipped,
+           (unsigned long)hs.bytes, (unsigned long)hs.build_us,
+           (unsigned long)hs.build_failed, (unsigned long)hs.per_client_us,
+           (unsigned long)hs.max_send_us);
+  const track_simplify_stats_t *ts = &simplifier.stats;
+  uint32_t ratio = track_simplify_ratio_x100(ts);
+  ESP_LOGI(TAG, "Simplify: %lu fixes in, %lu out (%lu.%02lu:1), %lu keepalive",
+           (unsigned long)ts->in, (unsigned long)ts->out,
+           (unsigned long)(ratio / 100), (unsigned long)(ratio % 100),
+           (unsigned long)ts->keepalives);
+  ESP_LOGI(TAG, "Ingest stack: %lu B never used of %d",
+           (unsigned long)uxTaskGetStackHighWaterMark(NULL),
+           GPS_INGEST_STACK_BYTES);
+}
 
-  fprintf(file, "%lu,%.8f,%.8f,%.2f,%d,%.2f,%.2f,%s,%s\n",
-          (unsigned long)(esp_timer_get_time() / 1000000), gps->latitude,
-          gps->longitude, gps->altitude, gps->satellites, gps->speed,
-          gps->course, gps->timestamp, gps->date);
+// Significant fixes only: the SD log gets the simplified track, the MQTT
+// queue the part of it that passes its dead-band
+static void on_simplified_fix(const sd_log_record_t *rec) {
+  sd_logger_append_record(rec);
+  if (mqtt_queue_offer(rec))
+    __atomic_add_fetch(&queued_points, 1, __ATOMIC_RELEASE);
+}
 
-  fclose(file);
-  ESP_LOGI(TAG, "GPS data saved to SD");
-  return ESP_OK;
+// One filter step per complete epoch (see gps_data_t.epoch), so position,
+// Doppler speed and course all belong to the same fix. False without a
+// filtered fix.
+static bool filter_fix(const gps_data_t *gps, gps_filter_state_t *out) {
+  if (!gps_data_has_fix(gps))
+    return false;
+  gps_filter_meas_t m = {
+      .time_us = esp_timer_get_time(),
+      .lat_e7 = gps->lat_e7,
+      .lon_e7 = gps->lon_e7,
+      .hdop_e2 = gps->hdop_e2,
+      .speed_ckmh = gps->speed_ckmh,
+      .course_cdeg = gps->course_cdeg,
+      .has_velocity = true,
+  };
+  gps_filter_update(&m, out);
+  return out->valid;
+}
+
+// Runs on the ingest task; the MQTT client only queues the message
+static void on_geofence_event(const geofence_event_t *ev, void *ctx) {
+  mqtt_publish_geofence_event(ev);
+}
+
+// Once per complete epoch; GSV/GSA batches in between republish the same
+// position. Every sink below gets the filtered position.
+static void on_fix_epoch(const gps_data_t *gps) {
+  gps_filter_state_t filt;
+  bool filtered = filter_fix(gps, &filt);
+
+  // History keeps at most one fix per second (same-second fixes are
+  // rejected by track_append)
+  track_fix_t fix;
+  if (track_fix_from_gps(gps, &fix)) {
+    if (filtered) {
+      fix.lat_e7 = filt.lat_e7;
+      fix.lon_e7 = filt.lon_e7;
+    }
+    if (track_append(&fix)) {
+      trip_stats_update(fix.time, fix.lat_e7, fix.lon_e7,
+                        filtered ? filt.speed_ckmh : gps->speed_ckmh);
+      // Once per accepted point: a few microseconds through the R-tree,
+      // even on large extracts, and the fence grid
+      map_nearby_update(fix.lat_e7, fix.lon_e7);
+      geofence_update(fix.lat_e7, fix.lon_e7, fix.time);
+    }
+  }
+
+  // Same-second fixes are ignored by the simplifier too; losing the
+  // fix flushes the pending point so the log ends where the boat was
+  sd_log_record_t rec, out;
+  if (sd_log_record_from_gps(gps, &rec)) {
+    if (filtered) {
+      rec.lat_e7 = filt.lat_e7;
+      rec.lon_e7 = filt.lon_e7;
+      rec.crc8 = sd_log_crc8((const uint8_t *)&rec, sizeof(rec) - 1);
+    }
+    if (track_simplify_push(&simplifier, &rec, &out))
+      on_simplified_fix(&out);
+  } else if (track_simplify_flush(&simplifier, &out)) {
+    on_simplified_fix(&out);
+  }
+}
+
+static void gps_ingest_task(void *arg) {
+  nmea_framer_init(&nmea_framer);
+  ubx_decoder_init(&ubx_decoder);
+  track_simplify_init(&simplifier, TRACK_SIMPLIFY_TOL_M,
+                      TRACK_SIMPLIFY_KEEPALIVE_S);
+  uint32_t last_stats = 0, last_epoch = 0;
+  uart_event_t event;
+
+  while (1) {
+    if (xQueueReceive(gps_uart_queue, &event, pdMS_TO_TICKS(1000))) {
+      switch (event.type) {
+      case UART_DATA:
+      case UART_PATTERN_DET:
+        // Positions are not needed: the framer finds boundaries itself
+        while (uart_pattern_pop_pos(UART_NUM_0) != -1) {
+        }
+        gps_drain_uart();
+        break;
+      case UART_FIFO_OVF:
+      case UART_BUFFER_FULL:
+        ESP_LOGW(TAG, "GPS UART overflow, flushing");
+        uart_flush_input(UART_NUM_0);
+        xQueueReset(gps_uart_queue);
+        break;
+      default:
+        break;
+      }
+    }
+
+    // One publish per batch of sentences keeps readers' retries rare
+    if (gps_updated) {
+      gps_publish();
+      gps_updated = false;
+      const gps_data_t *gps = gps_get_data();
+      if (gps->epoch != last_epoch) {
+        last_epoch = gps->epoch;
+        on_fix_epoch(gps);
+        // Web page subscribers get the fix and filter state just published
+        http_stream_notify();
+      }
+    }
+
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (now - last_stats > GPS_STATS_PERIOD_MS) {
+      log_gps_stats();
+      last_stats = now;
+    }
+  }
+}
+
+static void log_display_stats(void) {
+  oled_stats_t st;
+  oled_get_stats(&st);
+  uint32_t sent = st.frames ? st.bytes / st.frames : 0;
+  ESP_LOGI(TAG, "OLED: frames=%lu skipped=%lu avg=%lu B/frame last=%u B/%u tx",
+           (unsigned long)st.frames, (unsigned long)st.skipped,
+           (unsigned long)sent, st.last_bytes, st.last_transactions);
+  if (map_stats.render_us)
+    ESP_LOGI(TAG, "Map: %u tiles %u ways %u segments %u marks in %lu us",
+             map_stats.tiles, map_stats.features, map_stats.segments,
+             map_stats.pois, (unsigned long)map_stats.render_us);
+}
+
+static void display_task(void *arg) {
+  TickType_t last_wake = xTaskGetTickCount();
+  uint32_t last_stats = 0;
+  while (1) {
+    display_gps_info();
+
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (now - last_stats > GPS_STATS_PERIOD_MS) {
+      log_display_stats();
+      last_stats = now;
+    }
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(DISPLAY_PERIOD_MS));
+  }
+}
+
+static void sd_task(void *arg) {
+  TickType_t last_wake = xTaskGetTickCount();
+  while (1) {
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SD_PERIOD_MS));
+    // The ingest task buffers simplified fixes in RAM; the card is only
+    // written in whole buffers or on the flush timeout
+    sd_logger_service();
+  }
+}
+
+// MQTT task: the connection counters belong to mqtt_service()
+static void log_mqtt_stats(void) {
+  mqtt_queue_stats_t qs;
+  mqtt_queue_get_stats(&qs);
+  ESP_LOGI(TAG, "MQTT queue: %lu in, %lu queued, %lu sent in %lu batches, "
+                "ram %lu file %lu, %lu spilled %lu dropped %lu resent",
+           (unsigned long)qs.offered, (unsigned long)qs.queued,
+           (unsigned long)qs.sent, (unsigned long)qs.batches,
+           (unsigned long)qs.ram, (unsigned long)qs.file,
+           (unsigned long)qs.spilled, (unsigned long)qs.dropped,
+           (unsigned long)qs.resent);
+  mqtt_conn_stats_t cs;
+  mqtt_get_conn_stats(&cs);
+  ESP_LOGI(TAG, "MQTT link: state %d, %lu/%lu connects, %lu drops, "
+                "up %lu s (total %lu s), reconnect %lu ms max %lu ms",
+           cs.state, (unsigned long)cs.connects, (unsigned long)cs.attempts,
+           (unsigned long)cs.drops, (unsigned long)cs.uptime_s,
+           (unsigned long)cs.total_up_s, (unsigned long)cs.reconnect_ms,
+           (unsigned long)cs.max_reconnect_ms);
+}
+
+static void mqtt_task(void *arg) {
+  TickType_t last_wake = xTaskGetTickCount();
+  uint32_t published = 0, last_period = 0, last_live = 0, last_stats = 0;
+  uint32_t last_log = 0;
+  bool live_sent = false, stats_sent = false;
+  while (1) {
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(MQTT_DRAIN_PERIOD_MS));
+    // Connection events and backoff, then track batches: sent when due,
+    // spilled to the card while offline
+    mqtt_service();
+    mqtt_publish_queue();
+
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (now - last_period < MQTT_PERIOD_MS)
+      continue;
+    last_period = now;
+    if (now - last_log > GPS_STATS_PERIOD_MS) {
+      log_mqtt_stats();
+      last_log = now;
+    }
+    // Slow NVS writes stay off the ingest task
+    trip_stats_service();
+    if (!mqtt_is_connected())
+      continue;
+    // The live fix goes out only once a new point has passed the queue's
+    // dead-band
+    uint32_t points = __atomic_load_n(&queued_points, __ATOMIC_ACQUIRE);
+    if (points != published &&
+        (!live_sent || now - last_live >= MQTT_LIVE_PERIOD_MS) &&
+        mqtt_publish_gps_data() == ESP_OK) {
+      published = points;
+      last_live = now;
+      live_sent = true;
+    }
+    if ((!stats_sent || now - last_stats >= MQTT_STATS_PERIOD_MS) &&
+        mqtt_publish_trip_stats() == ESP_OK) {
+      last_stats = now;
+      stats_sent = true;
+    }
+  }
 }
 
 void app_main(void) {
@@ -184,10 +673,13 @@ void app_main(void) {
   ESP_ERROR_CHECK(init_i2c());
   i2c_scan();
   ESP_ERROR_CHECK(init_uart_gps());
+  ESP_ERROR_CHECK(track_init());
   ESP_ERROR_CHECK(mount_sdcard());
   ESP_ERROR_CHECK(wifi_init_apsta("OLEDGPS", "12345678"));
   ESP_ERROR_CHECK(http_server_start());
   ESP_ERROR_CHECK(mqtt_init());
+  // Connects from the MQTT task once on the server network
+  mqtt_connect();
 
   // Initialize OLED
   esp_err_t oled_ret = oled_init();
@@ -200,44 +692,25 @@ void app_main(void) {
     ESP_LOGW(TAG, "OLED not available");
   }
 
-  ESP_LOGI(TAG, "Init complete. Reading GPS...");
-  uint8_t buf[128];
-  uint32_t last_display_update = 0;
-  uint32_t last_mqtt_publish = 0;
-  uint32_t last_sd_save = 0;
-
-  while (1) {
-    int len =
-        uart_read_bytes(UART_NUM_0, buf, sizeof(buf) - 1, pdMS_TO_TICKS(1000));
-    if (len > 0) {
-      buf[len] = 0;
-      ESP_LOGI(TAG, "GPS: %s", (char *)buf);
+  // Fences come from the card or NVS; loaded before the ingest task that
+  // evaluates them starts
+  geofence_set_callback(on_geofence_event, NULL);
+  geofence_init();
 
-      // Parse NMEA sentence
-      gps_parse_nmea((char *)buf);
+  // Odometer from NVS before the first fix is counted
+  trip_stats_init();
 
-      uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-
-      // Update display every 2 seconds
-      if (now - last_display_update > 2000) {
-        if (oled_ret == ESP_OK) {
-          display_gps_info();
-        }
-        last_display_update = now;
-      }
+  // The ingest task appends to the log and the MQTT queue, so both must
+  // exist first
+  bool sd_log = sd_mounted && sd_logger_init() == ESP_OK;
+  mqtt_queue_init(sd_mounted ? MQTT_QUEUE_SPILL_PATH : NULL);
 
-      // Try MQTT connection and publish every 10 seconds
-      if (now - last_mqtt_publish > 10000) {
-        mqtt_connect();
-        mqtt_publish_gps_data();
-        last_mqtt_publish = now;
-      }
-
-      // Save to SD every 5 seconds (if valid GPS data)
-      if (now - last_sd_save > 5000) {
-        save_gps_to_sd();
-        last_sd_save = now;
-      }
-    }
-  }
+  ESP_LOGI(TAG, "Init complete. Reading GPS...");
+  xTaskCreate(gps_ingest_task, "gps_ingest", GPS_INGEST_STACK_BYTES, NULL,
+              GPS_INGEST_TASK_PRIO, NULL);
+  if (oled_ret == ESP_OK)
+    xTaskCreate(display_task, "display", 4096, NULL, DISPLAY_TASK_PRIO, NULL);
+  if (sd_log)
+    xTaskCreate(sd_task, "sd_log", 4096, NULL, SD_TASK_PRIO, NULL);
+  xTaskCreate(mqtt_task, "mqtt_pub", 4096, NULL, MQTT_TASK_PRIO, NULL);
 }
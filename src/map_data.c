@@ -0,0 +1,251 @@
+// Generated by tools/osm2tiles.py from map(1).osm, do not edit.
+// 34 ways in 3x3 tiles, 7 seamark points, 8 cm units
+#include "map_data.h"
+
+const uint8_t map_blob[] __attribute__((aligned(4))) = {
+    0x47, 0x4D, 0x41, 0x50, 0x02, 0x03, 0x03, 0x03, 0xA6, 0xC4, 0x60, 0xF2,
+    0x44, 0xDB, 0x4C, 0xE6, 0x90, 0x23, 0x00, 0x00, 0xC6, 0x20, 0x00, 0x00,
+    0x72, 0x5F, 0x2B, 0x85, 0x22, 0x00, 0x10, 0x01, 0x07, 0x00, 0x00, 0x00,
+    0x38, 0x00, 0x00, 0x00, 0xF0, 0x0A, 0x00, 0x00, 0x44, 0x0B, 0x00, 0x00,
+    0x50, 0x0B, 0x00, 0x00, 0x69, 0x0B, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0xC8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xC8, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xAB, 0x29, 0x00, 0x00, 0x71, 0x5F, 0x5A, 0x4B,
+    0xC8, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2D, 0x1F, 0xF6, 0x47, 0x7C, 0x36, 0x82, 0x5F, 0x02, 0x01, 0x00, 0x00,
+    0x15, 0x00, 0x00, 0x00, 0x91, 0x38, 0x11, 0x3D, 0xB3, 0x55, 0xB9, 0x51,
+    0x80, 0x04, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x2E, 0x09, 0xC5, 0x62,
+    0xAD, 0x2F, 0xD6, 0x7E, 0x96, 0x04, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0xF7, 0x41, 0x1B, 0x43, 0x2A, 0x85, 0x1A, 0x06, 0x00, 0x00,
+    0x0A, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+    0xF0, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xAB, 0x29, 0x00, 0x00,
+    0x71, 0x5F, 0x5A, 0x4B, 0x07, 0x00, 0x2E, 0x00, 0x12, 0x4E, 0xE4, 0x11,
+    0x80, 0x00, 0x3F, 0x44, 0x00, 0x00, 0x80, 0x00, 0xEE, 0x2E, 0xF2, 0x12,
+    0x80, 0x00, 0xAB, 0x29, 0x04, 0x34, 0x80, 0x00, 0x99, 0x30, 0xA6, 0x3B,
+    0x80, 0x00, 0x0E, 0x38, 0x59, 0x41, 0x80, 0x00, 0x20, 0x45, 0x5A, 0x4B,
+    0x80, 0x00, 0x71, 0x5F, 0x7D, 0x3D, 0x91, 0x21, 0x6F, 0x50, 0xB6, 0x31,
+    0x82, 0x5F, 0x05, 0x01, 0x96, 0x00, 0x85, 0x26, 0x12, 0x58, 0x8E, 0xDF,
+    0x80, 0x00, 0x00, 0x25, 0x4F, 0x59, 0x9C, 0x46, 0x80, 0x00, 0x39, 0x22,
+    0x5E, 0x5C, 0x80, 0x00, 0x91, 0x21, 0x4D, 0x5D, 0x80, 0x00, 0x34, 0x23,
+    0xC0, 0x5E, 0x79, 0x2A, 0x80, 0x00, 0x62, 0x25, 0x82, 0x5F, 0x80, 0x00,
+    0x8E, 0x27, 0x53, 0x5F, 0x80, 0x00, 0x6F, 0x28, 0x14, 0x5F, 0x80, 0x00,
+    0xF5, 0x2A, 0xBE, 0x5C, 0x80, 0x00, 0xBB, 0x2C, 0x7B, 0x5B, 0x80, 0x00,
+    0x22, 0x2E, 0xBA, 0x58, 0x80, 0x00, 0x1C, 0x30, 0xA5, 0x55, 0x80, 0x00,
+    0x51, 0x30, 0xBE, 0x54, 0x80, 0x00, 0xB6, 0x31, 0x6D, 0x52, 0x80, 0x00,
+    0x8A, 0x31, 0xA3, 0x51, 0x80, 0x00, 0x0A, 0x30, 0xD1, 0x50, 0x80, 0x00,
+    0x57, 0x2F, 0x6F, 0x50, 0x80, 0x00, 0x8D, 0x2E, 0x75, 0x50, 0x80, 0x00,
+    0x07, 0x2B, 0xF1, 0x54, 0xB0, 0x65, 0x80, 0x00, 0x41, 0x2A, 0xEC, 0x55,
+    0x80, 0x00, 0x76, 0x29, 0xE9, 0x58, 0x80, 0x00, 0xC3, 0x28, 0x79, 0x59,
+    0x80, 0x00, 0x8C, 0x27, 0xF5, 0x58, 0x80, 0x00, 0x85, 0x26, 0x12, 0x58,
+    0x05, 0x2D, 0xF6, 0x47, 0x39, 0x2F, 0xCB, 0x49, 0x04, 0x01, 0x20, 0x00,
+    0x05, 0x2D, 0xA8, 0x49, 0x80, 0x00, 0xF9, 0x2D, 0xF6, 0x47, 0x80, 0x00,
+    0x39, 0x2F, 0xC2, 0x48, 0xCC, 0x5B, 0x80, 0x00, 0x0C, 0x2E, 0x89, 0x48,
+    0x80, 0x00, 0x4E, 0x2D, 0xCB, 0x49, 0xB7, 0xDD, 0xA8, 0x34, 0xF7, 0x4C,
+    0x7C, 0x36, 0x11, 0x4E, 0x04, 0x01, 0x22, 0x00, 0xA8, 0x34, 0xF2, 0x4D,
+    0x80, 0x00, 0x45, 0x35, 0xF7, 0x4C, 0x80, 0x00, 0x7C, 0x36, 0xAB, 0x4D,
+    0xCC, 0x4C, 0x80, 0x00, 0x58, 0x35, 0x6B, 0x4D, 0x80, 0x00, 0xF1, 0x34,
+    0x11, 0x4E, 0xDA, 0xEF, 0xDD, 0xF2, 0x2D, 0x1F, 0xC1, 0x4B, 0xF9, 0x2A,
+    0xD2, 0x5E, 0x02, 0x00, 0x24, 0x00, 0x2D, 0x1F, 0xD2, 0x5E, 0x80, 0x00,
+    0xBC, 0x25, 0xF2, 0x53, 0x80, 0x00, 0x45, 0x28, 0xBF, 0x4F, 0x1D, 0xCA,
+    0x80, 0x00, 0x97, 0x29, 0x8C, 0x4D, 0x80, 0x00, 0x8A, 0x2A, 0xF1, 0x4B,
+    0x18, 0xE9, 0x23, 0xF2, 0x34, 0xF5, 0xF9, 0x2A, 0xC1, 0x4B, 0x9A, 0x35,
+    0x6F, 0x52, 0x02, 0x00, 0x22, 0x00, 0xF9, 0x2A, 0xC1, 0x4B, 0x80, 0x00,
+    0x8A, 0x2B, 0xE7, 0x4B, 0x80, 0x00, 0xBB, 0x2E, 0xF4, 0x4D, 0x80, 0x00,
+    0x10, 0x33, 0x86, 0x50, 0x80, 0x00, 0xDB, 0x34, 0xB0, 0x51, 0x80, 0x00,
+    0x9A, 0x35, 0x6F, 0x52, 0x2B, 0x29, 0xF4, 0x4D, 0xBB, 0x2E, 0x28, 0x56,
+    0x02, 0x00, 0x24, 0x00, 0xBB, 0x2E, 0xF4, 0x4D, 0x80, 0x00, 0x68, 0x2C,
+    0xD4, 0x51, 0x80, 0x00, 0xEF, 0x2A, 0x4E, 0x54, 0x80, 0x00, 0x66, 0x2A,
+    0x22, 0x55, 0x80, 0x00, 0xFF, 0x29, 0xC3, 0x55, 0xCD, 0x3C, 0xD5, 0x21,
+    0xD5, 0x08, 0xB5, 0xE5, 0xBC, 0x25, 0xF2, 0x53, 0x2B, 0x29, 0x0D, 0x56,
+    0x02, 0x00, 0x0A, 0x00, 0xBC, 0x25, 0xF2, 0x53, 0x80, 0x00, 0x2B, 0x29,
+    0x0D, 0x56, 0x62, 0x28, 0x89, 0x4F, 0x68, 0x2C, 0xD4, 0x51, 0x02, 0x00,
+    0x0A, 0x00, 0x62, 0x28, 0x89, 0x4F, 0x80, 0x00, 0x68, 0x2C, 0xD4, 0x51,
+    0x18, 0x24, 0x7C, 0x57, 0x94, 0x25, 0x30, 0x59, 0x05, 0x01, 0x1C, 0x00,
+    0xBB, 0x24, 0x30, 0x59, 0x80, 0x00, 0x18, 0x24, 0xC4, 0x58, 0x80, 0x00,
+    0xF2, 0x24, 0x7C, 0x57, 0x80, 0x00, 0x94, 0x25, 0xE7, 0x57, 0x80, 0x00,
+    0xBB, 0x24, 0x30, 0x59, 0x4A, 0x26, 0x79, 0x50, 0x69, 0x2A, 0x11, 0x55,
+    0x05, 0x01, 0x1C, 0x00, 0x69, 0x28, 0x11, 0x55, 0x80, 0x00, 0x4A, 0x26,
+    0xCA, 0x53, 0x80, 0x00, 0x4A, 0x28, 0x79, 0x50, 0x80, 0x00, 0x69, 0x2A,
+    0xC1, 0x51, 0x80, 0x00, 0x69, 0x28, 0x11, 0x55, 0x10, 0x33, 0x18, 0x4E,
+    0xB3, 0x34, 0x86, 0x50, 0x02, 0x00, 0x0A, 0x00, 0xB3, 0x34, 0x18, 0x4E,
+    0x80, 0x00, 0x10, 0x33, 0x86, 0x50, 0x8A, 0x2B, 0xD1, 0x49, 0xF4, 0x2C,
+    0xE7, 0x4B, 0x02, 0x00, 0x0A, 0x00, 0xF4, 0x2C, 0xD1, 0x49, 0x80, 0x00,
+    0x8A, 0x2B, 0xE7, 0x4B, 0xEB, 0x25, 0x50, 0x4C, 0x97, 0x29, 0xBF, 0x4F,
+    0x02, 0x00, 0x24, 0x00, 0x45, 0x28, 0xBF, 0x4F, 0x80, 0x00, 0x07, 0x26,
+    0x80, 0x4E, 0xEE, 0xDA, 0xF9, 0xE3, 0xFD, 0xD1, 0x80, 0x00, 0xAF, 0x26,
+    0xA4, 0x4C, 0x27, 0xCD, 0x23, 0xE8, 0x28, 0xF7, 0x45, 0x09, 0x80, 0x00,
+    0x97, 0x29, 0x8C, 0x4D, 0x84, 0x26, 0xC8, 0x54, 0xCA, 0x2C, 0xEF, 0x5A,
+    0x03, 0x00, 0x32, 0x00, 0x84, 0x26, 0xEF, 0x5A, 0x80, 0x00, 0x95, 0x27,
+    0xB9, 0x5A, 0x80, 0x00, 0xAA, 0x28, 0xC7, 0x5A, 0x80, 0x00, 0xCC, 0x29,
+    0x3B, 0x5A, 0x80, 0x00, 0x84, 0x2A, 0xB7, 0x58, 0x80, 0x00, 0x56, 0x2B,
+    0x2C, 0x57, 0x80, 0x00, 0xDA, 0x2B, 0x0E, 0x56, 0x80, 0x00, 0x57, 0x2C,
+    0x00, 0x55, 0x26, 0xC8, 0x4D, 0x28, 0x91, 0x2F, 0x31, 0x4C, 0xE9, 0x2F,
+    0x8F, 0x4C, 0x05, 0x01, 0x0E, 0x00, 0x91, 0x2F, 0x68, 0x4C, 0x1D, 0xC9,
+    0x3B, 0x28, 0xDF, 0x36, 0xE8, 0xEF, 0xE1, 0xEA, 0x58, 0x28, 0x5E, 0x56,
+    0xB4, 0x28, 0xB8, 0x56, 0x05, 0x01, 0x0C, 0x00, 0x58, 0x28, 0x93, 0x56,
+    0x21, 0xCB, 0x3B, 0x25, 0xDE, 0x35, 0xC6, 0xDB, 0x7B, 0x28, 0x92, 0x56,
+    0x9F, 0x28, 0xB4, 0x56, 0x06, 0x01, 0x0E, 0x00, 0x7B, 0x28, 0xA6, 0x56,
+    0x0D, 0xEC, 0x17, 0x0D, 0xF3, 0x15, 0xFC, 0xFE, 0xED, 0xF4, 0xB7, 0x2A,
+    0x56, 0x55, 0xDA, 0x2B, 0x0E, 0x56, 0x03, 0x00, 0x0A, 0x00, 0xB7, 0x2A,
+    0x56, 0x55, 0x80, 0x00, 0xDA, 0x2B, 0x0E, 0x56, 0x66, 0x2A, 0x22, 0x55,
+    0xB7, 0x2A, 0x56, 0x55, 0x03, 0x00, 0x06, 0x00, 0xB7, 0x2A, 0x56, 0x55,
+    0xAF, 0xCC, 0xCA, 0x2C, 0xCF, 0x54, 0x1E, 0x2D, 0x23, 0x55, 0x06, 0x01,
+    0x2A, 0x00, 0x1C, 0x2D, 0xEE, 0x54, 0x02, 0x0D, 0xFD, 0x0E, 0xF9, 0x0C,
+    0xF5, 0x08, 0xF4, 0x06, 0xF2, 0x00, 0xF3, 0xFD, 0xF5, 0xF8, 0xF7, 0xF5,
+    0xFC, 0xF3, 0x00, 0xF0, 0x04, 0xF5, 0x09, 0xF5, 0x0C, 0xF8, 0x0E, 0xFD,
+    0x0F, 0x02, 0x0C, 0x06, 0x0A, 0x0B, 0x06, 0x0C, 0x62, 0x26, 0xB5, 0x4C,
+    0xB7, 0x28, 0x24, 0x4F, 0x06, 0x01, 0x28, 0x00, 0x62, 0x26, 0x6F, 0x4E,
+    0x80, 0x00, 0xA3, 0x27, 0x24, 0x4F, 0x80, 0x00, 0xB7, 0x28, 0x87, 0x4D,
+    0x80, 0x00, 0x6D, 0x27, 0xB5, 0x4C, 0x80, 0x00, 0x1E, 0x27, 0x35, 0x4D,
+    0xD8, 0xE5, 0x80, 0x00, 0x6F, 0x26, 0xE6, 0x4D, 0x3A, 0x26, 0xB9, 0x63,
+    0x91, 0x38, 0x11, 0x3D, 0xB3, 0x55, 0xB9, 0x51, 0x07, 0x00, 0x0A, 0x00,
+    0xB3, 0x55, 0x11, 0x3D, 0x80, 0x00, 0x91, 0x38, 0xB9, 0x51, 0x2E, 0x09,
+    0xC5, 0x62, 0xAD, 0x2F, 0xD6, 0x7E, 0x05, 0x01, 0x78, 0x01, 0xE0, 0x13,
+    0xA5, 0x68, 0x80, 0x00, 0x7E, 0x10, 0x14, 0x68, 0x80, 0x00, 0x4A, 0x0F,
+    0x4B, 0x67, 0x80, 0x00, 0xCA, 0x0E, 0x4B, 0x67, 0x80, 0x00, 0x14, 0x0E,
+    0x7F, 0x67, 0x9E, 0x4D, 0x80, 0x00, 0x1B, 0x0C, 0x50, 0x6A, 0x80, 0x00,
+    0xDF, 0x0A, 0xD8, 0x6B, 0x80, 0x00, 0x51, 0x09, 0xEC, 0x6D, 0x80, 0x00,
+    0x2E, 0x09, 0x83, 0x6E, 0x80, 0x00, 0x54, 0x09, 0x2B, 0x6F, 0x80, 0x00,
+    0x06, 0x0C, 0xEB, 0x73, 0x80, 0x00, 0x80, 0x0D, 0xFC, 0x75, 0x80, 0x00,
+    0x9A, 0x0E, 0xBC, 0x76, 0x80, 0x00, 0xEA, 0x0F, 0x15, 0x77, 0x80, 0x00,
+    0xBD, 0x11, 0x0E, 0x77, 0x80, 0x00, 0x49, 0x14, 0x0E, 0x77, 0x80, 0x00,
+    0xD8, 0x15, 0x5A, 0x77, 0x80, 0x00, 0xBA, 0x16, 0xC8, 0x77, 0x80, 0x00,
+    0x77, 0x17, 0x8C, 0x78, 0x80, 0x00, 0xF4, 0x18, 0x30, 0x7B, 0x80, 0x00,
+    0x13, 0x1B, 0xED, 0x7D, 0x80, 0x00, 0xA0, 0x1B, 0x5E, 0x7E, 0x80, 0x00,
+    0x94, 0x1C, 0xA6, 0x7E, 0x80, 0x00, 0x82, 0x1E, 0xD6, 0x7E, 0x80, 0x00,
+    0x61, 0x1F, 0x9C, 0x7E, 0x80, 0x00, 0xA4, 0x22, 0x1E, 0x7D, 0x5F, 0xBF,
+    0x80, 0x00, 0x0C, 0x24, 0xDC, 0x7B, 0x75, 0xAA, 0x80, 0x00, 0x2D, 0x25,
+    0x59, 0x7B, 0x80, 0x00, 0xF9, 0x26, 0x3A, 0x7B, 0x80, 0x00, 0x9C, 0x29,
+    0x56, 0x7B, 0x80, 0x00, 0x44, 0x2A, 0x48, 0x7B, 0x80, 0x00, 0xD6, 0x2A,
+    0x1B, 0x7B, 0x80, 0x00, 0x70, 0x2B, 0xA3, 0x7A, 0x80, 0x00, 0xAD, 0x2F,
+    0xAE, 0x75, 0x80, 0x00, 0x51, 0x2E, 0xEC, 0x74, 0x80, 0x00, 0x36, 0x2E,
+    0x19, 0x73, 0x80, 0x00, 0x74, 0x2C, 0x27, 0x73, 0x80, 0x00, 0xE3, 0x2A,
+    0x0F, 0x73, 0x80, 0x00, 0x83, 0x28, 0xF7, 0x72, 0x80, 0x00, 0xDA, 0x26,
+    0x25, 0x73, 0x80, 0x00, 0x43, 0x25, 0x38, 0x73, 0x80, 0x00, 0x82, 0x23,
+    0x73, 0x73, 0x80, 0x00, 0xB5, 0x22, 0xDD, 0x73, 0x80, 0x00, 0x31, 0x22,
+    0xB5, 0x74, 0x80, 0x00, 0x03, 0x21, 0x23, 0x75, 0x80, 0x00, 0x9E, 0x1F,
+    0xBE, 0x73, 0x80, 0x00, 0xB4, 0x1E, 0xCA, 0x70, 0x80, 0x00, 0x67, 0x1F,
+    0xF2, 0x6D, 0x80, 0x00, 0xDA, 0x20, 0x6D, 0x6B, 0x80, 0x00, 0xAD, 0x22,
+    0xEC, 0x69, 0x80, 0x00, 0xED, 0x22, 0xD0, 0x68, 0x80, 0x00, 0xAA, 0x22,
+    0xCA, 0x67, 0x80, 0x00, 0x21, 0x22, 0x54, 0x65, 0x80, 0x00, 0x59, 0x21,
+    0x9E, 0x64, 0x80, 0x00, 0x98, 0x20, 0x0C, 0x64, 0x80, 0x00, 0x19, 0x1F,
+    0xEA, 0x62, 0x80, 0x00, 0x5C, 0x1E, 0xC5, 0x62, 0x80, 0x00, 0x81, 0x1C,
+    0xDC, 0x63, 0x80, 0x00, 0x3B, 0x19, 0xD4, 0x67, 0x80, 0x00, 0xD8, 0x16,
+    0xB3, 0x68, 0x80, 0x00, 0xCF, 0x14, 0xAD, 0x68, 0x80, 0x00, 0xE0, 0x13,
+    0xA5, 0x68, 0x2E, 0x09, 0x95, 0x49, 0x87, 0x3D, 0xD6, 0x7E, 0x01, 0x01,
+    0x42, 0x02, 0x03, 0x2F, 0xBE, 0x4A, 0x80, 0x00, 0x17, 0x33, 0x45, 0x4D,
+    0x80, 0x00, 0xA9, 0x33, 0x94, 0x4D, 0x80, 0x00, 0xA8, 0x34, 0xF2, 0x4D,
+    0x23, 0x0E, 0x26, 0x11, 0x6A, 0x36, 0x2F, 0x3A, 0x02, 0x5D, 0x80, 0x00,
+    0x79, 0x35, 0x77, 0x4F, 0x07, 0x5D, 0x25, 0x6A, 0x80, 0x00, 0x65, 0x36,
+    0xBD, 0x51, 0x80, 0x00, 0x33, 0x38, 0x42, 0x55, 0x26, 0x69, 0x11, 0x67,
+    0x80, 0x00, 0x5D, 0x38, 0x25, 0x57, 0x80, 0x00, 0x51, 0x38, 0x68, 0x58,
+    0x80, 0x00, 0x70, 0x38, 0x2F, 0x5A, 0x80, 0x00, 0x8B, 0x38, 0xD5, 0x5A,
+    0x80, 0x00, 0xE3, 0x38, 0x22, 0x5C, 0x80, 0x00, 0x27, 0x39, 0xF0, 0x5C,
+    0x80, 0x00, 0xDC, 0x39, 0x61, 0x5E, 0x80, 0x00, 0x50, 0x3A, 0x12, 0x5F,
+    0x80, 0x00, 0x78, 0x3B, 0x44, 0x60, 0x52, 0x75, 0x24, 0x6C, 0x80, 0x00,
+    0x57, 0x3C, 0x42, 0x63, 0x80, 0x00, 0x93, 0x3C, 0x10, 0x64, 0x80, 0x00,
+    0x7E, 0x3D, 0x62, 0x66, 0x09, 0x65, 0xE6, 0x5D, 0x80, 0x00, 0x02, 0x3D,
+    0xC7, 0x67, 0x80, 0x00, 0x24, 0x3C, 0xB2, 0x68, 0x80, 0x00, 0x1B, 0x3B,
+    0x99, 0x69, 0x80, 0x00, 0x50, 0x3A, 0x7E, 0x6A, 0x80, 0x00, 0x7F, 0x39,
+    0x7B, 0x6B, 0x80, 0x00, 0x14, 0x39, 0x26, 0x6C, 0x80, 0x00, 0xD3, 0x38,
+    0xC4, 0x6C, 0xBD, 0x64, 0xBD, 0x3A, 0x80, 0x00, 0x5F, 0x37, 0xD9, 0x6D,
+    0x80, 0x00, 0xDC, 0x36, 0xF1, 0x6D, 0x80, 0x00, 0x4A, 0x36, 0xFF, 0x6D,
+    0x81, 0x1B, 0x80, 0x00, 0x2C, 0x35, 0x66, 0x6E, 0x80, 0x00, 0xA1, 0x34,
+    0xD3, 0x6E, 0x80, 0x00, 0x25, 0x34, 0x65, 0x6F, 0x80, 0x00, 0x50, 0x33,
+    0xA3, 0x71, 0x80, 0x00, 0x84, 0x32, 0xF4, 0x72, 0x80, 0x00, 0x4F, 0x31,
+    0x78, 0x74, 0x80, 0x00, 0x3D, 0x30, 0x2E, 0x75, 0x80, 0x00, 0xAD, 0x2F,
+    0xAE, 0x75, 0x80, 0x00, 0x70, 0x2B, 0xA3, 0x7A, 0x80, 0x00, 0xD6, 0x2A,
+    0x1B, 0x7B, 0x80, 0x00, 0x44, 0x2A, 0x48, 0x7B, 0x80, 0x00, 0x9C, 0x29,
+    0x56, 0x7B, 0x80, 0x00, 0xF9, 0x26, 0x3A, 0x7B, 0x80, 0x00, 0x2D, 0x25,
+    0x59, 0x7B, 0x80, 0x00, 0x81, 0x24, 0x86, 0x7B, 0x8B, 0x56, 0x80, 0x00,
+    0x03, 0x23, 0xDD, 0x7C, 0xA1, 0x41, 0x80, 0x00, 0x61, 0x1F, 0x9C, 0x7E,
+    0x80, 0x00, 0x82, 0x1E, 0xD6, 0x7E, 0x80, 0x00, 0x94, 0x1C, 0xA6, 0x7E,
+    0x80, 0x00, 0xA0, 0x1B, 0x5E, 0x7E, 0x80, 0x00, 0x13, 0x1B, 0xED, 0x7D,
+    0x80, 0x00, 0xF4, 0x18, 0x30, 0x7B, 0x80, 0x00, 0x77, 0x17, 0x8C, 0x78,
+    0x80, 0x00, 0xBA, 0x16, 0xC8, 0x77, 0x80, 0x00, 0xD8, 0x15, 0x5A, 0x77,
+    0x80, 0x00, 0x49, 0x14, 0x0E, 0x77, 0x80, 0x00, 0xBD, 0x11, 0x0E, 0x77,
+    0x80, 0x00, 0xEA, 0x0F, 0x15, 0x77, 0x80, 0x00, 0x9A, 0x0E, 0xBC, 0x76,
+    0x80, 0x00, 0x80, 0x0D, 0xFC, 0x75, 0x80, 0x00, 0x06, 0x0C, 0xEB, 0x73,
+    0x80, 0x00, 0x54, 0x09, 0x2B, 0x6F, 0x80, 0x00, 0x2E, 0x09, 0x83, 0x6E,
+    0x80, 0x00, 0x51, 0x09, 0xEC, 0x6D, 0x80, 0x00, 0xDF, 0x0A, 0xD8, 0x6B,
+    0x80, 0x00, 0x1B, 0x0C, 0x50, 0x6A, 0x80, 0x00, 0xB2, 0x0D, 0xCC, 0x67,
+    0x62, 0xB3, 0x80, 0x00, 0xCA, 0x0E, 0x4B, 0x67, 0x80, 0x00, 0x4A, 0x0F,
+    0x4B, 0x67, 0x80, 0x00, 0x7E, 0x10, 0x14, 0x68, 0x80, 0x00, 0xE0, 0x13,
+    0xA5, 0x68, 0x80, 0x00, 0x44, 0x15, 0x55, 0x68, 0x80, 0x00, 0x84, 0x16,
+    0x5B, 0x67, 0x80, 0x00, 0x31, 0x19, 0x8D, 0x64, 0x80, 0x00, 0x52, 0x1B,
+    0xB3, 0x61, 0x80, 0x00, 0x2B, 0x1C, 0x23, 0x60, 0x80, 0x00, 0x7C, 0x1C,
+    0xD1, 0x5E, 0xEE, 0x92, 0xC6, 0xB1, 0x80, 0x00, 0x75, 0x1B, 0xAD, 0x5D,
+    0xEB, 0xDE, 0x00, 0xBB, 0x23, 0xCD, 0x80, 0x00, 0xAD, 0x1C, 0xB6, 0x5B,
+    0x80, 0x00, 0x89, 0x1E, 0x2D, 0x59, 0x80, 0x00, 0x0D, 0x20, 0xBC, 0x56,
+    0x80, 0x00, 0xF8, 0x21, 0x0A, 0x53, 0x80, 0x00, 0x7A, 0x24, 0xCD, 0x4E,
+    0x80, 0x00, 0xD3, 0x26, 0x31, 0x4B, 0x80, 0x00, 0x6D, 0x27, 0x89, 0x4A,
+    0x80, 0x00, 0x27, 0x28, 0x37, 0x4A, 0x80, 0x00, 0x2A, 0x2C, 0x95, 0x49,
+    0x80, 0x00, 0x05, 0x2D, 0xA8, 0x49, 0x49, 0x23, 0x7D, 0x36, 0x80, 0x00,
+    0x03, 0x2F, 0xBE, 0x4A, 0x00, 0x00, 0xF7, 0x41, 0x1B, 0x43, 0x2A, 0x85,
+    0x07, 0x01, 0x28, 0x00, 0x94, 0x1F, 0xF7, 0x41, 0x80, 0x00, 0x00, 0x00,
+    0x56, 0x71, 0x80, 0x00, 0xC6, 0x21, 0x2A, 0x85, 0x80, 0x00, 0xA2, 0x39,
+    0x4D, 0x7C, 0x80, 0x00, 0x1B, 0x43, 0xCA, 0x69, 0x80, 0x00, 0x5F, 0x3E,
+    0x9D, 0x4B, 0x80, 0x00, 0x94, 0x1F, 0xF7, 0x41, 0xCE, 0x22, 0xDC, 0x58,
+    0x35, 0x24, 0x71, 0x5A, 0x05, 0x01, 0x1C, 0x00, 0x84, 0x23, 0x71, 0x5A,
+    0x80, 0x00, 0xCE, 0x22, 0x04, 0x5A, 0x80, 0x00, 0x80, 0x23, 0xDC, 0x58,
+    0x80, 0x00, 0x35, 0x24, 0x49, 0x59, 0x80, 0x00, 0x84, 0x23, 0x71, 0x5A,
+    0x43, 0x24, 0x6F, 0x52, 0xE5, 0x35, 0xB0, 0x71, 0x02, 0x00, 0x2C, 0x00,
+    0x9A, 0x35, 0x6F, 0x52, 0x80, 0x00, 0xC1, 0x35, 0xEF, 0x52, 0x20, 0x7A,
+    0x80, 0x00, 0xE5, 0x35, 0x01, 0x54, 0xF2, 0x5B, 0x80, 0x00, 0xA9, 0x35,
+    0xEE, 0x54, 0x80, 0x00, 0x3D, 0x31, 0x4B, 0x5C, 0x80, 0x00, 0x3C, 0x2B,
+    0x39, 0x66, 0x80, 0x00, 0x43, 0x24, 0xB0, 0x71, 0x3E, 0x2E, 0x68, 0x5A,
+    0x51, 0x36, 0x77, 0x5F, 0x02, 0x00, 0x10, 0x00, 0x51, 0x36, 0x77, 0x5F,
+    0x80, 0x00, 0x3D, 0x31, 0x4B, 0x5C, 0x80, 0x00, 0x3E, 0x2E, 0x68, 0x5A,
+    0x59, 0x22, 0x20, 0x61, 0x1E, 0x31, 0x0E, 0x6A, 0x02, 0x00, 0x10, 0x00,
+    0x59, 0x22, 0x20, 0x61, 0x80, 0x00, 0x3C, 0x2B, 0x39, 0x66, 0x80, 0x00,
+    0x1E, 0x31, 0x0E, 0x6A, 0xAC, 0x07, 0x49, 0x47, 0xAF, 0x3D, 0xB9, 0x7F,
+    0x08, 0x01, 0x54, 0x01, 0x51, 0x24, 0x3B, 0x7C, 0x80, 0x00, 0x9B, 0x1F,
+    0xB1, 0x7E, 0x80, 0x00, 0xD0, 0x1B, 0xB9, 0x7F, 0x80, 0x00, 0xD6, 0x16,
+    0x4B, 0x79, 0x80, 0x00, 0x85, 0x13, 0x7E, 0x77, 0x80, 0x00, 0x8B, 0x0E,
+    0x7E, 0x77, 0x80, 0x00, 0x35, 0x0D, 0x7F, 0x76, 0x80, 0x00, 0xC0, 0x0A,
+    0xAA, 0x74, 0x80, 0x00, 0x91, 0x09, 0x11, 0x71, 0x80, 0x00, 0xAC, 0x07,
+    0x7F, 0x6E, 0x80, 0x00, 0x46, 0x0A, 0x10, 0x6B, 0x80, 0x00, 0x99, 0x0C,
+    0xF3, 0x67, 0x80, 0x00, 0xF7, 0x0F, 0x02, 0x66, 0x80, 0x00, 0x07, 0x11,
+    0x75, 0x67, 0x80, 0x00, 0x85, 0x13, 0xCF, 0x67, 0x80, 0x00, 0x0A, 0x14,
+    0xBE, 0x67, 0x80, 0x00, 0x8C, 0x15, 0x8F, 0x67, 0x80, 0x00, 0x72, 0x17,
+    0x98, 0x65, 0x80, 0x00, 0xFA, 0x19, 0xF7, 0x61, 0x80, 0x00, 0x6C, 0x1B,
+    0xD3, 0x5E, 0x80, 0x00, 0x9E, 0x19, 0x10, 0x5D, 0x80, 0x00, 0x55, 0x1B,
+    0x47, 0x5C, 0x80, 0x00, 0x98, 0x1D, 0x3C, 0x59, 0x80, 0x00, 0xDB, 0x1F,
+    0x02, 0x55, 0x80, 0x00, 0xD9, 0x20, 0x27, 0x53, 0x80, 0x00, 0x1B, 0x23,
+    0x6D, 0x4F, 0x80, 0x00, 0xA3, 0x25, 0xB8, 0x4A, 0x80, 0x00, 0xA1, 0x27,
+    0x71, 0x49, 0x80, 0x00, 0x9C, 0x2A, 0xA8, 0x48, 0x80, 0x00, 0x26, 0x2C,
+    0xF4, 0x48, 0x80, 0x00, 0x51, 0x2E, 0x49, 0x47, 0x80, 0x00, 0x4E, 0x30,
+    0xA8, 0x48, 0x80, 0x00, 0x21, 0x2F, 0x85, 0x4A, 0x80, 0x00, 0x92, 0x31,
+    0xF2, 0x4B, 0x80, 0x00, 0x03, 0x34, 0x5E, 0x4D, 0x80, 0x00, 0x75, 0x35,
+    0xFE, 0x4B, 0x80, 0x00, 0x2D, 0x37, 0x17, 0x4C, 0x80, 0x00, 0x46, 0x36,
+    0x04, 0x50, 0x80, 0x00, 0xFC, 0x38, 0xEB, 0x54, 0x80, 0x00, 0x5A, 0x38,
+    0x73, 0x58, 0x80, 0x00, 0x58, 0x39, 0xAB, 0x5C, 0x80, 0x00, 0x3D, 0x3C,
+    0xCA, 0x60, 0x80, 0x00, 0x60, 0x3C, 0xEB, 0x61, 0x80, 0x00, 0xDF, 0x3C,
+    0xE8, 0x64, 0x80, 0x00, 0xAF, 0x3D, 0xF3, 0x67, 0x80, 0x00, 0xB2, 0x3B,
+    0x9E, 0x69, 0x80, 0x00, 0xB5, 0x39, 0xF8, 0x6B, 0x80, 0x00, 0x71, 0x38,
+    0xB8, 0x6E, 0x80, 0x00, 0xBB, 0x35, 0x3A, 0x6E, 0x80, 0x00, 0x03, 0x34,
+    0x9A, 0x6F, 0x80, 0x00, 0x61, 0x33, 0xA9, 0x71, 0x80, 0x00, 0xC0, 0x31,
+    0xCC, 0x74, 0x80, 0x00, 0x52, 0x2F, 0xEF, 0x75, 0x80, 0x00, 0xC5, 0x2E,
+    0xC0, 0x77, 0x80, 0x00, 0x74, 0x2B, 0x5A, 0x7B, 0x80, 0x00, 0x01, 0x26,
+    0x5A, 0x7B, 0x80, 0x00, 0x51, 0x24, 0x3B, 0x7C, 0x2D, 0x1F, 0xD2, 0x5E,
+    0x59, 0x22, 0x20, 0x61, 0x02, 0x00, 0x0A, 0x00, 0x59, 0x22, 0x20, 0x61,
+    0x80, 0x00, 0x2D, 0x1F, 0xD2, 0x5E, 0x4F, 0x26, 0xEC, 0x5A, 0x84, 0x26,
+    0x33, 0x5B, 0x06, 0x00, 0x18, 0x00, 0x84, 0x26, 0xEF, 0x5A, 0xF3, 0xFD,
+    0xF3, 0x01, 0xF5, 0x06, 0xF8, 0x08, 0xFB, 0x09, 0xFD, 0x0B, 0x01, 0x0B,
+    0x05, 0x0B, 0x07, 0x08, 0x09, 0x06, 0x65, 0x26, 0xEF, 0x5A, 0x99, 0x26,
+    0x36, 0x5B, 0x06, 0x00, 0x16, 0x00, 0x65, 0x26, 0x33, 0x5B, 0x0D, 0x03,
+    0x0D, 0xFF, 0x0B, 0xFA, 0x09, 0xF7, 0x06, 0xF4, 0x00, 0xF3, 0xFD, 0xF4,
+    0xF8, 0xF5, 0xF6, 0xF9, 0xB8, 0x45, 0x39, 0x4A, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xFE, 0x42, 0x41, 0x6B, 0x01, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x96, 0x3B, 0x07, 0x5D, 0x03, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0x57, 0x3D, 0x5D, 0x4C, 0x01, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x81, 0x1C, 0xB5, 0x4A, 0x02, 0x00, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x22, 0x0B, 0x65, 0x57, 0x05, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0x20, 0x01, 0xCF, 0x70, 0x01, 0x00, 0x00, 0x00,
+    0x17, 0x00, 0x00, 0x00, 0x20, 0x01, 0x39, 0x4A, 0xB8, 0x45, 0xCF, 0x70,
+    0x2E, 0x00, 0x00, 0x00, 0x33, 0x00, 0x35, 0x00, 0x32, 0x00, 0x50, 0x6F,
+    0x6E, 0x74, 0x61, 0x20, 0x64, 0x6F, 0x20, 0x4D, 0x6F, 0x72, 0x63, 0x65,
+    0x67, 0x6F, 0x00, 0x32, 0x00,
+};
+const uint32_t map_blob_size = sizeof(map_blob);
@@ -0,0 +1,256 @@
+#include "map_index.h"
+#include "geo.h"
+#include "map_render.h"
+#include "seqlock.h"
+#include <string.h>
+
+static const char *const kind_names[] = {
+    [MAP_POI_BUOY] = "buoy",   [MAP_POI_BEACON] = "beacon",
+    [MAP_POI_WRECK] = "wreck", [MAP_POI_LIGHT] = "light",
+    [MAP_POI_OTHER] = "other",
+};
+
+// Published nearby list, see seqlock.h
+static map_nearby_t nearby;
+static uint32_t nearby_seq;
+
+// Level geometry derived from the header: sizes[0] is the POI count,
+// start[l] is the first box of internal level l (1-based)
+typedef struct {
+  const map_header_t *map;
+  const map_poi_t *pois;
+  const map_bbox_t *boxes;
+  const uint8_t *masks;
+  uint32_t size[MAP_RTREE_MAX_LEVELS + 1];
+  uint32_t start[MAP_RTREE_MAX_LEVELS + 1];
+  uint8_t levels;
+} tree_t;
+
+static bool tree_open(const map_header_t *map, tree_t *t) {
+  if (!map || !map->rtree_levels || map->rtree_levels > MAP_RTREE_MAX_LEVELS)
+    return false;
+  const uint8_t *base = (const uint8_t *)map;
+  uint32_t m = map->rtree_fanout, nodes = 0;
+  t->map = map;
+  t->levels = map->rtree_levels;
+  t->size[0] = map->poi_count;
+  for (uint8_t l = 1; l <= t->levels; l++) {
+    t->size[l] = (t->size[l - 1] + m - 1) / m;
+    t->start[l] = nodes;
+    nodes += t->size[l];
+  }
+  t->pois = (const map_poi_t *)(base + map->poi_off);
+  t->boxes = (const map_bbox_t *)(base + map->rtree_off);
+  t->masks = base + map->rtree_off + nodes * sizeof(map_bbox_t);
+  return true;
+}
+
+const map_poi_t *map_poi_get(const map_header_t *map, uint32_t id) {
+  if (!map || id >= map->poi_count)
+    return NULL;
+  return (const map_poi_t *)((const uint8_t *)map + map->poi_off) + id;
+}
+
+const char *map_poi_name(const map_header_t *map, const map_poi_t *poi) {
+  if (!map || !poi || poi->name == MAP_NO_NAME)
+    return NULL;
+  return (const char *)map + map->names_off + poi->name;
+}
+
+const char *map_poi_kind_name(uint8_t kind) {
+  if (kind < sizeof(kind_names) / sizeof(kind_names[0]) && kind_names[kind])
+    return kind_names[kind];
+  return "other";
+}
+
+uint8_t map_poi_kind_mask(const char *name) {
+  if (!name || strcmp(name, "all") == 0)
+    return MAP_POI_KIND_ALL;
+  for (uint8_t k = 1; k < sizeof(kind_names) / sizeof(kind_names[0]); k++)
+    if (strcmp(name, kind_names[k]) == 0)
+      return (uint8_t)(1u << k);
+  return 0;
+}
+
+static bool box_overlaps(const map_bbox_t *a, const map_bbox_t *b) {
+  return a->x0 <= b->x1 && a->x1 >= b->x0 && a->y0 <= b->y1 &&
+         a->y1 >= b->y0;
+}
+
+// Squared distance from a point to a box, 0 inside
+static uint64_t box_dist2(const map_bbox_t *b, int32_t x, int32_t y) {
+  int64_t dx = x < b->x0 ? b->x0 - x : (x > b->x1 ? x - b->x1 : 0);
+  int64_t dy = y < b->y0 ? b->y0 - y : (y > b->y1 ? y - b->y1 : 0);
+  return (uint64_t)(dx * dx + dy * dy);
+}
+
+static uint64_t point_dist2(const map_poi_t *p, int32_t x, int32_t y) {
+  int64_t dx = (int64_t)p->x - x, dy = (int64_t)p->y - y;
+  return (uint64_t)(dx * dx + dy * dy);
+}
+
+typedef struct {
+  const tree_t *t;
+  const map_bbox_t *box;
+  uint8_t mask;
+  map_poi_cb_t cb;
+  void *ctx;
+  uint32_t found;
+  bool stop;
+} bbox_query_t;
+
+static void bbox_visit(bbox_query_t *q, uint8_t level, uint32_t node) {
+  const tree_t *t = q->t;
+  uint32_t m = t->map->rtree_fanout;
+  uint32_t first = node * m, last = first + m;
+  if (last > t->size[level - 1])
+    last = t->size[level - 1];
+
+  for (uint32_t c = first; c < last && !q->stop; c++) {
+    if (level == 1) {
+      const map_poi_t *p = &t->pois[c];
+      if (!(q->mask & (1u << p->kind)) || p->x < q->box->x0 ||
+          p->x > q->box->x1 || p->y < q->box->y0 || p->y > q->box->y1)
+        continue;
+      q->found++;
+      if (q->cb && !q->cb(c, p, q->ctx))
+        q->stop = true;
+    } else {
+      uint32_t n = t->start[level - 1] + c;
+      if ((t->masks[n] & q->mask) && box_overlaps(&t->boxes[n], q->box))
+        bbox_visit(q, level - 1, c);
+    }
+  }
+}
+
+uint32_t map_index_bbox(const map_header_t *map, const map_bbox_t *box,
+                        uint8_t kind_mask, map_poi_cb_t cb, void *ctx) {
+  tree_t t;
+  if (!box || !tree_open(map, &t))
+    return 0;
+  uint32_t root = t.start[t.levels];
+  if (!(t.masks[root] & kind_mask) || !box_overlaps(&t.boxes[root], box))
+    return 0;
+  bbox_query_t q = {.t = &t, .box = box, .mask = kind_mask, .cb = cb,
+                    .ctx = ctx};
+  bbox_visit(&q, t.levels, 0);
+  return q.found;
+}
+
+typedef struct {
+  const tree_t *t;
+  int32_t x, y;
+  uint8_t mask;
+  uint8_t k;
+  uint8_t count;
+  map_poi_hit_t *hits; // sorted, closest first
+} knn_query_t;
+
+static uint64_t knn_bound(const knn_query_t *q) {
+  return q->count < q->k ? UINT64_MAX : q->hits[q->count - 1].dist2;
+}
+
+static void knn_insert(knn_query_t *q, uint32_t id, uint64_t d) {
+  uint8_t i = q->count < q->k ? q->count++ : q->k - 1;
+  while (i > 0 && q->hits[i - 1].dist2 > d) {
+    q->hits[i] = q->hits[i - 1];
+    i--;
+  }
+  q->hits[i] = (map_poi_hit_t){.id = id, .dist2 = d};
+}
+
+// Depth-first branch and bound: children are visited nearest box first
+// and skipped once they cannot beat the current k-th hit
+static void knn_visit(knn_query_t *q, uint8_t level, uint32_t node) {
+  const tree_t *t = q->t;
+  uint32_t m = t->map->rtree_fanout;
+  uint32_t first = node * m, last = first + m;
+  if (last > t->size[level - 1])
+    last = t->size[level - 1];
+
+  if (level == 1) {
+    for (uint32_t c = first; c < last; c++) {
+      const map_poi_t *p = &t->pois[c];
+      if (!(q->mask & (1u << p->kind)))
+        continue;
+      uint64_t d = point_dist2(p, q->x, q->y);
+      if (d < knn_bound(q))
+        knn_insert(q, c, d);
+    }
+    return;
+  }
+
+  uint64_t dist[MAP_RTREE_MAX_FANOUT];
+  uint8_t order[MAP_RTREE_MAX_FANOUT];
+  uint8_t n = 0;
+  for (uint32_t c = first; c < last; c++) {
+    uint32_t i = t->start[level - 1] + c;
+    if (!(t->masks[i] & q->mask))
+      continue;
+    uint64_t d = box_dist2(&t->boxes[i], q->x, q->y);
+    if (d >= knn_bound(q))
+      continue;
+    uint8_t j = n++;
+    while (j > 0 && dist[j - 1] > d) {
+      dist[j] = dist[j - 1];
+      order[j] = order[j - 1];
+      j--;
+    }
+    dist[j] = d;
+    order[j] = (uint8_t)(c - first);
+  }
+  for (uint8_t j = 0; j < n && dist[j] < knn_bound(q); j++)
+    knn_visit(q, level - 1, first + order[j]);
+}
+
+uint8_t map_index_nearest(const map_header_t *map, int32_t x, int32_t y,
+                          uint8_t kind_mask, uint8_t k, map_poi_hit_t *hits) {
+  tree_t t;
+  if (!hits || k == 0 || !tree_open(map, &t))
+    return 0;
+  if (k > MAP_POI_MAX_K)
+    k = MAP_POI_MAX_K;
+  if (!(t.masks[t.start[t.levels]] & kind_mask))
+    return 0;
+  knn_query_t q = {.t = &t, .x = x, .y = y, .mask = kind_mask, .k = k,
+                   .hits = hits};
+  knn_visit(&q, t.levels, 0);
+  return q.count;
+}
+
+uint32_t map_index_dist_m(const map_header_t *map, uint64_t dist2) {
+  // sqrt in map units, then 2^unit_log2_cm cm each
+  uint64_t r = geo_isqrt64(dist2);
+  return (uint32_t)(((r << map->unit_log2_cm) + 50) / 100);
+}
+
+uint16_t map_poi_bearing(const map_poi_t *poi, int32_t x, int32_t y) {
+  // Map units are isotropic, so the plain heading is the true bearing
+  uint16_t cdeg = geo_heading_cdeg((int64_t)poi->x - x, (int64_t)poi->y - y);
+  return (uint16_t)((cdeg + 50) / 100 % 360);
+}
+
+void map_nearby_update(int32_t lat_e7, int32_t lon_e7) {
+  const map_header_t *map = map_get();
+  map_nearby_t next = {.lat_e7 = lat_e7, .lon_e7 = lon_e7};
+  map_poi_hit_t hits[MAP_NEARBY_K];
+  int32_t x, y;
+
+  if (map && map_project(lat_e7, lon_e7, &x, &y)) {
+    next.count = map_index_nearest(map, x, y, MAP_POI_KIND_ALL,
+                                   MAP_NEARBY_K, hits);
+    for (uint8_t i = 0; i < next.count; i++) {
+      next.hits[i] = (map_nearby_hit_t){
+          .id = hits[i].id,
+          .dist_m = map_index_dist_m(map, hits[i].dist2),
+          .bearing_deg = map_poi_bearing(map_poi_get(map, hits[i].id), x, y),
+      };
+    }
+  }
+
+  seqlock_write(&nearby_seq, &nearby, &next, sizeof(nearby));
+}
+
+uint32_t map_nearby_get(map_nearby_t *out) {
+  return seqlock_read(&nearby_seq, out, &nearby, sizeof(*out));
+}
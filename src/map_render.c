@@ -0,0 +1,339 @@
+#include "map_render.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "map_data.h"
+#include "map_index.h"
+#include "oled.h"
+
+static const char *TAG = "MAP";
+
+#define MAP_CX (OLED_WIDTH / 2)
+#define MAP_CY (OLED_HEIGHT / 2)
+
+// Clipping region in screen pixels (the OLED clip narrows it further)
+#define CLIP_LEFT 1
+#define CLIP_RIGHT 2
+#define CLIP_BOTTOM 4
+#define CLIP_TOP 8
+
+static const uint8_t *map;
+static const map_header_t *hdr;
+
+// Narrowest zoom level at which each class is drawn, indexed by kind
+static const uint8_t kind_min_zoom[] = {
+    [MAP_KIND_COAST] = 0, [MAP_KIND_ROAD] = 0,     [MAP_KIND_PATH] = 2,
+    [MAP_KIND_PIER] = 1,  [MAP_KIND_AREA] = 1,     [MAP_KIND_BUILDING] = 2,
+    [MAP_KIND_SEAMARK] = 0, [MAP_KIND_BOUNDARY] = 1,
+};
+
+// 8-pixel on/off pattern per class, 0 (unset) means solid
+static const uint8_t kind_pattern[] = {
+    [MAP_KIND_SEAMARK] = 0x55, // dotted
+    [MAP_KIND_BOUNDARY] = 0x33, // dashed
+};
+
+// 5x5 seamark symbols, page layout, indexed by MAP_POI_*
+static const uint8_t poi_icons[][5] = {
+    {0x1F, 0x11, 0x11, 0x11, 0x1F}, // unknown: square
+    {0x0E, 0x11, 0x11, 0x11, 0x0E}, // buoy: ring
+    {0x10, 0x1C, 0x1F, 0x1C, 0x10}, // beacon: triangle
+    {0x11, 0x0A, 0x04, 0x0A, 0x11}, // wreck: cross
+    {0x04, 0x15, 0x0E, 0x15, 0x04}, // light: star
+    {0x1F, 0x11, 0x11, 0x11, 0x1F}, // other: square
+};
+
+// Own position: a diamond cut out of whatever is underneath
+static const uint8_t marker_halo[] = {0x1C, 0x3E, 0x7F, 0x7F,
+                                      0x7F, 0x3E, 0x1C};
+static const uint8_t marker[] = {0x00, 0x08, 0x1C, 0x3E, 0x1C, 0x08, 0x00};
+
+// Node count of the packed R-tree over `count` POIs, 0 if malformed
+static uint32_t rtree_nodes(uint32_t count, uint8_t fanout, uint8_t levels) {
+  uint32_t nodes = 0;
+  for (uint8_t l = 0; l < levels; l++) {
+    count = (count + fanout - 1) / fanout;
+    nodes += count;
+  }
+  return count == 1 ? nodes : 0;
+}
+
+esp_err_t map_open(const uint8_t *blob, uint32_t size) {
+  const map_header_t *h = (const map_header_t *)blob;
+  if (!blob || size < sizeof(*h) || ((uintptr_t)blob & 3))
+    return ESP_ERR_INVALID_ARG;
+  if (h->magic != MAP_MAGIC || h->version != MAP_VERSION) {
+    ESP_LOGE(TAG, "Not a map blob (magic %08lx version %u)",
+             (unsigned long)h->magic, h->version);
+    return ESP_ERR_INVALID_VERSION;
+  }
+  uint32_t tiles_end =
+      h->tiles_off + (uint32_t)h->tiles_x * h->tiles_y * sizeof(map_tile_t);
+  uint64_t pois_end = h->poi_off + (uint64_t)h->poi_count * sizeof(map_poi_t);
+  uint32_t nodes = rtree_nodes(h->poi_count, h->rtree_fanout, h->rtree_levels);
+  bool tree_ok =
+      h->poi_count == 0
+          ? h->rtree_levels == 0
+          : h->rtree_fanout >= 2 && h->rtree_fanout <= MAP_RTREE_MAX_FANOUT &&
+                h->rtree_levels <= MAP_RTREE_MAX_LEVELS && nodes &&
+                h->rtree_off + (uint64_t)nodes * (sizeof(map_bbox_t) + 1) <=
+                    h->names_off;
+  if (h->size > size || tiles_end > h->poi_off || pois_end > h->rtree_off ||
+      h->names_off > h->size || (h->poi_off & 3) || (h->rtree_off & 3) ||
+      !tree_ok || h->unit_log2_cm < 0 ||
+      h->unit_log2_cm > MAP_ZOOM0_LOG2_CM - MAP_ZOOM_LEVELS + 1) {
+    ESP_LOGE(TAG, "Corrupt map header");
+    return ESP_ERR_INVALID_SIZE;
+  }
+  map = blob;
+  hdr = h;
+  ESP_LOGI(TAG, "Map: %u features, %lu points, %ux%u tiles, %lu bytes",
+           h->feature_count, (unsigned long)h->poi_count, h->tiles_x,
+           h->tiles_y, (unsigned long)h->size);
+  return ESP_OK;
+}
+
+static bool map_ready(void) {
+  return hdr || map_open(map_blob, map_blob_size) == ESP_OK;
+}
+
+const map_header_t *map_get(void) { return map_ready() ? hdr : NULL; }
+
+// Same integer math as the generator, so points and fixes agree exactly
+static void map_units(int32_t lat_e7, int32_t lon_e7, int32_t *x,
+                      int32_t *y) {
+  *x = (int32_t)(((int64_t)(lon_e7 - hdr->origin_lon_e7) * hdr->lon_q16) >>
+                 16);
+  *y = (int32_t)(((int64_t)(lat_e7 - hdr->origin_lat_e7) * hdr->lat_q16) >>
+                 16);
+}
+
+bool map_project(int32_t lat_e7, int32_t lon_e7, int32_t *x, int32_t *y) {
+  if (!map_ready())
+    return false;
+  map_units(lat_e7, lon_e7, x, y);
+  return true;
+}
+
+void map_unproject(int32_t x, int32_t y, int32_t *lat_e7, int32_t *lon_e7) {
+  if (!map_ready())
+    return;
+  *lat_e7 = hdr->origin_lat_e7 +
+            (int32_t)((((int64_t)y << 16) + hdr->lat_q16 / 2) / hdr->lat_q16);
+  *lon_e7 = hdr->origin_lon_e7 +
+            (int32_t)((((int64_t)x << 16) + hdr->lon_q16 / 2) / hdr->lon_q16);
+}
+
+bool map_contains(int32_t lat_e7, int32_t lon_e7) {
+  if (!map_ready())
+    return false;
+  int32_t x, y;
+  map_units(lat_e7, lon_e7, &x, &y);
+  return x >= 0 && y >= 0 && x < hdr->width && y < hdr->height;
+}
+
+uint32_t map_scale_m(uint8_t zoom, uint8_t pixels) {
+  return ((uint32_t)pixels << (MAP_ZOOM0_LOG2_CM - zoom)) / 100;
+}
+
+// Viewport and transform for one render
+typedef struct {
+  int32_t cx, cy; // centre in map units
+  int32_t x0, y0, x1, y1;
+  uint8_t shift; // map units to pixels
+  map_render_stats_t *st;
+} view_t;
+
+static bool bbox_visible(const view_t *v, const map_bbox_t *b) {
+  return b->x0 <= b->x1 && b->x0 <= v->x1 && b->x1 >= v->x0 &&
+         b->y0 <= v->y1 && b->y1 >= v->y0;
+}
+
+static inline int32_t to_sx(const view_t *v, int32_t x) {
+  return MAP_CX + ((x - v->cx) >> v->shift);
+}
+
+static inline int32_t to_sy(const view_t *v, int32_t y) {
+  return MAP_CY - ((y - v->cy) >> v->shift);
+}
+
+static uint8_t outcode(int32_t x, int32_t y) {
+  uint8_t c = 0;
+  if (x < 0)
+    c |= CLIP_LEFT;
+  else if (x >= OLED_WIDTH)
+    c |= CLIP_RIGHT;
+  if (y < 0)
+    c |= CLIP_TOP;
+  else if (y >= OLED_HEIGHT)
+    c |= CLIP_BOTTOM;
+  return c;
+}
+
+// Cohen-Sutherland against the screen; products need 64 bits at the
+// closest zoom
+static bool clip_segment(int32_t *x0, int32_t *y0, int32_t *x1,
+                         int32_t *y1) {
+  uint8_t c0 = outcode(*x0, *y0), c1 = outcode(*x1, *y1);
+  while (c0 | c1) {
+    if (c0 & c1)
+      return false;
+    uint8_t c = c0 ? c0 : c1;
+    int64_t dx = *x1 - *x0, dy = *y1 - *y0;
+    int32_t x, y;
+    if (c & CLIP_TOP) {
+      x = *x0 + (int32_t)(dx * (0 - *y0) / dy);
+      y = 0;
+    } else if (c & CLIP_BOTTOM) {
+      x = *x0 + (int32_t)(dx * (OLED_HEIGHT - 1 - *y0) / dy);
+      y = OLED_HEIGHT - 1;
+    } else if (c & CLIP_RIGHT) {
+      y = *y0 + (int32_t)(dy * (OLED_WIDTH - 1 - *x0) / dx);
+      x = OLED_WIDTH - 1;
+    } else {
+      y = *y0 + (int32_t)(dy * (0 - *x0) / dx);
+      x = 0;
+    }
+    if (c == c0) {
+      *x0 = x;
+      *y0 = y;
+      c0 = outcode(x, y);
+    } else {
+      *x1 = x;
+      *y1 = y;
+      c1 = outcode(x, y);
+    }
+  }
+  return true;
+}
+
+// Bresenham with an 8-pixel on/off pattern for dotted classes
+static void draw_pattern_line(int32_t x0, int32_t y0, int32_t x1,
+                              int32_t y1, uint8_t pattern) {
+  int32_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+  int32_t dy = y1 > y0 ? y0 - y1 : y1 - y0;
+  int32_t sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+  int32_t err = dx + dy;
+  for (uint8_t i = 0;; i++) {
+    if (pattern & (1u << (i & 7)))
+      oled_draw_pixel((uint8_t)x0, (uint8_t)y0, true);
+    if (x0 == x1 && y0 == y1)
+      break;
+    int32_t e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+static void draw_segment(const view_t *v, int32_t ax, int32_t ay, int32_t bx,
+                         int32_t by, uint8_t pattern) {
+  int32_t x0 = to_sx(v, ax), y0 = to_sy(v, ay);
+  int32_t x1 = to_sx(v, bx), y1 = to_sy(v, by);
+  if (!clip_segment(&x0, &y0, &x1, &y1))
+    return;
+  v->st->segments++;
+  if (pattern)
+    draw_pattern_line(x0, y0, x1, y1, pattern);
+  else
+    oled_draw_line((uint8_t)x0, (uint8_t)y0, (uint8_t)x1, (uint8_t)y1, true);
+}
+
+// Walks the point stream; segments far outside the view are cut by the
+// clipper's trivial reject
+static void draw_feature(const view_t *v, const map_feature_t *f) {
+  const uint8_t *p = (const uint8_t *)(f + 1);
+  const uint8_t *end = p + f->size;
+  const uint16_t *abs = (const uint16_t *)p;
+  int32_t px = abs[0], py = abs[1];
+  uint8_t pattern = f->kind < sizeof(kind_pattern) ? kind_pattern[f->kind] : 0;
+
+  for (p += 4; p < end; p += 2) {
+    int32_t x, y;
+    if ((int8_t)p[0] == -128) {
+      abs = (const uint16_t *)(p + 2);
+      x = abs[0];
+      y = abs[1];
+      p += 4;
+    } else {
+      x = px + (int8_t)p[0];
+      y = py + (int8_t)p[1];
+    }
+    draw_segment(v, px, py, x, y, pattern);
+    px = x;
+    py = y;
+  }
+  v->st->features++;
+}
+
+static bool draw_poi(uint32_t id, const map_poi_t *poi, void *ctx) {
+  const view_t *v = ctx;
+  uint8_t kind = poi->kind <= MAP_POI_OTHER ? poi->kind : 0;
+  oled_draw_bitmap((int16_t)(to_sx(v, poi->x) - 2),
+                   (int16_t)(to_sy(v, poi->y) - 2), poi_icons[kind], 5, 5,
+                   OLED_BLIT_OR);
+  return true;
+}
+
+// Marks come from the R-tree, so a regional extract costs the same
+static void draw_pois(const view_t *v) {
+  map_bbox_t box = {
+      .x0 = (uint16_t)(v->x0 < 0 ? 0 : (v->x0 > 0xFFFF ? 0xFFFF : v->x0)),
+      .y0 = (uint16_t)(v->y0 < 0 ? 0 : (v->y0 > 0xFFFF ? 0xFFFF : v->y0)),
+      .x1 = (uint16_t)(v->x1 < 0 ? 0 : (v->x1 > 0xFFFF ? 0xFFFF : v->x1)),
+      .y1 = (uint16_t)(v->y1 < 0 ? 0 : (v->y1 > 0xFFFF ? 0xFFFF : v->y1)),
+  };
+  if (v->x1 < 0 || v->y1 < 0 || v->x0 > 0xFFFF || v->y0 > 0xFFFF)
+    return;
+  v->st->pois = (uint16_t)map_index_bbox(hdr, &box, MAP_POI_KIND_ALL,
+                                         draw_poi, (void *)v);
+}
+
+esp_err_t map_render(int32_t lat_e7, int32_t lon_e7, uint8_t zoom,
+                     map_render_stats_t *stats) {
+  if (zoom >= MAP_ZOOM_LEVELS)
+    return ESP_ERR_INVALID_ARG;
+  if (!map_ready())
+    return ESP_ERR_INVALID_STATE;
+
+  int64_t start = esp_timer_get_time();
+  map_render_stats_t st = {0};
+  view_t v = {.shift = MAP_ZOOM0_LOG2_CM - zoom - hdr->unit_log2_cm,
+              .st = &st};
+  map_units(lat_e7, lon_e7, &v.cx, &v.cy);
+  // One pixel of margin so lines leaving the screen are still drawn
+  v.x0 = v.cx - ((MAP_CX + 1) << v.shift);
+  v.x1 = v.cx + ((MAP_CX + 1) << v.shift);
+  v.y0 = v.cy - ((MAP_CY + 1) << v.shift);
+  v.y1 = v.cy + ((MAP_CY + 1) << v.shift);
+
+  const map_tile_t *tile = (const map_tile_t *)(map + hdr->tiles_off);
+  uint16_t tiles = (uint16_t)hdr->tiles_x * hdr->tiles_y;
+  for (uint16_t t = 0; t < tiles; t++, tile++) {
+    if (!bbox_visible(&v, &tile->bbox))
+      continue;
+    st.tiles++;
+    const uint8_t *p = map + tile->offset;
+    for (uint16_t i = 0; i < tile->count; i++) {
+      const map_feature_t *f = (const map_feature_t *)p;
+      p += sizeof(*f) + f->size;
+      if (f->kind < sizeof(kind_min_zoom) && kind_min_zoom[f->kind] > zoom)
+        continue;
+      if (bbox_visible(&v, &f->bbox))
+        draw_feature(&v, f);
+    }
+  }
+  draw_pois(&v);
+
+  oled_draw_bitmap(MAP_CX - 3, MAP_CY - 3, marker_halo, 7, 7, OLED_BLIT_CLEAR);
+  oled_draw_bitmap(MAP_CX - 3, MAP_CY - 3, marker, 7, 7, OLED_BLIT_OR);
+
+  st.render_us = (uint32_t)(esp_timer_get_time() - start);
+  if (stats)
+    *stats = st;
+  return ESP_OK;
+}
@@ -1,8 +1,15 @@
 #include "mqtt_client.h"
 #include "esp_log.h"
 #include "esp_mqtt.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
+#include "fixed_fmt.h"
+#include "gps_filter.h"
 #include "gps_parser.h"
+#include "mqtt_codec.h"
+#include "mqtt_queue.h"
+#include "trip_stats.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -10,6 +17,47 @@ static const char *TAG = "MQTT";
 static esp_mqtt_client_handle_t mqtt_client = NULL;
 static bool mqtt_connected = false;
 
+// Connection manager. The WiFi/IP and client event handlers only cache
+// flags and post EV_* bits; mqtt_service() on the MQTT task owns the state
+// and is the only caller of start/reconnect/disconnect.
+#define EV_NET 0x01 // server network gained or lost
+#define EV_CONNECTED 0x02
+#define EV_DISCONNECTED 0x04
+static uint32_t pending_ev;
+static bool net_ok;  // STA address on the server network
+static bool enabled; // mqtt_connect() called, mqtt_disconnect() not
+static uint32_t connected_at_ms;
+// MQTT task only
+static bool client_started;
+static mqtt_state_t conn_state = MQTT_STATE_IDLE;
+static uint32_t attempt_ms, down_since_ms, up_since_ms, next_attempt_ms;
+static uint32_t backoff_ms = MQTT_BACKOFF_MIN_MS;
+static mqtt_conn_stats_t conn;
+
+// Queue batch in flight, one message per payload format. Acks arrive on
+// the client's task, also for the live and stats messages, so the last few
+// are kept.
+#define FORMAT_COUNT 3
+#define ACKED_IDS 16
+static int inflight_ids[FORMAT_COUNT];
+static uint8_t inflight_n;
+static uint16_t inflight_count;
+static int64_t inflight_us;
+static bool inflight_lost;
+static int acked_ids[ACKED_IDS];
+static uint32_t acked_next;
+// MQTT task only; the client copies QoS 1 payloads to its outbox
+static sd_log_record_t batch[MQTT_BATCH_MAX];
+static uint8_t payload_buf[MQTT_CODEC_MAX_BYTES(MQTT_BATCH_MAX)];
+
+static uint32_t now_ms(void) {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void post_event(uint32_t ev) {
+  __atomic_fetch_or(&pending_ev, ev, __ATOMIC_ACQ_REL);
+}
+
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
                                int32_t event_id, void *event_data) {
   esp_mqtt_event_handle_t event = event_data;
@@ -17,50 +65,63 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
   switch (event->event_id) {
   case MQTT_EVENT_CONNECTED:
     ESP_LOGI(TAG, "MQTT connected");
-    mqtt_connected = true;
+    __atomic_store_n(&connected_at_ms, now_ms(), __ATOMIC_RELAXED);
+    __atomic_store_n(&mqtt_connected, true, __ATOMIC_RELEASE);
+    post_event(EV_CONNECTED);
     break;
   case MQTT_EVENT_DISCONNECTED:
     ESP_LOGI(TAG, "MQTT disconnected");
-    mqtt_connected = false;
+    __atomic_store_n(&mqtt_connected, false, __ATOMIC_RELEASE);
+    post_event(EV_DISCONNECTED);
     break;
   case MQTT_EVENT_PUBLISHED:
     ESP_LOGD(TAG, "MQTT message published");
+    __atomic_store_n(&acked_ids[acked_next % ACKED_IDS], event->msg_id,
+                     __ATOMIC_RELEASE);
+    __atomic_add_fetch(&acked_next, 1, __ATOMIC_RELEASE);
     break;
   case MQTT_EVENT_ERROR:
+    // A failed or lost connection also reports DISCONNECTED
     ESP_LOGE(TAG, "MQTT error");
-    mqtt_connected = false;
     break;
   default:
     break;
   }
 }
 
-static bool is_server_network(void) {
-  esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
-  if (!netif)
-    return false;
-
-  esp_netif_ip_info_t ip_info;
-  esp_err_t ret = esp_netif_get_ip_info(netif, &ip_info);
-  if (ret != ESP_OK)
-    return false;
-
-  // Check if connected to server network (adjust IP range as needed)
-  uint32_t ip = ip_info.ip.addr;
+// Server network, e.g. 192.168.1.x (adjust as needed)
+static bool is_server_ip(uint32_t ip) {
   uint8_t ip_bytes[4];
   ip_bytes[0] = ip & 0xFF;
   ip_bytes[1] = (ip >> 8) & 0xFF;
   ip_bytes[2] = (ip >> 16) & 0xFF;
   ip_bytes[3] = (ip >> 24) & 0xFF;
-
-  // Check if on server network (e.g., 192.168.1.x)
   return (ip_bytes[0] == 192 && ip_bytes[1] == 168 && ip_bytes[2] == 1);
 }
 
+// Default event loop task; the address only changes here
+static void net_event_handler(void *arg, esp_event_base_t base,
+                              int32_t event_id, void *event_data) {
+  bool ok = false;
+  if (base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+    const ip_event_got_ip_t *ev = event_data;
+    ok = is_server_ip(ev->ip_info.ip.addr);
+  }
+  if (__atomic_exchange_n(&net_ok, ok, __ATOMIC_ACQ_REL) != ok)
+    post_event(EV_NET);
+}
+
+// Cached by the IP events, no netif lookup
+static bool is_server_network(void) {
+  return __atomic_load_n(&net_ok, __ATOMIC_ACQUIRE);
+}
+
 esp_err_t mqtt_init(void) {
+  // Reconnects are paced by mqtt_service() with a growing delay
   esp_mqtt_client_config_t mqtt_cfg = {
       .broker.address.hostname = MQTT_BROKER_HOST,
       .broker.address.port = MQTT_BROKER_PORT,
+      .network.disable_auto_reconnect = true,
   };
 
   mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
@@ -71,6 +132,19 @@ esp_err_t mqtt_init(void) {
 
   esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID,
                                  mqtt_event_handler, NULL);
+  esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, net_event_handler,
+                             NULL);
+  esp_event_handler_register(IP_EVENT, IP_EVENT_STA_LOST_IP,
+                             net_event_handler, NULL);
+  esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                             net_event_handler, NULL);
+
+  // The STA may already have its address
+  esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+  esp_netif_ip_info_t ip_info;
+  if (netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK)
+    __atomic_store_n(&net_ok, is_server_ip(ip_info.ip.addr),
+                     __ATOMIC_RELEASE);
 
   ESP_LOGI(TAG, "MQTT client initialized");
   return ESP_OK;
@@ -81,70 +155,293 @@ esp_err_t mqtt_connect(void) {
     ESP_LOGE(TAG, "MQTT client not initialized");
     return ESP_FAIL;
   }
+  __atomic_store_n(&enabled, true, __ATOMIC_RELEASE);
+  post_event(EV_NET);
+  return ESP_OK;
+}
 
-  if (!is_server_network()) {
-    ESP_LOGD(TAG, "Not on server network, skipping MQTT connection");
-    return ESP_OK;
-  }
+esp_err_t mqtt_disconnect(void) {
+  __atomic_store_n(&enabled, false, __ATOMIC_RELEASE);
+  post_event(EV_NET);
+  return ESP_OK;
+}
 
-  esp_err_t ret = esp_mqtt_client_start(mqtt_client);
+static void retry_later(uint32_t now) {
+  conn_state = MQTT_STATE_BACKOFF;
+  // Up to 25% jitter so a fleet does not reconnect in step
+  next_attempt_ms = now + backoff_ms + esp_random() % (backoff_ms / 4 + 1);
+  ESP_LOGD(TAG, "Next attempt in %lu ms", (unsigned long)backoff_ms);
+  backoff_ms = backoff_ms >= MQTT_BACKOFF_MAX_MS / 2 ? MQTT_BACKOFF_MAX_MS
+                                                     : backoff_ms * 2;
+}
+
+static void start_attempt(uint32_t now) {
+  conn.attempts++;
+  attempt_ms = now;
+  conn_state = MQTT_STATE_CONNECTING;
+  // The client task runs from the first start on; later attempts only
+  // reopen the connection
+  esp_err_t ret = client_started ? esp_mqtt_client_reconnect(mqtt_client)
+                                 : esp_mqtt_client_start(mqtt_client);
   if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to start MQTT client: %s", esp_err_to_name(ret));
-    return ret;
+    ESP_LOGW(TAG, "Connect attempt failed: %s", esp_err_to_name(ret));
+    retry_later(now);
+    return;
   }
+  client_started = true;
+}
 
-  ESP_LOGI(TAG, "MQTT client started");
-  return ESP_OK;
+static void on_connected(void) {
+  uint32_t at = __atomic_load_n(&connected_at_ms, __ATOMIC_RELAXED);
+  conn.connects++;
+  conn.connect_ms = at - attempt_ms;
+  conn.reconnect_ms = at - down_since_ms;
+  if (conn.reconnect_ms > conn.max_reconnect_ms)
+    conn.max_reconnect_ms = conn.reconnect_ms;
+  up_since_ms = at;
+  backoff_ms = MQTT_BACKOFF_MIN_MS;
+  conn_state = MQTT_STATE_CONNECTED;
+  ESP_LOGI(TAG, "Connected after %lu ms, attempt %lu ms",
+           (unsigned long)conn.reconnect_ms, (unsigned long)conn.connect_ms);
 }
 
-esp_err_t mqtt_disconnect(void) {
-  if (mqtt_client) {
-    esp_mqtt_client_stop(mqtt_client);
-    mqtt_connected = false;
+// Leaves CONNECTED or CONNECTING; the outage starts now
+static void on_lost(uint32_t now) {
+  if (conn_state == MQTT_STATE_CONNECTED) {
+    conn.drops++;
+    conn.total_up_s += (now - up_since_ms) / 1000;
+    down_since_ms = now;
   }
-  return ESP_OK;
+}
+
+void mqtt_service(void) {
+  if (!mqtt_client)
+    return;
+  uint32_t ev = __atomic_exchange_n(&pending_ev, 0, __ATOMIC_ACQ_REL);
+  uint32_t now = now_ms();
+
+  // A quick flap may post both; the flag says which came last
+  if (ev & (EV_CONNECTED | EV_DISCONNECTED)) {
+    bool up = __atomic_load_n(&mqtt_connected, __ATOMIC_ACQUIRE);
+    if ((ev & EV_CONNECTED) && conn_state != MQTT_STATE_CONNECTED &&
+        conn_state != MQTT_STATE_IDLE)
+      on_connected();
+    if (!up && (conn_state == MQTT_STATE_CONNECTED ||
+                conn_state == MQTT_STATE_CONNECTING)) {
+      on_lost(now);
+      retry_later(now);
+    }
+  }
+
+  if (!__atomic_load_n(&enabled, __ATOMIC_ACQUIRE) || !is_server_network()) {
+    if (conn_state != MQTT_STATE_IDLE) {
+      ESP_LOGI(TAG, "Off the server network, MQTT idle");
+      on_lost(now);
+      if (client_started)
+        esp_mqtt_client_disconnect(mqtt_client);
+      // Down from here, not once the client's DISCONNECTED arrives
+      __atomic_store_n(&mqtt_connected, false, __ATOMIC_RELEASE);
+      conn_state = MQTT_STATE_IDLE;
+    }
+    return;
+  }
+
+  switch (conn_state) {
+  case MQTT_STATE_IDLE:
+    // A usable network starts the outage clock and a fresh backoff
+    down_since_ms = now;
+    backoff_ms = MQTT_BACKOFF_MIN_MS;
+    start_attempt(now);
+    break;
+  case MQTT_STATE_BACKOFF:
+    if ((int32_t)(now - next_attempt_ms) >= 0)
+      start_attempt(now);
+    break;
+  case MQTT_STATE_CONNECTING:
+    if (now - attempt_ms >= MQTT_CONNECT_TIMEOUT_MS) {
+      ESP_LOGW(TAG, "No answer from the broker");
+      retry_later(now);
+    }
+    break;
+  case MQTT_STATE_CONNECTED:
+    break;
+  }
+}
+
+void mqtt_get_conn_stats(mqtt_conn_stats_t *out) {
+  *out = conn;
+  out->state = conn_state;
+  out->backoff_ms = backoff_ms;
+  out->uptime_s = conn_state == MQTT_STATE_CONNECTED
+                      ? (now_ms() - up_since_ms) / 1000
+                      : 0;
+  out->total_up_s += out->uptime_s;
+}
+
+// Publishes the fixes once per format in `formats`, each on topic plus the
+// format's suffix. Returns the message count with their ids in `ids`, or
+// -1 at the first failure.
+static int publish_fixes(const char *topic, uint8_t formats,
+                         const mqtt_batch_id_t *id,
+                         const sd_log_record_t *recs, uint16_t n, int *ids) {
+  int count = 0;
+  for (uint8_t f = MQTT_PAYLOAD_JSON; f <= MQTT_PAYLOAD_PACKED; f <<= 1) {
+    if (!(formats & f))
+      continue;
+    size_t len =
+        mqtt_codec_encode(f, id, recs, n, payload_buf, sizeof(payload_buf));
+    if (!len)
+      return -1;
+    char full[32];
+    snprintf(full, sizeof(full), "%s%s", topic, mqtt_codec_suffix(f));
+    int msg_id = esp_mqtt_client_publish(
+        mqtt_client, full, (const char *)payload_buf, len, 1, 0);
+    if (msg_id < 0)
+      return -1;
+    ids[count++] = msg_id;
+  }
+  return count;
 }
 
 esp_err_t mqtt_publish_gps_data(void) {
-  if (!mqtt_connected || !is_server_network()) {
+  if (!mqtt_is_connected()) {
     return ESP_OK; // Not connected or not on server network
   }
 
-  gps_data_t *gps = gps_get_data();
+  gps_data_t snapshot;
+  gps_get_snapshot(&snapshot);
+  const gps_data_t *gps = &snapshot;
+  char lat[FIXED_FMT_MAX], lon[FIXED_FMT_MAX], alt[FIXED_FMT_MAX];
+  char speed[FIXED_FMT_MAX], course[FIXED_FMT_MAX], hdop[FIXED_FMT_MAX];
+  fixed_fmt(lat, sizeof(lat), gps->lat_e7, 7);
+  fixed_fmt(lon, sizeof(lon), gps->lon_e7, 7);
+  fixed_fmt(alt, sizeof(alt), gps->alt_cm, 2);
+  fixed_fmt(speed, sizeof(speed), (int32_t)gps->speed_ckmh, 2);
+  fixed_fmt(course, sizeof(course), gps->course_cdeg, 2);
+  fixed_fmt(hdop, sizeof(hdop), gps->hdop_e2, 2);
+  // Same "filtered" object as /api/gps, so subscribers can use the
+  // position every other sink logs
+  char filtered[GPS_FILTER_JSON_MAX];
+  gps_filter_json(filtered, sizeof(filtered), esp_timer_get_time());
 
   char json_payload[512];
-  snprintf(json_payload, sizeof(json_payload),
-           "{"
-           "\"device_id\":\"oledgps\","
-           "\"timestamp\":%lu,"
-           "\"valid\":%s,"
-           "\"latitude\":%.8f,"
-           "\"longitude\":%.8f,"
-           "\"altitude\":%.2f,"
-           "\"satellites\":%d,"
-           "\"speed\":%.2f,"
-           "\"course\":%.2f,"
-           "\"gps_time\":\"%s\","
-           "\"gps_date\":\"%s\""
-           "}",
-           (unsigned long)(esp_timer_get_time() / 1000000), // Unix timestamp
-           gps->valid ? "true" : "false", gps->latitude, gps->longitude,
-           gps->altitude, gps->satellites, gps->speed, gps->course,
-           gps->timestamp, gps->date);
-
-  int msg_id = esp_mqtt_client_publish(mqtt_client, MQTT_TOPIC_GPS,
-                                       json_payload, 0, 1, 0);
-  if (msg_id < 0) {
-    ESP_LOGE(TAG, "Failed to publish GPS data");
-    return ESP_FAIL;
+  int len = snprintf(
+      json_payload, sizeof(json_payload),
+      "{"
+      "\"device_id\":\"oledgps\","
+      "\"timestamp\":%lu,"
+      "\"valid\":%s,"
+      "\"latitude\":%s,"
+      "\"longitude\":%s,"
+      "\"altitude\":%s,"
+      "\"satellites\":%d,"
+      "\"speed\":%s,"
+      "\"course\":%s,"
+      "\"gps_time\":\"%s\","
+      "\"gps_date\":\"%s\","
+      "\"fix_type\":%d,"
+      "\"hdop\":%s,"
+      "\"sats_in_view\":%d"
+      "%s}",
+      (unsigned long)(esp_timer_get_time() / 1000000), // Unix timestamp
+      gps->valid ? "true" : "false", lat, lon, alt, gps->satellites, speed,
+      course, gps->timestamp, gps->date, gps->fix_type, hdop,
+      gps->sats_in_view, filtered);
+  if (len <= 0 || len >= (int)sizeof(json_payload))
+    return ESP_ERR_INVALID_SIZE;
+
+  if (MQTT_PAYLOAD_FORMATS & MQTT_PAYLOAD_JSON) {
+    int msg_id = esp_mqtt_client_publish(mqtt_client, MQTT_TOPIC_GPS,
+                                         json_payload, len, 1, 0);
+    if (msg_id < 0) {
+      ESP_LOGE(TAG, "Failed to publish GPS data");
+      return ESP_FAIL;
+    }
+  }
+
+  // Binary formats carry the fix as a one-record batch, so need a fix time
+  sd_log_record_t rec;
+  uint8_t binary = MQTT_PAYLOAD_FORMATS & ~MQTT_PAYLOAD_JSON;
+  int ids[FORMAT_COUNT];
+  if (binary && sd_log_record_from_gps(gps, &rec)) {
+    gps_filter_state_t filt;
+    gps_filter_get(&filt);
+    if (filt.valid) {
+      rec.lat_e7 = filt.lat_e7;
+      rec.lon_e7 = filt.lon_e7;
+      rec.crc8 = sd_log_crc8((const uint8_t *)&rec, sizeof(rec) - 1);
+    }
+    const mqtt_batch_id_t live = {0};
+    if (publish_fixes(MQTT_TOPIC_GPS, binary, &live, &rec, 1, ids) < 0) {
+      ESP_LOGE(TAG, "Failed to publish GPS data");
+      return ESP_FAIL;
+    }
   }
 
   ESP_LOGI(TAG, "GPS data published to MQTT");
   return ESP_OK;
 }
 
+static bool was_acked(int msg_id) {
+  for (int i = 0; i < ACKED_IDS; i++) {
+    if (__atomic_load_n(&acked_ids[i], __ATOMIC_ACQUIRE) == msg_id)
+      return true;
+  }
+  return false;
+}
+
+static bool all_acked(void) {
+  for (uint8_t i = 0; i < inflight_n; i++) {
+    if (!was_acked(inflight_ids[i]))
+      return false;
+  }
+  return true;
+}
+
+esp_err_t mqtt_publish_queue(void) {
+  if (inflight_n) {
+    if (all_acked()) {
+      mqtt_queue_ack(inflight_count);
+      inflight_n = 0;
+    } else if (mqtt_is_connected() &&
+               esp_timer_get_time() - inflight_us <
+                   MQTT_ACK_TIMEOUT_MS * 1000LL) {
+      return ESP_OK;
+    } else {
+      // Peeked again below; the broker may already have it
+      inflight_n = 0;
+      inflight_lost = true;
+    }
+  }
+  if (!mqtt_is_connected()) {
+    mqtt_queue_spill();
+    return ESP_OK;
+  }
+
+  mqtt_batch_id_t id;
+  uint16_t n = mqtt_queue_peek(batch, MQTT_BATCH_MAX, &id);
+  if (!n)
+    return ESP_OK;
+  // A partly published batch is sent again whole on the next tick, with
+  // the same id
+  int count = publish_fixes(MQTT_TOPIC_TRACK, MQTT_PAYLOAD_FORMATS, &id,
+                            batch, n, inflight_ids);
+  if (count <= 0) {
+    ESP_LOGE(TAG, "Failed to publish track batch");
+    return ESP_FAIL;
+  }
+  if (inflight_lost)
+    mqtt_queue_note_resend();
+  inflight_lost = false;
+  inflight_n = (uint8_t)count;
+  inflight_count = n;
+  inflight_us = esp_timer_get_time();
+  ESP_LOGD(TAG, "Track batch of %u fixes in %d formats", n, count);
+  return ESP_OK;
+}
+
 esp_err_t mqtt_publish_status(const char *status) {
-  if (!mqtt_connected || !is_server_network()) {
+  if (!mqtt_is_connected()) {
     return ESP_OK;
   }
 
@@ -159,5 +456,57 @@ esp_err_t mqtt_publish_status(const char *status) {
   return ESP_OK;
 }
 
-bool mqtt_is_connected(void) { return mqtt_connected && is_server_network(); }
+esp_err_t mqtt_publish_trip_stats(void) {
+  if (!mqtt_is_connected())
+    return ESP_OK;
+
+  trip_stats_t st;
+  trip_stats_get(&st);
+  char stats[256], payload[288];
+  if (!trip_stats_json(&st, stats, sizeof(stats)))
+    return ESP_ERR_INVALID_SIZE;
+  // Same object with the device id first
+  snprintf(payload, sizeof(payload), "{\"device_id\":\"oledgps\",%s",
+           stats + 1);
+
+  int msg_id = esp_mqtt_client_publish(mqtt_client, MQTT_TOPIC_STATS, payload,
+                                       0, 1, 1);
+  if (msg_id < 0) {
+    ESP_LOGE(TAG, "Failed to publish trip stats");
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+esp_err_t mqtt_publish_geofence_event(const geofence_event_t *ev) {
+  if (!mqtt_client)
+    return ESP_ERR_INVALID_STATE;
+
+  char lat[FIXED_FMT_MAX], lon[FIXED_FMT_MAX];
+  fixed_fmt(lat, sizeof(lat), ev->lat_e7, 7);
+  fixed_fmt(lon, sizeof(lon), ev->lon_e7, 7);
+  char payload[160];
+  int len = snprintf(payload, sizeof(payload),
+                     "{\"device_id\":\"oledgps\",\"fence\":\"%s\",\"id\":%u,"
+                     "\"event\":\"%s\",\"time\":%lu,\"latitude\":%s,"
+                     "\"longitude\":%s}",
+                     ev->name, ev->id,
+                     ev->transition == GEOFENCE_ENTER ? "enter" : "exit",
+                     (unsigned long)ev->time, lat, lon);
+  if (len <= 0 || len >= (int)sizeof(payload))
+    return ESP_ERR_INVALID_SIZE;
+
+  int msg_id = esp_mqtt_client_enqueue(mqtt_client, MQTT_TOPIC_GEOFENCE,
+                                       payload, len, 1, 0, true);
+  if (msg_id < 0) {
+    ESP_LOGE(TAG, "Failed to queue geofence event");
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+bool mqtt_is_connected(void) {
+  return __atomic_load_n(&mqtt_connected, __ATOMIC_ACQUIRE) &&
+         is_server_network();
+}
 
@@ -0,0 +1,162 @@
+#include "mqtt_codec.h"
+#include "fixed_fmt.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+  uint8_t *buf;
+  size_t size;
+  size_t len;
+  bool overflow;
+} cbor_out_t;
+
+static void cbor_put(cbor_out_t *o, const uint8_t *data, size_t len) {
+  if (o->len + len > o->size) {
+    o->overflow = true;
+    return;
+  }
+  memcpy(o->buf + o->len, data, len);
+  o->len += len;
+}
+
+// Major type and argument in the shortest form (RFC 8949 3.1)
+static void cbor_head(cbor_out_t *o, uint8_t major, uint32_t v) {
+  uint8_t b[5];
+  size_t len;
+  if (v < 24) {
+    b[0] = major << 5 | v;
+    len = 1;
+  } else if (v <= 0xFF) {
+    b[0] = major << 5 | 24;
+    b[1] = v;
+    len = 2;
+  } else if (v <= 0xFFFF) {
+    b[0] = major << 5 | 25;
+    b[1] = v >> 8;
+    b[2] = v;
+    len = 3;
+  } else {
+    b[0] = major << 5 | 26;
+    b[1] = v >> 24;
+    b[2] = v >> 16;
+    b[3] = v >> 8;
+    b[4] = v;
+    len = 5;
+  }
+  cbor_put(o, b, len);
+}
+
+static void cbor_int(cbor_out_t *o, int64_t v) {
+  if (v >= 0)
+    cbor_head(o, 0, (uint32_t)v);
+  else
+    cbor_head(o, 1, (uint32_t)(-1 - v));
+}
+
+static size_t encode_cbor(const mqtt_batch_id_t *id,
+                          const sd_log_record_t *recs, uint16_t n,
+                          uint8_t *buf, size_t size) {
+  cbor_out_t o = {.buf = buf, .size = size};
+  cbor_head(&o, 4, n + 3u);
+  cbor_int(&o, MQTT_CODEC_VERSION);
+  cbor_int(&o, id->session);
+  cbor_int(&o, id->seq);
+  for (uint16_t i = 0; i < n; i++) {
+    const sd_log_record_t *r = &recs[i];
+    const sd_log_record_t *p = i ? &recs[i - 1] : NULL;
+    cbor_head(&o, 4, 9);
+    cbor_int(&o, (int64_t)r->time - (p ? p->time : 0));
+    cbor_int(&o, (int64_t)r->lat_e7 - (p ? p->lat_e7 : 0));
+    cbor_int(&o, (int64_t)r->lon_e7 - (p ? p->lon_e7 : 0));
+    cbor_int(&o, (int64_t)r->alt_cm - (p ? p->alt_cm : 0));
+    cbor_int(&o, r->speed_ckmh);
+    cbor_int(&o, r->course_cdeg);
+    cbor_int(&o, r->satellites);
+    cbor_int(&o, r->hdop_dec);
+    cbor_int(&o, r->flags);
+  }
+  return o.overflow ? 0 : o.len;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+// Records are already little-endian and packed on the target
+static size_t encode_packed(const mqtt_batch_id_t *id,
+                            const sd_log_record_t *recs, uint16_t n,
+                            uint8_t *buf, size_t size) {
+  size_t len = 10 + (size_t)n * sizeof(*recs);
+  if (len > size)
+    return 0;
+  buf[0] = MQTT_CODEC_VERSION;
+  buf[1] = (uint8_t)n;
+  put_u32(buf + 2, id->session);
+  put_u32(buf + 6, id->seq);
+  memcpy(buf + 10, recs, (size_t)n * sizeof(*recs));
+  return len;
+}
+
+// One row per fix in "fields" order
+static size_t encode_json(const mqtt_batch_id_t *id,
+                          const sd_log_record_t *recs, uint16_t n, char *buf,
+                          size_t size) {
+  int len = snprintf(buf, size,
+                     "{\"device_id\":\"oledgps\",\"session\":%lu,"
+                     "\"seq\":%lu,\"fields\":[\"time\",\"latitude\","
+                     "\"longitude\",\"altitude\",\"speed\",\"course\","
+                     "\"satellites\",\"hdop\"],\"fixes\":[",
+                     (unsigned long)id->session, (unsigned long)id->seq);
+  uint16_t i;
+  for (i = 0; i < n && len > 0 && (size_t)len + 80 < size; i++) {
+    const sd_log_record_t *r = &recs[i];
+    char lat[FIXED_FMT_MAX], lon[FIXED_FMT_MAX], alt[FIXED_FMT_MAX];
+    char speed[FIXED_FMT_MAX], course[FIXED_FMT_MAX], hdop[FIXED_FMT_MAX];
+    fixed_fmt(lat, sizeof(lat), r->lat_e7, 7);
+    fixed_fmt(lon, sizeof(lon), r->lon_e7, 7);
+    fixed_fmt(alt, sizeof(alt), r->alt_cm, 2);
+    fixed_fmt(speed, sizeof(speed), r->speed_ckmh, 2);
+    fixed_fmt(course, sizeof(course), r->course_cdeg, 2);
+    fixed_fmt(hdop, sizeof(hdop), r->hdop_dec, 1);
+    len += snprintf(buf + len, size - len, "%s[%lu,%s,%s,%s,%s,%s,%u,%s]",
+                    i ? "," : "", (unsigned long)r->time, lat, lon, alt,
+                    speed, course, r->satellites, hdop);
+  }
+  // Never a shortened batch: the queue acks all n
+  if (i < n || len <= 0 || (size_t)len + 3 > size)
+    return 0;
+  len += snprintf(buf + len, size - len, "]}");
+  return (size_t)len;
+}
+
+const char *mqtt_codec_suffix(uint8_t format) {
+  switch (format) {
+  case MQTT_PAYLOAD_CBOR:
+    return "/cbor";
+  case MQTT_PAYLOAD_PACKED:
+    return "/bin";
+  default:
+    return "";
+  }
+}
+
+size_t mqtt_codec_encode(uint8_t format, const mqtt_batch_id_t *id,
+                         const sd_log_record_t *recs, uint16_t n,
+                         uint8_t *buf, size_t size) {
+  if (!n || n > MQTT_CODEC_MAX_FIXES)
+    return 0;
+  switch (format) {
+  case MQTT_PAYLOAD_JSON:
+    return encode_json(id, recs, n, (char *)buf, size);
+  case MQTT_PAYLOAD_CBOR:
+    return encode_cbor(id, recs, n, buf, size);
+  case MQTT_PAYLOAD_PACKED:
+    return encode_packed(id, recs, n, buf, size);
+  default:
+    return 0;
+  }
+}
@@ -0,0 +1,345 @@
+#include "mqtt_queue.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "geo.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *TAG = "MQTT_QUEUE";
+
+// Spill file: this header, then MQTT_QUEUE_FILE_MAX record slots used as a
+// ring. head/tail count fixes ever written, like the RAM ring, and are the
+// queue indices of mqtt_batch_id_t.
+typedef struct {
+  uint32_t magic;
+  uint32_t session;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t crc32; // of the fields above
+} queue_file_hdr_t;
+
+typedef enum {
+  SRC_NONE = 0,
+  SRC_FILE,
+  SRC_RAM,
+} queue_src_t;
+
+// RAM ring; the ingest task appends at the tail, the MQTT task removes at
+// the head. Counters are free running, slot = counter % MQTT_QUEUE_RAM,
+// and continue the file's indices: spilled fixes keep their index.
+static sd_log_record_t ram[MQTT_QUEUE_RAM];
+static uint32_t ram_at[MQTT_QUEUE_RAM]; // uptime seconds when queued
+static uint32_t ram_head, ram_tail;
+static SemaphoreHandle_t queue_lock;
+static mqtt_queue_stats_t stats;
+static uint32_t session;
+
+// Dead-band reference, ingest task only
+static sd_log_record_t last_queued;
+static bool have_last;
+
+// MQTT task only
+static int file_fd = -1;
+static queue_file_hdr_t file_hdr;
+static queue_src_t peek_src;
+static uint32_t peek_start;
+static uint16_t peek_span;
+static uint32_t peek_seq;
+static sd_log_record_t spill_buf[MQTT_QUEUE_RAM];
+
+static uint32_t new_session(void) {
+  uint32_t s = esp_random();
+  return s ? s : 1; // 0 marks fixes not from the queue
+}
+
+static uint32_t uptime_s(void) {
+  return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+// Moves a free-running head forward to `to`, never back
+static void advance(uint32_t *head, uint32_t to) {
+  if ((int32_t)(to - *head) > 0)
+    *head = to;
+}
+
+static uint16_t course_diff(uint16_t a, uint16_t b) {
+  uint16_t d = a > b ? a - b : b - a;
+  return d > 18000 ? 36000 - d : d;
+}
+
+static bool deadband_pass(const sd_log_record_t *rec) {
+  if (!have_last || rec->time - last_queued.time >= MQTT_DEADBAND_MAX_S)
+    return true;
+  if (geo_distance_cm(last_queued.lat_e7, last_queued.lon_e7, rec->lat_e7,
+                      rec->lon_e7) >= MQTT_DEADBAND_M * 100)
+    return true;
+  return rec->speed_ckmh >= MQTT_DEADBAND_MIN_CKMH &&
+         course_diff(rec->course_cdeg, last_queued.course_cdeg) >=
+             MQTT_DEADBAND_CDEG;
+}
+
+static off_t file_offset(uint32_t idx) {
+  return sizeof(queue_file_hdr_t) +
+         (off_t)(idx % MQTT_QUEUE_FILE_MAX) * sizeof(sd_log_record_t);
+}
+
+static uint32_t hdr_crc(const queue_file_hdr_t *h) {
+  return sd_log_crc32(0, (const uint8_t *)h,
+                      offsetof(queue_file_hdr_t, crc32));
+}
+
+static bool write_at(off_t offset, const void *data, size_t len) {
+  return lseek(file_fd, offset, SEEK_SET) == offset &&
+         write(file_fd, data, len) == (ssize_t)len;
+}
+
+static bool read_at(off_t offset, void *data, size_t len) {
+  return lseek(file_fd, offset, SEEK_SET) == offset &&
+         read(file_fd, data, len) == (ssize_t)len;
+}
+
+// Header last and fsync'd, so a power cut leaves either the old or the new
+// window over records already on the card
+static bool write_hdr(void) {
+  file_hdr.crc32 = hdr_crc(&file_hdr);
+  return write_at(0, &file_hdr, sizeof(file_hdr)) && fsync(file_fd) == 0;
+}
+
+// Ring slots [idx, idx + n) split where the file wraps
+static bool file_io(uint32_t idx, sd_log_record_t *recs, uint32_t n,
+                    bool write) {
+  while (n > 0) {
+    uint32_t chunk = MQTT_QUEUE_FILE_MAX - idx % MQTT_QUEUE_FILE_MAX;
+    if (chunk > n)
+      chunk = n;
+    size_t len = chunk * sizeof(*recs);
+    if (write ? !write_at(file_offset(idx), recs, len)
+              : !read_at(file_offset(idx), recs, len))
+      return false;
+    idx += chunk;
+    recs += chunk;
+    n -= chunk;
+  }
+  return true;
+}
+
+static void file_disable(const char *what) {
+  ESP_LOGW(TAG, "Spill file %s failed, queue stays in RAM", what);
+  close(file_fd);
+  file_fd = -1;
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  stats.dropped += file_hdr.tail - file_hdr.head;
+  stats.file = 0;
+  xSemaphoreGive(queue_lock);
+}
+
+esp_err_t mqtt_queue_init(const char *spill_path) {
+  queue_lock = xSemaphoreCreateMutex();
+  if (!queue_lock)
+    return ESP_ERR_NO_MEM;
+  // Without a file the queue, and so its indices, start over every boot
+  session = new_session();
+  if (!spill_path)
+    return ESP_OK;
+
+  file_fd = open(spill_path, O_RDWR | O_CREAT, 0644);
+  if (file_fd < 0) {
+    ESP_LOGW(TAG, "Cannot open %s, queue stays in RAM", spill_path);
+    return ESP_FAIL;
+  }
+  if (!read_at(0, &file_hdr, sizeof(file_hdr)) ||
+      file_hdr.magic != MQTT_QUEUE_FILE_MAGIC ||
+      file_hdr.crc32 != hdr_crc(&file_hdr) ||
+      file_hdr.tail - file_hdr.head > MQTT_QUEUE_FILE_MAX) {
+    file_hdr = (queue_file_hdr_t){.magic = MQTT_QUEUE_FILE_MAGIC,
+                                  .session = session};
+    if (!write_hdr()) {
+      file_disable("init");
+      return ESP_FAIL;
+    }
+  }
+  session = file_hdr.session;
+  ram_head = ram_tail = file_hdr.tail;
+  stats.file = file_hdr.tail - file_hdr.head;
+  ESP_LOGI(TAG, "%s: %lu fixes waiting", spill_path,
+           (unsigned long)stats.file);
+  return ESP_OK;
+}
+
+bool mqtt_queue_offer(const sd_log_record_t *rec) {
+  if (!queue_lock)
+    return false;
+  bool pass = deadband_pass(rec);
+  if (pass) {
+    last_queued = *rec;
+    have_last = true;
+  }
+
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  stats.offered++;
+  if (pass) {
+    if (ram_tail - ram_head == MQTT_QUEUE_RAM) {
+      ram_head++;
+      stats.dropped++;
+    }
+    ram[ram_tail % MQTT_QUEUE_RAM] = *rec;
+    ram_at[ram_tail % MQTT_QUEUE_RAM] = uptime_s();
+    ram_tail++;
+    stats.queued++;
+    stats.ram = ram_tail - ram_head;
+  }
+  xSemaphoreGive(queue_lock);
+  return pass;
+}
+
+// Torn or stale slots (CRC mismatch) are skipped but still consumed by the
+// ack, so they cannot block the queue. A batch is one run of good slots,
+// so fix i still has index seq + i.
+static uint16_t peek_file(sd_log_record_t *out, uint16_t max) {
+  uint32_t n = file_hdr.tail - file_hdr.head;
+  if (n > max)
+    n = max;
+  if (!file_io(file_hdr.head, out, n, false)) {
+    file_disable("read");
+    return 0;
+  }
+  uint32_t skip = 0, valid = 0;
+  while (skip < n && !sd_log_record_valid(&out[skip]))
+    skip++;
+  while (skip + valid < n && sd_log_record_valid(&out[skip + valid]))
+    valid++;
+  memmove(out, out + skip, valid * sizeof(*out));
+  peek_src = SRC_FILE;
+  peek_start = file_hdr.head;
+  peek_span = (uint16_t)(skip + valid);
+  peek_seq = file_hdr.head + skip;
+  return (uint16_t)valid;
+}
+
+uint16_t mqtt_queue_peek(sd_log_record_t *out, uint16_t max,
+                         mqtt_batch_id_t *id) {
+  peek_src = SRC_NONE;
+  if (!queue_lock || !max)
+    return 0;
+  id->session = session;
+  // Everything in the file is older than the RAM ring
+  while (file_fd >= 0 && file_hdr.tail != file_hdr.head) {
+    uint16_t n = peek_file(out, max);
+    if (n) {
+      id->seq = peek_seq;
+      return n;
+    }
+    if (peek_src == SRC_FILE)
+      mqtt_queue_ack(0);
+  }
+
+  uint16_t n = 0;
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  uint32_t count = ram_tail - ram_head;
+  uint32_t age = count ? uptime_s() - ram_at[ram_head % MQTT_QUEUE_RAM] : 0;
+  if (count && (count >= MQTT_BATCH_MAX || age >= MQTT_BATCH_MAX_AGE_S)) {
+    n = count < max ? (uint16_t)count : max;
+    for (uint16_t i = 0; i < n; i++)
+      out[i] = ram[(ram_head + i) % MQTT_QUEUE_RAM];
+    peek_src = SRC_RAM;
+    peek_start = ram_head;
+    peek_span = n;
+    id->seq = ram_head;
+  }
+  xSemaphoreGive(queue_lock);
+  return n;
+}
+
+// `count` is the number of fixes the broker got; the file span also covers
+// skipped slots
+void mqtt_queue_ack(uint16_t count) {
+  if (peek_src == SRC_FILE) {
+    advance(&file_hdr.head, peek_start + peek_span);
+    if (!write_hdr())
+      file_disable("write");
+  }
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  if (peek_src == SRC_RAM)
+    advance(&ram_head, peek_start + peek_span);
+  if (peek_src != SRC_NONE && count) {
+    stats.sent += count;
+    stats.batches++;
+  }
+  stats.ram = ram_tail - ram_head;
+  stats.file = file_fd >= 0 ? file_hdr.tail - file_hdr.head : 0;
+  xSemaphoreGive(queue_lock);
+  peek_src = SRC_NONE;
+}
+
+void mqtt_queue_note_resend(void) {
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  stats.resent++;
+  xSemaphoreGive(queue_lock);
+}
+
+void mqtt_queue_spill(void) {
+  if (file_fd < 0 || !queue_lock)
+    return;
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  uint32_t start = ram_head, n = ram_tail - ram_head;
+  if (n >= MQTT_QUEUE_SPILL_AT) {
+    for (uint32_t i = 0; i < n; i++)
+      spill_buf[i] = ram[(start + i) % MQTT_QUEUE_RAM];
+  }
+  xSemaphoreGive(queue_lock);
+  if (n < MQTT_QUEUE_SPILL_AT)
+    return;
+
+  // An empty file restarts at the RAM head, so a batch that was in flight
+  // from RAM keeps its indices in the file
+  if (file_hdr.head == file_hdr.tail)
+    file_hdr.head = file_hdr.tail = start;
+  // The card is written without the lock; the ingest task keeps appending
+  uint32_t lost = 0;
+  if (file_hdr.tail + n - file_hdr.head > MQTT_QUEUE_FILE_MAX) {
+    uint32_t head = file_hdr.tail + n - MQTT_QUEUE_FILE_MAX;
+    lost = head - file_hdr.head;
+    file_hdr.head = head;
+  }
+  if (!file_io(file_hdr.tail, spill_buf, n, true)) {
+    file_disable("write");
+    return;
+  }
+  file_hdr.tail += n;
+  if (!write_hdr()) {
+    file_disable("write");
+    return;
+  }
+
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  advance(&ram_head, start + n);
+  stats.spilled += n;
+  stats.dropped += lost;
+  stats.ram = ram_tail - ram_head;
+  stats.file = file_hdr.tail - file_hdr.head;
+  xSemaphoreGive(queue_lock);
+}
+
+uint32_t mqtt_queue_backlog(void) {
+  if (!queue_lock)
+    return 0;
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  uint32_t n = ram_tail - ram_head;
+  xSemaphoreGive(queue_lock);
+  return n + (file_fd >= 0 ? file_hdr.tail - file_hdr.head : 0);
+}
+
+void mqtt_queue_get_stats(mqtt_queue_stats_t *out) {
+  if (!queue_lock) {
+    *out = stats;
+    return;
+  }
+  xSemaphoreTake(queue_lock, portMAX_DELAY);
+  *out = stats;
+  xSemaphoreGive(queue_lock);
+}
@@ -0,0 +1,246 @@
+#include "nmea.h"
+
+static inline bool is_field_end(char c) {
+  return c == ',' || c == '*' || c == '\r' || c == '\n' || c == '\0';
+}
+
+int nmea_split(const char *sentence, nmea_field_t *fields, int max_fields) {
+  if (!sentence || max_fields <= 0)
+    return 0;
+
+  const char *p = sentence;
+  if (*p == '$' || *p == '!')
+    p++;
+
+  int n = 0;
+  while (n < max_fields) {
+    const char *start = p;
+    while (!is_field_end(*p))
+      p++;
+    fields[n].ptr = start;
+    fields[n].len = (uint8_t)(p - start);
+    n++;
+    if (*p != ',')
+      break;
+    p++;
+  }
+  return n;
+}
+
+bool nmea_parse_uint(const nmea_field_t *f, uint32_t *out) {
+  if (!f || f->len == 0)
+    return false;
+
+  uint32_t v = 0;
+  for (uint8_t i = 0; i < f->len; i++) {
+    char c = f->ptr[i];
+    if (c < '0' || c > '9' || v > (UINT32_MAX - (uint32_t)(c - '0')) / 10)
+      return false;
+    v = v * 10 + (uint32_t)(c - '0');
+  }
+  *out = v;
+  return true;
+}
+
+// Scans [sign]int[.frac] into int_part and a fraction scaled to `decimals`
+static bool parse_decimal(const nmea_field_t *f, uint8_t decimals,
+                          bool *negative, uint32_t *int_part,
+                          uint32_t *frac_part) {
+  if (!f || f->len == 0)
+    return false;
+
+  uint8_t i = 0;
+  *negative = false;
+  if (f->ptr[0] == '-' || f->ptr[0] == '+') {
+    *negative = (f->ptr[0] == '-');
+    i++;
+  }
+
+  uint32_t ip = 0;
+  uint8_t digits = 0;
+  for (; i < f->len && f->ptr[i] != '.'; i++) {
+    char c = f->ptr[i];
+    if (c < '0' || c > '9' || ip > (UINT32_MAX - (uint32_t)(c - '0')) / 10)
+      return false;
+    ip = ip * 10 + (uint32_t)(c - '0');
+    digits++;
+  }
+
+  uint32_t fp = 0;
+  uint8_t used = 0;
+  if (i < f->len) {
+    i++; // skip '.'
+    for (; i < f->len; i++) {
+      char c = f->ptr[i];
+      if (c < '0' || c > '9')
+        return false;
+      if (used < decimals) {
+        fp = fp * 10 + (uint32_t)(c - '0');
+        used++;
+      }
+      digits++;
+    }
+  }
+  if (digits == 0)
+    return false;
+
+  for (; used < decimals; used++)
+    fp *= 10;
+
+  *int_part = ip;
+  *frac_part = fp;
+  return true;
+}
+
+static const uint32_t pow10_table[] = {1,      10,      100,      1000,
+                                       10000,  100000,  1000000,  10000000,
+                                       100000000};
+
+bool nmea_parse_fixed(const nmea_field_t *f, uint8_t decimals, int32_t *out) {
+  if (decimals > 8)
+    return false;
+
+  bool negative;
+  uint32_t ip, fp;
+  if (!parse_decimal(f, decimals, &negative, &ip, &fp))
+    return false;
+
+  int64_t v = (int64_t)ip * pow10_table[decimals] + fp;
+  if (v > INT32_MAX)
+    return false;
+  *out = negative ? -(int32_t)v : (int32_t)v;
+  return true;
+}
+
+bool nmea_parse_coord(const nmea_field_t *f, const nmea_field_t *hemi,
+                      int32_t *out_e7) {
+  bool negative;
+  uint32_t ip, frac_e7;
+  if (!parse_decimal(f, 7, &negative, &ip, &frac_e7) || negative)
+    return false;
+
+  // N/S is a latitude; E/W or no hemisphere is taken as a longitude
+  char h = hemi && hemi->len > 0 ? hemi->ptr[0] : '\0';
+  uint32_t max_deg = h == 'N' || h == 'S' ? 90 : 180;
+  uint32_t degrees = ip / 100;
+  uint32_t minutes = ip % 100;
+  if (degrees > max_deg || minutes >= 60)
+    return false;
+
+  // minutes * 1e7 / 60, rounded to nearest
+  uint64_t minutes_e7 = (uint64_t)minutes * 10000000u + frac_e7;
+  uint32_t v = degrees * 10000000u + (uint32_t)((minutes_e7 + 30) / 60);
+  if (v > max_deg * 10000000u)
+    return false;
+
+  *out_e7 = h == 'S' || h == 'W' ? -(int32_t)v : (int32_t)v;
+  return true;
+}
+
+enum {
+  FRAMER_IDLE = 0, // waiting for '$'
+  FRAMER_BODY,     // accumulating payload and running XOR
+  FRAMER_CK_HI,    // first checksum digit
+  FRAMER_CK_LO,    // second checksum digit
+  FRAMER_EOL,      // checksum read, waiting for CR/LF
+};
+
+static int hex_value(uint8_t c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+static void framer_start(nmea_framer_t *fr) {
+  fr->buf[0] = '$';
+  fr->len = 1;
+  fr->checksum = 0;
+  fr->expected = 0;
+  fr->state = FRAMER_BODY;
+}
+
+static bool framer_put(nmea_framer_t *fr, uint8_t c) {
+  if (fr->len >= NMEA_MAX_SENTENCE) {
+    fr->stats.truncated++;
+    fr->state = FRAMER_IDLE;
+    return false;
+  }
+  fr->buf[fr->len++] = (char)c;
+  return true;
+}
+
+void nmea_framer_init(nmea_framer_t *fr) {
+  fr->len = 0;
+  fr->state = FRAMER_IDLE;
+  fr->checksum = 0;
+  fr->expected = 0;
+  fr->stats = (nmea_framer_stats_t){0};
+}
+
+void nmea_framer_feed(nmea_framer_t *fr, const uint8_t *data, size_t len,
+                      nmea_frame_cb_t cb, void *ctx) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t c = data[i];
+
+    // A '$' always starts a new frame; anything in progress was cut short
+    if (c == '$') {
+      if (fr->state != FRAMER_IDLE)
+        fr->stats.truncated++;
+      framer_start(fr);
+      continue;
+    }
+
+    switch (fr->state) {
+    case FRAMER_IDLE:
+      break;
+
+    case FRAMER_BODY:
+      if (c == '*') {
+        if (framer_put(fr, c))
+          fr->state = FRAMER_CK_HI;
+      } else if (c == '\r' || c == '\n') {
+        fr->stats.truncated++;
+        fr->state = FRAMER_IDLE;
+      } else if (framer_put(fr, c)) {
+        fr->checksum ^= c;
+      }
+      break;
+
+    case FRAMER_CK_HI:
+    case FRAMER_CK_LO: {
+      int v = hex_value(c);
+      if (v < 0) {
+        fr->stats.bad_checksum++;
+        fr->state = FRAMER_IDLE;
+        break;
+      }
+      if (!framer_put(fr, c))
+        break;
+      fr->expected = (uint8_t)((fr->expected << 4) | v);
+      fr->state = (fr->state == FRAMER_CK_HI) ? FRAMER_CK_LO : FRAMER_EOL;
+      break;
+    }
+
+    case FRAMER_EOL:
+      if (c != '\r' && c != '\n') {
+        fr->stats.truncated++;
+        fr->state = FRAMER_IDLE;
+        break;
+      }
+      fr->state = FRAMER_IDLE;
+      if (fr->expected != fr->checksum) {
+        fr->stats.bad_checksum++;
+        break;
+      }
+      fr->buf[fr->len] = '\0';
+      fr->stats.good++;
+      if (cb)
+        cb(fr->buf, ctx);
+      break;
+    }
+  }
+}
@@ -1,66 +1,75 @@
 #include "oled.h"
-#include "driver/i2c.h"
 #include "esp_log.h"
-#include "pins.h"
+#include "oled_backend.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "OLED";
-static uint8_t oled_buffer[OLED_WIDTH * OLED_HEIGHT / 8];
-static uint8_t oled_addr = 0;
+static uint8_t oled_buffer[OLED_WIDTH * OLED_HEIGHT / 8]
+    __attribute__((aligned(4)));
+// What the panel currently shows; only bytes that differ are sent
+static uint8_t oled_shadow[OLED_WIDTH * OLED_HEIGHT / 8];
+static bool oled_shadow_valid = false;
+// Per-page column range touched since the last refresh (lo > hi: clean)
+static uint8_t dirty_lo[OLED_PAGES];
+static uint8_t dirty_hi[OLED_PAGES];
+static const oled_backend_t *oled_backend;
 static bool oled_initialized = false;
+static oled_stats_t oled_stats;
+
+// Text state: cursor is the top-left of the next glyph, `cursor_x0` the
+// column '\n' returns to. Everything is clipped to [clip_x0,clip_x1) x
+// [clip_y0,clip_y1).
+static const oled_font_t *text_font = &oled_font_5x7;
+static int16_t cursor_x, cursor_y, cursor_x0;
+static uint8_t clip_x0 = 0, clip_y0 = 0;
+static uint8_t clip_x1 = OLED_WIDTH, clip_y1 = OLED_HEIGHT;
+
+// Bus accounting assumes I2C framing: address and control byte per
+// transaction on top of the payload
+static void count_transfer(size_t len) {
+  oled_stats.bytes += len + 2;
+  oled_stats.transactions++;
+}
 
-static esp_err_t oled_write_cmd(uint8_t cmd) {
-  i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
-  i2c_master_start(cmd_handle);
-  i2c_master_write_byte(cmd_handle, (oled_addr << 1) | I2C_MASTER_WRITE, true);
-  i2c_master_write_byte(cmd_handle, 0x00, true); // Control byte: command
-  i2c_master_write_byte(cmd_handle, cmd, true);
-  i2c_master_stop(cmd_handle);
-  esp_err_t ret =
-      i2c_master_cmd_begin(I2C_NUM_0, cmd_handle, pdMS_TO_TICKS(100));
-  i2c_cmd_link_delete(cmd_handle);
-  return ret;
+// Control byte 0x00 (Co = 0): every following byte is a command, so a whole
+// command sequence costs a single START/address
+static esp_err_t oled_write_cmds(const uint8_t *cmds, size_t len) {
+  count_transfer(len);
+  return oled_backend->write_cmds(cmds, len);
 }
 
-static esp_err_t oled_write_data(uint8_t *data, size_t len) {
-  i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
-  i2c_master_start(cmd_handle);
-  i2c_master_write_byte(cmd_handle, (oled_addr << 1) | I2C_MASTER_WRITE, true);
-  i2c_master_write_byte(cmd_handle, 0x40, true); // Control byte: data
-  i2c_master_write(cmd_handle, data, len, true);
-  i2c_master_stop(cmd_handle);
-  esp_err_t ret =
-      i2c_master_cmd_begin(I2C_NUM_0, cmd_handle, pdMS_TO_TICKS(100));
-  i2c_cmd_link_delete(cmd_handle);
-  return ret;
+static esp_err_t oled_write_data(const uint8_t *data, size_t len) {
+  count_transfer(len);
+  return oled_backend->write_data(data, len);
 }
 
-static esp_err_t oled_detect_address(void) {
-  // Try common OLED addresses
-  uint8_t addresses[] = {OLED_ADDR_1, OLED_ADDR_2};
+static void mark_clean(void) {
+  memset(dirty_lo, 0xFF, sizeof(dirty_lo));
+  memset(dirty_hi, 0, sizeof(dirty_hi));
+}
 
-  for (int i = 0; i < 2; i++) {
-    oled_addr = addresses[i];
-    esp_err_t ret = oled_write_cmd(OLED_CMD_DISPLAY_OFF);
-    if (ret == ESP_OK) {
-      ESP_LOGI(TAG, "OLED found at address 0x%02X", oled_addr);
-      return ESP_OK;
-    }
-  }
+static void mark_all_dirty(void) {
+  memset(dirty_lo, 0, sizeof(dirty_lo));
+  memset(dirty_hi, OLED_WIDTH - 1, sizeof(dirty_hi));
+}
 
-  ESP_LOGE(TAG, "OLED not found at any address");
-  return ESP_FAIL;
+static inline void mark_dirty(uint8_t page, uint8_t x) {
+  if (x < dirty_lo[page])
+    dirty_lo[page] = x;
+  if (x > dirty_hi[page])
+    dirty_hi[page] = x;
 }
 
-esp_err_t oled_init(void) {
+esp_err_t oled_init_backend(const oled_backend_t *backend) {
   if (oled_initialized)
     return ESP_OK;
 
-  // Detect OLED address
-  esp_err_t ret = oled_detect_address();
+  oled_backend = backend;
+  esp_err_t ret = backend->probe();
   if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to detect OLED");
+    ESP_LOGE(TAG, "Failed to detect OLED (%s)", backend->name);
     return ret;
   }
 
@@ -91,20 +100,18 @@ esp_err_t oled_init(void) {
                              OLED_CMD_NORMAL_DISPLAY,
                              OLED_CMD_DISPLAY_ON};
 
-  for (int i = 0; i < sizeof(init_commands); i++) {
-    ret = oled_write_cmd(init_commands[i]);
-    if (ret != ESP_OK) {
-      ESP_LOGE(TAG, "Failed to send init command %d", i);
-      return ret;
-    }
-    vTaskDelay(pdMS_TO_TICKS(1));
+  ret = oled_write_cmds(init_commands, sizeof(init_commands));
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to send init commands");
+    return ret;
   }
 
-  // Clear display
+  // Panel RAM content is unknown: the first refresh sends everything
+  oled_initialized = true;
   memset(oled_buffer, 0, sizeof(oled_buffer));
+  oled_shadow_valid = false;
   oled_display();
 
-  oled_initialized = true;
   ESP_LOGI(TAG, "OLED initialized successfully");
   return ESP_OK;
 }
@@ -113,70 +120,262 @@ esp_err_t oled_clear(void) {
   if (!oled_initialized)
     return ESP_FAIL;
   memset(oled_buffer, 0, sizeof(oled_buffer));
+  mark_all_dirty();
+  cursor_x = cursor_x0 = 0;
+  cursor_y = 0;
   return ESP_OK;
 }
 
+esp_err_t oled_invalidate(void) {
+  if (!oled_initialized)
+    return ESP_FAIL;
+  oled_shadow_valid = false;
+  return ESP_OK;
+}
+
+// Sets the column/page window and streams `len` bytes into it: one command
+// transaction plus one data transaction
+static esp_err_t send_window(uint8_t col0, uint8_t col1, uint8_t page0,
+                             uint8_t page1, const uint8_t *data, size_t len) {
+  uint8_t commands[] = {OLED_CMD_COLUMN_ADDR, col0,  col1,
+                        OLED_CMD_PAGE_ADDR,   page0, page1};
+  esp_err_t ret = oled_write_cmds(commands, sizeof(commands));
+  if (ret != ESP_OK)
+    return ret;
+  return oled_write_data(data, len);
+}
+
 esp_err_t oled_display(void) {
   if (!oled_initialized)
     return ESP_FAIL;
 
-  uint8_t commands[] = {OLED_CMD_COLUMN_ADDR, 0, OLED_WIDTH - 1,
-                        OLED_CMD_PAGE_ADDR,   0, (OLED_HEIGHT / 8) - 1};
+  uint32_t bytes = oled_stats.bytes;
+  uint32_t transactions = oled_stats.transactions;
+  esp_err_t ret = ESP_OK;
 
-  for (int i = 0; i < sizeof(commands); i++) {
-    esp_err_t ret = oled_write_cmd(commands[i]);
-    if (ret != ESP_OK)
-      return ret;
+  if (!oled_shadow_valid) {
+    ret = send_window(0, OLED_WIDTH - 1, 0, OLED_PAGES - 1, oled_buffer,
+                      sizeof(oled_buffer));
+    if (ret == ESP_OK) {
+      memcpy(oled_shadow, oled_buffer, sizeof(oled_shadow));
+      oled_shadow_valid = true;
+      mark_clean();
+    }
+  } else {
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+      if (dirty_lo[page] > dirty_hi[page])
+        continue;
+
+      // Trim the touched range to the bytes that really differ
+      const uint8_t *buf = &oled_buffer[page * OLED_WIDTH];
+      uint8_t *shadow = &oled_shadow[page * OLED_WIDTH];
+      int lo = dirty_lo[page], hi = dirty_hi[page];
+      while (lo <= hi && buf[lo] == shadow[lo])
+        lo++;
+      while (hi >= lo && buf[hi] == shadow[hi])
+        hi--;
+
+      if (lo <= hi) {
+        esp_err_t r = send_window(lo, hi, page, page, &buf[lo], hi - lo + 1);
+        if (r != ESP_OK) {
+          ret = r; // stays dirty, retried on the next refresh
+          continue;
+        }
+        memcpy(&shadow[lo], &buf[lo], hi - lo + 1);
+      }
+      dirty_lo[page] = 0xFF;
+      dirty_hi[page] = 0;
+    }
   }
 
-  return oled_write_data(oled_buffer, sizeof(oled_buffer));
+  oled_stats.last_bytes = (uint16_t)(oled_stats.bytes - bytes);
+  oled_stats.last_transactions =
+      (uint8_t)(oled_stats.transactions - transactions);
+  if (oled_stats.last_transactions > 0)
+    oled_stats.frames++;
+  else
+    oled_stats.skipped++;
+  return ret;
 }
 
+void oled_get_stats(oled_stats_t *stats) { *stats = oled_stats; }
+
 esp_err_t oled_set_cursor(uint8_t x, uint8_t y) {
   if (!oled_initialized || x >= OLED_WIDTH || y >= OLED_HEIGHT)
     return ESP_FAIL;
-  // Cursor position is handled in print functions
+  cursor_x = cursor_x0 = x;
+  cursor_y = y;
   return ESP_OK;
 }
 
-esp_err_t oled_draw_pixel(uint8_t x, uint8_t y, bool color) {
-  if (!oled_initialized || x >= OLED_WIDTH || y >= OLED_HEIGHT)
-    return ESP_FAIL;
+void oled_set_font(const oled_font_t *font) {
+  text_font = font ? font : &oled_font_5x7;
+}
 
-  uint16_t index = x + (y / 8) * OLED_WIDTH;
-  uint8_t bit = y % 8;
+esp_err_t oled_set_clip(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+  if (x >= OLED_WIDTH || y >= OLED_HEIGHT)
+    return ESP_ERR_INVALID_ARG;
+  clip_x0 = x;
+  clip_y0 = y;
+  clip_x1 = (x + w > OLED_WIDTH) ? OLED_WIDTH : x + w;
+  clip_y1 = (y + h > OLED_HEIGHT) ? OLED_HEIGHT : y + h;
+  return ESP_OK;
+}
 
-  if (color) {
-    oled_buffer[index] |= (1 << bit);
-  } else {
-    oled_buffer[index] &= ~(1 << bit);
+void oled_reset_clip(void) {
+  clip_x0 = clip_y0 = 0;
+  clip_x1 = OLED_WIDTH;
+  clip_y1 = OLED_HEIGHT;
+}
+
+uint16_t oled_text_width(const char *str) {
+  uint16_t n = 0;
+  while (str[n] && str[n] != '\n')
+    n++;
+  return n * text_font->advance;
+}
+
+// Bits of `page` that fall inside rows [y0, y1)
+static uint8_t page_rows(int page, int y0, int y1) {
+  int top = page * 8;
+  uint8_t mask = 0xFF;
+  if (y0 > top)
+    mask = (y0 - top >= 8) ? 0 : (uint8_t)(mask << (y0 - top));
+  if (y1 < top + 8)
+    mask = (top + 8 - y1 >= 8) ? 0 : (uint8_t)(mask & (0xFF >> (top + 8 - y1)));
+  return mask;
+}
+
+// Intersects [x, x+w) x [y, y+h) with the clip rectangle; false if empty
+static bool clip_rect(int x, int y, int w, int h, int *x0, int *y0, int *x1,
+                      int *y1) {
+  *x0 = x > clip_x0 ? x : clip_x0;
+  *y0 = y > clip_y0 ? y : clip_y0;
+  *x1 = x + w < clip_x1 ? x + w : clip_x1;
+  *y1 = y + h < clip_y1 ? y + h : clip_y1;
+  return *x0 < *x1 && *y0 < *y1;
+}
+
+// Masked span ops, a 32-bit word at a time once the pointer is aligned
+static void span_or(uint8_t *p, int n, uint8_t m) {
+  uint32_t m32 = m * 0x01010101u;
+  for (; n > 0 && ((uintptr_t)p & 3); n--)
+    *p++ |= m;
+  for (; n >= 4; n -= 4, p += 4) {
+    uint32_t w;
+    memcpy(&w, p, 4);
+    w |= m32;
+    memcpy(p, &w, 4);
   }
-  return ESP_OK;
+  for (; n > 0; n--)
+    *p++ |= m;
+}
+
+static void span_and(uint8_t *p, int n, uint8_t m) {
+  uint32_t m32 = m * 0x01010101u;
+  for (; n > 0 && ((uintptr_t)p & 3); n--)
+    *p++ &= m;
+  for (; n >= 4; n -= 4, p += 4) {
+    uint32_t w;
+    memcpy(&w, p, 4);
+    w &= m32;
+    memcpy(p, &w, 4);
+  }
+  for (; n > 0; n--)
+    *p++ &= m;
+}
+
+// Fills a clipped rectangle: per page one row mask, then a memset for full
+// pages or a masked span for the partial top/bottom page
+static void fill_area(int x, int y, int w, int h, bool color) {
+  int x0, y0, x1, y1;
+  if (!clip_rect(x, y, w, h, &x0, &y0, &x1, &y1))
+    return;
+
+  for (int page = y0 >> 3; page <= (y1 - 1) >> 3; page++) {
+    uint8_t rows = page_rows(page, y0, y1);
+    uint8_t *dst = &oled_buffer[page * OLED_WIDTH + x0];
+    if (rows == 0xFF)
+      memset(dst, color ? 0xFF : 0x00, x1 - x0);
+    else if (color)
+      span_or(dst, x1 - x0, rows);
+    else
+      span_and(dst, x1 - x0, (uint8_t)~rows);
+    mark_dirty(page, x0);
+    mark_dirty(page, x1 - 1);
+  }
+}
+
+static int floor_div8(int v) { return v >= 0 ? v / 8 : -((7 - v) / 8); }
+
+// Page-layout blit. Destination page `page` starts at source row
+// off = page * 8 - y, i.e. bit (off & 7) of source page off / 8: each output
+// byte is a[col] >> s | b[col] << (8 - s) with a, b the two source pages.
+static void blit(int x, int y, const uint8_t *src, int w, int h,
+                 oled_blit_mode_t mode) {
+  int x0, y0, x1, y1;
+  if (!clip_rect(x, y, w, h, &x0, &y0, &x1, &y1))
+    return;
+
+  int src_pages = (h + 7) / 8;
+  for (int page = y0 >> 3; page <= (y1 - 1) >> 3; page++) {
+    uint8_t rows = page_rows(page, y0, y1);
+    int off = page * 8 - y;
+    int sp = floor_div8(off);
+    int s = off - sp * 8;
+    const uint8_t *a = (sp >= 0 && sp < src_pages) ? src + sp * w : NULL;
+    const uint8_t *b =
+        (s && sp + 1 >= 0 && sp + 1 < src_pages) ? src + (sp + 1) * w : NULL;
+    uint8_t *dst = &oled_buffer[page * OLED_WIDTH];
+
+    for (int cx = x0; cx < x1; cx++) {
+      int col = cx - x;
+      uint8_t v = 0;
+      if (a)
+        v = (uint8_t)(a[col] >> s);
+      if (b)
+        v |= (uint8_t)(b[col] << (8 - s));
+      v &= rows;
+      if (mode == OLED_BLIT_OR)
+        dst[cx] |= v;
+      else if (mode == OLED_BLIT_CLEAR)
+        dst[cx] &= (uint8_t)~v;
+      else
+        dst[cx] = (dst[cx] & (uint8_t)~rows) | v;
+    }
+    mark_dirty(page, x0);
+    mark_dirty(page, x1 - 1);
+  }
+}
+
+// One character cell, opaque: glyph columns are copied, the spacing
+// columns (and unknown characters) are cleared
+static void draw_glyph(const oled_font_t *f, uint8_t c, int x, int y) {
+  int h = f->pages * 8;
+  if (c < f->first || c > f->last) {
+    fill_area(x, y, f->advance, h, false);
+    return;
+  }
+  const uint8_t *g = f->glyphs + (size_t)(c - f->first) * f->width * f->pages;
+  blit(x, y, g, f->width, h, OLED_BLIT_COPY);
+  fill_area(x + f->width, y, f->advance - f->width, h, false);
 }
 
 esp_err_t oled_print(const char *str) {
   if (!oled_initialized || !str)
     return ESP_FAIL;
 
-  // Simple 8x8 font rendering (basic implementation)
-  uint8_t x = 0, y = 0;
-  for (int i = 0; str[i] != '\0' && x < OLED_WIDTH - 8; i++) {
-    char c = str[i];
-    if (c == '\n') {
-      y += 8;
-      x = 0;
+  const oled_font_t *f = text_font;
+  for (; *str; str++) {
+    if (*str == '\n') {
+      cursor_x = cursor_x0;
+      cursor_y += f->pages * 8;
       continue;
     }
-
-    // Draw simple 8x8 character (basic font)
-    for (int px = 0; px < 8; px++) {
-      for (int py = 0; py < 8; py++) {
-        // Simple character pattern (you can improve this)
-        bool pixel = (c >= 32 && c <= 126); // Basic printable chars
-        oled_draw_pixel(x + px, y + py, pixel);
-      }
-    }
-    x += 8;
+    // Past the right or bottom edge: keep advancing, clipping drops it
+    if (cursor_x < OLED_WIDTH && cursor_y < OLED_HEIGHT)
+      draw_glyph(f, (uint8_t)*str, cursor_x, cursor_y);
+    cursor_x += f->advance;
   }
   return ESP_OK;
 }
@@ -189,11 +388,55 @@ esp_err_t oled_println(const char *str) {
   return ret;
 }
 
+esp_err_t oled_draw_pixel(uint8_t x, uint8_t y, bool color) {
+  if (!oled_initialized || x >= OLED_WIDTH || y >= OLED_HEIGHT)
+    return ESP_FAIL;
+  if (x < clip_x0 || x >= clip_x1 || y < clip_y0 || y >= clip_y1)
+    return ESP_OK;
+
+  uint16_t index = x + (y / 8) * OLED_WIDTH;
+  uint8_t bit = y % 8;
+
+  uint8_t old = oled_buffer[index];
+  if (color) {
+    oled_buffer[index] |= (1 << bit);
+  } else {
+    oled_buffer[index] &= ~(1 << bit);
+  }
+  if (oled_buffer[index] != old)
+    mark_dirty(y / 8, x);
+  return ESP_OK;
+}
+
+esp_err_t oled_draw_hline(int16_t x, int16_t y, int16_t w, bool color) {
+  if (!oled_initialized)
+    return ESP_FAIL;
+  fill_area(x, y, w, 1, color);
+  return ESP_OK;
+}
+
+esp_err_t oled_draw_vline(int16_t x, int16_t y, int16_t h, bool color) {
+  if (!oled_initialized)
+    return ESP_FAIL;
+  fill_area(x, y, 1, h, color);
+  return ESP_OK;
+}
+
 esp_err_t oled_draw_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
                          bool color) {
   if (!oled_initialized)
     return ESP_FAIL;
 
+  // Axis-aligned lines are spans
+  if (y0 == y1) {
+    fill_area(x0 < x1 ? x0 : x1, y0, abs(x1 - x0) + 1, 1, color);
+    return ESP_OK;
+  }
+  if (x0 == x1) {
+    fill_area(x0, y0 < y1 ? y0 : y1, 1, abs(y1 - y0) + 1, color);
+    return ESP_OK;
+  }
+
   int dx = abs(x1 - x0);
   int dy = abs(y1 - y0);
   int sx = x0 < x1 ? 1 : -1;
@@ -221,11 +464,13 @@ esp_err_t oled_draw_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h,
                          bool color) {
   if (!oled_initialized)
     return ESP_FAIL;
+  if (w == 0 || h == 0)
+    return ESP_OK;
 
-  oled_draw_line(x, y, x + w - 1, y, color);
-  oled_draw_line(x + w - 1, y, x + w - 1, y + h - 1, color);
-  oled_draw_line(x + w - 1, y + h - 1, x, y + h - 1, color);
-  oled_draw_line(x, y + h - 1, x, y, color);
+  fill_area(x, y, w, 1, color);
+  fill_area(x, y + h - 1, w, 1, color);
+  fill_area(x, y + 1, 1, h - 2, color);
+  fill_area(x + w - 1, y + 1, 1, h - 2, color);
   return ESP_OK;
 }
 
@@ -233,12 +478,14 @@ esp_err_t oled_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h,
                          bool color) {
   if (!oled_initialized)
     return ESP_FAIL;
-
-  for (uint8_t i = x; i < x + w; i++) {
-    for (uint8_t j = y; j < y + h; j++) {
-      oled_draw_pixel(i, j, color);
-    }
-  }
+  fill_area(x, y, w, h, color);
   return ESP_OK;
 }
 
+esp_err_t oled_draw_bitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                           uint8_t w, uint8_t h, oled_blit_mode_t mode) {
+  if (!oled_initialized || !bitmap)
+    return ESP_FAIL;
+  blit(x, y, bitmap, w, h, mode);
+  return ESP_OK;
+}
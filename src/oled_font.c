@@ -0,0 +1,634 @@
+// Generated by tools/gen_oled_font.py, do not edit.
+#include "oled_font.h"
+
+// 5x7 in a 6x8 cell
+static const uint8_t oled_font_5x7_glyphs[] = {
+    // ' '
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    // '!'
+    0x00, 0x00, 0x5F, 0x00, 0x00,
+    // '"'
+    0x00, 0x07, 0x00, 0x07, 0x00,
+    // '#'
+    0x14, 0x7F, 0x14, 0x7F, 0x14,
+    // '$'
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,
+    // '%'
+    0x23, 0x13, 0x08, 0x64, 0x62,
+    // '&'
+    0x36, 0x49, 0x55, 0x22, 0x50,
+    // "'"
+    0x00, 0x05, 0x03, 0x00, 0x00,
+    // '('
+    0x00, 0x1C, 0x22, 0x41, 0x00,
+    // ')'
+    0x00, 0x41, 0x22, 0x1C, 0x00,
+    // '*'
+    0x08, 0x2A, 0x1C, 0x2A, 0x08,
+    // '+'
+    0x08, 0x08, 0x3E, 0x08, 0x08,
+    // ','
+    0x00, 0x50, 0x30, 0x00, 0x00,
+    // '-'
+    0x08, 0x08, 0x08, 0x08, 0x08,
+    // '.'
+    0x00, 0x60, 0x60, 0x00, 0x00,
+    // '/'
+    0x20, 0x10, 0x08, 0x04, 0x02,
+    // '0'
+    0x3E, 0x51, 0x49, 0x45, 0x3E,
+    // '1'
+    0x00, 0x42, 0x7F, 0x40, 0x00,
+    // '2'
+    0x42, 0x61, 0x51, 0x49, 0x46,
+    // '3'
+    0x21, 0x41, 0x45, 0x4B, 0x31,
+    // '4'
+    0x18, 0x14, 0x12, 0x7F, 0x10,
+    // '5'
+    0x27, 0x45, 0x45, 0x45, 0x39,
+    // '6'
+    0x3C, 0x4A, 0x49, 0x49, 0x30,
+    // '7'
+    0x01, 0x71, 0x09, 0x05, 0x03,
+    // '8'
+    0x36, 0x49, 0x49, 0x49, 0x36,
+    // '9'
+    0x06, 0x49, 0x49, 0x29, 0x1E,
+    // ':'
+    0x00, 0x36, 0x36, 0x00, 0x00,
+    // ';'
+    0x00, 0x56, 0x36, 0x00, 0x00,
+    // '<'
+    0x08, 0x14, 0x22, 0x41, 0x00,
+    // '='
+    0x14, 0x14, 0x14, 0x14, 0x14,
+    // '>'
+    0x00, 0x41, 0x22, 0x14, 0x08,
+    // '?'
+    0x02, 0x01, 0x51, 0x09, 0x06,
+    // '@'
+    0x32, 0x49, 0x79, 0x41, 0x3E,
+    // 'A'
+    0x7E, 0x11, 0x11, 0x11, 0x7E,
+    // 'B'
+    0x7F, 0x49, 0x49, 0x49, 0x36,
+    // 'C'
+    0x3E, 0x41, 0x41, 0x41, 0x22,
+    // 'D'
+    0x7F, 0x41, 0x41, 0x22, 0x1C,
+    // 'E'
+    0x7F, 0x49, 0x49, 0x49, 0x41,
+    // 'F'
+    0x7F, 0x09, 0x09, 0x09, 0x01,
+    // 'G'
+    0x3E, 0x41, 0x49, 0x49, 0x7A,
+    // 'H'
+    0x7F, 0x08, 0x08, 0x08, 0x7F,
+    // 'I'
+    0x00, 0x41, 0x7F, 0x41, 0x00,
+    // 'J'
+    0x20, 0x40, 0x41, 0x3F, 0x01,
+    // 'K'
+    0x7F, 0x08, 0x14, 0x22, 0x41,
+    // 'L'
+    0x7F, 0x40, 0x40, 0x40, 0x40,
+    // 'M'
+    0x7F, 0x02, 0x0C, 0x02, 0x7F,
+    // 'N'
+    0x7F, 0x04, 0x08, 0x10, 0x7F,
+    // 'O'
+    0x3E, 0x41, 0x41, 0x41, 0x3E,
+    // 'P'
+    0x7F, 0x09, 0x09, 0x09, 0x06,
+    // 'Q'
+    0x3E, 0x41, 0x51, 0x21, 0x5E,
+    // 'R'
+    0x7F, 0x09, 0x19, 0x29, 0x46,
+    // 'S'
+    0x46, 0x49, 0x49, 0x49, 0x31,
+    // 'T'
+    0x01, 0x01, 0x7F, 0x01, 0x01,
+    // 'U'
+    0x3F, 0x40, 0x40, 0x40, 0x3F,
+    // 'V'
+    0x1F, 0x20, 0x40, 0x20, 0x1F,
+    // 'W'
+    0x3F, 0x40, 0x38, 0x40, 0x3F,
+    // 'X'
+    0x63, 0x14, 0x08, 0x14, 0x63,
+    // 'Y'
+    0x07, 0x08, 0x70, 0x08, 0x07,
+    // 'Z'
+    0x61, 0x51, 0x49, 0x45, 0x43,
+    // '['
+    0x00, 0x7F, 0x41, 0x41, 0x00,
+    // '\\'
+    0x02, 0x04, 0x08, 0x10, 0x20,
+    // ']'
+    0x00, 0x41, 0x41, 0x7F, 0x00,
+    // '^'
+    0x04, 0x02, 0x01, 0x02, 0x04,
+    // '_'
+    0x40, 0x40, 0x40, 0x40, 0x40,
+    // '`'
+    0x00, 0x01, 0x02, 0x04, 0x00,
+    // 'a'
+    0x20, 0x54, 0x54, 0x54, 0x78,
+    // 'b'
+    0x7F, 0x48, 0x44, 0x44, 0x38,
+    // 'c'
+    0x38, 0x44, 0x44, 0x44, 0x20,
+    // 'd'
+    0x38, 0x44, 0x44, 0x48, 0x7F,
+    // 'e'
+    0x38, 0x54, 0x54, 0x54, 0x18,
+    // 'f'
+    0x08, 0x7E, 0x09, 0x01, 0x02,
+    // 'g'
+    0x0C, 0x52, 0x52, 0x52, 0x3E,
+    // 'h'
+    0x7F, 0x08, 0x04, 0x04, 0x78,
+    // 'i'
+    0x00, 0x44, 0x7D, 0x40, 0x00,
+    // 'j'
+    0x20, 0x40, 0x44, 0x3D, 0x00,
+    // 'k'
+    0x7F, 0x10, 0x28, 0x44, 0x00,
+    // 'l'
+    0x00, 0x41, 0x7F, 0x40, 0x00,
+    // 'm'
+    0x7C, 0x04, 0x18, 0x04, 0x78,
+    // 'n'
+    0x7C, 0x08, 0x04, 0x04, 0x78,
+    // 'o'
+    0x38, 0x44, 0x44, 0x44, 0x38,
+    // 'p'
+    0x7C, 0x14, 0x14, 0x14, 0x08,
+    // 'q'
+    0x08, 0x14, 0x14, 0x18, 0x7C,
+    // 'r'
+    0x7C, 0x08, 0x04, 0x04, 0x08,
+    // 's'
+    0x48, 0x54, 0x54, 0x54, 0x20,
+    // 't'
+    0x04, 0x3F, 0x44, 0x40, 0x20,
+    // 'u'
+    0x3C, 0x40, 0x40, 0x20, 0x7C,
+    // 'v'
+    0x1C, 0x20, 0x40, 0x20, 0x1C,
+    // 'w'
+    0x3C, 0x40, 0x30, 0x40, 0x3C,
+    // 'x'
+    0x44, 0x28, 0x10, 0x28, 0x44,
+    // 'y'
+    0x0C, 0x50, 0x50, 0x50, 0x3C,
+    // 'z'
+    0x44, 0x64, 0x54, 0x4C, 0x44,
+    // '{'
+    0x00, 0x08, 0x36, 0x41, 0x00,
+    // '|'
+    0x00, 0x00, 0x7F, 0x00, 0x00,
+    // '}'
+    0x00, 0x41, 0x36, 0x08, 0x00,
+    // '~'
+    0x08, 0x04, 0x08, 0x10, 0x08,
+    // degree
+    0x00, 0x06, 0x09, 0x09, 0x06,
+};
+
+const oled_font_t oled_font_5x7 = {
+    .width = 5,
+    .advance = 6,
+    .pages = 1,
+    .first = 0x20,
+    .last = 0x7F,
+    .glyphs = oled_font_5x7_glyphs,
+};
+
+// 10x14 in a 12x16 cell (5x7 through Scale2x)
+static const uint8_t oled_font_10x14_glyphs[] = {
+    // ' '
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '!'
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00,
+    // '"'
+    0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '#'
+    0x30, 0x38, 0xFF, 0xFF, 0x30, 0x30, 0xFF, 0xFF, 0x38, 0x30, 0x03, 0x07,
+    0x3F, 0x3F, 0x03, 0x03, 0x3F, 0x3F, 0x07, 0x03,
+    // '$'
+    0x30, 0x78, 0xCC, 0xCE, 0xFF, 0xFF, 0xCE, 0xCC, 0x8C, 0x0C, 0x0C, 0x0C,
+    0x0C, 0x1C, 0x3F, 0x3F, 0x1C, 0x0C, 0x07, 0x03,
+    // '%'
+    0x06, 0x0F, 0x0F, 0x86, 0xC0, 0xE0, 0x70, 0x38, 0x1C, 0x0C, 0x0C, 0x0E,
+    0x07, 0x03, 0x01, 0x00, 0x18, 0x3C, 0x3C, 0x18,
+    // '&'
+    0x3C, 0x3E, 0xC7, 0xC3, 0x33, 0x33, 0x1E, 0x0C, 0x00, 0x00, 0x0F, 0x1F,
+    0x38, 0x30, 0x33, 0x33, 0x0C, 0x0C, 0x33, 0x33,
+    // "'"
+    0x00, 0x00, 0x33, 0x33, 0x1F, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '('
+    0x00, 0x00, 0xF0, 0xF8, 0x1C, 0x0E, 0x07, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x07, 0x0E, 0x1C, 0x38, 0x30, 0x00, 0x00,
+    // ')'
+    0x00, 0x00, 0x03, 0x07, 0x0E, 0x1C, 0xF8, 0xF0, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x38, 0x1C, 0x0E, 0x07, 0x03, 0x00, 0x00,
+    // '*'
+    0xC0, 0xC0, 0xCC, 0xCC, 0xF0, 0xF0, 0xCC, 0xCC, 0xC0, 0xC0, 0x00, 0x00,
+    0x0C, 0x0C, 0x03, 0x03, 0x0C, 0x0C, 0x00, 0x00,
+    // '+'
+    0xC0, 0xC0, 0xC0, 0xE0, 0xFC, 0xFC, 0xE0, 0xC0, 0xC0, 0xC0, 0x00, 0x00,
+    0x00, 0x01, 0x0F, 0x0F, 0x01, 0x00, 0x00, 0x00,
+    // ','
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x33, 0x33, 0x1F, 0x0E, 0x00, 0x00, 0x00, 0x00,
+    // '-'
+    0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '.'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x3C, 0x3C, 0x18, 0x00, 0x00, 0x00, 0x00,
+    // '/'
+    0x00, 0x00, 0x00, 0x80, 0xC0, 0xE0, 0x70, 0x38, 0x1C, 0x0C, 0x0C, 0x0E,
+    0x07, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '0'
+    0xFC, 0xFE, 0x07, 0x03, 0xC3, 0xE3, 0x33, 0x33, 0xFE, 0xFC, 0x0F, 0x1F,
+    0x33, 0x33, 0x31, 0x30, 0x30, 0x38, 0x1F, 0x0F,
+    // '1'
+    0x00, 0x00, 0x0C, 0x1E, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x38, 0x3F, 0x3F, 0x38, 0x30, 0x00, 0x00,
+    // '2'
+    0x0C, 0x0E, 0x07, 0x03, 0x03, 0x83, 0xC3, 0xE7, 0x7E, 0x3C, 0x30, 0x38,
+    0x3C, 0x3E, 0x33, 0x33, 0x31, 0x30, 0x30, 0x30,
+    // '3'
+    0x03, 0x03, 0x03, 0x03, 0x33, 0x73, 0xCF, 0xCF, 0x87, 0x03, 0x0C, 0x1C,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x39, 0x1F, 0x0F,
+    // '4'
+    0xC0, 0xE0, 0x30, 0x38, 0x0C, 0x8E, 0xFF, 0xFF, 0x80, 0x00, 0x01, 0x03,
+    0x03, 0x03, 0x03, 0x07, 0x3F, 0x3F, 0x07, 0x03,
+    // '5'
+    0x1E, 0x3F, 0x33, 0x33, 0x33, 0x33, 0x33, 0x73, 0xE3, 0xC3, 0x0C, 0x1C,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x38, 0x1F, 0x0F,
+    // '6'
+    0xF0, 0xF8, 0xCC, 0xCE, 0xC7, 0xC3, 0xC3, 0xC3, 0x80, 0x00, 0x0F, 0x1F,
+    0x39, 0x30, 0x30, 0x30, 0x30, 0x39, 0x1F, 0x0F,
+    // '7'
+    0x03, 0x03, 0x03, 0x83, 0xC3, 0xE3, 0x73, 0x33, 0x1F, 0x0E, 0x00, 0x00,
+    0x3F, 0x3F, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '8'
+    0x3C, 0x3E, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x3E, 0x3C, 0x0F, 0x1F,
+    0x39, 0x30, 0x30, 0x30, 0x30, 0x39, 0x1F, 0x0F,
+    // '9'
+    0x3C, 0x7E, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0xFE, 0xFC, 0x00, 0x00,
+    0x30, 0x30, 0x30, 0x38, 0x1C, 0x0C, 0x07, 0x03,
+    // ':'
+    0x00, 0x00, 0x18, 0x3C, 0x3C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x06, 0x0F, 0x0F, 0x06, 0x00, 0x00, 0x00, 0x00,
+    // ';'
+    0x00, 0x00, 0x18, 0x3C, 0x3C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x33, 0x33, 0x1F, 0x0E, 0x00, 0x00, 0x00, 0x00,
+    // '<'
+    0xC0, 0xE0, 0x30, 0x38, 0x1C, 0x0E, 0x07, 0x03, 0x00, 0x00, 0x00, 0x01,
+    0x03, 0x07, 0x0E, 0x1C, 0x38, 0x30, 0x00, 0x00,
+    // '='
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    // '>'
+    0x00, 0x00, 0x03, 0x07, 0x0E, 0x1C, 0x38, 0x30, 0xE0, 0xC0, 0x00, 0x00,
+    0x30, 0x38, 0x1C, 0x0E, 0x07, 0x03, 0x01, 0x00,
+    // '?'
+    0x0C, 0x0E, 0x07, 0x03, 0x03, 0x83, 0xC3, 0xE7, 0x7E, 0x3C, 0x00, 0x00,
+    0x00, 0x00, 0x33, 0x33, 0x01, 0x00, 0x00, 0x00,
+    // '@'
+    0x0C, 0x8E, 0xC7, 0xC3, 0xC3, 0x83, 0x03, 0x07, 0xFE, 0xFC, 0x0F, 0x1F,
+    0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x1F, 0x0F,
+    // 'A'
+    0xFC, 0xFE, 0x87, 0x03, 0x03, 0x03, 0x03, 0x87, 0xFE, 0xFC, 0x3F, 0x3F,
+    0x07, 0x03, 0x03, 0x03, 0x03, 0x07, 0x3F, 0x3F,
+    // 'B'
+    0xFE, 0xFF, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x3E, 0x3C, 0x1F, 0x3F,
+    0x39, 0x30, 0x30, 0x30, 0x30, 0x39, 0x1F, 0x0F,
+    // 'C'
+    0xFC, 0xFE, 0x07, 0x03, 0x03, 0x03, 0x03, 0x07, 0x0E, 0x0C, 0x0F, 0x1F,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x38, 0x1C, 0x0C,
+    // 'D'
+    0xFE, 0xFF, 0x07, 0x03, 0x03, 0x07, 0x0E, 0x1C, 0xF8, 0xF0, 0x1F, 0x3F,
+    0x38, 0x30, 0x30, 0x38, 0x1C, 0x0E, 0x07, 0x03,
+    // 'E'
+    0xFE, 0xFF, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0x1F, 0x3F,
+    0x39, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    // 'F'
+    0xFE, 0xFF, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0x3F, 0x3F,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // 'G'
+    0xFC, 0xFE, 0x07, 0x03, 0xC3, 0xC3, 0xC3, 0xC7, 0xCE, 0x8C, 0x0F, 0x1F,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x39, 0x3F, 0x1F,
+    // 'H'
+    0xFF, 0xFF, 0xE0, 0xC0, 0xC0, 0xC0, 0xC0, 0xE0, 0xFF, 0xFF, 0x3F, 0x3F,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x3F, 0x3F,
+    // 'I'
+    0x00, 0x00, 0x03, 0x07, 0xFF, 0xFF, 0x07, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x38, 0x3F, 0x3F, 0x38, 0x30, 0x00, 0x00,
+    // 'J'
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x07, 0xFF, 0xFF, 0x07, 0x03, 0x0C, 0x1C,
+    0x38, 0x30, 0x30, 0x38, 0x1F, 0x0F, 0x00, 0x00,
+    // 'K'
+    0xFF, 0xFF, 0xC0, 0xC0, 0x30, 0x38, 0x1C, 0x0E, 0x07, 0x03, 0x3F, 0x3F,
+    0x00, 0x00, 0x03, 0x07, 0x0E, 0x1C, 0x38, 0x30,
+    // 'L'
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    // 'M'
+    0xFF, 0xFF, 0x0E, 0x0C, 0xF0, 0xF0, 0x0C, 0x0E, 0xFF, 0xFF, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F,
+    // 'N'
+    0xFF, 0xFF, 0x38, 0x30, 0xE0, 0xC0, 0x00, 0x00, 0xFF, 0xFF, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x01, 0x03, 0x07, 0x3F, 0x3F,
+    // 'O'
+    0xFC, 0xFE, 0x07, 0x03, 0x03, 0x03, 0x03, 0x07, 0xFE, 0xFC, 0x0F, 0x1F,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x38, 0x1F, 0x0F,
+    // 'P'
+    0xFE, 0xFF, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x7E, 0x3C, 0x3F, 0x3F,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // 'Q'
+    0xFC, 0xFE, 0x07, 0x03, 0x03, 0x03, 0x03, 0x07, 0xFE, 0xFC, 0x0F, 0x1F,
+    0x38, 0x30, 0x33, 0x33, 0x0C, 0x0C, 0x33, 0x33,
+    // 'R'
+    0xFE, 0xFF, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x7E, 0x3C, 0x3F, 0x3F,
+    0x00, 0x00, 0x03, 0x07, 0x0C, 0x1C, 0x38, 0x30,
+    // 'S'
+    0x3C, 0x7E, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x83, 0x03, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x39, 0x1F, 0x0F,
+    // 'T'
+    0x03, 0x03, 0x03, 0x07, 0xFF, 0xFF, 0x07, 0x03, 0x03, 0x03, 0x00, 0x00,
+    0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00,
+    // 'U'
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x0F, 0x1F,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x38, 0x1F, 0x0F,
+    // 'V'
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x03, 0x07,
+    0x0E, 0x1C, 0x30, 0x30, 0x1C, 0x0E, 0x07, 0x03,
+    // 'W'
+    0xFF, 0xFF, 0x00, 0x00, 0xC0, 0xC0, 0x00, 0x00, 0xFF, 0xFF, 0x0F, 0x1F,
+    0x30, 0x30, 0x0F, 0x0F, 0x30, 0x30, 0x1F, 0x0F,
+    // 'X'
+    0x0F, 0x1F, 0x38, 0x30, 0xC0, 0xC0, 0x30, 0x38, 0x1F, 0x0F, 0x3C, 0x3E,
+    0x07, 0x03, 0x00, 0x00, 0x03, 0x07, 0x3E, 0x3C,
+    // 'Y'
+    0x3F, 0x7F, 0xE0, 0xC0, 0x00, 0x00, 0xC0, 0xE0, 0x7F, 0x3F, 0x00, 0x00,
+    0x00, 0x01, 0x3F, 0x3F, 0x01, 0x00, 0x00, 0x00,
+    // 'Z'
+    0x03, 0x03, 0x03, 0x83, 0xC3, 0xE3, 0x73, 0x33, 0x1F, 0x0E, 0x1C, 0x3E,
+    0x33, 0x33, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30,
+    // '['
+    0x00, 0x00, 0xFE, 0xFF, 0x07, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x1F, 0x3F, 0x38, 0x30, 0x30, 0x30, 0x00, 0x00,
+    // '\\'
+    0x0C, 0x1C, 0x38, 0x70, 0xE0, 0xC0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x01, 0x03, 0x07, 0x0E, 0x0C,
+    // ']'
+    0x00, 0x00, 0x03, 0x03, 0x03, 0x07, 0xFF, 0xFE, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x30, 0x30, 0x38, 0x3F, 0x1F, 0x00, 0x00,
+    // '^'
+    0x30, 0x38, 0x1C, 0x0E, 0x03, 0x03, 0x0E, 0x1C, 0x38, 0x30, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '_'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    // '`'
+    0x00, 0x00, 0x03, 0x07, 0x0E, 0x1C, 0x38, 0x30, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // 'a'
+    0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xE0, 0xC0, 0x0C, 0x1E,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x1F,
+    // 'b'
+    0xFF, 0xFF, 0xC0, 0xC0, 0x70, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x1F, 0x3F,
+    0x39, 0x30, 0x30, 0x30, 0x30, 0x38, 0x1F, 0x0F,
+    // 'c'
+    0xC0, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x0F, 0x1F,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x38, 0x1C, 0x0C,
+    // 'd'
+    0xC0, 0xE0, 0x70, 0x30, 0x30, 0x70, 0xC0, 0xC0, 0xFF, 0xFF, 0x0F, 0x1F,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x39, 0x3F, 0x1F,
+    // 'e'
+    0xC0, 0xE0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xE0, 0xC0, 0x0F, 0x1F,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x03, 0x01,
+    // 'f'
+    0xC0, 0xE0, 0xFC, 0xFE, 0xE7, 0xC3, 0x03, 0x07, 0x0E, 0x0C, 0x00, 0x01,
+    0x3F, 0x3F, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // 'g'
+    0xF0, 0xF8, 0x9C, 0x0C, 0x0C, 0x0C, 0x0C, 0x9C, 0xFC, 0xF8, 0x00, 0x01,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x1F, 0x0F,
+    // 'h'
+    0xFF, 0xFF, 0xC0, 0xC0, 0x70, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x3F, 0x3F,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F,
+    // 'i'
+    0x00, 0x00, 0x30, 0x70, 0xF3, 0xE3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x38, 0x3F, 0x3F, 0x38, 0x30, 0x00, 0x00,
+    // 'j'
+    0x00, 0x00, 0x00, 0x00, 0x30, 0x70, 0xF3, 0xE3, 0x00, 0x00, 0x0C, 0x1C,
+    0x38, 0x30, 0x30, 0x38, 0x1F, 0x0F, 0x00, 0x00,
+    // 'k'
+    0xFF, 0xFF, 0x00, 0x00, 0xC0, 0xE0, 0x70, 0x30, 0x00, 0x00, 0x3F, 0x3F,
+    0x03, 0x03, 0x0C, 0x1C, 0x38, 0x30, 0x00, 0x00,
+    // 'l'
+    0x00, 0x00, 0x03, 0x07, 0xFF, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x38, 0x3F, 0x3F, 0x38, 0x30, 0x00, 0x00,
+    // 'm'
+    0xE0, 0xF0, 0x30, 0x30, 0xC0, 0xC0, 0x30, 0x30, 0xE0, 0xC0, 0x3F, 0x3F,
+    0x00, 0x00, 0x03, 0x03, 0x00, 0x00, 0x3F, 0x3F,
+    // 'n'
+    0xF0, 0xF0, 0xC0, 0xC0, 0x70, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x3F, 0x3F,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F,
+    // 'o'
+    0xC0, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x0F, 0x1F,
+    0x38, 0x30, 0x30, 0x30, 0x30, 0x38, 0x1F, 0x0F,
+    // 'p'
+    0xE0, 0xF0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xE0, 0xC0, 0x3F, 0x3F,
+    0x07, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x00,
+    // 'q'
+    0xC0, 0xE0, 0x30, 0x30, 0x30, 0x30, 0x80, 0xC0, 0xF0, 0xF0, 0x00, 0x01,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x3F, 0x3F,
+    // 'r'
+    0xF0, 0xF0, 0xC0, 0xC0, 0x70, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x3F, 0x3F,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // 's'
+    0xC0, 0xE0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x30, 0x31,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C,
+    // 't'
+    0x30, 0x78, 0xFF, 0xFF, 0x78, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0F, 0x1F, 0x38, 0x30, 0x30, 0x38, 0x1C, 0x0C,
+    // 'u'
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x0F, 0x1F,
+    0x38, 0x30, 0x30, 0x38, 0x0C, 0x0E, 0x3F, 0x3F,
+    // 'v'
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x03, 0x07,
+    0x0E, 0x1C, 0x30, 0x30, 0x1C, 0x0E, 0x07, 0x03,
+    // 'w'
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x0F, 0x1F,
+    0x30, 0x30, 0x0F, 0x0F, 0x30, 0x30, 0x1F, 0x0F,
+    // 'x'
+    0x30, 0x70, 0xE0, 0xC0, 0x00, 0x00, 0xC0, 0xE0, 0x70, 0x30, 0x30, 0x38,
+    0x1C, 0x0C, 0x03, 0x03, 0x0C, 0x1C, 0x38, 0x30,
+    // 'y'
+    0xF0, 0xF0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x80, 0xF0, 0xF0, 0x00, 0x01,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x1F, 0x0F,
+    // 'z'
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xF0, 0xF0, 0x70, 0x30, 0x30, 0x38,
+    0x3C, 0x3E, 0x33, 0x33, 0x31, 0x30, 0x30, 0x30,
+    // '{'
+    0x00, 0x00, 0xC0, 0xE0, 0x3C, 0x3E, 0x07, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x0F, 0x1F, 0x38, 0x30, 0x00, 0x00,
+    // '|'
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00,
+    // '}'
+    0x00, 0x00, 0x03, 0x07, 0x3E, 0x3C, 0xE0, 0xC0, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x38, 0x1F, 0x0F, 0x01, 0x00, 0x00, 0x00,
+    // '~'
+    0xC0, 0xE0, 0x30, 0x30, 0xE0, 0xC0, 0x00, 0x00, 0xC0, 0xC0, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x01, 0x03, 0x03, 0x01, 0x00,
+    // degree
+    0x00, 0x00, 0x3C, 0x7E, 0xE7, 0xC3, 0xC3, 0xE7, 0x7E, 0x3C, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+const oled_font_t oled_font_10x14 = {
+    .width = 10,
+    .advance = 12,
+    .pages = 2,
+    .first = 0x20,
+    .last = 0x7F,
+    .glyphs = oled_font_10x14_glyphs,
+};
+
+// 20x28 in a 24x32 cell, '-' to ':' (5x7 through Scale2x twice)
+static const uint8_t oled_font_digits_20x28_glyphs[] = {
+    // '-'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '.'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xE0, 0xE0, 0xF0,
+    0xF0, 0xE0, 0xE0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x07, 0x0F, 0x0F, 0x07, 0x07, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '/'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x80, 0xE0, 0xE0, 0xF0, 0xF0, 0x60, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x80, 0xE0, 0xE0, 0xF8, 0xF8, 0x7E, 0x7E, 0x1F, 0x1F, 0x07,
+    0x07, 0x01, 0x01, 0x00, 0x60, 0xF8, 0xF8, 0x7E, 0x7E, 0x1F, 0x1F, 0x07,
+    0x07, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '0'
+    0xE0, 0xF8, 0xF8, 0xFE, 0x7E, 0x1F, 0x1F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x9E, 0xFE, 0xF8, 0xF8, 0xE0, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x80, 0x00, 0x00, 0x80, 0xE0, 0xF8, 0xF8, 0x7E, 0x1E, 0x0F, 0x0F, 0x1F,
+    0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF, 0x9F, 0x0F, 0x0F, 0x07,
+    0x07, 0x01, 0x01, 0x00, 0x00, 0x80, 0x80, 0xE0, 0xFF, 0xFF, 0xFF, 0x7F,
+    0x00, 0x01, 0x01, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x01, 0x01, 0x00,
+    // '1'
+    0x00, 0x00, 0x00, 0x00, 0x60, 0xF8, 0xF8, 0xFE, 0xFE, 0xFF, 0xFF, 0xFE,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x01, 0x07, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xE0,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xE0, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x06, 0x00, 0x00, 0x00, 0x00,
+    // '2'
+    0x60, 0xF8, 0xF8, 0x7E, 0x7E, 0x1F, 0x1F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x1F, 0x1F, 0x7E, 0xFE, 0xF8, 0xF8, 0xE0, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xE0, 0xE0, 0xF8, 0xF8, 0x7E,
+    0x7F, 0x1F, 0x1F, 0x07, 0x00, 0x80, 0x80, 0xE0, 0xE0, 0xF8, 0xF8, 0xFE,
+    0x9E, 0x0F, 0x0F, 0x07, 0x07, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x06,
+    // '3'
+    0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x9F,
+    0x7F, 0xFF, 0xFF, 0x7F, 0x7F, 0x1F, 0x1F, 0x06, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x06, 0x1F, 0x1F, 0x7E, 0x79, 0xF0, 0xF0, 0xE0,
+    0xE0, 0x80, 0x80, 0x00, 0x60, 0xF0, 0xF0, 0xE0, 0xE0, 0x80, 0x80, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x81, 0xE7, 0xFF, 0xFF, 0xFF, 0x7E,
+    0x00, 0x01, 0x01, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x01, 0x01, 0x00,
+    // '4'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xE0, 0xE0, 0xF8, 0xF8, 0xFE,
+    0xFE, 0xFF, 0xFF, 0xFE, 0x00, 0x00, 0x00, 0x00, 0xE0, 0xF8, 0xF8, 0xFE,
+    0x9E, 0x0F, 0x0F, 0x07, 0x01, 0x80, 0x80, 0xE1, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xE0, 0x80, 0x80, 0x00, 0x01, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x1F, 0x1F, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x1F, 0x1F, 0x06,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x07, 0x0F, 0x0F, 0x07, 0x00, 0x00, 0x00, 0x00,
+    // '5'
+    0xF8, 0xFE, 0xFE, 0xFF, 0x9F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x06, 0x01, 0x07, 0x07, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x1F, 0x1F, 0x7E,
+    0xFE, 0xF8, 0xF8, 0xE0, 0x60, 0xF0, 0xF0, 0xE0, 0xE0, 0x80, 0x80, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xE0, 0xFF, 0xFF, 0xFF, 0x7F,
+    0x00, 0x01, 0x01, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x01, 0x01, 0x00,
+    // '6'
+    0x00, 0x80, 0x80, 0xE0, 0xE0, 0xF8, 0xF8, 0x7E, 0x7E, 0x1F, 0x1F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x06, 0x00, 0x00, 0x00, 0x00, 0xFE, 0xFF, 0xFF, 0xFF,
+    0xF9, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xE0,
+    0xE0, 0x80, 0x80, 0x00, 0x7F, 0xFF, 0xFF, 0xFF, 0xE7, 0x81, 0x81, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x81, 0xE7, 0xFF, 0xFF, 0xFF, 0x7E,
+    0x00, 0x01, 0x01, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x01, 0x01, 0x00,
+    // '7'
+    0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x9F, 0xFF, 0xFE, 0xFE, 0x78, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x80, 0xE0, 0xE0, 0xF8, 0xF8, 0x7E, 0x7E, 0x1F, 0x1F, 0x07,
+    0x07, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0xFF, 0xFF, 0xFF,
+    0x07, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x07, 0x0F, 0x0F, 0x07, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '8'
+    0xE0, 0xF8, 0xF8, 0xFE, 0x7E, 0x1F, 0x1F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x1F, 0x1F, 0x7E, 0xFE, 0xF8, 0xF8, 0xE0, 0x07, 0x0F, 0x0F, 0x9F,
+    0xFE, 0xF8, 0xF8, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF8, 0xF8, 0xFE,
+    0x9F, 0x0F, 0x0F, 0x07, 0x7E, 0xFF, 0xFF, 0xFF, 0xE7, 0x81, 0x81, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x81, 0xE7, 0xFF, 0xFF, 0xFF, 0x7E,
+    0x00, 0x01, 0x01, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x01, 0x01, 0x00,
+    // '9'
+    0xE0, 0xF8, 0xF8, 0xFE, 0x7E, 0x1F, 0x1F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x1F, 0x1F, 0x7E, 0xFE, 0xF8, 0xF8, 0xE0, 0x07, 0x1F, 0x1F, 0x7F,
+    0x7E, 0xF8, 0xF8, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF8, 0xF8, 0xFE,
+    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x80, 0xE0, 0xE0, 0xF0, 0xF0, 0x79, 0x7F, 0x1F, 0x1F, 0x07,
+    0x00, 0x00, 0x00, 0x00, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x07,
+    0x07, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // ':'
+    0x00, 0x00, 0x00, 0x00, 0x80, 0xE0, 0xE0, 0xF0, 0xF0, 0xE0, 0xE0, 0x80,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x07, 0x07, 0x0F, 0x0F, 0x07, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x7E, 0x7E, 0xFF,
+    0xFF, 0x7E, 0x7E, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+const oled_font_t oled_font_digits_20x28 = {
+    .width = 20,
+    .advance = 24,
+    .pages = 4,
+    .first = 0x2D,
+    .last = 0x3A,
+    .glyphs = oled_font_digits_20x28_glyphs,
+};
+
@@ -0,0 +1,114 @@
+#include "oled.h"
+#include "oled_backend.h"
+#include <stdio.h>
+#include <string.h>
+
+// Emulated controller state, horizontal addressing mode only (the mode
+// oled_init() selects)
+static uint8_t ram[OLED_WIDTH * OLED_PAGES];
+static uint8_t col_start, col_end = OLED_WIDTH - 1;
+static uint8_t page_start, page_end = OLED_PAGES - 1;
+static uint8_t col, page;
+static oled_host_stats_t host_stats;
+
+// Argument bytes that follow each SSD1306 command we may receive
+static int cmd_args(uint8_t cmd) {
+  switch (cmd) {
+  case OLED_CMD_COLUMN_ADDR:
+  case OLED_CMD_PAGE_ADDR:
+    return 2;
+  case OLED_CMD_SET_CONTRAST:
+  case OLED_CMD_SET_DISPLAY_OFFSET:
+  case OLED_CMD_SET_COM_PINS:
+  case OLED_CMD_SET_VCOM_DETECT:
+  case OLED_CMD_SET_DISPLAY_CLK_DIV:
+  case OLED_CMD_SET_PRECHARGE:
+  case OLED_CMD_SET_MULTIPLEX:
+  case OLED_CMD_CHARGE_PUMP:
+  case OLED_CMD_MEMORY_MODE:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+static void count(size_t len) {
+  host_stats.transactions++;
+  host_stats.bytes += len + 2;
+}
+
+static esp_err_t host_probe(void) {
+  memset(ram, 0, sizeof(ram));
+  col_start = col = 0;
+  col_end = OLED_WIDTH - 1;
+  page_start = page = 0;
+  page_end = OLED_PAGES - 1;
+  return ESP_OK;
+}
+
+static esp_err_t host_write_cmds(const uint8_t *cmds, size_t len) {
+  count(len);
+  for (size_t i = 0; i < len;) {
+    uint8_t cmd = cmds[i];
+    int n = cmd_args(cmd);
+    if (i + 1 + n > len)
+      return ESP_ERR_INVALID_SIZE; // argument split across transactions
+    if (cmd == OLED_CMD_COLUMN_ADDR) {
+      col_start = col = cmds[i + 1] & (OLED_WIDTH - 1);
+      col_end = cmds[i + 2] & (OLED_WIDTH - 1);
+    } else if (cmd == OLED_CMD_PAGE_ADDR) {
+      page_start = page = cmds[i + 1] & (OLED_PAGES - 1);
+      page_end = cmds[i + 2] & (OLED_PAGES - 1);
+    }
+    i += 1 + n;
+  }
+  return ESP_OK;
+}
+
+static esp_err_t host_write_data(const uint8_t *data, size_t len) {
+  count(len);
+  host_stats.data_bytes += len;
+  for (size_t i = 0; i < len; i++) {
+    ram[page * OLED_WIDTH + col] = data[i];
+    // Horizontal mode: column wraps inside the window, then the page
+    if (col == col_end) {
+      col = col_start;
+      page = (page == page_end) ? page_start : page + 1;
+    } else {
+      col = (col + 1) & (OLED_WIDTH - 1);
+    }
+  }
+  return ESP_OK;
+}
+
+const oled_backend_t oled_backend_host = {
+    .name = "host",
+    .probe = host_probe,
+    .write_cmds = host_write_cmds,
+    .write_data = host_write_data,
+};
+
+const uint8_t *oled_host_ram(void) { return ram; }
+
+void oled_host_get_stats(oled_host_stats_t *stats) { *stats = host_stats; }
+
+void oled_host_reset_stats(void) {
+  memset(&host_stats, 0, sizeof(host_stats));
+}
+
+esp_err_t oled_host_save_pbm(const char *path) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return ESP_FAIL;
+
+  fprintf(f, "P4\n%d %d\n", OLED_WIDTH, OLED_HEIGHT);
+  for (int y = 0; y < OLED_HEIGHT; y++) {
+    uint8_t row[OLED_WIDTH / 8] = {0};
+    for (int x = 0; x < OLED_WIDTH; x++) {
+      if (ram[(y / 8) * OLED_WIDTH + x] & (1 << (y % 8)))
+        row[x / 8] |= 0x80 >> (x % 8);
+    }
+    fwrite(row, 1, sizeof(row), f);
+  }
+  return fclose(f) == 0 ? ESP_OK : ESP_FAIL;
+}
@@ -0,0 +1,59 @@
+#include "driver/i2c.h"
+#include "esp_log.h"
+#include "oled.h"
+#include "oled_backend.h"
+
+static const char *TAG = "OLED";
+static uint8_t oled_addr = 0;
+
+static esp_err_t i2c_transfer(uint8_t control, const uint8_t *data,
+                              size_t len) {
+  i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
+  i2c_master_start(cmd_handle);
+  i2c_master_write_byte(cmd_handle, (oled_addr << 1) | I2C_MASTER_WRITE, true);
+  i2c_master_write_byte(cmd_handle, control, true);
+  i2c_master_write(cmd_handle, data, len, true);
+  i2c_master_stop(cmd_handle);
+  esp_err_t ret =
+      i2c_master_cmd_begin(I2C_NUM_0, cmd_handle, pdMS_TO_TICKS(100));
+  i2c_cmd_link_delete(cmd_handle);
+  return ret;
+}
+
+static esp_err_t ssd1306_write_cmds(const uint8_t *cmds, size_t len) {
+  return i2c_transfer(0x00, cmds, len);
+}
+
+static esp_err_t ssd1306_write_data(const uint8_t *data, size_t len) {
+  return i2c_transfer(0x40, data, len);
+}
+
+static esp_err_t ssd1306_probe(void) {
+  // Try common OLED addresses
+  uint8_t addresses[] = {OLED_ADDR_1, OLED_ADDR_2};
+  uint8_t cmd = OLED_CMD_DISPLAY_OFF;
+
+  for (int i = 0; i < 2; i++) {
+    oled_addr = addresses[i];
+    esp_err_t ret = ssd1306_write_cmds(&cmd, 1);
+    if (ret == ESP_OK) {
+      ESP_LOGI(TAG, "OLED found at address 0x%02X", oled_addr);
+      return ESP_OK;
+    }
+  }
+
+  ESP_LOGE(TAG, "OLED not found at any address");
+  return ESP_FAIL;
+}
+
+const oled_backend_t oled_backend_ssd1306_i2c = {
+    .name = "ssd1306-i2c",
+    .probe = ssd1306_probe,
+    .write_cmds = ssd1306_write_cmds,
+    .write_data = ssd1306_write_data,
+};
+
+// Lives with the I2C backend so oled.c links on a host without the driver
+esp_err_t oled_init(void) {
+  return oled_init_backend(&oled_backend_ssd1306_i2c);
+}
@@ -0,0 +1,903 @@
+#include "sd_logger.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "fixed_fmt.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char *TAG = "SD_LOG";
+
+// Double-buffered byte stream: appends fill `buf[active]`; once it reaches
+// the next aligned boundary it is handed to the SD task as `pending`.
+typedef struct {
+  const char *path;
+  uint8_t format;
+  int fd;
+  uint8_t buf[2][SD_LOG_BUF_BYTES];
+  uint16_t used[2];
+  uint8_t active;
+  bool pending;
+  uint32_t file_size;
+} log_stream_t;
+
+static log_stream_t csv_stream = {
+    .path = SD_LOG_CSV_PATH, .format = SD_LOG_CSV, .fd = -1};
+
+#define BLOCK_HDR_BYTES sizeof(sd_log_block_hdr_t)
+#define SECONDS_PER_DAY 86400
+
+// Segment blocks, filled by appends. The other buffer is either free or
+// `seg_pending` for the SD task, exactly like log_stream_t.
+static uint8_t seg_buf[2][SD_LOG_BUF_BYTES] __attribute__((aligned(4)));
+static bool seg_close_after[2]; // block is the last one of its segment
+static uint8_t seg_active;
+static bool seg_pending;
+static bool seg_enabled;
+static uint32_t seg_last_time;
+// Start of a segment whose file already existed: its blocks are dropped and
+// the next append starts another segment. 0 = none.
+static uint32_t seg_refused;
+
+// Open segment, owned by the SD task; readers take log_lock to look at the
+// block count and index of the segment still being written.
+static int seg_fd = -1;
+static uint32_t seg_open_start;
+static uint32_t seg_block_count;
+static uint16_t seg_last_count; // records in the last block on the card
+static uint32_t seg_record_count;
+static uint32_t seg_end_time;
+static sd_log_index_t seg_index[SD_LOG_MAX_INDEX];
+static uint32_t seg_index_count;
+
+static SemaphoreHandle_t log_lock;
+static sd_logger_stats_t log_stats;
+static int64_t last_flush_us;
+
+// CRC-8 of a high nibble shifted through poly 0x07, 4 bits at a time: every
+// record read is checked, and bit-by-bit this was most of a read's cost
+static const uint8_t crc8_nibble[16] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D};
+
+uint8_t sd_log_crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    crc = (uint8_t)(crc << 4) ^ crc8_nibble[crc >> 4];
+    crc = (uint8_t)(crc << 4) ^ crc8_nibble[crc >> 4];
+  }
+  return crc;
+}
+
+uint32_t sd_log_crc32(uint32_t crc, const uint8_t *data, size_t len) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++)
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+  }
+  return ~crc;
+}
+
+static uint16_t clamp_u16(uint32_t v) { return v >= 65535 ? 65535 : v; }
+
+bool sd_log_record_from_gps(const gps_data_t *gps, sd_log_record_t *rec) {
+  uint32_t t = gps_unix_time(gps);
+  if (!gps->valid || t == 0)
+    return false;
+
+  rec->time = t;
+  rec->lat_e7 = gps->lat_e7;
+  rec->lon_e7 = gps->lon_e7;
+  rec->alt_cm = gps->alt_cm;
+  rec->speed_ckmh = clamp_u16(gps->speed_ckmh);
+  rec->course_cdeg = gps->course_cdeg;
+  rec->satellites = gps->satellites;
+  uint32_t hdop = gps->hdop_e2 / 10u;
+  rec->hdop_dec = hdop >= 255 ? 255 : (uint8_t)hdop;
+  rec->flags = (gps->valid ? 0x01 : 0) | ((gps->fix_type & 0x03) << 1);
+  rec->crc8 = sd_log_crc8((const uint8_t *)rec, sizeof(*rec) - 1);
+  return true;
+}
+
+bool sd_log_record_valid(const sd_log_record_t *rec) {
+  return rec->time != 0 &&
+         rec->crc8 == sd_log_crc8((const uint8_t *)rec, sizeof(*rec) - 1);
+}
+
+static bool stream_enabled(const log_stream_t *s) { return s->fd >= 0; }
+
+// Bytes the active buffer may hold before the file offset is 4 KiB aligned
+static uint16_t stream_limit(const log_stream_t *s) {
+  uint32_t offset = s->file_size;
+  if (s->pending)
+    offset += s->used[s->active ^ 1];
+  return SD_LOG_BUF_BYTES - (offset % SD_LOG_BUF_BYTES);
+}
+
+static bool stream_put(log_stream_t *s, const void *data, size_t len) {
+  const uint8_t *p = data;
+  while (len > 0) {
+    uint16_t limit = stream_limit(s);
+    uint16_t room = limit - s->used[s->active];
+    size_t n = len < room ? len : room;
+    memcpy(&s->buf[s->active][s->used[s->active]], p, n);
+    s->used[s->active] += n;
+    p += n;
+    len -= n;
+
+    if (s->used[s->active] == limit) {
+      if (s->pending)
+        return false; // SD task has not caught up
+      s->pending = true;
+      s->active ^= 1;
+      s->used[s->active] = 0;
+    }
+  }
+  return true;
+}
+
+static bool stream_has_room(const log_stream_t *s, size_t len) {
+  if (!s->pending)
+    return true;
+  return stream_limit(s) - s->used[s->active] > len;
+}
+
+static sd_log_block_hdr_t *block_hdr(uint8_t *block) {
+  return (sd_log_block_hdr_t *)block;
+}
+
+static sd_log_record_t *block_record(uint8_t *block, uint16_t i) {
+  return (sd_log_record_t *)(block + BLOCK_HDR_BYTES) + i;
+}
+
+static void block_start(uint8_t idx, uint32_t seg_start, uint16_t block_no) {
+  memset(seg_buf[idx], 0, SD_LOG_BUF_BYTES);
+  sd_log_block_hdr_t *h = block_hdr(seg_buf[idx]);
+  h->magic = SD_LOG_BLOCK_MAGIC;
+  h->seg_start = seg_start;
+  h->block_no = block_no;
+  seg_close_after[idx] = false;
+}
+
+static bool seg_rotate_due(const sd_log_block_hdr_t *h, uint32_t time) {
+  return time / SECONDS_PER_DAY != h->seg_start / SECONDS_PER_DAY ||
+         h->seg_start == seg_refused ||
+         (h->count == SD_LOG_BLOCK_RECORDS &&
+          h->block_no + 1 >= SD_LOG_SEG_MAX_BLOCKS);
+}
+
+// True if seg_put() will not need the buffer the SD task may still hold
+static bool seg_has_room(uint32_t time) {
+  const sd_log_block_hdr_t *h = block_hdr(seg_buf[seg_active]);
+  if (h->magic == 0)
+    return true;
+  if (h->count < SD_LOG_BLOCK_RECORDS && !seg_rotate_due(h, time))
+    return true;
+  return !seg_pending;
+}
+
+static void seg_put(const sd_log_record_t *rec) {
+  sd_log_block_hdr_t *h = block_hdr(seg_buf[seg_active]);
+  if (h->magic == 0) {
+    block_start(seg_active, rec->time, 0);
+  } else if (seg_rotate_due(h, rec->time)) {
+    seg_close_after[seg_active] = true;
+    seg_pending = true;
+    seg_active ^= 1;
+    block_start(seg_active, rec->time, 0);
+  } else if (h->count == SD_LOG_BLOCK_RECORDS) {
+    uint32_t seg_start = h->seg_start;
+    uint16_t next = h->block_no + 1;
+    seg_pending = true;
+    seg_active ^= 1;
+    block_start(seg_active, seg_start, next);
+  }
+
+  h = block_hdr(seg_buf[seg_active]);
+  if (h->count == 0)
+    h->first_time = rec->time;
+  *block_record(seg_buf[seg_active], h->count) = *rec;
+  h->count++;
+  seg_last_time = rec->time;
+}
+
+static esp_err_t write_all(int fd, const uint8_t *data, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, data, len);
+    if (n <= 0)
+      return ESP_FAIL;
+    data += n;
+    len -= n;
+  }
+  return ESP_OK;
+}
+
+static bool read_at(int fd, off_t offset, void *data, size_t len) {
+  return lseek(fd, offset, SEEK_SET) == offset &&
+         read(fd, data, len) == (ssize_t)len;
+}
+
+static void seg_path(char *path, size_t size, uint32_t seg_start) {
+  snprintf(path, size, SD_LOG_SEG_DIR "/%08lX.BIN", (unsigned long)seg_start);
+}
+
+static bool seg_parse_name(const char *name, uint32_t *seg_start) {
+  char *end;
+  unsigned long v = strtoul(name, &end, 16);
+  if (end != name + 8 || strcasecmp(end, ".BIN") != 0)
+    return false;
+  *seg_start = (uint32_t)v;
+  return true;
+}
+
+static uint32_t footer_crc(const sd_log_index_t *index,
+                           const sd_log_trailer_t *tr) {
+  uint32_t crc = sd_log_crc32(0, (const uint8_t *)index,
+                              tr->index_count * sizeof(*index));
+  return sd_log_crc32(crc, (const uint8_t *)tr,
+                      offsetof(sd_log_trailer_t, crc32));
+}
+
+// Footer goes right after the last block; the file is cut there so a
+// leftover tail from an interrupted footer never survives
+static esp_err_t seg_write_footer(int fd, const sd_log_index_t *index,
+                                  sd_log_trailer_t *tr) {
+  tr->magic = SD_LOG_TRAILER_MAGIC;
+  tr->crc32 = footer_crc(index, tr);
+  off_t end = (off_t)tr->block_count * SD_LOG_BUF_BYTES;
+  if (lseek(fd, end, SEEK_SET) != end ||
+      write_all(fd, (const uint8_t *)index,
+                tr->index_count * sizeof(*index)) != ESP_OK ||
+      write_all(fd, (const uint8_t *)tr, sizeof(*tr)) != ESP_OK)
+    return ESP_FAIL;
+  end += tr->index_count * sizeof(*index) + sizeof(*tr);
+  ftruncate(fd, end);
+  fsync(fd);
+  return ESP_OK;
+}
+
+// Reads and checks the footer of a closed segment into tr and index
+static bool seg_load_footer(int fd, sd_log_trailer_t *tr,
+                            sd_log_index_t *index) {
+  off_t size = lseek(fd, 0, SEEK_END);
+  if (size < (off_t)sizeof(*tr) ||
+      !read_at(fd, size - sizeof(*tr), tr, sizeof(*tr)))
+    return false;
+  if (tr->magic != SD_LOG_TRAILER_MAGIC ||
+      tr->index_count > SD_LOG_MAX_INDEX ||
+      size != (off_t)tr->block_count * SD_LOG_BUF_BYTES +
+                  tr->index_count * sizeof(*index) + sizeof(*tr))
+    return false;
+  size_t index_bytes = tr->index_count * sizeof(*index);
+  if (!read_at(fd, size - sizeof(*tr) - index_bytes, index, index_bytes))
+    return false;
+  return footer_crc(index, tr) == tr->crc32;
+}
+
+static void seg_close(void) {
+  sd_log_trailer_t tr = {0};
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  tr.record_count = seg_record_count;
+  tr.block_count = seg_block_count;
+  tr.index_count = seg_index_count;
+  tr.start_time = seg_open_start;
+  tr.end_time = seg_end_time;
+  xSemaphoreGive(log_lock);
+
+  if (seg_write_footer(seg_fd, seg_index, &tr) != ESP_OK)
+    ESP_LOGW(TAG, "Footer write failed for segment %08lX",
+             (unsigned long)tr.start_time);
+  close(seg_fd);
+
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  seg_fd = -1;
+  seg_open_start = 0;
+  xSemaphoreGive(log_lock);
+}
+
+static esp_err_t seg_open(uint32_t seg_start) {
+  char path[32];
+  seg_path(path, sizeof(path), seg_start);
+  // Never over an existing segment: its fixes stay, these are dropped
+  int fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0 && errno == EEXIST) {
+    ESP_LOGW(TAG, "%s already exists, starting another segment", path);
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    seg_refused = seg_start;
+    xSemaphoreGive(log_lock);
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (fd < 0) {
+    ESP_LOGW(TAG, "Failed to create %s", path);
+    return ESP_FAIL;
+  }
+
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  seg_fd = fd;
+  seg_open_start = seg_start;
+  seg_block_count = 0;
+  seg_last_count = 0;
+  seg_record_count = 0;
+  seg_end_time = 0;
+  seg_index_count = 0;
+  log_stats.segments++;
+  xSemaphoreGive(log_lock);
+  ESP_LOGI(TAG, "New segment %s", path);
+  return ESP_OK;
+}
+
+// Writes one block at its own offset: full blocks once, the last block of
+// an open segment again on every flush until it fills up
+static esp_err_t seg_write_block(uint8_t *block, bool close_after) {
+  sd_log_block_hdr_t *h = block_hdr(block);
+  if (h->seg_start == seg_refused)
+    return ESP_OK;
+  if (seg_fd >= 0 && seg_open_start != h->seg_start)
+    seg_close();
+  if (seg_fd < 0 && seg_open(h->seg_start) != ESP_OK)
+    return ESP_FAIL;
+
+  int64_t start = esp_timer_get_time();
+  off_t offset = (off_t)h->block_no * SD_LOG_BUF_BYTES;
+  if (lseek(seg_fd, offset, SEEK_SET) != offset ||
+      write_all(seg_fd, block, SD_LOG_BUF_BYTES) != ESP_OK) {
+    ESP_LOGW(TAG, "Write to segment %08lX failed",
+             (unsigned long)h->seg_start);
+    return ESP_FAIL;
+  }
+  fsync(seg_fd);
+
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  if (h->block_no >= seg_block_count) {
+    seg_block_count = h->block_no + 1;
+    seg_record_count += h->count;
+    if (h->block_no % SD_LOG_INDEX_STRIDE == 0 &&
+        seg_index_count < SD_LOG_MAX_INDEX)
+      seg_index[seg_index_count++] =
+          (sd_log_index_t){.time = h->first_time, .block_no = h->block_no};
+  } else {
+    seg_record_count += h->count - seg_last_count;
+  }
+  seg_last_count = h->count;
+  seg_end_time = block_record(block, h->count - 1)->time;
+  log_stats.writes++;
+  log_stats.bytes_written += SD_LOG_BUF_BYTES;
+  log_stats.last_write_us = (uint32_t)(esp_timer_get_time() - start);
+  xSemaphoreGive(log_lock);
+
+  if (close_after)
+    seg_close();
+  return ESP_OK;
+}
+
+static esp_err_t seg_service(bool force) {
+  if (!seg_enabled)
+    return ESP_OK;
+
+  esp_err_t ret = ESP_OK;
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  bool pending = seg_pending;
+  uint8_t idx = seg_active ^ 1;
+  xSemaphoreGive(log_lock);
+
+  if (pending) {
+    ret = seg_write_block(seg_buf[idx], seg_close_after[idx]);
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    seg_pending = false;
+    xSemaphoreGive(log_lock);
+  }
+
+  if (force && ret == ESP_OK) {
+    // Snapshot the partial block into the free buffer; appends keep going
+    // into the active one and it is rewritten at the same offset later
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    idx = seg_active ^ 1;
+    bool partial = !seg_pending &&
+                   block_hdr(seg_buf[seg_active])->count > 0;
+    if (partial) {
+      memcpy(seg_buf[idx], seg_buf[seg_active], SD_LOG_BUF_BYTES);
+      seg_close_after[idx] = false;
+      seg_pending = true;
+    }
+    xSemaphoreGive(log_lock);
+
+    if (partial) {
+      ret = seg_write_block(seg_buf[idx], false);
+      xSemaphoreTake(log_lock, portMAX_DELAY);
+      seg_pending = false;
+      xSemaphoreGive(log_lock);
+    }
+  }
+  return ret;
+}
+
+// Valid records at the start of a block: CRC ok and time increasing
+static uint16_t block_valid_prefix(uint8_t *block) {
+  uint32_t last = 0;
+  uint16_t n = 0;
+  for (; n < SD_LOG_BLOCK_RECORDS; n++) {
+    const sd_log_record_t *rec = block_record(block, n);
+    if (!sd_log_record_valid(rec) || rec->time <= last)
+      break;
+    last = rec->time;
+  }
+  return n;
+}
+
+// A segment without a valid footer was cut off by a reset. Only its tail is
+// read: torn trailing blocks are dropped, the last good block is trimmed
+// to its valid records, and the index is rebuilt from the header of every
+// SD_LOG_INDEX_STRIDE-th block before the footer is written. The newest
+// segment's end time seeds seg_last_time, so segments after a reboot
+// start later than it and never reuse a name.
+static void seg_recover_last(void) {
+  DIR *dir = opendir(SD_LOG_SEG_DIR);
+  if (!dir)
+    return;
+  uint32_t last = 0;
+  bool found = false;
+  struct dirent *de;
+  while ((de = readdir(dir)) != NULL) {
+    uint32_t s;
+    if (seg_parse_name(de->d_name, &s) && (!found || s > last)) {
+      last = s;
+      found = true;
+    }
+  }
+  closedir(dir);
+  if (!found)
+    return;
+
+  char path[32];
+  seg_path(path, sizeof(path), last);
+  int fd = open(path, O_RDWR);
+  if (fd < 0)
+    return;
+
+  // Nothing is being written yet, so the segment buffers serve as scratch
+  sd_log_trailer_t tr = {0};
+  if (seg_load_footer(fd, &tr, seg_index)) {
+    close(fd);
+    seg_last_time = tr.end_time;
+    return;
+  }
+
+  uint8_t *block = seg_buf[0];
+  sd_log_block_hdr_t *h = block_hdr(block);
+  uint32_t blocks = (uint32_t)(lseek(fd, 0, SEEK_END) / SD_LOG_BUF_BYTES);
+  uint16_t kept = 0;
+  while (blocks > 0) {
+    off_t offset = (off_t)(blocks - 1) * SD_LOG_BUF_BYTES;
+    if (read_at(fd, offset, block, SD_LOG_BUF_BYTES) &&
+        h->magic == SD_LOG_BLOCK_MAGIC && h->seg_start == last &&
+        (kept = block_valid_prefix(block)) > 0)
+      break;
+    blocks--;
+  }
+
+  if (blocks == 0) {
+    close(fd);
+    unlink(path);
+    ESP_LOGW(TAG, "Removed empty segment %s", path);
+    return;
+  }
+
+  tr.end_time = block_record(block, kept - 1)->time;
+  if (h->count != kept) {
+    h->count = kept;
+    memset(block_record(block, kept), 0,
+           (SD_LOG_BLOCK_RECORDS - kept) * sizeof(sd_log_record_t));
+    off_t offset = (off_t)(blocks - 1) * SD_LOG_BUF_BYTES;
+    if (lseek(fd, offset, SEEK_SET) == offset)
+      write_all(fd, block, SD_LOG_BUF_BYTES);
+  }
+
+  tr.index_count = 0;
+  for (uint32_t b = 0; b < blocks; b += SD_LOG_INDEX_STRIDE) {
+    sd_log_block_hdr_t bh;
+    if (read_at(fd, (off_t)b * SD_LOG_BUF_BYTES, &bh, sizeof(bh)) &&
+        bh.magic == SD_LOG_BLOCK_MAGIC && bh.block_no == b &&
+        tr.index_count < SD_LOG_MAX_INDEX)
+      seg_index[tr.index_count++] =
+          (sd_log_index_t){.time = bh.first_time, .block_no = b};
+  }
+
+  // Blocks before the last are only handed over once full
+  tr.record_count = (blocks - 1) * SD_LOG_BLOCK_RECORDS + kept;
+  tr.block_count = blocks;
+  tr.start_time = last;
+  seg_write_footer(fd, seg_index, &tr);
+  close(fd);
+  seg_last_time = tr.end_time;
+
+  memset(block, 0, SD_LOG_BUF_BYTES);
+  log_stats.recovered = tr.record_count;
+  ESP_LOGW(TAG, "Recovered %s: %lu records in %lu blocks", path,
+           (unsigned long)tr.record_count, (unsigned long)blocks);
+}
+
+esp_err_t sd_logger_init(void) {
+  log_lock = xSemaphoreCreateMutex();
+  if (!log_lock)
+    return ESP_ERR_NO_MEM;
+
+  if (SD_LOG_FORMATS & SD_LOG_CSV) {
+    // Kept open for the lifetime of the logger: no directory update per fix
+    csv_stream.fd = open(csv_stream.path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (csv_stream.fd < 0) {
+      ESP_LOGW(TAG, "Failed to open %s", csv_stream.path);
+    } else {
+      off_t size = lseek(csv_stream.fd, 0, SEEK_END);
+      csv_stream.file_size = size > 0 ? (uint32_t)size : 0;
+    }
+  }
+
+  if (SD_LOG_FORMATS & SD_LOG_BIN) {
+    struct stat st;
+    if (stat(SD_LOG_SEG_DIR, &st) != 0 && mkdir(SD_LOG_SEG_DIR, 0755) != 0) {
+      ESP_LOGW(TAG, "Failed to create %s", SD_LOG_SEG_DIR);
+    } else {
+      seg_recover_last();
+      seg_enabled = true;
+    }
+  }
+
+  if (!stream_enabled(&csv_stream) && !seg_enabled)
+    return ESP_FAIL;
+
+  last_flush_us = esp_timer_get_time();
+  ESP_LOGI(TAG, "SD logger ready (csv=%d bin=%d)",
+           stream_enabled(&csv_stream), seg_enabled);
+  return ESP_OK;
+}
+
+// Appends one formatted field and its separator; a field that does not fit
+// (formatter returned 0) empties the whole line
+static char *csv_field(char *p, int len, char sep) {
+  if (!p || len == 0)
+    return NULL;
+  p += len;
+  *p++ = sep;
+  return p;
+}
+
+// Legacy text line (uptime, position, alt, sats, speed, course, hhmmss,
+// ddmmyy), rebuilt from the record so simplified fixes log the same way.
+// Written field by field: snprintf was half the cost of an append.
+static int csv_line(const sd_log_record_t *rec, char *line, size_t size) {
+  char iso[FIXED_FMT_ISO8601_LEN]; // "YYYY-MM-DDTHH:MM:SSZ"
+  fixed_fmt_iso8601(iso, sizeof(iso), rec->time);
+  // Every field but the last two is bounded by FIXED_FMT_MAX; the last two
+  // are 6 characters plus separator
+  if (size < 7 * FIXED_FMT_MAX + 2 * 7 + 1)
+    return 0;
+  char *p = line;
+  p = csv_field(p, fixed_fmt_u32(p, FIXED_FMT_MAX,
+                                 (uint32_t)(esp_timer_get_time() / 1000000)),
+                ',');
+  p = csv_field(p, fixed_fmt(p, FIXED_FMT_MAX, rec->lat_e7, 7), ',');
+  p = csv_field(p, fixed_fmt(p, FIXED_FMT_MAX, rec->lon_e7, 7), ',');
+  p = csv_field(p, fixed_fmt(p, FIXED_FMT_MAX, rec->alt_cm, 2), ',');
+  p = csv_field(p, fixed_fmt_u32(p, FIXED_FMT_MAX, rec->satellites), ',');
+  p = csv_field(p, fixed_fmt(p, FIXED_FMT_MAX, rec->speed_ckmh, 2), ',');
+  p = csv_field(p, fixed_fmt(p, FIXED_FMT_MAX, rec->course_cdeg, 2), ',');
+  if (!p)
+    return 0;
+  // hhmmss from "HH:MM:SS", then ddmmyy from "YYYY-MM-DD"
+  static const uint8_t order[12] = {11, 12, 14, 15, 17, 18, 8, 9, 5, 6, 2, 3};
+  for (int i = 0; i < 12; i++) {
+    *p++ = iso[order[i]];
+    if (i == 5)
+      *p++ = ',';
+  }
+  *p++ = '\n';
+  return p - line;
+}
+
+bool sd_logger_append(const gps_data_t *gps) {
+  sd_log_record_t rec;
+  if (!sd_log_record_from_gps(gps, &rec))
+    return false;
+  return sd_logger_append_record(&rec);
+}
+
+bool sd_logger_append_record(const sd_log_record_t *rec) {
+  if (!log_lock)
+    return false;
+
+  char line[128];
+  int line_len = 0;
+  if (stream_enabled(&csv_stream))
+    line_len = csv_line(rec, line, sizeof(line));
+
+  bool ok = true;
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  // Segments need strictly increasing time for the index to hold
+  bool bin = seg_enabled && rec->time > seg_last_time;
+  // All-or-nothing per fix, so a drop never leaves half a record
+  if ((bin && !seg_has_room(rec->time)) ||
+      (line_len && !stream_has_room(&csv_stream, line_len))) {
+    ok = false;
+  } else {
+    if (bin)
+      seg_put(rec);
+    if (line_len)
+      stream_put(&csv_stream, line, line_len);
+  }
+  if (ok)
+    log_stats.records++;
+  else
+    log_stats.dropped++;
+  xSemaphoreGive(log_lock);
+  return ok;
+}
+
+// Writes one buffer outside the lock; the buffer is not touched by appends
+// while it is marked pending. fsync commits the FAT size once per buffer.
+static esp_err_t stream_write(log_stream_t *s, const uint8_t *data,
+                              size_t len) {
+  int64_t start = esp_timer_get_time();
+  esp_err_t ret = write_all(s->fd, data, len);
+  if (ret == ESP_OK)
+    fsync(s->fd);
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "Write to %s failed", s->path);
+    return ret;
+  }
+
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  s->file_size += len;
+  log_stats.writes++;
+  log_stats.bytes_written += len;
+  log_stats.last_write_us = (uint32_t)(esp_timer_get_time() - start);
+  xSemaphoreGive(log_lock);
+  return ESP_OK;
+}
+
+static esp_err_t stream_service(log_stream_t *s, bool force) {
+  if (!stream_enabled(s))
+    return ESP_OK;
+
+  esp_err_t ret = ESP_OK;
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  bool pending = s->pending;
+  uint8_t idx = s->active ^ 1;
+  xSemaphoreGive(log_lock);
+
+  if (pending) {
+    ret = stream_write(s, s->buf[idx], s->used[idx]);
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    s->pending = false;
+    xSemaphoreGive(log_lock);
+  }
+
+  if (force && ret == ESP_OK) {
+    // Swap the partial buffer out so appends can continue meanwhile
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    idx = s->active;
+    uint16_t used = s->used[idx];
+    if (used > 0) {
+      s->pending = true;
+      s->active ^= 1;
+      s->used[s->active] = 0;
+    }
+    xSemaphoreGive(log_lock);
+
+    if (used > 0) {
+      ret = stream_write(s, s->buf[idx], used);
+      xSemaphoreTake(log_lock, portMAX_DELAY);
+      s->pending = false;
+      xSemaphoreGive(log_lock);
+    }
+  }
+  return ret;
+}
+
+static esp_err_t logger_service(bool force) {
+  esp_err_t ret = stream_service(&csv_stream, force);
+  esp_err_t r = seg_service(force);
+  return ret != ESP_OK ? ret : r;
+}
+
+esp_err_t sd_logger_service(void) {
+  if (!log_lock)
+    return ESP_ERR_INVALID_STATE;
+
+  int64_t now = esp_timer_get_time();
+  bool force = (now - last_flush_us) >= (int64_t)SD_LOG_FLUSH_MS * 1000;
+  if (force)
+    last_flush_us = now;
+  return logger_service(force);
+}
+
+esp_err_t sd_logger_flush(void) {
+  if (!log_lock)
+    return ESP_ERR_INVALID_STATE;
+
+  last_flush_us = esp_timer_get_time();
+  return logger_service(true);
+}
+
+void sd_logger_get_stats(sd_logger_stats_t *stats) {
+  if (!log_lock) {
+    memset(stats, 0, sizeof(*stats));
+    return;
+  }
+  xSemaphoreTake(log_lock, portMAX_DELAY);
+  *stats = log_stats;
+  xSemaphoreGive(log_lock);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+// Sorted segment ids; keeps the newest SD_LOG_MAX_SEGMENTS
+static uint16_t seg_list(uint32_t *segs) {
+  DIR *dir = opendir(SD_LOG_SEG_DIR);
+  if (!dir)
+    return 0;
+  uint16_t n = 0;
+  struct dirent *de;
+  while ((de = readdir(dir)) != NULL) {
+    uint32_t s;
+    if (!seg_parse_name(de->d_name, &s))
+      continue;
+    if (n < SD_LOG_MAX_SEGMENTS) {
+      segs[n++] = s;
+      continue;
+    }
+    uint16_t oldest = 0;
+    for (uint16_t i = 1; i < n; i++)
+      if (segs[i] < segs[oldest])
+        oldest = i;
+    if (s > segs[oldest])
+      segs[oldest] = s;
+  }
+  closedir(dir);
+  qsort(segs, n, sizeof(segs[0]), cmp_u32);
+  return n;
+}
+
+// Block of the last index entry at or before `from`
+static uint32_t index_search(const sd_log_index_t *index, uint32_t n,
+                             uint32_t from) {
+  uint32_t lo = 0, hi = n;
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (index[mid].time <= from)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo > 0 ? index[lo - 1].block_no : 0;
+}
+
+// Opens cur->segs[cur->seg_idx] (or the next readable one); `seek` places
+// the cursor at the index entry before cur->from
+static bool cursor_open_segment(sd_log_cursor_t *cur, bool seek) {
+  for (; cur->seg_idx < cur->seg_count; cur->seg_idx++) {
+    uint32_t start = cur->segs[cur->seg_idx];
+    char path[32];
+    seg_path(path, sizeof(path), start);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+      continue;
+
+    uint32_t first = 0;
+    bool active = false;
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    if (seg_fd >= 0 && seg_open_start == start) {
+      // Still being written: the footer does not exist yet, use RAM
+      active = true;
+      cur->block_count = seg_block_count;
+      if (seek)
+        first = index_search(seg_index, seg_index_count, cur->from);
+    }
+    xSemaphoreGive(log_lock);
+
+    if (!active) {
+      sd_log_trailer_t tr;
+      sd_log_index_t *index = (sd_log_index_t *)cur->block;
+      if (seg_load_footer(fd, &tr, index)) {
+        if (tr.end_time < cur->from) {
+          close(fd);
+          continue;
+        }
+        cur->block_count = tr.block_count;
+        if (seek)
+          first = index_search(index, tr.index_count, cur->from);
+      } else {
+        cur->block_count =
+            (uint32_t)(lseek(fd, 0, SEEK_END) / SD_LOG_BUF_BYTES);
+      }
+    }
+
+    cur->fd = fd;
+    cur->block_no = first;
+    cur->rec_idx = 0;
+    cur->rec_count = 0;
+    return true;
+  }
+  return false;
+}
+
+esp_err_t sd_log_cursor_open(sd_log_cursor_t *cur, uint32_t from,
+                             uint32_t to) {
+  cur->fd = -1;
+  cur->from = from;
+  cur->to = to;
+  cur->seg_idx = 0;
+  cur->seg_count = seg_list(cur->segs);
+  if (!log_lock || cur->seg_count == 0)
+    return ESP_ERR_NOT_FOUND;
+
+  // Last segment starting at or before `from`
+  uint16_t lo = 0, hi = cur->seg_count;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (cur->segs[mid] <= from)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  cur->seg_idx = lo > 0 ? lo - 1 : 0;
+  if (cur->segs[cur->seg_idx] > to)
+    return ESP_ERR_NOT_FOUND;
+
+  return cursor_open_segment(cur, true) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+bool sd_log_cursor_next(sd_log_cursor_t *cur, sd_log_record_t *rec) {
+  while (cur->fd >= 0) {
+    while (cur->rec_idx < cur->rec_count) {
+      *rec = *block_record(cur->block, cur->rec_idx++);
+      if (!sd_log_record_valid(rec) || rec->time < cur->from)
+        continue;
+      if (rec->time > cur->to) {
+        sd_log_cursor_close(cur);
+        return false;
+      }
+      return true;
+    }
+
+    if (cur->block_no < cur->block_count) {
+      const sd_log_block_hdr_t *h = block_hdr(cur->block);
+      cur->rec_idx = 0;
+      cur->rec_count = 0;
+      if (read_at(cur->fd, (off_t)cur->block_no * SD_LOG_BUF_BYTES,
+                  cur->block, SD_LOG_BUF_BYTES) &&
+          h->magic == SD_LOG_BLOCK_MAGIC)
+        cur->rec_count = h->count < SD_LOG_BLOCK_RECORDS
+                             ? h->count
+                             : SD_LOG_BLOCK_RECORDS;
+      cur->block_no++;
+      continue;
+    }
+
+    close(cur->fd);
+    cur->fd = -1;
+    cur->seg_idx++;
+    cursor_open_segment(cur, false);
+  }
+  return false;
+}
+
+void sd_log_cursor_close(sd_log_cursor_t *cur) {
+  if (cur->fd >= 0)
+    close(cur->fd);
+  cur->fd = -1;
+  cur->seg_idx = cur->seg_count;
+}
@@ -0,0 +1,327 @@
+#include "track.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "TRACK";
+
+// Record flags: a field is present only when it differs from the previous fix
+#define REC_DT 0x01     // dt != 1 s, varint follows
+#define REC_POS 0x02    // zigzag varint dlat, dlon
+#define REC_ALT 0x04    // zigzag varint dalt
+#define REC_SPEED 0x08  // zigzag varint dspeed
+#define REC_COURSE 0x10 // raw course byte
+
+typedef struct {
+  uint32_t seq;
+  track_fix_t first;
+  uint16_t used;
+  uint16_t count; // delta records after `first`
+} track_block_t;
+
+static track_block_t blocks[TRACK_BLOCKS];
+static uint8_t ring[TRACK_BLOCKS][TRACK_BLOCK_BYTES];
+static uint32_t head_seq; // oldest live block
+static uint32_t tail_seq; // block being appended to
+static bool have_data;
+static track_fix_t last_fix;
+static uint32_t total_fixes;
+static uint32_t total_bytes;
+static SemaphoreHandle_t track_lock;
+
+static size_t put_varint(uint8_t *p, uint64_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+static size_t get_varint(const uint8_t *p, size_t len, uint64_t *v) {
+  uint64_t r = 0;
+  for (size_t n = 0; n < len && n < 10; n++) {
+    r |= (uint64_t)(p[n] & 0x7F) << (7 * n);
+    if (!(p[n] & 0x80)) {
+      *v = r;
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+static inline uint64_t zigzag(int64_t v) {
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+size_t track_encode(const track_fix_t *prev, const track_fix_t *cur,
+                    uint8_t *out) {
+  if (cur->time <= prev->time)
+    return 0;
+
+  uint8_t flags = 0;
+  uint8_t *p = out + 1;
+
+  uint32_t dt = cur->time - prev->time;
+  if (dt != 1) {
+    flags |= REC_DT;
+    p += put_varint(p, dt);
+  }
+  if (cur->lat_e7 != prev->lat_e7 || cur->lon_e7 != prev->lon_e7) {
+    flags |= REC_POS;
+    p += put_varint(p, zigzag((int64_t)cur->lat_e7 - prev->lat_e7));
+    p += put_varint(p, zigzag((int64_t)cur->lon_e7 - prev->lon_e7));
+  }
+  if (cur->alt_dm != prev->alt_dm) {
+    flags |= REC_ALT;
+    p += put_varint(p, zigzag((int64_t)cur->alt_dm - prev->alt_dm));
+  }
+  if (cur->speed_dkmh != prev->speed_dkmh) {
+    flags |= REC_SPEED;
+    p += put_varint(p, zigzag((int64_t)cur->speed_dkmh - prev->speed_dkmh));
+  }
+  if (cur->course_2deg != prev->course_2deg) {
+    flags |= REC_COURSE;
+    *p++ = cur->course_2deg;
+  }
+
+  out[0] = flags;
+  return (size_t)(p - out);
+}
+
+size_t track_decode(const track_fix_t *prev, const uint8_t *in, size_t len,
+                    track_fix_t *out) {
+  if (len < 1)
+    return 0;
+
+  uint8_t flags = in[0];
+  size_t n = 1, w;
+  uint64_t v;
+  *out = *prev;
+
+  if (flags & REC_DT) {
+    if (!(w = get_varint(in + n, len - n, &v)))
+      return 0;
+    n += w;
+    out->time = prev->time + (uint32_t)v;
+  } else {
+    out->time = prev->time + 1;
+  }
+  if (flags & REC_POS) {
+    if (!(w = get_varint(in + n, len - n, &v)))
+      return 0;
+    n += w;
+    out->lat_e7 = (int32_t)(prev->lat_e7 + unzigzag(v));
+    if (!(w = get_varint(in + n, len - n, &v)))
+      return 0;
+    n += w;
+    out->lon_e7 = (int32_t)(prev->lon_e7 + unzigzag(v));
+  }
+  if (flags & REC_ALT) {
+    if (!(w = get_varint(in + n, len - n, &v)))
+      return 0;
+    n += w;
+    out->alt_dm = (int32_t)(prev->alt_dm + unzigzag(v));
+  }
+  if (flags & REC_SPEED) {
+    if (!(w = get_varint(in + n, len - n, &v)))
+      return 0;
+    n += w;
+    out->speed_dkmh = (uint16_t)(prev->speed_dkmh + unzigzag(v));
+  }
+  if (flags & REC_COURSE) {
+    if (n >= len)
+      return 0;
+    out->course_2deg = in[n++];
+  }
+  return n;
+}
+
+bool track_fix_from_gps(const gps_data_t *gps, track_fix_t *out) {
+  uint32_t t = gps_unix_time(gps);
+  if (!gps->valid || t == 0)
+    return false;
+
+  out->time = t;
+  out->lat_e7 = gps->lat_e7;
+  out->lon_e7 = gps->lon_e7;
+  out->alt_dm = gps->alt_cm / 10;
+  uint32_t speed = gps->speed_ckmh / 10;
+  out->speed_dkmh = speed >= 65535 ? 65535 : (uint16_t)speed;
+  out->course_2deg = (uint8_t)((gps->course_cdeg + 100) / 200 % 180);
+  return true;
+}
+
+esp_err_t track_init(void) {
+  track_lock = xSemaphoreCreateMutex();
+  if (!track_lock)
+    return ESP_ERR_NO_MEM;
+  ESP_LOGI(TAG, "Track ring: %d blocks x %d bytes", TRACK_BLOCKS,
+           TRACK_BLOCK_BYTES);
+  return ESP_OK;
+}
+
+static void start_block(uint32_t seq, const track_fix_t *fix) {
+  track_block_t *b = &blocks[seq % TRACK_BLOCKS];
+  b->seq = seq;
+  b->first = *fix;
+  b->used = 0;
+  b->count = 0;
+}
+
+bool track_append(const track_fix_t *fix) {
+  if (!track_lock)
+    return false;
+
+  xSemaphoreTake(track_lock, portMAX_DELAY);
+  bool ok = true;
+  if (!have_data) {
+    head_seq = tail_seq = 0;
+    start_block(0, fix);
+    have_data = true;
+  } else if (fix->time <= last_fix.time) {
+    ok = false;
+  } else {
+    uint32_t slot = tail_seq % TRACK_BLOCKS;
+    track_block_t *b = &blocks[slot];
+    if (b->used + TRACK_MAX_RECORD > TRACK_BLOCK_BYTES) {
+      tail_seq++;
+      if (tail_seq - head_seq >= TRACK_BLOCKS) {
+        // Drop the oldest block; its slot is reused for the new one
+        track_block_t *old = &blocks[head_seq % TRACK_BLOCKS];
+        total_fixes -= old->count + 1u;
+        total_bytes -= old->used;
+        head_seq++;
+      }
+      start_block(tail_seq, fix);
+    } else {
+      size_t n = track_encode(&last_fix, fix, &ring[slot][b->used]);
+      b->used += n;
+      b->count++;
+      total_bytes += n;
+    }
+  }
+  if (ok) {
+    last_fix = *fix;
+    total_fixes++;
+  }
+  xSemaphoreGive(track_lock);
+  return ok;
+}
+
+void track_get_stats(track_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+  if (!track_lock)
+    return;
+
+  xSemaphoreTake(track_lock, portMAX_DELAY);
+  if (have_data) {
+    stats->fixes = total_fixes;
+    stats->bytes_used =
+        total_bytes + (tail_seq - head_seq + 1) * sizeof(track_block_t);
+    stats->oldest = blocks[head_seq % TRACK_BLOCKS].first.time;
+    stats->newest = last_fix.time;
+  }
+  xSemaphoreGive(track_lock);
+}
+
+// Last block whose first fix is not after `from` (blocks are time-ordered)
+static uint32_t find_start_block(uint32_t from) {
+  uint32_t lo = head_seq, hi = tail_seq;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo + 1) / 2;
+    if (blocks[mid % TRACK_BLOCKS].first.time <= from)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+static void load_block(track_cursor_t *cur, uint32_t seq) {
+  const track_block_t *b = &blocks[seq % TRACK_BLOCKS];
+  cur->seq = seq;
+  cur->first = b->first;
+  cur->first_done = false;
+  cur->pos = 0;
+  cur->len = b->used;
+  memcpy(cur->data, ring[seq % TRACK_BLOCKS], b->used);
+  cur->loaded = true;
+}
+
+// Called with more data needed; false at the end of the ring
+static bool cursor_refill(track_cursor_t *cur) {
+  bool ok = true;
+  xSemaphoreTake(track_lock, portMAX_DELAY);
+  if (!have_data) {
+    ok = false;
+  } else if (!cur->loaded) {
+    load_block(cur, find_start_block(cur->from));
+  } else if (cur->seq < head_seq) {
+    // Our block was evicted while we were reading; resume at the oldest
+    load_block(cur, head_seq);
+  } else if (blocks[cur->seq % TRACK_BLOCKS].used > cur->len) {
+    // The tail block grew since we copied it; earlier bytes never change
+    uint16_t used = blocks[cur->seq % TRACK_BLOCKS].used;
+    memcpy(cur->data + cur->len, ring[cur->seq % TRACK_BLOCKS] + cur->len,
+           used - cur->len);
+    cur->len = used;
+  } else if (cur->seq < tail_seq) {
+    load_block(cur, cur->seq + 1);
+  } else {
+    ok = false;
+  }
+  xSemaphoreGive(track_lock);
+  return ok;
+}
+
+void track_cursor_init(track_cursor_t *cur, uint32_t from, uint32_t to) {
+  memset(cur, 0, sizeof(*cur));
+  cur->from = from;
+  cur->to = to;
+}
+
+bool track_cursor_next(track_cursor_t *cur, track_fix_t *fix) {
+  if (!track_lock)
+    return false;
+
+  while (1) {
+    track_fix_t cand;
+    if (!cur->loaded) {
+      if (!cursor_refill(cur))
+        return false;
+      continue;
+    }
+    if (!cur->first_done) {
+      cur->first_done = true;
+      cand = cur->first;
+    } else if (cur->pos < cur->len) {
+      size_t n =
+          track_decode(&cur->prev, cur->data + cur->pos, cur->len - cur->pos,
+                       &cand);
+      if (!n) {
+        cur->pos = cur->len;
+        continue;
+      }
+      cur->pos += n;
+    } else {
+      if (!cursor_refill(cur))
+        return false;
+      continue;
+    }
+
+    cur->prev = cand;
+    if (cand.time < cur->from)
+      continue;
+    if (cand.time > cur->to)
+      return false;
+    *fix = cand;
+    return true;
+  }
+}
@@ -0,0 +1,211 @@
+#include "track_export.h"
+#include "esp_log.h"
+#include "fixed_fmt.h"
+#include "sd_logger.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "TRACK_EXPORT";
+
+// Worst case of one formatted record (GPX trkpt) with margin
+#define MAX_ITEM 192
+
+typedef struct {
+  char buf[TRACK_EXPORT_CHUNK];
+  size_t len;
+  track_export_sink_t sink;
+  void *ctx;
+  esp_err_t err;
+  track_export_stats_t stats;
+} out_t;
+
+static const struct {
+  const char *name;
+  const char *mime;
+} formats[] = {
+    [TRACK_EXPORT_GPX] = {"gpx", "application/gpx+xml"},
+    [TRACK_EXPORT_GEOJSON] = {"geojson", "application/geo+json"},
+    [TRACK_EXPORT_CSV] = {"csv", "text/csv"},
+    [TRACK_EXPORT_BIN] = {"bin", "application/octet-stream"},
+};
+
+bool track_export_parse_format(const char *name, track_export_format_t *fmt) {
+  for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+    if (strcmp(name, formats[i].name) == 0) {
+      *fmt = (track_export_format_t)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *track_export_mime(track_export_format_t fmt) {
+  return formats[fmt].mime;
+}
+
+const char *track_export_extension(track_export_format_t fmt) {
+  return formats[fmt].name;
+}
+
+static void out_flush(out_t *o) {
+  if (o->len == 0 || o->err != ESP_OK)
+    return;
+  o->err = o->sink(o->buf, o->len, o->ctx);
+  o->stats.bytes += o->len;
+  o->stats.chunks++;
+  o->len = 0;
+}
+
+// Makes room for `need` bytes; callers then write straight into buf
+static void out_reserve(out_t *o, size_t need) {
+  if (o->len + need > sizeof(o->buf))
+    out_flush(o);
+}
+
+static void out_str(out_t *o, const char *s) {
+  size_t n = strlen(s);
+  out_reserve(o, n);
+  memcpy(o->buf + o->len, s, n);
+  o->len += n;
+}
+
+static void out_fixed(out_t *o, int32_t v, uint8_t decimals) {
+  o->len += fixed_fmt(o->buf + o->len, sizeof(o->buf) - o->len, v, decimals);
+}
+
+static void out_u32(out_t *o, uint32_t v) {
+  o->len += fixed_fmt_u32(o->buf + o->len, sizeof(o->buf) - o->len, v);
+}
+
+static void out_char(out_t *o, char c) { o->buf[o->len++] = c; }
+
+static void put_header(out_t *o, track_export_format_t fmt) {
+  switch (fmt) {
+  case TRACK_EXPORT_GPX:
+    out_str(o, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<gpx version=\"1.1\" creator=\"esp32_GPS_oled\" "
+               "xmlns=\"http://www.topografix.com/GPX/1/1\">\n"
+               "<trk><trkseg>\n");
+    break;
+  case TRACK_EXPORT_GEOJSON:
+    out_str(o, "{\"type\":\"Feature\",\"properties\":{},"
+               "\"geometry\":{\"type\":\"LineString\",\"coordinates\":[");
+    break;
+  case TRACK_EXPORT_CSV:
+    out_str(o, "time,latitude,longitude,altitude,speed,course,satellites,"
+               "hdop\n");
+    break;
+  case TRACK_EXPORT_BIN:
+    break;
+  }
+}
+
+static void put_footer(out_t *o, track_export_format_t fmt) {
+  if (fmt == TRACK_EXPORT_GPX)
+    out_str(o, "</trkseg></trk>\n</gpx>\n");
+  else if (fmt == TRACK_EXPORT_GEOJSON)
+    out_str(o, "]}}\n");
+}
+
+static void put_record(out_t *o, track_export_format_t fmt,
+                       const sd_log_record_t *rec, bool first) {
+  out_reserve(o, MAX_ITEM);
+  switch (fmt) {
+  case TRACK_EXPORT_GPX:
+    out_str(o, "<trkpt lat=\"");
+    out_fixed(o, rec->lat_e7, 7);
+    out_str(o, "\" lon=\"");
+    out_fixed(o, rec->lon_e7, 7);
+    out_str(o, "\"><ele>");
+    out_fixed(o, rec->alt_cm, 2);
+    out_str(o, "</ele><time>");
+    o->len += fixed_fmt_iso8601(o->buf + o->len, sizeof(o->buf) - o->len,
+                                rec->time);
+    out_str(o, "</time><sat>");
+    out_u32(o, rec->satellites);
+    out_str(o, "</sat><hdop>");
+    out_fixed(o, rec->hdop_dec, 1);
+    out_str(o, "</hdop></trkpt>\n");
+    break;
+
+  case TRACK_EXPORT_GEOJSON:
+    if (!first)
+      out_char(o, ',');
+    out_char(o, '[');
+    out_fixed(o, rec->lon_e7, 7);
+    out_char(o, ',');
+    out_fixed(o, rec->lat_e7, 7);
+    out_char(o, ',');
+    out_fixed(o, rec->alt_cm, 2);
+    out_char(o, ']');
+    break;
+
+  case TRACK_EXPORT_CSV:
+    out_u32(o, rec->time);
+    out_char(o, ',');
+    out_fixed(o, rec->lat_e7, 7);
+    out_char(o, ',');
+    out_fixed(o, rec->lon_e7, 7);
+    out_char(o, ',');
+    out_fixed(o, rec->alt_cm, 2);
+    out_char(o, ',');
+    out_fixed(o, rec->speed_ckmh, 2);
+    out_char(o, ',');
+    out_fixed(o, rec->course_cdeg, 2);
+    out_char(o, ',');
+    out_u32(o, rec->satellites);
+    out_char(o, ',');
+    out_fixed(o, rec->hdop_dec, 1);
+    out_char(o, '\n');
+    break;
+
+  case TRACK_EXPORT_BIN:
+    memcpy(o->buf + o->len, rec, sizeof(*rec));
+    o->len += sizeof(*rec);
+    break;
+  }
+}
+
+esp_err_t track_export_stream(track_export_format_t fmt, uint32_t from,
+                              uint32_t to, track_export_sink_t sink,
+                              void *ctx, track_export_stats_t *stats) {
+  // Cursor (4 KiB block) and chunk are too big for the httpd task stack
+  sd_log_cursor_t *cur = malloc(sizeof(*cur));
+  if (!cur)
+    return ESP_ERR_NO_MEM;
+
+  out_t *o = malloc(sizeof(*o));
+  if (!o) {
+    free(cur);
+    return ESP_ERR_NO_MEM;
+  }
+  o->len = 0;
+  o->sink = sink;
+  o->ctx = ctx;
+  o->err = ESP_OK;
+  o->stats = (track_export_stats_t){0};
+
+  put_header(o, fmt);
+  if (sd_log_cursor_open(cur, from, to) == ESP_OK) {
+    sd_log_record_t rec;
+    bool first = true;
+    while (o->err == ESP_OK && sd_log_cursor_next(cur, &rec)) {
+      put_record(o, fmt, &rec, first);
+      first = false;
+      o->stats.records++;
+    }
+    sd_log_cursor_close(cur);
+  }
+  put_footer(o, fmt);
+  out_flush(o);
+
+  esp_err_t ret = o->err;
+  if (ret != ESP_OK)
+    ESP_LOGW(TAG, "Export aborted after %lu records",
+             (unsigned long)o->stats.records);
+  if (stats)
+    *stats = o->stats;
+  free(o);
+  free(cur);
+  return ret;
+}
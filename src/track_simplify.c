@@ -0,0 +1,116 @@
+#include "track_simplify.h"
+#include "geo.h"
+#include <stdlib.h>
+
+// Offsets from the anchor beyond this (~3000 km) always cut the window, so
+// the 64-bit products below cannot overflow
+#define SIMPLIFY_MAX_OFFSET (1 << 28)
+#define SIMPLIFY_MAX_TOL_M 10000
+
+static void set_anchor(track_simplifier_t *s, const sd_log_record_t *fix) {
+  s->anchor = *fix;
+  s->have_anchor = true;
+  s->cos_q16 = geo_cos_q16(fix->lat_e7);
+}
+
+// Local plane around the anchor, 1e-7 degree of latitude per unit
+static bool project(const track_simplifier_t *s, const sd_log_record_t *fix,
+                    int64_t *x, int64_t *y) {
+  *x = ((int64_t)fix->lon_e7 - s->anchor.lon_e7) * s->cos_q16 >> 16;
+  *y = (int64_t)fix->lat_e7 - s->anchor.lat_e7;
+  return llabs(*x) < SIMPLIFY_MAX_OFFSET && llabs(*y) < SIMPLIFY_MAX_OFFSET;
+}
+
+// Distance from p to the segment anchor-b within the tolerance. Squared
+// distances cannot be compared against the segment length without
+// overflowing, so the perpendicular case uses |cross| <= tol * |b|, with
+// |b| rounded down (never accepts more than the tolerance).
+static bool within(const track_simplifier_t *s, int64_t bx, int64_t by,
+                   int64_t px, int64_t py) {
+  int64_t tol2 = (int64_t)s->tol * s->tol;
+  int64_t len2 = bx * bx + by * by;
+  int64_t dot = px * bx + py * by;
+  if (len2 == 0 || dot <= 0)
+    return px * px + py * py <= tol2;
+  if (dot >= len2) {
+    int64_t dx = px - bx, dy = py - by;
+    return dx * dx + dy * dy <= tol2;
+  }
+  int64_t cross = llabs(bx * py - by * px);
+  return cross <= (int64_t)s->tol * geo_isqrt64((uint64_t)len2);
+}
+
+static bool window_fits(const track_simplifier_t *s,
+                        const sd_log_record_t *fix) {
+  int64_t bx, by, px, py;
+  if (!project(s, fix, &bx, &by))
+    return false;
+  for (uint8_t i = 0; i < s->count; i++) {
+    if (!project(s, &s->window[i], &px, &py) ||
+        !within(s, bx, by, px, py))
+      return false;
+  }
+  return true;
+}
+
+void track_simplify_init(track_simplifier_t *s, uint32_t tol_m,
+                         uint32_t keepalive_s) {
+  if (tol_m > SIMPLIFY_MAX_TOL_M)
+    tol_m = SIMPLIFY_MAX_TOL_M;
+  *s = (track_simplifier_t){
+      .tol = (uint32_t)((uint64_t)tol_m * 10000000u / GEO_CM_PER_E7_X100000),
+      .keepalive_s = keepalive_s,
+  };
+}
+
+bool track_simplify_push(track_simplifier_t *s, const sd_log_record_t *fix,
+                         sd_log_record_t *out) {
+  if (!s->have_anchor) {
+    set_anchor(s, fix);
+    s->stats.in++;
+    s->stats.out++;
+    *out = *fix;
+    return true;
+  }
+
+  const sd_log_record_t *last =
+      s->count ? &s->window[s->count - 1] : &s->anchor;
+  if (fix->time <= last->time)
+    return false;
+  s->stats.in++;
+
+  bool cut = false;
+  if (s->count == TRACK_SIMPLIFY_WINDOW) {
+    cut = true;
+    s->stats.window_cuts++;
+  } else if (s->count && !window_fits(s, fix)) {
+    cut = true;
+  } else if (s->count && fix->time - s->anchor.time >= s->keepalive_s) {
+    cut = true;
+    s->stats.keepalives++;
+  }
+
+  if (cut) {
+    // The previous fix closes a segment already known to fit
+    *out = *last;
+    set_anchor(s, last);
+    s->count = 0;
+    s->stats.out++;
+  }
+  s->window[s->count++] = *fix;
+  return cut;
+}
+
+bool track_simplify_flush(track_simplifier_t *s, sd_log_record_t *out) {
+  if (!s->count)
+    return false;
+  *out = s->window[s->count - 1];
+  set_anchor(s, out);
+  s->count = 0;
+  s->stats.out++;
+  return true;
+}
+
+uint32_t track_simplify_ratio_x100(const track_simplify_stats_t *stats) {
+  return stats->out ? (uint32_t)((uint64_t)stats->in * 100 / stats->out) : 0;
+}
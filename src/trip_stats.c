@@ -0,0 +1,210 @@
+#include "trip_stats.h"
+#include "esp_log.h"
+#include "fixed_fmt.h"
+#include "geo.h"
+#include "nvs.h"
+#include "seqlock.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "TRIP";
+
+#define TRIP_STATS_VERSION 1
+
+// NVS image; the version guards against layout changes
+typedef struct {
+  uint32_t version;
+  uint64_t odometer_cm;
+  trip_t trip;
+} trip_saved_t;
+
+// Writer (ingest task) state
+static trip_stats_t cur;
+static bool have_prev;
+static uint32_t prev_time;
+static int32_t leg_lat, leg_lon; // last counted point
+static uint32_t leg_time;
+static uint32_t stopped_since;
+static bool reset_pending;
+
+// Published state, see seqlock.h
+static trip_stats_t state;
+static uint32_t state_seq;
+
+// Service side: what NVS holds
+static trip_saved_t saved;
+static bool save_now;
+
+static void publish(void) {
+  seqlock_write(&state_seq, &state, &cur, sizeof(state));
+}
+
+static void new_trip(uint32_t time) {
+  cur.trip = (trip_t){.start = time, .last = time};
+  __atomic_store_n(&save_now, true, __ATOMIC_RELEASE);
+}
+
+esp_err_t trip_stats_init(void) {
+  nvs_handle_t h;
+  esp_err_t ret = nvs_open(TRIP_STATS_NVS_NAMESPACE, NVS_READONLY, &h);
+  if (ret == ESP_OK) {
+    trip_saved_t s;
+    size_t len = sizeof(s);
+    ret = nvs_get_blob(h, TRIP_STATS_NVS_KEY, &s, &len);
+    nvs_close(h);
+    if (ret == ESP_OK && (len != sizeof(s) || s.version != TRIP_STATS_VERSION))
+      ret = ESP_ERR_INVALID_VERSION;
+    if (ret == ESP_OK) {
+      saved = s;
+      cur.odometer_cm = s.odometer_cm;
+      cur.trip = s.trip;
+    }
+  }
+  // A boot counts as stopped since the last saved fix, so the first
+  // movement after a long rest starts a new trip
+  stopped_since = cur.trip.last;
+  publish();
+  ESP_LOGI(TAG, "Odometer %lu m, trip %lu m: %s",
+           (unsigned long)(cur.odometer_cm / 100),
+           (unsigned long)(cur.trip.distance_cm / 100), esp_err_to_name(ret));
+  return ret == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : ret;
+}
+
+void trip_stats_update(uint32_t time, int32_t lat_e7, int32_t lon_e7,
+                       uint32_t speed_ckmh) {
+  if (have_prev && time <= prev_time)
+    return;
+  if (__atomic_exchange_n(&reset_pending, false, __ATOMIC_ACQ_REL))
+    new_trip(have_prev ? prev_time : time);
+  if (!cur.trip.start)
+    new_trip(time);
+
+  bool was_moving = cur.moving;
+  if (cur.moving ? speed_ckmh < TRIP_STATS_STOP_CKMH
+                 : speed_ckmh >= TRIP_STATS_START_CKMH)
+    cur.moving = !cur.moving;
+
+  if (cur.moving && !was_moving) {
+    // The new trip starts where the boat was lying
+    if (TRIP_STATS_SPLIT_S && stopped_since &&
+        time - stopped_since >= TRIP_STATS_SPLIT_S)
+      new_trip(have_prev ? prev_time : time);
+  } else if (!cur.moving && (was_moving || !stopped_since)) {
+    stopped_since = time;
+    __atomic_store_n(&save_now, true, __ATOMIC_RELEASE);
+  }
+
+  if (have_prev) {
+    uint32_t dt = time - prev_time;
+    if (dt <= TRIP_STATS_MAX_GAP_S) {
+      if (cur.moving || was_moving)
+        cur.trip.moving_s += dt;
+      else
+        cur.trip.stopped_s += dt;
+    }
+  }
+
+  // A leg is closed when it is long enough or the boat stops; at rest the
+  // counted point follows the fix. cm/s x 3.6 = 0.01 km/h.
+  if (have_prev && (cur.moving || was_moving)) {
+    uint32_t d = geo_distance_cm(leg_lat, leg_lon, lat_e7, lon_e7);
+    if (d >= TRIP_STATS_MIN_LEG_M * 100 || !cur.moving) {
+      if ((uint64_t)d * 36 <=
+          (uint64_t)TRIP_STATS_MAX_CKMH * 10 * (time - leg_time)) {
+        cur.trip.distance_cm += d;
+        cur.odometer_cm += d;
+      }
+      leg_lat = lat_e7;
+      leg_lon = lon_e7;
+      leg_time = time;
+    }
+  } else {
+    leg_lat = lat_e7;
+    leg_lon = lon_e7;
+    leg_time = time;
+  }
+
+  if (cur.moving) {
+    if (speed_ckmh > cur.trip.max_speed_ckmh)
+      cur.trip.max_speed_ckmh = speed_ckmh;
+    if (!cur.trip.min_speed_ckmh || speed_ckmh < cur.trip.min_speed_ckmh)
+      cur.trip.min_speed_ckmh = speed_ckmh;
+  }
+  cur.trip.last = time;
+  cur.fixes++;
+  have_prev = true;
+  prev_time = time;
+  publish();
+}
+
+void trip_stats_reset_trip(void) {
+  __atomic_store_n(&reset_pending, true, __ATOMIC_RELEASE);
+}
+
+uint32_t trip_stats_get(trip_stats_t *out) {
+  return seqlock_read(&state_seq, out, &state, sizeof(*out));
+}
+
+uint32_t trip_stats_avg_ckmh(const trip_t *trip) {
+  if (!trip->moving_s)
+    return 0;
+  return (uint32_t)((uint64_t)trip->distance_cm * 36 / 10 / trip->moving_s);
+}
+
+// Only distance or a new trip is worth a flash write; stopped time alone
+// waits for the next one
+void trip_stats_service(void) {
+  trip_stats_t s;
+  trip_stats_get(&s);
+  if (s.odometer_cm == saved.odometer_cm && s.trip.start == saved.trip.start)
+    return;
+  bool now = __atomic_exchange_n(&save_now, false, __ATOMIC_ACQ_REL);
+  if (!now && s.trip.last - saved.trip.last < TRIP_STATS_SAVE_S)
+    return;
+
+  trip_saved_t next = {
+      .version = TRIP_STATS_VERSION,
+      .odometer_cm = s.odometer_cm,
+      .trip = s.trip,
+  };
+  nvs_handle_t h;
+  esp_err_t ret = nvs_open(TRIP_STATS_NVS_NAMESPACE, NVS_READWRITE, &h);
+  if (ret == ESP_OK) {
+    ret = nvs_set_blob(h, TRIP_STATS_NVS_KEY, &next, sizeof(next));
+    if (ret == ESP_OK)
+      ret = nvs_commit(h);
+    nvs_close(h);
+  }
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "Save failed: %s", esp_err_to_name(ret));
+    return;
+  }
+  saved = next;
+}
+
+// Metres as km with 3 decimals; fixed_fmt takes int32
+static void fmt_km(char *buf, size_t size, uint64_t cm) {
+  uint64_t m = cm / 100;
+  fixed_fmt(buf, size, m > INT32_MAX ? INT32_MAX : (int32_t)m, 3);
+}
+
+size_t trip_stats_json(const trip_stats_t *s, char *buf, size_t size) {
+  const trip_t *t = &s->trip;
+  char odo[FIXED_FMT_MAX], dist[FIXED_FMT_MAX];
+  char max[FIXED_FMT_MAX], min[FIXED_FMT_MAX], avg[FIXED_FMT_MAX];
+  fmt_km(odo, sizeof(odo), s->odometer_cm);
+  fmt_km(dist, sizeof(dist), t->distance_cm);
+  fixed_fmt(max, sizeof(max), (int32_t)t->max_speed_ckmh, 2);
+  fixed_fmt(min, sizeof(min), (int32_t)t->min_speed_ckmh, 2);
+  fixed_fmt(avg, sizeof(avg), (int32_t)trip_stats_avg_ckmh(t), 2);
+  int len = snprintf(buf, size,
+                     "{\"odometer\":%s,\"moving\":%s,\"trip\":{"
+                     "\"start\":%lu,\"last\":%lu,\"distance\":%s,"
+                     "\"moving_s\":%lu,\"stopped_s\":%lu,"
+                     "\"max_speed\":%s,\"min_speed\":%s,\"avg_speed\":%s}}",
+                     odo, s->moving ? "true" : "false",
+                     (unsigned long)t->start, (unsigned long)t->last, dist,
+                     (unsigned long)t->moving_s, (unsigned long)t->stopped_s,
+                     max, min, avg);
+  return len > 0 && (size_t)len < size ? (size_t)len : 0;
+}
@@ -0,0 +1,269 @@
+#include "ubx.h"
+#include <string.h>
+
+enum {
+  UBX_WAIT_SYNC_1 = 0,
+  UBX_WAIT_SYNC_2,
+  UBX_READ_CLASS,
+  UBX_READ_ID,
+  UBX_READ_LEN_LO,
+  UBX_READ_LEN_HI,
+  UBX_READ_PAYLOAD,
+  UBX_READ_CK_A,
+  UBX_READ_CK_B,
+};
+
+static inline void fletcher_add(uint8_t *ck_a, uint8_t *ck_b, uint8_t c) {
+  *ck_a += c;
+  *ck_b += *ck_a;
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static inline int32_t get_i32(const uint8_t *p) { return (int32_t)get_u32(p); }
+
+static inline void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+}
+
+void ubx_decoder_init(ubx_decoder_t *dec) {
+  memset(dec, 0, sizeof(*dec));
+  dec->state = UBX_WAIT_SYNC_1;
+}
+
+void ubx_decoder_feed(ubx_decoder_t *dec, const uint8_t *data, size_t len,
+                      ubx_frame_cb_t cb, void *ctx) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t c = data[i];
+
+    switch (dec->state) {
+    case UBX_WAIT_SYNC_1:
+      if (c == UBX_SYNC_1)
+        dec->state = UBX_WAIT_SYNC_2;
+      break;
+
+    case UBX_WAIT_SYNC_2:
+      if (c == UBX_SYNC_2) {
+        dec->ck_a = 0;
+        dec->ck_b = 0;
+        dec->state = UBX_READ_CLASS;
+      } else if (c != UBX_SYNC_1) {
+        dec->state = UBX_WAIT_SYNC_1;
+      }
+      break;
+
+    case UBX_READ_CLASS:
+      dec->msg_class = c;
+      fletcher_add(&dec->ck_a, &dec->ck_b, c);
+      dec->state = UBX_READ_ID;
+      break;
+
+    case UBX_READ_ID:
+      dec->msg_id = c;
+      fletcher_add(&dec->ck_a, &dec->ck_b, c);
+      dec->state = UBX_READ_LEN_LO;
+      break;
+
+    case UBX_READ_LEN_LO:
+      dec->len = c;
+      fletcher_add(&dec->ck_a, &dec->ck_b, c);
+      dec->state = UBX_READ_LEN_HI;
+      break;
+
+    case UBX_READ_LEN_HI:
+      dec->len |= (uint16_t)c << 8;
+      fletcher_add(&dec->ck_a, &dec->ck_b, c);
+      dec->pos = 0;
+      dec->state = dec->len ? UBX_READ_PAYLOAD : UBX_READ_CK_A;
+      break;
+
+    case UBX_READ_PAYLOAD:
+      if (dec->pos < UBX_MAX_PAYLOAD)
+        dec->payload[dec->pos] = c;
+      fletcher_add(&dec->ck_a, &dec->ck_b, c);
+      if (++dec->pos == dec->len)
+        dec->state = UBX_READ_CK_A;
+      break;
+
+    case UBX_READ_CK_A:
+      if (c == dec->ck_a) {
+        dec->state = UBX_READ_CK_B;
+      } else {
+        dec->stats.bad_checksum++;
+        dec->state = UBX_WAIT_SYNC_1;
+      }
+      break;
+
+    case UBX_READ_CK_B:
+      dec->state = UBX_WAIT_SYNC_1;
+      if (c != dec->ck_b) {
+        dec->stats.bad_checksum++;
+      } else if (dec->len > UBX_MAX_PAYLOAD) {
+        dec->stats.skipped++;
+      } else {
+        dec->stats.good++;
+        if (cb)
+          cb(dec->msg_class, dec->msg_id, dec->payload, dec->len, ctx);
+      }
+      break;
+    }
+  }
+}
+
+size_t ubx_build_frame(uint8_t msg_class, uint8_t msg_id,
+                       const uint8_t *payload, uint16_t len, uint8_t *out,
+                       size_t out_size) {
+  size_t total = (size_t)len + UBX_FRAME_OVERHEAD;
+  if (out_size < total)
+    return 0;
+
+  out[0] = UBX_SYNC_1;
+  out[1] = UBX_SYNC_2;
+  out[2] = msg_class;
+  out[3] = msg_id;
+  put_u16(&out[4], len);
+  if (len)
+    memcpy(&out[6], payload, len);
+
+  uint8_t ck_a = 0, ck_b = 0;
+  for (size_t i = 2; i < 6 + (size_t)len; i++)
+    fletcher_add(&ck_a, &ck_b, out[i]);
+  out[6 + len] = ck_a;
+  out[7 + len] = ck_b;
+  return total;
+}
+
+size_t ubx_build_config(uint32_t baud, uint8_t rate_hz, uint8_t *out,
+                        size_t out_size) {
+  if (rate_hz == 0)
+    rate_hz = 1;
+
+  size_t n = 0, w;
+
+  // CFG-RATE: measurement period in ms, one solution per measurement, GPS time
+  uint8_t rate[6];
+  put_u16(&rate[0], (uint16_t)(1000 / rate_hz));
+  put_u16(&rate[2], 1);
+  put_u16(&rate[4], 1);
+  w = ubx_build_frame(UBX_CLASS_CFG, UBX_ID_CFG_RATE, rate, sizeof(rate),
+                      out + n, out_size - n);
+  if (!w)
+    return 0;
+  n += w;
+
+  // CFG-MSG (short form applies to the port we are talking on)
+  const uint8_t msgs[][3] = {
+      {UBX_CLASS_NAV, UBX_ID_NAV_PVT, 1},
+      {UBX_CLASS_NAV, UBX_ID_NAV_DOP, 1},
+  };
+  for (size_t i = 0; i < sizeof(msgs) / sizeof(msgs[0]); i++) {
+    w = ubx_build_frame(UBX_CLASS_CFG, UBX_ID_CFG_MSG, msgs[i], 3, out + n,
+                        out_size - n);
+    if (!w)
+      return 0;
+    n += w;
+  }
+
+  // CFG-PRT: UART1, 8N1, UBX+NMEA in, UBX out
+  uint8_t prt[20] = {0};
+  prt[0] = 1;
+  put_u32(&prt[4], 0x000008D0);
+  put_u32(&prt[8], baud);
+  put_u16(&prt[12], 0x0003);
+  put_u16(&prt[14], 0x0001);
+  w = ubx_build_frame(UBX_CLASS_CFG, UBX_ID_CFG_PRT, prt, sizeof(prt),
+                      out + n, out_size - n);
+  if (!w)
+    return 0;
+  return n + w;
+}
+
+// "aabbcc" from three values below 100, as the NMEA fields read; cheaper
+// than snprintf() at 10 epochs a second
+static void put_six_digits(char *dst, uint8_t a, uint8_t b, uint8_t c) {
+  const uint8_t v[3] = {a, b, c};
+  for (int i = 0; i < 3; i++) {
+    dst[2 * i] = (char)('0' + v[i] / 10);
+    dst[2 * i + 1] = (char)('0' + v[i] % 10);
+  }
+  dst[6] = '\0';
+}
+
+static void apply_nav_pvt(const uint8_t *p, gps_data_t *gps) {
+  uint8_t valid_flags = p[11];
+  uint8_t fix_type = p[20];
+  bool fix_ok = (p[21] & 0x01) != 0;
+
+  if (valid_flags & 0x02) {
+    put_six_digits(gps->timestamp, p[8] % 100u, p[9] % 100u, p[10] % 100u);
+    // nano is signed around the second; epochs sit on whole milliseconds
+    int32_t ms = (get_i32(&p[16]) + 500000) / 1000000;
+    gps->time_ms = ms < 0 ? 0 : ms > 999 ? 999 : (uint16_t)ms;
+  }
+  if (valid_flags & 0x01) {
+    put_six_digits(gps->date, p[7] % 100u, p[6] % 100u,
+                   get_u16(&p[4]) % 100u);
+  }
+
+  // 2=2D, 3=3D, 4=GNSS+dead reckoning; 0/1/5 carry no usable position
+  gps->valid = fix_ok && fix_type >= 2 && fix_type <= 4;
+  if (fix_type == 2)
+    gps->fix_type = GPS_FIX_2D;
+  else if (fix_type == 3 || fix_type == 4)
+    gps->fix_type = GPS_FIX_3D;
+  else
+    gps->fix_type = GPS_FIX_NONE;
+  gps->satellites = p[23];
+
+  if (gps->valid) {
+    gps->lon_e7 = get_i32(&p[24]);
+    gps->lat_e7 = get_i32(&p[28]);
+    gps->alt_cm = get_i32(&p[36]) / 10; // hMSL, mm
+    // gSpeed mm/s to 0.01 km/h (x0.36), headMot 1e-5 degree
+    int32_t speed = get_i32(&p[60]);
+    gps->speed_ckmh =
+        speed <= 0 ? 0 : (uint32_t)(((uint64_t)speed * 36 + 50) / 100);
+    int32_t head = get_i32(&p[64]) / 1000 % 36000;
+    gps->course_cdeg = (uint16_t)(head < 0 ? head + 36000 : head);
+  }
+  gps->pdop_e2 = get_u16(&p[76]);
+  // Each NAV-PVT is a whole epoch: position, velocity and time together
+  gps->epoch++;
+}
+
+static void apply_nav_dop(const uint8_t *p, gps_data_t *gps) {
+  gps->pdop_e2 = get_u16(&p[6]);
+  gps->vdop_e2 = get_u16(&p[10]);
+  gps->hdop_e2 = get_u16(&p[12]);
+}
+
+bool ubx_apply_frame(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload,
+                     uint16_t len, gps_data_t *gps) {
+  if (msg_class != UBX_CLASS_NAV)
+    return false;
+
+  if (msg_id == UBX_ID_NAV_PVT && len >= UBX_NAV_PVT_LEN) {
+    apply_nav_pvt(payload, gps);
+    return true;
+  }
+  if (msg_id == UBX_ID_NAV_DOP && len >= UBX_NAV_DOP_LEN) {
+    apply_nav_dop(payload, gps);
+    return true;
+  }
+  return false;
+}
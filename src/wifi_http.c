@@ -4,147 +4,665 @@
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_wifi.h"
+#include "esp_timer.h"
+#include "fixed_fmt.h"
+#include "gps_filter.h"
 #include "gps_parser.h"
+#include "map_index.h"
+#include "map_render.h"
+#include "nmea.h"
 #include "nvs_flash.h"
+#include "track.h"
+#include "track_export.h"
+#include "trip_stats.h"
+#include "web_assets.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 static const char *TAG = "WIFIHTTP";
 
-static esp_err_t root_get_handler(httpd_req_t *req) {
-  const char *html =
-      "<!DOCTYPE html>"
-      "<html><head>"
-      "<meta charset='UTF-8'>"
-      "<meta name='viewport' content='width=device-width, initial-scale=1.0'>"
-      "<title>OLEDGPS Tracker</title>"
-      "<link rel='stylesheet' "
-      "href='https://unpkg.com/leaflet@1.9.4/dist/leaflet.css'/>"
-      "<style>"
-      "body { font-family: Arial, sans-serif; margin: 0; padding: 20px; }"
-      "#map { height: 400px; width: 100%; border: 1px solid #ccc; }"
-      ".info { background: #f0f0f0; padding: 10px; margin: 10px 0; "
-      "border-radius: 5px; }"
-      ".status { font-weight: bold; }"
-      ".online { color: green; }"
-      ".offline { color: red; }"
-      "</style>"
-      "</head><body>"
-      "<h1>🛰️ OLEDGPS Tracker</h1>"
-      "<div class='info'>"
-      "<div>Status: <span id='status' class='status'>Carregando...</span></div>"
-      "<div>Satélites: <span id='satellites'>-</span></div>"
-      "<div>Velocidade: <span id='speed'>-</span> km/h</div>"
-      "<div>Altitude: <span id='altitude'>-</span> m</div>"
-      "<div>Última atualização: <span id='lastUpdate'>-</span></div>"
-      "</div>"
-      "<div id='map'></div>"
-      "<script src='https://unpkg.com/leaflet@1.9.4/dist/leaflet.js'></script>"
-      "<script>"
-      "let map, marker, polyline, positions = [];"
-      "let lastLat = null, lastLon = null;"
-      ""
-      "function initMap() {"
-      "  map = L.map('map').setView([-23.5505, -46.6333], 13);"
-      "  L.tileLayer('https://{s}.tile.openstreetmap.org/{z}/{x}/{y}.png', {"
-      "    attribution: '© OpenStreetMap contributors'"
-      "  }).addTo(map);"
-      "  marker = L.marker([0, 0]).addTo(map);"
-      "  polyline = L.polyline([], {color: 'red'}).addTo(map);"
-      "}"
-      ""
-      "function updateGPS() {"
-      "  fetch('/api/gps')"
-      "    .then(response => response.json())"
-      "    .then(data => {"
-      "      document.getElementById('satellites').textContent = "
-      "data.satellites || 0;"
-      "      document.getElementById('speed').textContent = (data.speed || "
-      "0).toFixed(1);"
-      "      document.getElementById('altitude').textContent = (data.altitude "
-      "|| 0).toFixed(1);"
-      "      document.getElementById('lastUpdate').textContent = new "
-      "Date().toLocaleTimeString();"
-      "      "
-      "      if (data.valid && data.latitude && data.longitude) {"
-      "        document.getElementById('status').textContent = 'Conectado';"
-      "        document.getElementById('status').className = 'status online';"
-      "        "
-      "        let lat = parseFloat(data.latitude);"
-      "        let lon = parseFloat(data.longitude);"
-      "        "
-      "        if (lastLat !== lat || lastLon !== lon) {"
-      "          marker.setLatLng([lat, lon]);"
-      "          map.setView([lat, lon], 15);"
-      "          "
-      "          positions.push([lat, lon]);"
-      "          polyline.setLatLngs(positions);"
-      "          "
-      "          lastLat = lat;"
-      "          lastLon = lon;"
-      "        }"
-      "      } else {"
-      "        document.getElementById('status').textContent = 'Sem sinal GPS';"
-      "        document.getElementById('status').className = 'status offline';"
-      "      }"
-      "    })"
-      "    .catch(error => {"
-      "      document.getElementById('status').textContent = 'Erro de conexão';"
-      "      document.getElementById('status').className = 'status offline';"
-      "    });"
-      "}"
-      ""
-      "initMap();"
-      "setInterval(updateGPS, 2000);"
-      "updateGPS();"
-      "</script>"
-      "</body></html>";
-
-  httpd_resp_set_type(req, "text/html");
-  httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
-  return ESP_OK;
+// Where /leaflet/ goes when the build left Leaflet out (--no-leaflet)
+#define WEB_LEAFLET_CDN "https://unpkg.com/leaflet@1.9.4/dist/"
+
+static httpd_handle_t http_server;
+
+// Longest gps_json() output with its terminator: 146 bytes of keys,
+// punctuation and "false", six fixed_fmt() numbers, three uint8_t counts,
+// the timestamp and date strings and the filter object
+#define GPS_JSON_MAX                                                         \
+  (146 + 6 * (FIXED_FMT_MAX - 1) + 3 * 3 + 9 + 6 + GPS_FILTER_JSON_MAX)
+// "data: <json>\n\n", then as one chunk with its hex size line and CRLF
+#define STREAM_EVENT_MAX (GPS_JSON_MAX + 8)
+#define STREAM_FRAME_MAX (STREAM_EVENT_MAX + 8)
+
+// /api/stream subscribers; httpd task only, except the count
+typedef struct {
+  int fd; // -1 when free
+  uint16_t tail_len;
+  uint32_t stalled_since_ms; // 0 while the client keeps up
+  char tail[STREAM_FRAME_MAX]; // unsent end of the last frame
+} stream_client_t;
+
+static stream_client_t stream_clients[HTTP_STREAM_MAX_CLIENTS];
+static uint32_t stream_count;
+static bool stream_pending;
+static char stream_frame[STREAM_FRAME_MAX];
+static http_stream_stats_t stream_stats;
+
+// Assets exist only gzip-compressed; flash has no room for a plain copy.
+// No Accept-Encoding means any coding is fine (RFC 9110 12.5.3), so only a
+// header that lists neither gzip nor "*" is refused. A value too long for
+// the buffer is taken as accepting.
+static bool accepts_gzip(httpd_req_t *req) {
+  char enc[64];
+  esp_err_t err = httpd_req_get_hdr_value_str(req, "Accept-Encoding", enc,
+                                              sizeof(enc));
+  if (err != ESP_OK)
+    return true;
+  return strstr(enc, "gzip") || strchr(enc, '*');
+}
+
+// Embedded UI (src/web_assets.c, built by tools/build_web.py), Leaflet
+// included. Bodies are sent as stored; a matching If-None-Match gets a 304
+// without a body. /leaflet/ goes to unpkg only in a --no-leaflet build.
+static esp_err_t asset_handler(httpd_req_t *req) {
+  char path[64];
+  size_t n = strcspn(req->uri, "?");
+  if (n >= sizeof(path)) {
+    httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
+    return ESP_FAIL;
+  }
+  memcpy(path, req->uri, n);
+  path[n] = '\0';
+
+  const web_asset_t *asset = NULL;
+  for (uint32_t i = 0; i < web_asset_count && !asset; i++)
+    if (strcmp(web_assets[i].path, path) == 0)
+      asset = &web_assets[i];
+  if (!asset && strncmp(path, "/leaflet/", 9) == 0) {
+    char location[96];
+    snprintf(location, sizeof(location), "%s%s", WEB_LEAFLET_CDN, path + 9);
+    httpd_resp_set_status(req, "302 Found");
+    httpd_resp_set_hdr(req, "Location", location);
+    return httpd_resp_send(req, NULL, 0);
+  }
+  if (!asset) {
+    httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
+    return ESP_FAIL;
+  }
+
+  httpd_resp_set_hdr(req, "ETag", asset->etag);
+  httpd_resp_set_hdr(req, "Cache-Control", asset->cache_control);
+  // Also on the 304, so caches key the stored copy the same way
+  if (asset->gzip)
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+  char match[80];
+  if (httpd_req_get_hdr_value_str(req, "If-None-Match", match,
+                                  sizeof(match)) == ESP_OK &&
+      strstr(match, asset->etag)) {
+    httpd_resp_set_status(req, "304 Not Modified");
+    return httpd_resp_send(req, NULL, 0);
+  }
+  // Deliberate: there is no identity copy of the text files in flash, and
+  // every browser the page supports sends gzip
+  if (asset->gzip && !accepts_gzip(req)) {
+    httpd_resp_set_status(req, "406 Not Acceptable");
+    httpd_resp_set_type(req, "text/plain");
+    return httpd_resp_sendstr(req, "Only gzip content-coding is served");
+  }
+  httpd_resp_set_type(req, asset->mime);
+  if (asset->gzip)
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  return httpd_resp_send(req, (const char *)asset->data, asset->len);
+}
+
+// The /api/gps object
+static size_t gps_json(char *buf, size_t size) {
+  gps_data_t snapshot;
+  gps_get_snapshot(&snapshot);
+  const gps_data_t *gps = &snapshot;
+  char filtered[GPS_FILTER_JSON_MAX];
+  gps_filter_json(filtered, sizeof(filtered), esp_timer_get_time());
+  char lat[FIXED_FMT_MAX], lon[FIXED_FMT_MAX], alt[FIXED_FMT_MAX];
+  char speed[FIXED_FMT_MAX], course[FIXED_FMT_MAX], hdop[FIXED_FMT_MAX];
+  fixed_fmt(lat, sizeof(lat), gps->lat_e7, 7);
+  fixed_fmt(lon, sizeof(lon), gps->lon_e7, 7);
+  fixed_fmt(alt, sizeof(alt), gps->alt_cm, 2);
+  fixed_fmt(speed, sizeof(speed), (int32_t)gps->speed_ckmh, 2);
+  fixed_fmt(course, sizeof(course), gps->course_cdeg, 2);
+  fixed_fmt(hdop, sizeof(hdop), gps->hdop_e2, 2);
+
+  int len = snprintf(buf, size,
+                     "{"
+                     "\"valid\":%s,"
+                     "\"latitude\":%s,"
+                     "\"longitude\":%s,"
+                     "\"altitude\":%s,"
+                     "\"satellites\":%d,"
+                     "\"speed\":%s,"
+                     "\"course\":%s,"
+                     "\"timestamp\":\"%s\","
+                     "\"date\":\"%s\","
+                     "\"fix_type\":%d,"
+                     "\"hdop\":%s,"
+                     "\"sats_in_view\":%d"
+                     "%s}",
+                     gps->valid ? "true" : "false", lat, lon, alt,
+                     gps->satellites, speed, course, gps->timestamp,
+                     gps->date, gps->fix_type, hdop, gps->sats_in_view,
+                     filtered);
+  return len > 0 && (size_t)len < size ? (size_t)len : 0;
 }
 
 static esp_err_t gps_api_handler(httpd_req_t *req) {
-  gps_data_t *gps = gps_get_data();
-
-  char json_response[512];
-  snprintf(json_response, sizeof(json_response),
-           "{"
-           "\"valid\":%s,"
-           "\"latitude\":%.8f,"
-           "\"longitude\":%.8f,"
-           "\"altitude\":%.2f,"
-           "\"satellites\":%d,"
-           "\"speed\":%.2f,"
-           "\"course\":%.2f,"
-           "\"timestamp\":\"%s\","
-           "\"date\":\"%s\""
-           "}",
-           gps->valid ? "true" : "false", gps->latitude, gps->longitude,
-           gps->altitude, gps->satellites, gps->speed, gps->course,
-           gps->timestamp, gps->date);
+  char json_response[GPS_JSON_MAX];
+  size_t len = gps_json(json_response, sizeof(json_response));
 
   httpd_resp_set_type(req, "application/json");
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-  httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+  httpd_resp_send(req, json_response, len);
   return ESP_OK;
 }
 
+static uint32_t stream_now_ms(void) {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// "data: <json>\n\n"
+static size_t stream_event(char *buf, size_t size) {
+  if (size < 9)
+    return 0;
+  size_t json = gps_json(buf + 6, size - 8);
+  if (!json)
+    return 0;
+  memcpy(buf, "data: ", 6);
+  memcpy(buf + 6 + json, "\n\n", 2);
+  return json + 8;
+}
+
+// One event as one HTTP chunk: the stream is the chunked body of the
+// /api/stream response, so raw socket writes must keep the framing
+static size_t stream_build(char *buf, size_t size) {
+  char event[STREAM_EVENT_MAX];
+  size_t len = stream_event(event, sizeof(event));
+  int head = snprintf(buf, size, "%x\r\n", (unsigned)len);
+  if (!len || head <= 0 || (size_t)head + len + 2 > size)
+    return 0;
+  memcpy(buf + head, event, len);
+  memcpy(buf + head + len, "\r\n", 2);
+  return (size_t)head + len + 2;
+}
+
+static void stream_drop(stream_client_t *c, bool close_socket) {
+  if (close_socket)
+    httpd_sess_trigger_close(http_server, c->fd);
+  c->fd = -1;
+  c->tail_len = 0;
+  stream_stats.clients =
+      __atomic_sub_fetch(&stream_count, 1, __ATOMIC_RELEASE);
+}
+
+// Never waits on the socket; what the client cannot take now is kept in
+// its tail. False when the client was dropped.
+static bool stream_send(stream_client_t *c, const char *data, size_t len) {
+  int n = httpd_socket_send(http_server, c->fd, data, len, MSG_DONTWAIT);
+  if (n == HTTPD_SOCK_ERR_TIMEOUT)
+    n = 0;
+  if (n < 0) {
+    stream_stats.closed++;
+    stream_drop(c, true);
+    return false;
+  }
+  stream_stats.bytes += n;
+  c->tail_len = (uint16_t)(len - n);
+  memmove(c->tail, data + n, c->tail_len);
+  if (!c->tail_len) {
+    c->stalled_since_ms = 0;
+  } else if (!c->stalled_since_ms) {
+    c->stalled_since_ms = stream_now_ms() | 1;
+  } else if (stream_now_ms() - c->stalled_since_ms > HTTP_STREAM_STALL_MS) {
+    ESP_LOGW(TAG, "Stream client %d stalled, closing", c->fd);
+    stream_stats.closed++;
+    stream_drop(c, true);
+    return false;
+  }
+  return true;
+}
+
+// httpd task: one serialisation, then a non-blocking write per client. A
+// client still holding part of an older frame finishes that first and
+// skips this one.
+static void stream_fanout(void *arg) {
+  __atomic_store_n(&stream_pending, false, __ATOMIC_RELEASE);
+  int64_t t0 = esp_timer_get_time();
+  size_t len = stream_build(stream_frame, sizeof(stream_frame));
+  int64_t t1 = esp_timer_get_time();
+  if (!len) {
+    stream_stats.build_failed++;
+    return;
+  }
+
+  uint32_t sent_to = 0;
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS; i++) {
+    stream_client_t *c = &stream_clients[i];
+    if (c->fd < 0)
+      continue;
+    sent_to++;
+    if (c->tail_len) {
+      if (stream_send(c, c->tail, c->tail_len) && c->tail_len)
+        stream_stats.skipped++;
+      if (c->fd < 0 || c->tail_len)
+        continue;
+    }
+    stream_send(c, stream_frame, len);
+  }
+  uint32_t send_us = (uint32_t)(esp_timer_get_time() - t1);
+  stream_stats.events++;
+  stream_stats.build_us = (uint32_t)(t1 - t0);
+  if (sent_to)
+    stream_stats.per_client_us = send_us / sent_to;
+  if (send_us > stream_stats.max_send_us)
+    stream_stats.max_send_us = send_us;
+}
+
+void http_stream_notify(void) {
+  if (!http_server || !__atomic_load_n(&stream_count, __ATOMIC_ACQUIRE))
+    return;
+  if (__atomic_exchange_n(&stream_pending, true, __ATOMIC_ACQ_REL))
+    return;
+  if (httpd_queue_work(http_server, stream_fanout, NULL) != ESP_OK)
+    __atomic_store_n(&stream_pending, false, __ATOMIC_RELEASE);
+}
+
+void http_stream_get_stats(http_stream_stats_t *stats) {
+  *stats = stream_stats;
+}
+
+// GET /api/stream: text/event-stream of /api/gps objects. The handler sends
+// the headers and the current fix, then returns without ending the chunked
+// body, so httpd keeps the socket open for stream_fanout().
+static esp_err_t stream_handler(httpd_req_t *req) {
+  stream_client_t *c = NULL;
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS && !c; i++)
+    if (stream_clients[i].fd < 0)
+      c = &stream_clients[i];
+  if (!c) {
+    stream_stats.refused++;
+    httpd_resp_send_err(req, HTTPD_503_SERVICE_UNAVAILABLE,
+                        "Too many streams");
+    return ESP_FAIL;
+  }
+
+  httpd_resp_set_type(req, "text/event-stream");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  char first[STREAM_EVENT_MAX + 16];
+  int len = snprintf(first, sizeof(first), "retry: %d\n", HTTP_STREAM_RETRY_MS);
+  size_t event = stream_event(first + len, sizeof(first) - len);
+  if (!event)
+    stream_stats.build_failed++; // still subscribe; the next fix follows
+  len += (int)event;
+  if (httpd_resp_send_chunk(req, first, len) != ESP_OK)
+    return ESP_FAIL;
+
+  c->fd = httpd_req_to_sockfd(req);
+  c->tail_len = 0;
+  c->stalled_since_ms = 0;
+  stream_stats.opened++;
+  stream_stats.clients =
+      __atomic_add_fetch(&stream_count, 1, __ATOMIC_RELEASE);
+  ESP_LOGI(TAG, "Stream client %d, %lu subscribed", c->fd,
+           (unsigned long)stream_stats.clients);
+  return ESP_OK;
+}
+
+// httpd closes a session (client gone, or stream_drop()); with close_fn
+// set, closing the socket is ours
+static void session_closed(httpd_handle_t hd, int fd) {
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS; i++)
+    if (stream_clients[i].fd == fd)
+      stream_drop(&stream_clients[i], false);
+  close(fd);
+}
+
+static uint32_t query_u32(const char *query, const char *key,
+                          uint32_t fallback) {
+  char value[16];
+  if (!query ||
+      httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK)
+    return fallback;
+  return (uint32_t)strtoul(value, NULL, 10);
+}
+
+// Streams the in-RAM history as [[lat,lon],...] in fixed-size chunks
+static esp_err_t history_api_handler(httpd_req_t *req) {
+  char query[64];
+  const char *q = NULL;
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    q = query;
+  uint32_t from = query_u32(q, "from", 0);
+  uint32_t to = query_u32(q, "to", UINT32_MAX);
+
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+  track_cursor_t cur;
+  track_cursor_init(&cur, from, to);
+  char chunk[512];
+  size_t len = 0;
+  chunk[len++] = '[';
+
+  track_fix_t fix;
+  bool first = true;
+  while (track_cursor_next(&cur, &fix)) {
+    if (len > sizeof(chunk) - 48) {
+      if (httpd_resp_send_chunk(req, chunk, len) != ESP_OK)
+        return ESP_FAIL;
+      len = 0;
+    }
+    if (!first)
+      chunk[len++] = ',';
+    first = false;
+    chunk[len++] = '[';
+    len += fixed_fmt(chunk + len, sizeof(chunk) - len, fix.lat_e7, 7);
+    chunk[len++] = ',';
+    len += fixed_fmt(chunk + len, sizeof(chunk) - len, fix.lon_e7, 7);
+    chunk[len++] = ']';
+  }
+  chunk[len++] = ']';
+  httpd_resp_send_chunk(req, chunk, len);
+  return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t send_chunk(const char *data, size_t len, void *ctx) {
+  return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len);
+}
+
+// Streams logged fixes from the SD card:
+// /api/track?from=<unix>&to=<unix>&format=gpx|geojson|csv|bin
+static esp_err_t track_api_handler(httpd_req_t *req) {
+  char query[96];
+  const char *q = NULL;
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    q = query;
+  uint32_t from = query_u32(q, "from", 0);
+  uint32_t to = query_u32(q, "to", UINT32_MAX);
+
+  track_export_format_t fmt = TRACK_EXPORT_GPX;
+  char name[12];
+  if (q && httpd_query_key_value(q, "format", name, sizeof(name)) == ESP_OK &&
+      !track_export_parse_format(name, &fmt)) {
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown format");
+    return ESP_FAIL;
+  }
+
+  char disposition[48];
+  snprintf(disposition, sizeof(disposition),
+           "attachment; filename=\"track.%s\"", track_export_extension(fmt));
+  httpd_resp_set_type(req, track_export_mime(fmt));
+  httpd_resp_set_hdr(req, "Content-Disposition", disposition);
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+  track_export_stats_t stats;
+  esp_err_t ret = track_export_stream(fmt, from, to, send_chunk, req, &stats);
+  if (ret == ESP_ERR_NO_MEM) {
+    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No memory");
+    return ESP_FAIL;
+  }
+  if (ret != ESP_OK)
+    return ESP_FAIL; // client went away, httpd closes the socket
+  ESP_LOGI(TAG, "Track export: %lu records, %lu bytes",
+           (unsigned long)stats.records, (unsigned long)stats.bytes);
+  return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Degrees as text ("-22.8312") to 1e-7 degrees, reusing the NMEA parser
+static bool parse_deg_e7(const char *text, size_t len, int32_t *out) {
+  nmea_field_t f = {.ptr = text, .len = (uint8_t)len};
+  return len > 0 && len < 16 && nmea_parse_fixed(&f, 7, out);
+}
+
+static bool query_deg_e7(const char *query, const char *key, int32_t *out) {
+  char value[16];
+  return query &&
+         httpd_query_key_value(query, key, value, sizeof(value)) == ESP_OK &&
+         parse_deg_e7(value, strlen(value), out);
+}
+
+// JSON string body, truncated to 64 bytes on a UTF-8 boundary
+static size_t json_escape(char *out, size_t size, const char *s) {
+  size_t n = strnlen(s, 64), len = 0;
+  while (n > 0 && s[n] && ((uint8_t)s[n] & 0xC0) == 0x80)
+    n--;
+  for (size_t i = 0; i < n && len + 2 < size; i++) {
+    if (s[i] == '"' || s[i] == '\\')
+      out[len++] = '\\';
+    if ((uint8_t)s[i] >= 0x20)
+      out[len++] = s[i];
+  }
+  return len;
+}
+
+// One POI as a JSON object; dist_m < 0 leaves out distance and bearing
+static size_t poi_json(char *out, size_t size, const map_header_t *map,
+                       uint32_t id, int32_t dist_m, uint16_t bearing) {
+  const map_poi_t *poi = map_poi_get(map, id);
+  const char *name = map_poi_name(map, poi);
+  char esc[132], lat[FIXED_FMT_MAX], lon[FIXED_FMT_MAX];
+  int32_t lat_e7 = 0, lon_e7 = 0;
+  map_unproject(poi->x, poi->y, &lat_e7, &lon_e7);
+  fixed_fmt(lat, sizeof(lat), lat_e7, 7);
+  fixed_fmt(lon, sizeof(lon), lon_e7, 7);
+  esc[json_escape(esc, sizeof(esc), name ? name : "")] = '\0';
+
+  int n = snprintf(out, size,
+                   "{\"id\":%lu,\"kind\":\"%s\",\"name\":\"%s\",\"lat\":%s,"
+                   "\"lon\":%s",
+                   (unsigned long)id, map_poi_kind_name(poi->kind), esc, lat,
+                   lon);
+  if (n > 0 && (size_t)n < size && dist_m >= 0)
+    n += snprintf(out + n, size - n, ",\"dist\":%ld,\"bearing\":%u",
+                  (long)dist_m, bearing);
+  if (n <= 0 || (size_t)n + 1 >= size)
+    return 0;
+  out[n++] = '}';
+  return (size_t)n;
+}
+
+typedef struct {
+  httpd_req_t *req;
+  const map_header_t *map;
+  char buf[512];
+  size_t len;
+  uint32_t count;
+  uint32_t limit;
+  esp_err_t err;
+} poi_stream_t;
+
+static void poi_stream_put(poi_stream_t *st, uint32_t id, int32_t dist_m,
+                           uint16_t bearing) {
+  char obj[256];
+  size_t n = poi_json(obj, sizeof(obj), st->map, id, dist_m, bearing);
+  if (st->err != ESP_OK || n == 0)
+    return;
+  if (st->len + n + 1 > sizeof(st->buf)) {
+    st->err = httpd_resp_send_chunk(st->req, st->buf, st->len);
+    st->len = 0;
+  }
+  if (st->count++)
+    st->buf[st->len++] = ',';
+  memcpy(st->buf + st->len, obj, n);
+  st->len += n;
+}
+
+static bool poi_stream_cb(uint32_t id, const map_poi_t *poi, void *ctx) {
+  poi_stream_t *st = ctx;
+  poi_stream_put(st, id, -1, 0);
+  return st->err == ESP_OK && st->count < st->limit;
+}
+
+static uint16_t clamp_u16(int32_t v) {
+  return (uint16_t)(v < 0 ? 0 : (v > 0xFFFF ? 0xFFFF : v));
+}
+
+// Seamarks from the map's R-tree:
+//   /api/poi                          nearest marks to the last fix
+//   /api/poi?k=&kind=&lat=&lon=       k nearest of a kind to a point
+//   /api/poi?bbox=s,w,n,e&kind=&limit= marks inside a box
+static esp_err_t poi_api_handler(httpd_req_t *req) {
+  char query[128];
+  const char *q = NULL;
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    q = query;
+
+  poi_stream_t *st = calloc(1, sizeof(*st));
+  if (!st) {
+    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No memory");
+    return ESP_FAIL;
+  }
+  st->req = req;
+  st->map = map_get();
+  st->limit = query_u32(q, "limit", 100);
+
+  char value[64];
+  uint8_t mask = MAP_POI_KIND_ALL;
+  if (q && httpd_query_key_value(q, "kind", value, sizeof(value)) == ESP_OK)
+    mask = map_poi_kind_mask(value);
+  const char *error = !st->map ? "No map" : (!mask ? "Unknown kind" : NULL);
+
+  bool box = q && httpd_query_key_value(q, "bbox", value, sizeof(value)) ==
+                      ESP_OK;
+  int32_t corner[4]; // s, w, n, e
+  if (!error && box) {
+    nmea_field_t f[4];
+    if (nmea_split(value, f, 4) != 4)
+      error = "bbox=s,w,n,e";
+    for (int i = 0; !error && i < 4; i++)
+      if (!parse_deg_e7(f[i].ptr, f[i].len, &corner[i]))
+        error = "bbox=s,w,n,e";
+  }
+
+  map_nearby_t nearby;
+  int32_t lat_e7, lon_e7;
+  bool point =
+      query_deg_e7(q, "lat", &lat_e7) && query_deg_e7(q, "lon", &lon_e7);
+  // Without a point, k or kind the answer is the list kept for the last fix
+  bool cached = !point && mask == MAP_POI_KIND_ALL &&
+                !(q && httpd_query_key_value(q, "k", value, sizeof(value)) ==
+                           ESP_OK);
+  if (!error && !box && !point) {
+    if (map_nearby_get(&nearby) == 0) {
+      error = "No fix yet";
+    } else {
+      lat_e7 = nearby.lat_e7;
+      lon_e7 = nearby.lon_e7;
+    }
+  }
+  if (error) {
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);
+    free(st);
+    return ESP_FAIL;
+  }
+
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  if (box) {
+    int32_t x0, y0, x1, y1;
+    map_project(corner[0], corner[1], &x0, &y0);
+    map_project(corner[2], corner[3], &x1, &y1);
+    map_bbox_t b = {clamp_u16(x0), clamp_u16(y0), clamp_u16(x1),
+                    clamp_u16(y1)};
+    st->len = (size_t)snprintf(st->buf, sizeof(st->buf), "{\"pois\":[");
+    if (x1 >= 0 && y1 >= 0 && x0 <= 0xFFFF && y0 <= 0xFFFF && st->limit)
+      map_index_bbox(st->map, &b, mask, poi_stream_cb, st);
+  } else {
+    char lat[FIXED_FMT_MAX], lon[FIXED_FMT_MAX];
+    fixed_fmt(lat, sizeof(lat), lat_e7, 7);
+    fixed_fmt(lon, sizeof(lon), lon_e7, 7);
+    st->len = (size_t)snprintf(st->buf, sizeof(st->buf),
+                               "{\"lat\":%s,\"lon\":%s,\"pois\":[", lat,
+                               lon);
+    if (cached) {
+      for (uint8_t i = 0; i < nearby.count; i++)
+        poi_stream_put(st, nearby.hits[i].id, (int32_t)nearby.hits[i].dist_m,
+                       nearby.hits[i].bearing_deg);
+    } else {
+      map_poi_hit_t hits[MAP_POI_MAX_K];
+      int32_t x, y;
+      map_project(lat_e7, lon_e7, &x, &y);
+      uint8_t k = (uint8_t)query_u32(q, "k", MAP_NEARBY_K);
+      uint8_t n = map_index_nearest(st->map, x, y, mask, k, hits);
+      for (uint8_t i = 0; i < n; i++)
+        poi_stream_put(st, hits[i].id,
+                       (int32_t)map_index_dist_m(st->map, hits[i].dist2),
+                       map_poi_bearing(map_poi_get(st->map, hits[i].id), x, y));
+    }
+  }
+
+  esp_err_t ret = st->err;
+  if (ret == ESP_OK) {
+    st->buf[st->len++] = ']';
+    st->buf[st->len++] = '}';
+    ret = httpd_resp_send_chunk(req, st->buf, st->len);
+  }
+  free(st);
+  return ret == ESP_OK ? httpd_resp_send_chunk(req, NULL, 0) : ESP_FAIL;
+}
+
+static esp_err_t stats_api_handler(httpd_req_t *req) {
+  trip_stats_t st;
+  trip_stats_get(&st);
+  char json[256];
+  size_t len = trip_stats_json(&st, json, sizeof(json));
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return httpd_resp_send(req, json, len);
+}
+
+// POST /api/stats/reset starts a new trip on the next fix; the odometer
+// is never reset
+static esp_err_t stats_reset_handler(httpd_req_t *req) {
+  trip_stats_reset_trip();
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  httpd_resp_set_status(req, "202 Accepted");
+  return httpd_resp_send(req, NULL, 0);
+}
+
 esp_err_t http_server_start(void) {
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  // History streaming keeps a track block copy on the handler stack
+  config.stack_size = 6144;
+  config.max_uri_handlers = 12;
+  // Streams hold their sockets; this lets the table forget them
+  config.close_fn = session_closed;
+  // "/leaflet/*" for the embedded assets
+  config.uri_match_fn = httpd_uri_match_wildcard;
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS; i++)
+    stream_clients[i].fd = -1;
   httpd_handle_t server = NULL;
   esp_err_t ret = httpd_start(&server, &config);
   if (ret != ESP_OK)
     return ret;
+  http_server = server;
   httpd_uri_t root = {
       .uri = "/",
       .method = HTTP_GET,
-      .handler = root_get_handler,
+      .handler = asset_handler,
       .user_ctx = NULL,
   };
   httpd_register_uri_handler(server, &root);
 
+  httpd_uri_t leaflet = {
+      .uri = "/leaflet/*",
+      .method = HTTP_GET,
+      .handler = asset_handler,
+      .user_ctx = NULL,
+  };
+  httpd_register_uri_handler(server, &leaflet);
+
   httpd_uri_t gps_api = {
       .uri = "/api/gps",
       .method = HTTP_GET,
@@ -153,6 +671,54 @@ esp_err_t http_server_start(void) {
   };
   httpd_register_uri_handler(server, &gps_api);
 
+  httpd_uri_t stream = {
+      .uri = "/api/stream",
+      .method = HTTP_GET,
+      .handler = stream_handler,
+      .user_ctx = NULL,
+  };
+  httpd_register_uri_handler(server, &stream);
+
+  httpd_uri_t history_api = {
+      .uri = "/api/history",
+      .method = HTTP_GET,
+      .handler = history_api_handler,
+      .user_ctx = NULL,
+  };
+  httpd_register_uri_handler(server, &history_api);
+
+  httpd_uri_t track_api = {
+      .uri = "/api/track",
+      .method = HTTP_GET,
+      .handler = track_api_handler,
+      .user_ctx = NULL,
+  };
+  httpd_register_uri_handler(server, &track_api);
+
+  httpd_uri_t poi_api = {
+      .uri = "/api/poi",
+      .method = HTTP_GET,
+      .handler = poi_api_handler,
+      .user_ctx = NULL,
+  };
+  httpd_register_uri_handler(server, &poi_api);
+
+  httpd_uri_t stats_api = {
+      .uri = "/api/stats",
+      .method = HTTP_GET,
+      .handler = stats_api_handler,
+      .user_ctx = NULL,
+  };
+  httpd_register_uri_handler(server, &stats_api);
+
+  httpd_uri_t stats_reset = {
+      .uri = "/api/stats/reset",
+      .method = HTTP_POST,
+      .handler = stats_reset_handler,
+      .user_ctx = NULL,
+  };
+  httpd_register_uri_handler(server, &stats_reset);
+
   return ESP_OK;
 }
 
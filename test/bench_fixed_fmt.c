@@ -0,0 +1,115 @@
+// One fix's worth of text and geodesy, as /api/gps, the SD CSV line and
+// the track step need it, on the integer path (fixed_fmt, geo.c) and on
+// the double path it replaced (snprintf "%f", gmtime_r, haversine), over
+// the fixes of the 1 Hz capture. The host has an FPU; on the C3 every
+// double operation is a soft-float call, so the gap there is wider.
+// Usage: bench_fixed_fmt [passes]
+#include "fixed_fmt.h"
+#include "geo.h"
+#include "gps_parser.h"
+#include "test_util.h"
+#include <math.h>
+#include <time.h>
+
+#define MAX_FIXES 1000
+
+typedef struct {
+  int32_t lat, lon, alt_cm;
+  uint32_t speed_ckmh, time;
+  uint16_t course_cdeg, hdop_e2;
+} fix_t;
+
+static fix_t fixes[MAX_FIXES];
+
+static size_t int_path(const fix_t *f, const fix_t *prev, char *out,
+                       size_t size, uint32_t *dist_cm) {
+  char lat[FIXED_FMT_MAX], lon[FIXED_FMT_MAX], alt[FIXED_FMT_MAX];
+  char speed[FIXED_FMT_MAX], course[FIXED_FMT_MAX], hdop[FIXED_FMT_MAX];
+  char iso[FIXED_FMT_ISO8601_LEN];
+  fixed_fmt(lat, sizeof(lat), f->lat, 7);
+  fixed_fmt(lon, sizeof(lon), f->lon, 7);
+  fixed_fmt_round(alt, sizeof(alt), f->alt_cm, 2, 1);
+  fixed_fmt(speed, sizeof(speed), (int32_t)f->speed_ckmh, 2);
+  fixed_fmt_round(course, sizeof(course), f->course_cdeg, 2, 1);
+  fixed_fmt(hdop, sizeof(hdop), f->hdop_e2, 2);
+  fixed_fmt_iso8601(iso, sizeof(iso), f->time);
+  *dist_cm += geo_distance_cm(prev->lat, prev->lon, f->lat, f->lon);
+  return (size_t)snprintf(out, size, "%s,%s,%s,%s,%s,%s,%s", lat, lon, alt,
+                          speed, course, hdop, iso);
+}
+
+static double haversine_cm(double lat1, double lon1, double lat2,
+                           double lon2) {
+  double r = M_PI / 180, dlat = (lat2 - lat1) * r, dlon = (lon2 - lon1) * r;
+  double a = sin(dlat / 2) * sin(dlat / 2) +
+             cos(lat1 * r) * cos(lat2 * r) * sin(dlon / 2) * sin(dlon / 2);
+  return 2 * 637100000.0 * asin(sqrt(a));
+}
+
+static size_t double_path(const fix_t *f, const fix_t *prev, char *out,
+                          size_t size, double *dist_cm) {
+  double lat = f->lat / 1e7, lon = f->lon / 1e7;
+  time_t t = f->time;
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  *dist_cm += haversine_cm(prev->lat / 1e7, prev->lon / 1e7, lat, lon);
+  return (size_t)snprintf(out, size,
+                          "%.7f,%.7f,%.1f,%.2f,%.1f,%.2f,"
+                          "%04d-%02d-%02dT%02d:%02d:%02dZ",
+                          lat, lon, f->alt_cm / 100.0, f->speed_ckmh / 100.0,
+                          f->course_cdeg / 100.0, f->hdop_e2 / 100.0,
+                          tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                          tm.tm_hour, tm.tm_min, tm.tm_sec);
+}
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 50);
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines), count = 0;
+  gps_reset_data();
+  const gps_data_t *gps = gps_get_data();
+  for (size_t i = 0; i < n && count < MAX_FIXES; i++) {
+    gps_parse_nmea(lines[i]);
+    if (strncmp(lines[i] + 3, "GGA", 3) == 0 && gps->valid)
+      fixes[count++] = (fix_t){gps->lat_e7,      gps->lon_e7,
+                               gps->alt_cm,      gps->speed_ckmh,
+                               gps_unix_time(gps), gps->course_cdeg,
+                               gps->hdop_e2};
+  }
+  free(lines);
+  free(text);
+  CHECK(count > 100);
+
+  // Same text both ways, away from rounding ties
+  char a[160], b[160];
+  uint32_t dist_int = 0;
+  double dist_double = 0;
+  int same = 0;
+  for (size_t i = 1; i < count; i++) {
+    int_path(&fixes[i], &fixes[i - 1], a, sizeof(a), &dist_int);
+    double_path(&fixes[i], &fixes[i - 1], b, sizeof(b), &dist_double);
+    same += strcmp(a, b) == 0;
+  }
+  CHECK(same >= (int)(count - 1) * 9 / 10);
+  CHECK(fabs(dist_int - dist_double) < dist_double * 1e-4);
+
+  size_t bytes = 0;
+  int64_t t0 = host_now_ns();
+  for (int p = 0; p < passes; p++)
+    for (size_t i = 1; i < count; i++)
+      bytes += int_path(&fixes[i], &fixes[i - 1], a, sizeof(a), &dist_int);
+  double int_ns = (double)(host_now_ns() - t0) / passes / (count - 1);
+  t0 = host_now_ns();
+  for (int p = 0; p < passes; p++)
+    for (size_t i = 1; i < count; i++)
+      bytes += double_path(&fixes[i], &fixes[i - 1], b, sizeof(b),
+                           &dist_double);
+  double double_ns = (double)(host_now_ns() - t0) / passes / (count - 1);
+
+  printf("%zu fixes x %d, %zu/%zu lines identical: integer %.0f ns/fix, "
+         "double %.0f ns/fix (%.1fx)\n",
+         count - 1, passes, (size_t)same, count - 1, int_ns, double_ns,
+         double_ns / int_ns);
+  CHECK(bytes > 0);
+  return test_result("bench_fixed_fmt");
+}
@@ -0,0 +1,79 @@
+// geofence_update() cost at 100, 1000 and 2000 random fences over the
+// harbour, along the same kind of 10 Hz random walk as test_geofence: time
+// and fences tested exactly per fix through the grid, against testing every
+// fence on each fix.
+// Usage: bench_geofence [fixes]
+#include "fence_gen.h"
+#include "geofence.h"
+#include "test_util.h"
+#include <math.h>
+
+#define MAX_FENCES 2000
+
+static int32_t e7(double deg) { return (int32_t)lround(deg * 1e7); }
+
+int main(int argc, char **argv) {
+  int fixes = bench_iterations(argc, argv, 100000);
+  static const int sizes[] = {100, 1000, MAX_FENCES};
+  static gen_fence_t gen[MAX_FENCES];
+  static char text[MAX_FENCES * 320];
+  int32_t *lat = malloc(fixes * sizeof(*lat));
+  int32_t *lon = malloc(fixes * sizeof(*lon));
+  double ref_lat = (FENCE_GEN_LAT0 + FENCE_GEN_LAT1) / 2;
+
+  double la = ref_lat, lo = (FENCE_GEN_LON0 + FENCE_GEN_LON1) / 2;
+  double heading = 0.3, k = cos(ref_lat * M_PI / 180);
+  uint32_t lcg = 7;
+  for (int i = 0; i < fixes; i++) {
+    lcg = lcg * 1103515245u + 12345u;
+    heading += ((int)(lcg >> 20) % 200 - 100) / 1000.0;
+    double step = 0.1 + 0.5 * ((lcg >> 8) & 0xFF) / 255.0;
+    la += step * cos(heading) / 111320.0;
+    lo += step * sin(heading) / (111320.0 * k);
+    if (la < FENCE_GEN_LAT0 || la > FENCE_GEN_LAT1 || lo < FENCE_GEN_LON0 ||
+        lo > FENCE_GEN_LON1) {
+      heading += M_PI;
+      la = fmin(fmax(la, FENCE_GEN_LAT0), FENCE_GEN_LAT1);
+      lo = fmin(fmax(lo, FENCE_GEN_LON0), FENCE_GEN_LON1);
+    }
+    lat[i] = e7(la);
+    lon[i] = e7(lo);
+  }
+
+  printf("%-7s %8s %8s %10s %9s %8s\n", "fences", "avg us", "max us",
+         "tested/fix", "scan us", "events");
+  for (int s = 0; s < 3; s++) {
+    CHECK(fence_gen(1, sizes[s], gen, text, sizeof(text)) > 0);
+    CHECK_EQ(geofence_load_text(text), ESP_OK);
+    int64_t worst = 0, t0 = host_now_ns();
+    for (int i = 0; i < fixes; i++) {
+      int64_t t1 = host_now_ns();
+      geofence_update(lat[i], lon[i], (uint32_t)i);
+      int64_t dt = host_now_ns() - t1;
+      worst = dt > worst ? dt : worst;
+    }
+    double avg = (double)(host_now_ns() - t0) / fixes / 1000;
+    geofence_stats_t st;
+    geofence_get_stats(&st);
+    CHECK_EQ(st.fixes, fixes);
+
+    // Every fence on every fix, in doubles; a tenth of the fixes is enough
+    int scans = fixes / 10 + 1, inside = 0;
+    t0 = host_now_ns();
+    for (int i = 0; i < scans && i < fixes; i++) {
+      for (int f = 0; f < sizes[s]; f++) {
+        double d;
+        inside += fence_gen_contains(&gen[f], lat[i] / 1e7, lon[i] / 1e7,
+                                     ref_lat, &d);
+      }
+    }
+    double scan = (double)(host_now_ns() - t0) / scans / 1000;
+    CHECK(inside > 0);
+    printf("%-7d %8.2f %8.1f %10.1f %9.1f %8u\n", sizes[s], avg,
+           (double)worst / 1000, (double)st.candidates / st.fixes, scan,
+           st.events);
+  }
+  free(lat);
+  free(lon);
+  return test_result("bench_geofence");
+}
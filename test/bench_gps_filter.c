@@ -0,0 +1,63 @@
+// gps_filter_update() over the hour of filter_1h.csv at 10 Hz, then the
+// reader side the OLED and /api/gps use between fixes: a sequence-locked
+// copy plus dead reckoning, and the "filtered" JSON object.
+// Usage: bench_gps_filter [passes]
+#include "gps_filter.h"
+#include "test_util.h"
+
+#define ROWS 36000
+
+static gps_filter_meas_t meas[ROWS];
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 10);
+  char *text = fixture_load("filter_1h.csv", NULL), **lines;
+  size_t n = fixture_lines(text, &lines), count = 0;
+  for (size_t i = 1; i < n && count < ROWS; i++) {
+    long t, tl, tn, ts, la, lo, h, sp, co;
+    if (sscanf(lines[i], "%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld", &t, &tl, &tn,
+               &ts, &la, &lo, &h, &sp, &co) == 9)
+      meas[count++] = (gps_filter_meas_t){(int64_t)t * 1000, (int32_t)la,
+                                          (int32_t)lo, (uint16_t)h,
+                                          (uint32_t)sp, (uint16_t)co, true};
+  }
+  free(lines);
+  free(text);
+  CHECK_EQ(count, ROWS);
+
+  gps_filter_state_t st;
+  int64_t t0 = host_now_ns();
+  for (int p = 0; p < passes; p++) {
+    gps_filter_reset();
+    for (size_t i = 0; i < count; i++)
+      gps_filter_update(&meas[i], &st);
+  }
+  double update_ns = (double)(host_now_ns() - t0) / passes / count;
+
+  int32_t lat, lon, sum = 0;
+  int reads = passes * 100000;
+  t0 = host_now_ns();
+  for (int i = 0; i < reads; i++) {
+    gps_filter_get(&st);
+    gps_filter_position_at(&st, st.time_us + i % 1000 * 100, &lat, &lon);
+    sum += lat & 1;
+  }
+  double read_ns = (double)(host_now_ns() - t0) / reads;
+
+  char json[GPS_FILTER_JSON_MAX];
+  int jsons = passes * 10000;
+  t0 = host_now_ns();
+  for (int i = 0; i < jsons; i++)
+    gps_filter_json(json, sizeof(json), st.time_us + i % 1000 * 100);
+  double json_ns = (double)(host_now_ns() - t0) / jsons;
+
+  gps_filter_stats_t fs;
+  gps_filter_get_stats(&fs);
+  printf("%zu fixes x %d: update %.0f ns, get + dead reckoning %.0f ns, "
+         "JSON %.0f ns (%zu B)\n",
+         count, passes, update_ns, read_ns, json_ns, strlen(json));
+  printf("%u outliers, %u restarts\n", fs.outliers, fs.resets);
+  CHECK(fs.resets == (uint32_t)passes);
+  CHECK(json[0] && sum >= 0);
+  return test_result("bench_gps_filter");
+}
@@ -0,0 +1,81 @@
+// Per-sentence cost of gps_parse_nmea() by talker and formatter on the
+// multi-GNSS capture. Dispatch is one table scan on the formatter, so the
+// cost should follow sentence length, not type or talker; the ns/byte
+// column shows that. Usage: bench_gps_parser [passes]
+#include "gps_parser.h"
+#include "test_util.h"
+
+#define MAX_KINDS 16
+
+typedef struct {
+  char addr[6]; // talker + formatter
+  char **lines;
+  size_t count, bytes;
+} kind_t;
+
+static kind_t kinds[MAX_KINDS];
+static size_t kind_count;
+
+static kind_t *kind_of(const char *line) {
+  for (size_t i = 0; i < kind_count; i++)
+    if (memcmp(kinds[i].addr, line + 1, 5) == 0)
+      return &kinds[i];
+  if (kind_count == MAX_KINDS)
+    return NULL;
+  kind_t *k = &kinds[kind_count++];
+  memcpy(k->addr, line + 1, 5);
+  return k;
+}
+
+static double ns_per_sentence(char **lines, size_t n, int passes) {
+  int64_t t0 = host_now_ns();
+  for (int p = 0; p < passes; p++)
+    for (size_t i = 0; i < n; i++)
+      gps_parse_nmea(lines[i]);
+  return (double)(host_now_ns() - t0) / ((double)n * passes);
+}
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 200);
+  char *text = fixture_load("gnss_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines), bytes = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    kind_t *k = kind_of(lines[i]);
+    if (!k)
+      continue;
+    if (!k->lines)
+      k->lines = malloc(n * sizeof(*k->lines));
+    k->lines[k->count++] = lines[i];
+    k->bytes += strlen(lines[i]);
+    bytes += strlen(lines[i]);
+  }
+
+  ns_per_sentence(lines, n, 1); // warm up
+  double all = ns_per_sentence(lines, n, passes);
+  printf("gnss_1hz.nmea: %zu sentences, %d passes\n", n, passes);
+  printf("%-6s %6s %6s %10s %8s\n", "type", "count", "bytes", "ns/sent",
+         "ns/byte");
+  double min_nb = 1e9, max_nb = 0;
+  for (size_t i = 0; i < kind_count; i++) {
+    kind_t *k = &kinds[i];
+    double ns = ns_per_sentence(k->lines, k->count, passes);
+    double avg = (double)k->bytes / k->count;
+    printf("%-6.5s %6zu %6.1f %10.1f %8.2f\n", k->addr, k->count, avg, ns,
+           ns / avg);
+    if (ns / avg < min_nb)
+      min_nb = ns / avg;
+    if (ns / avg > max_nb)
+      max_nb = ns / avg;
+    free(k->lines);
+  }
+  printf("%-6s %6zu %6.1f %10.1f %8.2f\n", "all", n, (double)bytes / n, all,
+         all * n / bytes);
+  printf("%.0f sentences/s; ns/byte spread %.2f-%.2f across types\n",
+         1e9 / all, min_nb, max_nb);
+
+  CHECK(gps_get_data()->valid);
+  free(lines);
+  free(text);
+  return test_result("bench_gps_parser");
+}
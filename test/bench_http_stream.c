@@ -0,0 +1,83 @@
+// /api/stream fan-out cost on the httpd task, through the httpd stand-in's
+// loopback sockets: the time in stream_fanout() per fix with 1 to
+// HTTP_STREAM_MAX_CLIENTS subscribers, split into the one serialisation
+// and the send per client by a least-squares line. The readers drain
+// between fixes, outside the timing. Host sockets say little about lwIP;
+// the target logs its own split (build_us, per_client_us in
+// http_stream_get_stats()).
+// Usage: bench_http_stream [fixes per client count]
+#include "gps_parser.h"
+#include "http_standin.h"
+#include "test_util.h"
+#include "wifi_http.h"
+#include <sys/socket.h>
+#include <unistd.h>
+
+static void drain(int fd) {
+  char buf[4096];
+  while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0)
+    ;
+}
+
+int main(int argc, char **argv) {
+  int rounds = bench_iterations(argc, argv, 20000);
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines);
+  gps_reset_data();
+  for (size_t i = 0; i < n && i < 40; i++)
+    gps_parse_nmea(lines[i]);
+  gps_publish();
+  CHECK(gps_get_data()->valid);
+  CHECK_EQ(http_server_start(), ESP_OK);
+
+  int fds[HTTP_STREAM_MAX_CLIENTS];
+  double x[HTTP_STREAM_MAX_CLIENTS], y[HTTP_STREAM_MAX_CLIENTS];
+  uint32_t bytes = 0;
+  for (int k = 0; k < HTTP_STREAM_MAX_CLIENTS; k++) {
+    esp_err_t ret;
+    fds[k] = http_standin_request(HTTP_GET, "/api/stream", NULL, &ret);
+    CHECK(fds[k] >= 0 && ret == ESP_OK);
+    drain(fds[k]);
+
+    http_standin_stats_t before, after;
+    http_standin_get_stats(&before);
+    http_stream_stats_t st;
+    http_stream_get_stats(&st);
+    uint32_t bytes0 = st.bytes;
+    for (int r = 0; r < rounds; r++) {
+      http_stream_notify();
+      http_standin_run();
+      for (int c = 0; c <= k; c++)
+        drain(fds[c]);
+    }
+    http_standin_get_stats(&after);
+    http_stream_get_stats(&st);
+    CHECK_EQ(after.work - before.work, (uint32_t)rounds);
+    CHECK_EQ(st.skipped + st.closed + st.build_failed, 0);
+    bytes = (st.bytes - bytes0) / rounds / (k + 1);
+    x[k] = k + 1;
+    y[k] = (double)(after.work_ns - before.work_ns) / rounds / 1000;
+    printf("%d client%s: fan-out %6.2f us per fix\n", k + 1, k ? "s" : " ",
+           y[k]);
+  }
+
+  // y = build + per_client * clients
+  double sx = 0, sy = 0, sxx = 0, sxy = 0, m = HTTP_STREAM_MAX_CLIENTS;
+  for (int k = 0; k < HTTP_STREAM_MAX_CLIENTS; k++) {
+    sx += x[k];
+    sy += y[k];
+    sxx += x[k] * x[k];
+    sxy += x[k] * y[k];
+  }
+  double per_client = (m * sxy - sx * sy) / (m * sxx - sx * sx);
+  double build = (sy - per_client * sx) / m;
+  printf("serialisation %.2f us per fix, then %.2f us and %u bytes per "
+         "client\n",
+         build, per_client, (unsigned)bytes);
+
+  for (int k = 0; k < HTTP_STREAM_MAX_CLIENTS; k++)
+    close(fds[k]);
+  free(lines);
+  free(text);
+  return test_result("bench_http_stream");
+}
@@ -0,0 +1,256 @@
+// kNN (k = 4) and viewport bbox queries on the packed R-tree at 10k, 100k
+// and 1M marks, against a linear scan of the POI table. The blobs are built
+// here in the layout of tools/osm2tiles.py (Hilbert order, fanout 16), with
+// marks clustered like a regional extract; the first queries of each size
+// are checked against the scan.
+// Usage: bench_map_index [queries]
+#include "map_index.h"
+#include "map_render.h"
+#include "test_util.h"
+
+#define FANOUT 16
+#define UNIT_LOG2_CM 5 // 32 cm: 65535 units are ~21 km
+
+static uint32_t lcg = 29;
+
+static uint32_t rnd(uint32_t n) {
+  lcg = lcg * 1103515245u + 12345u;
+  return (lcg >> 8) % n;
+}
+
+static uint64_t hilbert(uint32_t x, uint32_t y) {
+  uint64_t d = 0;
+  for (uint32_t s = 1u << 15; s; s >>= 1) {
+    uint32_t rx = (x & s) ? 1 : 0, ry = (y & s) ? 1 : 0;
+    d += (uint64_t)s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx) {
+        x = 0xFFFF - x;
+        y = 0xFFFF - y;
+      }
+      uint32_t t = x;
+      x = y;
+      y = t;
+    }
+  }
+  return d;
+}
+
+typedef struct {
+  uint64_t key;
+  map_poi_t poi;
+} keyed_t;
+
+static int cmp_key(const void *a, const void *b) {
+  uint64_t x = ((const keyed_t *)a)->key, y = ((const keyed_t *)b)->key;
+  return x < y ? -1 : x > y;
+}
+
+static uint16_t clamp16(double v) {
+  return v < 0 ? 0 : v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+// Header, one empty tile, the POI table and the tree; no ways or names
+static uint8_t *build(uint32_t count, uint32_t *size) {
+  keyed_t *k = malloc(count * sizeof(*k));
+  uint16_t cx[64], cy[64];
+  for (int i = 0; i < 64; i++) {
+    cx[i] = (uint16_t)rnd(0x10000);
+    cy[i] = (uint16_t)rnd(0x10000);
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    map_poi_t *p = &k[i].poi;
+    if (rnd(5)) {
+      int c = (int)rnd(64);
+      // Roughly normal around a harbour, ~1 km
+      double dx = (double)rnd(6000) + rnd(6000) - 6000;
+      double dy = (double)rnd(6000) + rnd(6000) - 6000;
+      p->x = clamp16(cx[c] + dx);
+      p->y = clamp16(cy[c] + dy);
+    } else {
+      p->x = (uint16_t)rnd(0x10000);
+      p->y = (uint16_t)rnd(0x10000);
+    }
+    p->kind = (uint8_t)(1 + rnd(5));
+    memset(p->reserved, 0, sizeof(p->reserved));
+    p->name = MAP_NO_NAME;
+    k[i].key = hilbert(p->x, p->y);
+  }
+  qsort(k, count, sizeof(*k), cmp_key);
+
+  uint32_t level_size[MAP_RTREE_MAX_LEVELS + 1] = {count}, nodes = 0;
+  uint8_t levels = 0;
+  while (levels == 0 || level_size[levels] > 1) {
+    level_size[levels + 1] = (level_size[levels] + FANOUT - 1) / FANOUT;
+    nodes += level_size[++levels];
+  }
+
+  uint32_t tiles_off = sizeof(map_header_t);
+  uint32_t poi_off = tiles_off + sizeof(map_tile_t);
+  uint32_t rtree_off = poi_off + count * sizeof(map_poi_t);
+  uint32_t names_off =
+      (rtree_off + nodes * (sizeof(map_bbox_t) + 1) + 3) & ~3u;
+  uint8_t *blob = calloc(1, names_off);
+  map_header_t *h = (map_header_t *)blob;
+  *h = (map_header_t){.magic = MAP_MAGIC,
+                      .version = MAP_VERSION,
+                      .tiles_x = 1,
+                      .tiles_y = 1,
+                      .unit_log2_cm = UNIT_LOG2_CM,
+                      .origin_lat_e7 = -230000000,
+                      .origin_lon_e7 = -433500000,
+                      .lat_q16 = 2276,
+                      .lon_q16 = 2095,
+                      .width = 0xFFFF,
+                      .height = 0xFFFF,
+                      .rtree_fanout = FANOUT,
+                      .rtree_levels = levels,
+                      .poi_count = count,
+                      .tiles_off = tiles_off,
+                      .poi_off = poi_off,
+                      .rtree_off = rtree_off,
+                      .names_off = names_off,
+                      .size = names_off};
+  map_tile_t *tile = (map_tile_t *)(blob + tiles_off);
+  tile->bbox = (map_bbox_t){0xFFFF, 0xFFFF, 0, 0};
+  tile->offset = poi_off;
+
+  map_poi_t *pois = (map_poi_t *)(blob + poi_off);
+  for (uint32_t i = 0; i < count; i++)
+    pois[i] = k[i].poi;
+  free(k);
+
+  // Level by level, each node the union of FANOUT children
+  map_bbox_t *boxes = (map_bbox_t *)(blob + rtree_off);
+  uint8_t *masks = blob + rtree_off + nodes * sizeof(map_bbox_t);
+  uint32_t below = 0, at = 0;
+  for (uint8_t l = 1; l <= levels; l++) {
+    for (uint32_t n = 0; n < level_size[l]; n++) {
+      map_bbox_t b = {0xFFFF, 0xFFFF, 0, 0};
+      uint8_t mask = 0;
+      for (uint32_t c = n * FANOUT;
+           c < (n + 1) * FANOUT && c < level_size[l - 1]; c++) {
+        map_bbox_t cb;
+        uint8_t cm;
+        if (l == 1) {
+          cb = (map_bbox_t){pois[c].x, pois[c].y, pois[c].x, pois[c].y};
+          cm = (uint8_t)(1u << pois[c].kind);
+        } else {
+          cb = boxes[below + c];
+          cm = masks[below + c];
+        }
+        b.x0 = cb.x0 < b.x0 ? cb.x0 : b.x0;
+        b.y0 = cb.y0 < b.y0 ? cb.y0 : b.y0;
+        b.x1 = cb.x1 > b.x1 ? cb.x1 : b.x1;
+        b.y1 = cb.y1 > b.y1 ? cb.y1 : b.y1;
+        mask |= cm;
+      }
+      boxes[at + n] = b;
+      masks[at + n] = mask;
+    }
+    below = l == 1 ? 0 : below + level_size[l - 1];
+    at += level_size[l];
+  }
+  *size = names_off;
+  return blob;
+}
+
+// The scan /api/poi would need without the tree: k = 4 by insertion
+static void linear_knn(const map_header_t *m, int32_t x, int32_t y,
+                       uint64_t best[4]) {
+  best[0] = best[1] = best[2] = best[3] = UINT64_MAX;
+  const map_poi_t *p = map_poi_get(m, 0);
+  for (uint32_t i = 0; i < m->poi_count; i++, p++) {
+    int64_t dx = (int64_t)p->x - x, dy = (int64_t)p->y - y;
+    uint64_t d = (uint64_t)(dx * dx + dy * dy);
+    if (d >= best[3])
+      continue;
+    int j = 3;
+    while (j > 0 && best[j - 1] > d) {
+      best[j] = best[j - 1];
+      j--;
+    }
+    best[j] = d;
+  }
+}
+
+static uint32_t linear_bbox(const map_header_t *m, const map_bbox_t *b) {
+  uint32_t n = 0;
+  const map_poi_t *p = map_poi_get(m, 0);
+  for (uint32_t i = 0; i < m->poi_count; i++, p++)
+    n += p->x >= b->x0 && p->x <= b->x1 && p->y >= b->y0 && p->y <= b->y1;
+  return n;
+}
+
+int main(int argc, char **argv) {
+  int queries = bench_iterations(argc, argv, 2000);
+  static const uint32_t sizes[] = {10000, 100000, 1000000};
+  // Zoom 0 viewport (128x64 px at 20 m) in 32 cm units
+  const int32_t vw = 8192, vh = 4096;
+
+  printf("%-8s %8s %9s %9s %9s %9s %7s\n", "marks", "blob KB", "knn us",
+         "scan us", "bbox us", "scan us", "hits");
+  for (int s = 0; s < 3; s++) {
+    uint32_t size;
+    uint8_t *blob = build(sizes[s], &size);
+    CHECK_EQ(map_open(blob, size), ESP_OK);
+    const map_header_t *m = map_get();
+
+    int32_t *qx = malloc(queries * sizeof(*qx));
+    int32_t *qy = malloc(queries * sizeof(*qy));
+    for (int i = 0; i < queries; i++) {
+      qx[i] = (int32_t)rnd(0x10000);
+      qy[i] = (int32_t)rnd(0x10000);
+    }
+
+    map_poi_hit_t hits[4];
+    uint64_t best[4];
+    int bad = 0;
+    for (int i = 0; i < queries && i < 200; i++) {
+      uint8_t n = map_index_nearest(m, qx[i], qy[i], MAP_POI_KIND_ALL, 4,
+                                    hits);
+      linear_knn(m, qx[i], qy[i], best);
+      for (int j = 0; j < 4; j++)
+        bad += j >= n || hits[j].dist2 != best[j];
+    }
+    CHECK_EQ(bad, 0);
+
+    int64_t t0 = host_now_ns();
+    for (int i = 0; i < queries; i++)
+      map_index_nearest(m, qx[i], qy[i], MAP_POI_KIND_ALL, 4, hits);
+    double knn = (double)(host_now_ns() - t0) / queries / 1000;
+    int scans = queries / 10 + 1;
+    t0 = host_now_ns();
+    for (int i = 0; i < scans; i++)
+      linear_knn(m, qx[i], qy[i], best);
+    double knn_scan = (double)(host_now_ns() - t0) / scans / 1000;
+
+    double found = 0;
+    t0 = host_now_ns();
+    for (int i = 0; i < queries; i++) {
+      map_bbox_t b = {clamp16(qx[i] - vw / 2), clamp16(qy[i] - vh / 2),
+                      clamp16(qx[i] + vw / 2), clamp16(qy[i] + vh / 2)};
+      found += map_index_bbox(m, &b, MAP_POI_KIND_ALL, NULL, NULL);
+    }
+    double bbox = (double)(host_now_ns() - t0) / queries / 1000;
+    t0 = host_now_ns();
+    for (int i = 0; i < scans; i++) {
+      map_bbox_t b = {clamp16(qx[i] - vw / 2), clamp16(qy[i] - vh / 2),
+                      clamp16(qx[i] + vw / 2), clamp16(qy[i] + vh / 2)};
+      bad += linear_bbox(m, &b) !=
+             map_index_bbox(m, &b, MAP_POI_KIND_ALL, NULL, NULL);
+    }
+    // The scan loop also runs the tree query once per box; negligible
+    double bbox_scan = (double)(host_now_ns() - t0) / scans / 1000;
+    CHECK_EQ(bad, 0);
+
+    printf("%-8u %8.0f %9.2f %9.1f %9.2f %9.1f %7.1f\n", sizes[s],
+           size / 1024.0, knn, knn_scan, bbox, bbox_scan, found / queries);
+    free(qx);
+    free(qy);
+    free(blob);
+  }
+  // Leave the bundled map selected
+  CHECK_EQ(map_open(map_blob, map_blob_size), ESP_OK);
+  return test_result("bench_map_index");
+}
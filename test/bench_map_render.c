@@ -0,0 +1,65 @@
+// Map page cost along the 10 Hz boat capture (nav_10hz.csv) at each zoom:
+// map_render() time, what it visited, and the I2C bytes of the partial
+// refresh that follows, as display_map() in main.c does it.
+// Usage: bench_map_render [passes]
+#include "map_render.h"
+#include "oled.h"
+#include "oled_backend.h"
+#include "test_util.h"
+
+#define MAX_FIXES 100000
+
+static int32_t lats[MAX_FIXES], lons[MAX_FIXES];
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 20);
+  CHECK_EQ(oled_init_backend(&oled_backend_host), ESP_OK);
+
+  char *text = fixture_load("nav_10hz.csv", NULL), **lines;
+  size_t n = fixture_lines(text, &lines), fixes = 0;
+  for (size_t i = 1; i < n && fixes < MAX_FIXES; i++) {
+    long itow, lat, lon;
+    if (sscanf(lines[i], "%ld,%ld,%ld", &itow, &lat, &lon) == 3 &&
+        map_contains((int32_t)lat, (int32_t)lon)) {
+      lats[fixes] = (int32_t)lat;
+      lons[fixes++] = (int32_t)lon;
+    }
+  }
+  CHECK(fixes > 0);
+  const map_header_t *hdr = map_get();
+  printf("%zu fixes inside the extract, %u tiles\n", fixes,
+         hdr->tiles_x * hdr->tiles_y);
+  printf("%-6s %8s %8s %6s %8s %8s %8s\n", "zoom", "avg us", "max us", "tiles",
+         "features", "segments", "bytes");
+
+  for (uint8_t zoom = 0; zoom < MAP_ZOOM_LEVELS; zoom++) {
+    double sum = 0, tiles = 0, features = 0, segments = 0;
+    int64_t worst = 0;
+    oled_stats_t before, after;
+    oled_get_stats(&before);
+    for (int p = 0; p < passes; p++) {
+      for (size_t i = 0; i < fixes; i++) {
+        map_render_stats_t st;
+        oled_clear();
+        int64_t t0 = host_now_ns();
+        map_render(lats[i], lons[i], zoom, &st);
+        int64_t dt = host_now_ns() - t0;
+        oled_display();
+        sum += (double)dt;
+        worst = dt > worst ? dt : worst;
+        tiles += st.tiles;
+        features += st.features;
+        segments += st.segments;
+      }
+    }
+    oled_get_stats(&after);
+    double frames = (double)passes * fixes;
+    printf("%-6u %8.1f %8.1f %6.1f %8.1f %8.1f %8.0f\n", zoom,
+           sum / frames / 1000, (double)worst / 1000, tiles / frames,
+           features / frames, segments / frames,
+           (after.bytes - before.bytes) / frames);
+  }
+  free(lines);
+  free(text);
+  return test_result("bench_map_render");
+}
@@ -0,0 +1,69 @@
+// mqtt_codec.c sizes and costs per format, for one fix and for a full
+// batch, on the 1 Hz capture as the queue sends it (every fix) and thinned
+// to one fix per 25 m (what the dead-band lets through under way). CBOR's
+// deltas are smallest at 1 Hz; packed does not care.
+// Usage: bench_mqtt_codec [passes]
+#include "geo.h"
+#include "gps_parser.h"
+#include "mqtt_codec.h"
+#include "test_util.h"
+
+#define MAX_FIXES 600
+#define BATCH 32
+
+static sd_log_record_t all[MAX_FIXES], thinned[MAX_FIXES];
+static uint8_t buf[MQTT_CODEC_MAX_BYTES(BATCH)];
+
+static void run(const char *name, const sd_log_record_t *recs, size_t count,
+                int passes) {
+  static const uint8_t formats[] = {MQTT_PAYLOAD_JSON, MQTT_PAYLOAD_CBOR,
+                                    MQTT_PAYLOAD_PACKED};
+  static const char *const names[] = {"JSON", "CBOR", "packed"};
+  for (int f = 0; f < 3; f++) {
+    printf("%s %-6s", name, names[f]);
+    for (uint16_t n = 1; n <= BATCH; n += BATCH - 1) {
+      mqtt_batch_id_t id = {0x5A17C0DE, 0};
+      size_t bytes = 0, batches = 0;
+      int64_t t0 = host_now_ns();
+      for (int p = 0; p < passes; p++) {
+        for (size_t i = 0; i + n <= count; i += n, batches++) {
+          id.seq = (uint32_t)i;
+          size_t len = mqtt_codec_encode(formats[f], &id, &recs[i], n, buf,
+                                         sizeof(buf));
+          CHECK(len > 0);
+          bytes += len;
+        }
+      }
+      int64_t ns = host_now_ns() - t0;
+      printf("  %2u fix%s %5.0f B %6.2f us", n, n > 1 ? "es" : "  ",
+             (double)bytes / batches, (double)ns / batches / 1000);
+    }
+    printf("\n");
+  }
+}
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 200);
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines), count = 0, kept = 0;
+  gps_reset_data();
+  for (size_t i = 0; i < n && count < MAX_FIXES; i++) {
+    gps_parse_nmea(lines[i]);
+    if (strncmp(lines[i] + 3, "GGA", 3) != 0 ||
+        !sd_log_record_from_gps(gps_get_data(), &all[count]))
+      continue;
+    const sd_log_record_t *r = &all[count++];
+    if (kept == 0 ||
+        geo_distance_cm(thinned[kept - 1].lat_e7, thinned[kept - 1].lon_e7,
+                        r->lat_e7, r->lon_e7) >= 2500)
+      thinned[kept++] = *r;
+  }
+  free(lines);
+  free(text);
+  CHECK(count == MAX_FIXES && kept >= BATCH);
+
+  run("1 Hz   ", all, count, passes);
+  run("25 m   ", thinned, kept, passes * (int)(count / kept));
+  printf("(%zu fixes at 1 Hz, %zu kept at 25 m)\n", count, kept);
+  return test_result("bench_mqtt_codec");
+}
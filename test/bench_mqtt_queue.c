@@ -0,0 +1,79 @@
+// mqtt_queue.c costs on the host: offer() per fix (dead-band and the
+// ring, what the ingest task pays), peek() + ack() per batch from RAM, and
+// the spill file: spilling a batch and draining it again, each with the
+// fsync'd header write. Host file system times say little about an SD
+// card; the target logs its own (`MQTT queue:`).
+// Usage: bench_mqtt_queue [fixes]
+#include "geo.h"
+#include "mqtt_queue.h"
+#include "test_util.h"
+
+static sd_log_record_t fix(uint32_t i) {
+  // 30 m north per fix: every one passes the dead-band
+  sd_log_record_t r = {.time = 1715000000u + i,
+                       .lat_e7 = -228400000 + (int32_t)(i % 100000) * 2700,
+                       .lon_e7 = -431100000, .satellites = 9, .flags = 1};
+  r.crc8 = sd_log_crc8((const uint8_t *)&r, sizeof(r) - 1);
+  return r;
+}
+
+int main(int argc, char **argv) {
+  int fixes = bench_iterations(argc, argv, 1000000);
+  const char *dir = scratch_enter();
+  host_set_time_us(0);
+  CHECK_EQ(mqtt_queue_init("mqttq.bin"), ESP_OK);
+  sd_log_record_t out[MQTT_BATCH_MAX];
+  mqtt_batch_id_t id;
+
+  // Online: offer, and a batch out every MQTT_BATCH_MAX fixes
+  int64_t offer_ns = 0, batch_ns = 0;
+  int batches = 0;
+  for (int i = 0; i < fixes; i++) {
+    sd_log_record_t r = fix((uint32_t)i);
+    int64_t t0 = host_now_ns();
+    mqtt_queue_offer(&r);
+    int64_t t1 = host_now_ns();
+    offer_ns += t1 - t0;
+    if (i % MQTT_BATCH_MAX == MQTT_BATCH_MAX - 1) {
+      uint16_t n = mqtt_queue_peek(out, MQTT_BATCH_MAX, &id);
+      mqtt_queue_ack(n);
+      batch_ns += host_now_ns() - t1;
+      batches++;
+      CHECK_EQ(n, MQTT_BATCH_MAX);
+    }
+  }
+
+  // Offline: spill a batch at a time, then drain the file
+  int spills = fixes / 100 / MQTT_BATCH_MAX + 1;
+  int64_t spill_ns = 0;
+  for (int s = 0; s < spills; s++) {
+    for (int i = 0; i < MQTT_BATCH_MAX; i++) {
+      sd_log_record_t r = fix((uint32_t)(fixes + s * MQTT_BATCH_MAX + i));
+      mqtt_queue_offer(&r);
+    }
+    int64_t t0 = host_now_ns();
+    mqtt_queue_spill();
+    spill_ns += host_now_ns() - t0;
+  }
+  int64_t t0 = host_now_ns();
+  int drained = 0;
+  uint16_t n;
+  while ((n = mqtt_queue_peek(out, MQTT_BATCH_MAX, &id)) > 0) {
+    mqtt_queue_ack(n);
+    drained += n;
+  }
+  int64_t drain_ns = host_now_ns() - t0;
+  CHECK_EQ(drained, spills * MQTT_BATCH_MAX);
+
+  mqtt_queue_stats_t st;
+  mqtt_queue_get_stats(&st);
+  CHECK_EQ(st.dropped, 0);
+  CHECK_EQ(st.sent, (uint32_t)batches * MQTT_BATCH_MAX + drained);
+  printf("offer %.0f ns/fix; RAM batch of %d: peek+ack %.2f us; spill "
+         "%.0f us/batch, drain %.0f us/batch (fsync'd header each)\n",
+         (double)offer_ns / fixes, MQTT_BATCH_MAX,
+         (double)batch_ns / batches / 1000, (double)spill_ns / spills / 1000,
+         (double)drain_ns / spills / 1000);
+  scratch_leave(dir);
+  return test_result("bench_mqtt_queue");
+}
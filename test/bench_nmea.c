@@ -0,0 +1,115 @@
+// Sentences per second and heap bytes per sentence of gps_parse_nmea()
+// against the strdup/strtok parser it replaced, on the recorded GPS-only
+// capture. The legacy parser only knows GGA and RMC, and strtok() merges
+// the empty fields every NMEA 2.3 GGA/RMC has, so it tokenises those and
+// then drops them. The like-for-like run therefore uses only the GGA and
+// RMC lines with empty fields filled with "0", which both decode fully.
+// Usage: bench_nmea [passes]
+#include "gps_parser.h"
+#include "legacy_gps_parser.h"
+#include "test_util.h"
+
+// Linked with -Wl,--wrap: every malloc/strdup from the parsers lands here
+static size_t heap_calls, heap_bytes;
+void *__real_malloc(size_t size);
+void __real_free(void *p);
+char *__real_strdup(const char *s);
+
+void *__wrap_malloc(size_t size) {
+  heap_calls++;
+  heap_bytes += size;
+  return __real_malloc(size);
+}
+
+void __wrap_free(void *p) { __real_free(p); }
+
+char *__wrap_strdup(const char *s) {
+  heap_calls++;
+  heap_bytes += strlen(s) + 1;
+  return __real_strdup(s);
+}
+
+typedef struct {
+  double ns_per_sentence;
+  double heap_calls;
+  double heap_bytes;
+} result_t;
+
+static result_t run(void (*parse)(const char *), char **lines, size_t n,
+                    int passes) {
+  heap_calls = heap_bytes = 0;
+  int64_t t0 = host_now_ns();
+  for (int p = 0; p < passes; p++)
+    for (size_t i = 0; i < n; i++)
+      parse(lines[i]);
+  int64_t t1 = host_now_ns();
+  double total = (double)n * passes;
+  return (result_t){(t1 - t0) / total, heap_calls / total,
+                    heap_bytes / total};
+}
+
+static void report(const char *name, result_t r) {
+  printf("%-24s %8.0f sentences/s %7.1f ns/sentence %5.2f allocs/sentence "
+         "%6.1f heap bytes/sentence\n",
+         name, 1e9 / r.ns_per_sentence, r.ns_per_sentence, r.heap_calls,
+         r.heap_bytes);
+}
+
+// GGA/RMC lines of the capture with every empty field set to "0"
+static size_t filled_gga_rmc(char **lines, size_t n, char ***out) {
+  char **filled = malloc(n * sizeof(*filled));
+  size_t m = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (strncmp(lines[i] + 3, "GGA", 3) && strncmp(lines[i] + 3, "RMC", 3))
+      continue;
+    char *dst = malloc(2 * strlen(lines[i]) + 1), *d = dst;
+    for (const char *s = lines[i]; *s; s++) {
+      *d++ = *s;
+      if (*s == ',' && (s[1] == ',' || s[1] == '*'))
+        *d++ = '0';
+    }
+    *d = '\0';
+    filled[m++] = dst;
+  }
+  *out = filled;
+  return m;
+}
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 200);
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines);
+  printf("gp_1hz.nmea: %zu sentences, %d passes\n", n, passes);
+
+  char **filled;
+  size_t m = filled_gga_rmc(lines, n, &filled);
+
+  // Warm both paths once so neither pays for first-touch page faults
+  run(legacy_gps_parse_nmea, filled, m, 1);
+  run(gps_parse_nmea, filled, m, 1);
+  printf("GGA+RMC, empty fields filled (%zu sentences):\n", m);
+  result_t legacy = run(legacy_gps_parse_nmea, filled, m, passes);
+  result_t current = run(gps_parse_nmea, filled, m, passes);
+  report("  strdup/strtok (legacy)", legacy);
+  report("  nmea_split (current)", current);
+  printf("  speedup %.1fx\n",
+         legacy.ns_per_sentence / current.ns_per_sentence);
+  // The legacy parser must really have decoded them for the comparison
+  CHECK(legacy_gps_get_data()->latitude < -22.8);
+  CHECK(legacy_gps_get_data()->satellites > 0);
+
+  printf("Whole capture, as received (%zu sentences):\n", n);
+  result_t legacy_all = run(legacy_gps_parse_nmea, lines, n, passes);
+  result_t current_all = run(gps_parse_nmea, lines, n, passes);
+  report("  strdup/strtok (legacy)", legacy_all);
+  report("  nmea_split (current)", current_all);
+
+  // The point of the rewrite: no heap on the parse path
+  CHECK(current.heap_calls == 0 && current_all.heap_calls == 0);
+  for (size_t i = 0; i < m; i++)
+    free(filled[i]);
+  free(filled);
+  free(lines);
+  free(text);
+  return test_result("bench_nmea");
+}
@@ -0,0 +1,57 @@
+// Framebuffer primitives against the per-pixel loops they replaced: a
+// 120x50 fill, a full-screen rectangle outline, and the 104x64 world-map
+// blit from oledGPS.ino at an unaligned y.
+// Usage: bench_oled_draw [iterations]
+#include "oled.h"
+#include "oled_backend.h"
+#include "test_util.h"
+
+static uint8_t map[104 * 8];
+
+static void naive_fill(int x, int y, int w, int h) {
+  for (int j = 0; j < h; j++)
+    for (int i = 0; i < w; i++)
+      oled_draw_pixel(x + i, y + j, true);
+}
+
+static void naive_blit(int x, int y, const uint8_t *src, int w, int h) {
+  for (int row = 0; row < h; row++)
+    for (int col = 0; col < w; col++)
+      if ((src[(row / 8) * w + col] >> (row % 8)) & 1)
+        oled_draw_pixel(x + col, y + row, true);
+}
+
+#define TIME(label, n, stmt)                                                 \
+  do {                                                                       \
+    int64_t t0_ = host_now_ns();                                             \
+    for (int i_ = 0; i_ < (n); i_++)                                         \
+      stmt;                                                                  \
+    ns = (double)(host_now_ns() - t0_) / (n);                                \
+    printf("%-34s %10.0f\n", label, ns);                                     \
+  } while (0)
+
+int main(int argc, char **argv) {
+  int n = bench_iterations(argc, argv, 100000);
+  CHECK_EQ(oled_init_backend(&oled_backend_host), ESP_OK);
+  uint32_t lcg = 3;
+  for (size_t i = 0; i < sizeof(map); i++)
+    map[i] = (uint8_t)((lcg = lcg * 1103515245u + 12345u) >> 24);
+
+  double ns, fast, slow;
+  printf("%-34s %10s\n", "", "ns");
+  TIME("fill_rect 120x50 at y=5", n, oled_fill_rect(4, 5, 120, 50, true));
+  fast = ns;
+  TIME("  per pixel", n / 100 + 1, naive_fill(4, 5, 120, 50));
+  slow = ns;
+  printf("%-34s %9.0fx\n", "  speedup", slow / fast);
+  TIME("draw_rect 128x64 outline", n, oled_draw_rect(0, 0, 128, 64, true));
+  TIME("hline 128 / vline 64", n,
+       (oled_draw_hline(0, 30, 128, true), oled_draw_vline(70, 0, 64, true)));
+  TIME("draw_bitmap 104x64 at y=3, OR", n,
+       oled_draw_bitmap(12, 3, map, 104, 64, OLED_BLIT_OR));
+  fast = ns;
+  TIME("  per pixel", n / 100 + 1, naive_blit(12, 3, map, 104, 64));
+  slow = ns;
+  printf("%-34s %9.0fx\n", "  speedup", slow / fast);
+  return test_result("bench_oled_draw");
+}
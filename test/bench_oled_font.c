@@ -0,0 +1,59 @@
+// Cost of drawing a screen of text into the framebuffer (no refresh): 21x8
+// cells of 5x7 at page-aligned and unaligned y, 10x14 and the large digits,
+// against the old solid block of 64 oled_draw_pixel() calls per character.
+// Usage: bench_oled_font [frames]
+#include "oled.h"
+#include "oled_backend.h"
+#include "test_util.h"
+
+static const char *LINE = "SAT 9 3D HDOP 0.9 abc";
+
+static double frame_us(const oled_font_t *f, int y0, int rows, int frames) {
+  oled_set_font(f);
+  int64_t t0 = host_now_ns();
+  for (int i = 0; i < frames; i++) {
+    for (int r = 0; r < rows; r++) {
+      oled_set_cursor(0, y0 + r * f->pages * 8);
+      oled_print(LINE);
+    }
+  }
+  return (double)(host_now_ns() - t0) / frames / 1000;
+}
+
+// What oled_print() did before: 8x8 pixels per printable character
+static double legacy_us(int frames) {
+  int64_t t0 = host_now_ns();
+  for (int i = 0; i < frames; i++) {
+    for (int r = 0; r < 8; r++)
+      for (int c = 0; c < 16; c++)
+        for (int py = 0; py < 8; py++)
+          for (int px = 0; px < 8; px++)
+            oled_draw_pixel(c * 8 + px, r * 8 + py, true);
+  }
+  return (double)(host_now_ns() - t0) / frames / 1000;
+}
+
+int main(int argc, char **argv) {
+  int frames = bench_iterations(argc, argv, 20000);
+  CHECK_EQ(oled_init_backend(&oled_backend_host), ESP_OK);
+
+  printf("%-34s %8s\n", "", "us/frame");
+  printf("%-34s %8.2f\n", "5x7, 21x8 cells, y page-aligned",
+         frame_us(&oled_font_5x7, 0, 8, frames));
+  printf("%-34s %8.2f\n", "5x7, 21x8 cells, y = 3 + 8k",
+         frame_us(&oled_font_5x7, 3, 8, frames));
+  printf("%-34s %8.2f\n", "10x14, 10x4 cells",
+         frame_us(&oled_font_10x14, 0, 4, frames));
+  oled_clear();
+  oled_set_font(&oled_font_digits_20x28);
+  int64_t t0 = host_now_ns();
+  for (int i = 0; i < frames; i++) {
+    oled_set_cursor(0, 24);
+    oled_print("123.4");
+  }
+  printf("%-34s %8.2f\n", "20x28 digits, \"123.4\"",
+         (double)(host_now_ns() - t0) / frames / 1000);
+  printf("%-34s %8.2f\n", "old 8x8 block per char, 16x8",
+         legacy_us(frames / 10 + 1));
+  return test_result("bench_oled_font");
+}
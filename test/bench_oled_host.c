@@ -0,0 +1,93 @@
+// Frame cost of the display_gps_info() text page through the host backend:
+// drawing time, oled_display() time and the I2C bytes each 100 ms frame puts
+// on the bus while the position and speed change, against a full refresh.
+// Usage: bench_oled_host [frames]
+#include "fixed_fmt.h"
+#include "oled.h"
+#include "oled_backend.h"
+#include "test_util.h"
+
+// ~22.5 us per byte at 400 kHz (9 clocks per byte)
+#define BUS_US_PER_BYTE 22.5
+
+// Same drawing as display_gps_info() (see test_oled_host.c)
+static void gps_page(int32_t lat_e7, int32_t lon_e7, int32_t speed_ckmh,
+                     unsigned course_cdeg) {
+  char line[32], num[FIXED_FMT_MAX];
+  oled_clear();
+  oled_set_font(&oled_font_5x7);
+  fixed_fmt_round(num, sizeof(num), 90, 2, 1);
+  snprintf(line, sizeof(line), "SAT %d %s HDOP %s", 9, "3D", num);
+  oled_println(line);
+  fixed_fmt_round(num, sizeof(num), lat_e7, 7, 6);
+  snprintf(line, sizeof(line), "LAT %s", num);
+  oled_println(line);
+  fixed_fmt_round(num, sizeof(num), lon_e7, 7, 6);
+  snprintf(line, sizeof(line), "LON %s", num);
+  oled_println(line);
+  oled_set_font(&oled_font_digits_20x28);
+  oled_set_cursor(0, 24);
+  fixed_fmt_round(line, sizeof(line), speed_ckmh, 2, 1);
+  oled_print(line);
+  oled_set_font(&oled_font_5x7);
+  oled_set_cursor(OLED_WIDTH - oled_text_width("km/h"), 48);
+  oled_print("km/h");
+  oled_set_cursor(0, 56);
+  fixed_fmt_round(num, sizeof(num), 1234, 2, 0);
+  snprintf(line, sizeof(line), "ALT %sm CRS %u\x7F", num,
+           (course_cdeg + 50) / 100 % 360);
+  oled_print(line);
+}
+
+typedef struct {
+  double draw_ns, display_ns, bytes, transactions;
+} cost_t;
+
+// `frames` refreshes at 10 Hz of a boat doing ~20 km/h on a slow turn;
+// `full` resends the whole frame every time (no shadow)
+static cost_t run(int frames, bool full) {
+  cost_t c = {0};
+  int64_t draw = 0, display = 0;
+  oled_stats_t before, after;
+  oled_get_stats(&before);
+  for (int i = 0; i < frames; i++) {
+    int32_t lat = -228395173 + i * 40, lon = -431149703 - i * 25;
+    int32_t speed = 2000 + (i * 7) % 120;
+    int64_t t0 = host_now_ns();
+    gps_page(lat, lon, speed, (unsigned)(9000 + i * 3) % 36000);
+    int64_t t1 = host_now_ns();
+    if (full)
+      oled_invalidate();
+    oled_display();
+    int64_t t2 = host_now_ns();
+    draw += t1 - t0;
+    display += t2 - t1;
+  }
+  oled_get_stats(&after);
+  c.draw_ns = (double)draw / frames;
+  c.display_ns = (double)display / frames;
+  c.bytes = (double)(after.bytes - before.bytes) / frames;
+  c.transactions = (double)(after.transactions - before.transactions) / frames;
+  return c;
+}
+
+static void report(const char *label, cost_t c) {
+  printf("%-26s %8.0f %8.0f %8.0f %6.1f %8.2f\n", label, c.draw_ns,
+         c.display_ns, c.bytes, c.transactions,
+         c.bytes * BUS_US_PER_BYTE / 1000);
+}
+
+int main(int argc, char **argv) {
+  int frames = bench_iterations(argc, argv, 20000);
+  CHECK_EQ(oled_init_backend(&oled_backend_host), ESP_OK);
+
+  printf("%-26s %8s %8s %8s %6s %8s\n", "", "draw ns", "disp ns", "bytes",
+         "txns", "bus ms");
+  cost_t partial = run(frames, false);
+  report("gps page, partial refresh", partial);
+  cost_t full = run(frames, true);
+  report("gps page, full refresh", full);
+  printf("%-26s %7.1fx\n", "bus bytes saved", full.bytes / partial.bytes);
+  CHECK(partial.bytes < full.bytes);
+  return test_result("bench_oled_host");
+}
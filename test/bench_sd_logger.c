@@ -0,0 +1,89 @@
+// SD write path at 1 Hz: the old save_gps_to_sd() (fopen, fprintf, fclose
+// per fix) against sd_logger (RAM append, 4 KiB writes from the SD task,
+// timed flush every SD_LOG_FLUSH_MS), both on files in a scratch directory.
+// Card-side cost is what matters on the device: file opens (a FAT directory
+// update each) and writes per hour.
+// Usage: bench_sd_logger [hours]
+#include "esp_timer.h"
+#include "sd_logger.h"
+#include "test_util.h"
+
+#define T0 1716033600u // 2024-05-18T12:00:00Z
+
+static sd_log_record_t make_rec(uint32_t i) {
+  sd_log_record_t r = {T0 + i,        -228395173 + (int32_t)(i % 3000) * 37,
+                       -431149703 - (int32_t)(i % 2000) * 11,
+                       400,           1800 + i % 7,
+                       (i * 13) % 36000, 9, 9, 0x07, 0};
+  r.crc8 = sd_log_crc8((const uint8_t *)&r, sizeof(r) - 1);
+  return r;
+}
+
+// The removed save_gps_to_sd(), fed from the record
+static void legacy_save(const sd_log_record_t *r) {
+  FILE *file = fopen("legacy.txt", "a");
+  if (!file)
+    return;
+  fprintf(file, "%lu,%.8f,%.8f,%.2f,%d,%.2f,%.2f,%s,%s\n",
+          (unsigned long)(esp_timer_get_time() / 1000000), r->lat_e7 / 1e7,
+          r->lon_e7 / 1e7, r->alt_cm / 100.0, r->satellites,
+          r->speed_ckmh / 100.0, r->course_cdeg / 100.0, "120000", "180524");
+  fclose(file);
+}
+
+int main(int argc, char **argv) {
+  int hours = bench_iterations(argc, argv, 6);
+  uint32_t fixes = (uint32_t)hours * 3600;
+  const char *dir = scratch_enter();
+
+  host_set_time_us(0);
+  int64_t t0 = host_now_ns();
+  for (uint32_t i = 0; i < fixes; i++) {
+    sd_log_record_t r = make_rec(i);
+    legacy_save(&r);
+    host_advance_us(1000000);
+  }
+  double legacy_ns = (double)(host_now_ns() - t0) / fixes;
+  struct stat sb;
+  stat("legacy.txt", &sb);
+  double legacy_bytes = (double)sb.st_size;
+
+  host_set_time_us(0);
+  CHECK_EQ(sd_logger_init(), ESP_OK);
+  int64_t append_ns = 0, service_ns = 0;
+  for (uint32_t i = 0; i < fixes; i++) {
+    sd_log_record_t r = make_rec(i);
+    int64_t a = host_now_ns();
+    CHECK(sd_logger_append_record(&r));
+    int64_t b = host_now_ns();
+    sd_logger_service(); // the SD task runs about once per fix
+    service_ns += host_now_ns() - b;
+    append_ns += b - a;
+    host_advance_us(1000000);
+  }
+  sd_logger_flush();
+  sd_logger_stats_t st;
+  sd_logger_get_stats(&st);
+  stat(SD_LOG_CSV_PATH, &sb);
+  double payload = (double)sb.st_size + (double)fixes * 24;
+
+  printf("%u fixes at 1 Hz (%d h)\n", (unsigned)fixes, hours);
+  printf("%-26s %10s %12s %12s\n", "", "ns/fix", "opens/h", "writes/h");
+  printf("%-26s %10.0f %12.0f %12.0f\n", "fopen/fprintf/fclose", legacy_ns,
+         3600.0, 3600.0);
+  printf("%-26s %10.0f %12.0f %12.0f\n", "sd_logger append (RAM)",
+         (double)append_ns / fixes, 0.0, 0.0);
+  printf("%-26s %10.0f %12.1f %12.1f\n", "sd_logger SD task",
+         (double)service_ns / fixes, (double)st.segments / hours,
+         (double)st.writes / hours);
+  printf("CSV %.0f B/h as one write per fix; sd_logger CSV+binary %.0f B/h "
+         "payload, %.0f B/h written (4 KiB units, partial blocks "
+         "rewritten on each %d s flush)\n",
+         legacy_bytes / hours, payload / hours,
+         (double)st.bytes_written / hours, SD_LOG_FLUSH_MS / 1000);
+
+  CHECK_EQ(st.records, fixes);
+  CHECK_EQ(st.dropped, 0);
+  scratch_leave(dir);
+  return test_result("bench_sd_logger");
+}
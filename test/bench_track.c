@@ -0,0 +1,71 @@
+// track.c ring costs: append before and after the ring wraps (O(1) either
+// way), sequential cursor decode, and seeking a time range in a full ring.
+// Usage: bench_track [rounds]
+#include "test_util.h"
+#include "track.h"
+
+static track_fix_t make_fix(uint32_t i) {
+  track_fix_t f = {1700000000u + i, -228395173 + (int32_t)(i % 5000) * 37,
+                   -431149703 - (int32_t)(i % 3000) * 11, 40, 180 + i % 7,
+                   (uint8_t)(i / 30 % 180)};
+  return f;
+}
+
+int main(int argc, char **argv) {
+  int rounds = bench_iterations(argc, argv, 20);
+  track_init();
+
+  // Until the first eviction, then the same number again while evicting
+  uint32_t i = 0;
+  track_stats_t st;
+  int64_t t0 = host_now_ns();
+  for (;; i++) {
+    track_fix_t f = make_fix(i);
+    track_append(&f);
+    if ((i & 255) == 0) {
+      track_get_stats(&st);
+      if (st.fixes < i + 1)
+        break;
+    }
+  }
+  double fill_ns = (double)(host_now_ns() - t0) / i;
+  uint32_t filled = i;
+  t0 = host_now_ns();
+  for (uint32_t n = 0; n < filled * (uint32_t)rounds; n++, i++) {
+    track_fix_t f = make_fix(i);
+    track_append(&f);
+  }
+  double wrap_ns = (double)(host_now_ns() - t0) / (filled * (double)rounds);
+
+  track_get_stats(&st);
+  track_cursor_t cur;
+  track_fix_t f;
+  size_t read = 0;
+  t0 = host_now_ns();
+  for (int r = 0; r < rounds; r++) {
+    track_cursor_init(&cur, 0, UINT32_MAX);
+    while (track_cursor_next(&cur, &f))
+      read++;
+  }
+  double read_ns = (double)(host_now_ns() - t0) / read;
+
+  // Last 60 s of the ring: binary search over blocks, then one block decode
+  int seeks = rounds * 1000;
+  t0 = host_now_ns();
+  for (int s = 0; s < seeks; s++) {
+    uint32_t from = st.oldest + (uint32_t)s * 7919 % (st.newest - st.oldest);
+    track_cursor_init(&cur, from, from + 60);
+    while (track_cursor_next(&cur, &f))
+      ;
+  }
+  double seek_ns = (double)(host_now_ns() - t0) / seeks;
+
+  printf("ring %d x %d B: %u fixes in %u bytes (%.1f B/fix)\n", TRACK_BLOCKS,
+         TRACK_BLOCK_BYTES, (unsigned)st.fixes, (unsigned)st.bytes_used,
+         (double)st.bytes_used / st.fixes);
+  printf("append %.0f ns (filling), %.0f ns (evicting)\n", fill_ns, wrap_ns);
+  printf("cursor %.0f ns/fix; 60 s range from a full ring %.1f us\n", read_ns,
+         seek_ns / 1000);
+  CHECK(read == (size_t)rounds * st.fixes);
+  return test_result("bench_track");
+}
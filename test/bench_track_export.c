@@ -0,0 +1,61 @@
+// /api/track export speed: records formatted per second and bytes through
+// the loopback HTTP stand-in for each format, against the 200 KB/s the AP
+// link has to sustain, and the export's peak heap.
+// Usage: bench_track_export [records]
+#include "heap_wrap.h"
+#include "http_standin.h"
+#include "sd_logger.h"
+#include "test_util.h"
+#include "track_export.h"
+
+#define T0 1716033600u // 2024-05-18T12:00:00Z
+
+static esp_err_t discard(const char *data, size_t len, void *ctx) {
+  return ESP_OK;
+}
+
+int main(int argc, char **argv) {
+  uint32_t records = (uint32_t)bench_iterations(argc, argv, 200000);
+  const char *dir = scratch_enter();
+  host_set_time_us(0);
+  CHECK_EQ(sd_logger_init(), ESP_OK);
+  for (uint32_t i = 0; i < records; i++) {
+    sd_log_record_t r = {T0 + i,           -228395173 + (int32_t)(i % 4000),
+                         -431149703 - (int32_t)(i % 3000), 250,
+                         1800 + i % 7,     (i * 13) % 36000, 9, 9, 0x07, 0};
+    r.crc8 = sd_log_crc8((const uint8_t *)&r, sizeof(r) - 1);
+    sd_logger_append_record(&r);
+    sd_logger_service();
+  }
+  sd_logger_flush();
+
+  static const char *names[] = {"gpx", "geojson", "csv", "bin"};
+  printf("%u records\n%-8s %10s %10s %12s %12s %10s\n", (unsigned)records,
+         "format", "B/record", "ns/record", "MB/s (sink)", "MB/s (HTTP)",
+         "heap peak");
+  for (int fmt = TRACK_EXPORT_GPX; fmt <= TRACK_EXPORT_BIN; fmt++) {
+    track_export_stats_t st;
+    int64_t t0 = host_now_ns();
+    track_export_stream(fmt, 0, UINT32_MAX, discard, NULL, &st);
+    double gen_ns = (double)(host_now_ns() - t0);
+
+    http_standin_t h;
+    http_standin_open(&h, NULL, 0);
+    size_t before = heap_live();
+    heap_reset_peak();
+    t0 = host_now_ns();
+    track_export_stream(fmt, 0, UINT32_MAX, http_standin_chunk, &h, &st);
+    http_standin_chunk(NULL, 0, &h);
+    http_standin_close(&h);
+    double http_ns = (double)(host_now_ns() - t0);
+    CHECK_EQ(st.records, records);
+    CHECK_EQ(h.body_len, st.bytes);
+
+    printf("%-8s %10.1f %10.0f %12.0f %12.0f %8zu B\n", names[fmt],
+           (double)st.bytes / records, gen_ns / records,
+           st.bytes / gen_ns * 1e3, st.bytes / http_ns * 1e3,
+           heap_peak() - before);
+  }
+  scratch_leave(dir);
+  return test_result("bench_track_export");
+}
@@ -0,0 +1,55 @@
+// track_simplify_push() cost and compression at the default tolerance
+// (TRACK_SIMPLIFY_TOL_M) on the 1 Hz NMEA capture and the synthetic tracks
+// of track_gen.c. Every push scans the window, so the cost grows with the
+// fixes held since the last emitted one.
+// Usage: bench_track_simplify [passes]
+#include "gps_parser.h"
+#include "test_util.h"
+#include "track_gen.h"
+#include "track_simplify.h"
+
+#define FIXES 20000
+
+static sd_log_record_t fixes[FIXES];
+
+static void run(const char *name, size_t n, int passes) {
+  track_simplifier_t s;
+  sd_log_record_t out;
+  int64_t t0 = host_now_ns();
+  for (int p = 0; p < passes; p++) {
+    track_simplify_init(&s, TRACK_SIMPLIFY_TOL_M, TRACK_SIMPLIFY_KEEPALIVE_S);
+    for (size_t i = 0; i < n; i++)
+      track_simplify_push(&s, &fixes[i], &out);
+    track_simplify_flush(&s, &out);
+  }
+  double ns = (double)(host_now_ns() - t0) / passes / n;
+  uint32_t ratio = track_simplify_ratio_x100(&s.stats);
+  printf("%-10s %6zu %6u %5u.%02u:1 %8.0f\n", name, n, s.stats.out,
+         ratio / 100, ratio % 100, ns);
+  CHECK(s.stats.out >= 2);
+}
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 20);
+  printf("tolerance %d m, keepalive %d s\n", TRACK_SIMPLIFY_TOL_M,
+         TRACK_SIMPLIFY_KEEPALIVE_S);
+  printf("%-10s %6s %6s %8s %8s\n", "track", "in", "out", "ratio", "ns/fix");
+
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines), count = 0;
+  for (size_t i = 0; i < n && count < FIXES; i++) {
+    gps_parse_nmea(lines[i]);
+    if (strncmp(lines[i] + 3, "GGA", 3) == 0 &&
+        sd_log_record_from_gps(gps_get_data(), &fixes[count]))
+      count++;
+  }
+  free(lines);
+  free(text);
+  run("capture", count, passes * 30);
+
+  for (int shape = 0; shape < TRACK_GEN_SHAPES; shape++) {
+    track_gen(shape, FIXES, fixes);
+    run(track_gen_name(shape), FIXES, passes);
+  }
+  return test_result("bench_track_simplify");
+}
@@ -0,0 +1,51 @@
+// trip_stats_update() over the 5 h day of trip_gen, then the reader side:
+// the sequence-locked copy the OLED page takes and the /api/stats JSON.
+// Usage: bench_trip_stats [passes]
+#include "test_util.h"
+#include "trip_gen.h"
+#include "trip_stats.h"
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 20);
+  static trip_gen_fix_t fixes[TRIP_GEN_FIXES];
+  trip_gen(fixes, NULL);
+  host_nvs_reset();
+  CHECK_EQ(trip_stats_init(), ESP_OK);
+
+  // Each pass is another day, so time keeps moving forward
+  int64_t t0 = host_now_ns();
+  for (int p = 0; p < passes; p++) {
+    uint32_t day = (uint32_t)p * 86400;
+    for (size_t i = 0; i < TRIP_GEN_FIXES; i++) {
+      const trip_gen_fix_t *f = &fixes[i];
+      trip_stats_update(f->time + day, f->lat_e7, f->lon_e7, f->speed_ckmh);
+    }
+  }
+  double update_ns = (double)(host_now_ns() - t0) / passes / TRIP_GEN_FIXES;
+
+  trip_stats_t st;
+  uint32_t sum = 0;
+  int reads = passes * 100000;
+  t0 = host_now_ns();
+  for (int i = 0; i < reads; i++) {
+    trip_stats_get(&st);
+    sum += st.trip.moving_s & 1;
+  }
+  double read_ns = (double)(host_now_ns() - t0) / reads;
+
+  char json[256];
+  size_t len = 0;
+  int jsons = passes * 10000;
+  t0 = host_now_ns();
+  for (int i = 0; i < jsons; i++)
+    len = trip_stats_json(&st, json, sizeof(json));
+  double json_ns = (double)(host_now_ns() - t0) / jsons;
+
+  printf("%d fixes x %d: update %.1f ns, get %.1f ns, JSON %.0f ns (%zu B)\n",
+         TRIP_GEN_FIXES, passes, update_ns, read_ns, json_ns, len);
+  printf("odometer %.3f km over %u fixes\n", st.odometer_cm / 1e5,
+         (unsigned)st.fixes);
+  CHECK(len > 0 && sum <= (uint32_t)reads);
+  CHECK_EQ(st.fixes, (uint32_t)passes * TRIP_GEN_FIXES);
+  return test_result("bench_trip_stats");
+}
@@ -0,0 +1,79 @@
+// Cost and UART load of one fix epoch over UBX (NAV-PVT + NAV-DOP through
+// ubx_decoder_feed() and ubx_apply_frame()) against NMEA (the multi-GNSS
+// capture through nmea_framer_feed() and gps_parse_nmea()).
+// Usage: bench_ubx [passes]
+#include "gps_parser.h"
+#include "nmea.h"
+#include "test_util.h"
+#include "ubx.h"
+
+static gps_data_t ubx_gps;
+// Fix epochs seen: a NAV-PVT that applied, or the ZDA closing each NMEA
+// second
+static uint32_t ubx_epochs, nmea_epochs;
+
+static void ubx_apply(uint8_t cls, uint8_t id, const uint8_t *p,
+                      uint16_t len, void *ctx) {
+  if (ubx_apply_frame(cls, id, p, len, &ubx_gps) && id == UBX_ID_NAV_PVT)
+    ubx_epochs++;
+}
+
+static void nmea_apply(const char *sentence, void *ctx) {
+  gps_parse_nmea(sentence);
+  if (strncmp(sentence + 3, "ZDA", 3) == 0)
+    nmea_epochs++;
+}
+
+// Feeds the capture in 128-byte reads, like the UART event loop
+static double ubx_pass(const uint8_t *data, size_t len, int passes) {
+  ubx_decoder_t dec;
+  int64_t t0 = host_now_ns();
+  for (int p = 0; p < passes; p++) {
+    ubx_decoder_init(&dec);
+    for (size_t pos = 0; pos < len; pos += 128)
+      ubx_decoder_feed(&dec, data + pos, len - pos < 128 ? len - pos : 128,
+                       ubx_apply, NULL);
+  }
+  return (double)(host_now_ns() - t0) / passes;
+}
+
+static double nmea_pass(const uint8_t *data, size_t len, int passes) {
+  nmea_framer_t fr;
+  int64_t t0 = host_now_ns();
+  for (int p = 0; p < passes; p++) {
+    nmea_framer_init(&fr);
+    for (size_t pos = 0; pos < len; pos += 128)
+      nmea_framer_feed(&fr, data + pos, len - pos < 128 ? len - pos : 128,
+                       nmea_apply, NULL);
+  }
+  return (double)(host_now_ns() - t0) / passes;
+}
+
+int main(int argc, char **argv) {
+  int passes = bench_iterations(argc, argv, 50);
+  size_t ubx_len, nmea_len;
+  uint8_t *ubx = (uint8_t *)fixture_load("nav_10hz.ubx", &ubx_len);
+  uint8_t *nmea = (uint8_t *)fixture_load("gnss_1hz.nmea", &nmea_len);
+
+  ubx_pass(ubx, ubx_len, 1);
+  nmea_pass(nmea, nmea_len, 1);
+  uint32_t ubx_n = ubx_epochs, nmea_n = nmea_epochs;
+  CHECK_EQ(ubx_n, 1199); // one corrupted NAV-PVT is dropped
+  CHECK_EQ(nmea_n, 600);
+
+  double ubx_ns = ubx_pass(ubx, ubx_len, passes) / ubx_n;
+  double nmea_ns = nmea_pass(nmea, nmea_len, passes) / nmea_n;
+  double ubx_bytes = (double)ubx_len / ubx_n;
+  double nmea_bytes = (double)nmea_len / nmea_n;
+  printf("%-28s %8s %10s %14s\n", "", "ns/epoch", "bytes/epoch",
+         "UART at 10 Hz");
+  printf("%-28s %8.0f %10.0f %9.0f B/s\n", "UBX NAV-PVT+DOP (+NAV-SAT)",
+         ubx_ns, ubx_bytes, ubx_bytes * 10);
+  printf("%-28s %8.0f %10.0f %9.0f B/s\n", "NMEA GN 15 sentences", nmea_ns,
+         nmea_bytes, nmea_bytes * 10);
+  printf("115200 baud carries 11520 B/s; 9600 baud 960 B/s\n");
+
+  free(ubx);
+  free(nmea);
+  return test_result("bench_ubx");
+}
@@ -0,0 +1,83 @@
+// Random geofences and their reference test, see fence_gen.h
+#include "fence_gen.h"
+#include <math.h>
+#include <stdio.h>
+
+#define M_PER_DEG 111320.0 // as geofence.c: 1e-7 degree is 1.1132 cm
+
+static uint32_t lcg;
+
+static double uniform(double lo, double hi) {
+  lcg = lcg * 1103515245u + 12345u;
+  return lo + (hi - lo) * ((lcg >> 8) / 16777216.0);
+}
+
+static double round_e7(double deg) { return round(deg * 1e7) / 1e7; }
+
+size_t fence_gen(uint32_t seed, int count, gen_fence_t *fences, char *text,
+                 size_t cap) {
+  lcg = seed;
+  size_t len = 0;
+  double cos_lat = cos((FENCE_GEN_LAT0 + FENCE_GEN_LAT1) / 2 * M_PI / 180);
+  for (int i = 0; i < count; i++) {
+    gen_fence_t *f = &fences[i];
+    double r = uniform(10, 150);
+    f->lat = round_e7(uniform(FENCE_GEN_LAT0, FENCE_GEN_LAT1));
+    f->lon = round_e7(uniform(FENCE_GEN_LON0, FENCE_GEN_LON1));
+    f->circle = i % 2 == 0;
+    int n;
+    if (f->circle) {
+      f->radius_m = round(r);
+      f->count = 0;
+      n = snprintf(text + len, cap - len, "C,zone %d,%.7f,%.7f,%.0f\n", i,
+                   f->lat, f->lon, f->radius_m);
+    } else {
+      // Vertices at increasing angles with random radii: a simple polygon
+      f->count = 3 + (int)uniform(0, FENCE_GEN_MAX_VERTS - 2);
+      n = snprintf(text + len, cap - len, "P,area %d", i);
+      for (int k = 0; k < f->count && n > 0 && len + n < cap; k++) {
+        double a = 2 * M_PI * (k + uniform(0.1, 0.9)) / f->count;
+        double rk = r * uniform(0.3, 1.0);
+        f->vlat[k] = round_e7(f->lat + rk * sin(a) / M_PER_DEG);
+        f->vlon[k] = round_e7(f->lon + rk * cos(a) / (M_PER_DEG * cos_lat));
+        n += snprintf(text + len + n, cap - len - n, ",%.7f,%.7f", f->vlat[k],
+                      f->vlon[k]);
+      }
+      if (n > 0 && len + n < cap)
+        n += snprintf(text + len + n, cap - len - n, "\n");
+    }
+    if (n <= 0 || len + n >= cap)
+      return 0;
+    len += n;
+  }
+  return len;
+}
+
+static double seg_dist(double px, double py, double ax, double ay, double bx,
+                       double by) {
+  double dx = bx - ax, dy = by - ay, l = dx * dx + dy * dy;
+  double t = l > 0 ? ((px - ax) * dx + (py - ay) * dy) / l : 0;
+  t = t < 0 ? 0 : t > 1 ? 1 : t;
+  return hypot(ax + t * dx - px, ay + t * dy - py);
+}
+
+bool fence_gen_contains(const gen_fence_t *f, double lat, double lon,
+                        double ref_lat, double *edge_m) {
+  double k = cos(ref_lat * M_PI / 180);
+  if (f->circle) {
+    double d = hypot((lon - f->lon) * k, lat - f->lat) * M_PER_DEG;
+    *edge_m = fabs(d - f->radius_m);
+    return d <= f->radius_m;
+  }
+  bool in = false;
+  double px = lon * k * M_PER_DEG, py = lat * M_PER_DEG;
+  *edge_m = INFINITY;
+  for (int i = 0, j = f->count - 1; i < f->count; j = i++) {
+    double xi = f->vlon[i] * k * M_PER_DEG, yi = f->vlat[i] * M_PER_DEG;
+    double xj = f->vlon[j] * k * M_PER_DEG, yj = f->vlat[j] * M_PER_DEG;
+    *edge_m = fmin(*edge_m, seg_dist(px, py, xi, yi, xj, yj));
+    if ((yi > py) != (yj > py) && px < xi + (xj - xi) * (py - yi) / (yj - yi))
+      in = !in;
+  }
+  return in;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Random geofences over the harbour of the bundled extract, written as a
+// geofence definition and kept in degrees for a double-precision reference
+// that knows nothing of geofence.c's integer plane or grid.
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FENCE_GEN_MAX_VERTS 12
+
+// Area the fences and the random walk stay in, degrees
+#define FENCE_GEN_LAT0 -22.8560
+#define FENCE_GEN_LAT1 -22.8290
+#define FENCE_GEN_LON0 -43.1190
+#define FENCE_GEN_LON1 -43.0930
+
+typedef struct {
+  bool circle;
+  double lat, lon, radius_m; // circle
+  int count;                 // polygon vertices (star-shaped, may be concave)
+  double vlat[FENCE_GEN_MAX_VERTS], vlon[FENCE_GEN_MAX_VERTS];
+} gen_fence_t;
+
+// Function prototypes
+// `count` fences, half circles, 20-300 m across; returns the text length
+// (0 if `cap` is too small). Coordinates are rounded to 1e-7 degree in both
+// views.
+size_t fence_gen(uint32_t seed, int count, gen_fence_t *fences, char *text,
+                 size_t cap);
+// Containment in a local plane around `ref_lat`; *edge_m is the distance to
+// the fence boundary, so callers can ignore points on the edge
+bool fence_gen_contains(const gen_fence_t *f, double lat, double lon,
+                        double ref_lat, double *edge_m);
@@ -0,0 +1,428 @@
+#!/usr/bin/env python3
+"""Generate the receiver captures the host tests replay.
+
+There is no way to record a receiver in CI, so the captures are simulated:
+a boat loop inside the bounds of "map(1).osm" (Niteroi), sampled like the
+receivers the firmware supports, with the sentence mix, field formats and
+error behaviour of real logs. The random source has a fixed seed, so every
+run writes the same bytes.
+
+Position error is a first-order Gauss-Markov process (the slowly wandering
+bias of a real fix, GM_SIGMA_M over GM_TAU_S) plus white noise.
+
+Outputs (in the directory given on the command line):
+  gp_1hz.nmea   NEO-6M style GPS-only log, 1 Hz, 10 min: RMC, VTG, GGA, GSA,
+                GSV, GLL per second, CRLF line ends
+  gnss_1hz.nmea u-blox M8 NMEA 4.10 multi-GNSS log, 1 Hz, 10 min: GNRMC,
+                GNVTG, GNGGA, one GNGSA per system (GPS, GLONASS, Galileo),
+                GPGSV/GLGSV/GAGSV with signal ids, GNGLL, GNZDA
+  nav_10hz.ubx  UBX-only log after ubx_build_config(), 10 Hz, 2 min:
+                NAV-PVT and NAV-DOP every epoch, NAV-SAT (longer than the
+                decoder keeps) every second, an ACK-ACK, baud-switch garbage
+                in front and one frame with a flipped payload byte
+  nav_10hz.csv  the NAV-PVT fields written to nav_10hz.ubx, one row per
+                good frame, for the decoder test
+  filter_1h.csv the loop for an hour at 10 Hz: truth, then a receiver fix
+                with the usual error plus multipath jumps (15-50 m for
+                1-3 s, about every two minutes), HDOP, speed and course;
+                for the Kalman filter replay
+  seamarks.osm  a regional OSM extract around Guanabara Bay, ~40 x 30 km:
+                SEAMARKS buoys, beacons, wrecks, lights and moorings (half
+                of them named) and the coastline as a frame, for the map
+                index test (built into seamarks.bin by tools/osm2tiles.py)
+
+Usage: python3 gen_fixtures.py <output dir>
+"""
+
+import math
+import os
+import random
+import struct
+import sys
+
+SEED = 20240518
+START = 12 * 3600  # 12:00:00 UTC
+DATE = "180524"    # DDMMYY
+GM_SIGMA_M = 2.5
+GM_TAU_S = 60.0
+WHITE_SIGMA_M = 1.2
+# Loop through the extract's bounds, lat/lon degrees
+WAYPOINTS = [
+    (-22.83950, -43.11500), (-22.83400, -43.11350), (-22.83200, -43.10700),
+    (-22.83550, -43.10350), (-22.83950, -43.10500), (-22.84000, -43.11000),
+]
+EARTH_M = 6371008.8
+SEAMARKS = 5000
+SEAMARK_TYPES = ["buoy_lateral", "buoy_cardinal", "beacon_lateral",
+                 "beacon_special_purpose", "wreck", "light_minor",
+                 "mooring", "rock"]
+
+
+def checksum(body):
+    c = 0
+    for ch in body.encode():
+        c ^= ch
+    return "%02X" % c
+
+
+def sentence(body):
+    return "$%s*%s\r\n" % (body, checksum(body))
+
+
+def route(dt, duration):
+    """Truth at every dt: (t, lat, lon, alt_m, speed_ms, course_deg).
+    Cruises at 5 m/s, slows into each waypoint and waits 30 s at the
+    first one on every lap."""
+    states = []
+    leg, pos, wait = 0, WAYPOINTS[0], 0.0
+    speed = 0.0
+    for i in range(round(duration / dt)):
+        t = round(i * dt, 3)
+        a, b = WAYPOINTS[leg], WAYPOINTS[(leg + 1) % len(WAYPOINTS)]
+        north = (b[0] - pos[0]) * math.pi / 180 * EARTH_M
+        east = ((b[1] - pos[1]) * math.pi / 180 * EARTH_M *
+                math.cos(math.radians(pos[0])))
+        dist = math.hypot(north, east)
+        course = math.degrees(math.atan2(east, north)) % 360
+        target = 0.0 if wait > 0 else min(5.0, 0.3 + dist / 8)
+        speed += max(-0.5 * dt, min(0.5 * dt, target - speed))
+        if wait > 0:
+            wait -= dt
+        step = speed * dt
+        if step >= dist:
+            pos = b
+            leg = (leg + 1) % len(WAYPOINTS)
+            if leg == 0:
+                wait = 30.0
+        else:
+            f = step / dist
+            pos = (pos[0] + (b[0] - pos[0]) * f, pos[1] + (b[1] - pos[1]) * f)
+        alt = 4.0 + 0.5 * math.sin(t / 40)
+        states.append((t, pos[0], pos[1], alt, speed, course))
+    return states
+
+
+def measure(states, rng, dt):
+    """Adds the receiver's position error; returns (truth, measured) pairs."""
+    beta = math.exp(-dt / GM_TAU_S)
+    drive = GM_SIGMA_M * math.sqrt(1 - beta * beta)
+    bn = be = bu = 0.0
+    out = []
+    for s in states:
+        t, lat, lon, alt, speed, course = s
+        bn = beta * bn + rng.gauss(0, drive)
+        be = beta * be + rng.gauss(0, drive)
+        bu = beta * bu + rng.gauss(0, drive * 1.5)
+        dn = bn + rng.gauss(0, WHITE_SIGMA_M)
+        de = be + rng.gauss(0, WHITE_SIGMA_M)
+        mlat = lat + math.degrees(dn / EARTH_M)
+        mlon = lon + math.degrees(de / (EARTH_M * math.cos(math.radians(lat))))
+        mspeed = max(0.0, speed + rng.gauss(0, 0.05))
+        mcourse = (course + rng.gauss(0, 1.0 if speed > 0.5 else 30.0)) % 360
+        out.append((s, (t, mlat, mlon, alt + bu, mspeed, mcourse)))
+    return out
+
+
+class Sky:
+    """Satellites drifting across the sky, per constellation."""
+
+    def __init__(self, rng, talker, prns):
+        self.talker = talker
+        self.sats = [[prn, rng.uniform(5, 85), rng.uniform(0, 359),
+                      rng.uniform(-0.01, 0.01)] for prn in prns]
+
+    def tick(self, dt):
+        for s in self.sats:
+            s[1] = min(88.0, max(2.0, s[1] + s[3] * dt))
+            s[2] = (s[2] + 0.002 * dt) % 360
+
+    def snr(self, s):
+        return int(18 + s[1] * 0.3) if s[1] > 8 else 0
+
+    def used(self):
+        return [s[0] for s in self.sats if self.snr(s)][:12]
+
+
+def hhmmss(t, decimals):
+    t = START + t
+    h, rem = divmod(int(t), 3600)
+    m, s = divmod(rem, 60)
+    frac = t - int(t)
+    out = "%02d%02d%02d" % (h % 24, m, s)
+    if decimals:
+        out += ".%0*d" % (decimals, round(frac * 10 ** decimals))
+    return out
+
+
+def lat_field(lat, digits):
+    a = abs(lat)
+    d = int(a)
+    return "%02d%0*.*f,%s" % (d, digits + 3, digits, (a - d) * 60,
+                              "S" if lat < 0 else "N")
+
+
+def lon_field(lon, digits):
+    a = abs(lon)
+    d = int(a)
+    return "%03d%0*.*f,%s" % (d, digits + 3, digits, (a - d) * 60,
+                              "W" if lon < 0 else "E")
+
+
+def hdop_for(sky):
+    return max(0.6, 3.5 - 0.25 * len(sky.used()))
+
+
+def gga(talker, m, sky_used, hdop, time_dec, ll_digits):
+    t, lat, lon, alt = m[:4]
+    return sentence("%sGGA,%s,%s,%s,1,%02d,%.2f,%.1f,M,-5.4,M,," % (
+        talker, hhmmss(t, time_dec), lat_field(lat, ll_digits),
+        lon_field(lon, ll_digits), sky_used, hdop, alt))
+
+
+def rmc(talker, m, time_dec, ll_digits, mode=None):
+    t, lat, lon, _, speed, course = m
+    body = "%sRMC,%s,A,%s,%s,%.3f,%s,%s,," % (
+        talker, hhmmss(t, time_dec), lat_field(lat, ll_digits),
+        lon_field(lon, ll_digits), speed * 3600 / 1852,
+        "%.2f" % course if speed > 0.3 else "", DATE)
+    if mode:
+        body += "," + mode
+    return sentence(body)
+
+
+def vtg(talker, m):
+    speed, course = m[4], m[5]
+    c = "%.2f" % course if speed > 0.3 else ""
+    return sentence("%sVTG,%s,T,,M,%.3f,N,%.3f,K,A" % (
+        talker, c, speed * 3600 / 1852, speed * 3.6))
+
+
+def gsa(talker, used, hdop, system=None):
+    prns = ["%02d" % p for p in used] + [""] * (12 - len(used))
+    body = "%sGSA,A,3,%s,%.2f,%.2f,%.2f" % (
+        talker, ",".join(prns), hdop * 1.6, hdop, hdop * 1.3)
+    if system is not None:
+        body += ",%d" % system
+    return sentence(body)
+
+
+def gsv(sky, talker=None, signal=None):
+    talker = talker or sky.talker
+    sats = sky.sats
+    total = (len(sats) + 3) // 4
+    out = []
+    for i in range(total):
+        chunk = sats[i * 4:i * 4 + 4]
+        fields = []
+        for prn, el, az, _ in chunk:
+            snr = sky.snr([prn, el, az, 0])
+            fields.append("%02d,%02d,%03d,%s" % (prn, el, az,
+                                                 "%02d" % snr if snr else ""))
+        body = "%sGSV,%d,%d,%02d,%s" % (talker, total, i + 1, len(sats),
+                                        ",".join(fields))
+        if signal is not None:
+            body += ",%d" % signal
+        out.append(sentence(body))
+    return out
+
+
+def gll(talker, m, time_dec, ll_digits):
+    t, lat, lon = m[:3]
+    return sentence("%sGLL,%s,%s,%s,A,A" % (
+        talker, lat_field(lat, ll_digits), lon_field(lon, ll_digits),
+        hhmmss(t, time_dec)))
+
+
+def write_gp_1hz(path, rng):
+    sky = Sky(rng, "GP", [2, 5, 7, 9, 13, 15, 18, 20, 23, 26, 29, 30])
+    with open(path, "w", newline="") as f:
+        for _, m in measure(route(1.0, 600), rng, 1.0):
+            used = sky.used()
+            hdop = hdop_for(sky)
+            f.write(rmc("GP", m, 2, 5, "A"))
+            f.write(vtg("GP", m))
+            f.write(gga("GP", m, len(used), hdop, 2, 5))
+            f.write(gsa("GP", used, hdop))
+            for s in gsv(sky):
+                f.write(s)
+            f.write(gll("GP", m, 2, 5))
+            sky.tick(1.0)
+
+
+def zda(talker, m):
+    return sentence("%sZDA,%s,%s,%s,20%s,00,00" % (
+        talker, hhmmss(m[0], 2), DATE[0:2], DATE[2:4], DATE[4:6]))
+
+
+def write_gnss_1hz(path, rng):
+    skies = [Sky(rng, "GP", [2, 5, 7, 9, 13, 15, 18, 20, 23, 26, 29]),
+             Sky(rng, "GL", [65, 66, 72, 73, 74, 80, 81, 82]),
+             Sky(rng, "GA", [3, 5, 8, 13, 15, 21, 26])]
+    with open(path, "w", newline="") as f:
+        for _, m in measure(route(1.0, 600), rng, 1.0):
+            used = [sky.used() for sky in skies]
+            hdop = max(0.5, 2.5 - 0.08 * sum(len(u) for u in used))
+            f.write(rmc("GN", m, 2, 5, "A,V"))
+            f.write(vtg("GN", m))
+            f.write(gga("GN", m, min(12, sum(len(u) for u in used)), hdop,
+                        2, 5))
+            for system, u in enumerate(used, 1):
+                f.write(gsa("GN", u, hdop, system))
+            for sky, signal in zip(skies, (1, 1, 7)):
+                for s in gsv(sky, signal=signal):
+                    f.write(s)
+            f.write(gll("GN", m, 2, 5))
+            f.write(zda("GN", m))
+            for sky in skies:
+                sky.tick(1.0)
+
+
+def ubx_frame(cls, mid, payload):
+    body = struct.pack("<BBH", cls, mid, len(payload)) + payload
+    a = b = 0
+    for c in body:
+        a = (a + c) & 0xFF
+        b = (b + a) & 0xFF
+    return b"\xb5\x62" + body + bytes((a, b))
+
+
+def nav_pvt(m, num_sv, pdop, rng):
+    """NAV-PVT payload and the decoded fields the CSV expects."""
+    t, lat, lon, alt, speed, course = m
+    itow = (6 * 86400 + START) * 1000 + round(t * 1000)  # Saturday
+    whole = START + int(t + 1e-9)
+    frac_ms = round((t - int(t + 1e-9)) * 1000)
+    nano = frac_ms * 1000000 + rng.randint(-20000, 20000)
+    lat_e7, lon_e7 = round(lat * 1e7), round(lon * 1e7)
+    hmsl_mm = round(alt * 1000)
+    gspeed = round(speed * 1000)
+    rad = math.radians(course)
+    head_e5 = round(course * 1e5) % 36000000
+    p = struct.pack(
+        "<IHBBBBBBIiBBBBiiiiIIiiiiiIIHBBBBBBiHH", itow, 2024, 5, 18,
+        whole // 3600 % 24, whole // 60 % 60, whole % 60, 0x07, 30, nano,
+        3, 0x01, 0, num_sv, lon_e7, lat_e7, hmsl_mm - 5400, hmsl_mm, 1500,
+        2500, round(gspeed * math.cos(rad)), round(gspeed * math.sin(rad)),
+        0, gspeed, head_e5, 300, 80000, round(pdop * 100), 0, 0, 0, 0, 0, 0,
+        0, 0, 0)
+    assert len(p) == 92
+    row = (itow, lat_e7, lon_e7, hmsl_mm, gspeed, head_e5, num_sv,
+           "%02d%02d%02d" % (whole // 3600 % 24, whole // 60 % 60,
+                             whole % 60), frac_ms)
+    return p, row
+
+
+def nav_dop(itow, pdop, hdop, vdop):
+    return struct.pack("<I7H", itow, round(pdop * 130), round(pdop * 100),
+                       80, round(vdop * 100), round(hdop * 100), 70, 60)
+
+
+def nav_sat(itow, sky):
+    p = struct.pack("<IBBxx", itow, 1, len(sky.sats))
+    for prn, el, az, _ in sky.sats:
+        p += struct.pack("<BBBbhhi", 0, prn, sky.snr([prn, el, az, 0]),
+                         int(el), int(az), 0, 0x1F)
+    return p
+
+
+def write_nav_10hz(ubx_path, csv_path, rng):
+    sky = Sky(rng, "GP", list(range(1, 25)))
+    out = bytearray(bytes(rng.randrange(256) for _ in range(37)))
+    out += ubx_frame(0x05, 0x01, bytes((0x06, 0x00)))  # ACK-ACK CFG-PRT
+    rows = []
+    for i, (_, m) in enumerate(measure(route(0.1, 120), rng, 0.1)):
+        used = len(sky.used())
+        pdop = max(0.8, 3.0 - 0.1 * used)
+        pvt, row = nav_pvt(m, used, pdop, rng)
+        frame = bytearray(ubx_frame(0x01, 0x07, pvt))
+        if i == 500:
+            frame[40] ^= 0x10  # corrupt: checksum no longer matches
+        else:
+            rows.append(row)
+        out += frame
+        out += ubx_frame(0x01, 0x04, nav_dop(row[0], pdop, pdop * 0.6,
+                                             pdop * 0.8))
+        if i % 10 == 9:
+            out += ubx_frame(0x01, 0x35, nav_sat(row[0], sky))
+            sky.tick(1.0)
+    with open(ubx_path, "wb") as f:
+        f.write(out)
+    with open(csv_path, "w") as f:
+        f.write("itow,lat_e7,lon_e7,hmsl_mm,gspeed_mms,headmot_e5,numsv,"
+                "time,ms\n")
+        for row in rows:
+            f.write(",".join(str(v) for v in row) + "\n")
+
+
+def write_seamarks(path, rng):
+    lat0, lon0, lat1, lon1 = -23.05, -43.35, -22.75, -42.95
+    with open(path, "w") as f:
+        f.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+                '<osm version="0.6" generator="gen_fixtures.py">\n')
+        corners = [(lat0, lon0), (lat0, lon1), (lat1, lon1), (lat1, lon0)]
+        for i, (lat, lon) in enumerate(corners, 1):
+            f.write(' <node id="%d" lat="%.7f" lon="%.7f"/>\n' % (i, lat, lon))
+        # Clustered like real marks: channels and harbours, some spread out
+        centres = [(rng.uniform(lat0, lat1), rng.uniform(lon0, lon1))
+                   for _ in range(40)]
+        for i in range(SEAMARKS):
+            if rng.random() < 0.8:
+                clat, clon = rng.choice(centres)
+                lat = min(lat1, max(lat0, rng.gauss(clat, 0.01)))
+                lon = min(lon1, max(lon0, rng.gauss(clon, 0.01)))
+            else:
+                lat, lon = rng.uniform(lat0, lat1), rng.uniform(lon0, lon1)
+            f.write(' <node id="%d" lat="%.7f" lon="%.7f">\n'
+                    '  <tag k="seamark:type" v="%s"/>\n'
+                    % (100 + i, lat, lon, rng.choice(SEAMARK_TYPES)))
+            if i % 2 == 0:
+                f.write('  <tag k="seamark:name" v="Mark %d"/>\n' % i)
+            f.write(' </node>\n')
+        f.write(' <way id="1">\n')
+        for ref in (1, 2, 3, 4, 1):
+            f.write('  <nd ref="%d"/>\n' % ref)
+        f.write('  <tag k="natural" v="coastline"/>\n </way>\n</osm>\n')
+
+
+def write_filter_1h(path, rng):
+    jump_n = jump_e = 0.0
+    jump_left = 0
+    with open(path, "w") as f:
+        f.write("t_ms,true_lat_e7,true_lon_e7,true_speed_mms,lat_e7,lon_e7,"
+                "hdop_e2,speed_ckmh,course_cdeg\n")
+        for truth, m in measure(route(0.1, 3600), rng, 0.1):
+            t, lat, lon = m[0], m[1], m[2]
+            if jump_left == 0 and rng.random() < 1 / 1200:
+                a, d = rng.uniform(0, 2 * math.pi), rng.uniform(15, 50)
+                jump_n, jump_e = d * math.cos(a), d * math.sin(a)
+                jump_left = rng.randint(10, 30)
+            if jump_left:
+                jump_left -= 1
+                lat += math.degrees(jump_n / EARTH_M)
+                lon += math.degrees(jump_e / (EARTH_M *
+                                              math.cos(math.radians(lat))))
+            hdop = 0.9 + 0.3 * math.sin(t / 300)
+            f.write("%d,%d,%d,%d,%d,%d,%d,%d,%d\n" % (
+                round(t * 1000), round(truth[1] * 1e7), round(truth[2] * 1e7),
+                round(truth[4] * 1000), round(lat * 1e7), round(lon * 1e7),
+                round(hdop * 100), round(m[4] * 360),
+                round(m[5] * 100) % 36000))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__.strip().splitlines()[-1])
+    out = sys.argv[1]
+    os.makedirs(out, exist_ok=True)
+    write_gp_1hz(os.path.join(out, "gp_1hz.nmea"), random.Random(SEED))
+    write_gnss_1hz(os.path.join(out, "gnss_1hz.nmea"),
+                   random.Random(SEED + 1))
+    write_nav_10hz(os.path.join(out, "nav_10hz.ubx"),
+                   os.path.join(out, "nav_10hz.csv"), random.Random(SEED + 2))
+    write_seamarks(os.path.join(out, "seamarks.osm"), random.Random(SEED + 3))
+    write_filter_1h(os.path.join(out, "filter_1h.csv"),
+                    random.Random(SEED + 4))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,53 @@
+// Heap accounting for the host tests, see heap_wrap.h
+#include "heap_wrap.h"
+#include <malloc.h>
+#include <stdatomic.h>
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+void __real_free(void *p);
+
+static atomic_size_t live, peak;
+
+static void account(void *p, int sign) {
+  if (!p)
+    return;
+  size_t n = malloc_usable_size(p);
+  if (sign < 0) {
+    atomic_fetch_sub(&live, n);
+    return;
+  }
+  size_t now = atomic_fetch_add(&live, n) + n;
+  size_t old = atomic_load(&peak);
+  while (now > old && !atomic_compare_exchange_weak(&peak, &old, now))
+    ;
+}
+
+void *__wrap_malloc(size_t size) {
+  void *p = __real_malloc(size);
+  account(p, 1);
+  return p;
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+  void *p = __real_calloc(n, size);
+  account(p, 1);
+  return p;
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+  account(p, -1);
+  void *q = __real_realloc(p, size);
+  account(q ? q : p, 1);
+  return q;
+}
+
+void __wrap_free(void *p) {
+  account(p, -1);
+  __real_free(p);
+}
+
+size_t heap_live(void) { return atomic_load(&live); }
+size_t heap_peak(void) { return atomic_load(&peak); }
+void heap_reset_peak(void) { atomic_store(&peak, atomic_load(&live)); }
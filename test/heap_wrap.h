@@ -0,0 +1,13 @@
+#pragma once
+
+// Live and peak heap bytes of the process, counted through the linker's
+// --wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free (see heap_wrap()
+// in CMakeLists.txt). Sizes are malloc_usable_size(), so glibc rounding is
+// included.
+#include <stddef.h>
+
+// Function prototypes
+size_t heap_live(void);
+size_t heap_peak(void);
+// Restarts the peak from the current live bytes
+void heap_reset_peak(void);
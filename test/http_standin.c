@@ -0,0 +1,499 @@
+// HTTP server stand-in, see http_standin.h
+#include "http_standin.h"
+#include "host.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define MAX_HANDLERS 16
+#define MAX_SESSIONS 16
+#define MAX_WORK 16
+#define HDR_BYTES 512
+
+// The response state of a session's request, in httpd_req_t.aux
+typedef struct {
+  int fd;
+  const char *headers;
+  const char *status;
+  const char *type;
+  char extra[HDR_BYTES];
+  size_t extra_len;
+  bool head_sent;
+  bool chunked;
+} response_t;
+
+typedef struct {
+  bool used;
+  int fd; // server end
+  bool close_pending;
+  response_t resp;
+} session_t;
+
+typedef struct {
+  httpd_work_fn_t fn;
+  void *arg;
+} work_t;
+
+static int server_handle; // its address is the httpd_handle_t
+static httpd_config_t config;
+static httpd_uri_t handlers[MAX_HANDLERS];
+static int handler_count;
+static session_t sessions[MAX_SESSIONS];
+static work_t work[MAX_WORK];
+static uint32_t work_head, work_tail;
+static int sndbuf, rcvbuf;
+static http_standin_stats_t stats;
+
+static bool send_all(int fd, const char *data, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+    if (n <= 0)
+      return false;
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+// A connected loopback pair: *server and the returned client end
+static int connect_pair(int *server) {
+  int lfd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {.sin_family = AF_INET,
+                             .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+  socklen_t alen = sizeof(addr);
+  if (lfd < 0 || bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(lfd, 1) != 0 ||
+      getsockname(lfd, (struct sockaddr *)&addr, &alen) != 0) {
+    if (lfd >= 0)
+      close(lfd);
+    return -1;
+  }
+  int cfd = socket(AF_INET, SOCK_STREAM, 0);
+  // Before connect, so the advertised window follows it
+  if (cfd >= 0 && rcvbuf)
+    setsockopt(cfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  if (cfd >= 0 && connect(cfd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+    *server = accept(lfd, NULL, NULL);
+  close(lfd);
+  if (cfd < 0 || *server < 0) {
+    if (cfd >= 0)
+      close(cfd);
+    return -1;
+  }
+  int one = 1;
+  setsockopt(*server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (sndbuf)
+    setsockopt(*server, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+  return cfd;
+}
+
+static session_t *session_of(int fd) {
+  for (int i = 0; i < MAX_SESSIONS; i++)
+    if (sessions[i].used && sessions[i].fd == fd)
+      return &sessions[i];
+  return NULL;
+}
+
+// A free session on a new loopback pair, with a fresh response; returns
+// the client end, or -1
+static int session_open(session_t **out) {
+  session_t *s = NULL;
+  for (int i = 0; i < MAX_SESSIONS && !s; i++)
+    if (!sessions[i].used)
+      s = &sessions[i];
+  int server = -1, client = s ? connect_pair(&server) : -1;
+  if (client < 0)
+    return -1;
+  *s = (session_t){.used = true, .fd = server};
+  s->resp = (response_t){.fd = server, .status = "200 OK",
+                         .type = "text/html"};
+  stats.sessions++;
+  *out = s;
+  return client;
+}
+
+void http_standin_set_buffers(int snd, int rcv) {
+  sndbuf = snd;
+  rcvbuf = rcv;
+}
+
+int http_standin_request(int method, const char *uri, const char *headers,
+                          esp_err_t *ret) {
+  size_t path_len = strcspn(uri, "?");
+  const httpd_uri_t *h = NULL;
+  for (int i = 0; i < handler_count && !h; i++) {
+    if (handlers[i].method != (httpd_method_t)method)
+      continue;
+    bool match = config.uri_match_fn
+                     ? config.uri_match_fn(handlers[i].uri, uri, path_len)
+                     : strlen(handlers[i].uri) == path_len &&
+                           strncmp(handlers[i].uri, uri, path_len) == 0;
+    if (match)
+      h = &handlers[i];
+  }
+  session_t *s;
+  int client = h ? session_open(&s) : -1;
+  if (client < 0)
+    return -1;
+  stats.requests++;
+
+  s->resp.headers = headers;
+  httpd_req_t req = {.handle = &server_handle, .method = method, .uri = uri,
+                     .user_ctx = h->user_ctx, .aux = &s->resp};
+  esp_err_t r = h->handler(&req);
+  // As httpd does, a failed handler ends its session
+  if (r != ESP_OK)
+    s->close_pending = true;
+  if (ret)
+    *ret = r;
+  return client;
+}
+
+static void close_session(session_t *s) {
+  int fd = s->fd;
+  s->used = false;
+  stats.sessions--;
+  stats.closed++;
+  if (config.close_fn)
+    config.close_fn(&server_handle, fd);
+  else
+    close(fd);
+}
+
+int http_standin_run(void) {
+  int ran = 0;
+  // Work queued while this runs waits for the next pass
+  for (uint32_t end = work_tail; work_head != end; ran++) {
+    work_t w = work[work_head++ % MAX_WORK];
+    int64_t t0 = host_now_ns();
+    w.fn(w.arg);
+    stats.work_ns += host_now_ns() - t0;
+    stats.work++;
+  }
+  for (int i = 0; i < MAX_SESSIONS; i++) {
+    session_t *s = &sessions[i];
+    if (!s->used)
+      continue;
+    char b;
+    ssize_t n = recv(s->fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    bool hung_up = n == 0 || (n < 0 && errno != EAGAIN &&
+                              errno != EWOULDBLOCK);
+    if (s->close_pending || hung_up)
+      close_session(s);
+  }
+  return ran;
+}
+
+int http_standin_pending(void) { return (int)(work_tail - work_head); }
+
+void http_standin_get_stats(http_standin_stats_t *out) { *out = stats; }
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *cfg) {
+  config = *cfg;
+  handler_count = 0;
+  *handle = &server_handle;
+  return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
+                                     const httpd_uri_t *uri_handler) {
+  if (handler_count == MAX_HANDLERS ||
+      handler_count == config.max_uri_handlers)
+    return ESP_ERR_NO_MEM;
+  handlers[handler_count++] = *uri_handler;
+  return ESP_OK;
+}
+
+// Exact match, or a template ending in '*' that matches any rest
+bool httpd_uri_match_wildcard(const char *uri_template,
+                              const char *uri_to_match, size_t match_upto) {
+  size_t len = strlen(uri_template);
+  if (len && uri_template[len - 1] == '*')
+    return match_upto >= len - 1 &&
+           strncmp(uri_template, uri_to_match, len - 1) == 0;
+  return len == match_upto && strncmp(uri_template, uri_to_match, len) == 0;
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t fn,
+                           void *arg) {
+  if (work_tail - work_head == MAX_WORK)
+    return ESP_FAIL;
+  work[work_tail++ % MAX_WORK] = (work_t){fn, arg};
+  return ESP_OK;
+}
+
+int httpd_socket_send(httpd_handle_t hd, int sockfd, const char *buf,
+                      size_t buf_len, int flags) {
+  ssize_t n = send(sockfd, buf, buf_len, flags | MSG_NOSIGNAL);
+  if (n >= 0)
+    return (int)n;
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+    return HTTPD_SOCK_ERR_TIMEOUT;
+  return HTTPD_SOCK_ERR_FAIL;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd) {
+  session_t *s = session_of(sockfd);
+  if (!s)
+    return ESP_ERR_NOT_FOUND;
+  s->close_pending = true;
+  return ESP_OK;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r) {
+  return ((response_t *)r->aux)->fd;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf,
+                                      size_t buf_len) {
+  const char *q = strchr(r->uri, '?');
+  if (!q)
+    return ESP_ERR_NOT_FOUND;
+  size_t len = snprintf(buf, buf_len, "%s", q + 1);
+  return len < buf_len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val,
+                                size_t val_size) {
+  size_t key_len = strlen(key);
+  for (const char *p = qry; p && *p; p = strchr(p, '&'), p = p ? p + 1 : p) {
+    if (strncmp(p, key, key_len) != 0 || p[key_len] != '=')
+      continue;
+    const char *v = p + key_len + 1;
+    size_t len = strcspn(v, "&");
+    size_t n = len < val_size - 1 ? len : val_size - 1;
+    memcpy(val, v, n);
+    val[n] = '\0';
+    return n == len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field,
+                                      char *val, size_t val_size) {
+  const char *p = ((response_t *)r->aux)->headers;
+  size_t field_len = strlen(field);
+  for (; p && *p; p = strstr(p, "\r\n"), p = p ? p + 2 : p) {
+    if (strncasecmp(p, field, field_len) != 0 || p[field_len] != ':')
+      continue;
+    const char *v = p + field_len + 1;
+    v += strspn(v, " ");
+    size_t len = strcspn(v, "\r\n");
+    size_t n = len < val_size - 1 ? len : val_size - 1;
+    memcpy(val, v, n);
+    val[n] = '\0';
+    return n == len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status) {
+  ((response_t *)r->aux)->status = status;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+  ((response_t *)r->aux)->type = type;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field,
+                             const char *value) {
+  response_t *resp = r->aux;
+  int n = snprintf(resp->extra + resp->extra_len,
+                   sizeof(resp->extra) - resp->extra_len, "%s: %s\r\n", field,
+                   value);
+  if (n < 0 || resp->extra_len + n >= sizeof(resp->extra))
+    return ESP_ERR_HTTPD_RESULT_TRUNC;
+  resp->extra_len += n;
+  return ESP_OK;
+}
+
+// Status line and headers; `length` < 0 for a chunked body
+static bool send_head(response_t *resp, ssize_t length) {
+  char head[HDR_BYTES * 2];
+  int n = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\n%s",
+                   resp->status, resp->type, resp->extra);
+  if (length < 0)
+    n += snprintf(head + n, sizeof(head) - n,
+                  "Transfer-Encoding: chunked\r\n\r\n");
+  else
+    n += snprintf(head + n, sizeof(head) - n, "Content-Length: %zd\r\n\r\n",
+                  length);
+  resp->head_sent = true;
+  resp->chunked = length < 0;
+  return send_all(resp->fd, head, (size_t)n);
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+  response_t *resp = r->aux;
+  if (buf_len == HTTPD_RESP_USE_STRLEN)
+    buf_len = buf ? (ssize_t)strlen(buf) : 0;
+  if (resp->head_sent || !send_head(resp, buf_len) ||
+      !send_all(resp->fd, buf, (size_t)buf_len))
+    return ESP_FAIL;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf,
+                                ssize_t buf_len) {
+  response_t *resp = r->aux;
+  if (buf_len == HTTPD_RESP_USE_STRLEN)
+    buf_len = buf ? (ssize_t)strlen(buf) : 0;
+  if (!resp->head_sent && !send_head(resp, -1))
+    return ESP_FAIL;
+  if (!resp->chunked)
+    return ESP_FAIL;
+  char size[16];
+  int n = snprintf(size, sizeof(size), "%zx\r\n", buf_len);
+  if (!send_all(resp->fd, size, (size_t)n) ||
+      !send_all(resp->fd, buf, (size_t)buf_len) ||
+      !send_all(resp->fd, "\r\n", 2))
+    return ESP_FAIL;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str) {
+  return httpd_resp_send(r, str, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error,
+                              const char *msg) {
+  static const char *const status[] = {
+      [HTTPD_400_BAD_REQUEST] = "400 Bad Request",
+      [HTTPD_404_NOT_FOUND] = "404 Not Found",
+      [HTTPD_500_INTERNAL_SERVER_ERROR] = "500 Internal Server Error",
+      [HTTPD_503_SERVICE_UNAVAILABLE] = "503 Service Unavailable",
+  };
+  httpd_resp_set_status(req, status[error]);
+  httpd_resp_set_type(req, "text/plain");
+  return httpd_resp_sendstr(req, msg);
+}
+
+// Buffered reads on the client side
+typedef struct {
+  int fd;
+  char buf[16384];
+  size_t pos, len;
+} reader_t;
+
+static int read_byte(reader_t *r) {
+  if (r->pos == r->len) {
+    ssize_t n = recv(r->fd, r->buf, sizeof(r->buf), 0);
+    if (n <= 0)
+      return -1;
+    r->pos = 0;
+    r->len = (size_t)n;
+  }
+  return (unsigned char)r->buf[r->pos++];
+}
+
+// Line without CRLF; false at end of stream or on an overlong line
+static bool read_line(reader_t *r, char *line, size_t size) {
+  size_t n = 0;
+  for (;;) {
+    int c = read_byte(r);
+    if (c < 0)
+      return false;
+    if (c == '\n')
+      break;
+    if (n + 1 >= size)
+      return false;
+    line[n++] = (char)c;
+  }
+  if (n > 0 && line[n - 1] == '\r')
+    n--;
+  line[n] = '\0';
+  return true;
+}
+
+static void *client_main(void *arg) {
+  http_standin_t *h = arg;
+  // On the thread stack, so heap accounting only sees the code under test
+  reader_t reader = {.fd = h->client_fd}, *r = &reader;
+  char line[256];
+
+  // Response head up to the empty line
+  do {
+    if (!read_line(r, line, sizeof(line))) {
+      h->malformed = true;
+      return NULL;
+    }
+  } while (line[0] != '\0');
+
+  for (;;) {
+    char *end;
+    if (!read_line(r, line, sizeof(line))) {
+      h->malformed = true;
+      break;
+    }
+    size_t size = strtoul(line, &end, 16);
+    if (end == line) {
+      h->malformed = true;
+      break;
+    }
+    if (size == 0) {
+      read_line(r, line, sizeof(line)); // trailer end
+      break;
+    }
+    h->chunks++;
+    if (size > h->max_chunk)
+      h->max_chunk = size;
+    for (size_t i = 0; i < size; i++) {
+      int c = read_byte(r);
+      if (c < 0) {
+        h->malformed = true;
+        return NULL;
+      }
+      if (h->body && h->body_len < h->body_cap)
+        h->body[h->body_len] = (char)c;
+      h->body_len++;
+    }
+    if (!read_line(r, line, sizeof(line)) || line[0] != '\0') {
+      h->malformed = true;
+      break;
+    }
+  }
+  return NULL;
+}
+
+bool http_standin_open(http_standin_t *h, char *body, size_t body_cap) {
+  memset(h, 0, sizeof(*h));
+  h->body = body;
+  h->body_cap = body_cap;
+  session_t *s;
+  h->client_fd = session_open(&s);
+  if (h->client_fd < 0) {
+    perror("http_standin");
+    return false;
+  }
+  h->req = (httpd_req_t){.handle = &server_handle, .method = HTTP_GET,
+                         .uri = "", .aux = &s->resp};
+  return pthread_create(&h->client, NULL, client_main, h) == 0;
+}
+
+esp_err_t http_standin_chunk(const char *data, size_t len, void *ctx) {
+  http_standin_t *h = ctx;
+  if (h->fail_after && h->sent >= h->fail_after)
+    return ESP_FAIL; // client went away
+  if (httpd_resp_send_chunk(&h->req, data, (ssize_t)len) != ESP_OK)
+    return ESP_FAIL;
+  h->sent++;
+  return ESP_OK;
+}
+
+void http_standin_close(http_standin_t *h) {
+  // Without a terminating chunk the client sees the connection close
+  int fd = httpd_req_to_sockfd(&h->req);
+  shutdown(fd, SHUT_WR);
+  pthread_join(h->client, NULL);
+  close_session(session_of(fd));
+  close(h->client_fd);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// HTTP server stand-in behind stubs/esp_http_server.h. Every session is a
+// loopback TCP pair: the server end gets the response (status line and
+// headers, then the body or chunks) and the test reads the client end, so
+// socket sends include the kernel path.
+// - Tests that build wifi_http.c make requests with http_standin_request().
+//   Sessions stay open after the handler, as with keep-alive. Queued work,
+//   triggered closes and clients that hung up are handled only in
+//   http_standin_run(), the httpd task, so the test decides when.
+// - Tests of a streaming sink (track_export_stream()) open a session with
+//   http_standin_open() and feed it through http_standin_chunk(); a client
+//   thread reads and de-chunks the response.
+#include "esp_http_server.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+  uint32_t requests;
+  uint32_t sessions; // open now
+  uint32_t closed;   // through the close_fn, either side
+  uint32_t work;     // httpd_queue_work() items run
+  int64_t work_ns;   // wall time spent in them
+} http_standin_stats_t;
+
+// A session driven by the test instead of a handler
+typedef struct {
+  httpd_req_t req; // for httpd_resp_send_chunk()
+  int client_fd;   // read by the client thread
+  pthread_t client;
+  // Body as received; when `body` is NULL the client only counts bytes
+  char *body;
+  size_t body_cap;
+  size_t body_len;
+  size_t chunks;
+  size_t max_chunk;
+  size_t fail_after; // server side: chunks accepted before ESP_FAIL, 0 = never
+  size_t sent;
+  bool malformed; // chunk framing did not parse
+} http_standin_t;
+
+// Function prototypes
+// Server send and client receive buffers of later sessions, 0 for the
+// system default; small ones make a client that stops reading fill them
+// within a few frames
+void http_standin_set_buffers(int sndbuf, int rcvbuf);
+// Runs the handler for method and uri (with its query); `headers` is
+// "Name: value\r\n" lines or NULL. Returns the client end of the session,
+// -1 without a handler; *ret gets the handler's result.
+int http_standin_request(int method, const char *uri, const char *headers,
+                         esp_err_t *ret);
+// One pass of the httpd task: queued work, then pending closes and
+// sessions whose client end was closed. Returns the work items run.
+int http_standin_run(void);
+// Work items queued and not yet run
+int http_standin_pending(void);
+void http_standin_get_stats(http_standin_stats_t *stats);
+
+// Opens a session and its client thread; `body` may be NULL
+bool http_standin_open(http_standin_t *h, char *body, size_t body_cap);
+// httpd_resp_send_chunk() on the session, usable as a streaming sink (ctx
+// is the stand-in); len 0 sends the terminating chunk
+esp_err_t http_standin_chunk(const char *data, size_t len, void *ctx);
+// Waits for the client to read the terminating chunk, then closes
+void http_standin_close(http_standin_t *h);
@@ -0,0 +1,20 @@
+#pragma once
+
+// The original double/float parser (see legacy_gps_parser.c)
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  bool valid;
+  double latitude;
+  double longitude;
+  float altitude;
+  uint8_t satellites;
+  float speed;
+  float course;
+  char timestamp[10]; // HHMMSS
+  char date[7];       // DDMMYY
+} legacy_gps_data_t;
+
+void legacy_gps_parse_nmea(const char *nmea_sentence);
+legacy_gps_data_t *legacy_gps_get_data(void);
@@ -0,0 +1,208 @@
+// Broker stand-in, see mqtt_standin.h
+#include "mqtt_standin.h"
+#include "esp_mqtt.h"
+#include "esp_timer.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define EVENT_QUEUE 64
+#define OUTBOX_MAX 16
+#define OUTBOX_BYTES 256
+
+typedef struct {
+  int64_t due_us;
+  esp_mqtt_event_id_t id;
+  int msg_id;
+} pending_t;
+
+typedef struct {
+  char topic[32];
+  char data[OUTBOX_BYTES];
+  size_t len;
+  int msg_id;
+} outbox_t;
+
+struct esp_mqtt_client {
+  esp_event_handler_t handler;
+  void *handler_args;
+};
+
+static struct esp_mqtt_client client;
+static mqtt_standin_broker_t broker;
+static mqtt_standin_sink_t sink;
+static void *sink_ctx;
+static mqtt_standin_stats_t stats;
+static uint32_t loss_per_mille, loss_lcg;
+static bool connected;
+// Connection generation; events queued under an older one are dropped
+static uint32_t session;
+static pending_t queue[EVENT_QUEUE];
+static uint32_t queue_head, queue_tail;
+static uint32_t queue_session[EVENT_QUEUE];
+static outbox_t outbox[OUTBOX_MAX];
+static int outbox_n;
+static int next_msg_id = 1;
+
+static void post(esp_mqtt_event_id_t id, int msg_id, int64_t delay_us) {
+  if (queue_tail - queue_head == EVENT_QUEUE)
+    return;
+  uint32_t slot = queue_tail++ % EVENT_QUEUE;
+  queue[slot] = (pending_t){esp_timer_get_time() + delay_us, id, msg_id};
+  queue_session[slot] = session;
+}
+
+static bool ack_lost(void) {
+  loss_lcg = loss_lcg * 1103515245u + 12345u;
+  return (loss_lcg >> 16) % 1000 < loss_per_mille;
+}
+
+static void deliver(const char *topic, const char *data, size_t len,
+                    int qos, int msg_id) {
+  stats.messages++;
+  stats.bytes += len;
+  if (sink)
+    sink(topic, data, len, sink_ctx);
+  if (qos > 0) {
+    if (ack_lost())
+      stats.acks_lost++;
+    else
+      post(MQTT_EVENT_PUBLISHED, msg_id, 0);
+  }
+}
+
+static void drop_connection(void) {
+  if (!connected)
+    return;
+  connected = false;
+  session++; // acks and answers still queued are lost with it
+  post(MQTT_EVENT_DISCONNECTED, 0, 0);
+}
+
+void mqtt_standin_set_broker(mqtt_standin_broker_t state) {
+  broker = state;
+  if (state != MQTT_STANDIN_UP)
+    drop_connection();
+}
+
+void mqtt_standin_set_ack_loss(uint32_t per_mille, uint32_t seed) {
+  loss_per_mille = per_mille;
+  loss_lcg = seed;
+}
+
+void mqtt_standin_set_sink(mqtt_standin_sink_t s, void *ctx) {
+  sink = s;
+  sink_ctx = ctx;
+}
+
+void mqtt_standin_get_stats(mqtt_standin_stats_t *out) { *out = stats; }
+
+void mqtt_standin_poll(void) {
+  int64_t now = esp_timer_get_time();
+  while (queue_head != queue_tail) {
+    uint32_t slot = queue_head % EVENT_QUEUE;
+    pending_t *p = &queue[slot];
+    if (p->due_us > now)
+      break;
+    queue_head++;
+    // A connection answer of a superseded attempt, or an ack from a
+    // dropped connection, never arrives
+    bool stale = queue_session[slot] != session;
+    if (p->id == MQTT_EVENT_CONNECTED) {
+      if (stale || broker != MQTT_STANDIN_UP)
+        continue;
+      connected = true;
+      stats.connects++;
+    } else if (stale && p->id != MQTT_EVENT_DISCONNECTED) {
+      continue;
+    }
+    esp_mqtt_event_t ev = {.event_id = p->id, .client = &client,
+                           .msg_id = p->msg_id};
+    if (client.handler)
+      client.handler(client.handler_args, "MQTT_EVENTS", p->id, &ev);
+    if (p->id == MQTT_EVENT_CONNECTED) {
+      for (int i = 0; i < outbox_n; i++)
+        deliver(outbox[i].topic, outbox[i].data, outbox[i].len, 1,
+                outbox[i].msg_id);
+      outbox_n = 0;
+    }
+  }
+}
+
+esp_mqtt_client_handle_t
+esp_mqtt_client_init(const esp_mqtt_client_config_t *config) {
+  return &client;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t c,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler,
+                                         void *handler_args) {
+  c->handler = handler;
+  c->handler_args = handler_args;
+  return ESP_OK;
+}
+
+static esp_err_t attempt(void) {
+  stats.attempts++;
+  if (connected)
+    return ESP_OK;
+  session++;
+  int64_t delay = MQTT_STANDIN_CONNECT_MS * 1000LL;
+  if (broker == MQTT_STANDIN_UP) {
+    post(MQTT_EVENT_CONNECTED, 0, delay);
+  } else if (broker == MQTT_STANDIN_REFUSE) {
+    post(MQTT_EVENT_ERROR, 0, delay);
+    post(MQTT_EVENT_DISCONNECTED, 0, delay);
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t c) {
+  stats.starts++;
+  return attempt();
+}
+
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t c) {
+  return attempt();
+}
+
+esp_err_t esp_mqtt_client_disconnect(esp_mqtt_client_handle_t c) {
+  if (connected) {
+    drop_connection();
+  } else {
+    session++; // an attempt in progress is abandoned
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t c) {
+  return esp_mqtt_client_disconnect(c);
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t c, const char *topic,
+                            const char *data, int len, int qos, int retain) {
+  if (!connected) {
+    stats.refused++;
+    return -1;
+  }
+  int msg_id = next_msg_id++;
+  deliver(topic, data, len ? (size_t)len : strlen(data), qos, msg_id);
+  return msg_id;
+}
+
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t c, const char *topic,
+                            const char *data, int len, int qos, int retain,
+                            bool store) {
+  size_t n = len ? (size_t)len : strlen(data);
+  if (connected || !store)
+    return esp_mqtt_client_publish(c, topic, data, (int)n, qos, retain);
+  if (outbox_n == OUTBOX_MAX || n > OUTBOX_BYTES ||
+      strlen(topic) >= sizeof(outbox[0].topic))
+    return -1;
+  outbox_t *o = &outbox[outbox_n++];
+  strcpy(o->topic, topic);
+  memcpy(o->data, data, n);
+  o->len = n;
+  o->msg_id = next_msg_id++;
+  return o->msg_id;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// Broker stand-in behind stubs/esp_mqtt.h, for tests that build
+// mqtt_client.c. Connection and ack events are queued like the client
+// task would post them and reach the client's handler only in
+// mqtt_standin_poll(), so the test decides when they arrive. Published
+// messages go to the sink at once (the broker has them); the ack may then
+// be lost.
+#include <stddef.h>
+#include <stdint.h>
+
+// Time from a connect attempt to its CONNACK or refusal
+#define MQTT_STANDIN_CONNECT_MS 150
+
+typedef enum {
+  MQTT_STANDIN_UP = 0,
+  MQTT_STANDIN_REFUSE, // attempts fail with ERROR + DISCONNECTED
+  MQTT_STANDIN_SILENT, // attempts never answer
+} mqtt_standin_broker_t;
+
+typedef void (*mqtt_standin_sink_t)(const char *topic, const char *data,
+                                    size_t len, void *ctx);
+
+typedef struct {
+  uint32_t starts;    // start calls
+  uint32_t attempts;  // start/reconnect calls
+  uint32_t connects;  // CONNACKs sent
+  uint32_t messages;  // delivered to the sink
+  uint32_t bytes;     // their payloads
+  uint32_t acks_lost; // QoS 1 messages delivered but never acknowledged
+  uint32_t refused;   // publish calls while disconnected
+} mqtt_standin_stats_t;
+
+// Function prototypes
+// Anything but UP drops a live connection (DISCONNECTED on the next poll)
+void mqtt_standin_set_broker(mqtt_standin_broker_t state);
+// Share of QoS 1 acks lost, per mille, from its own fixed sequence
+void mqtt_standin_set_ack_loss(uint32_t per_mille, uint32_t seed);
+void mqtt_standin_set_sink(mqtt_standin_sink_t sink, void *ctx);
+// The client task: sends the queued events that are due by
+// esp_timer_get_time() to the registered handler
+void mqtt_standin_poll(void);
+void mqtt_standin_get_stats(mqtt_standin_stats_t *stats);
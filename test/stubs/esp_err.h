@@ -0,0 +1,30 @@
+#pragma once
+
+// Host stand-in for ESP-IDF esp_err.h: the codes the portable modules use
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERR_INVALID_CRC 0x109
+#define ESP_ERR_INVALID_VERSION 0x10A
+
+const char *esp_err_to_name(esp_err_t code);
+
+// Aborts on anything but ESP_OK, like the target's default
+#define ESP_ERROR_CHECK(x)                                                   \
+  do {                                                                       \
+    if ((x) != ESP_OK)                                                       \
+      abort();                                                               \
+  } while (0)
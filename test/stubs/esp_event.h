@@ -0,0 +1,15 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF default event loop: handlers run in the
+// caller of host_post_event() (see host.h)
+#include "esp_err.h"
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t base,
+                                    int32_t event_id, void *event_data);
+
+#define ESP_EVENT_ANY_ID -1
+
+esp_err_t esp_event_loop_create_default(void);
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t event_id,
+                                     esp_event_handler_t handler, void *arg);
@@ -0,0 +1,97 @@
+#pragma once
+
+// Host stand-in for ESP-IDF esp_http_server.h: the calls wifi_http.c makes.
+// Implemented by test/http_standin.c, which also drives the requests.
+#include "esp_err.h"
+#include <sys/types.h>
+
+#define ESP_ERR_HTTPD_BASE 0xb000
+#define ESP_ERR_HTTPD_RESULT_TRUNC (ESP_ERR_HTTPD_BASE + 4)
+
+// httpd_socket_send() results
+#define HTTPD_SOCK_ERR_FAIL -1
+#define HTTPD_SOCK_ERR_INVALID -2
+#define HTTPD_SOCK_ERR_TIMEOUT -3
+
+#define HTTPD_RESP_USE_STRLEN -1
+
+typedef void *httpd_handle_t;
+
+typedef enum {
+  HTTP_GET = 1,
+  HTTP_POST = 3,
+} httpd_method_t;
+
+typedef enum {
+  HTTPD_400_BAD_REQUEST,
+  HTTPD_404_NOT_FOUND,
+  HTTPD_500_INTERNAL_SERVER_ERROR,
+  HTTPD_503_SERVICE_UNAVAILABLE,
+} httpd_err_code_t;
+
+typedef struct httpd_req {
+  httpd_handle_t handle;
+  int method;
+  const char *uri;
+  void *user_ctx;
+  void *aux; // the stand-in's session
+} httpd_req_t;
+
+typedef esp_err_t (*httpd_uri_handler_t)(httpd_req_t *req);
+
+typedef struct {
+  const char *uri;
+  httpd_method_t method;
+  httpd_uri_handler_t handler;
+  void *user_ctx;
+} httpd_uri_t;
+
+typedef void (*httpd_close_func_t)(httpd_handle_t hd, int sockfd);
+typedef bool (*httpd_uri_match_func_t)(const char *reference_uri,
+                                       const char *uri_to_match,
+                                       size_t match_upto);
+typedef void (*httpd_work_fn_t)(void *arg);
+
+typedef struct {
+  size_t stack_size;
+  uint16_t max_open_sockets;
+  uint16_t max_uri_handlers;
+  httpd_close_func_t close_fn;
+  httpd_uri_match_func_t uri_match_fn;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG()                                               \
+  {                                                                          \
+    .stack_size = 4096, .max_open_sockets = 7, .max_uri_handlers = 8,        \
+    .close_fn = NULL, .uri_match_fn = NULL,                                  \
+  }
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
+                                     const httpd_uri_t *uri_handler);
+bool httpd_uri_match_wildcard(const char *uri_template,
+                              const char *uri_to_match, size_t match_upto);
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work,
+                           void *arg);
+int httpd_socket_send(httpd_handle_t hd, int sockfd, const char *buf,
+                      size_t buf_len, int flags);
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd);
+int httpd_req_to_sockfd(httpd_req_t *r);
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf,
+                                      size_t buf_len);
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val,
+                                size_t val_size);
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field,
+                                      char *val, size_t val_size);
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field,
+                             const char *value);
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf,
+                                ssize_t buf_len);
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error,
+                              const char *msg);
@@ -0,0 +1,18 @@
+#pragma once
+
+// Host stand-in for ESP-IDF esp_log.h: errors and warnings go to stderr,
+// the rest is compiled (so format strings are still checked) but dropped
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...)                                              \
+  fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)                                              \
+  fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOG_QUIET(tag, fmt, ...)                                         \
+  do {                                                                       \
+    if (0)                                                                   \
+      printf("%s" fmt, tag, ##__VA_ARGS__);                                  \
+  } while (0)
+#define ESP_LOGI ESP_LOG_QUIET
+#define ESP_LOGD ESP_LOG_QUIET
+#define ESP_LOGV ESP_LOG_QUIET
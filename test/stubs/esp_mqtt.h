@@ -0,0 +1,59 @@
+#pragma once
+
+// Host stand-in for the esp-mqtt client API that mqtt_client.c uses. The
+// broker behind it is test/mqtt_standin.c, linked only into the tests that
+// build the client.
+#include "esp_event.h"
+
+typedef struct esp_mqtt_client *esp_mqtt_client_handle_t;
+
+typedef enum {
+  MQTT_EVENT_ANY = -1,
+  MQTT_EVENT_ERROR = 0,
+  MQTT_EVENT_CONNECTED,
+  MQTT_EVENT_DISCONNECTED,
+  MQTT_EVENT_SUBSCRIBED,
+  MQTT_EVENT_UNSUBSCRIBED,
+  MQTT_EVENT_PUBLISHED,
+  MQTT_EVENT_DATA,
+  MQTT_EVENT_BEFORE_CONNECT,
+} esp_mqtt_event_id_t;
+
+typedef struct {
+  esp_mqtt_event_id_t event_id;
+  esp_mqtt_client_handle_t client;
+  int msg_id;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
+
+typedef struct {
+  struct {
+    struct {
+      const char *hostname;
+      uint32_t port;
+    } address;
+  } broker;
+  struct {
+    bool disable_auto_reconnect;
+  } network;
+} esp_mqtt_client_config_t;
+
+esp_mqtt_client_handle_t
+esp_mqtt_client_init(const esp_mqtt_client_config_t *config);
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler,
+                                         void *handler_args);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_disconnect(esp_mqtt_client_handle_t client);
+// len 0 takes strlen(data). Returns the message id, -1 when not connected.
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client,
+                            const char *topic, const char *data, int len,
+                            int qos, int retain);
+// Kept in the outbox while disconnected and sent on connect
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client,
+                            const char *topic, const char *data, int len,
+                            int qos, int retain, bool store);
@@ -0,0 +1,37 @@
+#pragma once
+
+// Host stand-in for ESP-IDF esp_netif.h: one STA interface whose address
+// is set by host_set_sta_ip() (see host.h)
+#include "esp_event.h"
+
+typedef struct host_netif esp_netif_t;
+
+typedef struct {
+  uint32_t addr; // network byte order, as on the target
+} esp_ip4_addr_t;
+
+typedef struct {
+  esp_ip4_addr_t ip;
+  esp_ip4_addr_t netmask;
+  esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+typedef struct {
+  esp_netif_t *esp_netif;
+  esp_netif_ip_info_t ip_info;
+  bool ip_changed;
+} ip_event_got_ip_t;
+
+extern esp_event_base_t const IP_EVENT;
+
+typedef enum {
+  IP_EVENT_STA_GOT_IP,
+  IP_EVENT_STA_LOST_IP,
+} ip_event_t;
+
+esp_err_t esp_netif_init(void);
+esp_netif_t *esp_netif_create_default_wifi_sta(void);
+esp_netif_t *esp_netif_create_default_wifi_ap(void);
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key);
+esp_err_t esp_netif_get_ip_info(esp_netif_t *netif,
+                                esp_netif_ip_info_t *ip_info);
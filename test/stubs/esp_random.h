@@ -0,0 +1,6 @@
+#pragma once
+
+// Host stand-in for ESP-IDF esp_random.h: a fixed sequence, see host.h
+#include <stdint.h>
+
+uint32_t esp_random(void);
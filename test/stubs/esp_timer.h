@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for ESP-IDF esp_timer.h; see host.h for the fake clock
+#include "esp_err.h"
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,57 @@
+#pragma once
+
+// Host stand-in for ESP-IDF esp_wifi.h: the events, and a driver that
+// accepts any configuration and does nothing with it
+#include "esp_event.h"
+#include "esp_netif.h"
+
+extern esp_event_base_t const WIFI_EVENT;
+
+typedef enum {
+  WIFI_EVENT_STA_CONNECTED = 4,
+  WIFI_EVENT_STA_DISCONNECTED,
+} wifi_event_t;
+
+typedef enum {
+  WIFI_MODE_STA = 1,
+  WIFI_MODE_AP,
+  WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+typedef enum {
+  WIFI_IF_STA,
+  WIFI_IF_AP,
+} wifi_interface_t;
+
+typedef enum {
+  WIFI_AUTH_OPEN,
+  WIFI_AUTH_WPA_WPA2_PSK = 4,
+} wifi_auth_mode_t;
+
+typedef struct {
+  int unused;
+} wifi_init_config_t;
+
+#define WIFI_INIT_CONFIG_DEFAULT()                                           \
+  { 0 }
+
+typedef union {
+  struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    uint8_t ssid_len;
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    uint8_t max_connection;
+  } ap;
+  struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+  } sta;
+} wifi_config_t;
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config);
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface,
+                              wifi_config_t *conf);
+esp_err_t esp_wifi_start(void);
@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for FreeRTOS mutexes, backed by pthread mutexes
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_mutex *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+// Blocks for portMAX_DELAY, otherwise only tries once
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
@@ -0,0 +1,23 @@
+#pragma once
+
+// Test controls for the host stand-ins in stubs/
+#include <stdint.h>
+
+// esp_timer_get_time() follows CLOCK_MONOTONIC until a test sets the fake
+// clock; from then on it returns the set value until the next call.
+void host_set_time_us(int64_t now_us);
+void host_advance_us(int64_t delta_us);
+// Wall-clock nanoseconds for benchmarks, independent of the fake clock
+int64_t host_now_ns(void);
+// Empties the NVS stand-in and resets its write counter
+void host_nvs_reset(void);
+// nvs_set_str()/nvs_set_blob() calls since the last reset
+uint32_t host_nvs_writes(void);
+// esp_random() is a fixed sequence that restarts from this seed
+void host_seed_random(uint32_t seed);
+// Runs the handlers registered for base/event_id (or ESP_EVENT_ANY_ID), in
+// the caller, like the default event loop would
+void host_post_event(const char *base, int32_t event_id, void *event_data);
+// Sets the STA address (a.b.c.d as 0xddccbbaa, 0 for none) and posts
+// IP_EVENT_STA_GOT_IP, or IP_EVENT_STA_LOST_IP for 0
+void host_set_sta_ip(uint32_t addr);
@@ -0,0 +1,298 @@
+// Host implementations of the ESP-IDF calls declared in stubs/
+#include "esp_err.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/semphr.h"
+#include "host.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static bool fake_clock;
+static int64_t fake_now_us;
+
+int64_t host_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void host_set_time_us(int64_t now_us) {
+  fake_clock = true;
+  fake_now_us = now_us;
+}
+
+void host_advance_us(int64_t delta_us) {
+  fake_clock = true;
+  fake_now_us += delta_us;
+}
+
+int64_t esp_timer_get_time(void) {
+  return fake_clock ? fake_now_us : host_now_ns() / 1000;
+}
+
+static uint32_t random_state = 1;
+
+void host_seed_random(uint32_t seed) { random_state = seed; }
+
+uint32_t esp_random(void) {
+  // Two LCG steps, high halves, so every bit varies
+  random_state = random_state * 1103515245u + 12345u;
+  uint32_t hi = random_state >> 16;
+  random_state = random_state * 1103515245u + 12345u;
+  return hi << 16 | random_state >> 16;
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+  switch (code) {
+  case ESP_OK:
+    return "ESP_OK";
+  case ESP_FAIL:
+    return "ESP_FAIL";
+  case ESP_ERR_NO_MEM:
+    return "ESP_ERR_NO_MEM";
+  case ESP_ERR_INVALID_ARG:
+    return "ESP_ERR_INVALID_ARG";
+  case ESP_ERR_INVALID_STATE:
+    return "ESP_ERR_INVALID_STATE";
+  case ESP_ERR_INVALID_SIZE:
+    return "ESP_ERR_INVALID_SIZE";
+  case ESP_ERR_NOT_FOUND:
+    return "ESP_ERR_NOT_FOUND";
+  case ESP_ERR_TIMEOUT:
+    return "ESP_ERR_TIMEOUT";
+  case ESP_ERR_INVALID_CRC:
+    return "ESP_ERR_INVALID_CRC";
+  default:
+    return "ERROR";
+  }
+}
+
+struct host_mutex {
+  pthread_mutex_t mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  SemaphoreHandle_t sem = malloc(sizeof(*sem));
+  if (sem)
+    pthread_mutex_init(&sem->mutex, NULL);
+  return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait) {
+  if (wait == portMAX_DELAY)
+    return pthread_mutex_lock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+  return pthread_mutex_trylock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  return pthread_mutex_unlock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+// NVS: a handle is its namespace index, the high bit marks read-write
+#define HOST_NVS_ENTRIES 32
+#define HOST_NVS_NAMESPACES 8
+#define HOST_NVS_RW 0x80000000u
+
+typedef struct {
+  uint8_t ns;
+  bool is_str;
+  char key[16];
+  void *data;
+  size_t len;
+} host_nvs_entry_t;
+
+static char nvs_names[HOST_NVS_NAMESPACES][16];
+static host_nvs_entry_t nvs_entries[HOST_NVS_ENTRIES];
+static uint32_t nvs_writes;
+
+void host_nvs_reset(void) {
+  for (int i = 0; i < HOST_NVS_ENTRIES; i++)
+    free(nvs_entries[i].data);
+  memset(nvs_entries, 0, sizeof(nvs_entries));
+  memset(nvs_names, 0, sizeof(nvs_names));
+  nvs_writes = 0;
+}
+
+uint32_t host_nvs_writes(void) { return nvs_writes; }
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode,
+                   nvs_handle_t *out_handle) {
+  int free_slot = -1;
+  for (int i = 0; i < HOST_NVS_NAMESPACES; i++) {
+    if (strcmp(nvs_names[i], name) == 0) {
+      *out_handle = (nvs_handle_t)i | (mode == NVS_READWRITE ? HOST_NVS_RW
+                                                              : 0);
+      return ESP_OK;
+    }
+    if (!nvs_names[i][0] && free_slot < 0)
+      free_slot = i;
+  }
+  // Like the real store, a read-only open needs an existing namespace
+  if (mode == NVS_READONLY)
+    return ESP_ERR_NVS_NOT_FOUND;
+  if (free_slot < 0 || strlen(name) >= sizeof(nvs_names[0]))
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+  strcpy(nvs_names[free_slot], name);
+  *out_handle = (nvs_handle_t)free_slot | HOST_NVS_RW;
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {}
+
+esp_err_t nvs_commit(nvs_handle_t handle) { return ESP_OK; }
+
+static host_nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key) {
+  uint8_t ns = (uint8_t)(handle & ~HOST_NVS_RW);
+  for (int i = 0; i < HOST_NVS_ENTRIES; i++)
+    if (nvs_entries[i].data && nvs_entries[i].ns == ns &&
+        strcmp(nvs_entries[i].key, key) == 0)
+      return &nvs_entries[i];
+  return NULL;
+}
+
+static esp_err_t nvs_set(nvs_handle_t handle, const char *key,
+                         const void *value, size_t len, bool is_str) {
+  if (!(handle & HOST_NVS_RW))
+    return ESP_ERR_NVS_READ_ONLY;
+  host_nvs_entry_t *e = nvs_find(handle, key);
+  for (int i = 0; !e && i < HOST_NVS_ENTRIES; i++)
+    if (!nvs_entries[i].data)
+      e = &nvs_entries[i];
+  if (!e || strlen(key) >= sizeof(e->key))
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+  void *data = malloc(len ? len : 1);
+  if (!data)
+    return ESP_ERR_NO_MEM;
+  memcpy(data, value, len);
+  free(e->data);
+  *e = (host_nvs_entry_t){.ns = (uint8_t)(handle & ~HOST_NVS_RW),
+                          .is_str = is_str, .data = data, .len = len};
+  strcpy(e->key, key);
+  nvs_writes++;
+  return ESP_OK;
+}
+
+// NULL out_value asks for the length; a short buffer is an error
+static esp_err_t nvs_get(nvs_handle_t handle, const char *key, void *out,
+                         size_t *length, bool is_str) {
+  host_nvs_entry_t *e = nvs_find(handle, key);
+  if (!e || e->is_str != is_str)
+    return ESP_ERR_NVS_NOT_FOUND;
+  if (out) {
+    if (*length < e->len)
+      return ESP_ERR_NVS_INVALID_LENGTH;
+    memcpy(out, e->data, e->len);
+  }
+  *length = e->len;
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key,
+                      const char *value) {
+  return nvs_set(handle, key, value, strlen(value) + 1, true);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value,
+                      size_t *length) {
+  return nvs_get(handle, key, out_value, length, true);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key,
+                       const void *value, size_t length) {
+  return nvs_set(handle, key, value, length, false);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value,
+                       size_t *length) {
+  return nvs_get(handle, key, out_value, length, false);
+}
+
+// Default event loop: a handler table, dispatched in the caller
+#define HOST_EVENT_HANDLERS 16
+
+esp_event_base_t const IP_EVENT = "IP_EVENT";
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+
+typedef struct {
+  esp_event_base_t base;
+  int32_t event_id;
+  esp_event_handler_t handler;
+  void *arg;
+} host_event_handler_t;
+
+static host_event_handler_t event_handlers[HOST_EVENT_HANDLERS];
+static int event_handler_count;
+
+esp_err_t esp_event_loop_create_default(void) { return ESP_OK; }
+
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t event_id,
+                                     esp_event_handler_t handler, void *arg) {
+  if (event_handler_count == HOST_EVENT_HANDLERS)
+    return ESP_ERR_NO_MEM;
+  event_handlers[event_handler_count++] =
+      (host_event_handler_t){base, event_id, handler, arg};
+  return ESP_OK;
+}
+
+void host_post_event(const char *base, int32_t event_id, void *event_data) {
+  for (int i = 0; i < event_handler_count; i++) {
+    const host_event_handler_t *h = &event_handlers[i];
+    if (strcmp(h->base, base) == 0 &&
+        (h->event_id == ESP_EVENT_ANY_ID || h->event_id == event_id))
+      h->handler(h->arg, base, event_id, event_data);
+  }
+}
+
+// The STA interface; only its address is kept
+struct host_netif {
+  esp_netif_ip_info_t ip_info;
+};
+
+static esp_netif_t sta_netif, ap_netif;
+
+esp_err_t esp_netif_init(void) { return ESP_OK; }
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void) { return &sta_netif; }
+
+esp_netif_t *esp_netif_create_default_wifi_ap(void) { return &ap_netif; }
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key) {
+  return strcmp(if_key, "WIFI_STA_DEF") == 0 ? &sta_netif : NULL;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *netif,
+                                esp_netif_ip_info_t *ip_info) {
+  if (!netif)
+    return ESP_ERR_INVALID_ARG;
+  *ip_info = netif->ip_info;
+  return ESP_OK;
+}
+
+// WiFi driver: configured, never associates
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) { return ESP_OK; }
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) { return ESP_OK; }
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface,
+                              wifi_config_t *conf) {
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void) { return ESP_OK; }
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+
+void host_set_sta_ip(uint32_t addr) {
+  sta_netif.ip_info.ip.addr = addr;
+  ip_event_got_ip_t ev = {.esp_netif = &sta_netif,
+                          .ip_info = sta_netif.ip_info,
+                          .ip_changed = true};
+  host_post_event(IP_EVENT, addr ? IP_EVENT_STA_GOT_IP : IP_EVENT_STA_LOST_IP,
+                  &ev);
+}
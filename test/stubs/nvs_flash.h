@@ -0,0 +1,6 @@
+#pragma once
+
+// Host stand-in for ESP-IDF nvs_flash.h: the partition is always there
+#include "esp_err.h"
+
+esp_err_t nvs_flash_init(void);
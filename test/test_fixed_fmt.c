@@ -0,0 +1,160 @@
+// fixed_fmt.c against the double path it replaced: snprintf("%.*f") of
+// v / 10^decimals for every decimal count over random and edge values,
+// rounding to fewer shown digits (ties half away from zero), %u, and
+// gmtime_r() for ISO 8601 from 1970 to 2106. Outputs that do not fit must
+// leave the buffer untouched.
+#include "fixed_fmt.h"
+#include "test_util.h"
+#include <stdbool.h>
+#include <time.h>
+
+static uint32_t lcg = 41;
+
+static uint32_t rnd32(void) {
+  lcg = lcg * 1103515245u + 12345u;
+  uint32_t hi = lcg >> 16;
+  lcg = lcg * 1103515245u + 12345u;
+  return hi << 16 | lcg >> 16;
+}
+
+static const uint32_t pow10[] = {1,      10,      100,      1000,    10000,
+                                 100000, 1000000, 10000000, 100000000};
+
+// Random values weighted towards the ranges the firmware prints
+static int32_t sample(int i) {
+  static const int32_t edges[] = {0,          1,           -1,
+                                  9,          -9,          10,
+                                  99999999,   -99999999,   100000000,
+                                  -228333333, -431000000,  1800000000,
+                                  -1800000000, INT32_MAX,  INT32_MIN,
+                                  INT32_MIN + 1};
+  int n = sizeof(edges) / sizeof(edges[0]);
+  if (i < n)
+    return edges[i];
+  uint32_t r = rnd32();
+  switch (i % 4) {
+  case 0:
+    return (int32_t)r;
+  case 1:
+    return (int32_t)(r % 2000000001u) - 1000000000; // lat/lon e7
+  case 2:
+    return (int32_t)(r % 200001u) - 100000; // speed, alt, DOP
+  default:
+    return (int32_t)(r % 201u) - 100;
+  }
+}
+
+static void test_fixed(void) {
+  char got[FIXED_FMT_MAX], want[32];
+  int bad = 0;
+  for (int i = 0; i < 400000; i++) {
+    int32_t v = sample(i);
+    uint8_t d = (uint8_t)(i % 9);
+    int len = fixed_fmt(got, sizeof(got), v, d);
+    snprintf(want, sizeof(want), "%.*f", d, (double)v / pow10[d]);
+    bad += len != (int)strlen(want) || strcmp(got, want) != 0;
+  }
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(fixed_fmt(got, sizeof(got), INT32_MIN, 0), 11);
+  CHECK_STR(got, "-2147483648");
+  CHECK_EQ(fixed_fmt(got, sizeof(got), 5, 9), 0);
+}
+
+// Exact decimal reference: the double path rounds binary approximations
+// of ties either way, the firmware always away from zero
+static void test_round(void) {
+  char got[FIXED_FMT_MAX], want[32];
+  int bad = 0, ties = 0;
+  for (int i = 0; i < 400000; i++) {
+    int32_t v = sample(i);
+    uint8_t d = (uint8_t)(1 + i % 8), shown = (uint8_t)(i / 8 % d);
+    uint32_t div = pow10[d - shown];
+    uint64_t a = v < 0 ? (uint64_t)-(int64_t)v : (uint64_t)v;
+    uint64_t q = (a + div / 2) / div;
+    bool tie = a % div == div / 2 && div > 1;
+    fixed_fmt_round(got, sizeof(got), v, d, shown);
+    if (tie) {
+      ties++;
+      snprintf(want, sizeof(want), "%s%llu", v < 0 ? "-" : "",
+               (unsigned long long)(q / pow10[shown]));
+      if (shown)
+        snprintf(want + strlen(want), sizeof(want) - strlen(want), ".%0*llu",
+                 shown, (unsigned long long)(q % pow10[shown]));
+    } else {
+      snprintf(want, sizeof(want), "%.*f", shown, (double)v / pow10[d]);
+      // The double path keeps the sign of values that round to zero
+      if (q == 0 && want[0] == '-')
+        memmove(want, want + 1, strlen(want));
+    }
+    bad += strcmp(got, want) != 0;
+  }
+  CHECK_EQ(bad, 0);
+  CHECK(ties > 0);
+  fixed_fmt_round(got, sizeof(got), -228333335, 7, 5);
+  CHECK_STR(got, "-22.83333");
+  fixed_fmt_round(got, sizeof(got), 995, 2, 1);
+  CHECK_STR(got, "10.0");
+  fixed_fmt_round(got, sizeof(got), -5, 1, 0);
+  CHECK_STR(got, "-1");
+  CHECK_EQ(fixed_fmt_round(got, sizeof(got), 1, 2, 3), 0);
+}
+
+static void test_u32_and_sizes(void) {
+  char got[16], want[16];
+  int bad = 0;
+  for (int i = 0; i < 100000; i++) {
+    uint32_t v = i < 2 ? (i ? UINT32_MAX : 0) : rnd32() >> (i % 32);
+    fixed_fmt_u32(got, sizeof(got), v);
+    snprintf(want, sizeof(want), "%u", v);
+    bad += strcmp(got, want) != 0;
+  }
+  CHECK_EQ(bad, 0);
+
+  // Exactly fits, one byte short: nothing written
+  char buf[8];
+  memset(buf, '#', sizeof(buf));
+  CHECK_EQ(fixed_fmt(buf, 7, -12345, 2), 0);
+  CHECK_EQ(buf[0], '#');
+  CHECK_EQ(fixed_fmt(buf, 8, -12345, 2), 7);
+  CHECK_STR(buf, "-123.45");
+  memset(buf, '#', sizeof(buf));
+  CHECK_EQ(fixed_fmt_u32(buf, 3, 123), 0);
+  CHECK_EQ(buf[0], '#');
+  CHECK_EQ(fixed_fmt_round(buf, 4, 1234, 2, 1), 0);
+  CHECK_EQ(buf[0], '#');
+  char iso[FIXED_FMT_ISO8601_LEN];
+  memset(iso, '#', sizeof(iso));
+  CHECK_EQ(fixed_fmt_iso8601(iso, sizeof(iso) - 1, 0), 0);
+  CHECK_EQ(iso[0], '#');
+}
+
+static void test_iso8601(void) {
+  char got[FIXED_FMT_ISO8601_LEN], want[32];
+  int bad = 0;
+  static const uint32_t edges[] = {0,          951782400, 951868799,
+                                   1709251199, 4107542399u, 4107542400u,
+                                   UINT32_MAX};
+  for (int i = 0; i < 300000; i++) {
+    uint32_t t = i < 7 ? edges[i] : rnd32();
+    // Midnight and the last second of a day more often than by chance
+    if (i % 3 == 1)
+      t = t / 86400 * 86400 + (i % 2 ? 86399 : 0);
+    time_t tt = t;
+    struct tm tm;
+    gmtime_r(&tt, &tm);
+    strftime(want, sizeof(want), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    int len = fixed_fmt_iso8601(got, sizeof(got), t);
+    bad += len != FIXED_FMT_ISO8601_LEN - 1 || strcmp(got, want) != 0;
+  }
+  CHECK_EQ(bad, 0);
+  fixed_fmt_iso8601(got, sizeof(got), UINT32_MAX);
+  CHECK_STR(got, "2106-02-07T06:28:15Z");
+}
+
+int main(void) {
+  test_fixed();
+  test_round();
+  test_u32_and_sizes();
+  test_iso8601();
+  return test_result("test_fixed_fmt");
+}
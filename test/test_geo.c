@@ -0,0 +1,148 @@
+// geo.c against double precision: cos_q16 over every latitude step,
+// isqrt64 against the exact floor root, heading against atan2, and
+// distance/bearing against haversine on a 6371 km sphere for legs from
+// centimetres to 100 km at latitudes up to 80 degrees.
+#include "geo.h"
+#include "test_util.h"
+#include <math.h>
+
+#define R_CM 637100000.0
+#define RAD(e7) ((double)(e7) * 1e-7 * M_PI / 180)
+
+static uint32_t lcg = 43;
+
+static double uniform(double lo, double hi) {
+  lcg = lcg * 1103515245u + 12345u;
+  return lo + (hi - lo) * ((lcg >> 8) / 16777216.0);
+}
+
+static double haversine_cm(int32_t lat1, int32_t lon1, int32_t lat2,
+                           int32_t lon2) {
+  double dlat = RAD(lat2 - lat1), dlon = RAD(lon2 - lon1);
+  double a = sin(dlat / 2) * sin(dlat / 2) +
+             cos(RAD(lat1)) * cos(RAD(lat2)) * sin(dlon / 2) * sin(dlon / 2);
+  return 2 * R_CM * asin(sqrt(a));
+}
+
+static double bearing_deg(int32_t lat1, int32_t lon1, int32_t lat2,
+                          int32_t lon2) {
+  double y = sin(RAD(lon2 - lon1)) * cos(RAD(lat2));
+  double x = cos(RAD(lat1)) * sin(RAD(lat2)) -
+             sin(RAD(lat1)) * cos(RAD(lat2)) * cos(RAD(lon2 - lon1));
+  return fmod(atan2(y, x) * 180 / M_PI + 360, 360);
+}
+
+static double angle_diff(double a, double b) {
+  double d = fabs(a - b);
+  return d > 180 ? 360 - d : d;
+}
+
+static void test_cos(void) {
+  double worst = 0;
+  for (int32_t lat = -900000000; lat <= 900000000; lat += 99991) {
+    double e = fabs(geo_cos_q16(lat) / 65536.0 - cos(RAD(lat)));
+    worst = e > worst ? e : worst;
+  }
+  printf("cos_q16: max error %.2e\n", worst);
+  CHECK(worst < 5e-5);
+  CHECK_EQ(geo_cos_q16(0), 65536);
+  CHECK_EQ(geo_cos_q16(900000000), 0);
+  CHECK_EQ(geo_cos_q16(-950000000), 0);
+}
+
+static void test_isqrt(void) {
+  int bad = 0;
+  for (int i = 0; i < 200000; i++) {
+    uint64_t v = (uint64_t)(lcg = lcg * 1103515245u + 12345u) << 32;
+    v |= lcg = lcg * 1103515245u + 12345u;
+    v >>= i % 64;
+    uint64_t r = geo_isqrt64(v);
+    bad += r * r > v || (r + 1) * (r + 1) <= v;
+  }
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(geo_isqrt64(0), 0);
+  CHECK_EQ(geo_isqrt64(UINT64_MAX), 0xFFFFFFFFu);
+  CHECK_EQ(geo_isqrt64(99), 9);
+}
+
+static void test_heading(void) {
+  double worst = 0;
+  for (int i = 0; i < 200000; i++) {
+    int64_t e = (int64_t)uniform(-2e9, 2e9) >> (i % 30);
+    int64_t n = (int64_t)uniform(-2e9, 2e9) >> (i / 30 % 30);
+    if (e == 0 && n == 0)
+      continue;
+    uint16_t h = geo_heading_cdeg(e, n);
+    CHECK(h < 36000);
+    double ref = fmod(atan2((double)e, (double)n) * 180 / M_PI + 360, 360);
+    double d = angle_diff(h / 100.0, ref);
+    worst = d > worst ? d : worst;
+  }
+  printf("heading: max error %.3f degree\n", worst);
+  CHECK(worst <= 0.125);
+  CHECK_EQ(geo_heading_cdeg(0, 0), 0);
+  CHECK_EQ(geo_heading_cdeg(0, 100), 0);
+  CHECK_EQ(geo_heading_cdeg(100, 0), 9000);
+  CHECK_EQ(geo_heading_cdeg(0, -100), 18000);
+  CHECK_EQ(geo_heading_cdeg(-100, 0), 27000);
+}
+
+// Within 3 cm up to 100 m (fix to fix), then relative error
+static void test_distance(void) {
+  double short_worst = 0, long_worst = 0, bearing_worst = 0;
+  double bias = 0, short_sum = 0; // signed, legs of 1-100 m
+  for (int i = 0; i < 300000; i++) {
+    double lat = uniform(-80, 80), lon = uniform(-179, 179);
+    double len_m = pow(10, uniform(-2, 5)), a = uniform(0, 2 * M_PI);
+    double dlat = len_m * cos(a) / 111195, dlon = len_m * sin(a) / 111195;
+    dlon /= cos(lat * M_PI / 180);
+    int32_t lat1 = (int32_t)lround(lat * 1e7);
+    int32_t lon1 = (int32_t)lround(lon * 1e7);
+    int32_t lat2 = (int32_t)lround((lat + dlat) * 1e7);
+    int32_t lon2 = (int32_t)lround((lon + dlon) * 1e7);
+    double ref = haversine_cm(lat1, lon1, lat2, lon2);
+    double d = fabs(geo_distance_cm(lat1, lon1, lat2, lon2) - ref);
+    if (ref <= 10000) {
+      short_worst = d > short_worst ? d : short_worst;
+      if (ref >= 100) {
+        bias += geo_distance_cm(lat1, lon1, lat2, lon2) - ref;
+        short_sum += ref;
+      }
+    } else {
+      long_worst = d / ref > long_worst ? d / ref : long_worst;
+    }
+    // Bearings of legs over 10 m; below, 1e-7 degree steps dominate
+    if (ref > 1000) {
+      double b = angle_diff(geo_bearing_cdeg(lat1, lon1, lat2, lon2) / 100.0,
+                            bearing_deg(lat1, lon1, lat2, lon2));
+      // geo.c takes the bearing at mid-leg; it drifts from the initial
+      // bearing with the leg length and latitude (0.26 degree on 10 km
+      // at 78N), so only legs up to 1 km are held to the initial bearing
+      if (ref < 100000)
+        bearing_worst = b > bearing_worst ? b : bearing_worst;
+    }
+  }
+  printf("distance: max %.3f cm up to 100 m (bias %+.4f%% on 1-100 m), "
+         "%.4f%% to 100 km; bearing %.3f degree to 1 km\n",
+         short_worst, bias / short_sum * 100, long_worst * 100,
+         bearing_worst);
+  // Fix-to-fix legs are summed into the trip odometer
+  CHECK(fabs(bias / short_sum) < 1e-4);
+  CHECK(short_worst <= 3);
+  CHECK(long_worst <= 0.0005);
+  CHECK(bearing_worst <= 0.15);
+
+  CHECK_EQ(geo_distance_cm(0, 0, 0, 0), 0);
+  CHECK_EQ(geo_distance_cm(-228400000, -431100000, -228400000, -431100000),
+           0);
+  CHECK_EQ(geo_bearing_cdeg(0, 0, 1000, 0), 0);
+  CHECK_EQ(geo_bearing_cdeg(0, 0, 0, 1000), 9000);
+}
+
+int main(void) {
+  test_cos();
+  test_isqrt();
+  test_heading();
+  test_distance();
+  return test_result("test_geo");
+}
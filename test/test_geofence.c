@@ -0,0 +1,185 @@
+// geofence.c on the host: definition parsing and the SD/NVS sources,
+// enter/exit events along a known path, and 1000 random circles and
+// polygons over the harbour against a double-precision brute force over a
+// 200k-fix random walk. Only fixes within EDGE_M of a boundary may differ.
+#include "fence_gen.h"
+#include "geofence.h"
+#include "nvs.h"
+#include "test_util.h"
+#include <math.h>
+
+#define FENCES 1000
+#define FIXES 200000
+#define EDGE_M 0.1
+
+typedef struct {
+  int enter, exit;
+  uint16_t last_id;
+  char last_name[GEOFENCE_NAME_LEN];
+  geofence_transition_t last_tr;
+  uint32_t last_time;
+  uint8_t inside[FENCES]; // per id, from the events alone
+} events_t;
+
+static void on_event(const geofence_event_t *ev, void *ctx) {
+  events_t *e = ctx;
+  if (ev->transition == GEOFENCE_ENTER)
+    e->enter++;
+  else
+    e->exit++;
+  e->last_id = ev->id;
+  snprintf(e->last_name, sizeof(e->last_name), "%s", ev->name);
+  e->last_tr = ev->transition;
+  e->last_time = ev->time;
+  if (ev->id < FENCES)
+    e->inside[ev->id] = ev->transition == GEOFENCE_ENTER;
+}
+
+static int32_t e7(double deg) { return (int32_t)lround(deg * 1e7); }
+
+static void test_parse(void) {
+  CHECK_EQ(geofence_load_text(""), ESP_ERR_NOT_FOUND);
+  CHECK_EQ(geofence_load_text("# nothing\n\n"), ESP_ERR_NOT_FOUND);
+
+  // Two good fences among malformed lines (each is skipped, not fatal)
+  const char *text = "# harbour zones\r\n"
+                     "C,marina \"A\",-22.8400000,-43.1100000,50\r\n"
+                     "C,no radius,-22.84,-43.11\n"
+                     "C,zero,-22.84,-43.11,0\n"
+                     "C,bad lat,-22.8x,-43.11,30\n"
+                     "P,two points,-22.84,-43.11,-22.85,-43.12\n"
+                     "P,odd,-22.84,-43.11,-22.85,-43.12,-22.86\n"
+                     "X,unknown,-22.84,-43.11,10\n"
+                     "P,channel,-22.8450,-43.1050,-22.8450,-43.1000,"
+                     "-22.8400,-43.1000,-22.8400,-43.1025,-22.8425,-43.1025,"
+                     "-22.8425,-43.1050";
+  CHECK_EQ(geofence_load_text(text), ESP_OK);
+  geofence_stats_t st;
+  geofence_get_stats(&st);
+  CHECK_EQ(st.fences, 2);
+
+  events_t ev = {0};
+  geofence_set_callback(on_event, &ev);
+  // Into the circle: one enter with the sanitised name
+  geofence_update(e7(-22.8400), e7(-43.1110), 100); // ~100 m west
+  CHECK_EQ(ev.enter, 0);
+  geofence_update(e7(-22.8400), e7(-43.1104), 101); // ~41 m
+  CHECK_EQ(ev.enter, 1);
+  CHECK_EQ(ev.last_id, 0);
+  CHECK_STR(ev.last_name, "marina _A_");
+  CHECK_EQ(ev.last_time, 101);
+  geofence_update(e7(-22.8401), e7(-43.1100), 102);
+  CHECK_EQ(ev.enter + ev.exit, 1);
+  geofence_update(e7(-22.8400), e7(-43.1090), 103); // ~103 m east
+  CHECK_EQ(ev.exit, 1);
+  CHECK_EQ(ev.last_tr, GEOFENCE_EXIT);
+
+  // The L-shaped channel: its notch is outside
+  geofence_update(e7(-22.8440), e7(-43.1040), 104);
+  CHECK_EQ(ev.enter, 2);
+  CHECK_EQ(ev.last_id, 1);
+  geofence_update(e7(-22.8410), e7(-43.1040), 105); // notch
+  CHECK_EQ(ev.exit, 2);
+  geofence_update(e7(-22.8410), e7(-43.1010), 106); // upper arm
+  CHECK_EQ(ev.enter, 3);
+  geofence_get_stats(&st);
+  CHECK_EQ(st.inside, 1);
+  CHECK_EQ(st.events, 5);
+  geofence_set_callback(NULL, NULL);
+}
+
+// fences.txt in the working directory (the SD card), else NVS
+static void test_sources(void) {
+  const char *dir = scratch_enter();
+  host_nvs_reset();
+  CHECK_EQ(geofence_init(), ESP_ERR_NOT_FOUND);
+
+  nvs_handle_t h;
+  CHECK_EQ(nvs_open(GEOFENCE_NVS_NAMESPACE, NVS_READWRITE, &h), ESP_OK);
+  CHECK_EQ(nvs_set_str(h, GEOFENCE_NVS_KEY,
+                       "C,a,-22.84,-43.11,10\nC,b,-22.85,-43.11,10\n"),
+           ESP_OK);
+  nvs_close(h);
+  geofence_stats_t st;
+  CHECK_EQ(geofence_init(), ESP_OK);
+  geofence_get_stats(&st);
+  CHECK_EQ(st.fences, 2);
+
+  FILE *f = fopen(GEOFENCE_FILE, "w");
+  fputs("C,sd,-22.84,-43.11,10\n", f);
+  fclose(f);
+  CHECK_EQ(geofence_init(), ESP_OK);
+  geofence_get_stats(&st);
+  CHECK_EQ(st.fences, 1);
+  host_nvs_reset();
+  scratch_leave(dir);
+}
+
+static void test_random(void) {
+  static gen_fence_t gen[FENCES];
+  static char text[FENCES * 320];
+  static events_t ev;
+  CHECK(fence_gen(1, FENCES, gen, text, sizeof(text)) > 0);
+  CHECK_EQ(geofence_load_text(text), ESP_OK);
+  geofence_set_callback(on_event, &ev);
+  double ref_lat = (FENCE_GEN_LAT0 + FENCE_GEN_LAT1) / 2;
+
+  // A boat at 1-6 m/s sampled at 10 Hz, turning slowly, bouncing off the
+  // edges of the area
+  double lat = ref_lat, lon = (FENCE_GEN_LON0 + FENCE_GEN_LON1) / 2;
+  double heading = 0.3, k = cos(ref_lat * M_PI / 180);
+  uint32_t lcg = 3;
+  int wrong = 0, edge = 0, ref_enter = 0, max_inside = 0;
+  static bool ref_in[FENCES];
+  for (int i = 0; i < FIXES; i++) {
+    lcg = lcg * 1103515245u + 12345u;
+    heading += ((int)(lcg >> 20) % 200 - 100) / 1000.0;
+    double step = 0.1 + 0.5 * ((lcg >> 8) & 0xFF) / 255.0;
+    lat += step * cos(heading) / 111320.0;
+    lon += step * sin(heading) / (111320.0 * k);
+    if (lat < FENCE_GEN_LAT0 || lat > FENCE_GEN_LAT1 ||
+        lon < FENCE_GEN_LON0 || lon > FENCE_GEN_LON1) {
+      heading += M_PI;
+      lat = fmin(fmax(lat, FENCE_GEN_LAT0), FENCE_GEN_LAT1);
+      lon = fmin(fmax(lon, FENCE_GEN_LON0), FENCE_GEN_LON1);
+    }
+    // Compare on the position geofence.c sees
+    int32_t la = e7(lat), lo = e7(lon);
+    geofence_update(la, lo, (uint32_t)i);
+
+    int inside = 0;
+    for (int f = 0; f < FENCES; f++) {
+      double d;
+      bool in = fence_gen_contains(&gen[f], la / 1e7, lo / 1e7, ref_lat, &d);
+      ref_enter += in && !ref_in[f];
+      ref_in[f] = in;
+      inside += in;
+      if (in != ev.inside[f]) {
+        if (d < EDGE_M)
+          edge++;
+        else
+          wrong++;
+      }
+    }
+    max_inside = inside > max_inside ? inside : max_inside;
+  }
+  geofence_stats_t st;
+  geofence_get_stats(&st);
+  printf("%d fixes: %d enters (reference %d), %d on-edge fixes that differ, "
+         "%.1f fences tested per fix, up to %d inside\n",
+         FIXES, ev.enter, ref_enter, edge,
+         (double)st.candidates / st.fixes, max_inside);
+  CHECK_EQ(wrong, 0);
+  CHECK(ev.enter > FIXES / 500);
+  CHECK(max_inside <= GEOFENCE_MAX_INSIDE);
+  CHECK_EQ(st.fixes, FIXES);
+  CHECK(st.candidates < (uint64_t)st.fixes * 50);
+  geofence_set_callback(NULL, NULL);
+}
+
+int main(void) {
+  test_parse();
+  test_sources();
+  test_random();
+  return test_result("test_geofence");
+}
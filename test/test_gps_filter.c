@@ -0,0 +1,239 @@
+// gps_filter.c on the host: epochs from 10 Hz NMEA in either sentence
+// order, then an hour of the simulated loop (filter_1h.csv: truth and a
+// receiver fix with correlated error and multipath jumps) at 10 Hz and at
+// 1 Hz, against the truth. At 1 Hz the position drawn every 100 ms is
+// compared too, dead reckoned as the OLED does and held as before.
+#include "geo.h"
+#include "gps_filter.h"
+#include "gps_parser.h"
+#include "test_util.h"
+#include <math.h>
+
+#define ROWS 36000
+#define M_PER_E7 (GEO_CM_PER_E7_X100000 / 1e7)
+
+typedef struct {
+  int64_t t_us;
+  int32_t true_lat, true_lon, lat, lon;
+  uint16_t hdop_e2, course_cdeg;
+  uint32_t speed_ckmh;
+} row_t;
+
+static row_t rows[ROWS];
+static size_t row_count;
+
+static double err_m(int32_t lat, int32_t lon, const row_t *r) {
+  double k = cos(r->true_lat / 1e7 * M_PI / 180);
+  return hypot((double)(lat - r->true_lat),
+               (double)(lon - r->true_lon) * k) * M_PER_E7;
+}
+
+static void sentence(char *buf, size_t size, const char *type, int epoch) {
+  // One epoch every 100 ms from 12:00:00.00; each has its own position
+  // and speed so a mixed-up epoch shows
+  int cs = epoch * 10, s = cs / 100;
+  char time[16];
+  snprintf(time, sizeof(time), "12%02d%02d.%02d", s / 60, s % 60, cs % 100);
+  if (strcmp(type, "GGA") == 0)
+    snprintf(buf, size, "$GPGGA,%s,2250.%05d,S,04306.00000,W,1,09,0.80,"
+             "4.0,M,-5.4,M,,*00", time, epoch);
+  else if (strcmp(type, "RMC") == 0)
+    snprintf(buf, size, "$GPRMC,%s,A,2250.%05d,S,04306.00000,W,%d.000,"
+             "90.00,180524,,,A*00", time, epoch, epoch);
+  else
+    snprintf(buf, size, "$GPGSA,A,3,01,02,03,04,,,,,,,,,1.50,0.80,1.20*00");
+}
+
+// The ingest task steps once per new gps_data_t.epoch: a GGA and an RMC of
+// the same hhmmss.ss, in either order
+static void test_epochs(void) {
+  gps_reset_data();
+  const gps_data_t *gps = gps_get_data();
+  char buf[128];
+  uint32_t steps = 0, last_epoch = gps->epoch;
+  for (int e = 1; e <= 50; e++) {
+    static const char *const orders[][3] = {{"GGA", "GSA", "RMC"},
+                                            {"RMC", "GGA", "GSA"},
+                                            {"GSA", "RMC", "GGA"}};
+    for (int i = 0; i < 3; i++) {
+      const char *type = orders[e % 3][i];
+      sentence(buf, sizeof(buf), type, e);
+      gps_parse_nmea(buf);
+      if (gps->epoch == last_epoch)
+        continue;
+      // Stepped on the second of GGA/RMC, with both from this epoch
+      steps++;
+      last_epoch = gps->epoch;
+      CHECK(strcmp(type, "GSA") != 0);
+      CHECK_EQ(gps->time_ms, e * 100 % 1000);
+      CHECK(abs((int)gps->speed_ckmh - (int)lround(e * 185.2)) <= 1);
+      int32_t lat = -(int32_t)llround((22 + (50 + e * 1e-5) / 60) * 1e7);
+      CHECK(abs(gps->lat_e7 - lat) <= 1);
+    }
+  }
+  CHECK_EQ(steps, 50);
+
+  // A GGA alone, or repeated, does not complete an epoch
+  sentence(buf, sizeof(buf), "GGA", 51);
+  gps_parse_nmea(buf);
+  gps_parse_nmea(buf);
+  sentence(buf, sizeof(buf), "GGA", 52);
+  gps_parse_nmea(buf);
+  CHECK_EQ(gps->epoch, last_epoch);
+  sentence(buf, sizeof(buf), "RMC", 52);
+  gps_parse_nmea(buf);
+  gps_parse_nmea(buf);
+  CHECK_EQ(gps->epoch, last_epoch + 1);
+}
+
+static void load_rows(void) {
+  char *text = fixture_load("filter_1h.csv", NULL), **lines;
+  size_t n = fixture_lines(text, &lines);
+  for (size_t i = 1; i < n && row_count < ROWS; i++) {
+    long t, tl, tn, ts, la, lo, h, sp, co;
+    if (sscanf(lines[i], "%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld", &t, &tl, &tn,
+               &ts, &la, &lo, &h, &sp, &co) != 9)
+      continue;
+    rows[row_count++] = (row_t){(int64_t)t * 1000, (int32_t)tl, (int32_t)tn,
+                                (int32_t)la, (int32_t)lo, (uint16_t)h,
+                                (uint16_t)co, (uint32_t)sp};
+  }
+  free(lines);
+  free(text);
+  CHECK_EQ(row_count, ROWS);
+}
+
+typedef struct {
+  double raw, filtered, held, reckoned; // RMS, metres
+  uint32_t outliers, resets;
+} replay_t;
+
+// Filter every `every`-th row; error on every row
+static replay_t replay(int every) {
+  gps_filter_reset();
+  gps_filter_stats_t before, after;
+  gps_filter_get_stats(&before);
+  double raw = 0, filt = 0, held = 0, dr = 0;
+  size_t fixes = 0;
+  gps_filter_state_t st = {0};
+  const row_t *last = NULL;
+  for (size_t i = 0; i < row_count; i++) {
+    const row_t *r = &rows[i];
+    if (i % every == 0) {
+      gps_filter_meas_t m = {r->t_us,      r->lat,         r->lon,
+                             r->hdop_e2,   r->speed_ckmh,  r->course_cdeg,
+                             true};
+      gps_filter_update(&m, &st);
+      last = r;
+      double e = err_m(r->lat, r->lon, r);
+      raw += e * e;
+      e = err_m(st.lat_e7, st.lon_e7, r);
+      filt += e * e;
+      fixes++;
+    }
+    int32_t lat, lon;
+    gps_filter_position_at(&st, r->t_us, &lat, &lon);
+    double e = err_m(lat, lon, r);
+    dr += e * e;
+    e = err_m(last->lat, last->lon, r);
+    held += e * e;
+  }
+  gps_filter_get_stats(&after);
+  return (replay_t){sqrt(raw / fixes),
+                    sqrt(filt / fixes),
+                    sqrt(held / row_count),
+                    sqrt(dr / row_count),
+                    after.outliers - before.outliers,
+                    after.resets - before.resets};
+}
+
+static void test_replay(void) {
+  load_rows();
+  for (int every = 1; every <= 10; every += 9) {
+    replay_t r = replay(every);
+    printf("%2d Hz: RMS raw %.2f m, filtered %.2f m; every 100 ms: held "
+           "%.2f m, dead reckoned %.2f m; %u outliers, %u resets\n",
+           10 / every, r.raw, r.filtered, r.held, r.reckoned, r.outliers,
+           r.resets);
+    CHECK(r.filtered < 0.6 * r.raw);
+    CHECK(r.reckoned < r.held);
+    CHECK(r.outliers > 0);
+    CHECK_EQ(r.resets, 1);
+  }
+}
+
+static void test_state(void) {
+  gps_filter_reset();
+  gps_filter_state_t st;
+  gps_filter_get(&st);
+  CHECK(!st.valid);
+  char json[GPS_FILTER_JSON_MAX];
+  gps_filter_json(json, sizeof(json), 0);
+  CHECK_STR(json, "");
+
+  // Due east at 18 km/h (5 m/s)
+  gps_filter_meas_t m = {1000000, -228400000, -431100000, 80, 1800, 9000,
+                         true};
+  gps_filter_stats_t s0, s1;
+  gps_filter_get_stats(&s0);
+  uint32_t seq = gps_filter_get(&st);
+  CHECK(gps_filter_update(&m, &st));
+  CHECK_EQ(gps_filter_get(&st), seq + 1);
+  CHECK(st.valid);
+  CHECK_EQ(st.lat_e7, m.lat_e7);
+  CHECK_EQ(st.speed_ckmh, 1800);
+  CHECK_EQ(st.course_cdeg, 9000);
+
+  // Dead reckoning: 5 m east per second, held after GPS_FILTER_DR_MAX_US
+  int32_t lat, lon, lat3, lon3;
+  gps_filter_position_at(&st, st.time_us + 1000000, &lat, &lon);
+  double east = (double)(lon - st.lon_e7) * M_PER_E7 *
+                cos(st.lat_e7 / 1e7 * M_PI / 180);
+  CHECK(fabs(east - 5) < 0.05 && lat == st.lat_e7);
+  gps_filter_position_at(&st, st.time_us + GPS_FILTER_DR_MAX_US, &lat3,
+                         &lon3);
+  gps_filter_position_at(&st, st.time_us + 60000000, &lat, &lon);
+  CHECK_EQ(lon, lon3);
+  gps_filter_position_at(&st, st.time_us - 1000000, &lat, &lon);
+  CHECK_EQ(lon, st.lon_e7);
+
+  gps_filter_json(json, sizeof(json), st.time_us);
+  CHECK_STR(json, ",\"filtered\":{\"latitude\":-22.8400000,"
+                  "\"longitude\":-43.1100000,\"speed\":18.00,"
+                  "\"course\":90.0,\"sigma\":3.4}");
+
+  // A jump far outside the gate is rejected, at 10 Hz, until it has lasted
+  // GPS_FILTER_OUTLIER_RESET_US; then the filter restarts on it
+  m.lat_e7 += 90000; // 1 km north
+  int rejected = 0;
+  for (;;) {
+    m.time_us += 100000;
+    if (gps_filter_update(&m, &st))
+      break;
+    rejected++;
+    CHECK(st.lat_e7 < m.lat_e7 - 80000);
+  }
+  CHECK_EQ(rejected, GPS_FILTER_OUTLIER_RESET_US / 100000);
+  CHECK_EQ(st.lat_e7, m.lat_e7);
+  // A good fix ends a run: the next jump is rejected again
+  m.time_us += 100000;
+  CHECK(gps_filter_update(&m, &st));
+  m.time_us += 100000;
+  m.lat_e7 -= 90000;
+  CHECK(!gps_filter_update(&m, &st));
+  m.lat_e7 += 90000;
+  // As does a gap longer than GPS_FILTER_MAX_GAP_US
+  m.time_us += GPS_FILTER_MAX_GAP_US + 1;
+  CHECK(gps_filter_update(&m, &st));
+  gps_filter_get_stats(&s1);
+  CHECK_EQ(s1.outliers - s0.outliers, (uint32_t)rejected + 2);
+  CHECK_EQ(s1.resets - s0.resets, 3);
+  CHECK_EQ(s1.updates - s0.updates, (uint32_t)rejected + 5);
+}
+
+int main(void) {
+  test_epochs();
+  test_state();
+  test_replay();
+  return test_result("test_gps_filter");
+}
@@ -0,0 +1,130 @@
+// gps_parser.c sentence handlers, talkers and GSV bookkeeping, then the
+// multi-GNSS capture end to end
+#include "gps_parser.h"
+#include "test_util.h"
+
+static void test_talkers(void) {
+  gps_reset_data();
+  gps_parse_nmea("$GNGGA,101010.00,2250.00000,S,04306.00000,W,1,09,0.80,12.3,"
+                 "M,-5.4,M,,*68");
+  const gps_data_t *gps = gps_get_data();
+  CHECK_EQ(gps->lat_e7, -228333333);
+  CHECK_EQ(gps->lon_e7, -431000000);
+  CHECK_EQ(gps->alt_cm, 1230);
+  CHECK_EQ(gps->satellites, 9);
+  CHECK_EQ(gps->hdop_e2, 80);
+  CHECK(gps->valid);
+
+  // Same formatter from another talker goes through the same parser
+  gps_parse_nmea("$GLGGA,101011.00,2251.00000,S,04306.00000,W,1,05,1.00,10.0,"
+                 "M,-5.4,M,,*72");
+  CHECK_EQ(gps->lat_e7, -228500000);
+  // Unknown formatters and malformed input change nothing
+  gps_parse_nmea("$GNTXT,01,01,02,u-blox AG*4B");
+  gps_parse_nmea("$GNGGA,no checksum");
+  gps_parse_nmea("GNGGA,101012.00,2252.00000,S*00");
+  CHECK_EQ(gps->lat_e7, -228500000);
+}
+
+static void test_gsa_vtg_zda(void) {
+  gps_reset_data();
+  const gps_data_t *gps = gps_get_data();
+  CHECK_EQ(gps->fix_type, 0);
+  gps_parse_nmea("$GNGSA,A,2,02,05,,,,,,,,,,,2.10,1.20,1.70,1*00");
+  CHECK_EQ(gps->fix_type, GPS_FIX_2D);
+  CHECK_EQ(gps->pdop_e2, 210);
+  CHECK_EQ(gps->hdop_e2, 120);
+  CHECK_EQ(gps->vdop_e2, 170);
+
+  gps_parse_nmea("$GNVTG,359.99,T,,M,10.000,N,18.520,K,A*00");
+  CHECK_EQ(gps->course_cdeg, 35999);
+  CHECK_EQ(gps->speed_ckmh, 1852);
+  gps_parse_nmea("$GNVTG,,T,,M,,N,,K,N*00"); // no fix: previous values stay
+  CHECK_EQ(gps->course_cdeg, 35999);
+
+  gps_parse_nmea("$GNZDA,235959.50,31,12,2023,00,00*00");
+  CHECK_STR(gps->date, "311223");
+  CHECK_STR(gps->timestamp, "235959");
+}
+
+static void test_gsv(void) {
+  gps_reset_data();
+  const gps_data_t *gps = gps_get_data();
+  gps_parse_nmea("$GPGSV,2,1,06,01,40,083,46,02,17,308,41,12,07,344,39,"
+                 "14,22,228,45,1*00");
+  gps_parse_nmea("$GPGSV,2,2,06,15,10,100,,16,11,200,30,1*00");
+  gps_parse_nmea("$GLGSV,1,1,03,65,40,083,36,66,17,308,,67,07,344,29,1*00");
+  CHECK_EQ(gps->sats_in_view, 9);
+  CHECK_EQ(gps->sats_stored, 9);
+  CHECK_EQ(gps->sats[6].talker, 'L');
+  CHECK_EQ(gps->sats[6].prn, 65);
+  CHECK_EQ(gps->sats[4].snr, 0); // in view, not tracked
+
+  // A new GPS cycle replaces only the GPS entries
+  gps_parse_nmea("$GPGSV,1,1,02,01,40,083,46,02,17,308,41,1*00");
+  CHECK_EQ(gps->sats_in_view, 5);
+  CHECK_EQ(gps->sats_stored, 5);
+
+  // In view counts the receiver's field 3 even past the storage limit
+  gps_reset_data();
+  char s[96];
+  for (int msg = 1; msg <= 10; msg++) {
+    snprintf(s, sizeof(s), "$GPGSV,10,%d,40,%02d,40,083,46,%02d,17,308,41,"
+             "%02d,07,344,39,%02d,22,228,45*00", msg, msg * 4 - 3,
+             msg * 4 - 2, msg * 4 - 1, msg * 4);
+    gps_parse_nmea(s);
+  }
+  CHECK_EQ(gps->sats_in_view, 40);
+  CHECK_EQ(gps->sats_stored, GPS_MAX_SATS_STORED);
+}
+
+static void test_unix_time(void) {
+  gps_data_t gps = {0};
+  CHECK_EQ(gps_unix_time(&gps), 0);
+  strcpy(gps.timestamp, "120000");
+  strcpy(gps.date, "180524");
+  CHECK_EQ(gps_unix_time(&gps), 1716033600);
+  strcpy(gps.date, "290224");
+  strcpy(gps.timestamp, "235959");
+  CHECK_EQ(gps_unix_time(&gps), 1709251199);
+}
+
+// Every second of the capture: fix type 3 and the in-view count equal to
+// the sum of the three constellations' GSV field 3
+static void test_capture(void) {
+  char *text = fixture_load("gnss_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines);
+  gps_reset_data();
+  const gps_data_t *gps = gps_get_data();
+  uint32_t in_view = 0, seconds = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (strncmp(lines[i], "$GNRMC", 6) == 0 && i) {
+      CHECK_EQ(gps->sats_in_view, in_view);
+      in_view = 0;
+    }
+    if (strncmp(lines[i] + 3, "GSV,", 4) == 0 && lines[i][9] == '1')
+      in_view += strtoul(lines[i] + 11, NULL, 10);
+    gps_parse_nmea(lines[i]);
+    if (strncmp(lines[i], "$GNZDA", 6) == 0) {
+      seconds++;
+      CHECK_EQ(gps->fix_type, GPS_FIX_3D);
+      CHECK(gps->valid && gps->sats_stored <= GPS_MAX_SATS_STORED);
+    }
+  }
+  CHECK_EQ(seconds, 600);
+  CHECK_EQ(gps->sats_in_view, 26);
+  CHECK_STR(gps->date, "180524");
+  CHECK_STR(gps->timestamp, "120959");
+  CHECK_EQ(gps_unix_time(gps), 1716033600 + 599);
+  free(lines);
+  free(text);
+}
+
+int main(void) {
+  test_talkers();
+  test_gsa_vtg_zda();
+  test_gsv();
+  test_unix_time();
+  test_capture();
+  return test_result("test_gps_parser");
+}
@@ -0,0 +1,285 @@
+// wifi_http.c's /api/stream on the host, behind the httpd stand-in: the
+// 1 Hz capture replayed at 10 fixes per second of fake clock to four
+// subscribers. Every fast client gets every fix once, as one chunk holding
+// one "data:" event equal to /api/gps at that moment; notifies between two
+// fan-outs merge; a fifth stream is refused. A client that reads every 2 s
+// through small socket buffers misses frames but never gets a torn one; a
+// client that stops reading is closed after HTTP_STREAM_STALL_MS; one that
+// hangs up frees its slot. The longest fix JSON still fits the frame.
+#include "esp_timer.h"
+#include "gps_filter.h"
+#include "gps_parser.h"
+#include "http_standin.h"
+#include "test_util.h"
+#include "wifi_http.h"
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define FIX_US 100000 // 10 Hz
+#define SLOW_READ_FIXES 20
+#define RX_BYTES 65536
+#define EVENT_MAX 1024
+
+typedef struct {
+  int fd;
+  char rx[RX_BYTES];
+  size_t len;
+  bool head_seen;
+  bool bad; // framing or event did not parse
+  bool eof;
+  int events;
+  char last[EVENT_MAX]; // JSON of the newest event
+} sub_t;
+
+// Everything the client end has now, without waiting; rx stays a string
+// (the stream is text)
+static void sub_read(sub_t *s) {
+  while (s->len < sizeof(s->rx) - 1) {
+    ssize_t n = recv(s->fd, s->rx + s->len, sizeof(s->rx) - 1 - s->len,
+                     MSG_DONTWAIT);
+    if (n == 0)
+      s->eof = true;
+    if (n <= 0)
+      break;
+    s->len += (size_t)n;
+  }
+  s->rx[s->len] = '\0';
+}
+
+// Consumes the response head, then whole chunks; each must be one
+// "data: <json>\n\n" event, the first one after a "retry:" line
+static void sub_parse(sub_t *s) {
+  size_t pos = 0;
+  if (!s->head_seen) {
+    char *end = strstr(s->rx, "\r\n\r\n");
+    if (!end)
+      return;
+    *end = '\0'; // the checks below stay within the head
+    s->bad |= !strstr(s->rx, "HTTP/1.1 200 OK") ||
+              !strstr(s->rx, "Content-Type: text/event-stream") ||
+              !strstr(s->rx, "Transfer-Encoding: chunked");
+    s->head_seen = true;
+    pos = end + 4 - s->rx;
+  }
+  for (;;) {
+    char *line = strstr(s->rx + pos, "\r\n");
+    if (!line)
+      break;
+    char *end;
+    size_t size = strtoul(s->rx + pos, &end, 16);
+    size_t data = line + 2 - s->rx;
+    if (end != line || size == 0) {
+      s->bad = true;
+      break;
+    }
+    if (data + size + 2 > s->len)
+      break;
+    char *ev = s->rx + data;
+    if (memcmp(ev + size, "\r\n", 2) != 0) {
+      s->bad = true;
+      break;
+    }
+    if (s->events == 0 && strncmp(ev, "retry: ", 7) == 0)
+      ev = strchr(ev, '\n') + 1;
+    size_t ev_len = s->rx + data + size - ev;
+    if (ev_len < 10 || strncmp(ev, "data: {", 7) != 0 ||
+        strncmp(ev + ev_len - 3, "}\n\n", 3) != 0 ||
+        ev_len - 8 >= sizeof(s->last)) {
+      s->bad = true;
+      break;
+    }
+    memcpy(s->last, ev + 6, ev_len - 8);
+    s->last[ev_len - 8] = '\0';
+    s->events++;
+    pos = data + size + 2;
+  }
+  memmove(s->rx, s->rx + pos, s->len - pos + 1);
+  s->len -= pos;
+}
+
+static void sub_drain(sub_t *s) {
+  sub_read(s);
+  sub_parse(s);
+}
+
+static void sub_open(sub_t *s) {
+  memset(s, 0, sizeof(*s));
+  esp_err_t ret;
+  s->fd = http_standin_request(HTTP_GET, "/api/stream", NULL, &ret);
+  CHECK(s->fd >= 0 && ret == ESP_OK);
+  sub_drain(s);
+  CHECK_EQ(s->events, 1);
+}
+
+// The /api/gps body now, through its own session
+static void api_gps(char *out, size_t size) {
+  esp_err_t ret;
+  int fd = http_standin_request(HTTP_GET, "/api/gps", NULL, &ret);
+  char resp[EVENT_MAX + 256];
+  size_t len = 0;
+  struct pollfd p = {.fd = fd, .events = POLLIN};
+  while (len < sizeof(resp) - 1 && poll(&p, 1, 100) > 0) {
+    ssize_t n = recv(fd, resp + len, sizeof(resp) - 1 - len, 0);
+    if (n <= 0)
+      break;
+    len += (size_t)n;
+    resp[len] = '\0';
+    if (strstr(resp, "\r\n\r\n") && resp[len - 1] == '}')
+      break;
+  }
+  close(fd);
+  resp[len] = '\0';
+  char *body = strstr(resp, "\r\n\r\n");
+  snprintf(out, size, "%s", body ? body + 4 : "");
+}
+
+static http_stream_stats_t stream_stats(void) {
+  http_stream_stats_t st;
+  http_stream_get_stats(&st);
+  return st;
+}
+
+int main(void) {
+  host_set_time_us(1000000);
+  gps_reset_data();
+  CHECK_EQ(http_server_start(), ESP_OK);
+  static sub_t subs[HTTP_STREAM_MAX_CLIENTS + 1];
+
+  // Nobody listening: nothing queued
+  http_stream_notify();
+  CHECK_EQ(http_standin_pending(), 0);
+
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS; i++)
+    sub_open(&subs[i]);
+  CHECK_EQ(stream_stats().clients, HTTP_STREAM_MAX_CLIENTS);
+
+  // One over: 503, and httpd ends that session
+  esp_err_t ret;
+  sub_t *extra = &subs[HTTP_STREAM_MAX_CLIENTS];
+  memset(extra, 0, sizeof(*extra));
+  extra->fd = http_standin_request(HTTP_GET, "/api/stream", NULL, &ret);
+  CHECK_EQ(ret, ESP_FAIL);
+  http_standin_run();
+  sub_read(extra);
+  CHECK(strstr(extra->rx, "503 Service Unavailable") != NULL);
+  CHECK(extra->eof);
+  close(extra->fd);
+  CHECK_EQ(stream_stats().refused, 1);
+
+  // Fan-outs merge: three notifies, one event each
+  http_stream_notify();
+  http_stream_notify();
+  http_stream_notify();
+  CHECK_EQ(http_standin_pending(), 1);
+  CHECK_EQ(http_standin_run(), 1);
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS; i++) {
+    sub_drain(&subs[i]);
+    CHECK_EQ(subs[i].events, 2);
+  }
+
+  // From here on, subscribers with small buffers: 0 and 1 read every fix,
+  // 2 every SLOW_READ_FIXES, 3 never
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS; i++)
+    close(subs[i].fd);
+  http_standin_run();
+  CHECK_EQ(stream_stats().clients, 0);
+  http_standin_set_buffers(4096, 2048);
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS; i++)
+    sub_open(&subs[i]);
+
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines);
+  uint32_t epoch = 0, fixes = 0, mismatched = 0, stuck_at = 0;
+  char want[EVENT_MAX];
+  for (size_t i = 0; i < n; i++) {
+    gps_parse_nmea(lines[i]);
+    if (gps_get_data()->epoch == epoch)
+      continue;
+    epoch = gps_get_data()->epoch;
+    gps_publish();
+    host_advance_us(FIX_US);
+    http_stream_notify();
+    http_standin_run();
+    fixes++;
+    for (int c = 0; c < 2; c++) {
+      int before = subs[c].events;
+      sub_drain(&subs[c]);
+      CHECK_EQ(subs[c].events, before + 1);
+    }
+    api_gps(want, sizeof(want));
+    mismatched += strcmp(subs[0].last, want) != 0;
+    if (fixes % SLOW_READ_FIXES == 0)
+      sub_drain(&subs[2]);
+    if (!stuck_at && stream_stats().closed)
+      stuck_at = fixes;
+  }
+  free(lines);
+  free(text);
+
+  http_stream_stats_t st = stream_stats();
+  CHECK(fixes >= 500);
+  CHECK_EQ(mismatched, 0);
+  CHECK_EQ(subs[0].events, (int)fixes + 1);
+  CHECK(!subs[0].bad && !subs[1].bad && !subs[2].bad);
+  // The slow reader lost frames, whole ones, and stayed subscribed
+  sub_drain(&subs[2]);
+  CHECK(!subs[2].eof && !subs[2].bad);
+  CHECK(subs[2].events > (int)fixes / 4 && subs[2].events < (int)fixes);
+  CHECK(st.skipped >= fixes - subs[2].events);
+  // The one that never read went after the stall time, nobody else
+  CHECK_EQ(st.closed, 1);
+  CHECK(stuck_at * FIX_US / 1000 > HTTP_STREAM_STALL_MS);
+  CHECK(stuck_at * FIX_US / 1000 < HTTP_STREAM_STALL_MS + 5000);
+  http_standin_run();
+  sub_read(&subs[3]);
+  CHECK(subs[3].eof);
+  CHECK_EQ(st.clients, HTTP_STREAM_MAX_CLIENTS - 1);
+  CHECK_EQ(st.build_failed, 0);
+  printf("%u fixes: slow reader got %d, %u skipped; stuck one closed after "
+         "%u fixes\n",
+         (unsigned)fixes, subs[2].events, (unsigned)st.skipped,
+         (unsigned)stuck_at);
+
+  // A client that hangs up frees its slot without a send error
+  close(subs[3].fd);
+  close(subs[1].fd);
+  http_standin_run();
+  CHECK_EQ(stream_stats().clients, HTTP_STREAM_MAX_CLIENTS - 2);
+  CHECK_EQ(stream_stats().closed, 1);
+  sub_open(&subs[1]);
+  sub_open(&subs[3]);
+  CHECK_EQ(stream_stats().clients, HTTP_STREAM_MAX_CLIENTS);
+
+  // The longest fix JSON: every field at its widest, with the filtered
+  // object (a first fix with a large error)
+  gps_filter_meas_t m = {esp_timer_get_time(), -899999999, -1799999999,
+                         UINT16_MAX, 99999999, 35999, true};
+  gps_filter_state_t filt;
+  gps_filter_update(&m, &filt);
+  CHECK(filt.valid);
+  gps_data_t *gps = gps_get_data();
+  gps->valid = false;
+  gps->lat_e7 = INT32_MIN;
+  gps->lon_e7 = INT32_MIN;
+  gps->alt_cm = INT32_MIN;
+  gps->speed_ckmh = 0x80000000u;
+  gps->course_cdeg = UINT16_MAX;
+  gps->hdop_e2 = UINT16_MAX;
+  gps->satellites = gps->fix_type = gps->sats_in_view = UINT8_MAX;
+  memset(gps->timestamp, '9', sizeof(gps->timestamp) - 1);
+  memset(gps->date, '9', sizeof(gps->date) - 1);
+  gps_publish();
+  http_stream_notify();
+  http_standin_run();
+  sub_drain(&subs[0]);
+  api_gps(want, sizeof(want));
+  CHECK_STR(subs[0].last, want);
+  CHECK_EQ(stream_stats().build_failed, 0);
+  printf("longest event: %zu bytes of JSON\n", strlen(subs[0].last));
+
+  for (int i = 0; i < HTTP_STREAM_MAX_CLIENTS; i++)
+    close(subs[i].fd);
+  return test_result("test_http_stream");
+}
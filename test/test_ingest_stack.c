@@ -0,0 +1,242 @@
+// Stack depth of gps_ingest_task() in src/main.c over the whole pipeline:
+// the 10 Hz UBX and the multi-GNSS 1 Hz NMEA captures fed in UART-sized
+// reads through the framer, parser, publish, filter, history, trip stats,
+// nearby marks, 1000 geofences (events go to the MQTT client), the
+// simplifier, the SD log, the MQTT queue and the web stream notify. Each
+// mode runs on a thread with a painted stack; the depth is the lowest byte
+// written below the task's entry frame. x86-64 frames hold 8-byte
+// registers and are 16-byte aligned, so this is above the RV32 build for
+// the same calls; the ESP_LOGI() lines, dropped here, are budgeted in
+// GPS_INGEST_STACK_BYTES. Linked with -z now: a lazily bound first call into
+// libm runs the dynamic linker on this stack, which the device never does.
+#include "fence_gen.h"
+#include "geofence.h"
+#include "gps_filter.h"
+#include "gps_parser.h"
+#include "map_index.h"
+#include "esp_timer.h"
+#include "mqtt_client.h"
+#include "mqtt_queue.h"
+#include "mqtt_standin.h"
+#include "nmea.h"
+#include "sd_logger.h"
+#include "test_util.h"
+#include "track.h"
+#include "track_simplify.h"
+#include "trip_stats.h"
+#include "ubx.h"
+#include "wifi_http.h"
+#include <pthread.h>
+
+// Stack given to the task in src/main.c and the part of it the host depth
+// may use: the rest is for ESP_LOGI()'s vprintf and the trap frame
+#define GPS_INGEST_STACK_BYTES 5120
+#define HOST_DEPTH_MAX 3584
+
+#define STACK_BYTES (256 * 1024)
+#define PAINT 0xA5
+#define FENCES 1000
+
+static nmea_framer_t nmea_framer;
+static ubx_decoder_t ubx_decoder;
+static bool gps_updated;
+static track_simplifier_t simplifier;
+static uint32_t queued_points;
+
+// Callbacks and on_fix_epoch() as in src/main.c, same calls in the same
+// order
+static void on_nmea_frame(const char *sentence, void *ctx) {
+  gps_parse_nmea(sentence);
+  gps_updated = true;
+}
+
+static void on_ubx_frame(uint8_t msg_class, uint8_t msg_id,
+                         const uint8_t *payload, uint16_t len, void *ctx) {
+  if (ubx_apply_frame(msg_class, msg_id, payload, len, gps_get_data()))
+    gps_updated = true;
+}
+
+static void on_simplified_fix(const sd_log_record_t *rec) {
+  sd_logger_append_record(rec);
+  if (mqtt_queue_offer(rec))
+    queued_points++;
+}
+
+static bool filter_fix(const gps_data_t *gps, gps_filter_state_t *out) {
+  if (!gps_data_has_fix(gps))
+    return false;
+  gps_filter_meas_t m = {
+      .time_us = esp_timer_get_time(),
+      .lat_e7 = gps->lat_e7,
+      .lon_e7 = gps->lon_e7,
+      .hdop_e2 = gps->hdop_e2,
+      .speed_ckmh = gps->speed_ckmh,
+      .course_cdeg = gps->course_cdeg,
+      .has_velocity = true,
+  };
+  gps_filter_update(&m, out);
+  return out->valid;
+}
+
+static uint32_t events;
+static void on_geofence_event(const geofence_event_t *ev, void *ctx) {
+  mqtt_publish_geofence_event(ev);
+  events++;
+}
+
+static void on_fix_epoch(const gps_data_t *gps) {
+  gps_filter_state_t filt;
+  bool filtered = filter_fix(gps, &filt);
+
+  track_fix_t fix;
+  if (track_fix_from_gps(gps, &fix)) {
+    if (filtered) {
+      fix.lat_e7 = filt.lat_e7;
+      fix.lon_e7 = filt.lon_e7;
+    }
+    if (track_append(&fix)) {
+      trip_stats_update(fix.time, fix.lat_e7, fix.lon_e7,
+                        filtered ? filt.speed_ckmh : gps->speed_ckmh);
+      map_nearby_update(fix.lat_e7, fix.lon_e7);
+      geofence_update(fix.lat_e7, fix.lon_e7, fix.time);
+    }
+  }
+
+  sd_log_record_t rec, out;
+  if (sd_log_record_from_gps(gps, &rec)) {
+    if (filtered) {
+      rec.lat_e7 = filt.lat_e7;
+      rec.lon_e7 = filt.lon_e7;
+      rec.crc8 = sd_log_crc8((const uint8_t *)&rec, sizeof(rec) - 1);
+    }
+    if (track_simplify_push(&simplifier, &rec, &out))
+      on_simplified_fix(&out);
+  } else if (track_simplify_flush(&simplifier, &out)) {
+    on_simplified_fix(&out);
+  }
+}
+
+typedef struct {
+  const char *fixture;
+  uint8_t *data;
+  size_t len;
+  bool ubx;
+  int64_t epoch_us; // fake clock step per fix
+  uint32_t epochs;
+  size_t depth;
+} run_t;
+
+static uint8_t *stack_lo;
+static uintptr_t entry_sp;
+
+// The task loop body for one capture: gps_drain_uart()'s 256-byte reads,
+// then the publish and epoch step after each
+static __attribute__((noinline)) void replay(run_t *r) {
+  uint32_t last_epoch = 0;
+  for (size_t pos = 0; pos < r->len; pos += 256) {
+    uint8_t buf[256];
+    size_t n = r->len - pos < sizeof(buf) ? r->len - pos : sizeof(buf);
+    memcpy(buf, r->data + pos, n);
+    if (r->ubx)
+      ubx_decoder_feed(&ubx_decoder, buf, n, on_ubx_frame, NULL);
+    else
+      nmea_framer_feed(&nmea_framer, buf, n, on_nmea_frame, NULL);
+
+    if (gps_updated) {
+      gps_publish();
+      gps_updated = false;
+      const gps_data_t *gps = gps_get_data();
+      if (gps->epoch != last_epoch) {
+        last_epoch = gps->epoch;
+        host_advance_us(r->epoch_us);
+        on_fix_epoch(gps);
+        http_stream_notify();
+        r->epochs++;
+      }
+    }
+  }
+}
+
+static void *ingest_thread(void *arg) {
+  entry_sp = (uintptr_t)__builtin_frame_address(0);
+  replay(arg);
+  return NULL;
+}
+
+static void run(run_t *r) {
+  gps_reset_data();
+  gps_filter_reset();
+  nmea_framer_init(&nmea_framer);
+  ubx_decoder_init(&ubx_decoder);
+  track_simplify_init(&simplifier, TRACK_SIMPLIFY_TOL_M,
+                      TRACK_SIMPLIFY_KEEPALIVE_S);
+
+  memset(stack_lo, PAINT, STACK_BYTES);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, stack_lo, STACK_BYTES);
+  pthread_t t;
+  CHECK_EQ(pthread_create(&t, &attr, ingest_thread, r), 0);
+  pthread_join(t, NULL);
+  pthread_attr_destroy(&attr);
+
+  size_t untouched = 0;
+  while (untouched < STACK_BYTES && stack_lo[untouched] == PAINT)
+    untouched++;
+  r->depth = entry_sp - (uintptr_t)(stack_lo + untouched);
+  printf("%s: %lu fixes, deepest %zu B below the task entry\n", r->fixture,
+         (unsigned long)r->epochs, r->depth);
+  CHECK(r->epochs > 0);
+}
+
+int main(void) {
+  run_t runs[] = {
+      {.fixture = "nav_10hz.ubx", .ubx = true, .epoch_us = 100000},
+      {.fixture = "gnss_1hz.nmea", .ubx = false, .epoch_us = 1000000},
+  };
+  for (int i = 0; i < 2; i++)
+    runs[i].data = (uint8_t *)fixture_load(runs[i].fixture, &runs[i].len);
+  const char *dir = scratch_enter();
+  host_set_time_us(1000000);
+  host_nvs_reset();
+  CHECK_EQ(track_init(), ESP_OK);
+  CHECK_EQ(trip_stats_init(), ESP_OK);
+  CHECK_EQ(sd_logger_init(), ESP_OK);
+  CHECK_EQ(mqtt_queue_init(NULL), ESP_OK);
+  // Connected, so each geofence event is published as on the device
+  mqtt_standin_set_broker(MQTT_STANDIN_UP);
+  CHECK_EQ(mqtt_init(), ESP_OK);
+  CHECK_EQ(mqtt_connect(), ESP_OK);
+  host_set_sta_ip(0x6401A8C0u); // MQTT_BROKER_HOST
+  for (int i = 0; i < 100 && !mqtt_is_connected(); i++) {
+    host_advance_us(10000);
+    mqtt_standin_poll();
+    mqtt_service();
+  }
+  CHECK(mqtt_is_connected());
+  CHECK_EQ(http_server_start(), ESP_OK);
+  static gen_fence_t gen[FENCES];
+  static char text[FENCES * 320];
+  CHECK(fence_gen(1, FENCES, gen, text, sizeof(text)) > 0);
+  CHECK_EQ(geofence_load_text(text), ESP_OK);
+  geofence_set_callback(on_geofence_event, NULL);
+
+  stack_lo = aligned_alloc(4096, STACK_BYTES);
+  size_t deepest = 0;
+  for (int i = 0; i < 2; i++) {
+    run(&runs[i]);
+    if (runs[i].depth > deepest)
+      deepest = runs[i].depth;
+    free(runs[i].data);
+  }
+  free(stack_lo);
+  printf("%lu geofence events; %zu of %d B budgeted for the host depth, "
+         "task stack %d B\n",
+         (unsigned long)events, deepest, HOST_DEPTH_MAX,
+         GPS_INGEST_STACK_BYTES);
+  CHECK(events > 0);
+  CHECK(deepest <= HOST_DEPTH_MAX);
+  CHECK(sd_logger_flush() == ESP_OK);
+  scratch_leave(dir);
+  return test_result("test_ingest_stack");
+}
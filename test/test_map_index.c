@@ -0,0 +1,191 @@
+// map_index.c against brute force on a regional extract built by
+// tools/osm2tiles.py (seamarks.bin, 5000 marks, a four-level tree): kNN
+// distances for random points, k and kind masks, bbox results and early
+// stop, then the nearby list on the bundled map.
+#include "map_index.h"
+#include "map_render.h"
+#include "test_util.h"
+
+static const map_header_t *map;
+static uint32_t lcg = 23;
+
+static uint32_t rnd(uint32_t n) {
+  lcg = lcg * 1103515245u + 12345u;
+  return (lcg >> 8) % n;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static uint64_t dist2(const map_poi_t *p, int32_t x, int32_t y) {
+  int64_t dx = (int64_t)p->x - x, dy = (int64_t)p->y - y;
+  return (uint64_t)(dx * dx + dy * dy);
+}
+
+static uint8_t random_mask(void) {
+  switch (rnd(4)) {
+  case 0:
+    return MAP_POI_KIND_ALL;
+  case 1:
+    return (uint8_t)(1u << (1 + rnd(5)));
+  default:
+    return (uint8_t)((1u << (1 + rnd(5))) | (1u << (1 + rnd(5))));
+  }
+}
+
+static void test_names(void) {
+  CHECK_EQ(map_poi_kind_mask("wreck"), 1u << MAP_POI_WRECK);
+  CHECK_EQ(map_poi_kind_mask("all"), MAP_POI_KIND_ALL);
+  CHECK_EQ(map_poi_kind_mask(NULL), MAP_POI_KIND_ALL);
+  CHECK_EQ(map_poi_kind_mask("ferry"), 0);
+  CHECK_STR(map_poi_kind_name(MAP_POI_LIGHT), "light");
+  CHECK_STR(map_poi_kind_name(200), "other");
+
+  int named = 0;
+  for (uint32_t i = 0; i < map->poi_count; i++) {
+    const char *name = map_poi_name(map, map_poi_get(map, i));
+    named += name && strncmp(name, "Mark ", 5) == 0;
+  }
+  CHECK_EQ(named, map->poi_count / 2);
+  CHECK(map_poi_get(map, map->poi_count) == NULL);
+}
+
+static void test_knn(void) {
+  static uint64_t all[8192];
+  int bad = 0;
+  for (int q = 0; q < 3000; q++) {
+    // Up to a fifth of the extent outside the map on every side
+    int32_t x = (int32_t)rnd(map->width * 7 / 5) - map->width / 5;
+    int32_t y = (int32_t)rnd(map->height * 7 / 5) - map->height / 5;
+    uint8_t mask = random_mask(), k = (uint8_t)(1 + rnd(MAP_POI_MAX_K + 4));
+    map_poi_hit_t hits[MAP_POI_MAX_K];
+    uint8_t n = map_index_nearest(map, x, y, mask, k, hits);
+
+    uint32_t m = 0;
+    for (uint32_t i = 0; i < map->poi_count; i++) {
+      const map_poi_t *p = map_poi_get(map, i);
+      if (mask & (1u << p->kind))
+        all[m++] = dist2(p, x, y);
+    }
+    qsort(all, m, sizeof(all[0]), cmp_u64);
+    uint32_t want = k > MAP_POI_MAX_K ? MAP_POI_MAX_K : k;
+    want = want < m ? want : m;
+    if (n != want) {
+      bad++;
+      continue;
+    }
+    // Ties may come in any order; distances and ids must agree
+    for (uint8_t i = 0; i < n; i++) {
+      const map_poi_t *p = map_poi_get(map, hits[i].id);
+      bad += hits[i].dist2 != all[i] || dist2(p, x, y) != hits[i].dist2 ||
+             !(mask & (1u << p->kind));
+    }
+  }
+  CHECK_EQ(bad, 0);
+  map_poi_hit_t hit;
+  CHECK_EQ(map_index_nearest(map, 0, 0, MAP_POI_KIND_ALL, 0, &hit), 0);
+  CHECK_EQ(map_index_nearest(map, 0, 0, 0, 1, &hit), 0);
+  CHECK_EQ(map_index_nearest(NULL, 0, 0, MAP_POI_KIND_ALL, 1, &hit), 0);
+}
+
+typedef struct {
+  uint32_t count, stop_after;
+  uint64_t id_sum;
+} visit_t;
+
+static bool on_poi(uint32_t id, const map_poi_t *poi, void *ctx) {
+  visit_t *v = ctx;
+  v->count++;
+  v->id_sum += id;
+  return v->count != v->stop_after;
+}
+
+static void test_bbox(void) {
+  int bad = 0;
+  for (int q = 0; q < 1000; q++) {
+    map_bbox_t b;
+    b.x0 = (uint16_t)rnd(map->width);
+    b.y0 = (uint16_t)rnd(map->height);
+    uint32_t w = rnd(q % 10 ? map->width / 8 : map->width);
+    uint32_t h = rnd(q % 10 ? map->height / 8 : map->height);
+    b.x1 = (uint16_t)(b.x0 + w > 0xFFFF ? 0xFFFF : b.x0 + w);
+    b.y1 = (uint16_t)(b.y0 + h > 0xFFFF ? 0xFFFF : b.y0 + h);
+    uint8_t mask = random_mask();
+
+    visit_t v = {0};
+    uint32_t found = map_index_bbox(map, &b, mask, on_poi, &v);
+    uint32_t count = 0;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < map->poi_count; i++) {
+      const map_poi_t *p = map_poi_get(map, i);
+      if ((mask & (1u << p->kind)) && p->x >= b.x0 && p->x <= b.x1 &&
+          p->y >= b.y0 && p->y <= b.y1) {
+        count++;
+        sum += i;
+      }
+    }
+    bad += found != count || v.count != count || v.id_sum != sum;
+
+    // A callback returning false ends the walk
+    if (count > 3) {
+      visit_t stop = {.stop_after = 3};
+      bad += map_index_bbox(map, &b, mask, on_poi, &stop) != 3;
+    }
+  }
+  CHECK_EQ(bad, 0);
+  map_bbox_t whole = {0, 0, 0xFFFF, 0xFFFF};
+  CHECK_EQ(map_index_bbox(map, &whole, MAP_POI_KIND_ALL, NULL, NULL),
+           map->poi_count);
+}
+
+// Nearby list on the bundled extract: distances, bearings, sequence
+static void test_nearby(void) {
+  CHECK_EQ(map_open(map_blob, map_blob_size), ESP_OK);
+  const map_header_t *m = map_get();
+  CHECK(m->poi_count >= MAP_NEARBY_K);
+  const map_poi_t *p = map_poi_get(m, 0);
+
+  // 1250 units (100 m at 8 cm units) due south of the first mark
+  int32_t lat, lon;
+  CHECK_EQ(m->unit_log2_cm, 3);
+  map_unproject(p->x, p->y - 1250, &lat, &lon);
+  map_nearby_t before, after;
+  uint32_t seq = map_nearby_get(&before);
+  map_nearby_update(lat, lon);
+  CHECK_EQ(map_nearby_get(&after), seq + 1);
+  CHECK_EQ(after.lat_e7, lat);
+  CHECK_EQ(after.count, MAP_NEARBY_K);
+  bool found = false;
+  for (uint8_t i = 0; i < after.count; i++) {
+    if (i > 0)
+      CHECK(after.hits[i].dist_m >= after.hits[i - 1].dist_m);
+    if (after.hits[i].id == 0) {
+      found = true;
+      CHECK(after.hits[i].dist_m >= 99 && after.hits[i].dist_m <= 101);
+      CHECK(after.hits[i].bearing_deg == 0 || after.hits[i].bearing_deg == 359);
+    }
+  }
+  CHECK(found);
+
+  // Due west of it: the mark bears 090
+  CHECK_EQ(map_poi_bearing(p, p->x - 500, p->y), 90);
+  CHECK_EQ(map_poi_bearing(p, p->x, p->y + 500), 180);
+  CHECK_EQ(map_index_dist_m(m, 1250ull * 1250), 100);
+}
+
+int main(void) {
+  size_t len;
+  uint8_t *blob = (uint8_t *)fixture_load("seamarks.bin", &len);
+  CHECK_EQ(map_open(blob, (uint32_t)len), ESP_OK);
+  map = map_get();
+  CHECK_EQ(map->poi_count, 5000);
+  CHECK_EQ(map->rtree_levels, 4); // 313, 20, 2 and 1 nodes
+  test_names();
+  test_knn();
+  test_bbox();
+  test_nearby();
+  free(blob);
+  return test_result("test_map_index");
+}
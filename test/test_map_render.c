@@ -0,0 +1,320 @@
+// map_render.c over the bundled extract: the generated src/map_data.c
+// against a fresh tools/osm2tiles.py run (map.bin), the blob structure, the
+// projection, and rendered frames against an independent reference (every
+// way decoded and drawn with float clipping) at all zoom levels. Only the
+// tiles whose box meets the viewport may be visited.
+#include "map_index.h"
+#include "map_render.h"
+#include "oled.h"
+#include "oled_backend.h"
+#include "test_util.h"
+#include <math.h>
+
+#define MAX_POINTS 4096
+
+static const map_header_t *hdr;
+// Pixels some way should light, with a one-pixel border off the screen
+static bool ref[OLED_HEIGHT + 2][OLED_WIDTH + 2];
+static bool must[OLED_HEIGHT][OLED_WIDTH]; // solid lines, must be lit
+static bool skip[OLED_HEIGHT][OLED_WIDTH]; // under the marker or a mark
+
+// Narrowest zoom per class, as documented in map_render.c
+static const uint8_t min_zoom[] = {0, 0, 0, 2, 1, 1, 2, 0, 1};
+
+static const map_tile_t *tile_at(int i) {
+  return (const map_tile_t *)(map_blob + hdr->tiles_off) + i;
+}
+
+// Point stream of a feature, decoded independently of the renderer
+static int decode(const map_feature_t *f, int32_t *xs, int32_t *ys) {
+  const uint8_t *p = (const uint8_t *)(f + 1), *end = p + f->size;
+  int n = 0;
+  xs[0] = p[0] | p[1] << 8;
+  ys[0] = p[2] | p[3] << 8;
+  for (p += 4, n = 1; p < end && n < MAX_POINTS; p += 2, n++) {
+    if ((int8_t)p[0] == -128) {
+      xs[n] = p[2] | p[3] << 8;
+      ys[n] = p[4] | p[5] << 8;
+      p += 4;
+    } else {
+      xs[n] = xs[n - 1] + (int8_t)p[0];
+      ys[n] = ys[n - 1] + (int8_t)p[1];
+    }
+  }
+  return n;
+}
+
+static bool in_box(const map_bbox_t *b, int32_t x, int32_t y) {
+  return x >= b->x0 && x <= b->x1 && y >= b->y0 && y <= b->y1;
+}
+
+static void test_blob(void) {
+  size_t len;
+  char *bin = fixture_load("map.bin", &len);
+  CHECK_EQ(len, map_blob_size);
+  CHECK(len == map_blob_size && memcmp(bin, map_blob, len) == 0);
+  free(bin);
+
+  hdr = map_get();
+  CHECK(hdr != NULL);
+  CHECK_EQ(hdr->size, map_blob_size);
+
+  // Bad magic, truncated, misaligned
+  static uint32_t copy[4096];
+  memcpy(copy, map_blob, map_blob_size);
+  copy[0] ^= 1;
+  CHECK_EQ(map_open((const uint8_t *)copy, map_blob_size),
+           ESP_ERR_INVALID_VERSION);
+  copy[0] ^= 1;
+  CHECK_EQ(map_open((const uint8_t *)copy, map_blob_size - 1),
+           ESP_ERR_INVALID_SIZE);
+  CHECK_EQ(map_open((const uint8_t *)copy + 2, map_blob_size),
+           ESP_ERR_INVALID_ARG);
+  CHECK_EQ(map_open(map_blob, map_blob_size), ESP_OK);
+  hdr = map_get();
+}
+
+// Features are contiguous by tile, points stay inside their boxes and
+// tile boxes cover their features
+static void test_structure(void) {
+  static int32_t xs[MAX_POINTS], ys[MAX_POINTS];
+  int tiles = hdr->tiles_x * hdr->tiles_y, features = 0, bad = 0;
+  uint32_t offset = hdr->tiles_off + tiles * sizeof(map_tile_t);
+  for (int t = 0; t < tiles; t++) {
+    const map_tile_t *tile = tile_at(t);
+    CHECK_EQ(tile->offset, offset);
+    const uint8_t *p = map_blob + tile->offset;
+    for (int i = 0; i < tile->count; i++, features++) {
+      const map_feature_t *f = (const map_feature_t *)p;
+      int n = decode(f, xs, ys);
+      CHECK(n >= 2 && f->size % 2 == 0);
+      for (int k = 0; k < n; k++)
+        bad += !in_box(&f->bbox, xs[k], ys[k]) ||
+               xs[k] >= hdr->width || ys[k] >= hdr->height;
+      bad += f->closed && (xs[0] != xs[n - 1] || ys[0] != ys[n - 1]);
+      bad += !in_box(&tile->bbox, f->bbox.x0, f->bbox.y0) ||
+             !in_box(&tile->bbox, f->bbox.x1, f->bbox.y1);
+      p += sizeof(*f) + f->size;
+    }
+    offset = (uint32_t)(p - map_blob);
+  }
+  CHECK_EQ(features, hdr->feature_count);
+  CHECK(offset <= hdr->poi_off);
+  CHECK_EQ(bad, 0);
+
+  for (uint32_t i = 0; i < hdr->poi_count; i++) {
+    const map_poi_t *poi = map_poi_get(hdr, i);
+    CHECK(poi->x < hdr->width && poi->y < hdr->height);
+    CHECK(poi->kind >= MAP_POI_BUOY && poi->kind <= MAP_POI_OTHER);
+  }
+}
+
+static void test_projection(void) {
+  uint32_t lcg = 5;
+  int bad = 0;
+  for (int i = 0; i < 100000; i++) {
+    lcg = lcg * 1103515245u + 12345u;
+    int32_t x = (int32_t)((lcg >> 8) % hdr->width);
+    lcg = lcg * 1103515245u + 12345u;
+    int32_t y = (int32_t)((lcg >> 8) % hdr->height);
+    int32_t lat, lon, x2, y2;
+    map_unproject(x, y, &lat, &lon);
+    CHECK(map_project(lat, lon, &x2, &y2));
+    bad += abs(x2 - x) > 1 || abs(y2 - y) > 1 || !map_contains(lat, lon);
+  }
+  CHECK_EQ(bad, 0);
+  // Just outside the south-west corner
+  CHECK(!map_contains(hdr->origin_lat_e7 - 1, hdr->origin_lon_e7));
+  CHECK(!map_contains(hdr->origin_lat_e7, hdr->origin_lon_e7 - 1));
+}
+
+typedef struct {
+  int32_t cx, cy;
+  int shift;
+} view_t;
+
+static double sx(const view_t *v, int32_t x) {
+  return OLED_WIDTH / 2 + ((x - v->cx) >> v->shift);
+}
+
+static double sy(const view_t *v, int32_t y) {
+  return OLED_HEIGHT / 2 - ((y - v->cy) >> v->shift);
+}
+
+static void mark(bool (*set)[OLED_WIDTH], int x, int y, int r) {
+  for (int j = y - r; j <= y + r; j++)
+    for (int i = x - r; i <= x + r; i++)
+      if (i >= 0 && i < OLED_WIDTH && j >= 0 && j < OLED_HEIGHT)
+        set[j][i] = true;
+}
+
+// Segment cut to the screen and its border (Liang-Barsky), then stepped one
+// pixel at a time. A line passing just off a corner can round onto it.
+static void ref_segment(double x0, double y0, double x1, double y1,
+                        bool solid) {
+  double t0 = 0, t1 = 1, dx = x1 - x0, dy = y1 - y0;
+  double p[4] = {-dx, dx, -dy, dy};
+  double q[4] = {x0 + 1, OLED_WIDTH - x0, y0 + 1, OLED_HEIGHT - y0};
+  for (int i = 0; i < 4; i++) {
+    if (p[i] == 0) {
+      if (q[i] < 0)
+        return;
+    } else if (p[i] < 0) {
+      t0 = fmax(t0, q[i] / p[i]);
+    } else {
+      t1 = fmin(t1, q[i] / p[i]);
+    }
+  }
+  if (t0 > t1)
+    return;
+  double n = ceil(fmax(fabs(dx), fabs(dy)) * (t1 - t0));
+  for (int k = 0; k <= n; k++) {
+    double t = n ? t0 + (t1 - t0) * k / n : t0;
+    int x = (int)lround(x0 + dx * t), y = (int)lround(y0 + dy * t);
+    if (x < -1 || x > OLED_WIDTH || y < -1 || y > OLED_HEIGHT)
+      continue;
+    ref[y + 1][x + 1] = true;
+    // Ends moved by the integer clipper are checked by the stray test only
+    if (solid && x > 1 && x < OLED_WIDTH - 2 && y > 1 && y < OLED_HEIGHT - 2)
+      must[y][x] = true;
+  }
+}
+
+static void ref_render(const view_t *v, uint8_t zoom) {
+  static int32_t xs[MAX_POINTS], ys[MAX_POINTS];
+  memset(ref, 0, sizeof(ref));
+  memset(must, 0, sizeof(must));
+  memset(skip, 0, sizeof(skip));
+  for (int t = 0; t < hdr->tiles_x * hdr->tiles_y; t++) {
+    const uint8_t *p = map_blob + tile_at(t)->offset;
+    for (int i = 0; i < tile_at(t)->count; i++) {
+      const map_feature_t *f = (const map_feature_t *)p;
+      p += sizeof(*f) + f->size;
+      if (f->kind < sizeof(min_zoom) && min_zoom[f->kind] > zoom)
+        continue;
+      bool solid = f->kind != MAP_KIND_SEAMARK && f->kind != MAP_KIND_BOUNDARY;
+      int n = decode(f, xs, ys);
+      for (int k = 1; k < n; k++)
+        ref_segment(sx(v, xs[k - 1]), sy(v, ys[k - 1]), sx(v, xs[k]),
+                    sy(v, ys[k]), solid);
+    }
+  }
+  for (uint32_t i = 0; i < hdr->poi_count; i++) {
+    const map_poi_t *poi = map_poi_get(hdr, i);
+    mark(skip, (int)sx(v, poi->x), (int)sy(v, poi->y), 3);
+  }
+  mark(skip, OLED_WIDTH / 2, OLED_HEIGHT / 2, 4);
+}
+
+static bool lit(const uint8_t *ram, int x, int y) {
+  return (ram[(y / 8) * OLED_WIDTH + x] >> (y % 8)) & 1;
+}
+
+static bool near_ref(int x, int y) {
+  for (int j = y; j <= y + 2; j++)
+    for (int i = x; i <= x + 2; i++)
+      if (ref[j][i])
+        return true;
+  return false;
+}
+
+static bool near_lit(const uint8_t *ram, int x, int y) {
+  for (int j = y - 1; j <= y + 1; j++)
+    for (int i = x - 1; i <= x + 1; i++)
+      if (i >= 0 && i < OLED_WIDTH && j >= 0 && j < OLED_HEIGHT &&
+          lit(ram, i, j))
+        return true;
+  return false;
+}
+
+// Tiles the renderer should visit: the same one-pixel viewport margin
+static int visible_tiles(const view_t *v) {
+  int32_t rx = (OLED_WIDTH / 2 + 1) << v->shift;
+  int32_t ry = (OLED_HEIGHT / 2 + 1) << v->shift;
+  int n = 0;
+  for (int t = 0; t < hdr->tiles_x * hdr->tiles_y; t++) {
+    const map_bbox_t *b = &tile_at(t)->bbox;
+    n += b->x0 <= b->x1 && b->x0 <= v->cx + rx && b->x1 >= v->cx - rx &&
+         b->y0 <= v->cy + ry && b->y1 >= v->cy - ry;
+  }
+  return n;
+}
+
+// One frame: stray pixels (nothing near the reference), missing pixels
+// (solid reference not lit within one pixel), marks drawn where expected
+static void check_frame(int32_t lat, int32_t lon, uint8_t zoom, int *stray,
+                        int *missing, int *bad_tiles, int *bad_marks) {
+  view_t v = {.shift = MAP_ZOOM0_LOG2_CM - zoom - hdr->unit_log2_cm};
+  map_project(lat, lon, &v.cx, &v.cy);
+  map_render_stats_t st;
+  oled_clear();
+  CHECK_EQ(map_render(lat, lon, zoom, &st), ESP_OK);
+  oled_display();
+  const uint8_t *ram = oled_host_ram();
+  ref_render(&v, zoom);
+  for (int y = 0; y < OLED_HEIGHT; y++) {
+    for (int x = 0; x < OLED_WIDTH; x++) {
+      if (skip[y][x])
+        continue;
+      *stray += lit(ram, x, y) && !near_ref(x, y);
+      *missing += must[y][x] && !near_lit(ram, x, y);
+    }
+  }
+  *bad_tiles += st.tiles != visible_tiles(&v);
+
+  // Every mark fully on screen is drawn (the R-tree query found it)
+  for (uint32_t i = 0; i < hdr->poi_count; i++) {
+    const map_poi_t *poi = map_poi_get(hdr, i);
+    int px = (int)sx(&v, poi->x), py = (int)sy(&v, poi->y);
+    if (px < 2 || px >= OLED_WIDTH - 2 || py < 2 || py >= OLED_HEIGHT - 2 ||
+        (abs(px - OLED_WIDTH / 2) < 6 && abs(py - OLED_HEIGHT / 2) < 6))
+      continue;
+    int on = 0;
+    for (int j = -2; j <= 2; j++)
+      for (int k = -2; k <= 2; k++)
+        on += lit(ram, px + k, py + j);
+    *bad_marks += on < 8;
+  }
+}
+
+static void test_render(void) {
+  uint32_t lcg = 17;
+  int stray = 0, missing = 0, bad_tiles = 0, bad_marks = 0, frames = 0;
+  for (int i = 0; i < 2000; i++) {
+    lcg = lcg * 1103515245u + 12345u;
+    int32_t x = (int32_t)((lcg >> 8) % hdr->width);
+    lcg = lcg * 1103515245u + 12345u;
+    int32_t y = (int32_t)((lcg >> 8) % hdr->height);
+    int32_t lat, lon;
+    map_unproject(x, y, &lat, &lon);
+    for (uint8_t zoom = 0; zoom < MAP_ZOOM_LEVELS; zoom++, frames++)
+      check_frame(lat, lon, zoom, &stray, &missing, &bad_tiles, &bad_marks);
+  }
+  printf("%d frames: %d stray, %d missing pixels\n", frames, stray, missing);
+  CHECK_EQ(stray, 0);
+  CHECK_EQ(missing, 0);
+  CHECK_EQ(bad_tiles, 0);
+  CHECK_EQ(bad_marks, 0);
+
+  // Far outside the extract: no tile visited, only the own-position marker
+  map_render_stats_t st;
+  oled_clear();
+  CHECK_EQ(map_render(hdr->origin_lat_e7 - 10000000, hdr->origin_lon_e7, 0,
+                      &st),
+           ESP_OK);
+  CHECK_EQ(st.tiles, 0);
+  CHECK_EQ(st.features, 0);
+  CHECK_EQ(st.pois, 0);
+  CHECK_EQ(map_render(0, 0, MAP_ZOOM_LEVELS, &st), ESP_ERR_INVALID_ARG);
+  CHECK_EQ(map_scale_m(0, 32), 655);
+  CHECK_EQ(map_scale_m(3, 32), 81);
+}
+
+int main(void) {
+  CHECK_EQ(oled_init_backend(&oled_backend_host), ESP_OK);
+  test_blob();
+  test_structure();
+  test_projection();
+  test_render();
+  return test_result("test_map_render");
+}
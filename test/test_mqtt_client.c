@@ -0,0 +1,322 @@
+// mqtt_client.c's connection manager on the host, against the broker
+// stand-in and the STA address of stubs/host_stubs.c. Every boot is a
+// forked process, so the module starts from its power-on state: retries
+// back off from MQTT_BACKOFF_MIN_MS to MQTT_BACKOFF_MAX_MS with at most 25%
+// jitter, whether the broker refuses or never answers (then after
+// MQTT_CONNECT_TIMEOUT_MS); flaps, including a CONNACK and a drop seen in
+// the same tick; the server network coming and going; and the conn stats.
+// The MQTT task is stepped every TICK_MS, finer than main.c's 500 ms, so
+// the delays can be checked to the tick.
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "mqtt_client.h"
+#include "mqtt_standin.h"
+#include "test_util.h"
+#include <sys/wait.h>
+
+#define TICK_MS 10
+#define SERVER_IP 0x6401A8C0u // 192.168.1.100
+#define OTHER_IP 0x0500000Au  // 10.0.0.5
+#define MAX_ATTEMPTS 256
+
+static uint32_t attempt_at[MAX_ATTEMPTS];
+static int attempt_n;
+// Jitter seen by check_backoff(), percent of the backoff
+static int jitter_min = 100, jitter_max;
+
+// Runs fn in a child process, a fresh boot; its failures count here
+static void boot(void (*fn)(void)) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    fn();
+    fflush(stdout);
+    _exit(test_failures ? 1 : 0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static uint32_t now_ms(void) {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static mqtt_conn_stats_t conn_stats(void) {
+  mqtt_conn_stats_t cs;
+  mqtt_get_conn_stats(&cs);
+  return cs;
+}
+
+static mqtt_standin_stats_t broker_stats(void) {
+  mqtt_standin_stats_t ss;
+  mqtt_standin_get_stats(&ss);
+  return ss;
+}
+
+// One MQTT task tick; notes the time of every new attempt
+static void tick(void) {
+  host_advance_us(TICK_MS * 1000);
+  mqtt_standin_poll();
+  mqtt_service();
+  uint32_t attempts = broker_stats().attempts;
+  while (attempt_n < (int)attempts && attempt_n < MAX_ATTEMPTS)
+    attempt_at[attempt_n++] = now_ms();
+}
+
+static void run_ms(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += TICK_MS)
+    tick();
+}
+
+// Ticks until connected or `limit` ms; returns the time taken
+static uint32_t run_until_connected(uint32_t limit) {
+  uint32_t t = 0;
+  while (!mqtt_is_connected() && t < limit) {
+    tick();
+    t += TICK_MS;
+  }
+  CHECK(mqtt_is_connected());
+  return t;
+}
+
+static void start(mqtt_standin_broker_t broker, uint32_t sta_ip) {
+  host_seed_random(7);
+  host_set_time_us(1000000);
+  mqtt_standin_set_broker(broker);
+  CHECK_EQ(mqtt_init(), ESP_OK);
+  CHECK_EQ(mqtt_connect(), ESP_OK);
+  if (sta_ip)
+    host_set_sta_ip(sta_ip);
+}
+
+// Attempts from..attempt_n-1 follow one another after `answer_ms` (the
+// refusal, or the connect timeout) plus the backoff, which doubles from
+// `base` up to the maximum, plus 0-25% jitter
+static void check_backoff(int from, uint32_t base, uint32_t answer_ms) {
+  int bad = 0;
+  for (int i = from + 1; i < attempt_n; i++) {
+    uint32_t wait = attempt_at[i] - attempt_at[i - 1] - answer_ms;
+    bad += wait < base || wait > base + base / 4 + TICK_MS;
+    int pct = (int)((wait - base) * 100 / base);
+    jitter_max = pct > jitter_max ? pct : jitter_max;
+    jitter_min = pct < jitter_min ? pct : jitter_min;
+    base = base * 2 > MQTT_BACKOFF_MAX_MS ? MQTT_BACKOFF_MAX_MS : base * 2;
+  }
+  CHECK_EQ(bad, 0);
+}
+
+// A refusing broker: 1, 2, 4 .. 60 s apart, then back to 1 s once it
+// lets the device in. Then outages of a broker that comes back: how long
+// after it is up the device is in again.
+static void boot_refused(void) {
+  start(MQTT_STANDIN_REFUSE, SERVER_IP);
+  run_ms(10 * 60 * 1000);
+  CHECK(attempt_n >= 10);
+  check_backoff(0, MQTT_BACKOFF_MIN_MS, MQTT_STANDIN_CONNECT_MS);
+  mqtt_conn_stats_t cs = conn_stats();
+  CHECK_EQ(cs.state, MQTT_STATE_BACKOFF);
+  CHECK_EQ(cs.attempts, (uint32_t)attempt_n);
+  CHECK_EQ(cs.connects, 0);
+  CHECK_EQ(cs.backoff_ms, MQTT_BACKOFF_MAX_MS);
+
+  mqtt_standin_set_broker(MQTT_STANDIN_UP);
+  uint32_t wait = run_until_connected(MQTT_BACKOFF_MAX_MS * 5 / 4 + 1000);
+  cs = conn_stats();
+  CHECK_EQ(cs.state, MQTT_STATE_CONNECTED);
+  CHECK_EQ(cs.connects, 1);
+  CHECK_EQ(cs.connect_ms, MQTT_STANDIN_CONNECT_MS);
+  // The outage runs from the first attempt, when the network came up
+  CHECK_EQ(cs.reconnect_ms, now_ms() - attempt_at[0]);
+  CHECK_EQ(cs.max_reconnect_ms, cs.reconnect_ms);
+  CHECK_EQ(cs.backoff_ms, MQTT_BACKOFF_MIN_MS);
+  // Started once; every later attempt reopens the same client
+  CHECK_EQ(broker_stats().starts, 1);
+  printf("refused for 10 min: %d attempts, in %.1f s after the broker "
+         "let it\n",
+         attempt_n, wait / 1000.0);
+
+  static const uint32_t outage_s[] = {5, 30, 120, 600, 1800};
+  for (int i = 0; i < 5; i++) {
+    run_ms(60000);
+    int from = attempt_n;
+    uint32_t drops = conn_stats().drops;
+    mqtt_standin_set_broker(MQTT_STANDIN_REFUSE);
+    run_ms(outage_s[i] * 1000);
+    // The first retry waited the minimum after the drop
+    check_backoff(from, MQTT_BACKOFF_MIN_MS * 2, MQTT_STANDIN_CONNECT_MS);
+    mqtt_standin_set_broker(MQTT_STANDIN_UP);
+    wait = run_until_connected(MQTT_BACKOFF_MAX_MS * 5 / 4 + 1000);
+    cs = conn_stats();
+    CHECK_EQ(cs.drops, drops + 1);
+    CHECK(cs.reconnect_ms >= outage_s[i] * 1000);
+    // At worst the longest backoff with full jitter, and the CONNACK
+    CHECK(wait <= MQTT_BACKOFF_MAX_MS * 5 / 4 + MQTT_STANDIN_CONNECT_MS +
+                      2 * TICK_MS);
+    printf("broker away %4lu s: back %5.1f s after it\n",
+           (unsigned long)outage_s[i], wait / 1000.0);
+  }
+  CHECK(cs.max_reconnect_ms >= 1800 * 1000);
+  // The jitter spreads over its range
+  CHECK(jitter_min <= 5 && jitter_max >= 20);
+  printf("jitter %d-%d%% of the backoff over %d attempts\n", jitter_min,
+         jitter_max, attempt_n);
+}
+
+// A broker that never answers: every attempt waits out the connect
+// timeout, then the backoff as above
+static void boot_silent(void) {
+  start(MQTT_STANDIN_SILENT, SERVER_IP);
+  run_ms(MQTT_CONNECT_TIMEOUT_MS / 2);
+  CHECK_EQ(conn_stats().state, MQTT_STATE_CONNECTING);
+  run_ms(MQTT_CONNECT_TIMEOUT_MS / 2 + TICK_MS);
+  CHECK_EQ(conn_stats().state, MQTT_STATE_BACKOFF);
+  run_ms(5 * 60 * 1000);
+  CHECK(attempt_n >= 6);
+  check_backoff(0, MQTT_BACKOFF_MIN_MS, MQTT_CONNECT_TIMEOUT_MS);
+  CHECK_EQ(conn_stats().connects, 0);
+
+  // The broker wakes up; the attempt it ignored still times out first
+  mqtt_standin_set_broker(MQTT_STANDIN_UP);
+  run_until_connected(MQTT_CONNECT_TIMEOUT_MS + MQTT_BACKOFF_MAX_MS * 5 / 4 +
+                      1000);
+  CHECK_EQ(conn_stats().connects, 1);
+}
+
+// Drops while connected, uptime, and a connection won and lost between two
+// ticks of the MQTT task
+static void boot_flaps(void) {
+  start(MQTT_STANDIN_UP, SERVER_IP);
+  run_until_connected(1000);
+  mqtt_conn_stats_t cs = conn_stats();
+  CHECK_EQ(cs.connect_ms, MQTT_STANDIN_CONNECT_MS);
+  CHECK_EQ(cs.reconnect_ms, MQTT_STANDIN_CONNECT_MS);
+  uint32_t up_at = now_ms();
+  run_ms(100 * 1000);
+  cs = conn_stats();
+  CHECK_EQ(cs.uptime_s, (now_ms() - up_at) / 1000);
+  CHECK_EQ(cs.total_up_s, cs.uptime_s);
+
+  // Lost, refused twice (1 s, then 2 s), in on the third attempt
+  mqtt_standin_set_broker(MQTT_STANDIN_REFUSE);
+  tick();
+  uint32_t lost_at = now_ms();
+  cs = conn_stats();
+  CHECK_EQ(cs.state, MQTT_STATE_BACKOFF);
+  CHECK_EQ(cs.drops, 1);
+  CHECK_EQ(cs.uptime_s, 0);
+  CHECK_EQ(cs.total_up_s, 100);
+  CHECK(!mqtt_is_connected());
+  int from = attempt_n;
+  while (attempt_n < from + 2)
+    tick();
+  mqtt_standin_set_broker(MQTT_STANDIN_UP);
+  run_until_connected(MQTT_BACKOFF_MIN_MS * 10);
+  cs = conn_stats();
+  CHECK_EQ(attempt_n, from + 3);
+  CHECK_EQ(cs.connects, 2);
+  CHECK_EQ(cs.reconnect_ms, now_ms() - lost_at);
+  CHECK(cs.reconnect_ms >= 7 * MQTT_BACKOFF_MIN_MS);
+  CHECK(cs.reconnect_ms <= 7 * MQTT_BACKOFF_MIN_MS * 5 / 4 +
+                              3 * MQTT_STANDIN_CONNECT_MS + 5 * TICK_MS);
+  CHECK_EQ(cs.backoff_ms, MQTT_BACKOFF_MIN_MS);
+
+  // CONNACK and drop in one tick: counted as both, then retried
+  run_ms(10 * 1000);
+  mqtt_standin_set_broker(MQTT_STANDIN_REFUSE);
+  tick();
+  mqtt_standin_set_broker(MQTT_STANDIN_UP);
+  while (conn_stats().state != MQTT_STATE_CONNECTING)
+    tick();
+  host_advance_us(MQTT_STANDIN_CONNECT_MS * 1000);
+  mqtt_standin_poll(); // CONNECTED
+  mqtt_standin_set_broker(MQTT_STANDIN_REFUSE);
+  mqtt_standin_poll(); // DISCONNECTED
+  mqtt_service();
+  cs = conn_stats();
+  CHECK_EQ(cs.state, MQTT_STATE_BACKOFF);
+  CHECK_EQ(cs.connects, 3);
+  CHECK_EQ(cs.drops, 3);
+  CHECK_EQ(cs.uptime_s, 0);
+  mqtt_standin_set_broker(MQTT_STANDIN_UP);
+  run_until_connected(MQTT_BACKOFF_MIN_MS * 4);
+  CHECK_EQ(broker_stats().starts, 1);
+}
+
+// Only the server network (192.168.1.x) is used; leaving it goes idle at
+// once and coming back tries at once, whatever the backoff was
+static void boot_network(void) {
+  start(MQTT_STANDIN_UP, 0);
+  run_ms(5000);
+  CHECK_EQ(conn_stats().state, MQTT_STATE_IDLE);
+  host_set_sta_ip(OTHER_IP);
+  run_ms(5000);
+  CHECK_EQ(conn_stats().state, MQTT_STATE_IDLE);
+  CHECK_EQ(attempt_n, 0);
+
+  host_set_sta_ip(SERVER_IP);
+  CHECK_EQ(run_until_connected(1000), MQTT_STANDIN_CONNECT_MS + TICK_MS);
+  run_ms(5000);
+
+  // The cached flag answers before the MQTT task has run
+  host_set_sta_ip(0);
+  CHECK(!mqtt_is_connected());
+  tick();
+  mqtt_conn_stats_t cs = conn_stats();
+  CHECK_EQ(cs.state, MQTT_STATE_IDLE);
+  CHECK_EQ(cs.drops, 1);
+  CHECK_EQ(cs.total_up_s, 5);
+  run_ms(5000);
+  CHECK_EQ(attempt_n, 1);
+
+  host_set_sta_ip(SERVER_IP);
+  run_until_connected(1000);
+  host_post_event(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, NULL);
+  tick();
+  CHECK_EQ(conn_stats().state, MQTT_STATE_IDLE);
+  host_set_sta_ip(SERVER_IP);
+  run_until_connected(1000);
+
+  CHECK_EQ(mqtt_disconnect(), ESP_OK);
+  tick();
+  CHECK_EQ(conn_stats().state, MQTT_STATE_IDLE);
+  run_ms(5000);
+  CHECK_EQ(conn_stats().state, MQTT_STATE_IDLE);
+  CHECK(!mqtt_is_connected());
+  CHECK_EQ(mqtt_connect(), ESP_OK);
+  run_until_connected(1000);
+  CHECK_EQ(attempt_n, 4);
+
+  // Deep in backoff when the network goes; back on it, no wait
+  mqtt_standin_set_broker(MQTT_STANDIN_REFUSE);
+  run_ms(3 * 60 * 1000);
+  CHECK_EQ(conn_stats().backoff_ms, MQTT_BACKOFF_MAX_MS);
+  host_set_sta_ip(0);
+  run_ms(1000);
+  mqtt_standin_set_broker(MQTT_STANDIN_UP);
+  host_set_sta_ip(SERVER_IP);
+  run_until_connected(MQTT_STANDIN_CONNECT_MS + TICK_MS);
+  cs = conn_stats();
+  CHECK_EQ(cs.reconnect_ms, MQTT_STANDIN_CONNECT_MS);
+  CHECK_EQ(cs.backoff_ms, MQTT_BACKOFF_MIN_MS);
+  CHECK_EQ(broker_stats().starts, 1);
+}
+
+// The STA had its address before mqtt_init(): no event will come
+static void boot_early_ip(void) {
+  host_set_time_us(1000000);
+  host_set_sta_ip(SERVER_IP);
+  CHECK_EQ(mqtt_init(), ESP_OK);
+  CHECK_EQ(mqtt_connect(), ESP_OK);
+  run_until_connected(1000);
+  CHECK_EQ(conn_stats().attempts, 1);
+}
+
+int main(void) {
+  boot(boot_refused);
+  boot(boot_silent);
+  boot(boot_flaps);
+  boot(boot_network);
+  boot(boot_early_ip);
+  return test_result("test_mqtt_client");
+}
@@ -0,0 +1,347 @@
+// mqtt_codec.c round trips: the 1 Hz capture in batches of 1 to 32 and
+// random records at the edges of every field, through JSON, CBOR and
+// packed, decoded here (a CBOR reader for the integer/array subset, the
+// JSON rows, the raw records) and by tools/mqtt_decode.py on a hex capture
+// of all three. Buffers: MQTT_CODEC_MAX_BYTES() fits the worst case, and a
+// short buffer gives 0 without writing past its size.
+#include "gps_parser.h"
+#include "mqtt_codec.h"
+#include "test_util.h"
+#include <math.h>
+
+#ifndef PYTHON
+#define PYTHON "python3"
+#endif
+#ifndef MQTT_DECODE
+#define MQTT_DECODE "../../tools/mqtt_decode.py"
+#endif
+
+#define MAX_FIXES 1200
+// Batches as the queue sends them
+#define BATCH_MAX 32
+#define CANARY 0xA5
+
+static sd_log_record_t fixes[MAX_FIXES];
+static size_t fix_count;
+static const uint8_t formats[] = {MQTT_PAYLOAD_JSON, MQTT_PAYLOAD_CBOR,
+                                  MQTT_PAYLOAD_PACKED};
+static uint8_t buf[MQTT_CODEC_MAX_BYTES(MQTT_CODEC_MAX_FIXES) + 64];
+
+static uint32_t lcg = 47;
+
+static uint32_t rnd32(void) {
+  lcg = lcg * 1103515245u + 12345u;
+  uint32_t hi = lcg >> 16;
+  lcg = lcg * 1103515245u + 12345u;
+  return hi << 16 | lcg >> 16;
+}
+
+// Values as decoded: time, lat_e7, lon_e7, alt_cm, speed_ckmh,
+// course_cdeg, satellites, hdop_dec, flags
+typedef int64_t row_t[9];
+
+static void to_row(const sd_log_record_t *r, row_t v) {
+  int64_t f[9] = {r->time,        r->lat_e7,      r->lon_e7,
+                  r->alt_cm,      r->speed_ckmh,  r->course_cdeg,
+                  r->satellites,  r->hdop_dec,    r->flags};
+  memcpy(v, f, sizeof(f));
+}
+
+static int rows_differ(const sd_log_record_t *recs, row_t *rows, size_t n,
+                       int fields) {
+  int bad = 0;
+  for (size_t i = 0; i < n; i++) {
+    row_t want;
+    to_row(&recs[i], want);
+    for (int f = 0; f < fields; f++)
+      bad += rows[i][f] != want[f];
+  }
+  return bad;
+}
+
+// CBOR: integer and array heads only, as the codec writes them
+typedef struct {
+  const uint8_t *p, *end;
+  bool bad;
+} cbor_in_t;
+
+static uint64_t cbor_head(cbor_in_t *in, int *major) {
+  *major = -1;
+  if (in->p >= in->end) {
+    in->bad = true;
+    return 0;
+  }
+  uint8_t h = *in->p++;
+  *major = h >> 5;
+  uint8_t info = h & 0x1F;
+  if (info < 24)
+    return info;
+  if (info > 27 || in->end - in->p < 1 << (info - 24)) {
+    in->bad = true;
+    return 0;
+  }
+  uint64_t v = 0;
+  for (int i = 0; i < 1 << (info - 24); i++)
+    v = v << 8 | *in->p++;
+  return v;
+}
+
+static int64_t cbor_int(cbor_in_t *in) {
+  int major;
+  uint64_t v = cbor_head(in, &major);
+  if (major > 1)
+    in->bad = true;
+  return major == 1 ? -1 - (int64_t)v : (int64_t)v;
+}
+
+// Rows with the deltas undone; -1 when malformed
+static int decode_cbor(const uint8_t *data, size_t len, mqtt_batch_id_t *id,
+                       row_t *rows) {
+  cbor_in_t in = {data, data + len, false};
+  int major;
+  uint64_t items = cbor_head(&in, &major);
+  if (major != 4 || items < 3 || cbor_int(&in) != MQTT_CODEC_VERSION)
+    return -1;
+  id->session = (uint32_t)cbor_int(&in);
+  id->seq = (uint32_t)cbor_int(&in);
+  for (uint64_t i = 0; i < items - 3; i++) {
+    if (cbor_head(&in, &major) != 9 || major != 4)
+      return -1;
+    for (int f = 0; f < 9; f++)
+      rows[i][f] = cbor_int(&in) + (i && f < 4 ? rows[i - 1][f] : 0);
+  }
+  return in.bad || in.p != in.end ? -1 : (int)(items - 3);
+}
+
+static int decode_packed(const uint8_t *data, size_t len,
+                         mqtt_batch_id_t *id, sd_log_record_t *recs) {
+  if (len < 10 || data[0] != MQTT_CODEC_VERSION ||
+      len != 10 + data[1] * sizeof(sd_log_record_t))
+    return -1;
+  memcpy(&id->session, data + 2, 4);
+  memcpy(&id->seq, data + 6, 4);
+  memcpy(recs, data + 10, data[1] * sizeof(sd_log_record_t));
+  return data[1];
+}
+
+// The "fixes" rows of a gps/track JSON object: numbers scaled back to the
+// record's integers; true/false (mqtt_decode.py's valid) as 1/0 and the
+// fix type folded back into flags. -1 when malformed.
+static int decode_json(const char *json, mqtt_batch_id_t *id, row_t *rows,
+                       int max) {
+  static const double scale[] = {1, 1e7, 1e7, 100, 100, 100, 1, 10};
+  const char *s = strstr(json, "\"session\":");
+  const char *q = strstr(json, "\"seq\":");
+  const char *p = strstr(json, "\"fixes\":[");
+  if (!s || !q || !p)
+    return -1;
+  id->session = strtoul(s + 10, NULL, 10);
+  id->seq = strtoul(q + 6, NULL, 10);
+  int n = 0;
+  for (p += 9; *p == '[' && n < max; n++) {
+    memset(rows[n], 0, sizeof(rows[n]));
+    for (int f = 0;; f++) {
+      char *end;
+      p++;
+      if (strncmp(p, "true", 4) == 0 || strncmp(p, "false", 5) == 0) {
+        rows[n][8] |= *p == 't';
+        p += *p == 't' ? 4 : 5;
+      } else {
+        double v = strtod(p, &end);
+        if (end == p || f > 9)
+          return -1;
+        if (f < 8)
+          rows[n][f] = llround(v * scale[f]);
+        else
+          rows[n][8] |= (int64_t)v << 1;
+        p = end;
+      }
+      if (*p == ']')
+        break;
+      if (*p != ',')
+        return -1;
+    }
+    p += p[1] == ',' ? 2 : 1;
+  }
+  return *p == ']' ? n : -1;
+}
+
+static void load_capture(void) {
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines);
+  gps_reset_data();
+  for (size_t i = 0; i < n && fix_count < 600; i++) {
+    gps_parse_nmea(lines[i]);
+    if (strncmp(lines[i] + 3, "GGA", 3) == 0 &&
+        sd_log_record_from_gps(gps_get_data(), &fixes[fix_count]))
+      fix_count++;
+  }
+  free(lines);
+  free(text);
+  CHECK_EQ(fix_count, 600);
+}
+
+// Random records, every field at its edges now and then
+static void add_random(size_t n) {
+  for (size_t i = 0; i < n && fix_count < MAX_FIXES; i++) {
+    sd_log_record_t *r = &fixes[fix_count++];
+    uint32_t e = rnd32();
+    r->time = e % 7 == 0 ? (e & 8 ? UINT32_MAX : 0) : rnd32();
+    r->lat_e7 = e % 5 == 0 ? (e & 8 ? INT32_MAX : INT32_MIN) : (int32_t)rnd32();
+    r->lon_e7 = e % 3 == 0 ? (e & 8 ? INT32_MIN : INT32_MAX) : (int32_t)rnd32();
+    r->alt_cm = e % 11 == 0 ? INT32_MIN : (int32_t)rnd32();
+    r->speed_ckmh = (uint16_t)rnd32();
+    r->course_cdeg = (uint16_t)rnd32();
+    r->satellites = (uint8_t)rnd32();
+    r->hdop_dec = (uint8_t)rnd32();
+    r->flags = (uint8_t)(rnd32() & 7);
+    r->crc8 = sd_log_crc8((const uint8_t *)r, sizeof(*r) - 1);
+  }
+}
+
+static void test_round_trip(void) {
+  static row_t rows[MQTT_CODEC_MAX_FIXES];
+  static sd_log_record_t recs[MQTT_CODEC_MAX_FIXES];
+  int bad = 0, batches = 0;
+  for (size_t start = 0; start < fix_count; batches++) {
+    uint16_t n = (uint16_t)(1 + batches % BATCH_MAX);
+    if (start + n > fix_count)
+      n = (uint16_t)(fix_count - start);
+    const sd_log_record_t *in = &fixes[start];
+    mqtt_batch_id_t id = {rnd32() | 1, (uint32_t)start}, got;
+
+    size_t len = mqtt_codec_encode(MQTT_PAYLOAD_JSON, &id, in, n, buf,
+                                   sizeof(buf));
+    buf[len] = '\0';
+    CHECK(len > 0 && len <= MQTT_CODEC_MAX_BYTES(n));
+    int m = decode_json((const char *)buf, &got, rows, MQTT_CODEC_MAX_FIXES);
+    bad += m != n || got.session != id.session || got.seq != id.seq ||
+           rows_differ(in, rows, n, 8);
+
+    len = mqtt_codec_encode(MQTT_PAYLOAD_CBOR, &id, in, n, buf, sizeof(buf));
+    CHECK(len > 0 && len <= MQTT_CODEC_MAX_BYTES(n));
+    m = decode_cbor(buf, len, &got, rows);
+    bad += m != n || got.session != id.session || got.seq != id.seq ||
+           rows_differ(in, rows, n, 9);
+
+    len = mqtt_codec_encode(MQTT_PAYLOAD_PACKED, &id, in, n, buf,
+                            sizeof(buf));
+    CHECK(len > 0 && len <= MQTT_CODEC_MAX_BYTES(n));
+    m = decode_packed(buf, len, &got, recs);
+    bad += m != n || got.session != id.session || got.seq != id.seq ||
+           memcmp(recs, in, n * sizeof(*in)) != 0;
+    start += n;
+  }
+  CHECK_EQ(bad, 0);
+  CHECK(batches > 40);
+}
+
+// Worst case per format at 1, 32 and 255 fixes; every shorter buffer
+// fails cleanly
+static void test_sizes(void) {
+  static sd_log_record_t worst[MQTT_CODEC_MAX_FIXES];
+  for (int i = 0; i < MQTT_CODEC_MAX_FIXES; i++) {
+    // Alternating extremes: the longest JSON numbers and CBOR deltas
+    bool odd = i & 1;
+    worst[i] = (sd_log_record_t){
+        .time = odd ? UINT32_MAX : 0,
+        .lat_e7 = odd ? INT32_MAX : INT32_MIN,
+        .lon_e7 = odd ? INT32_MIN : INT32_MAX,
+        .alt_cm = odd ? INT32_MAX : INT32_MIN,
+        .speed_ckmh = UINT16_MAX, .course_cdeg = UINT16_MAX,
+        .satellites = UINT8_MAX, .hdop_dec = UINT8_MAX, .flags = UINT8_MAX};
+  }
+  mqtt_batch_id_t id = {UINT32_MAX, UINT32_MAX};
+  static const uint16_t counts[] = {1, 32, MQTT_CODEC_MAX_FIXES};
+  for (int c = 0; c < 3; c++) {
+    uint16_t n = counts[c];
+    for (int f = 0; f < 3; f++) {
+      size_t len = mqtt_codec_encode(formats[f], &id, worst, n, buf,
+                                     MQTT_CODEC_MAX_BYTES(n));
+      CHECK(len > 0);
+      if (n == 32)
+        printf("worst case, %u fixes: %-6s %5zu B of %d\n", n,
+               f == 0 ? "JSON" : f == 1 ? "CBOR" : "packed", len,
+               MQTT_CODEC_MAX_BYTES(n));
+      int bad = 0;
+      for (size_t size = 0; size < len; size += 1 + size / 16) {
+        memset(buf, CANARY, sizeof(buf));
+        bad += mqtt_codec_encode(formats[f], &id, worst, n, buf, size) != 0;
+        for (size_t i = size; i < sizeof(buf); i++)
+          bad += buf[i] != CANARY;
+      }
+      CHECK_EQ(bad, 0);
+    }
+  }
+  CHECK_EQ(mqtt_codec_encode(MQTT_PAYLOAD_CBOR, &id, worst, 0, buf,
+                             sizeof(buf)), 0);
+  CHECK_EQ(mqtt_codec_encode(MQTT_PAYLOAD_PACKED, &id, worst,
+                             MQTT_CODEC_MAX_FIXES + 1, buf, sizeof(buf)), 0);
+  CHECK_EQ(mqtt_codec_encode(0x08, &id, worst, 1, buf, sizeof(buf)), 0);
+  CHECK_STR(mqtt_codec_suffix(MQTT_PAYLOAD_JSON), "");
+  CHECK_STR(mqtt_codec_suffix(MQTT_PAYLOAD_CBOR), "/cbor");
+  CHECK_STR(mqtt_codec_suffix(MQTT_PAYLOAD_PACKED), "/bin");
+}
+
+// tools/mqtt_decode.py --hex over a capture of all three formats, plus a
+// packed payload with a bad record CRC
+static void test_decoder(void) {
+  const char *dir = scratch_enter();
+  FILE *cap = fopen("capture.hex", "w");
+  size_t batches = 0;
+  for (size_t start = 0; start + 32 <= fix_count; start += 32, batches++) {
+    mqtt_batch_id_t id = {7, (uint32_t)start};
+    for (int f = 0; f < 3; f++) {
+      size_t len = mqtt_codec_encode(formats[f], &id, &fixes[start], 32, buf,
+                                     sizeof(buf));
+      fprintf(cap, "gps/track%s ", mqtt_codec_suffix(formats[f]));
+      for (size_t i = 0; i < len; i++)
+        fprintf(cap, "%02x", buf[i]);
+      fputc('\n', cap);
+    }
+  }
+  mqtt_batch_id_t id = {7, 0};
+  size_t len = mqtt_codec_encode(MQTT_PAYLOAD_PACKED, &id, fixes, 1, buf,
+                                 sizeof(buf));
+  buf[len - 1] ^= 1;
+  fprintf(cap, "gps/track/bin ");
+  for (size_t i = 0; i < len; i++)
+    fprintf(cap, "%02x", buf[i]);
+  fputc('\n', cap);
+  fclose(cap);
+
+  FILE *out = popen(PYTHON " " MQTT_DECODE " --hex capture.hex", "r");
+  CHECK(out != NULL);
+  static char line[16384];
+  static row_t rows[BATCH_MAX];
+  size_t lines = 0;
+  int bad = 0;
+  while (out && fgets(line, sizeof(line), out)) {
+    size_t b = lines / 3;
+    if (b == batches) {
+      CHECK(strstr(line, "error: record 0: CRC mismatch") != NULL);
+      lines++;
+      continue;
+    }
+    mqtt_batch_id_t got;
+    // JSON passes through without the flags; binary adds valid, fix_type
+    int fields = lines % 3 == 0 ? 8 : 9;
+    int n = decode_json(line, &got, rows, BATCH_MAX);
+    bad += n != 32 || got.session != 7 || got.seq != b * 32 ||
+           rows_differ(&fixes[b * 32], rows, 32, fields);
+    lines++;
+  }
+  CHECK(out && pclose(out) == 0);
+  CHECK_EQ(lines, batches * 3 + 1);
+  CHECK_EQ(bad, 0);
+  scratch_leave(dir);
+}
+
+int main(void) {
+  load_capture();
+  add_random(MAX_FIXES - fix_count);
+  test_round_trip();
+  test_sizes();
+  test_decoder();
+  return test_result("test_mqtt_codec");
+}
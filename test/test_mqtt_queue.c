@@ -0,0 +1,531 @@
+// mqtt_queue.c on the host. Every boot is a forked process, so the module
+// starts from its power-on state each time: the dead-band rules, batches
+// by size and age, peek/ack order and RAM overflow; the spill file across
+// a power cut, with a torn slot and a corrupt header; then 6 h of track
+// through track_simplify, the queue and the real mqtt_client.c against the
+// broker stand-in, with a 1.5 h outage ended by a power cut and 2% of acks
+// lost. A subscriber that dedupes on the batch index must see every queued
+// fix once and in order, except the few still in RAM at the power cut.
+#include "geo.h"
+#include "gps_filter.h"
+#include "gps_parser.h"
+#include "mqtt_client.h"
+#include "mqtt_queue.h"
+#include "mqtt_standin.h"
+#include "test_util.h"
+#include "track_gen.h"
+#include "track_simplify.h"
+#include "trip_stats.h"
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+
+#define M_PER_E7 (GEO_CM_PER_E7_X100000 / 1e7)
+#define SPILL "mqttq.bin"
+#define HDR_BYTES 20 // queue_file_hdr_t
+#define SERVER_IP 0x6401A8C0u // 192.168.1.100
+#define HOURS 6
+#define FIXES (HOURS * 3600)
+#define OUTAGE_FROM 9000 // s, 2.5 h
+#define POWER_CUT 14400  // s, 4 h: the outage ends with a reboot
+#define DRAIN_S 600      // after the last fix
+// main.c's MQTT task periods
+#define MQTT_PERIOD_MS 10000
+#define MQTT_LIVE_PERIOD_MS 60000
+#define MQTT_STATS_PERIOD_MS 300000
+
+// Runs fn in a child process, a fresh boot; its failures count here
+static void boot(void (*fn)(void)) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    fn();
+    fflush(stdout);
+    _exit(test_failures ? 1 : 0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static int32_t metres(double m) { return (int32_t)lround(m / M_PER_E7); }
+
+static sd_log_record_t fix(uint32_t time, int32_t lat_e7, uint16_t speed,
+                           uint16_t course) {
+  sd_log_record_t r = {.time = time, .lat_e7 = lat_e7, .lon_e7 = -431100000,
+                       .speed_ckmh = speed, .course_cdeg = course,
+                       .satellites = 9, .hdop_dec = 8, .flags = 1};
+  r.crc8 = sd_log_crc8((const uint8_t *)&r, sizeof(r) - 1);
+  return r;
+}
+
+// Queues n fixes 30 m apart from *lat, one per second from *time
+static void queue_run(uint32_t *time, int32_t *lat, int n) {
+  for (int i = 0; i < n; i++) {
+    *lat += metres(30);
+    sd_log_record_t r = fix((*time)++, *lat, 0, 0);
+    CHECK(mqtt_queue_offer(&r));
+  }
+}
+
+static void boot_ram(void) {
+  host_seed_random(1);
+  host_set_time_us(1000000000);
+  CHECK_EQ(mqtt_queue_init(NULL), ESP_OK);
+
+  // Dead-band against the last queued fix
+  int32_t lat = -228400000;
+  sd_log_record_t r = fix(1000, lat, 0, 0);
+  CHECK(mqtt_queue_offer(&r));
+  r = fix(1001, lat + metres(24), 0, 0);
+  CHECK(!mqtt_queue_offer(&r));
+  r = fix(1002, lat + metres(25.5), 0, 0);
+  CHECK(mqtt_queue_offer(&r));
+  lat = r.lat_e7;
+  // A turn counts above MIN_CKMH only, across north too
+  r = fix(1003, lat, MQTT_DEADBAND_MIN_CKMH, 36000 - MQTT_DEADBAND_CDEG);
+  CHECK(mqtt_queue_offer(&r));
+  r = fix(1004, lat, MQTT_DEADBAND_MIN_CKMH, 36000 - 1);
+  CHECK(!mqtt_queue_offer(&r));
+  r = fix(1005, lat, MQTT_DEADBAND_MIN_CKMH, 1000); // 25 degrees
+  CHECK(mqtt_queue_offer(&r));
+  r = fix(1006, lat, MQTT_DEADBAND_MIN_CKMH - 1, 10000);
+  CHECK(!mqtt_queue_offer(&r));
+  // Keepalive
+  r = fix(1005 + MQTT_DEADBAND_MAX_S - 1, lat, 0, 1000);
+  CHECK(!mqtt_queue_offer(&r));
+  r = fix(1005 + MQTT_DEADBAND_MAX_S, lat, 0, 1000);
+  CHECK(mqtt_queue_offer(&r));
+  mqtt_queue_stats_t st;
+  mqtt_queue_get_stats(&st);
+  CHECK_EQ(st.offered, 9);
+  CHECK_EQ(st.queued, 5);
+
+  // A short batch waits for MQTT_BATCH_MAX_AGE_S, then comes back the
+  // same until acknowledged
+  sd_log_record_t out[MQTT_BATCH_MAX];
+  mqtt_batch_id_t id, again;
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), 0);
+  host_advance_us((MQTT_BATCH_MAX_AGE_S - 1) * 1000000LL);
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), 0);
+  host_advance_us(1000000);
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), 5);
+  CHECK(id.session != 0);
+  CHECK_EQ(id.seq, 0);
+  CHECK_EQ(out[0].time, 1000);
+  CHECK_EQ(out[4].time, 1305);
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &again), 5);
+  CHECK_EQ(again.seq, id.seq);
+  CHECK_EQ(again.session, id.session);
+  mqtt_queue_ack(5);
+
+  // A full batch leaves at once; indices continue
+  uint32_t time = 2000;
+  queue_run(&time, &lat, MQTT_BATCH_MAX + 8);
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), MQTT_BATCH_MAX);
+  CHECK_EQ(id.seq, 5);
+  CHECK_EQ(out[0].time, 2000);
+  mqtt_queue_ack(MQTT_BATCH_MAX);
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), 0);
+  CHECK_EQ(mqtt_queue_backlog(), 8);
+
+  // Overflow drops the oldest; the batch starts at the oldest kept
+  queue_run(&time, &lat, 300);
+  mqtt_queue_get_stats(&st);
+  CHECK_EQ(st.dropped, 8 + 300 - MQTT_QUEUE_RAM);
+  CHECK_EQ(st.ram, MQTT_QUEUE_RAM);
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), MQTT_BATCH_MAX);
+  CHECK_EQ(id.seq, 5 + 40 + 300 - MQTT_QUEUE_RAM);
+  CHECK_EQ(out[0].time, time - MQTT_QUEUE_RAM);
+  mqtt_queue_ack(MQTT_BATCH_MAX);
+  mqtt_queue_get_stats(&st);
+  CHECK_EQ(st.sent, 5 + 2 * MQTT_BATCH_MAX);
+  CHECK_EQ(st.batches, 3);
+}
+
+// Shared with the parent and the boots after it
+typedef struct {
+  uint32_t session;
+  uint32_t time;
+  int32_t lat;
+} spill_state_t;
+
+static spill_state_t *spill;
+
+// Offline: 100 fixes spilled, 20 more in RAM, then a power cut
+static void boot_spill(void) {
+  host_seed_random(2);
+  host_set_time_us(0);
+  CHECK_EQ(mqtt_queue_init(SPILL), ESP_OK);
+  spill->time = 5000;
+  spill->lat = -228400000;
+  queue_run(&spill->time, &spill->lat, 100);
+  mqtt_queue_spill();
+  queue_run(&spill->time, &spill->lat, 20);
+  mqtt_queue_spill(); // below MQTT_QUEUE_SPILL_AT, stays in RAM
+  mqtt_queue_stats_t st;
+  mqtt_queue_get_stats(&st);
+  CHECK_EQ(st.spilled, 100);
+  CHECK_EQ(st.file, 100);
+  CHECK_EQ(st.ram, 20);
+  sd_log_record_t out[MQTT_BATCH_MAX];
+  mqtt_batch_id_t id;
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), MQTT_BATCH_MAX);
+  CHECK_EQ(id.seq, 0);
+  spill->session = id.session;
+}
+
+// The file drains first and in order; slot 5 was torn
+static void boot_drain(void) {
+  host_seed_random(3);
+  host_set_time_us(0);
+  CHECK_EQ(mqtt_queue_init(SPILL), ESP_OK);
+  CHECK_EQ(mqtt_queue_backlog(), 100);
+  sd_log_record_t out[MQTT_BATCH_MAX];
+  mqtt_batch_id_t id;
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), 5);
+  CHECK_EQ(id.session, spill->session);
+  CHECK_EQ(id.seq, 0);
+  mqtt_queue_ack(5);
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), MQTT_BATCH_MAX - 1);
+  CHECK_EQ(id.seq, 6);
+  CHECK_EQ(out[0].time, 5006);
+  uint32_t drained = 5, expect = 5006, n;
+  for (;;) {
+    mqtt_queue_ack(n = mqtt_queue_peek(out, MQTT_BATCH_MAX, &id));
+    if (!n)
+      break;
+    CHECK_EQ(id.seq, expect - 5000);
+    for (uint32_t i = 0; i < n; i++)
+      CHECK_EQ(out[i].time, expect + i);
+    expect += n;
+    drained += n;
+  }
+  CHECK_EQ(drained, 99);
+  CHECK_EQ(expect, 5100);
+  mqtt_queue_stats_t st;
+  mqtt_queue_get_stats(&st);
+  CHECK_EQ(st.file, 0);
+  CHECK_EQ(st.sent, 99);
+  // New fixes carry on from the file's indices
+  queue_run(&spill->time, &spill->lat, MQTT_BATCH_MAX);
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), MQTT_BATCH_MAX);
+  CHECK_EQ(id.seq, 100);
+  CHECK_EQ(id.session, spill->session);
+}
+
+// A header that fails its CRC starts a new, empty queue
+static void boot_corrupt(void) {
+  host_seed_random(4);
+  host_set_time_us(0);
+  CHECK_EQ(mqtt_queue_init(SPILL), ESP_OK);
+  CHECK_EQ(mqtt_queue_backlog(), 0);
+  queue_run(&spill->time, &spill->lat, MQTT_BATCH_MAX);
+  sd_log_record_t out[MQTT_BATCH_MAX];
+  mqtt_batch_id_t id;
+  CHECK_EQ(mqtt_queue_peek(out, MQTT_BATCH_MAX, &id), MQTT_BATCH_MAX);
+  CHECK(id.session != spill->session);
+  CHECK_EQ(id.seq, 0);
+}
+
+static void flip_byte(const char *path, off_t offset) {
+  int fd = open(path, O_RDWR);
+  uint8_t b = 0;
+  CHECK(pread(fd, &b, 1, offset) == 1);
+  b ^= 0x5A;
+  CHECK(pwrite(fd, &b, 1, offset) == 1);
+  close(fd);
+}
+
+static void test_spill(void) {
+  spill = mmap(NULL, sizeof(*spill), PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  boot(boot_spill);
+  // Slot 5's CRC byte, as a write cut short would leave it
+  flip_byte(SPILL, HDR_BYTES + 5 * sizeof(sd_log_record_t) + 23);
+  boot(boot_drain);
+  flip_byte(SPILL, 8);
+  boot(boot_corrupt);
+  munmap(spill, sizeof(*spill));
+  unlink(SPILL);
+}
+
+// 6 h replay. The track and what the subscriber saw live in shared memory.
+enum { TOPIC_TRACK, TOPIC_LIVE, TOPIC_STATS, TOPIC_OTHER, TOPICS };
+
+typedef struct {
+  sd_log_record_t track[FIXES];
+  uint32_t queued[FIXES]; // times of the fixes that passed the dead-band
+  uint32_t got[FIXES];    // times the subscriber kept, in arrival order
+  uint32_t n_queued, n_got, n_queued_at_cut, lost_at_cut;
+  uint32_t session, next_index, dupes, bad_payloads;
+  uint32_t msgs[TOPICS], bytes[TOPICS];
+  uint32_t resent, acks_lost, spilled, max_backlog;
+} replay_t;
+
+static replay_t *rp;
+
+// Subscriber: keeps fixes above the highest index seen in the session
+static void on_message(const char *topic, const char *data, size_t len,
+                       void *ctx) {
+  int t = strcmp(topic, MQTT_TOPIC_TRACK) == 0    ? TOPIC_TRACK
+          : strcmp(topic, MQTT_TOPIC_GPS) == 0    ? TOPIC_LIVE
+          : strcmp(topic, MQTT_TOPIC_STATS) == 0  ? TOPIC_STATS
+                                                  : TOPIC_OTHER;
+  rp->msgs[t]++;
+  rp->bytes[t] += len;
+  if (t != TOPIC_TRACK)
+    return;
+  char *json = strndup(data, len);
+  const char *s = strstr(json, "\"session\":");
+  const char *q = strstr(json, "\"seq\":");
+  char *p = strstr(json, "\"fixes\":[");
+  if (!s || !q || !p) {
+    rp->bad_payloads++;
+    free(json);
+    return;
+  }
+  uint32_t session = strtoul(s + 10, NULL, 10);
+  uint32_t index = strtoul(q + 6, NULL, 10);
+  if (session != rp->session) {
+    rp->session = session;
+    rp->next_index = 0;
+  }
+  for (p += 9; *p == '['; index++) {
+    uint32_t time = strtoul(p + 1, &p, 10);
+    if (index < rp->next_index)
+      rp->dupes++;
+    else if (rp->n_got < FIXES)
+      rp->got[rp->n_got++] = time;
+    if (index + 1 > rp->next_index)
+      rp->next_index = index + 1;
+    p = strchr(p, ']');
+    if (!p)
+      break;
+    p += p[1] == ',' ? 2 : 1;
+  }
+  free(json);
+}
+
+// Five legs of 1.2 h, each starting where the last ended; speed and
+// course over 10 s, as smooth as the receiver's Doppler values
+static void build_track(void) {
+  static const track_gen_shape_t legs[] = {
+      TRACK_GEN_MOORED, TRACK_GEN_STRAIGHT, TRACK_GEN_CIRCLES, TRACK_GEN_GAPS,
+      TRACK_GEN_MOORED};
+  size_t per = FIXES / 5;
+  for (size_t l = 0; l < 5; l++) {
+    sd_log_record_t *leg = &rp->track[l * per];
+    track_gen(legs[l], per, leg);
+    if (l == 0)
+      continue;
+    const sd_log_record_t *end = leg - 1;
+    int32_t dlat = end->lat_e7 - leg[0].lat_e7;
+    int32_t dlon = end->lon_e7 - leg[0].lon_e7;
+    uint32_t dt = end->time + 1 - leg[0].time;
+    for (size_t i = 0; i < per; i++) {
+      leg[i].lat_e7 += dlat;
+      leg[i].lon_e7 += dlon;
+      leg[i].time += dt;
+    }
+  }
+  for (size_t i = 0; i < FIXES; i++) {
+    sd_log_record_t *r = &rp->track[i];
+    if (i >= 10) {
+      const sd_log_record_t *a = r - 10;
+      uint32_t cm = geo_distance_cm(a->lat_e7, a->lon_e7, r->lat_e7,
+                                    r->lon_e7);
+      r->speed_ckmh = (uint16_t)(cm * 36 / (r->time - a->time) / 10);
+      r->course_cdeg =
+          geo_bearing_cdeg(a->lat_e7, a->lon_e7, r->lat_e7, r->lon_e7);
+    }
+    r->alt_cm = 250;
+    r->satellites = 9;
+    r->hdop_dec = 8;
+    r->flags = 1 | 3 << 1;
+    r->crc8 = sd_log_crc8((const uint8_t *)r, sizeof(*r) - 1);
+  }
+}
+
+// The GGA and RMC of a fix, so the live message is the real one
+static void parse_fix(const sd_log_record_t *r) {
+  time_t t = r->time;
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  char hms[16], ll[64], buf[160];
+  snprintf(hms, sizeof(hms), "%02d%02d%02d.00", tm.tm_hour, tm.tm_min,
+           tm.tm_sec);
+  int32_t la = abs(r->lat_e7), lo = abs(r->lon_e7);
+  snprintf(ll, sizeof(ll), "%02d%02d.%05d,%c,%03d%02d.%05d,%c",
+           la / 10000000, la % 10000000 * 60 / 10000000,
+           (int)((int64_t)la % 10000000 * 60 % 10000000 / 100),
+           r->lat_e7 < 0 ? 'S' : 'N', lo / 10000000,
+           lo % 10000000 * 60 / 10000000,
+           (int)((int64_t)lo % 10000000 * 60 % 10000000 / 100),
+           r->lon_e7 < 0 ? 'W' : 'E');
+  snprintf(buf, sizeof(buf), "$GPGGA,%s,%s,1,09,0.80,2.5,M,-5.4,M,,*00",
+           hms, ll);
+  gps_parse_nmea(buf);
+  snprintf(buf, sizeof(buf), "$GPRMC,%s,A,%s,%u.%02u,%u.%02u,%02d%02d%02d,,,"
+           "A*00", hms, ll, r->speed_ckmh * 100 / 18520,
+           r->speed_ckmh * 100 % 18520 * 100 / 18520, r->course_cdeg / 100,
+           r->course_cdeg % 100, tm.tm_mday, tm.tm_mon + 1, tm.tm_year % 100);
+  gps_parse_nmea(buf);
+}
+
+// main.c's mqtt_task between the drain ticks
+typedef struct {
+  uint32_t published, last_period, last_live, last_stats;
+  bool live_sent, stats_sent;
+} task_t;
+
+static void mqtt_task_period(task_t *t, uint32_t now, uint32_t points) {
+  if (now - t->last_period < MQTT_PERIOD_MS)
+    return;
+  t->last_period = now;
+  trip_stats_service();
+  if (!mqtt_is_connected())
+    return;
+  if (points != t->published &&
+      (!t->live_sent || now - t->last_live >= MQTT_LIVE_PERIOD_MS) &&
+      mqtt_publish_gps_data() == ESP_OK) {
+    t->published = points;
+    t->last_live = now;
+    t->live_sent = true;
+  }
+  if ((!t->stats_sent || now - t->last_stats >= MQTT_STATS_PERIOD_MS) &&
+      mqtt_publish_trip_stats() == ESP_OK) {
+    t->last_stats = now;
+    t->stats_sent = true;
+  }
+}
+
+// Fixes [from, to), then `drain` seconds without new ones
+static void replay_boot(uint32_t from, uint32_t to, uint32_t drain) {
+  host_seed_random(10 + from);
+  host_set_time_us(0);
+  gps_reset_data();
+  gps_filter_reset();
+  CHECK_EQ(trip_stats_init(), ESP_OK);
+  CHECK_EQ(mqtt_queue_init(SPILL), ESP_OK);
+  CHECK_EQ(mqtt_init(), ESP_OK);
+  mqtt_connect();
+  mqtt_standin_set_sink(on_message, NULL);
+  mqtt_standin_set_ack_loss(20, from + 1);
+  host_set_sta_ip(SERVER_IP);
+
+  track_simplifier_t simp;
+  track_simplify_init(&simp, TRACK_SIMPLIFY_TOL_M,
+                      TRACK_SIMPLIFY_KEEPALIVE_S);
+  task_t task = {0};
+  uint32_t points = 0;
+  uint32_t ticks = 2 * (to - from + drain);
+  for (uint32_t k = 0; k < ticks; k++) {
+    uint32_t now_ms = k * 500, i = from + k / 2;
+    host_set_time_us(now_ms * 1000LL);
+    if (k % 2 == 0 && i < to) {
+      if (i == OUTAGE_FROM)
+        host_set_sta_ip(0);
+      const sd_log_record_t *r = &rp->track[i];
+      parse_fix(r);
+      gps_filter_meas_t m = {now_ms * 1000LL, r->lat_e7, r->lon_e7,
+                             80,             r->speed_ckmh, r->course_cdeg,
+                             true};
+      gps_filter_state_t st;
+      gps_filter_update(&m, &st);
+      trip_stats_update(r->time, r->lat_e7, r->lon_e7, r->speed_ckmh);
+      sd_log_record_t out;
+      if (track_simplify_push(&simp, r, &out) && mqtt_queue_offer(&out)) {
+        rp->queued[rp->n_queued++] = out.time;
+        points++;
+      }
+    }
+    mqtt_standin_poll();
+    mqtt_service();
+    mqtt_publish_queue();
+    mqtt_task_period(&task, now_ms, points);
+    uint32_t backlog = mqtt_queue_backlog();
+    if (backlog > rp->max_backlog)
+      rp->max_backlog = backlog;
+  }
+
+  mqtt_queue_stats_t qs;
+  mqtt_queue_get_stats(&qs);
+  mqtt_standin_stats_t ss;
+  mqtt_standin_get_stats(&ss);
+  rp->resent += qs.resent;
+  rp->acks_lost += ss.acks_lost;
+  rp->spilled += qs.spilled;
+  CHECK_EQ(qs.dropped, 0);
+  // The power cut loses what had not reached the spill file yet
+  if (to == POWER_CUT) {
+    rp->n_queued_at_cut = rp->n_queued;
+    rp->lost_at_cut = qs.ram;
+    CHECK(qs.ram < MQTT_QUEUE_SPILL_AT);
+  } else {
+    CHECK_EQ(mqtt_queue_backlog(), 0);
+  }
+}
+
+static void boot_replay_1(void) { replay_boot(0, POWER_CUT, 0); }
+static void boot_replay_2(void) { replay_boot(POWER_CUT, FIXES, DRAIN_S); }
+
+static void test_replay(void) {
+  rp = mmap(NULL, sizeof(*rp), PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  build_track();
+  boot(boot_replay_1);
+  boot(boot_replay_2);
+
+  // Everything queued arrives once and in order, but the RAM tail at the
+  // power cut
+  uint32_t keep = rp->n_queued_at_cut - rp->lost_at_cut, bad = 0;
+  CHECK_EQ(rp->n_got, rp->n_queued - rp->lost_at_cut);
+  for (uint32_t i = 0, j = 0; i < rp->n_queued && j < rp->n_got; i++) {
+    if (i >= keep && i < rp->n_queued_at_cut)
+      continue;
+    bad += rp->got[j++] != rp->queued[i];
+  }
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(rp->bad_payloads, 0);
+  CHECK(rp->acks_lost > 0);
+  CHECK(rp->resent > 0);
+  CHECK(rp->dupes > 0);
+  CHECK(rp->spilled > 0);
+
+  uint32_t msgs = 0, bytes = 0;
+  for (int t = 0; t < TOPICS; t++) {
+    msgs += rp->msgs[t];
+    bytes += rp->bytes[t];
+  }
+  // The old loop sent the live JSON every 10 s, and nothing while offline
+  double live = rp->msgs[TOPIC_LIVE]
+                    ? (double)rp->bytes[TOPIC_LIVE] / rp->msgs[TOPIC_LIVE]
+                    : 0;
+  printf("%d h, %u fixes: %u simplified fixes queued, %u spilled (backlog "
+         "up to %u), %u lost in RAM at the power cut; %u acks lost, %u "
+         "resends, %u duplicate fixes dropped by the subscriber\n",
+         HOURS, FIXES, rp->n_queued, rp->spilled, rp->max_backlog,
+         rp->lost_at_cut, rp->acks_lost, rp->resent, rp->dupes);
+  printf("per hour: %.1f messages, %.1f KB (track %.1f msgs %.1f KB, live "
+         "%.1f msgs %.1f KB, stats %.1f msgs); old 10 s publish: 360 msgs, "
+         "%.1f KB\n",
+         (double)msgs / HOURS, bytes / 1000.0 / HOURS,
+         (double)rp->msgs[TOPIC_TRACK] / HOURS,
+         rp->bytes[TOPIC_TRACK] / 1000.0 / HOURS,
+         (double)rp->msgs[TOPIC_LIVE] / HOURS,
+         rp->bytes[TOPIC_LIVE] / 1000.0 / HOURS,
+         (double)rp->msgs[TOPIC_STATS] / HOURS, 360 * live / 1000);
+  munmap(rp, sizeof(*rp));
+}
+
+int main(void) {
+  const char *dir = scratch_enter();
+  boot(boot_ram);
+  test_spill();
+  test_replay();
+  scratch_leave(dir);
+  return test_result("test_mqtt_queue");
+}
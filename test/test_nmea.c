@@ -0,0 +1,301 @@
+// nmea.c field scanner, fixed-point decoders and byte framer, and
+// gps_parser.c on the recorded GPS-only capture
+#include "gps_parser.h"
+#include "nmea.h"
+#include "test_util.h"
+#include <math.h>
+
+static nmea_field_t field(const char *s) {
+  return (nmea_field_t){s, (uint8_t)strlen(s)};
+}
+
+static void test_split(void) {
+  nmea_field_t f[NMEA_MAX_FIELDS];
+  const char *s = "$GPGGA,120000.00,2250.37104,S,,W,1,11,0.75,4.0,M,,M,,*46";
+  int n = nmea_split(s, f, NMEA_MAX_FIELDS);
+  CHECK_EQ(n, 15);
+  CHECK(f[0].len == 5 && memcmp(f[0].ptr, "GPGGA", 5) == 0);
+  CHECK(f[2].len == 10 && memcmp(f[2].ptr, "2250.37104", 10) == 0);
+  // Empty fields keep their index
+  CHECK_EQ(f[4].len, 0);
+  CHECK_EQ(f[11].len, 0);
+  CHECK_EQ(f[14].len, 0);
+  // Fields point into the sentence, nothing is copied
+  CHECK(f[1].ptr == s + 7);
+
+  // Stops at max_fields, CR/LF and NUL
+  CHECK_EQ(nmea_split(s, f, 3), 3);
+  CHECK_EQ(nmea_split("$GPRMC,1,2\r\n", f, NMEA_MAX_FIELDS), 3);
+  CHECK_EQ(f[2].len, 1);
+  CHECK_EQ(nmea_split("", f, NMEA_MAX_FIELDS), 1);
+  CHECK_EQ(nmea_split(NULL, f, NMEA_MAX_FIELDS), 0);
+}
+
+static void test_decoders(void) {
+  uint32_t u = 7;
+  nmea_field_t f = field("0042");
+  CHECK(nmea_parse_uint(&f, &u) && u == 42);
+  f = field("4a");
+  CHECK(!nmea_parse_uint(&f, &u) && u == 42);
+  f = field("");
+  CHECK(!nmea_parse_uint(&f, &u));
+  f = field("4294967295");
+  CHECK(nmea_parse_uint(&f, &u) && u == UINT32_MAX);
+  f = field("4294967296");
+  CHECK(!nmea_parse_uint(&f, &u) && u == UINT32_MAX); // would wrap to 0
+  f = field("99999999999");
+  CHECK(!nmea_parse_uint(&f, &u));
+
+  int32_t v = 0;
+  f = field("123.456");
+  CHECK(nmea_parse_fixed(&f, 2, &v) && v == 12345); // truncated
+  CHECK(nmea_parse_fixed(&f, 5, &v) && v == 12345600); // zero-filled
+  f = field("-5.4");
+  CHECK(nmea_parse_fixed(&f, 1, &v) && v == -54);
+  f = field(".5");
+  CHECK(nmea_parse_fixed(&f, 1, &v) && v == 5);
+  f = field("1.2.3");
+  CHECK(!nmea_parse_fixed(&f, 2, &v));
+  f = field("99999999.9");
+  CHECK(!nmea_parse_fixed(&f, 2, &v)); // over INT32_MAX
+  f = field("4294967296.5");
+  CHECK(!nmea_parse_fixed(&f, 0, &v)); // integer part wraps to 0
+  f = field("-2147483648");
+  CHECK(!nmea_parse_fixed(&f, 0, &v)); // magnitude over INT32_MAX
+
+  nmea_field_t south = field("S"), west = field("W"), none = field("");
+  f = field("2250.37104");
+  CHECK(nmea_parse_coord(&f, &south, &v) && v == -228395173);
+  f = field("04306.89822");
+  CHECK(nmea_parse_coord(&f, &west, &v) && v == -431149703);
+  f = field("0000.0000001");
+  CHECK(nmea_parse_coord(&f, &none, &v) && v == 0); // rounds to nearest
+  f = field("4061.0");
+  CHECK(!nmea_parse_coord(&f, &none, &v)); // 61 minutes
+
+  // Latitude up to 90 degrees, longitude up to 180
+  nmea_field_t north = field("N"), east = field("E");
+  f = field("9000.0000");
+  CHECK(nmea_parse_coord(&f, &south, &v) && v == -900000000);
+  f = field("9000.0001");
+  CHECK(!nmea_parse_coord(&f, &north, &v) && v == -900000000);
+  f = field("9100.0000");
+  CHECK(!nmea_parse_coord(&f, &north, &v));
+  f = field("12000.0000");
+  CHECK(!nmea_parse_coord(&f, &south, &v));
+  CHECK(nmea_parse_coord(&f, &east, &v) && v == 1200000000);
+  f = field("18000.0000");
+  CHECK(nmea_parse_coord(&f, &west, &v) && v == -1800000000);
+  f = field("18000.0001");
+  CHECK(!nmea_parse_coord(&f, &east, &v));
+  CHECK(!nmea_parse_coord(&f, &none, &v));
+  f = field("18100.0000");
+  CHECK(!nmea_parse_coord(&f, &west, &v));
+  f = field("4294967296.0");
+  CHECK(!nmea_parse_coord(&f, &east, &v)); // wraps to 0 degrees
+}
+
+// Framer output: the sentences it dispatched, concatenated with '\n'
+typedef struct {
+  char out[1 << 20];
+  size_t len;
+  int frames;
+} frames_t;
+
+static void on_frame(const char *sentence, void *ctx) {
+  frames_t *fs = ctx;
+  size_t n = strlen(sentence);
+  CHECK(n <= NMEA_MAX_SENTENCE);
+  if (fs->len + n + 1 < sizeof(fs->out)) {
+    memcpy(fs->out + fs->len, sentence, n);
+    fs->len += n;
+    fs->out[fs->len++] = '\n';
+    fs->out[fs->len] = '\0';
+  }
+  fs->frames++;
+}
+
+static void framer_reset(nmea_framer_t *fr, frames_t *fs) {
+  nmea_framer_init(fr);
+  fs->len = 0;
+  fs->frames = 0;
+}
+
+static void feed_str(nmea_framer_t *fr, const char *s, frames_t *fs) {
+  nmea_framer_feed(fr, (const uint8_t *)s, strlen(s), on_frame, fs);
+}
+
+// "$<body>*HH" with the right checksum
+static void with_checksum(char *out, size_t size, const char *body) {
+  uint8_t ck = 0;
+  for (const char *p = body; *p; p++)
+    ck ^= (uint8_t)*p;
+  snprintf(out, size, "$%s*%02X", body, ck);
+}
+
+static void test_framer(void) {
+  static frames_t fs;
+  nmea_framer_t fr;
+  char s[160], body[128], gga[NMEA_MAX_SENTENCE + 1];
+  with_checksum(gga, sizeof(gga),
+                "GPGGA,120000.00,2250.37104,S,04306.89822,W,1,11,0.75,4.0,M,"
+                "-5.1,M,,");
+
+  // CRLF, LF only and CR only all end a sentence
+  const char *ends[] = {"\r\n", "\n", "\r"};
+  for (int e = 0; e < 3; e++) {
+    framer_reset(&fr, &fs);
+    for (int i = 0; i < 3; i++) {
+      feed_str(&fr, gga, &fs);
+      feed_str(&fr, ends[e], &fs);
+    }
+    CHECK_EQ(fs.frames, 3);
+    CHECK_EQ(fr.stats.good, 3);
+    CHECK_EQ(fr.stats.bad_checksum + fr.stats.truncated, 0);
+    // Each one whole, without its line end
+    CHECK_EQ(fs.len, 3 * (strlen(gga) + 1));
+    CHECK(strncmp(fs.out, gga, strlen(gga)) == 0);
+    CHECK_EQ(fs.out[strlen(gga)], '\n');
+  }
+
+  // A wrong checksum, non-hex digits or a missing '*' drop the sentence;
+  // the next good one still goes through
+  framer_reset(&fr, &fs);
+  feed_str(&fr, "$GPGLL,2250.37104,S,04306.89822,W,120000.00,A,A*7F\r\n",
+           &fs);
+  feed_str(&fr, "$GPGLL,2250.37104,S,04306.89822,W,120000.00,A,A*G1\r\n",
+           &fs);
+  feed_str(&fr, "$GPGLL,2250.37104,S,04306.89822,W,120000.00,A,A\r\n", &fs);
+  with_checksum(s, sizeof(s), "GPGLL,2250.37104,S,04306.89822,W,120000.00,A,A");
+  feed_str(&fr, s, &fs);
+  feed_str(&fr, "\r\n", &fs);
+  CHECK_EQ(fr.stats.bad_checksum, 2);
+  CHECK_EQ(fr.stats.truncated, 1);
+  CHECK_EQ(fs.frames, 1);
+  CHECK_EQ(fr.stats.good, 1);
+  CHECK(strncmp(fs.out, s, strlen(s)) == 0);
+  // Lowercase hex is accepted
+  for (char *p = strchr(s, '*'); *p; p++)
+    *p = (char)(*p >= 'A' && *p <= 'F' ? *p + 32 : *p);
+  feed_str(&fr, s, &fs);
+  feed_str(&fr, "\n", &fs);
+  CHECK_EQ(fr.stats.good, 2);
+
+  // The buffer takes NMEA_MAX_SENTENCE characters before the line end, two
+  // more than the standard allows; one more is truncated, and the framer
+  // recovers on the next '$'
+  framer_reset(&fr, &fs);
+  memset(body, 'A', NMEA_MAX_SENTENCE - 4);
+  body[NMEA_MAX_SENTENCE - 4] = '\0';
+  memcpy(body, "GPTXT,", 6);
+  with_checksum(s, sizeof(s), body);
+  CHECK_EQ(strlen(s), NMEA_MAX_SENTENCE);
+  feed_str(&fr, s, &fs);
+  feed_str(&fr, "\r\n", &fs);
+  CHECK_EQ(fs.frames, 1);
+  strcat(body, "A");
+  with_checksum(s, sizeof(s), body);
+  feed_str(&fr, s, &fs);
+  feed_str(&fr, "\r\n", &fs);
+  CHECK_EQ(fs.frames, 1);
+  CHECK_EQ(fr.stats.truncated, 1);
+  // Far longer than the buffer, with no '*' at all
+  memset(s, 'B', sizeof(s) - 1);
+  s[0] = '$';
+  s[sizeof(s) - 1] = '\0';
+  feed_str(&fr, s, &fs);
+  feed_str(&fr, "\r\n", &fs);
+  CHECK_EQ(fr.stats.truncated, 2);
+  feed_str(&fr, gga, &fs);
+  feed_str(&fr, "\r\n", &fs);
+  CHECK_EQ(fs.frames, 2);
+  CHECK_EQ(fr.stats.good, 2);
+
+  // Line noise between sentences is skipped; a stray '$' in it costs one
+  // truncated frame and nothing else
+  framer_reset(&fr, &fs);
+  feed_str(&fr, "\xff\x13garbage*00\r\n", &fs);
+  feed_str(&fr, gga, &fs);
+  feed_str(&fr, "\r\n", &fs);
+  feed_str(&fr, "\x80\x81\r\r\n\n,,*", &fs);
+  feed_str(&fr, "x$GP\x01\x02", &fs);
+  feed_str(&fr, gga, &fs);
+  feed_str(&fr, "\r\n", &fs);
+  CHECK_EQ(fs.frames, 2);
+  CHECK_EQ(fr.stats.truncated, 1);
+  CHECK_EQ(fr.stats.bad_checksum, 0);
+
+  // The capture as UART reads of every size from 1 byte up: each sentence
+  // comes out once and whole, wherever the reads split it
+  size_t len;
+  char *text = fixture_load("gp_1hz.nmea", &len);
+  int lines = 0;
+  for (size_t i = 0; i < len; i++)
+    lines += text[i] == '\n';
+  char *want = malloc(len + 1);
+  size_t w = 0;
+  for (size_t i = 0; i < len; i++)
+    if (text[i] != '\r')
+      want[w++] = text[i];
+  want[w] = '\0';
+  const size_t chunks[] = {1, 2, 3, 7, 64, 128, 1024};
+  for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+    framer_reset(&fr, &fs);
+    for (size_t i = 0; i < len; i += chunks[c]) {
+      size_t n = len - i < chunks[c] ? len - i : chunks[c];
+      nmea_framer_feed(&fr, (const uint8_t *)text + i, n, on_frame, &fs);
+    }
+    CHECK_EQ(fs.frames, lines);
+    CHECK_EQ(fr.stats.good, lines);
+    CHECK_EQ(fr.stats.bad_checksum + fr.stats.truncated, 0);
+    CHECK(fs.len == w && memcmp(fs.out, want, w) == 0);
+  }
+  free(want);
+  free(text);
+}
+
+// Every GGA/RMC of the capture decodes to the value a double parse of the
+// same text gives, to the nearest 1e-7 degree
+static double coord_ref(const char *text, char hemi) {
+  double raw = strtod(text, NULL);
+  int deg = (int)(raw / 100);
+  double v = deg + (raw - deg * 100) / 60;
+  return hemi == 'S' || hemi == 'W' ? -v : v;
+}
+
+static void test_capture(void) {
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines);
+  CHECK(n > 1000);
+  gps_reset_data();
+  size_t checked = 0;
+  for (size_t i = 0; i < n; i++) {
+    gps_parse_nmea(lines[i]);
+    if (strncmp(lines[i], "$GPGGA", 6) != 0)
+      continue;
+    nmea_field_t f[NMEA_MAX_FIELDS];
+    nmea_split(lines[i], f, NMEA_MAX_FIELDS);
+    const gps_data_t *gps = gps_get_data();
+    double lat = coord_ref(f[2].ptr, f[3].ptr[0]);
+    double lon = coord_ref(f[4].ptr, f[5].ptr[0]);
+    CHECK(fabs(gps->lat_e7 - lat * 1e7) <= 1.0);
+    CHECK(fabs(gps->lon_e7 - lon * 1e7) <= 1.0);
+    CHECK(fabs(gps->alt_cm - strtod(f[9].ptr, NULL) * 100) <= 0.5);
+    CHECK_EQ(gps->satellites, strtol(f[7].ptr, NULL, 10));
+    CHECK(gps->valid);
+    checked++;
+  }
+  CHECK_EQ(checked, 600);
+  CHECK_STR(gps_get_data()->timestamp, "120959");
+  CHECK_STR(gps_get_data()->date, "180524");
+  free(lines);
+  free(text);
+}
+
+int main(void) {
+  test_split();
+  test_decoders();
+  test_framer();
+  test_capture();
+  return test_result("test_nmea");
+}
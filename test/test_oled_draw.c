@@ -0,0 +1,193 @@
+// Span fills, lines, rectangles and bitmap blits in oled.c against naive
+// per-pixel versions, with random clips and partly off-screen coordinates.
+// Each case goes through a partial refresh, so the dirty spans are checked
+// too: the host controller RAM has to match the reference.
+#include "oled.h"
+#include "oled_backend.h"
+#include "test_util.h"
+#include <stdlib.h>
+
+static bool ref[OLED_HEIGHT][OLED_WIDTH];
+static int clip_x0, clip_y0, clip_x1 = OLED_WIDTH, clip_y1 = OLED_HEIGHT;
+static uint32_t lcg = 11;
+
+static int rnd(int n) {
+  lcg = lcg * 1103515245u + 12345u;
+  return (int)((lcg >> 8) % (uint32_t)n);
+}
+
+static void ref_pixel(int x, int y, bool on) {
+  if (x >= 0 && x < OLED_WIDTH && y >= 0 && y < OLED_HEIGHT &&
+      x >= clip_x0 && x < clip_x1 && y >= clip_y0 && y < clip_y1)
+    ref[y][x] = on;
+}
+
+static void ref_fill(int x, int y, int w, int h, bool on) {
+  for (int j = 0; j < h; j++)
+    for (int i = 0; i < w; i++)
+      ref_pixel(x + i, y + j, on);
+}
+
+static void ref_line(int x0, int y0, int x1, int y1, bool on) {
+  int dx = abs(x1 - x0), dy = abs(y1 - y0);
+  int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1, err = dx - dy;
+  for (;;) {
+    ref_pixel(x0, y0, on);
+    if (x0 == x1 && y0 == y1)
+      break;
+    int e2 = 2 * err;
+    if (e2 > -dy) {
+      err -= dy;
+      x0 += sx;
+    }
+    if (e2 < dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+static void ref_blit(int x, int y, const uint8_t *src, int w, int h,
+                     oled_blit_mode_t mode) {
+  for (int row = 0; row < h; row++) {
+    for (int col = 0; col < w; col++) {
+      bool bit = (src[(row / 8) * w + col] >> (row % 8)) & 1;
+      if (mode == OLED_BLIT_COPY)
+        ref_pixel(x + col, y + row, bit);
+      else if (bit)
+        ref_pixel(x + col, y + row, mode == OLED_BLIT_OR);
+    }
+  }
+}
+
+static int frame_diff(void) {
+  oled_display();
+  const uint8_t *ram = oled_host_ram();
+  int diff = 0;
+  for (int y = 0; y < OLED_HEIGHT; y++)
+    for (int x = 0; x < OLED_WIDTH; x++)
+      diff += ((ram[(y / 8) * OLED_WIDTH + x] >> (y % 8)) & 1) != ref[y][x];
+  return diff;
+}
+
+static void random_clip(void) {
+  oled_reset_clip();
+  clip_x0 = clip_y0 = 0;
+  clip_x1 = OLED_WIDTH;
+  clip_y1 = OLED_HEIGHT;
+  if (rnd(3))
+    return;
+  clip_x0 = rnd(OLED_WIDTH);
+  clip_y0 = rnd(OLED_HEIGHT);
+  int w = 1 + rnd(OLED_WIDTH), h = 1 + rnd(OLED_HEIGHT);
+  oled_set_clip(clip_x0, clip_y0, w, h);
+  clip_x1 = clip_x0 + w > OLED_WIDTH ? OLED_WIDTH : clip_x0 + w;
+  clip_y1 = clip_y0 + h > OLED_HEIGHT ? OLED_HEIGHT : clip_y0 + h;
+}
+
+// Accumulates onto the same frame, so clears and copies hit lit pixels
+static void test_random(void) {
+  static uint8_t bitmap[OLED_WIDTH * OLED_PAGES];
+  int bad[6] = {0};
+  oled_clear();
+  memset(ref, 0, sizeof(ref));
+  for (int t = 0; t < 60000; t++) {
+    random_clip();
+    int op = rnd(6);
+    bool on = rnd(3) != 0;
+    int x = rnd(OLED_WIDTH), y = rnd(OLED_HEIGHT);
+    int w = rnd(OLED_WIDTH + 1), h = rnd(OLED_HEIGHT + 1);
+    switch (op) {
+    case 0:
+      oled_fill_rect(x, y, w, h, on);
+      ref_fill(x, y, w, h, on);
+      break;
+    case 1:
+      oled_draw_rect(x, y, w, h, on);
+      if (w && h) {
+        ref_fill(x, y, w, 1, on);
+        ref_fill(x, y + h - 1, w, 1, on);
+        ref_fill(x, y + 1, 1, h - 2, on);
+        ref_fill(x + w - 1, y + 1, 1, h - 2, on);
+      }
+      break;
+    case 2: {
+      // Spans may start off-screen
+      int sx = rnd(OLED_WIDTH + 40) - 20, sy = rnd(OLED_HEIGHT + 20) - 10;
+      if (rnd(2)) {
+        oled_draw_hline(sx, sy, w, on);
+        ref_fill(sx, sy, w, 1, on);
+      } else {
+        oled_draw_vline(sx, sy, h, on);
+        ref_fill(sx, sy, 1, h, on);
+      }
+      break;
+    }
+    case 3: {
+      int x1 = rnd(OLED_WIDTH), y1 = rnd(OLED_HEIGHT);
+      if (rnd(3) == 0)
+        y1 = y; // horizontal
+      else if (rnd(2) == 0)
+        x1 = x; // vertical
+      oled_draw_line(x, y, x1, y1, on);
+      ref_line(x, y, x1, y1, on);
+      break;
+    }
+    default: {
+      int bw = 1 + rnd(104), bh = 1 + rnd(64);
+      for (int i = 0; i < bw * ((bh + 7) / 8); i++)
+        bitmap[i] = (uint8_t)rnd(256);
+      int bx = rnd(OLED_WIDTH + bw) - bw, by = rnd(OLED_HEIGHT + bh) - bh;
+      oled_blit_mode_t mode = (oled_blit_mode_t)rnd(3);
+      oled_draw_bitmap(bx, by, bitmap, bw, bh, mode);
+      ref_blit(bx, by, bitmap, bw, bh, mode);
+      op = 4 + (mode == OLED_BLIT_COPY);
+      break;
+    }
+    }
+    if (frame_diff() != 0) {
+      bad[op]++;
+      // Resynchronise so one mismatch is not counted for every later case
+      const uint8_t *ram = oled_host_ram();
+      for (int py = 0; py < OLED_HEIGHT; py++)
+        for (int px = 0; px < OLED_WIDTH; px++)
+          ref[py][px] = (ram[(py / 8) * OLED_WIDTH + px] >> (py % 8)) & 1;
+    }
+  }
+  oled_reset_clip();
+  CHECK_EQ(bad[0], 0); // fill_rect
+  CHECK_EQ(bad[1], 0); // draw_rect
+  CHECK_EQ(bad[2], 0); // hline/vline
+  CHECK_EQ(bad[3], 0); // line
+  CHECK_EQ(bad[4], 0); // blit OR/CLEAR
+  CHECK_EQ(bad[5], 0); // blit COPY
+}
+
+// Edges of the page arithmetic
+static void test_cases(void) {
+  static const uint8_t arrow[2 * 5] = {0x04, 0x0E, 0x1F, 0x0E, 0x04,
+                                       0x80, 0xC0, 0xE0, 0xC0, 0x80};
+  oled_reset_clip();
+  clip_x0 = clip_y0 = 0;
+  clip_x1 = OLED_WIDTH;
+  clip_y1 = OLED_HEIGHT;
+  for (int y = -16; y <= OLED_HEIGHT; y++) {
+    oled_clear();
+    memset(ref, 0, sizeof(ref));
+    oled_draw_bitmap(-2, y, arrow, 5, 16, OLED_BLIT_OR);
+    ref_blit(-2, y, arrow, 5, 16, OLED_BLIT_OR);
+    oled_fill_rect(60, y < 0 ? 0 : y, 7, 9, true);
+    ref_fill(60, y < 0 ? 0 : y, 7, 9, true);
+    CHECK_EQ(frame_diff(), 0);
+  }
+  oled_clear();
+  CHECK_EQ(oled_draw_bitmap(0, 0, NULL, 1, 1, OLED_BLIT_OR), ESP_FAIL);
+  CHECK_EQ(oled_draw_pixel(OLED_WIDTH, 0, true), ESP_FAIL);
+}
+
+int main(void) {
+  CHECK_EQ(oled_init_backend(&oled_backend_host), ESP_OK);
+  test_cases();
+  test_random();
+  return test_result("test_oled_draw");
+}
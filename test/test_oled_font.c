@@ -0,0 +1,170 @@
+// Text drawing in oled.c against a per-pixel reference renderer: glyph
+// tables, the cursor and '\n', opaque cells, clipping, and unaligned y.
+// Frames are compared through the host backend's controller RAM.
+#include "oled.h"
+#include "oled_backend.h"
+#include "test_util.h"
+
+static bool ref[OLED_HEIGHT][OLED_WIDTH];
+static int clip_x0, clip_y0, clip_x1 = OLED_WIDTH, clip_y1 = OLED_HEIGHT;
+
+static void ref_pixel(int x, int y, bool on) {
+  if (x >= clip_x0 && x < clip_x1 && y >= clip_y0 && y < clip_y1)
+    ref[y][x] = on;
+}
+
+static bool glyph_bit(const oled_font_t *f, uint8_t c, int col, int row) {
+  if (c < f->first || c > f->last || col >= f->width)
+    return false;
+  const uint8_t *g = f->glyphs + (size_t)(c - f->first) * f->width * f->pages;
+  return (g[(row / 8) * f->width + col] >> (row % 8)) & 1;
+}
+
+// The documented text model, one pixel at a time
+static void ref_print(const oled_font_t *f, int x0, int y0, const char *s) {
+  int x = x0, y = y0;
+  for (; *s; s++) {
+    if (*s == '\n') {
+      x = x0;
+      y += f->pages * 8;
+      continue;
+    }
+    for (int col = 0; col < f->advance; col++)
+      for (int row = 0; row < f->pages * 8; row++)
+        ref_pixel(x + col, y + row, glyph_bit(f, (uint8_t)*s, col, row));
+    x += f->advance;
+  }
+}
+
+// Pixels that differ between the panel and the reference
+static int frame_diff(void) {
+  oled_display();
+  const uint8_t *ram = oled_host_ram();
+  int diff = 0;
+  for (int y = 0; y < OLED_HEIGHT; y++)
+    for (int x = 0; x < OLED_WIDTH; x++)
+      diff += ((ram[(y / 8) * OLED_WIDTH + x] >> (y % 8)) & 1) != ref[y][x];
+  return diff;
+}
+
+static void reset(void) {
+  oled_reset_clip();
+  oled_clear();
+  memset(ref, 0, sizeof(ref));
+  clip_x0 = clip_y0 = 0;
+  clip_x1 = OLED_WIDTH;
+  clip_y1 = OLED_HEIGHT;
+}
+
+static void test_tables(void) {
+  const oled_font_t *fonts[] = {&oled_font_5x7, &oled_font_10x14,
+                                &oled_font_digits_20x28};
+  for (int i = 0; i < 3; i++) {
+    const oled_font_t *f = fonts[i];
+    CHECK(f->width < f->advance && f->pages >= 1 && f->pages <= 4);
+    CHECK(f->first <= f->last);
+  }
+  // HD44780 5x7 'A' and the digits font covering "-./0-9:"
+  const uint8_t *a = oled_font_5x7.glyphs + ('A' - 0x20) * 5;
+  CHECK(a[0] == 0x7E && a[1] == 0x11 && a[2] == 0x11 && a[3] == 0x11 &&
+        a[4] == 0x7E);
+  CHECK(oled_font_digits_20x28.first == '-' &&
+        oled_font_digits_20x28.last == ':');
+
+  oled_set_font(&oled_font_10x14);
+  CHECK_EQ(oled_text_width("12.5\nignored"), 4 * 12);
+  oled_set_font(NULL); // back to 5x7
+  CHECK_EQ(oled_text_width("km/h"), 24);
+}
+
+static void test_cases(void) {
+  reset();
+  // Aligned, then '\n' back to the cursor's x
+  oled_set_cursor(10, 8);
+  oled_print("Hi\nGPS");
+  ref_print(&oled_font_5x7, 10, 8, "Hi\nGPS");
+  CHECK_EQ(frame_diff(), 0);
+
+  // Unaligned y over a lit background: cells are opaque
+  reset();
+  oled_fill_rect(0, 0, OLED_WIDTH, OLED_HEIGHT, true);
+  memset(ref, 1, sizeof(ref));
+  oled_set_font(&oled_font_digits_20x28);
+  oled_set_cursor(3, 21);
+  oled_print("12.5");
+  ref_print(&oled_font_digits_20x28, 3, 21, "12.5");
+  CHECK_EQ(frame_diff(), 0);
+  oled_set_font(NULL);
+
+  // Characters outside the font are blank cells
+  reset();
+  oled_set_font(&oled_font_digits_20x28);
+  oled_set_cursor(0, 0);
+  oled_print("9A9");
+  ref_print(&oled_font_digits_20x28, 0, 0, "9A9");
+  CHECK_EQ(frame_diff(), 0);
+  oled_set_font(NULL);
+
+  // Clipped, running off the right and bottom edges
+  reset();
+  oled_set_clip(20, 10, 50, 20);
+  clip_x0 = 20, clip_y0 = 10, clip_x1 = 70, clip_y1 = 30;
+  oled_set_cursor(15, 5);
+  oled_print("clipped text line\nsecond line\nthird\nfourth");
+  ref_print(&oled_font_5x7, 15, 5,
+            "clipped text line\nsecond line\nthird\nfourth");
+  CHECK_EQ(frame_diff(), 0);
+
+  CHECK_EQ(oled_set_cursor(OLED_WIDTH, 0), ESP_FAIL);
+  CHECK_EQ(oled_set_clip(0, OLED_HEIGHT, 1, 1), ESP_ERR_INVALID_ARG);
+}
+
+// Random fonts, positions, clips, backgrounds and strings
+static void test_random(void) {
+  const oled_font_t *fonts[] = {&oled_font_5x7, &oled_font_10x14,
+                                &oled_font_digits_20x28};
+  uint32_t lcg = 7;
+#define RND(n) ((lcg = lcg * 1103515245u + 12345u) >> 8) % (n)
+  int bad = 0;
+  for (int t = 0; t < 3000; t++) {
+    reset();
+    int bx = RND(OLED_WIDTH), by = RND(OLED_HEIGHT);
+    int bw = 1 + RND(OLED_WIDTH), bh = 1 + RND(OLED_HEIGHT);
+    oled_fill_rect(bx, by, bw, bh, true);
+    for (int y = by; y < by + bh && y < OLED_HEIGHT; y++)
+      for (int x = bx; x < bx + bw && x < OLED_WIDTH; x++)
+        ref[y][x] = true;
+
+    if (RND(2)) {
+      clip_x0 = RND(OLED_WIDTH);
+      clip_y0 = RND(OLED_HEIGHT);
+      int w = 1 + RND(OLED_WIDTH), h = 1 + RND(OLED_HEIGHT);
+      oled_set_clip(clip_x0, clip_y0, w, h);
+      clip_x1 = clip_x0 + w > OLED_WIDTH ? OLED_WIDTH : clip_x0 + w;
+      clip_y1 = clip_y0 + h > OLED_HEIGHT ? OLED_HEIGHT : clip_y0 + h;
+    }
+
+    const oled_font_t *f = fonts[RND(3)];
+    char s[40];
+    int n = 1 + RND(sizeof(s) - 1);
+    for (int i = 0; i < n; i++)
+      s[i] = RND(12) == 0 ? '\n' : (char)(0x1E + RND(0x64));
+    s[n] = '\0';
+    int x = RND(OLED_WIDTH), y = RND(OLED_HEIGHT);
+    oled_set_font(f);
+    oled_set_cursor(x, y);
+    oled_print(s);
+    ref_print(f, x, y, s);
+    bad += frame_diff() != 0;
+  }
+#undef RND
+  CHECK_EQ(bad, 0);
+}
+
+int main(void) {
+  CHECK_EQ(oled_init_backend(&oled_backend_host), ESP_OK);
+  test_tables();
+  test_cases();
+  test_random();
+  return test_result("test_oled_font");
+}
@@ -0,0 +1,231 @@
+// The host backend and oled_display() together: bus accounting for full,
+// partial and skipped refreshes against what the emulator saw, partial
+// refreshes leaving the controller RAM equal to a full resend, and the
+// display_gps_info() pages as golden frames (test/golden/*.pbm).
+// OLED_GOLDEN_UPDATE=1 rewrites the golden files from the current output.
+#include "fixed_fmt.h"
+#include "oled.h"
+#include "oled_backend.h"
+#include "test_util.h"
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "golden"
+#endif
+
+// Bus cost of one refresh, seen from both sides of the backend
+typedef struct {
+  uint32_t bytes, transactions, data_bytes;
+} traffic_t;
+
+static traffic_t refresh(void) {
+  oled_host_stats_t before, after;
+  oled_host_get_stats(&before);
+  CHECK_EQ(oled_display(), ESP_OK);
+  oled_host_get_stats(&after);
+  oled_stats_t st;
+  oled_get_stats(&st);
+  traffic_t t = {after.bytes - before.bytes,
+                 after.transactions - before.transactions,
+                 after.data_bytes - before.data_bytes};
+  CHECK_EQ(st.last_bytes, t.bytes);
+  CHECK_EQ(st.last_transactions, t.transactions);
+  return t;
+}
+
+static void test_traffic(void) {
+  // oled_init_backend(): init sequence, then the whole frame
+  oled_host_stats_t hs;
+  oled_host_get_stats(&hs);
+  oled_stats_t st;
+  oled_get_stats(&st);
+  CHECK_EQ(hs.transactions, 3);
+  CHECK_EQ(hs.data_bytes, OLED_WIDTH * OLED_PAGES);
+  CHECK_EQ(st.bytes, hs.bytes);
+  CHECK_EQ(st.frames, 1);
+
+  // Nothing drawn: nothing sent
+  traffic_t t = refresh();
+  CHECK_EQ(t.transactions, 0);
+  oled_get_stats(&st);
+  CHECK_EQ(st.skipped, 1);
+
+  // One pixel: a 1x1 window (6 command bytes) and one data byte
+  oled_draw_pixel(77, 42, true);
+  t = refresh();
+  CHECK_EQ(t.transactions, 2);
+  CHECK_EQ(t.bytes, (6 + 2) + (1 + 2));
+
+  // Touched but put back before the refresh: trimmed to nothing
+  oled_draw_pixel(10, 3, true);
+  oled_draw_pixel(10, 3, false);
+  t = refresh();
+  CHECK_EQ(t.transactions, 0);
+
+  // oled_clear() dirties everything, but only the lit byte differs
+  oled_clear();
+  t = refresh();
+  CHECK_EQ(t.data_bytes, 1);
+
+  // A span across two pages: one window per page, only its columns
+  oled_fill_rect(20, 6, 30, 4, true);
+  t = refresh();
+  CHECK_EQ(t.transactions, 4);
+  CHECK_EQ(t.data_bytes, 2 * 30);
+
+  oled_invalidate();
+  t = refresh();
+  CHECK_EQ(t.transactions, 2);
+  CHECK_EQ(t.data_bytes, OLED_WIDTH * OLED_PAGES);
+  CHECK_EQ(t.bytes, (6 + 2) + (OLED_WIDTH * OLED_PAGES + 2));
+  oled_clear();
+  refresh();
+}
+
+// Random drawing refreshed at random intervals: after each refresh the
+// controller RAM must equal what a full resend of the framebuffer gives
+static void test_partial(void) {
+  static uint8_t partial[OLED_WIDTH * OLED_PAGES];
+  uint32_t lcg = 13;
+#define RND(n) ((lcg = lcg * 1103515245u + 12345u) >> 8) % (n)
+  int bad = 0;
+  for (int t = 0; t < 20000; t++) {
+    int ops = 1 + RND(4);
+    for (int i = 0; i < ops; i++) {
+      int x = RND(OLED_WIDTH), y = RND(OLED_HEIGHT);
+      bool on = RND(3) != 0;
+      switch (RND(4)) {
+      case 0:
+        oled_draw_pixel(x, y, on);
+        break;
+      case 1: {
+        int w = 1 + RND(40), h = 1 + RND(20);
+        oled_fill_rect(x, y, w, h, on);
+        break;
+      }
+      case 2: {
+        int x1 = RND(OLED_WIDTH), y1 = RND(OLED_HEIGHT);
+        oled_draw_line(x, y, x1, y1, on);
+        break;
+      }
+      default:
+        oled_set_cursor(x, y);
+        oled_print(on ? "12:34" : "GPS");
+        break;
+      }
+    }
+    if (RND(3))
+      continue; // several frames of drawing per refresh
+    refresh();
+    memcpy(partial, oled_host_ram(), sizeof(partial));
+    oled_invalidate();
+    refresh();
+    bad += memcmp(partial, oled_host_ram(), sizeof(partial)) != 0;
+  }
+#undef RND
+  CHECK_EQ(bad, 0);
+}
+
+// The text page of display_gps_info() in src/main.c, same calls and
+// positions, with the snapshot values passed in
+static void gps_page(int sats, const char *fix, int32_t hdop_e2,
+                     int32_t lat_e7, int32_t lon_e7, int32_t speed_ckmh,
+                     int32_t alt_cm, unsigned course_cdeg) {
+  char line[32], num[FIXED_FMT_MAX];
+  oled_clear();
+  oled_set_font(&oled_font_5x7);
+  fixed_fmt_round(num, sizeof(num), hdop_e2, 2, 1);
+  snprintf(line, sizeof(line), "SAT %d %s HDOP %s", sats, fix, num);
+  oled_println(line);
+  fixed_fmt_round(num, sizeof(num), lat_e7, 7, 6);
+  snprintf(line, sizeof(line), "LAT %s", num);
+  oled_println(line);
+  fixed_fmt_round(num, sizeof(num), lon_e7, 7, 6);
+  snprintf(line, sizeof(line), "LON %s", num);
+  oled_println(line);
+
+  oled_set_font(&oled_font_digits_20x28);
+  oled_set_cursor(0, 24);
+  fixed_fmt_round(line, sizeof(line), speed_ckmh, 2, 1);
+  oled_print(line);
+  oled_set_font(&oled_font_5x7);
+  oled_set_cursor(OLED_WIDTH - oled_text_width("km/h"), 48);
+  oled_print("km/h");
+
+  oled_set_cursor(0, 56);
+  fixed_fmt_round(num, sizeof(num), alt_cm, 2, 0);
+  snprintf(line, sizeof(line), "ALT %sm CRS %u\x7F", num,
+           (course_cdeg + 50) / 100 % 360);
+  oled_print(line);
+}
+
+static void search_page(int sats, int in_view) {
+  char line[32];
+  oled_clear();
+  oled_set_font(&oled_font_5x7);
+  oled_println("GPS: Searching...");
+  snprintf(line, sizeof(line), "Sats: %d in view: %d", sats, in_view);
+  oled_println(line);
+}
+
+// display_trip(): header lines, distance in the big digits, odometer
+static void trip_page(void) {
+  oled_clear();
+  oled_set_font(&oled_font_5x7);
+  oled_println("TRIP km        MOVING");
+  oled_println("MAX 31.4 AVG 12.0");
+  oled_println("MOV 1:07 STOP 0:12");
+  oled_set_font(&oled_font_digits_20x28);
+  oled_set_cursor(0, 24);
+  char num[FIXED_FMT_MAX];
+  fixed_fmt_round(num, sizeof(num), 13407, 3, 2);
+  oled_print(num);
+  oled_set_font(&oled_font_5x7);
+  oled_set_cursor(0, 56);
+  oled_print("ODO 1234 km");
+}
+
+// Frame written with oled_host_save_pbm(), compared byte for byte
+static void check_golden(const char *name) {
+  oled_display();
+  char actual[64], golden[512];
+  snprintf(actual, sizeof(actual), "%s.actual.pbm", name);
+  snprintf(golden, sizeof(golden), "%s/%s.pbm", GOLDEN_DIR, name);
+  CHECK_EQ(oled_host_save_pbm(actual), ESP_OK);
+  const char *update = getenv("OLED_GOLDEN_UPDATE");
+  if (update && *update == '1') {
+    CHECK_EQ(rename(actual, golden), 0);
+    printf("updated %s\n", golden);
+    return;
+  }
+  size_t alen, glen;
+  char *a = fixture_load(actual, &alen);
+  char *g = fixture_load(golden, &glen);
+  if (alen == glen && memcmp(a, g, alen) == 0) {
+    remove(actual);
+  } else {
+    fprintf(stderr, "%s differs from %s (kept for inspection)\n", actual,
+            golden);
+    test_failures++;
+  }
+  free(a);
+  free(g);
+}
+
+static void test_golden(void) {
+  gps_page(9, "3D", 90, -228395173, -431149703, 2345, 1234, 27149);
+  check_golden("gps_fix");
+  gps_page(4, "2D", 412, 515072000, -1275000, 0, -350, 0);
+  check_golden("gps_fix_2d");
+  search_page(0, 7);
+  check_golden("gps_search");
+  trip_page();
+  check_golden("trip");
+}
+
+int main(void) {
+  CHECK_EQ(oled_init_backend(&oled_backend_host), ESP_OK);
+  test_traffic();
+  test_partial();
+  test_golden();
+  return test_result("test_oled_host");
+}
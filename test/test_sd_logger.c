@@ -0,0 +1,330 @@
+// sd_logger.c against files in a scratch directory: record encoding, 4 KiB
+// aligned writes before and after a timed flush, fixes dropped whole when
+// the SD task falls behind, a day rollover into a new segment, a power cut
+// that tears the last record, range reads over closed and open segments,
+// and segment names that are never reused or overwritten
+#include "sd_logger.h"
+#include "test_util.h"
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <time.h>
+
+#define T0 1716033600u // 2024-05-18T12:00:00Z
+// Start 23:00 UTC so the second hour rolls over into a new segment
+#define T_NIGHT 1716073200u // 2024-05-18T23:00:00Z
+#define N_BULK 3600
+#define N_TAIL 100
+
+// Every write() from the logger, through the linker's --wrap
+static uint32_t writes, unaligned_end;
+ssize_t __real_write(int fd, const void *buf, size_t len);
+ssize_t __wrap_write(int fd, const void *buf, size_t len) {
+  off_t start = lseek(fd, 0, SEEK_CUR);
+  ssize_t n = __real_write(fd, buf, len);
+  writes++;
+  if (n > 0 && (start + n) % SD_LOG_BUF_BYTES != 0)
+    unaligned_end++;
+  return n;
+}
+
+// Fix i seconds after t0
+static uint32_t t0 = T0;
+static gps_data_t make_gps(uint32_t i) {
+  gps_data_t gps = {0};
+  gps.valid = true;
+  gps.fix_type = GPS_FIX_3D;
+  gps.lat_e7 = -228395173 + (int32_t)i * 37;
+  gps.lon_e7 = -431149703 - (int32_t)i * 11;
+  gps.alt_cm = 400 + (int32_t)(i % 50);
+  gps.speed_ckmh = 1800 + i % 7;
+  gps.course_cdeg = (uint16_t)((i * 13) % 36000);
+  gps.satellites = 9;
+  gps.hdop_e2 = 90;
+  time_t t = t0 + i;
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  strftime(gps.timestamp, sizeof(gps.timestamp), "%H%M%S", &tm);
+  strftime(gps.date, sizeof(gps.date), "%d%m%y", &tm);
+  return gps;
+}
+
+static void test_records(void) {
+  CHECK_EQ(sizeof(sd_log_record_t), 24);
+  CHECK_EQ(sizeof(sd_log_block_hdr_t) +
+               SD_LOG_BLOCK_RECORDS * sizeof(sd_log_record_t),
+           SD_LOG_BUF_BYTES);
+  // CRC-8/SMBUS and CRC-32/ISO-HDLC check values
+  CHECK_EQ(sd_log_crc8((const uint8_t *)"123456789", 9), 0xF4);
+  CHECK_EQ(sd_log_crc32(0, (const uint8_t *)"123456789", 9), 0xCBF43926);
+
+  gps_data_t gps = {0};
+  sd_log_record_t r;
+  CHECK(!sd_log_record_from_gps(&gps, &r));
+  gps = make_gps(0);
+  gps.speed_ckmh = 70000; // saturates
+  gps.course_cdeg = 17950;
+  gps.hdop_e2 = 3000; // saturates
+  CHECK(sd_log_record_from_gps(&gps, &r));
+  CHECK_EQ(r.time, T0);
+  CHECK(r.lat_e7 == -228395173 && r.lon_e7 == -431149703 &&
+        r.alt_cm == 400 && r.course_cdeg == 17950 && r.satellites == 9);
+  CHECK_EQ(r.speed_ckmh, 65535);
+  CHECK_EQ(r.hdop_dec, 255);
+  CHECK_EQ(r.flags, 0x07);
+  CHECK(sd_log_record_valid(&r));
+  r.lat_e7 ^= 1;
+  CHECK(!sd_log_record_valid(&r));
+}
+
+// Records with from <= time <= to; *same is set if the i-th one read
+// equals make_gps(first_i + i) for all of them
+static size_t read_range(uint32_t from, uint32_t to, uint32_t first_i,
+                         bool *same) {
+  static sd_log_cursor_t cur;
+  sd_log_record_t r;
+  size_t n = 0;
+  *same = true;
+  if (sd_log_cursor_open(&cur, from, to) != ESP_OK)
+    return 0;
+  while (sd_log_cursor_next(&cur, &r)) {
+    gps_data_t gps = make_gps(first_i + n);
+    sd_log_record_t want;
+    sd_log_record_from_gps(&gps, &want);
+    *same = *same && memcmp(&r, &want, sizeof(want)) == 0;
+    n++;
+  }
+  sd_log_cursor_close(&cur);
+  return n;
+}
+
+static size_t read_all(void) {
+  bool same;
+  size_t n = read_range(0, UINT32_MAX, 0, &same);
+  return same ? n : 0;
+}
+
+// Child process, one logger per process: a single segment within the day
+static int log_aligned(void) {
+  host_set_time_us(0);
+  CHECK_EQ(sd_logger_init(), ESP_OK);
+
+  // No timed flush: every write is a whole 4 KiB at an aligned offset
+  bool ok = true;
+  for (uint32_t i = 0; i < N_BULK; i++) {
+    gps_data_t gps = make_gps(i);
+    ok = sd_logger_append(&gps) && ok;
+    sd_logger_service();
+  }
+  CHECK(ok);
+  sd_logger_stats_t st;
+  sd_logger_get_stats(&st);
+  CHECK(writes > 0);
+  CHECK_EQ(unaligned_end, 0);
+  CHECK_EQ(st.writes, writes);
+  CHECK_EQ(st.bytes_written, writes * SD_LOG_BUF_BYTES);
+
+  // A timed flush writes the partial CSV buffer (the segment's last block
+  // is rewritten whole); the CSV write after it ends back on a 4 KiB
+  // boundary
+  host_advance_us((SD_LOG_FLUSH_MS + 1000) * 1000LL);
+  CHECK_EQ(sd_logger_service(), ESP_OK);
+  CHECK_EQ(unaligned_end, 1);
+  for (uint32_t i = N_BULK; i < N_BULK + N_TAIL; i++) {
+    gps_data_t gps = make_gps(i);
+    ok = sd_logger_append(&gps) && ok;
+    sd_logger_service();
+  }
+  CHECK(ok);
+  CHECK_EQ(unaligned_end, 1);
+
+  CHECK_EQ(sd_logger_flush(), ESP_OK);
+  sd_logger_get_stats(&st);
+  CHECK_EQ(st.records, N_BULK + N_TAIL);
+  CHECK_EQ(st.dropped, 0);
+
+  // Both streams hold every fix, in order
+  CHECK_EQ(read_all(), N_BULK + N_TAIL);
+  char *csv = fixture_load(SD_LOG_CSV_PATH, NULL), **lines;
+  CHECK_EQ(fixture_lines(csv, &lines), N_BULK + N_TAIL);
+  CHECK_STR(lines[0], "0,-22.8395173,-43.1149703,4.00,9,18.00,0.00,"
+                      "120000,180524");
+  free(lines);
+  free(csv);
+
+  // SD task stalled: appends fill both buffers, then whole fixes drop and
+  // each file still ends on a complete record once the task catches up
+  uint32_t appended = 0, dropped = 0;
+  for (uint32_t i = 0; i < 1000; i++) {
+    gps_data_t gps = make_gps(N_BULK + N_TAIL + i);
+    if (sd_logger_append(&gps))
+      appended++;
+    else
+      dropped++;
+  }
+  CHECK(dropped > 0);
+  CHECK_EQ(sd_logger_flush(), ESP_OK);
+  sd_logger_get_stats(&st);
+  CHECK_EQ(st.records, N_BULK + N_TAIL + appended);
+  CHECK_EQ(st.dropped, dropped);
+  CHECK_EQ(read_all(), st.records);
+  size_t csv_len;
+  csv = fixture_load(SD_LOG_CSV_PATH, &csv_len);
+  CHECK(csv_len > 0 && csv[csv_len - 1] == '\n');
+  CHECK_EQ(fixture_lines(csv, &lines), st.records);
+  free(lines);
+  free(csv);
+  fflush(stdout);
+  return test_failures ? 1 : 0;
+}
+
+// Child process: logs across midnight, flushes and exits without closing
+// the open segment, as a reset would leave it
+static int log_then_cut(void) {
+  host_set_time_us(0);
+  if (sd_logger_init() != ESP_OK)
+    return 2;
+
+  // No timed flush: every write is a whole 4 KiB at an aligned offset,
+  // except the two footer writes of the segment closed at midnight
+  bool ok = true;
+  for (uint32_t i = 0; i < 2 * N_BULK; i++) {
+    gps_data_t gps = make_gps(i);
+    ok = sd_logger_append(&gps) && ok;
+    sd_logger_service();
+  }
+  CHECK(ok);
+  sd_logger_stats_t st;
+  sd_logger_get_stats(&st);
+  CHECK_EQ(st.segments, 2);
+  CHECK_EQ(unaligned_end, 2 * (st.segments - 1));
+  CHECK_EQ(st.bytes_written, (writes - unaligned_end) * SD_LOG_BUF_BYTES);
+
+  for (uint32_t i = 2 * N_BULK; i < 2 * N_BULK + N_TAIL; i++) {
+    gps_data_t gps = make_gps(i);
+    ok = sd_logger_append(&gps) && ok;
+    sd_logger_service();
+  }
+  CHECK(ok);
+  CHECK_EQ(sd_logger_flush(), ESP_OK);
+  sd_logger_get_stats(&st);
+  CHECK_EQ(st.records, 2 * N_BULK + N_TAIL);
+  fflush(stdout);
+  return test_failures ? 1 : 0;
+}
+
+static void run_child(int (*fn)(void)) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0)
+    _exit(fn());
+  int status;
+  waitpid(pid, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void test_segments(void) {
+  t0 = T_NIGHT;
+  run_child(log_then_cut);
+
+  // Tear the last record of the open segment, as a cut mid-write would
+  char path[64];
+  uint32_t midnight = T_NIGHT + 3600;
+  snprintf(path, sizeof(path), SD_LOG_SEG_DIR "/%08lX.BIN",
+           (unsigned long)midnight);
+  int fd = open(path, O_RDWR);
+  CHECK(fd >= 0);
+  off_t size = lseek(fd, 0, SEEK_END);
+  CHECK_EQ(size % SD_LOG_BUF_BYTES, 0); // no footer yet
+  uint32_t total = 2 * N_BULK + N_TAIL, seg_records = total - 3600;
+  off_t last = sizeof(sd_log_block_hdr_t) +
+               ((seg_records - 1) % SD_LOG_BLOCK_RECORDS) *
+                   sizeof(sd_log_record_t);
+  uint8_t junk[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  CHECK(pwrite(fd, junk, sizeof(junk), size - SD_LOG_BUF_BYTES + last) ==
+        (ssize_t)sizeof(junk));
+  close(fd);
+
+  // Init repairs it: the torn record is dropped and a footer written
+  host_set_time_us(0);
+  CHECK_EQ(sd_logger_init(), ESP_OK);
+  sd_logger_stats_t st;
+  sd_logger_get_stats(&st);
+  CHECK_EQ(st.recovered, seg_records - 1);
+  struct stat sb;
+  CHECK(stat(path, &sb) == 0 && sb.st_size % SD_LOG_BUF_BYTES != 0);
+
+  uint32_t kept = total - 1;
+  bool same;
+  CHECK_EQ(read_range(0, UINT32_MAX, 0, &same), kept);
+  CHECK(same);
+  CHECK_EQ(read_range(t0 + 1000, t0 + 1100, 1000, &same), 101);
+  CHECK(same);
+  CHECK_EQ(read_range(t0 + 3500, t0 + 3700, 3500, &same), 201);
+  CHECK(same);
+  CHECK_EQ(read_range(t0 + kept, UINT32_MAX, 0, &same), 0);
+  CHECK_EQ(read_range(0, t0 - 1, 0, &same), 0);
+
+  // Fixes no later than the recovered tail stay out of the segments: the
+  // first one would have reopened the oldest segment's name
+  gps_data_t old = make_gps(0);
+  CHECK(sd_logger_append(&old));
+  old = make_gps(kept - 1);
+  CHECK(sd_logger_append(&old));
+  CHECK_EQ(sd_logger_flush(), ESP_OK);
+  CHECK_EQ(read_range(0, UINT32_MAX, 0, &same), kept);
+  CHECK(same);
+
+  // New fixes go to a new segment; reads of it use the RAM index
+  for (uint32_t i = kept + 1; i <= kept + 500; i++) {
+    gps_data_t gps = make_gps(i);
+    CHECK(sd_logger_append(&gps));
+    sd_logger_service();
+  }
+  CHECK_EQ(sd_logger_flush(), ESP_OK);
+  CHECK_EQ(read_range(t0 + kept + 1, UINT32_MAX, kept + 1, &same), 500);
+  CHECK(same);
+  CHECK_EQ(read_range(t0 + kept + 400, t0 + kept + 409, kept + 400, &same),
+           10);
+  CHECK(same);
+  // The gap left by the torn record
+  CHECK_EQ(read_range(t0 + kept, t0 + kept, 0, &same), 0);
+  sd_logger_get_stats(&st);
+  CHECK_EQ(st.segments, 1);
+
+  // A file already named for the next day's segment is left alone: the
+  // fixes buffered for it are lost and the next one starts a segment
+  uint32_t next = midnight + 86400 - t0;
+  snprintf(path, sizeof(path), SD_LOG_SEG_DIR "/%08lX.BIN",
+           (unsigned long)(t0 + next));
+  fd = open(path, O_WRONLY | O_CREAT, 0644);
+  CHECK(fd >= 0 && write(fd, "keep", 4) == 4);
+  close(fd);
+  for (uint32_t i = next; i < next + 500; i++) {
+    gps_data_t gps = make_gps(i);
+    CHECK(sd_logger_append(&gps));
+    sd_logger_service();
+  }
+  CHECK_EQ(sd_logger_flush(), ESP_OK);
+  char keep[8] = {0};
+  fd = open(path, O_RDONLY);
+  CHECK(fd >= 0 && read(fd, keep, sizeof(keep)) == 4);
+  close(fd);
+  CHECK_STR(keep, "keep");
+  uint32_t lost = SD_LOG_BLOCK_RECORDS + 1;
+  CHECK_EQ(read_range(t0 + next, UINT32_MAX, next + lost, &same),
+           500 - lost);
+  CHECK(same);
+  sd_logger_get_stats(&st);
+  CHECK_EQ(st.segments, 2);
+}
+
+int main(void) {
+  test_records();
+  const char *dir = scratch_enter();
+  run_child(log_aligned);
+  scratch_remove(SD_LOG_CSV_PATH);
+  scratch_remove(SD_LOG_SEG_DIR);
+  test_segments();
+  scratch_leave(dir);
+  return test_result("test_sd_logger");
+}
@@ -0,0 +1,86 @@
+// seqlock.h between threads: one writer publishes a block whose every word
+// is the write number while two readers copy it. Each copy is whole (all
+// words equal), matches the count seqlock_read() returns, and never goes
+// back in time.
+#include "seqlock.h"
+#include "test_util.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+// 4 KiB copies for 0.4 s: even on one core the scheduler preempts many of
+// them halfway, and a reader that did not retry fails every run
+#define WORDS 1024
+#define WRITES 1000000
+
+typedef struct {
+  uint32_t w[WORDS];
+} block_t;
+
+static block_t published;
+static uint32_t seq;
+static bool done;
+
+typedef struct {
+  uint32_t reads;
+  uint32_t torn;
+  uint32_t wrong_count;
+  uint32_t backwards;
+} reader_t;
+
+static void *writer(void *arg) {
+  block_t next;
+  for (uint32_t n = 1; n <= WRITES; n++) {
+    for (int i = 0; i < WORDS; i++)
+      next.w[i] = n;
+    seqlock_write(&seq, &published, &next, sizeof(published));
+  }
+  __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static void *reader(void *arg) {
+  reader_t *r = arg;
+  uint32_t last = 0;
+  bool more = true;
+  while (more) {
+    // One read after the writer finished, so the last write is seen
+    more = !__atomic_load_n(&done, __ATOMIC_ACQUIRE);
+    block_t copy;
+    uint32_t count = seqlock_read(&seq, &copy, &published, sizeof(copy));
+    r->reads++;
+    for (int i = 1; i < WORDS; i++)
+      if (copy.w[i] != copy.w[0]) {
+        r->torn++;
+        break;
+      }
+    r->wrong_count += count != copy.w[0];
+    r->backwards += count < last;
+    last = count;
+  }
+  return NULL;
+}
+
+int main(void) {
+  block_t copy;
+  CHECK_EQ(seqlock_read(&seq, &copy, &published, sizeof(copy)), 0);
+
+  reader_t readers[2] = {0};
+  pthread_t w, r[2];
+  for (int i = 0; i < 2; i++)
+    pthread_create(&r[i], NULL, reader, &readers[i]);
+  pthread_create(&w, NULL, writer, NULL);
+  pthread_join(w, NULL);
+  for (int i = 0; i < 2; i++) {
+    pthread_join(r[i], NULL);
+    printf("reader %d: %u copies over %u writes\n", i,
+           (unsigned)readers[i].reads, WRITES);
+    CHECK(readers[i].reads > 0);
+    CHECK_EQ(readers[i].torn, 0);
+    CHECK_EQ(readers[i].wrong_count, 0);
+    CHECK_EQ(readers[i].backwards, 0);
+  }
+
+  CHECK_EQ(seqlock_read(&seq, &copy, &published, sizeof(copy)), WRITES);
+  CHECK_EQ(seq, 2 * WRITES);
+  return test_result("test_seqlock");
+}
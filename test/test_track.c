@@ -0,0 +1,211 @@
+// track.c: the delta codec, record sizes on the recorded capture, and the
+// block ring (eviction, range cursors, readers racing the writer)
+#include "test_util.h"
+#include "track.h"
+
+static uint32_t lcg = 1;
+static uint32_t rnd(void) {
+  lcg = lcg * 1103515245u + 12345u;
+  return lcg >> 8;
+}
+
+static bool fix_eq(const track_fix_t *a, const track_fix_t *b) {
+  return a->time == b->time && a->lat_e7 == b->lat_e7 &&
+         a->lon_e7 == b->lon_e7 && a->alt_dm == b->alt_dm &&
+         a->speed_dkmh == b->speed_dkmh && a->course_2deg == b->course_2deg;
+}
+
+static void test_codec(void) {
+  uint8_t buf[TRACK_MAX_RECORD];
+  track_fix_t prev = {1700000000, -228395173, -431149703, 40, 0, 0}, cur, out;
+
+  // Moored: nothing but the 1 s step changes, one flag byte
+  cur = prev;
+  cur.time++;
+  CHECK_EQ(track_encode(&prev, &cur, buf), 1);
+  CHECK(track_decode(&prev, buf, 1, &out) == 1 && fix_eq(&out, &cur));
+
+  // Time must move forward
+  CHECK_EQ(track_encode(&prev, &prev, buf), 0);
+
+  // Worst case fits TRACK_MAX_RECORD and round-trips exactly
+  cur = (track_fix_t){prev.time + 0x7FFFFFFF, INT32_MAX, INT32_MIN,
+                      INT32_MIN, 65535, 179};
+  track_fix_t far = {0, INT32_MIN, INT32_MAX, INT32_MAX, 0, 0};
+  size_t n = track_encode(&far, &cur, buf);
+  CHECK(n > 0 && n <= TRACK_MAX_RECORD);
+  CHECK(track_decode(&far, buf, n, &out) == n && fix_eq(&out, &cur));
+  // Truncated input is an error, not a misread
+  for (size_t cut = 0; cut < n; cut++)
+    CHECK_EQ(track_decode(&far, buf, cut, &out), 0);
+
+  // Random walks
+  int bad = 0;
+  for (int i = 0; i < 100000; i++) {
+    cur = prev;
+    cur.time += 1 + (rnd() % 8 == 0 ? rnd() % 100000 : 0);
+    cur.lat_e7 += (int32_t)(rnd() % 20001) - 10000;
+    cur.lon_e7 += (int32_t)(rnd() % 20001) - 10000;
+    cur.alt_dm += (int32_t)(rnd() % 5) - 2;
+    cur.speed_dkmh = (uint16_t)(rnd() % 300);
+    cur.course_2deg = (uint8_t)(rnd() % 180);
+    n = track_encode(&prev, &cur, buf);
+    if (!n || n > TRACK_MAX_RECORD ||
+        track_decode(&prev, buf, n, &out) != n || !fix_eq(&out, &cur))
+      bad++;
+    prev = cur;
+  }
+  CHECK_EQ(bad, 0);
+}
+
+// Bytes per record on the recorded 1 Hz capture, as header track.h claims
+static void test_record_sizes(void) {
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines);
+  gps_reset_data();
+  track_fix_t prev = {0}, fix;
+  uint8_t buf[TRACK_MAX_RECORD];
+  size_t moving = 0, moving_bytes = 0, max_rec = 0;
+  for (size_t i = 0; i < n; i++) {
+    gps_parse_nmea(lines[i]);
+    // GGA closes each second of this capture, after RMC and VTG
+    if (strncmp(lines[i] + 3, "GGA", 3) ||
+        !track_fix_from_gps(gps_get_data(), &fix))
+      continue;
+    if (prev.time) {
+      size_t len = track_encode(&prev, &fix, buf);
+      if (fix.speed_dkmh > 30) {
+        moving++;
+        moving_bytes += len;
+      }
+      if (len > max_rec)
+        max_rec = len;
+    }
+    prev = fix;
+  }
+  double avg = (double)moving_bytes / moving;
+  printf("1 Hz under way: %.1f bytes/record (max %zu) over %zu records\n",
+         avg, max_rec, moving);
+  CHECK(moving > 300);
+  CHECK(avg >= 6 && avg <= 10);
+  free(lines);
+  free(text);
+}
+
+// The ring, filled past capacity with a known track
+#define TOTAL (TRACK_BLOCKS * 200)
+static track_fix_t ref[TOTAL];
+
+static track_fix_t make_fix(int i) {
+  // 1 Hz under way, a 5 s gap every 1000 fixes
+  track_fix_t f = {1700000000u + i + i / 1000 * 5, -228395173 + i * 37,
+                   -431149703 - i * 11, 40 + (i / 50) % 3, 180 + i % 7,
+                   (uint8_t)(i / 30 % 180)};
+  return f;
+}
+
+static size_t read_range(uint32_t from, uint32_t to, track_fix_t *out,
+                         size_t max) {
+  track_cursor_t cur;
+  track_fix_t f;
+  size_t n = 0;
+  track_cursor_init(&cur, from, to);
+  while (n < max && track_cursor_next(&cur, &f))
+    out[n++] = f;
+  return n;
+}
+
+static void test_ring(void) {
+  static track_fix_t got[TOTAL];
+  track_stats_t st;
+  track_fix_t f = make_fix(0);
+  CHECK(!track_append(&f)); // before init
+  CHECK_EQ(track_init(), ESP_OK);
+  track_get_stats(&st);
+  CHECK_EQ(st.fixes, 0);
+  CHECK_EQ(read_range(0, UINT32_MAX, got, TOTAL), 0);
+
+  // A reader that starts now and keeps up with the writer
+  track_cursor_t live;
+  track_cursor_init(&live, 0, UINT32_MAX);
+  size_t live_n = 0;
+  bool live_ok = true;
+
+  for (int i = 0; i < TOTAL; i++) {
+    ref[i] = make_fix(i);
+    CHECK(track_append(&ref[i]));
+    if (i % 97 == 0) {
+      while (track_cursor_next(&live, &f)) {
+        if (!fix_eq(&f, &ref[live_n]))
+          live_ok = false;
+        live_n++;
+      }
+    }
+  }
+  CHECK(live_ok);
+  CHECK(live_n > TOTAL - 100);
+  CHECK(!track_append(&ref[TOTAL - 1])); // not newer
+  CHECK(!track_append(&ref[10]));
+
+  // Memory budget holds once the ring wraps
+  track_get_stats(&st);
+  CHECK(st.bytes_used <= TRACK_RING_BYTES + TRACK_BLOCKS * 28);
+  CHECK(st.bytes_used > TRACK_RING_BYTES * 9 / 10);
+  CHECK_EQ(st.newest, ref[TOTAL - 1].time);
+  printf("ring: %u of %d fixes kept in %u bytes (%.1f bytes/fix)\n",
+         (unsigned)st.fixes, TOTAL, (unsigned)st.bytes_used,
+         (double)st.bytes_used / st.fixes);
+
+  // Everything still held reads back in order, from the oldest block on
+  size_t first = TOTAL - st.fixes;
+  CHECK_EQ(ref[first].time, st.oldest);
+  size_t n = read_range(0, UINT32_MAX, got, TOTAL);
+  CHECK_EQ(n, st.fixes);
+  bool same = true;
+  for (size_t i = 0; i < n; i++)
+    same = same && fix_eq(&got[i], &ref[first + i]);
+  CHECK(same);
+
+  // Time ranges: inclusive bounds, gaps, empty ranges
+  size_t a = first + 1234, b = first + 5678;
+  n = read_range(ref[a].time, ref[b].time, got, TOTAL);
+  CHECK_EQ(n, b - a + 1);
+  CHECK(fix_eq(&got[0], &ref[a]) && fix_eq(&got[n - 1], &ref[b]));
+  n = read_range(ref[a].time + 1, ref[a].time + 1, got, TOTAL);
+  CHECK(n == 1 && fix_eq(&got[0], &ref[a + 1]));
+  // Inside a 5 s gap
+  size_t gap = (first / 1000 + 2) * 1000;
+  CHECK_EQ(read_range(ref[gap].time - 3, ref[gap].time - 1, got, TOTAL), 0);
+  CHECK_EQ(read_range(0, st.oldest - 1, got, TOTAL), 0);
+  CHECK_EQ(read_range(st.newest + 1, UINT32_MAX, got, TOTAL), 0);
+
+  // A slow reader whose block is evicted resumes at the oldest block
+  track_cursor_t slow;
+  track_cursor_init(&slow, 0, UINT32_MAX);
+  CHECK(track_cursor_next(&slow, &f) && fix_eq(&f, &ref[first]));
+  track_fix_t more;
+  for (int i = 0; i < 2000; i++) {
+    more = make_fix(TOTAL + i);
+    track_append(&more);
+  }
+  track_get_stats(&st);
+  size_t resumed = 0;
+  bool ordered = true;
+  uint32_t last = 0;
+  while (track_cursor_next(&slow, &f)) {
+    if (resumed && f.time <= last)
+      ordered = false;
+    last = f.time;
+    resumed++;
+  }
+  CHECK(ordered);
+  CHECK(last == more.time);
+  CHECK(resumed >= st.fixes);
+}
+
+int main(void) {
+  test_codec();
+  test_record_sizes();
+  test_ring();
+  return test_result("test_track");
+}
@@ -0,0 +1,212 @@
+// track_export.c over a logged SD range through the loopback HTTP stand-in:
+// every format read back against the records, range bounds, chunk sizes,
+// a client that goes away mid-export, and the export's heap use
+#include "heap_wrap.h"
+#include "http_standin.h"
+#include "sd_logger.h"
+#include "test_util.h"
+#include "track_export.h"
+
+#define T0 1716033600u // 2024-05-18T12:00:00Z
+#define N 20000
+
+static sd_log_record_t make_rec(uint32_t i) {
+  sd_log_record_t r = {T0 + i,
+                       -228395173 + (int32_t)i * 37,
+                       -431149703 - (int32_t)i * 11,
+                       (int32_t)(i % 200) - 100,
+                       1800 + i % 7,
+                       (i * 13) % 36000,
+                       (uint8_t)(4 + i % 9),
+                       (uint8_t)(6 + i % 20),
+                       0x07,
+                       0};
+  r.crc8 = sd_log_crc8((const uint8_t *)&r, sizeof(r) - 1);
+  return r;
+}
+
+// v / 10^d written with integer printf, independent of fixed_fmt
+static const char *dec(char *buf, int32_t v, int d) {
+  long scale = 1;
+  for (int i = 0; i < d; i++)
+    scale *= 10;
+  long a = labs((long)v);
+  sprintf(buf, "%s%ld.%0*ld", v < 0 ? "-" : "", a / scale, d, a % scale);
+  return buf;
+}
+
+static void csv_row(char *out, const sd_log_record_t *r) {
+  char a[4][16];
+  char b[3][16];
+  sprintf(out, "%lu,%s,%s,%s,%s,%s,%u,%s", (unsigned long)r->time,
+          dec(a[0], r->lat_e7, 7), dec(a[1], r->lon_e7, 7),
+          dec(a[2], r->alt_cm, 2), dec(a[3], r->speed_ckmh, 2),
+          dec(b[0], r->course_cdeg, 2), r->satellites,
+          dec(b[1], r->hdop_dec, 1));
+}
+
+typedef struct {
+  char *body;
+  size_t len;
+  track_export_stats_t stats;
+  esp_err_t ret;
+  http_standin_t http;
+} export_t;
+
+static void run(export_t *e, track_export_format_t fmt, uint32_t from,
+                uint32_t to) {
+  static char body[N * 200];
+  http_standin_open(&e->http, body, sizeof(body));
+  e->ret = track_export_stream(fmt, from, to, http_standin_chunk, &e->http,
+                               &e->stats);
+  if (e->ret == ESP_OK)
+    http_standin_chunk(NULL, 0, &e->http);
+  http_standin_close(&e->http);
+  body[e->http.body_len < sizeof(body) ? e->http.body_len
+                                       : sizeof(body) - 1] = '\0';
+  e->body = body;
+  e->len = e->http.body_len;
+  // Transport view matches the exporter's own count
+  CHECK(e->ret != ESP_OK || !e->http.malformed);
+  CHECK(e->ret != ESP_OK || e->http.chunks == e->stats.chunks);
+  CHECK(e->ret != ESP_OK || e->len == e->stats.bytes);
+  CHECK(e->http.max_chunk <= TRACK_EXPORT_CHUNK);
+}
+
+static size_t count(const char *s, const char *needle) {
+  size_t n = 0;
+  for (const char *p = strstr(s, needle); p; p = strstr(p + 1, needle))
+    n++;
+  return n;
+}
+
+static void test_names(void) {
+  track_export_format_t fmt;
+  CHECK(track_export_parse_format("geojson", &fmt) &&
+        fmt == TRACK_EXPORT_GEOJSON);
+  CHECK(track_export_parse_format("bin", &fmt) && fmt == TRACK_EXPORT_BIN);
+  CHECK(!track_export_parse_format("kml", &fmt));
+  CHECK(!track_export_parse_format("GPX", &fmt));
+  CHECK_STR(track_export_mime(TRACK_EXPORT_GPX), "application/gpx+xml");
+  CHECK_STR(track_export_extension(TRACK_EXPORT_CSV), "csv");
+}
+
+static void test_formats(void) {
+  static export_t e;
+  char row[160];
+
+  run(&e, TRACK_EXPORT_CSV, 0, UINT32_MAX);
+  CHECK_EQ(e.ret, ESP_OK);
+  CHECK_EQ(e.stats.records, N);
+  char **lines;
+  size_t n = fixture_lines(e.body, &lines);
+  CHECK_EQ(n, N + 1);
+  CHECK_STR(lines[0], "time,latitude,longitude,altitude,speed,course,"
+                      "satellites,hdop");
+  int bad = 0;
+  for (uint32_t i = 0; i < N && i + 1 < n; i++) {
+    sd_log_record_t r = make_rec(i);
+    csv_row(row, &r);
+    bad += strcmp(lines[i + 1], row) != 0;
+  }
+  CHECK_EQ(bad, 0);
+  free(lines);
+
+  run(&e, TRACK_EXPORT_GPX, 0, UINT32_MAX);
+  CHECK_EQ(e.ret, ESP_OK);
+  CHECK_EQ(count(e.body, "<trkpt "), N);
+  CHECK_EQ(count(e.body, "</trkpt>\n"), N);
+  CHECK(strncmp(e.body, "<?xml", 5) == 0);
+  CHECK(e.len > 23 && strcmp(e.body + e.len - 23,
+                             "</trkseg></trk>\n</gpx>\n") == 0);
+  CHECK(strstr(e.body, "<trkpt lat=\"-22.8395136\" lon=\"-43.1149714\">"
+                       "<ele>-0.99</ele><time>2024-05-18T12:00:01Z</time>"
+                       "<sat>5</sat><hdop>0.7</hdop></trkpt>\n") != NULL);
+
+  run(&e, TRACK_EXPORT_GEOJSON, 0, UINT32_MAX);
+  CHECK_EQ(e.ret, ESP_OK);
+  CHECK_EQ(count(e.body, "["), N + 1);
+  CHECK(strstr(e.body, "\"coordinates\":[[-43.1149703,-22.8395173,-1.00],"
+                       "[-43.1149714,-22.8395136,-0.99],") != NULL);
+  CHECK(e.len > 4 && strcmp(e.body + e.len - 4, "]}}\n") == 0);
+
+  run(&e, TRACK_EXPORT_BIN, 0, UINT32_MAX);
+  CHECK_EQ(e.ret, ESP_OK);
+  CHECK_EQ(e.len, N * sizeof(sd_log_record_t));
+  bad = 0;
+  for (uint32_t i = 0; i < N; i++) {
+    sd_log_record_t r = make_rec(i);
+    bad += memcmp(e.body + i * sizeof(r), &r, sizeof(r)) != 0;
+  }
+  CHECK_EQ(bad, 0);
+}
+
+static void test_ranges(void) {
+  static export_t e;
+  run(&e, TRACK_EXPORT_BIN, T0 + 5000, T0 + 5999);
+  CHECK_EQ(e.stats.records, 1000);
+  sd_log_record_t r = make_rec(5000);
+  CHECK(e.len >= sizeof(r) && memcmp(e.body, &r, sizeof(r)) == 0);
+
+  // Nothing logged in range: header and footer only
+  run(&e, TRACK_EXPORT_GEOJSON, T0 + N, UINT32_MAX);
+  CHECK_EQ(e.ret, ESP_OK);
+  CHECK_EQ(e.stats.records, 0);
+  CHECK_STR(e.body, "{\"type\":\"Feature\",\"properties\":{},\"geometry\":"
+                    "{\"type\":\"LineString\",\"coordinates\":[]}}\n");
+  run(&e, TRACK_EXPORT_CSV, 0, T0 - 1);
+  CHECK_EQ(e.stats.records, 0);
+  CHECK_EQ(e.stats.chunks, 1);
+}
+
+// A client that disconnects: the export stops and reports it
+static void test_abort(void) {
+  static export_t e;
+  size_t before = heap_live();
+  http_standin_t *h = &e.http;
+  char body[64];
+  http_standin_open(h, body, sizeof(body));
+  h->fail_after = 3;
+  e.ret = track_export_stream(TRACK_EXPORT_GPX, 0, UINT32_MAX,
+                              http_standin_chunk, h, &e.stats);
+  http_standin_close(h);
+  CHECK_EQ(e.ret, ESP_FAIL);
+  CHECK_EQ(e.stats.chunks, 4); // the failed send is counted
+  CHECK(e.stats.records > 0 && e.stats.records < N / 100);
+  CHECK(h->malformed); // no terminating chunk
+  CHECK_EQ(heap_live(), before);
+}
+
+// Heap while exporting: the cursor and one chunk, whatever the range
+static void test_memory(void) {
+  static export_t e;
+  size_t before = heap_live();
+  heap_reset_peak();
+  run(&e, TRACK_EXPORT_GPX, 0, UINT32_MAX);
+  size_t peak = heap_peak() - before;
+  printf("export heap peak %zu B (cursor %zu + chunk buffer)\n", peak,
+         sizeof(sd_log_cursor_t));
+  CHECK(peak >= sizeof(sd_log_cursor_t) + TRACK_EXPORT_CHUNK);
+  CHECK(peak < 8 * 1024);
+  CHECK_EQ(heap_live(), before);
+}
+
+int main(void) {
+  test_names();
+  const char *dir = scratch_enter();
+  host_set_time_us(0);
+  CHECK_EQ(sd_logger_init(), ESP_OK);
+  for (uint32_t i = 0; i < N; i++) {
+    sd_log_record_t r = make_rec(i);
+    sd_logger_append_record(&r);
+    sd_logger_service();
+  }
+  CHECK_EQ(sd_logger_flush(), ESP_OK);
+
+  test_formats();
+  test_ranges();
+  test_abort();
+  test_memory();
+  scratch_leave(dir);
+  return test_result("test_track_export");
+}
@@ -0,0 +1,185 @@
+// track_simplify.c against double-precision distances: the 1 Hz NMEA
+// capture through gps_parse_nmea() and sd_log_record_from_gps(), as the
+// ingest task feeds it, then synthetic tracks (moored jitter, a noisy
+// straight run, circles, a turn at 78N, gaps) at 2/5/10/25 m. Every fix
+// fed in must lie within the tolerance of the emitted segment that spans
+// its time, and the keepalive bounds the gaps.
+#include "geo.h"
+#include "gps_parser.h"
+#include "sd_logger.h"
+#include "test_util.h"
+#include "track_gen.h"
+#include "track_simplify.h"
+#include <math.h>
+
+#define MAX_FIXES 20000
+#define M_PER_E7 (GEO_CM_PER_E7_X100000 / 1e7) // 1e-7 degree of latitude
+#define SLACK_M 0.05 // 1e-7 degree rounding in the integer plane
+
+static sd_log_record_t in[MAX_FIXES], out[MAX_FIXES];
+// Distance in metres from p to segment a-b, local plane at a's latitude
+static double seg_dist_m(const sd_log_record_t *a, const sd_log_record_t *b,
+                         const sd_log_record_t *p) {
+  double k = cos(a->lat_e7 / 1e7 * M_PI / 180);
+  double bx = (double)(b->lon_e7 - a->lon_e7) * k, by = b->lat_e7 - a->lat_e7;
+  double px = (double)(p->lon_e7 - a->lon_e7) * k, py = p->lat_e7 - a->lat_e7;
+  double l = bx * bx + by * by;
+  double t = l > 0 ? (px * bx + py * by) / l : 0;
+  t = t < 0 ? 0 : t > 1 ? 1 : t;
+  return hypot(px - t * bx, py - t * by) * M_PER_E7;
+}
+
+typedef struct {
+  size_t out;
+  double max_dev_m;
+  uint32_t max_gap_s;
+  track_simplify_stats_t stats;
+} run_t;
+
+// Simplifies in[0..n), checks the bound, returns what came out
+static run_t run(size_t n, uint32_t tol_m) {
+  track_simplifier_t s;
+  track_simplify_init(&s, tol_m, TRACK_SIMPLIFY_KEEPALIVE_S);
+  run_t r = {0};
+  for (size_t i = 0; i < n; i++) {
+    if (track_simplify_push(&s, &in[i], &out[r.out]))
+      r.out++;
+  }
+  if (track_simplify_flush(&s, &out[r.out]))
+    r.out++;
+  r.stats = s.stats;
+  CHECK_EQ(r.stats.out, r.out);
+  CHECK(r.out >= 2);
+  CHECK_EQ(out[0].time, in[0].time);
+  CHECK_EQ(out[r.out - 1].time, in[n - 1].time);
+
+  size_t seg = 0;
+  for (size_t i = 0; i < n; i++) {
+    while (seg + 1 < r.out && out[seg + 1].time < in[i].time)
+      seg++;
+    if (seg + 1 == r.out)
+      break;
+    double d = seg_dist_m(&out[seg], &out[seg + 1], &in[i]);
+    r.max_dev_m = d > r.max_dev_m ? d : r.max_dev_m;
+  }
+  for (size_t j = 1; j < r.out; j++) {
+    CHECK(out[j].time > out[j - 1].time);
+    uint32_t gap = out[j].time - out[j - 1].time;
+    r.max_gap_s = gap > r.max_gap_s ? gap : r.max_gap_s;
+  }
+  CHECK(r.max_dev_m <= tol_m + SLACK_M);
+  return r;
+}
+
+static size_t load_capture(void) {
+  char *text = fixture_load("gp_1hz.nmea", NULL), **lines;
+  size_t n = fixture_lines(text, &lines), fixes = 0;
+  gps_reset_data();
+  for (size_t i = 0; i < n; i++) {
+    gps_parse_nmea(lines[i]);
+    // Once per epoch, after the GGA that closes it
+    if (strncmp(lines[i] + 3, "GGA", 3) == 0 &&
+        sd_log_record_from_gps(gps_get_data(), &in[fixes]))
+      fixes++;
+  }
+  free(lines);
+  free(text);
+  return fixes;
+}
+
+static void test_capture(void) {
+  size_t n = load_capture();
+  CHECK_EQ(n, 600);
+  static const uint32_t tols[] = {2, 5, 10, 25};
+  for (int t = 0; t < 4; t++) {
+    run_t r = run(n, tols[t]);
+    printf("capture, %2u m: %zu -> %zu fixes (%.1f:1), max %.2f m, "
+           "longest gap %u s\n",
+           tols[t], n, r.out, (double)n / r.out, r.max_dev_m, r.max_gap_s);
+    CHECK(r.max_gap_s <= TRACK_SIMPLIFY_KEEPALIVE_S);
+  }
+}
+
+static void test_shapes(void) {
+  static const uint32_t tols[] = {2, 5, 10, 25};
+  for (int shape = 0; shape < TRACK_GEN_SHAPES; shape++) {
+    size_t n = MAX_FIXES;
+    track_gen(shape, n, in);
+    for (int t = 0; t < 4; t++) {
+      run_t r = run(n, tols[t]);
+      printf("%-9s %2u m: %5.1f:1, max %5.2f m, %u keepalives, "
+             "%u window cuts\n",
+             track_gen_name(shape), tols[t], (double)n / r.out, r.max_dev_m,
+             r.stats.keepalives, r.stats.window_cuts);
+      // A gap in the input is the only way past the keepalive
+      if (shape != TRACK_GEN_GAPS)
+        CHECK(r.max_gap_s <= TRACK_SIMPLIFY_KEEPALIVE_S);
+    }
+  }
+}
+
+static void test_edges(void) {
+  track_simplifier_t s;
+  sd_log_record_t o;
+  track_simplify_init(&s, 5, 60);
+  CHECK(!track_simplify_flush(&s, &o));
+  CHECK_EQ(track_simplify_ratio_x100(&s.stats), 0);
+  sd_log_record_t a = {.time = 100, .lat_e7 = -228400000,
+                       .lon_e7 = -431100000};
+  CHECK(track_simplify_push(&s, &a, &o));
+  CHECK_EQ(o.time, 100);
+  // Same second and older fixes are ignored, not counted
+  CHECK(!track_simplify_push(&s, &a, &o));
+  a.time = 99;
+  CHECK(!track_simplify_push(&s, &a, &o));
+  CHECK_EQ(s.stats.in, 1);
+
+  // Standing still: one fix per keepalive
+  int emitted = 0;
+  for (uint32_t t = 101; t <= 400; t++) {
+    a.time = t;
+    emitted += track_simplify_push(&s, &a, &o);
+  }
+  CHECK_EQ(emitted, 5);
+  CHECK_EQ(s.stats.keepalives, 5);
+
+  // A 90-degree corner: the fix before the deviation is emitted
+  track_simplify_init(&s, 5, 60);
+  sd_log_record_t p = {.time = 1000, .lat_e7 = -228400000, .lon_e7 = 0};
+  track_simplify_push(&s, &p, &o);
+  for (int i = 1; i <= 20; i++) {
+    p.time++;
+    p.lat_e7 += 900; // ~10 m north
+    CHECK(!track_simplify_push(&s, &p, &o));
+  }
+  sd_log_record_t corner = p;
+  p.time++;
+  p.lon_e7 += 300;
+  CHECK(!track_simplify_push(&s, &p, &o)); // ~3 m east still fits
+  p.time++;
+  p.lon_e7 += 300;
+  CHECK(track_simplify_push(&s, &p, &o));
+  CHECK_EQ(o.time, corner.time + 1);
+  CHECK(track_simplify_flush(&s, &o));
+  CHECK_EQ(o.time, p.time);
+  CHECK_EQ(track_simplify_ratio_x100(&s.stats), 23 * 100 / 3);
+
+  // Without the keepalive, a straight run is cut when the window fills:
+  // the first fix, then one cut on the fix after each full window
+  track_simplify_init(&s, 5, UINT32_MAX);
+  emitted = 0;
+  for (int i = 0; i < 1 + 3 * (TRACK_SIMPLIFY_WINDOW + 1); i++) {
+    p.time++;
+    p.lat_e7 += 900;
+    emitted += track_simplify_push(&s, &p, &o);
+  }
+  CHECK_EQ(s.stats.window_cuts, 3);
+  CHECK_EQ(emitted, 4);
+}
+
+int main(void) {
+  test_edges();
+  test_capture();
+  test_shapes();
+  return test_result("test_track_simplify");
+}
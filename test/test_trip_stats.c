@@ -0,0 +1,249 @@
+// trip_stats.c on the host: the NVS image, the JSON, a 5 h day (trip_gen:
+// moored, under way, moored past the split, under way) against the
+// haversine length of the noise-free track, and the moving/stopped,
+// reset, jump and gap rules.
+#include "nvs.h"
+#include "test_util.h"
+#include "trip_gen.h"
+#include "trip_stats.h"
+#include <math.h>
+
+// trip_stats.c's NVS image
+typedef struct {
+  uint32_t version;
+  uint64_t odometer_cm;
+  trip_t trip;
+} saved_t;
+
+#define ODOMETER_CM 123456789u
+
+static void put_blob(const void *blob, size_t len) {
+  nvs_handle_t h;
+  CHECK_EQ(nvs_open(TRIP_STATS_NVS_NAMESPACE, NVS_READWRITE, &h), ESP_OK);
+  CHECK_EQ(nvs_set_blob(h, TRIP_STATS_NVS_KEY, blob, len), ESP_OK);
+  nvs_close(h);
+}
+
+static saved_t get_blob(void) {
+  saved_t s = {0};
+  size_t len = sizeof(s);
+  nvs_handle_t h;
+  CHECK_EQ(nvs_open(TRIP_STATS_NVS_NAMESPACE, NVS_READONLY, &h), ESP_OK);
+  CHECK_EQ(nvs_get_blob(h, TRIP_STATS_NVS_KEY, &s, &len), ESP_OK);
+  nvs_close(h);
+  CHECK_EQ(len, sizeof(s));
+  return s;
+}
+
+static void test_json(void) {
+  trip_stats_t s = {
+      .odometer_cm = ODOMETER_CM,
+      .moving = true,
+      .trip = {TRIP_GEN_T0, TRIP_GEN_T0 + 3600, 1340700, 4020, 720, 3140,
+               310},
+  };
+  CHECK_EQ(trip_stats_avg_ckmh(&s.trip), 1200);
+  CHECK_EQ(trip_stats_avg_ckmh(&(trip_t){.distance_cm = 5000}), 0);
+  const char *want =
+      "{\"odometer\":1234.567,\"moving\":true,\"trip\":{"
+      "\"start\":1716033600,\"last\":1716037200,\"distance\":13.407,"
+      "\"moving_s\":4020,\"stopped_s\":720,\"max_speed\":31.40,"
+      "\"min_speed\":3.10,\"avg_speed\":12.00}}";
+  char buf[256];
+  CHECK_EQ(trip_stats_json(&s, buf, sizeof(buf)), strlen(want));
+  CHECK_STR(buf, want);
+  // A buffer one byte short is refused
+  CHECK_EQ(trip_stats_json(&s, buf, strlen(want)), 0);
+  CHECK_EQ(trip_stats_json(&s, buf, strlen(want) + 1), strlen(want));
+}
+
+// A missing image starts from zero; a wrong version or size is refused
+// and the odometer is not touched; a good one is loaded
+static void test_init(void) {
+  host_nvs_reset();
+  CHECK_EQ(trip_stats_init(), ESP_OK);
+  trip_stats_t st;
+  trip_stats_get(&st);
+  CHECK(st.odometer_cm == 0 && st.trip.start == 0);
+
+  saved_t s = {
+      .version = 2,
+      .odometer_cm = ODOMETER_CM,
+      // Last seen ten minutes before the replay, after a 20 km trip
+      .trip = {.start = TRIP_GEN_T0 - 86400, .last = TRIP_GEN_T0 - 600,
+               .distance_cm = 2000000, .moving_s = 7200},
+  };
+  put_blob(&s, sizeof(s));
+  CHECK_EQ(trip_stats_init(), ESP_ERR_INVALID_VERSION);
+  s.version = 1;
+  put_blob(&s, sizeof(s) - 4);
+  CHECK_EQ(trip_stats_init(), ESP_ERR_INVALID_VERSION);
+  trip_stats_get(&st);
+  CHECK_EQ(st.odometer_cm, 0);
+
+  put_blob(&s, sizeof(s));
+  CHECK_EQ(trip_stats_init(), ESP_OK);
+  trip_stats_get(&st);
+  CHECK_EQ(st.odometer_cm, ODOMETER_CM);
+  CHECK_EQ(st.trip.start, s.trip.start);
+  CHECK_EQ(st.trip.distance_cm, s.trip.distance_cm);
+}
+
+static double err_pct(double counted_cm, double truth_m) {
+  return (counted_cm / 100 - truth_m) / truth_m * 100;
+}
+
+// The day, with trip_stats_service() every 10 s as the MQTT task does
+static void test_day(void) {
+  static trip_gen_fix_t fixes[TRIP_GEN_FIXES];
+  static double truth[TRIP_GEN_FIXES];
+  trip_gen(fixes, truth);
+  const size_t leg1 = TRIP_GEN_MOORED_S;
+  const size_t stop = leg1 + TRIP_GEN_LEG1_S;
+  const size_t leg2 = stop + TRIP_GEN_STOP_S;
+
+  uint32_t writes = host_nvs_writes();
+  trip_stats_t st, at_stop, end_leg1;
+  for (size_t i = 0; i < TRIP_GEN_FIXES; i++) {
+    const trip_gen_fix_t *f = &fixes[i];
+    trip_stats_update(f->time, f->lat_e7, f->lon_e7, f->speed_ckmh);
+    if (f->time % 10 == 0)
+      trip_stats_service();
+    if (i == leg1 - 1) {
+      // Nothing added at the mooring
+      trip_stats_get(&st);
+      CHECK(!st.moving);
+      CHECK_EQ(st.odometer_cm, ODOMETER_CM);
+    } else if (i == stop + 60) {
+      trip_stats_get(&at_stop);
+      CHECK(!at_stop.moving);
+    } else if (i == leg2 - 1) {
+      trip_stats_get(&end_leg1);
+      CHECK_EQ(end_leg1.odometer_cm, at_stop.odometer_cm);
+    }
+  }
+  trip_stats_get(&st);
+
+  // More than TRIP_STATS_SPLIT_S at the mooring: each leg opened a trip
+  // at the last moored fix. The first one is measured from the trip the
+  // second leg replaced.
+  const trip_t *t1 = &end_leg1.trip, *t2 = &st.trip;
+  CHECK_EQ(t1->start, TRIP_GEN_T0 + leg1 - 1);
+  CHECK_EQ(t2->start, TRIP_GEN_T0 + leg2 - 1);
+  double truth1 = truth[stop - 1], truth2 = truth[TRIP_GEN_FIXES - 1];
+  truth2 -= truth1;
+  double e1 = err_pct(t1->distance_cm, truth1);
+  double e2 = err_pct(t2->distance_cm, truth2);
+  double eo =
+      err_pct((double)(st.odometer_cm - ODOMETER_CM), truth1 + truth2);
+  uint32_t saves = host_nvs_writes() - writes;
+  printf("legs %.3f/%.3f km: error %+.3f%%/%+.3f%%, odometer %+.3f%%; "
+         "moving %lu/%lu s; %u NVS writes in %u fixes\n",
+         truth1 / 1000, truth2 / 1000, e1, e2, eo,
+         (unsigned long)t1->moving_s, (unsigned long)t2->moving_s, saves,
+         (unsigned)TRIP_GEN_FIXES);
+  // Noise of 1 m at both ends of a 25 m leg lengthens it by ~0.1% on
+  // average; the second leg is still open, so its last metres are missing
+  CHECK(fabs(e1) < 0.15 && fabs(e2) < 0.15 && fabs(eo) < 0.15);
+  // Moving time is the leg give or take the hysteresis
+  CHECK(abs((int)t1->moving_s - TRIP_GEN_LEG1_S) <= 5);
+  CHECK(abs((int)t2->moving_s - TRIP_GEN_LEG2_S) <= 5);
+  CHECK(t1->max_speed_ckmh >= 1400 && t1->max_speed_ckmh < 1500);
+  CHECK(t1->min_speed_ckmh >= 300 && t1->min_speed_ckmh < 800);
+  CHECK(abs((int)trip_stats_avg_ckmh(t1) - 1100) < 100);
+  // One write per new trip and per stop, else one per TRIP_STATS_SAVE_S
+  // under way
+  uint32_t under_way = TRIP_GEN_LEG1_S + TRIP_GEN_LEG2_S;
+  CHECK(saves >= under_way / TRIP_STATS_SAVE_S &&
+        saves <= under_way / TRIP_STATS_SAVE_S + 4);
+
+  // The image follows the published state after the next save
+  uint32_t t = st.trip.last;
+  const trip_gen_fix_t *last = &fixes[TRIP_GEN_FIXES - 1];
+  for (int i = 1; i <= 10; i++)
+    trip_stats_update(t + i, last->lat_e7, last->lon_e7, 0);
+  trip_stats_service();
+  trip_stats_get(&st);
+  saved_t s = get_blob();
+  CHECK_EQ(s.version, 1);
+  CHECK_EQ(s.odometer_cm, st.odometer_cm);
+  CHECK_EQ(s.trip.distance_cm, st.trip.distance_cm);
+  CHECK_EQ(s.trip.last, st.trip.last);
+}
+
+// Position east of a point, metres
+static int32_t lon_at(double m) {
+  return (int32_t)lround((-43.11 + m / (111195 * cos(-22.84 * M_PI / 180))) *
+                         1e7);
+}
+
+#define LAT (-228400000)
+
+static void test_rules(void) {
+  trip_stats_t st;
+  trip_stats_get(&st);
+  uint32_t t = st.trip.last + 100, fixes = st.fixes;
+  CHECK(!st.moving);
+
+  // Time must move forward
+  trip_stats_update(st.trip.last, LAT, lon_at(0), 0);
+  trip_stats_get(&st);
+  CHECK_EQ(st.fixes, fixes);
+
+  // 3 km/h to start, below 1.5 km/h to stop
+  const uint32_t speeds[] = {200, 299, 300, 200, 150, 149, 200};
+  const bool moving[] = {false, false, true, true, true, false, false};
+  for (int i = 0; i < 7; i++) {
+    trip_stats_update(++t, LAT, lon_at(0), speeds[i]);
+    trip_stats_get(&st);
+    CHECK_EQ(st.moving, moving[i]);
+  }
+
+  // A reset opens a trip at the last fix on the next one
+  trip_stats_reset_trip();
+  trip_stats_update(++t, LAT, lon_at(0), 0);
+  trip_stats_get(&st);
+  CHECK_EQ(st.trip.start, t - 1);
+  CHECK(st.trip.distance_cm == 0 && st.trip.moving_s == 0);
+  uint64_t odo = st.odometer_cm;
+
+  // 60 s at 18 km/h: 300 m in legs of at least TRIP_STATS_MIN_LEG_M
+  double x = 0;
+  for (int i = 0; i < 60; i++)
+    trip_stats_update(++t, LAT, lon_at(x += 5), 1800);
+  trip_stats_get(&st);
+  CHECK(st.moving && st.trip.moving_s == 60);
+  CHECK(st.trip.distance_cm >= 29900 && st.trip.distance_cm <= 30100);
+  uint32_t before = st.trip.distance_cm;
+
+  // A 5 km jump in one second is dropped; counting goes on from there
+  trip_stats_update(++t, LAT, lon_at(x += 5000), 1800);
+  for (int i = 0; i < 10; i++)
+    trip_stats_update(++t, LAT, lon_at(x += 5), 1800);
+  trip_stats_get(&st);
+  CHECK(st.trip.distance_cm - before <= 5100);
+  before = st.trip.distance_cm;
+
+  // A 60 s gap adds no moving time, but its 300 m leg is plausible
+  uint32_t moving_s = st.trip.moving_s;
+  t += 60;
+  trip_stats_update(t, LAT, lon_at(x += 300), 1800);
+  trip_stats_get(&st);
+  CHECK_EQ(st.trip.moving_s, moving_s);
+  CHECK(st.trip.distance_cm - before >= 29900);
+
+  // Stopping closes the pending leg
+  trip_stats_update(++t, LAT, lon_at(x += 20), 0);
+  trip_stats_get(&st);
+  CHECK(!st.moving);
+  CHECK_EQ(st.odometer_cm - odo, st.trip.distance_cm);
+  CHECK(st.trip.max_speed_ckmh == 1800 && st.trip.min_speed_ckmh == 1800);
+}
+
+int main(void) {
+  test_json();
+  test_init();
+  test_day();
+  test_rules();
+  return test_result("test_trip_stats");
+}
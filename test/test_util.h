@@ -0,0 +1,135 @@
+#pragma once
+
+// Shared helpers for the host tests and benchmarks: checks that report and
+// count failures instead of aborting, fixture loading and timing.
+#include "host.h"
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int test_failures;
+
+#define CHECK(cond)                                                          \
+  do {                                                                       \
+    if (!(cond)) {                                                           \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,       \
+              #cond);                                                        \
+      test_failures++;                                                       \
+    }                                                                        \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                       \
+  do {                                                                       \
+    long long a_ = (long long)(a), b_ = (long long)(b);                      \
+    if (a_ != b_) {                                                          \
+      fprintf(stderr, "%s:%d: %s == %s failed: %lld != %lld\n", __FILE__,    \
+              __LINE__, #a, #b, a_, b_);                                     \
+      test_failures++;                                                       \
+    }                                                                        \
+  } while (0)
+
+#define CHECK_STR(a, b)                                                      \
+  do {                                                                       \
+    const char *a_ = (a), *b_ = (b);                                         \
+    if (strcmp(a_, b_) != 0) {                                               \
+      fprintf(stderr, "%s:%d: %s == \"%s\" failed: \"%s\"\n", __FILE__,      \
+              __LINE__, #a, b_, a_);                                         \
+      test_failures++;                                                       \
+    }                                                                        \
+  } while (0)
+
+// Exit status for main()
+static inline int test_result(const char *name) {
+  if (test_failures)
+    fprintf(stderr, "%s: %d check(s) failed\n", name, test_failures);
+  else
+    printf("%s: ok\n", name);
+  return test_failures ? 1 : 0;
+}
+
+// Whole fixture file, NUL-terminated; exits when it cannot be read
+static inline char *fixture_load(const char *name, size_t *len) {
+  FILE *f = fopen(name, "rb");
+  if (!f) {
+    perror(name);
+    exit(2);
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *buf = malloc((size_t)size + 1);
+  if (!buf || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+    fprintf(stderr, "%s: read failed\n", name);
+    exit(2);
+  }
+  fclose(f);
+  buf[size] = '\0';
+  if (len)
+    *len = (size_t)size;
+  return buf;
+}
+
+// Splits a loaded text fixture into lines in place (CR/LF dropped).
+// Returns the line count; *lines is malloc'd.
+static inline size_t fixture_lines(char *text, char ***lines) {
+  size_t n = 0, cap = 1024;
+  char **out = malloc(cap * sizeof(*out));
+  for (char *p = text; *p;) {
+    char *end = p + strcspn(p, "\r\n");
+    char next = *end;
+    *end = '\0';
+    if (end > p) {
+      if (n == cap)
+        out = realloc(out, (cap *= 2) * sizeof(*out));
+      out[n++] = p;
+    }
+    p = next ? end + 1 : end;
+  }
+  *lines = out;
+  return n;
+}
+
+// Iteration count from argv[1], for benchmarks: ctest passes a short run
+static inline int bench_iterations(int argc, char **argv, int fallback) {
+  return argc > 1 ? atoi(argv[1]) : fallback;
+}
+
+// Fresh directory under /tmp made the working directory, for modules that
+// write files (load fixtures first). The path is static; one per process.
+static inline const char *scratch_enter(void) {
+  static char path[] = "/tmp/gps_host_XXXXXX";
+  if (!mkdtemp(path) || chdir(path) != 0) {
+    perror(path);
+    exit(2);
+  }
+  return path;
+}
+
+static inline void scratch_remove(const char *path) {
+  DIR *dir = opendir(path);
+  if (dir) {
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+      if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+        continue;
+      char sub[512];
+      if (snprintf(sub, sizeof(sub), "%s/%s", path, de->d_name) <
+          (int)sizeof(sub))
+        scratch_remove(sub);
+    }
+    closedir(dir);
+    rmdir(path);
+  } else {
+    unlink(path);
+  }
+}
+
+// Leaves and deletes the scratch directory
+static inline void scratch_leave(const char *path) {
+  if (chdir("/") == 0)
+    scratch_remove(path);
+}
@@ -0,0 +1,203 @@
+// wifi_http.c's asset_handler() on the host, behind the httpd stand-in:
+// every embedded file is served as stored with its ETag, Cache-Control and
+// type; a matching If-None-Match gets a bodyless 304 that still carries
+// Vary; a client without gzip gets 406 for a text file and the PNGs as
+// they are; the query string is ignored and a missing Leaflet file
+// redirects to the CDN. src/web_assets.c must equal a fresh
+// tools/build_web.py run over web/ (the web_assets.c fixture).
+#include "http_standin.h"
+#include "test_util.h"
+#include "web_assets.h"
+#include "wifi_http.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef WEB_DIR
+#define WEB_DIR "../../../web"
+#endif
+#ifndef WEB_ASSETS_SRC
+#define WEB_ASSETS_SRC "../../../src/web_assets.c"
+#endif
+
+#define RESP_MAX (64 * 1024)
+
+typedef struct {
+  char head[1024]; // status line and headers, NUL-terminated
+  char *body;
+  size_t body_len;
+  esp_err_t ret;
+} resp_t;
+
+// One GET through its own session, read up to Content-Length
+static bool get(const char *uri, const char *headers, resp_t *r) {
+  static char rx[RESP_MAX];
+  int fd = http_standin_request(HTTP_GET, uri, headers, &r->ret);
+  if (fd < 0)
+    return false;
+  size_t len = 0;
+  long want = -1;
+  char *end = NULL;
+  struct pollfd p = {.fd = fd, .events = POLLIN};
+  while (len < sizeof(rx) - 1 && poll(&p, 1, 100) > 0) {
+    ssize_t n = recv(fd, rx + len, sizeof(rx) - 1 - len, 0);
+    if (n <= 0)
+      break;
+    len += (size_t)n;
+    rx[len] = '\0';
+    if (!end && (end = strstr(rx, "\r\n\r\n"))) {
+      char *cl = strstr(rx, "Content-Length: ");
+      want = cl && cl < end ? strtol(cl + 16, NULL, 10) : -1;
+    }
+    if (end && want >= 0 && len >= (size_t)(end + 4 - rx) + want)
+      break;
+  }
+  close(fd);
+  http_standin_run();
+  if (!end || want < 0 || (size_t)(end - rx) >= sizeof(r->head))
+    return false;
+  memcpy(r->head, rx, end - rx + 2);
+  r->head[end - rx + 2] = '\0';
+  r->body = end + 4;
+  r->body_len = len - (size_t)(end + 4 - rx);
+  return r->body_len == (size_t)want;
+}
+
+// Value of a response header, "" when missing
+static const char *hdr(const resp_t *r, const char *name) {
+  static char val[256];
+  char key[64];
+  snprintf(key, sizeof(key), "\r\n%s: ", name);
+  const char *p = strstr(r->head, key);
+  val[0] = '\0';
+  if (p) {
+    p += strlen(key);
+    size_t n = strcspn(p, "\r\n");
+    snprintf(val, sizeof(val), "%.*s", (int)n, p);
+  }
+  return val;
+}
+
+static const web_asset_t *asset_at(const char *path) {
+  for (uint32_t i = 0; i < web_asset_count; i++)
+    if (strcmp(web_assets[i].path, path) == 0)
+      return &web_assets[i];
+  return NULL;
+}
+
+static bool png(const char *path) {
+  size_t n = strlen(path);
+  return n > 4 && strcmp(path + n - 4, ".png") == 0;
+}
+
+// Each asset as a browser fetches it first
+static void test_serve(void) {
+  size_t bytes = 0;
+  for (uint32_t i = 0; i < web_asset_count; i++) {
+    const web_asset_t *a = &web_assets[i];
+    resp_t r;
+    CHECK(get(a->path, "Accept-Encoding: gzip, deflate, br\r\n", &r));
+    CHECK_EQ(r.ret, ESP_OK);
+    CHECK(strncmp(r.head, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    CHECK_STR(hdr(&r, "Content-Type"), a->mime);
+    CHECK_STR(hdr(&r, "ETag"), a->etag);
+    CHECK_STR(hdr(&r, "Cache-Control"), a->cache_control);
+    CHECK_STR(hdr(&r, "Content-Encoding"), a->gzip ? "gzip" : "");
+    CHECK_STR(hdr(&r, "Vary"), a->gzip ? "Accept-Encoding" : "");
+    CHECK(r.body_len == a->len && memcmp(r.body, a->data, a->len) == 0);
+    // gzip member or PNG signature: only the PNGs are stored as they are
+    CHECK_EQ(a->gzip, !png(a->path));
+    CHECK(a->gzip ? memcmp(a->data, "\x1f\x8b", 2) == 0
+                  : memcmp(a->data, "\x89PNG", 4) == 0);
+    bytes += r.body_len;
+  }
+  printf("%u assets, %zu B on a cold load\n", (unsigned)web_asset_count,
+         bytes);
+  const web_asset_t *index = asset_at("/");
+  CHECK(index != NULL && strcmp(index->cache_control, "no-cache") == 0);
+  CHECK(asset_at("/leaflet/leaflet.js") != NULL);
+}
+
+// Revalidation, the query string and the Accept-Encoding cases
+static void test_conditional(void) {
+  const web_asset_t *index = asset_at("/");
+  const web_asset_t *icon = asset_at("/leaflet/images/marker-icon.png");
+  CHECK(index && icon);
+  char h[256];
+  resp_t r;
+
+  // Revalidating the page: 304 with no body, ETag and Vary kept
+  snprintf(h, sizeof(h), "If-None-Match: %s\r\n", index->etag);
+  CHECK(get("/", h, &r));
+  CHECK(strncmp(r.head, "HTTP/1.1 304 Not Modified\r\n", 27) == 0);
+  CHECK_EQ(r.body_len, 0);
+  CHECK_STR(hdr(&r, "ETag"), index->etag);
+  CHECK_STR(hdr(&r, "Vary"), "Accept-Encoding");
+  CHECK_STR(hdr(&r, "Content-Encoding"), "");
+
+  // One of several tags
+  snprintf(h, sizeof(h), "If-None-Match: \"0\", %s\r\n", index->etag);
+  CHECK(get("/?t=1", h, &r));
+  CHECK(strstr(r.head, " 304 ") != NULL);
+
+  // A stale tag gets the page
+  CHECK(get("/?t=2", "If-None-Match: \"0123456789abcdef\"\r\n", &r));
+  CHECK(strstr(r.head, " 200 ") != NULL);
+  CHECK(r.body_len == index->len);
+
+  // No Accept-Encoding is taken as accepting gzip; one without it is
+  // refused for the text files, by design, and still gets Vary
+  CHECK(get("/", NULL, &r));
+  CHECK_STR(hdr(&r, "Content-Encoding"), "gzip");
+  CHECK(get("/", "Accept-Encoding: identity\r\n", &r));
+  CHECK(strncmp(r.head, "HTTP/1.1 406 Not Acceptable\r\n", 29) == 0);
+  CHECK_STR(hdr(&r, "Vary"), "Accept-Encoding");
+  CHECK_STR(hdr(&r, "Content-Encoding"), "");
+  CHECK(get("/", "Accept-Encoding: *\r\n", &r));
+  CHECK(strstr(r.head, " 200 ") != NULL);
+
+  // The PNGs need no coding, so any client gets them, byte for byte the
+  // file in web/
+  CHECK(get(icon->path, "Accept-Encoding: identity\r\n", &r));
+  CHECK(strstr(r.head, " 200 ") != NULL);
+  CHECK_STR(hdr(&r, "Content-Encoding"), "");
+  size_t len;
+  char *file = fixture_load(WEB_DIR "/leaflet/images/marker-icon.png", &len);
+  CHECK(r.body_len == len && memcmp(r.body, file, len) == 0);
+  free(file);
+  snprintf(h, sizeof(h), "If-None-Match: %s\r\n", icon->etag);
+  CHECK(get(icon->path, h, &r));
+  CHECK(strstr(r.head, " 304 ") != NULL);
+  CHECK_STR(hdr(&r, "Vary"), "");
+
+  // Not embedded: a Leaflet path goes to the CDN, others are not found
+  CHECK(get("/leaflet/leaflet-src.js", NULL, &r));
+  CHECK(strncmp(r.head, "HTTP/1.1 302 Found\r\n", 20) == 0);
+  CHECK(strstr(hdr(&r, "Location"), "leaflet-src.js") != NULL);
+  CHECK_EQ(http_standin_request(HTTP_GET, "/index.html", NULL, NULL), -1);
+}
+
+// The committed C file against the one generated from web/ for this build
+static void test_fresh(void) {
+  size_t fresh_len, src_len;
+  char *fresh = fixture_load("web_assets.c", &fresh_len);
+  char *src = fixture_load(WEB_ASSETS_SRC, &src_len);
+  if (fresh_len != src_len || memcmp(fresh, src, src_len) != 0)
+    fprintf(stderr, "src/web_assets.c is stale: run "
+                    "python3 tools/build_web.py > src/web_assets.c\n");
+  CHECK_EQ(src_len, fresh_len);
+  CHECK(fresh_len == src_len && memcmp(fresh, src, src_len) == 0);
+  free(fresh);
+  free(src);
+}
+
+int main(void) {
+  CHECK_EQ(http_server_start(), ESP_OK);
+  test_serve();
+  test_conditional();
+  test_fresh();
+  http_standin_stats_t st;
+  http_standin_get_stats(&st);
+  CHECK_EQ(st.sessions, 0);
+  return test_result("test_web_assets");
+}
@@ -0,0 +1,62 @@
+// Synthetic tracks, see track_gen.h
+#include "track_gen.h"
+#include "geo.h"
+#include <math.h>
+
+static uint32_t lcg;
+
+static double gauss(void) {
+  double s = 0;
+  for (int i = 0; i < 12; i++) {
+    lcg = lcg * 1103515245u + 12345u;
+    s += (lcg >> 8) / 16777216.0;
+  }
+  return s - 6;
+}
+
+void track_gen(track_gen_shape_t shape, size_t n, sd_log_record_t *out) {
+  lcg = 17 + (uint32_t)shape;
+  double lat = shape == TRACK_GEN_NORTH ? 78.2 : -22.84, lon = -43.11;
+  // Degrees per metre, on the scale of geo.c
+  double m = 1e-7 / (GEO_CM_PER_E7_X100000 / 1e7);
+  double k = cos(lat * M_PI / 180), heading = 0;
+  uint32_t time = 1715000000u;
+  for (size_t i = 0; i < n; i++) {
+    double speed = 0;
+    switch (shape) {
+    case TRACK_GEN_STRAIGHT:
+      speed = 5;
+      break;
+    case TRACK_GEN_CIRCLES:
+      speed = 4;
+      heading += 2 * M_PI / 120;
+      break;
+    case TRACK_GEN_NORTH:
+    case TRACK_GEN_GAPS:
+      speed = 6;
+      if (i % 90 == 0)
+        heading += M_PI / 3;
+      break;
+    default:
+      break;
+    }
+    lat += speed * cos(heading) * m;
+    lon += speed * sin(heading) * m / k;
+    time += shape == TRACK_GEN_GAPS && i % 200 == 199 ? 5 + i % 116 : 1;
+    // Separate statements: one noise draw per coordinate, in order
+    double nlat = 1.5 * gauss() * m;
+    double nlon = 1.5 * gauss() * m / k;
+    out[i] = (sd_log_record_t){
+        .time = time,
+        .lat_e7 = (int32_t)lround((lat + nlat) * 1e7),
+        .lon_e7 = (int32_t)lround((lon + nlon) * 1e7),
+        .flags = 1,
+    };
+  }
+}
+
+const char *track_gen_name(track_gen_shape_t shape) {
+  static const char *const names[] = {"moored", "straight", "circles",
+                                      "78N turns", "gaps"};
+  return shape < TRACK_GEN_SHAPES ? names[shape] : "?";
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Synthetic 1 Hz tracks with ~1.5 m of Gaussian noise, as sd_log records,
+// shared by test_track_simplify and bench_track_simplify
+#include "sd_logger.h"
+#include <stddef.h>
+
+typedef enum {
+  TRACK_GEN_MOORED = 0,
+  TRACK_GEN_STRAIGHT, // 5 m/s
+  TRACK_GEN_CIRCLES,  // 4 m/s, one turn every 2 min
+  TRACK_GEN_NORTH,    // 6 m/s at 78N, 60-degree turns every 90 s
+  TRACK_GEN_GAPS,     // as NORTH at 22S, signal lost 5-120 s now and then
+  TRACK_GEN_SHAPES,
+} track_gen_shape_t;
+
+// Function prototypes
+void track_gen(track_gen_shape_t shape, size_t n, sd_log_record_t *out);
+const char *track_gen_name(track_gen_shape_t shape);
@@ -0,0 +1,63 @@
+// Synthetic day for trip_stats, see trip_gen.h
+#include "trip_gen.h"
+#include <math.h>
+#include <stdbool.h>
+
+#define EARTH_M 6371000.0
+
+static uint32_t lcg;
+
+static double gauss(void) {
+  double s = 0;
+  for (int i = 0; i < 12; i++) {
+    lcg = lcg * 1103515245u + 12345u;
+    s += (lcg >> 8) / 16777216.0;
+  }
+  return s - 6;
+}
+
+static double haversine_m(double lat1, double lon1, double lat2,
+                          double lon2) {
+  double r = M_PI / 180;
+  double a = pow(sin((lat2 - lat1) * r / 2), 2) +
+             cos(lat1 * r) * cos(lat2 * r) * pow(sin((lon2 - lon1) * r / 2), 2);
+  return 2 * EARTH_M * asin(sqrt(a));
+}
+
+void trip_gen(trip_gen_fix_t *out, double *truth_m) {
+  lcg = 20;
+  double lat = -22.84, lon = -43.11, heading = 0.4, total = 0;
+  double m = 180 / (M_PI * EARTH_M); // degrees per metre
+  for (size_t i = 0; i < TRIP_GEN_FIXES; i++) {
+    bool under_way =
+        (i >= TRIP_GEN_MOORED_S && i < TRIP_GEN_MOORED_S + TRIP_GEN_LEG1_S) ||
+        i >= TRIP_GEN_FIXES - TRIP_GEN_LEG2_S;
+    double kmh = 0;
+    if (under_way) {
+      // 8-14 km/h, turning 30 degrees every 5 minutes
+      kmh = 11 + 3 * sin(i / 600.0);
+      if (i % 300 == 0)
+        heading += i % 600 ? M_PI / 6 : -M_PI / 4;
+      double v = kmh / 3.6, k = cos(lat * M_PI / 180);
+      double nlat = lat + v * cos(heading) * m;
+      double nlon = lon + v * sin(heading) * m / k;
+      total += haversine_m(lat, lon, nlat, nlon);
+      lat = nlat;
+      lon = nlon;
+    }
+    double k = cos(lat * M_PI / 180);
+    // Separate statements: one noise draw per value, in order
+    double nlat = gauss() * m;
+    double nlon = gauss() * m / k;
+    double nkmh = under_way ? 0.2 * gauss() : fabs(0.3 * gauss());
+    double speed = fmax(kmh + nkmh, 0);
+    out[i] = (trip_gen_fix_t){
+        .time = TRIP_GEN_T0 + (uint32_t)i,
+        .lat_e7 = (int32_t)lround((lat + nlat) * 1e7),
+        .lon_e7 = (int32_t)lround((lon + nlon) * 1e7),
+        .speed_ckmh = (uint32_t)lround(speed * 100),
+    };
+    if (truth_m)
+      truth_m[i] = total;
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// A synthetic 5 h day at 1 Hz for trip_stats: moored, under way, moored
+// again past TRIP_STATS_SPLIT_S, under way. Positions carry 1 m of Gaussian
+// noise per axis and speeds 0.2 km/h (0.3 km/h of |noise| while moored),
+// shared by test_trip_stats and bench_trip_stats
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRIP_GEN_T0 1716033600u // 2024-05-18T12:00:00Z
+#define TRIP_GEN_MOORED_S 3600
+#define TRIP_GEN_LEG1_S 5400
+#define TRIP_GEN_STOP_S 3700
+#define TRIP_GEN_LEG2_S 5300
+#define TRIP_GEN_FIXES                                                       \
+  (TRIP_GEN_MOORED_S + TRIP_GEN_LEG1_S + TRIP_GEN_STOP_S + TRIP_GEN_LEG2_S)
+
+typedef struct {
+  uint32_t time;
+  int32_t lat_e7;
+  int32_t lon_e7;
+  uint32_t speed_ckmh;
+} trip_gen_fix_t;
+
+// Function prototypes
+// Fills TRIP_GEN_FIXES fixes from TRIP_GEN_T0; truth_m (optional) gets the
+// haversine length of the noise-free track up to each fix
+void trip_gen(trip_gen_fix_t *out, double *truth_m);
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""Generate src/web_assets.c: the web UI, precompressed, for flash.
+
+Every file under web/ becomes one asset at its relative path, web/index.html
+at "/". Leaflet 1.9.4 is vendored in web/leaflet/ (leaflet.js, leaflet.css,
+images/, BSD-2 LICENSE) and embedded under "/leaflet/" so the map works on
+the AP without internet; --leaflet takes another dist directory instead,
+and with --no-leaflet the firmware redirects /leaflet/ to unpkg.
+--fetch-leaflet first replaces web/leaflet/ with the upstream dist from
+unpkg. leaflet.js and leaflet.css are checked against the subresource
+integrity hashes published for 1.9.4, and a copy that differs is reported.
+
+Each asset is compressed once here (gzip -9, mtime 0, so the output only
+changes with the input) and served as is with Content-Encoding: gzip.
+Files gzip does not shrink (the PNGs) are stored as they are. The strong
+ETag is a SHA-256 prefix of the file itself, so it does not change with
+the compressor. index.html is revalidated on every load (no-cache,
+answered 304 while unchanged); the other files are cached for a day.
+
+Layout (structs in include/web_assets.h):
+
+  web_asset_t web_assets[]   path, mime, cache_control, etag, gzip, data,
+                             len
+
+Usage: python3 tools/build_web.py > src/web_assets.c
+       python3 tools/build_web.py --fetch-leaflet > src/web_assets.c
+       python3 tools/build_web.py --leaflet node_modules/leaflet/dist \\
+           > src/web_assets.c
+       python3 tools/build_web.py --no-leaflet > src/web_assets.c
+"""
+
+import argparse
+import base64
+import gzip
+import hashlib
+import os
+import sys
+import urllib.request
+
+MIME = {
+    ".html": "text/html; charset=utf-8",
+    ".js": "application/javascript",
+    ".css": "text/css",
+    ".png": "image/png",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".json": "application/json",
+}
+LEAFLET_FILES = ("leaflet.js", "leaflet.css")
+LEAFLET_IMAGES = ("layers-2x.png", "layers.png", "marker-icon-2x.png",
+                  "marker-icon.png", "marker-shadow.png")
+LEAFLET_URL = "https://unpkg.com/leaflet@1.9.4/"
+# As published on leafletjs.com for the 1.9.4 dist
+LEAFLET_SRI = {
+    "leaflet.js": "sha256-20nQCchB9co0qIjJZRGuk2/Z9VM+kNiyxNV1lvTlZBo=",
+    "leaflet.css": "sha256-p4NxAoJBhIIN+hmNHrzRCf9tD/miZyoHS5obTRR9BMY=",
+}
+
+
+def sri(data):
+    return "sha256-" + base64.b64encode(hashlib.sha256(data).digest()).decode()
+
+
+def fetch_leaflet(dest):
+    """Writes the upstream dist files the page loads, and the LICENSE, to
+    dest; exits if leaflet.js or leaflet.css fails its integrity hash."""
+    names = ["dist/" + n for n in LEAFLET_FILES]
+    names += ["dist/images/" + n for n in LEAFLET_IMAGES] + ["LICENSE"]
+    for name in names:
+        with urllib.request.urlopen(LEAFLET_URL + name) as r:
+            data = r.read()
+        rel = name[len("dist/"):] if name.startswith("dist/") else name
+        if rel in LEAFLET_SRI and sri(data) != LEAFLET_SRI[rel]:
+            sys.exit("%s%s: integrity mismatch" % (LEAFLET_URL, name))
+        path = os.path.join(dest, rel)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(data)
+
+
+def collect(root, prefix, skip=()):
+    """Yields (uri, file path) for every file below root, sorted, leaving
+    out the top-level directories in skip."""
+    for dirpath, dirs, files in os.walk(root):
+        if dirpath == root:
+            dirs[:] = [d for d in dirs if d not in skip]
+        dirs.sort()
+        for name in sorted(files):
+            path = os.path.join(dirpath, name)
+            rel = os.path.relpath(path, root).replace(os.sep, "/")
+            yield prefix + rel, path
+
+
+def leaflet_files(root):
+    for name in LEAFLET_FILES:
+        path = os.path.join(root, name)
+        if not os.path.isfile(path):
+            sys.exit("%s: no %s" % (root, name))
+        with open(path, "rb") as f:
+            if sri(f.read()) != LEAFLET_SRI[name]:
+                print("%s: not the upstream Leaflet 1.9.4 build" % path,
+                      file=sys.stderr)
+    for uri, path in collect(root, "/leaflet/"):
+        name = uri[len("/leaflet/"):]
+        # Only what the page loads: skip source maps and the ESM build
+        if name in LEAFLET_FILES or name.startswith("images/"):
+            yield uri, path
+
+
+def build(files):
+    assets = []
+    for uri, path in files:
+        ext = os.path.splitext(path)[1].lower()
+        if ext not in MIME:
+            sys.exit("%s: unknown type" % path)
+        with open(path, "rb") as f:
+            raw = f.read()
+        data = gzip.compress(raw, 9, mtime=0)
+        if len(data) >= len(raw):
+            data = raw
+        if uri.endswith("/index.html"):
+            uri = uri[:-len("index.html")]
+        cache = "no-cache" if ext == ".html" else "public, max-age=86400"
+        etag = '"%s"' % hashlib.sha256(raw).hexdigest()[:16]
+        assets.append((uri, MIME[ext], cache, etag, raw, data))
+    return assets
+
+
+def c_string(s):
+    return '"%s"' % s.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def emit_c(assets, out):
+    out.write("// Generated by tools/build_web.py from web/, do not edit.\n")
+    out.write("// %d assets, %d bytes stored (%d raw)\n" % (
+        len(assets), sum(len(a[5]) for a in assets),
+        sum(len(a[4]) for a in assets)))
+    out.write('#include "web_assets.h"\n')
+    for i, (uri, _, _, _, raw, data) in enumerate(assets):
+        out.write("\n// %s, %d -> %d bytes\n" % (uri, len(raw), len(data)))
+        out.write("static const uint8_t asset_%d[] = {\n" % i)
+        for j in range(0, len(data), 12):
+            row = ", ".join("0x%02X" % b for b in data[j:j + 12])
+            out.write("    %s,\n" % row)
+        out.write("};\n")
+    out.write("\nconst web_asset_t web_assets[] = {\n")
+    for i, (uri, mime, cache, etag, raw, data) in enumerate(assets):
+        out.write("    {%s, %s, %s,\n     %s, %s, asset_%d, sizeof(asset_%d)},"
+                  "\n" % (c_string(uri), c_string(mime), c_string(cache),
+                          c_string(etag), "false" if data is raw else "true",
+                          i, i))
+    out.write("};\n")
+    out.write("const uint32_t web_asset_count = "
+              "sizeof(web_assets) / sizeof(web_assets[0]);\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--web", default=os.path.normpath(os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), "..", "web")))
+    ap.add_argument("--leaflet", help="Leaflet dist directory to embed "
+                    "(default: <web>/leaflet)")
+    ap.add_argument("--no-leaflet", action="store_true",
+                    help="leave Leaflet out; /leaflet/ redirects to unpkg")
+    ap.add_argument("--fetch-leaflet", action="store_true",
+                    help="download the upstream dist into <web>/leaflet "
+                    "first")
+    args = ap.parse_args()
+
+    if args.fetch_leaflet:
+        fetch_leaflet(os.path.join(args.web, "leaflet"))
+
+    files = list(collect(args.web, "/", skip=("leaflet",)))
+    if not args.no_leaflet:
+        files += list(leaflet_files(
+            args.leaflet or os.path.join(args.web, "leaflet")))
+    assets = build(files)
+    emit_c(assets, sys.stdout)
+    for uri, _, _, _, raw, data in assets:
+        print("%-32s %7d -> %6d bytes" % (uri, len(raw), len(data)),
+              file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
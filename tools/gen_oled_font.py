@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""Generate src/oled_font.c: SSD1306 page-layout fonts for oled_print().
+
+Glyphs are stored column-major, one byte per 8-row page, LSB at the top, the
+same layout as the display RAM, so drawing a page-aligned glyph column is a
+single byte store and any other y is one shift plus two masked stores.
+
+The 5x7 table is the classic ASCII LCD font. The larger sizes are derived
+from it with Scale2x (EPX), which keeps diagonals smooth instead of
+doubling pixels into stairs:
+
+  5x7   -> 6x8 cell   (1 page)  full ASCII 0x20..0x7F (0x7F is a degree sign)
+  10x14 -> 12x16 cell (2 pages) full ASCII, Scale2x once
+  20x28 -> 24x32 cell (4 pages) '-' '.' '/' '0'..'9' ':' only, Scale2x twice
+
+Usage: python3 tools/gen_oled_font.py > src/oled_font.c
+"""
+
+import sys
+
+FIRST = 0x20
+
+# 5 columns per glyph, bit 0 = top row
+FONT_5X7 = [
+    0x00, 0x00, 0x00, 0x00, 0x00,  # ' '
+    0x00, 0x00, 0x5F, 0x00, 0x00,  # '!'
+    0x00, 0x07, 0x00, 0x07, 0x00,  # '"'
+    0x14, 0x7F, 0x14, 0x7F, 0x14,  # '#'
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,  # '$'
+    0x23, 0x13, 0x08, 0x64, 0x62,  # '%'
+    0x36, 0x49, 0x55, 0x22, 0x50,  # '&'
+    0x00, 0x05, 0x03, 0x00, 0x00,  # '''
+    0x00, 0x1C, 0x22, 0x41, 0x00,  # '('
+    0x00, 0x41, 0x22, 0x1C, 0x00,  # ')'
+    0x08, 0x2A, 0x1C, 0x2A, 0x08,  # '*'
+    0x08, 0x08, 0x3E, 0x08, 0x08,  # '+'
+    0x00, 0x50, 0x30, 0x00, 0x00,  # ','
+    0x08, 0x08, 0x08, 0x08, 0x08,  # '-'
+    0x00, 0x60, 0x60, 0x00, 0x00,  # '.'
+    0x20, 0x10, 0x08, 0x04, 0x02,  # '/'
+    0x3E, 0x51, 0x49, 0x45, 0x3E,  # '0'
+    0x00, 0x42, 0x7F, 0x40, 0x00,  # '1'
+    0x42, 0x61, 0x51, 0x49, 0x46,  # '2'
+    0x21, 0x41, 0x45, 0x4B, 0x31,  # '3'
+    0x18, 0x14, 0x12, 0x7F, 0x10,  # '4'
+    0x27, 0x45, 0x45, 0x45, 0x39,  # '5'
+    0x3C, 0x4A, 0x49, 0x49, 0x30,  # '6'
+    0x01, 0x71, 0x09, 0x05, 0x03,  # '7'
+    0x36, 0x49, 0x49, 0x49, 0x36,  # '8'
+    0x06, 0x49, 0x49, 0x29, 0x1E,  # '9'
+    0x00, 0x36, 0x36, 0x00, 0x00,  # ':'
+    0x00, 0x56, 0x36, 0x00, 0x00,  # ';'
+    0x08, 0x14, 0x22, 0x41, 0x00,  # '<'
+    0x14, 0x14, 0x14, 0x14, 0x14,  # '='
+    0x00, 0x41, 0x22, 0x14, 0x08,  # '>'
+    0x02, 0x01, 0x51, 0x09, 0x06,  # '?'
+    0x32, 0x49, 0x79, 0x41, 0x3E,  # '@'
+    0x7E, 0x11, 0x11, 0x11, 0x7E,  # 'A'
+    0x7F, 0x49, 0x49, 0x49, 0x36,  # 'B'
+    0x3E, 0x41, 0x41, 0x41, 0x22,  # 'C'
+    0x7F, 0x41, 0x41, 0x22, 0x1C,  # 'D'
+    0x7F, 0x49, 0x49, 0x49, 0x41,  # 'E'
+    0x7F, 0x09, 0x09, 0x09, 0x01,  # 'F'
+    0x3E, 0x41, 0x49, 0x49, 0x7A,  # 'G'
+    0x7F, 0x08, 0x08, 0x08, 0x7F,  # 'H'
+    0x00, 0x41, 0x7F, 0x41, 0x00,  # 'I'
+    0x20, 0x40, 0x41, 0x3F, 0x01,  # 'J'
+    0x7F, 0x08, 0x14, 0x22, 0x41,  # 'K'
+    0x7F, 0x40, 0x40, 0x40, 0x40,  # 'L'
+    0x7F, 0x02, 0x0C, 0x02, 0x7F,  # 'M'
+    0x7F, 0x04, 0x08, 0x10, 0x7F,  # 'N'
+    0x3E, 0x41, 0x41, 0x41, 0x3E,  # 'O'
+    0x7F, 0x09, 0x09, 0x09, 0x06,  # 'P'
+    0x3E, 0x41, 0x51, 0x21, 0x5E,  # 'Q'
+    0x7F, 0x09, 0x19, 0x29, 0x46,  # 'R'
+    0x46, 0x49, 0x49, 0x49, 0x31,  # 'S'
+    0x01, 0x01, 0x7F, 0x01, 0x01,  # 'T'
+    0x3F, 0x40, 0x40, 0x40, 0x3F,  # 'U'
+    0x1F, 0x20, 0x40, 0x20, 0x1F,  # 'V'
+    0x3F, 0x40, 0x38, 0x40, 0x3F,  # 'W'
+    0x63, 0x14, 0x08, 0x14, 0x63,  # 'X'
+    0x07, 0x08, 0x70, 0x08, 0x07,  # 'Y'
+    0x61, 0x51, 0x49, 0x45, 0x43,  # 'Z'
+    0x00, 0x7F, 0x41, 0x41, 0x00,  # '['
+    0x02, 0x04, 0x08, 0x10, 0x20,  # '\'
+    0x00, 0x41, 0x41, 0x7F, 0x00,  # ']'
+    0x04, 0x02, 0x01, 0x02, 0x04,  # '^'
+    0x40, 0x40, 0x40, 0x40, 0x40,  # '_'
+    0x00, 0x01, 0x02, 0x04, 0x00,  # '`'
+    0x20, 0x54, 0x54, 0x54, 0x78,  # 'a'
+    0x7F, 0x48, 0x44, 0x44, 0x38,  # 'b'
+    0x38, 0x44, 0x44, 0x44, 0x20,  # 'c'
+    0x38, 0x44, 0x44, 0x48, 0x7F,  # 'd'
+    0x38, 0x54, 0x54, 0x54, 0x18,  # 'e'
+    0x08, 0x7E, 0x09, 0x01, 0x02,  # 'f'
+    0x0C, 0x52, 0x52, 0x52, 0x3E,  # 'g'
+    0x7F, 0x08, 0x04, 0x04, 0x78,  # 'h'
+    0x00, 0x44, 0x7D, 0x40, 0x00,  # 'i'
+    0x20, 0x40, 0x44, 0x3D, 0x00,  # 'j'
+    0x7F, 0x10, 0x28, 0x44, 0x00,  # 'k'
+    0x00, 0x41, 0x7F, 0x40, 0x00,  # 'l'
+    0x7C, 0x04, 0x18, 0x04, 0x78,  # 'm'
+    0x7C, 0x08, 0x04, 0x04, 0x78,  # 'n'
+    0x38, 0x44, 0x44, 0x44, 0x38,  # 'o'
+    0x7C, 0x14, 0x14, 0x14, 0x08,  # 'p'
+    0x08, 0x14, 0x14, 0x18, 0x7C,  # 'q'
+    0x7C, 0x08, 0x04, 0x04, 0x08,  # 'r'
+    0x48, 0x54, 0x54, 0x54, 0x20,  # 's'
+    0x04, 0x3F, 0x44, 0x40, 0x20,  # 't'
+    0x3C, 0x40, 0x40, 0x20, 0x7C,  # 'u'
+    0x1C, 0x20, 0x40, 0x20, 0x1C,  # 'v'
+    0x3C, 0x40, 0x30, 0x40, 0x3C,  # 'w'
+    0x44, 0x28, 0x10, 0x28, 0x44,  # 'x'
+    0x0C, 0x50, 0x50, 0x50, 0x3C,  # 'y'
+    0x44, 0x64, 0x54, 0x4C, 0x44,  # 'z'
+    0x00, 0x08, 0x36, 0x41, 0x00,  # '{'
+    0x00, 0x00, 0x7F, 0x00, 0x00,  # '|'
+    0x00, 0x41, 0x36, 0x08, 0x00,  # '}'
+    0x08, 0x04, 0x08, 0x10, 0x08,  # '~'
+    0x00, 0x06, 0x09, 0x09, 0x06,  # degree sign at 0x7F
+]
+
+
+def to_grid(cols, height):
+    """Column bytes -> grid[y][x] of 0/1."""
+    return [[(c >> y) & 1 for c in cols] for y in range(height)]
+
+
+def scale2x(grid):
+    """EPX/Scale2x: each pixel becomes 2x2, corners follow matching edges."""
+    h, w = len(grid), len(grid[0])
+
+    def px(x, y):
+        if 0 <= x < w and 0 <= y < h:
+            return grid[y][x]
+        return 0
+
+    out = [[0] * (w * 2) for _ in range(h * 2)]
+    for y in range(h):
+        for x in range(w):
+            p = grid[y][x]
+            a, b, c, d = px(x, y - 1), px(x + 1, y), px(x - 1, y), px(x, y + 1)
+            e = [p, p, p, p]
+            if c == a and c != d and a != b:
+                e[0] = a
+            if a == b and a != c and b != d:
+                e[1] = b
+            if d == c and d != b and c != a:
+                e[2] = c
+            if b == d and b != a and d != c:
+                e[3] = d
+            out[2 * y][2 * x] = e[0]
+            out[2 * y][2 * x + 1] = e[1]
+            out[2 * y + 1][2 * x] = e[2]
+            out[2 * y + 1][2 * x + 1] = e[3]
+    return out
+
+
+def to_pages(grid, pages):
+    """grid -> bytes, page-major: all columns of page 0, then page 1..."""
+    w = len(grid[0])
+    out = []
+    for page in range(pages):
+        for x in range(w):
+            v = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < len(grid) and grid[y][x]:
+                    v |= 1 << bit
+            out.append(v)
+    return out
+
+
+def glyph_cols(code):
+    i = (code - FIRST) * 5
+    return FONT_5X7[i:i + 5]
+
+
+def build(first, last, scale_steps, pages):
+    data = []
+    for code in range(first, last + 1):
+        grid = to_grid(glyph_cols(code), 7)
+        for _ in range(scale_steps):
+            grid = scale2x(grid)
+        data.append(to_pages(grid, pages))
+    return data
+
+
+def emit_font(out, name, comment, first, last, width, advance, pages,
+              glyphs):
+    out.write(f"// {comment}\n")
+    out.write(f"static const uint8_t {name}_glyphs[] = {{\n")
+    for i, g in enumerate(glyphs):
+        ch = chr(first + i)
+        label = "degree" if first + i == 0x7F else repr(ch)
+        out.write(f"    // {label}\n")
+        for k in range(0, len(g), 12):
+            row = ", ".join(f"0x{v:02X}" for v in g[k:k + 12])
+            out.write(f"    {row},\n")
+    out.write("};\n\n")
+    out.write(f"const oled_font_t {name} = {{\n")
+    out.write(f"    .width = {width},\n")
+    out.write(f"    .advance = {advance},\n")
+    out.write(f"    .pages = {pages},\n")
+    out.write(f"    .first = 0x{first:02X},\n")
+    out.write(f"    .last = 0x{last:02X},\n")
+    out.write(f"    .glyphs = {name}_glyphs,\n")
+    out.write("};\n\n")
+
+
+def main():
+    assert len(FONT_5X7) == 96 * 5
+    out = sys.stdout
+    out.write("// Generated by tools/gen_oled_font.py, do not edit.\n")
+    out.write('#include "oled_font.h"\n\n')
+    emit_font(out, "oled_font_5x7", "5x7 in a 6x8 cell", 0x20, 0x7F, 5, 6,
+              1, build(0x20, 0x7F, 0, 1))
+    emit_font(out, "oled_font_10x14",
+              "10x14 in a 12x16 cell (5x7 through Scale2x)", 0x20, 0x7F, 10,
+              12, 2, build(0x20, 0x7F, 1, 2))
+    emit_font(out, "oled_font_digits_20x28",
+              "20x28 in a 24x32 cell, '-' to ':' (5x7 through Scale2x twice)",
+              0x2D, 0x3A, 20, 24, 4, build(0x2D, 0x3A, 2, 4))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Decode the MQTT fix payloads (see include/mqtt_codec.h).
+
+Two encodings, both starting with the codec version (1), then the batch's
+queue session and seq (fix i has queue index seq + i), then the integer
+sd_log_record_t fields:
+
+  <topic>/bin   u8 version, u8 count, u32 session, u32 seq, then count
+                24-byte records as on the SD card: <IiiiHHBBBB (time,
+                lat_e7, lon_e7, alt_cm, speed_ckmh, course_cdeg, satellites,
+                hdop_dec, flags, crc8)
+  <topic>/cbor  CBOR array [version, session, seq, row, row, ...], each row
+                [time, lat_e7, lon_e7, alt_cm, speed_ckmh, course_cdeg,
+                satellites, hdop_dec, flags]; after the first row the first
+                four fields are deltas from the previous row
+
+JSON payloads (the plain topics) are checked and passed through compacted,
+so a capture of all three formats can be piped in as is. The format is
+told apart by the first byte: '{' for JSON, 0x80..0x9F for CBOR arrays.
+Binary payloads come out in the JSON batch layout of gps/track, one
+payload per line:
+
+  {"session":123,"seq":456,
+   "fields":["time","latitude",...,"hdop","valid","fix_type"],
+   "fixes":[[1700000000,-23.5505200,...],...]}
+
+Usage:
+  python3 tools/mqtt_decode.py payload.bin
+  mosquitto_sub -t 'gps/track/#' -F '%t %x' |
+      python3 tools/mqtt_decode.py --hex -
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+VERSION = 1
+HEADER = struct.Struct("<BBII")
+RECORD = struct.Struct("<IiiiHHBBBB")
+FIELDS = ["time", "latitude", "longitude", "altitude", "speed", "course",
+          "satellites", "hdop", "valid", "fix_type"]
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc << 1) ^ 0x07 if crc & 0x80 else crc << 1
+            crc &= 0xFF
+    return crc
+
+
+def decode_packed(data):
+    if len(data) < HEADER.size or data[0] != VERSION:
+        raise ValueError("not a version %d packed payload" % VERSION)
+    _, count, session, seq = HEADER.unpack_from(data)
+    if len(data) != HEADER.size + count * RECORD.size:
+        raise ValueError("%d bytes for %d records" % (len(data), count))
+    rows = []
+    for i in range(count):
+        start = HEADER.size + i * RECORD.size
+        raw = data[start:start + RECORD.size]
+        rec = RECORD.unpack(raw)
+        if rec[-1] != crc8(raw[:-1]):
+            raise ValueError("record %d: CRC mismatch" % i)
+        rows.append(list(rec[:-1]))
+    return session, seq, rows
+
+
+def cbor_item(data, pos):
+    """Returns (value, next position) for the integer and array subset."""
+    head = data[pos]
+    major, info = head >> 5, head & 0x1F
+    pos += 1
+    if info < 24:
+        arg = info
+    elif info in (24, 25, 26, 27):
+        size = 1 << (info - 24)
+        arg = int.from_bytes(data[pos:pos + size], "big")
+        pos += size
+    else:
+        raise ValueError("unsupported CBOR head 0x%02x" % head)
+    if major == 0:
+        return arg, pos
+    if major == 1:
+        return -1 - arg, pos
+    if major == 4:
+        items = []
+        for _ in range(arg):
+            item, pos = cbor_item(data, pos)
+            items.append(item)
+        return items, pos
+    raise ValueError("unsupported CBOR major type %d" % major)
+
+
+def decode_cbor(data):
+    items, end = cbor_item(data, 0)
+    if end != len(data) or not isinstance(items, list):
+        raise ValueError("trailing bytes or not an array")
+    if len(items) < 3 or items[0] != VERSION:
+        raise ValueError("not a version %d CBOR payload" % VERSION)
+    rows, prev = [], None
+    for row in items[3:]:
+        if len(row) != 9:
+            raise ValueError("row of %d fields" % len(row))
+        if prev:
+            row[:4] = [a + b for a, b in zip(row[:4], prev[:4])]
+        rows.append(row)
+        prev = row
+    return items[1], items[2], rows
+
+
+def to_json(session, seq, rows):
+    fixes = []
+    for t, lat, lon, alt, speed, course, sats, hdop, flags in rows:
+        fixes.append([t, round(lat / 1e7, 7), round(lon / 1e7, 7),
+                      alt / 100, speed / 100, course / 100, sats, hdop / 10,
+                      bool(flags & 1), (flags >> 1) & 3])
+    return json.dumps({"session": session, "seq": seq, "fields": FIELDS,
+                       "fixes": fixes}, separators=(",", ":"))
+
+
+def decode(data):
+    """Returns one output line for a payload of any format."""
+    if data[:1] == b"{":
+        try:
+            return json.dumps(json.loads(data), separators=(",", ":"))
+        except (UnicodeDecodeError, json.JSONDecodeError) as e:
+            raise ValueError("bad JSON payload: %s" % e)
+    if data and 0x80 <= data[0] <= 0x9F:
+        return to_json(*decode_cbor(data))
+    return to_json(*decode_packed(data))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("input", help="payload file, or - for stdin")
+    ap.add_argument("--hex", action="store_true",
+                    help="input is hex, one payload per line; a leading "
+                         "topic word is passed through")
+    args = ap.parse_args()
+
+    src = sys.stdin.buffer if args.input == "-" else open(args.input, "rb")
+    if not args.hex:
+        print(decode(src.read()))
+        return
+    for line in src:
+        words = line.decode().split()
+        if not words:
+            continue
+        try:
+            out = decode(bytes.fromhex(words[-1]))
+        except ValueError as e:
+            out = "error: %s" % e
+        print(" ".join(words[:-1] + [out]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,333 @@
+#!/usr/bin/env python3
+"""Generate src/map_data.c: the OLED basemap built from an OSM XML extract.
+
+Coordinates are quantised to uint16 map units on a local isotropic grid:
+one unit is 2^n cm in both axes (x grows east, y grows north), with n the
+smallest value that fits the extract in 65535 units. The renderer zooms by
+shifting, so every zoom level is a power-of-two metres per pixel.
+
+Ways are bucketed into a grid of tiles by the centre of their bounding box.
+Each tile stores the union of its features' boxes, so a viewport test on
+the tile table skips whole buckets without looking at their features.
+
+Seamark points are sorted along a Hilbert curve and indexed by a packed
+static R-tree (the layout of Flatbush): fixed fanout, no child pointers,
+one box plus one kind mask byte per node, built bottom-up.
+
+Blob layout (little-endian, structs in include/map_data.h):
+
+  map_header_t                      56 bytes
+  map_tile_t[tiles_x * tiles_y]     16 bytes each, row-major from south-west
+  features, per tile                map_feature_t + points, 2-byte aligned
+  map_poi_t[poi_count]              12 bytes each, in Hilbert order
+  map_bbox_t[nodes]                 R-tree levels, lowest first, root last
+  uint8_t[nodes]                    R-tree kind masks
+  names                             NUL-terminated UTF-8
+
+Points: the first is absolute (u16 x, u16 y), the rest are int8 dx, dy
+pairs; dx == -128 escapes to an absolute u16 x, u16 y.
+
+Usage: python3 tools/osm2tiles.py "map(1).osm" > src/map_data.c
+       python3 tools/osm2tiles.py "map(1).osm" --bin map.bin
+"""
+
+import argparse
+import math
+import struct
+import sys
+import xml.etree.ElementTree as ET
+
+MAGIC = 0x50414D47  # "GMAP"
+VERSION = 2
+HEADER_FMT = "<IBBBbiiIIHHHBBIIIIII"
+TILE_FMT = "<HHHHIHH"
+FEATURE_FMT = "<HHHHBBH"
+POI_FMT = "<HHB3xI"
+BBOX_FMT = "<HHHH"
+NO_NAME = 0xFFFFFFFF
+TARGET_PER_TILE = 8
+RTREE_FANOUT = 16
+MAX_UNIT_LOG2_CM = 8  # the coarsest zoom level is 2^11 cm per pixel
+
+# Must match MAP_KIND_* / MAP_POI_* in include/map_data.h
+KIND_COAST, KIND_ROAD, KIND_PATH, KIND_PIER = 1, 2, 3, 4
+KIND_AREA, KIND_BUILDING, KIND_SEAMARK, KIND_BOUNDARY = 5, 6, 7, 8
+POI_BUOY, POI_BEACON, POI_WRECK, POI_LIGHT, POI_OTHER = 1, 2, 3, 4, 5
+
+PATHS = {"footway", "path", "steps", "cycleway", "track", "pedestrian"}
+AREAS = ("natural", "leisure", "landuse", "amenity")
+
+
+def way_kind(tags):
+    if tags.get("natural") == "coastline":
+        return KIND_COAST
+    if "seamark:type" in tags:
+        return KIND_SEAMARK
+    if "highway" in tags:
+        return KIND_PATH if tags["highway"] in PATHS else KIND_ROAD
+    if tags.get("man_made") in ("pier", "breakwater", "groyne"):
+        return KIND_PIER
+    if "building" in tags or tags.get("man_made") == "storage_tank":
+        return KIND_BUILDING
+    if tags.get("boundary") == "administrative":
+        return KIND_BOUNDARY
+    if any(k in tags for k in AREAS) or "man_made" in tags:
+        return KIND_AREA
+    return None
+
+
+def relation_kind(tags):
+    # Member ways of a multipolygon are usually untagged
+    if tags.get("natural") in ("bay", "water", "coastline"):
+        return KIND_COAST
+    return way_kind(tags)
+
+
+def poi_kind(tags):
+    t = tags.get("seamark:type")
+    if t is None:
+        return None
+    if t.startswith("buoy"):
+        return POI_BUOY
+    if t.startswith("beacon"):
+        return POI_BEACON
+    if t == "wreck":
+        return POI_WRECK
+    if t.startswith("light"):
+        return POI_LIGHT
+    return POI_OTHER
+
+
+def tag_map(elem):
+    return {t.get("k"): t.get("v") for t in elem.findall("tag")}
+
+
+def e7(v):
+    return int(round(float(v) * 1e7))
+
+
+def load(path):
+    root = ET.parse(path).getroot()
+    nodes = {}
+    pois = []
+    for n in root.findall("node"):
+        lat, lon = e7(n.get("lat")), e7(n.get("lon"))
+        nodes[n.get("id")] = (lat, lon)
+        tags = tag_map(n)
+        kind = poi_kind(tags)
+        if kind is not None:
+            name = tags.get("seamark:name") or tags.get("name") or ""
+            pois.append((lat, lon, kind, name))
+
+    member_kind = {}
+    for r in root.findall("relation"):
+        kind = relation_kind(tag_map(r))
+        if kind is None:
+            continue
+        for m in r.findall("member"):
+            if m.get("type") == "way":
+                member_kind.setdefault(m.get("ref"), kind)
+
+    ways = []
+    for w in root.findall("way"):
+        kind = way_kind(tag_map(w)) or member_kind.get(w.get("id"))
+        refs = [nd.get("ref") for nd in w.findall("nd")]
+        pts = [nodes[r] for r in refs if r in nodes]
+        if kind is None or len(pts) < 2:
+            continue
+        ways.append((kind, pts))
+    return ways, pois
+
+
+class Grid:
+    """Local equirectangular projection onto 2^n cm map units."""
+
+    def __init__(self, ways, pois):
+        lats = [p[0] for _, pts in ways for p in pts] + [p[0] for p in pois]
+        lons = [p[1] for _, pts in ways for p in pts] + [p[1] for p in pois]
+        self.lat0, self.lon0 = min(lats), min(lons)
+        mid = math.radians((min(lats) + max(lats)) / 2e7)
+        # cm per 1e-7 degree
+        cm_lat = 40007863e2 / 360e7
+        cm_lon = cm_lat * math.cos(mid)
+        span = max((max(lats) - self.lat0) * cm_lat,
+                   (max(lons) - self.lon0) * cm_lon)
+        self.unit_log2 = 0
+        while span / (1 << self.unit_log2) > 65535:
+            self.unit_log2 += 1
+        if self.unit_log2 > MAX_UNIT_LOG2_CM:
+            sys.exit("extract too large: %.0f km" % (span / 1e5))
+        unit = float(1 << self.unit_log2)
+        self.lat_q16 = int(round(cm_lat / unit * 65536))
+        self.lon_q16 = int(round(cm_lon / unit * 65536))
+
+    # Same integer math as map_units() on the device
+    def xy(self, p):
+        return (((p[1] - self.lon0) * self.lon_q16) >> 16,
+                ((p[0] - self.lat0) * self.lat_q16) >> 16)
+
+
+def bbox(pts):
+    xs = [p[0] for p in pts]
+    ys = [p[1] for p in pts]
+    return (min(xs), min(ys), max(xs), max(ys))
+
+
+def encode_points(pts):
+    out = bytearray(struct.pack("<HH", *pts[0]))
+    px, py = pts[0]
+    for x, y in pts[1:]:
+        dx, dy = x - px, y - py
+        if (dx, dy) == (0, 0):
+            continue
+        if -127 <= dx <= 127 and -128 <= dy <= 127:
+            out += struct.pack("<bb", dx, dy)
+        else:
+            out += struct.pack("<bbHH", -128, 0, x, y)
+        px, py = x, y
+    return out
+
+
+def hilbert(x, y):
+    """Position of (x, y) along the 2^16 x 2^16 Hilbert curve."""
+    d = 0
+    s = 1 << 15
+    while s:
+        rx = 1 if x & s else 0
+        ry = 1 if y & s else 0
+        d += s * s * ((3 * rx) ^ ry)
+        if ry == 0:
+            if rx:
+                x, y = 0xFFFF - x, 0xFFFF - y
+            x, y = y, x
+        s >>= 1
+    return d
+
+
+def rtree_levels(items):
+    """Internal levels of the packed tree, lowest first; items and nodes
+    are (x0, y0, x1, y1, kind_mask)."""
+    levels = []
+    cur = items
+    while cur and (not levels or len(cur) > 1):
+        nxt = []
+        for i in range(0, len(cur), RTREE_FANOUT):
+            group = cur[i:i + RTREE_FANOUT]
+            mask = 0
+            for n in group:
+                mask |= n[4]
+            nxt.append((min(n[0] for n in group), min(n[1] for n in group),
+                        max(n[2] for n in group), max(n[3] for n in group),
+                        mask))
+        levels.append(nxt)
+        cur = nxt
+    return levels
+
+
+def build(ways, pois):
+    g = Grid(ways, pois)
+    feats = []
+    for kind, pts in ways:
+        q = [g.xy(p) for p in pts]
+        feats.append((bbox(q), kind, q))
+
+    width = max(f[0][2] for f in feats) + 1
+    height = max(f[0][3] for f in feats) + 1
+    n = max(1, min(64, int(math.ceil(math.sqrt(len(feats) /
+                                               TARGET_PER_TILE)))))
+    tiles_x = tiles_y = n
+    buckets = [[] for _ in range(tiles_x * tiles_y)]
+    for f in feats:
+        b = f[0]
+        tx = min(tiles_x - 1, ((b[0] + b[2]) // 2) * tiles_x // width)
+        ty = min(tiles_y - 1, ((b[1] + b[3]) // 2) * tiles_y // height)
+        buckets[ty * tiles_x + tx].append(f)
+
+    header_size = struct.calcsize(HEADER_FMT)
+    tiles_off = header_size
+    body = bytearray()
+    body_off = tiles_off + len(buckets) * struct.calcsize(TILE_FMT)
+    tiles = bytearray()
+    for bucket in buckets:
+        if bucket:
+            tb = (min(f[0][0] for f in bucket), min(f[0][1] for f in bucket),
+                  max(f[0][2] for f in bucket), max(f[0][3] for f in bucket))
+        else:
+            tb = (0xFFFF, 0xFFFF, 0, 0)  # empty: x0 > x1
+        tiles += struct.pack(TILE_FMT, *tb, body_off + len(body),
+                             len(bucket), 0)
+        for b, kind, q in bucket:
+            pts = encode_points(q)
+            closed = 1 if q[0] == q[-1] else 0
+            body += struct.pack(FEATURE_FMT, *b, kind, closed, len(pts)) + pts
+
+    body += bytes(-len(body) % 4)
+    poi_off = body_off + len(body)
+    pois = sorted(((g.xy((lat, lon)), kind, name)
+                   for lat, lon, kind, name in pois),
+                  key=lambda p: hilbert(*p[0]))
+    names = bytearray()
+    poi_tab = bytearray()
+    for (x, y), kind, name in pois:
+        ref = NO_NAME
+        if name:
+            ref = len(names)
+            names += name.encode("utf-8") + b"\0"
+        poi_tab += struct.pack(POI_FMT, x, y, kind, ref)
+
+    levels = rtree_levels([(x, y, x, y, 1 << kind)
+                           for (x, y), kind, _ in pois])
+    nodes = [n for level in levels for n in level]
+    rtree_off = poi_off + len(poi_tab)
+    rtree = bytearray()
+    for n in nodes:
+        rtree += struct.pack(BBOX_FMT, *n[:4])
+    rtree += bytes(n[4] for n in nodes)
+    rtree += bytes(-len(rtree) % 4)
+    names_off = rtree_off + len(rtree)
+    size = names_off + len(names)
+
+    header = struct.pack(HEADER_FMT, MAGIC, VERSION, tiles_x, tiles_y,
+                         g.unit_log2, g.lat0, g.lon0, g.lat_q16, g.lon_q16,
+                         width, height, len(feats), RTREE_FANOUT,
+                         len(levels), len(pois), tiles_off, poi_off,
+                         rtree_off, names_off, size)
+    blob = header + tiles + body + poi_tab + rtree + names
+    assert len(blob) == size
+    return blob, g, tiles_x, tiles_y, len(feats), len(pois)
+
+
+def emit_c(blob, src, g, tiles_x, tiles_y, nfeat, npoi):
+    out = sys.stdout
+    out.write("// Generated by tools/osm2tiles.py from %s, do not edit.\n" %
+              src)
+    out.write("// %d ways in %dx%d tiles, %d seamark points, %d cm units\n"
+              % (nfeat, tiles_x, tiles_y, npoi, 1 << g.unit_log2))
+    out.write('#include "map_data.h"\n\n')
+    out.write("const uint8_t map_blob[] __attribute__((aligned(4))) = {\n")
+    for i in range(0, len(blob), 12):
+        row = ", ".join("0x%02X" % b for b in blob[i:i + 12])
+        out.write("    %s,\n" % row)
+    out.write("};\n")
+    out.write("const uint32_t map_blob_size = sizeof(map_blob);\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("osm")
+    ap.add_argument("--bin", help="write the raw blob instead of C source")
+    args = ap.parse_args()
+
+    ways, pois = load(args.osm)
+    blob, g, tx, ty, nfeat, npoi = build(ways, pois)
+    if args.bin:
+        with open(args.bin, "wb") as f:
+            f.write(blob)
+    else:
+        emit_c(blob, args.osm, g, tx, ty, nfeat, npoi)
+    print("map: %d ways, %d points, %dx%d tiles, %d bytes" %
+          (nfeat, npoi, tx, ty, len(blob)), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()